@@ -6,9 +6,15 @@ struct PSInput
     float2 uv : TEXCOORD;
 };
 
-Texture2D g_texture : register(t0);
+// Bindless, every texture lives in one table and draws pick theirs by index
+Texture2D g_textures[] : register(t0, space1);
 SamplerState g_sampler : register(s0);
 
+cbuffer DrawConstants : register(b0)
+{
+    uint g_textureIndex;
+};
+
 PSInput VSMain(float4 position : POSITION, float2 uv : TEXCOORD)
 {
     PSInput result;
@@ -21,5 +27,6 @@ PSInput VSMain(float4 position : POSITION, float2 uv : TEXCOORD)
 
 float4 PSMain(PSInput input) : SV_Target
 {
-    return g_texture.Sample(g_sampler, input.uv);
+    // Uniform across the draw, no NonUniformResourceIndex needed
+    return g_textures[g_textureIndex].Sample(g_sampler, input.uv);
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Fixed length frame benchmark: warmupFrames are thrown away, the next measuredFrames are kept per series
+// and reported as percentiles in a JSON file meant for regression tracking.
+// Series fill independently, GPU times for instance arrive a few frames late.
+class BenchmarkRecorder
+{
+public:
+	enum Series
+	{
+		CpuFrameTime,
+		GpuFrameTime,
+		PresentInterval,
+		SeriesCount
+	};
+
+	// Milliseconds. Stutters are samples longer than StutterFactor times the median.
+	struct Summary
+	{
+		uint32_t count;
+		double mean;
+		double p50;
+		double p95;
+		double p99;
+		double max;
+		uint32_t stutterCount;
+	};
+
+	static constexpr double StutterFactor = 2.0;
+
+	BenchmarkRecorder(uint32_t warmupFrames, uint32_t measuredFrames);
+
+	// Dropped while warming up and once the series holds measuredFrames samples
+	void AddSample(Series series, double milliseconds);
+	void EndFrame();
+
+	bool IsWarmingUp() const { return mFrame < mWarmupFrames; }
+	// Every frame ran, late series may still be short of samples
+	bool IsComplete() const { return mFrame >= mWarmupFrames + mMeasuredFrames; }
+
+	// Extra key and value written with the report, adapter name, resolution and such
+	void SetInfo(const std::string& key, const std::string& value);
+
+	Summary GetSummary(Series series) const;
+	static Summary Summarize(const std::vector<double>& samples);
+
+	std::string ToJson() const;
+	bool Write(const std::filesystem::path& path) const;
+
+	static const char* GetSeriesName(Series series);
+
+private:
+	uint32_t mWarmupFrames;
+	uint32_t mMeasuredFrames;
+	uint32_t mFrame = 0;
+	std::vector<double> mSamples[SeriesCount];
+	std::vector<std::pair<std::string, std::string>> mInfo;
+};
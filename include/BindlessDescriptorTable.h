@@ -0,0 +1,35 @@
+#pragma once
+
+#include "stdafx.h"
+#include "BindlessRegistry.h"
+#include "DescriptorAllocator.h"
+
+using Microsoft::WRL::ComPtr;
+
+// Shader resource views of every texture the shaders may sample, in the bindless region of a CBV/SRV/UAV heap.
+// Bound once per command list as an unbounded SRV table, draws pick their textures by index through root constants.
+// The index is also the heap index, SM6.6 shaders can use ResourceDescriptorHeap[index] with the same value.
+class BindlessDescriptorTable
+{
+public:
+	void Init(ID3D12Device* pDevice, DescriptorAllocator& heap);
+
+	// Thread safe. Returns the index of the resource's view, written on first registration; pDesc as for CreateShaderResourceView.
+	UINT RegisterTexture(ID3D12Resource* pResource, const D3D12_SHADER_RESOURCE_VIEW_DESC* pDesc = nullptr);
+
+	// The slot is cleared and reused once fenceValue completed
+	void Release(ID3D12Resource* pResource, UINT64 fenceValue);
+	void Retire(UINT64 completedFenceValue);
+
+	D3D12_GPU_DESCRIPTOR_HANDLE GetGpuHandle() const { return mTable.gpu; }
+	UINT GetCapacity() const { return mTable.count; }
+
+private:
+	void WriteNullDescriptor(UINT index);
+
+	ComPtr<ID3D12Device> mDevice;
+	DescriptorHandle mTable = {};
+	UINT mDescriptorSize = 0;
+	BindlessRegistry mRegistry;
+	std::vector<uint32_t> mFreedIndices;
+};
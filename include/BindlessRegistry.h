@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Which resources are resident in the bindless descriptor table and at which index.
+// Resources are keyed by any stable 64-bit id and reference counted. A released index is only
+// handed out again once the GPU retired the frames that may still read it.
+// Free indices are reused lowest first, keeping the live part of the table compact.
+class BindlessRegistry
+{
+public:
+	static const uint32_t InvalidIndex = ~0u;
+
+	explicit BindlessRegistry(uint32_t capacity = 0);
+
+	// Not thread safe, forgets every resource
+	void Reset(uint32_t capacity);
+
+	// Thread safe. Returns the index of key, allocating one on its first acquire, in which case isNew is set
+	// and the caller writes the descriptor. Returns InvalidIndex when the table is full.
+	uint32_t Acquire(uint64_t key, bool& isNew);
+
+	// Thread safe. Drops a reference, the last one frees the index once fenceValue completed
+	void Release(uint64_t key, uint64_t fenceValue);
+
+	// Appends the indices that became free to freedIndices, their descriptors can be cleared
+	void Retire(uint64_t completedFenceValue, std::vector<uint32_t>& freedIndices);
+
+	uint32_t Find(uint64_t key) const;
+	uint32_t GetResidentCount() const;
+	uint32_t GetCapacity() const { return mCapacity; }
+
+private:
+	struct Entry
+	{
+		uint32_t index;
+		uint32_t refCount;
+	};
+
+	struct PendingFree
+	{
+		uint32_t index;
+		uint64_t fenceValue;
+	};
+
+	mutable std::mutex mMutex;
+	std::unordered_map<uint64_t, Entry> mEntries;
+	std::vector<PendingFree> mPendingFrees;
+	// Min-heap
+	std::vector<uint32_t> mFreeIndices;
+	uint32_t mCapacity;
+};
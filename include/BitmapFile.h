@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Uncompressed 32-bit BMP, the one image format every Windows tool and browser opens without a library.
+class BitmapFile
+{
+public:
+	// pPixels is RGBA8 rows of rowPitch bytes, top row first
+	static std::vector<uint8_t> Write(uint32_t width, uint32_t height, const uint8_t* pPixels, uint64_t rowPitch);
+
+private:
+#pragma pack(push, 2)
+	struct FileHeader
+	{
+		uint16_t type;
+		uint32_t size;
+		uint16_t reserved1;
+		uint16_t reserved2;
+		uint32_t offBits;
+	};
+#pragma pack(pop)
+
+	struct InfoHeader
+	{
+		uint32_t size;
+		int32_t width;
+		int32_t height;
+		uint16_t planes;
+		uint16_t bitCount;
+		uint32_t compression;
+		uint32_t sizeImage;
+		int32_t xPelsPerMeter;
+		int32_t yPelsPerMeter;
+		uint32_t clrUsed;
+		uint32_t clrImportant;
+	};
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+class JobSystem;
+
+enum class BlockFormat
+{
+	// Opaque RGB, 5:6:5 endpoints and four colours per block
+	BC1,
+	// BC1 colour plus an interpolated alpha block
+	BC3,
+	// Two interpolated single channel blocks for red and green
+	BC5,
+	// RGBA, mode 6 only: 7 bit endpoints with a p-bit each and 16 interpolated colours
+	BC7
+};
+
+enum class BlockQuality
+{
+	// Endpoints from the principal axis of each block
+	Fast,
+	// Least squares endpoint refinement
+	Normal,
+	// Also searches the neighbouring quantized endpoints
+	High
+};
+
+// Encodes RGBA8 images to 4x4 BCn blocks. Channel errors are weighted equally, which maximises PSNR.
+class BlockCompressor
+{
+public:
+	struct Settings
+	{
+		BlockFormat format = BlockFormat::BC7;
+		BlockQuality quality = BlockQuality::Normal;
+		bool allowAvx2 = true;
+	};
+
+	// Bytes per 4x4 block
+	static uint32_t GetBlockSize(BlockFormat format);
+	static uint32_t GetBlockCount(uint32_t pixels) { return (pixels + 3) / 4; }
+
+	// pPixels holds 16 RGBA8 pixels row by row
+	static void CompressBlock(const Settings& settings, const uint8_t* pPixels, uint8_t* pBlock);
+
+	// Rows of blocks are written destRowPitch apart. Partial blocks at the edges repeat the last row and column.
+	static void Compress(const Settings& settings, uint32_t width, uint32_t height, const uint8_t* pSource, uint64_t sourceRowPitch,
+		uint8_t* pDest, uint64_t destRowPitch, JobSystem* pJobSystem = nullptr);
+
+	// Rows of blocks per job
+	static constexpr uint32_t BlockRowsPerJob = 4;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+// Palette fitting of BlockCompressor, the AVX2 version lives in its own source built with AVX2 code generation.
+
+#include <cstdint>
+
+// One 4x4 block, channel by channel. Values stay integral so errors sum exactly in any order.
+struct BlockPixels
+{
+	float channels[4][16];
+};
+
+// Picks the closest of paletteSize RGBA entries for every pixel, with per channel error weights.
+// Returns the summed squared error, ties go to the lowest index.
+float FindIndicesAvx2(const BlockPixels& pixels, const float (*pPalette)[4], uint32_t paletteSize, const float* pWeights, uint8_t* pIndices);
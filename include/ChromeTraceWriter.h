@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Collects events in the Chrome trace event format, opened with chrome://tracing, Perfetto or Speedscope,
+// or written as a Perfetto protobuf trace, which is smaller and loads faster for long captures.
+// Times are microseconds on whatever clock the caller picked, keep it the same for every event of a trace.
+// Thread safe. Events past maxEvents are dropped so a long capture can't eat all memory.
+class ChromeTraceWriter
+{
+public:
+	explicit ChromeTraceWriter(size_t maxEvents = 1 << 20);
+
+	void AddCompleteEvent(const char* name, const char* category, uint32_t processId, uint32_t threadId, double timestamp, double duration);
+	void AddInstantEvent(const char* name, const char* category, uint32_t processId, uint32_t threadId, double timestamp);
+	// Drawn as a graph per name and process
+	void AddCounterEvent(const char* name, uint32_t processId, double timestamp, double value);
+
+	// Labels shown instead of the ids
+	void SetProcessName(uint32_t processId, const char* name);
+	void SetThreadName(uint32_t processId, uint32_t threadId, const char* name);
+
+	std::string ToJson() const;
+	// Track events, one track per thread and per counter, grouped by process
+	std::vector<uint8_t> ToPerfetto() const;
+	// Perfetto protobuf for .pftrace and .perfetto-trace files, JSON otherwise
+	bool Write(const std::filesystem::path& path) const;
+
+	size_t GetEventCount() const;
+	void Clear();
+
+private:
+	struct Event
+	{
+		std::string name;
+		const char* category;
+		char phase;
+		uint32_t processId;
+		uint32_t threadId;
+		double timestamp;
+		// Value for counters
+		double duration;
+	};
+
+	void AddEvent(Event&& event);
+
+	static void AppendEscaped(std::string& json, const std::string& text);
+
+	size_t mMaxEvents;
+	mutable std::mutex mMutex;
+	std::vector<Event> mEvents;
+};
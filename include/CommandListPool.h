@@ -0,0 +1,26 @@
+#pragma once
+
+#include "stdafx.h"
+
+using Microsoft::WRL::ComPtr;
+
+// One command allocator and a growing set of command lists, owned by a single recording thread for a single frame.
+// Lists are recorded one after another, so they can all share the allocator.
+class CommandListPool
+{
+public:
+	void Init(ID3D12Device* pDevice, D3D12_COMMAND_LIST_TYPE type);
+
+	// Only call once the GPU has retired every list handed out since the last reset
+	void Reset();
+
+	// Returns a list in the recording state
+	ID3D12GraphicsCommandList* Acquire(ID3D12PipelineState* pInitialState);
+
+private:
+	ComPtr<ID3D12Device> mDevice;
+	D3D12_COMMAND_LIST_TYPE mType = D3D12_COMMAND_LIST_TYPE_DIRECT;
+	ComPtr<ID3D12CommandAllocator> mCommandAllocator;
+	std::vector<ComPtr<ID3D12GraphicsCommandList>> mCommandLists;
+	UINT mUsedCount = 0;
+};
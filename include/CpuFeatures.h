@@ -0,0 +1,11 @@
+#pragma once
+
+// Instruction set extensions the CPU and OS support, queried once
+class CpuFeatures
+{
+public:
+	static bool HasSse41();
+	// Includes FMA and F16C, every AVX2 CPU has them
+	static bool HasAvx2();
+	static bool HasNeon();
+};
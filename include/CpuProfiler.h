@@ -0,0 +1,149 @@
+#pragma once
+
+#include "ChromeTraceWriter.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define CPU_PROFILER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CPU_PROFILER_RDTSC 1
+#endif
+
+// Low overhead CPU instrumentation. Every thread appends to its own fixed size buffer, a single producer
+// single consumer ring, so recording takes no lock and writes nothing another thread reads until the flush.
+// The two timestamp reads are most of an enabled scope's cost. Flush drains all of them into a trace, call it
+// once a frame. Disabled by default, a disabled scope costs a load and a branch.
+class CpuProfiler
+{
+public:
+	static void SetEnabled(bool enabled);
+	static bool IsEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+	// Label of the calling thread in the trace
+	static void SetThreadName(const char* name);
+
+	// Raw timestamp, the invariant TSC where there is one
+	static uint64_t GetTicks()
+	{
+#ifdef CPU_PROFILER_RDTSC
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+	// Names are not copied and must outlive the profiler, string literals
+	static void RecordScope(const char* name, uint64_t beginTicks, uint64_t endTicks) { Record(name, beginTicks, endTicks, ScopeEvent); }
+	static void RecordCounter(const char* name, double value);
+	static void RecordFrameMark();
+
+	// Drains every thread's events into writer. Timestamps are microseconds of std::chrono::steady_clock,
+	// the QueryPerformanceCounter timeline on Windows, the one GpuProfiler uses.
+	static void Flush(ChromeTraceWriter& writer, uint32_t processId);
+
+	// Events lost to full buffers, flush more often if it grows
+	static uint64_t GetDroppedEventCount() { return sDroppedEvents.load(std::memory_order_relaxed); }
+
+private:
+	static const uint32_t BufferCapacity = 1 << 16;
+
+	enum EventType : uint32_t
+	{
+		ScopeEvent,
+		CounterEvent,
+		FrameEvent
+	};
+
+	struct Event
+	{
+		const char* name;
+		uint64_t begin;
+		// Counter value bits for counters
+		uint64_t end;
+		EventType type;
+	};
+
+	// The recording thread's and the flushing thread's indices sit on their own cache lines,
+	// recording only touches memory the flush doesn't write to until the buffer looks full
+	struct ThreadBuffer
+	{
+		std::unique_ptr<Event[]> events;
+		uint32_t threadId;
+		// Set and read under the registry lock
+		std::string name;
+		bool nameChanged;
+
+		alignas(64) std::atomic<uint32_t> writeIndex;
+		// Recording thread's last look at readIndex
+		uint32_t cachedReadIndex;
+
+		alignas(64) std::atomic<uint32_t> readIndex;
+	};
+
+	static void Record(const char* name, uint64_t begin, uint64_t end, EventType type)
+	{
+		ThreadBuffer* pBuffer = sThreadBuffer;
+		if (!pBuffer)
+			pBuffer = RegisterThread();
+
+		const uint32_t write = pBuffer->writeIndex.load(std::memory_order_relaxed);
+		if (write - pBuffer->cachedReadIndex >= BufferCapacity)
+		{
+			pBuffer->cachedReadIndex = pBuffer->readIndex.load(std::memory_order_acquire);
+			if (write - pBuffer->cachedReadIndex >= BufferCapacity)
+			{
+				sDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+
+		pBuffer->events[write % BufferCapacity] = { name, begin, end, type };
+		pBuffer->writeIndex.store(write + 1, std::memory_order_release);
+	}
+
+	struct Registry;
+
+	static Registry& GetRegistry();
+	static ThreadBuffer* RegisterThread();
+	static double TicksToMicroseconds(const Registry& registry, uint64_t ticks);
+
+	static std::atomic<bool> sEnabled;
+	static std::atomic<uint64_t> sDroppedEvents;
+	// Defined here so every use sees the constant initializer and skips the thread_local init check
+	static inline thread_local ThreadBuffer* sThreadBuffer = nullptr;
+};
+
+// Times its own lifetime
+class CpuProfileScope
+{
+public:
+	explicit CpuProfileScope(const char* name)
+		: mName(name), mBegin(CpuProfiler::IsEnabled() ? CpuProfiler::GetTicks() : 0) {}
+	~CpuProfileScope()
+	{
+		if (mBegin != 0)
+			CpuProfiler::RecordScope(mName, mBegin, CpuProfiler::GetTicks());
+	}
+
+	CpuProfileScope(const CpuProfileScope&) = delete;
+	CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+
+private:
+	const char* mName;
+	uint64_t mBegin;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#define PROFILE_SCOPE(name) CpuProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#define PROFILE_COUNTER(name, value) do { if (CpuProfiler::IsEnabled()) CpuProfiler::RecordCounter(name, static_cast<double>(value)); } while (0)
+#define PROFILE_FRAME() do { if (CpuProfiler::IsEnabled()) CpuProfiler::RecordFrameMark(); } while (0)
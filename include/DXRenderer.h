@@ -1,18 +1,38 @@
 #pragma once
 #include "stdafx.h"
+#include "BenchmarkRecorder.h"
+#include "BindlessDescriptorTable.h"
+#include "BlockCompressor.h"
+#include "CommandListPool.h"
+#include "CpuProfiler.h"
+#include "DescriptorAllocator.h"
+#include "FrameLoop.h"
+#include "GpuMemoryAllocator.h"
+#include "GpuProfiler.h"
+#include "JobSystem.h"
+#include "PipelineCache.h"
+#include "PreciseTimer.h"
+#include "QueueFence.h"
+#include "RenderGraph.h"
+#include "ResourceStateTracker.h"
+#include "RootSignatureRegistry.h"
+#include "ShaderHotReload.h"
+#include "ShaderLibrary.h"
+#include "UploadStreamer.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
 
-class DXRenderer
+// D3D12 backend of the frame loop. Hosts own the window, if any, and run frames until the loop asks them to quit.
+class DXRenderer : private RenderBackend
 {
 public:
 	DXRenderer(UINT width, UINT height, std::wstring name);
 	~DXRenderer();
 
-	void OnInit();
-	void OnUpdate();
-	void OnRender();
+	// The swap chain presents into hWnd, without one frames go into offscreen targets
+	void OnInit(FrameHost* pHost, HWND hWnd);
+	void RunFrame();
 	void OnDestroy();
 
 	void OnKeyDown(UINT8);
@@ -21,6 +41,7 @@ public:
 	UINT GetWidth() const { return mWidth; };
 	UINT GetHeight() const { return mHeight; }
 	const WCHAR* GetTitle() const { return mTitle.c_str(); }
+	bool IsHeadless() const { return mHeadless; }
 
 	void ParseCommandLineArgs(_In_reads_(argc) WCHAR* argv[], int argc);
 
@@ -33,14 +54,27 @@ private:
 		_Outptr_result_maybenull_ IDXGIAdapter1** ppAdapter,
 		bool requestHighPerformanceAdapter = false);
 
-	void SetCustomWindowText(LPCWSTR text);
+	// RenderBackend, driven by mFrameLoop
+	FrameQueue& GetFrameQueue() override { return mQueueFence; }
+	double GetTime() override;
+	void Wait(double milliseconds) override;
+	void WaitForDisplay() override;
+	void Update(uint64_t fenceValue) override;
+	void Render(uint32_t frameIndex, uint64_t fenceValue) override;
+	uint32_t Present(uint32_t frameIndex) override;
+	void Retire(uint64_t completedValue, std::vector<GpuFrame>& gpuFrames) override;
 
 	// Functions
-	void LoadPipeline();
+	void LoadPipeline(HWND hWnd);
+	void CreateSwapChain(IDXGIFactory4* pFactory, HWND hWnd);
 	void LoadAssets();
-	std::vector<UINT8> GenerateTextureData();
-	void PopulateCommandList();
-	void WaitForPreviousFrame();
+	D3D12_RESOURCE_DESC CreateProceduralTexture();
+	D3D12_RESOURCE_DESC LoadTextureFile(const std::wstring& path);
+	ComPtr<ID3D12PipelineState> CreateScenePipeline(const ShaderLibrary& library);
+	void PopulateCommandList(UINT frameIndex, UINT64 fenceValue);
+	void RecordSceneChunk(ID3D12GraphicsCommandList* pCommandList, UINT frameIndex, UINT firstDraw, UINT drawCount);
+	void SaveLastFrame(const std::wstring& path);
+	void OnGpuFrameRetired(const std::vector<ProfileNode>& nodes, UINT64 fenceValue);
 
 	// Display
 	UINT mWidth;
@@ -49,10 +83,49 @@ private:
 
 	bool mUseWarpDevice;
 
+	// No window or swap chain, a fixed number of frames into offscreen targets
+	bool mHeadless;
+	std::wstring mReadbackPath;
+	// Frames rendered headless, or measured by the benchmark
+	UINT mFrameLimit;
+
+	// -benchmark, frame timings reported as JSON once mFrameLimit frames were measured
+	std::unique_ptr<BenchmarkRecorder> mBenchmark;
+	std::wstring mBenchmarkPath;
+
+	// Pacing, frames in flight and when to quit, frames are identified by the fence value they end with
+	FrameLoop mFrameLoop;
+	PreciseTimer mPaceTimer;
+	HANDLE mFrameLatencyWaitable;
+	UINT mMaxFrameLatency;
+	bool mVsync;
+	bool mTearingSupported;
+
+	// Depth of the frame ring: number of back buffers and frames the CPU may record ahead of the GPU
 	static const UINT FrameCount = 2;
+	static const UINT DefaultFrameLimit = 100;
+	static const UINT BenchmarkWarmupFrames = 60;
+	static const UINT DefaultMaxFrameLatency = 2;
 	static const UINT TextureWidth = 256;
 	static const UINT TextureHeight = 256;
-	static const UINT TexturePixelSize = 4;
+	static const UINT DrawsPerChunk = 256;
+	static const UINT64 StreamingStagingSize = 64 * 1024 * 1024;
+	static const UINT PersistentDescriptorCount = 16384;
+	static const UINT TransientDescriptorCount = 16384;
+	static const UINT BindlessDescriptorCount = 16384;
+	static const UINT MaxGpuScopesPerFrame = 256;
+	static const uint32_t CpuTraceProcessId = 0;
+	static const uint32_t GpuTraceProcessId = 1;
+
+	enum RootParameters
+	{
+		BindlessTableParameter,
+		DrawConstantsParameter,
+		RootParameterCount
+	};
+
+	// Matches DrawConstants in shader.hlsl
+	static const UINT DrawConstantCount = 1;
 
 	struct Vertex
 	{
@@ -60,6 +133,14 @@ private:
 		XMFLOAT2 uv;
 	};
 
+	struct DrawItem
+	{
+		D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
+		UINT vertexCount;
+		// Bindless table index
+		UINT textureIndex;
+	};
+
 	// Pipeline Objects
 	CD3DX12_VIEWPORT mViewport;
 	CD3DX12_RECT mScissorRect;
@@ -67,25 +148,65 @@ private:
 	ComPtr<IDXGISwapChain3> mSwapChain;
 	ComPtr<ID3D12Device> mDevice;
 	ComPtr<ID3D12Resource> mRenderTargets[FrameCount];
-	ComPtr<ID3D12CommandAllocator> mCommandAllocator;
 	ComPtr<ID3D12CommandQueue> mCommandQueue;
 	ComPtr<ID3D12RootSignature> mRootSignature;
+	UINT64 mRootSignatureHash;
+	RootSignatureRegistry mRootSignatureRegistry;
 	ComPtr<ID3D12DescriptorHeap> mRtvHeap;
-	ComPtr<ID3D12DescriptorHeap> mSrvHeap;
+	DescriptorAllocator mCbvSrvUavHeap;
+	BindlessDescriptorTable mBindlessTable;
 	ComPtr<ID3D12PipelineState> mPipelineState;
-	ComPtr<ID3D12GraphicsCommandList> mCommandList;
+	PipelineCache mPipelineCache;
+	ShaderLibrary mShaderLibrary;
+	ShaderHotReload mShaderHotReload;
+	std::wstring mShaderReloadRoot;
 	UINT mRtvDescrptiorSize;
+	// -backbuffer, the view format is the sRGB variant of the buffer format for rgba8srgb
+	DXGI_FORMAT mBackBufferFormat;
+	DXGI_FORMAT mRenderTargetFormat;
 
 	// App Resources
-	ComPtr<ID3D12Resource> mVertexBuffer;
+	GpuMemoryAllocator mGpuAllocator;
+	GpuAllocation* mVertexBuffer;
 	D3D12_VERTEX_BUFFER_VIEW mVertexBufferView;
-	ComPtr<ID3D12Resource> mTexture;
+	GpuAllocation* mTexture;
+	UINT mTextureIndex;
+	// -texture, a DDS file drawn instead of the procedural checker
+	std::wstring mTexturePath;
+	// -texformat, textures are block compressed at load unless it names an uncompressed format
+	bool mCompressTextures;
+	BlockCompressor::Settings mTextureCompression;
+	// Uncompressed texture format, the RGBA8 mip chain is converted to it at load
+	DXGI_FORMAT mTextureFormat;
+	std::vector<DrawItem> mDrawItems;
+
+	// Parallel Recording, also copies upload data on the streamer's submission thread
+	std::unique_ptr<JobSystem> mJobSystem;
+	// After the job system it copies on, so it is destroyed first
+	UploadStreamer mUploadStreamer;
+	std::vector<ID3D12CommandList*> mFrameCommandLists;
+	ResourceStateTracker mStateTracker;
+	RenderGraph mRenderGraph;
+
+	// Per-frame objects, only recycled once the GPU has retired the frame that used them
+	struct FrameContext
+	{
+		// Indexed by JobSystem thread index
+		std::vector<CommandListPool> commandListPools;
+		// Render graph pass lists, open while the pass records its own lists on the job threads
+		CommandListPool graphCommandListPool;
+	};
+	FrameContext mFrames[FrameCount];
 
 	// Synchronization Objects
-	UINT mFrameIndex;
-	HANDLE mFenceEvent;
-	ComPtr<ID3D12Fence> mFence;
-	UINT64 mFenceValue;
+	QueueFence mQueueFence;
+
+	// Profiling
+	GpuProfiler mGpuProfiler;
+	// Filled by OnGpuFrameRetired while the profiler retires frames
+	std::vector<GpuFrame> mRetiredGpuFrames;
+	ChromeTraceWriter mTraceWriter;
+	std::wstring mTracePath;
 
 	// Misc.
 	std::wstring mAssetsPath;
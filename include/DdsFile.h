@@ -0,0 +1,107 @@
+#pragma once
+
+#include "directx/dxgiformat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Read-only view of a DDS texture: legacy headers and the DX10 extension, 1D, 2D, 3D, arrays, cubemaps and mip chains.
+//   uint32 magic "DDS ", Header, HeaderDx10 when the pixel format's fourCC is "DX10", then the subresources
+//   tightly packed, array slices (cube faces) outermost and mips within them, depth slices within a mip.
+// Subresources point into the parsed memory, which has to outlive this object.
+class DdsFile
+{
+public:
+	static const uint32_t Magic = 0x20534444; // "DDS "
+
+	enum class Dimension
+	{
+		Texture1D,
+		Texture2D,
+		Texture3D
+	};
+
+	struct Subresource
+	{
+		const void* pData;
+		// Bytes per row, rows of 4x4 blocks for block compressed formats
+		uint64_t rowPitch;
+		uint64_t slicePitch;
+		uint32_t rowCount;
+		uint32_t width;
+		uint32_t height;
+		uint32_t depth;
+	};
+
+	// Returns false when the file is truncated, malformed or in a format without a DXGI equivalent
+	bool Parse(const void* pData, size_t size);
+
+	Dimension GetDimension() const { return mDimension; }
+	DXGI_FORMAT GetFormat() const { return mFormat; }
+	uint32_t GetWidth() const { return mWidth; }
+	uint32_t GetHeight() const { return mHeight; }
+	uint32_t GetDepth() const { return mDepth; }
+	uint32_t GetMipCount() const { return mMipCount; }
+	// Array slices, six per cube
+	uint32_t GetArraySize() const { return mArraySize; }
+	bool IsCubemap() const { return mCubemap; }
+
+	// In D3D12 subresource order, mip + arraySlice * mipCount
+	const std::vector<Subresource>& GetSubresources() const { return mSubresources; }
+
+	// Bytes per pixel, or per 4x4 block when blockCompressed. False for formats DDS files can't hold.
+	static bool GetFormatSize(DXGI_FORMAT format, uint32_t& bytes, bool& blockCompressed);
+
+private:
+	struct PixelFormat
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t rgbBitCount;
+		uint32_t rBitMask;
+		uint32_t gBitMask;
+		uint32_t bBitMask;
+		uint32_t aBitMask;
+	};
+
+	struct Header
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t height;
+		uint32_t width;
+		uint32_t pitchOrLinearSize;
+		uint32_t depth;
+		uint32_t mipMapCount;
+		uint32_t reserved1[11];
+		PixelFormat pixelFormat;
+		uint32_t caps;
+		uint32_t caps2;
+		uint32_t caps3;
+		uint32_t caps4;
+		uint32_t reserved2;
+	};
+
+	struct HeaderDx10
+	{
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	};
+
+	static DXGI_FORMAT GetLegacyFormat(const PixelFormat& pixelFormat);
+
+	Dimension mDimension = Dimension::Texture2D;
+	DXGI_FORMAT mFormat = DXGI_FORMAT_UNKNOWN;
+	uint32_t mWidth = 0;
+	uint32_t mHeight = 0;
+	uint32_t mDepth = 0;
+	uint32_t mMipCount = 0;
+	uint32_t mArraySize = 0;
+	bool mCubemap = false;
+	std::vector<Subresource> mSubresources;
+};
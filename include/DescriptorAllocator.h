@@ -0,0 +1,48 @@
+#pragma once
+
+#include "stdafx.h"
+#include "DescriptorIndexAllocator.h"
+
+using Microsoft::WRL::ComPtr;
+
+struct DescriptorHandle
+{
+	CD3DX12_CPU_DESCRIPTOR_HANDLE cpu;
+	CD3DX12_GPU_DESCRIPTOR_HANDLE gpu;
+	UINT index;
+	UINT count;
+};
+
+// One large descriptor heap split in three regions: an optional bindless table at the very start,
+// so table indices are also heap indices, persistent descriptors handed out from a lock-free free list,
+// and a ring of contiguous transient tables that are retired by fence value, see DescriptorIndexAllocator.
+// Regions that are not needed can be given a count of 0.
+class DescriptorAllocator
+{
+public:
+	void Init(ID3D12Device* pDevice, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT persistentCount, UINT transientCount, UINT bindlessCount = 0);
+
+	// Whole bindless region, managed by BindlessDescriptorTable
+	DescriptorHandle GetBindlessTable() const;
+
+	// Thread safe, throws when the persistent region is exhausted
+	DescriptorHandle AllocatePersistent();
+	void FreePersistent(const DescriptorHandle& handle);
+
+	// Thread safe, count contiguous descriptors valid until the batch they belong to retires
+	DescriptorHandle AllocateTransient(UINT count);
+	void FinishBatch(UINT64 fenceValue);
+	void Retire(UINT64 completedFenceValue);
+
+	DescriptorHandle GetHandle(UINT index) const;
+	ID3D12DescriptorHeap* GetHeap() const { return mHeap.Get(); }
+	UINT GetDescriptorSize() const { return mDescriptorSize; }
+
+private:
+	ComPtr<ID3D12DescriptorHeap> mHeap;
+	CD3DX12_CPU_DESCRIPTOR_HANDLE mCpuStart;
+	CD3DX12_GPU_DESCRIPTOR_HANDLE mGpuStart;
+	UINT mDescriptorSize = 0;
+	bool mShaderVisible = false;
+	DescriptorIndexAllocator mIndices;
+};
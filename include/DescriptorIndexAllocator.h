@@ -0,0 +1,39 @@
+#pragma once
+
+#include "IndexFreeList.h"
+#include "RingAllocator.h"
+
+#include <cstdint>
+#include <mutex>
+
+// Index bookkeeping behind DescriptorAllocator, without D3D12. Heap indices are laid out as
+// [bindless | persistent | transient]: persistent indices come from a lock-free free list,
+// transient ranges from a ring retired by fence value.
+class DescriptorIndexAllocator
+{
+public:
+	static const uint32_t InvalidIndex = IndexFreeList::InvalidIndex;
+
+	void Init(uint32_t persistentCount, uint32_t transientCount, uint32_t bindlessCount = 0);
+
+	// Thread safe, return InvalidIndex when the region is exhausted
+	uint32_t AllocatePersistent();
+	void FreePersistent(uint32_t index);
+	uint32_t AllocateTransient(uint32_t count);
+
+	// Skipped when there is no transient region, so they cost nothing per frame then
+	void FinishBatch(uint64_t fenceValue);
+	void Retire(uint64_t completedFenceValue);
+
+	uint32_t GetBindlessCount() const { return mBindlessCount; }
+	uint32_t GetDescriptorCount() const { return mBindlessCount + mPersistentCount + mTransientCount; }
+
+private:
+	uint32_t mBindlessCount = 0;
+	uint32_t mPersistentCount = 0;
+	uint32_t mTransientCount = 0;
+	IndexFreeList mPersistentFreeList;
+
+	std::mutex mTransientMutex;
+	RingAllocator mTransientRing;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+
+// Watches a directory tree on its own thread and reports every file written, created or renamed into it.
+// ReadDirectoryChangesW on Windows, inotify on Linux. Editors often save several times in a row,
+// callers are expected to debounce.
+class FileWatcher
+{
+public:
+	// Called on the watcher thread with the absolute path of the changed file
+	typedef std::function<void(const std::filesystem::path& path)> ChangeFunc;
+
+	FileWatcher() = default;
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	// Returns false when the directory can't be watched
+	bool Start(const std::filesystem::path& directory, ChangeFunc onChange);
+	void Stop();
+
+private:
+	void ThreadMain();
+
+	std::filesystem::path mDirectory;
+	ChangeFunc mOnChange;
+	std::thread mThread;
+
+#ifdef _WIN32
+	void* mDirectoryHandle = nullptr;
+	void* mStopEvent = nullptr;
+#else
+	void AddWatches(const std::filesystem::path& directory);
+
+	int mInotify = -1;
+	int mStopPipe[2] = { -1, -1 };
+	std::map<int, std::filesystem::path> mWatches;
+#endif
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "directx/dxgiformat.h"
+
+#include <cstdint>
+
+class JobSystem;
+
+// One subresource, depth slices of height rows each
+struct FormatConversionDesc
+{
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+	const void* pSource;
+	uint64_t sourceRowPitch;
+	uint64_t sourceSlicePitch;
+	void* pDest;
+	uint64_t destRowPitch;
+	uint64_t destSlicePitch;
+};
+
+// Converts pixels between the common uncompressed DXGI formats, any to any, through linear float RGBA.
+// Kernels are picked from per-format component metadata laid out like D3D12_PROPERTY_LAYOUT_FORMAT_TABLE.
+//   UNORM and SNORM divide by the largest code on the way in, and clamp and round to nearest even on the way out.
+//   sRGB colour channels are linearized and re-encoded, alpha is always linear.
+//   16-bit floats follow F16C: overflow becomes infinity and NaNs stay quiet NaNs.
+//   11 and 10-bit floats clamp negatives to zero and finite overflow to their largest value.
+//   Channels the source lacks read as 0, alpha as 1. X channels are written as 0.
+// The AVX2 kernels run the same operations as the scalar ones, so results are bit-exact either way.
+class FormatConverter
+{
+public:
+	struct Settings
+	{
+		bool allowAvx2 = true;
+	};
+
+	static bool IsSupported(DXGI_FORMAT format);
+	static bool IsSrgb(DXGI_FORMAT format);
+	// 0 for unsupported formats
+	static uint32_t GetPixelSize(DXGI_FORMAT format);
+
+	// Every subresource goes from sourceFormat to destFormat, rows split across pJobSystem.
+	// Returns false when either format is unsupported, nothing is written then.
+	static bool Convert(const Settings& settings, DXGI_FORMAT sourceFormat, DXGI_FORMAT destFormat,
+		const FormatConversionDesc* pSubresources, uint32_t count, JobSystem* pJobSystem = nullptr);
+
+	// Approximate pixels per job
+	static constexpr uint32_t PixelsPerJob = 64 * 1024;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+// Pixel kernels of FormatConverter, the AVX2 versions live in their own source built with AVX2 code generation.
+// Pixels are decoded into four float planes (R, G, B, A) and encoded back out of them.
+
+#include <cstdint>
+
+enum class ComponentEncoding : uint8_t
+{
+	Unorm,
+	Snorm,
+	Srgb,
+	// 32, 16, 11 or 10 bits, the last two unsigned with a 5-bit exponent
+	Float
+};
+
+// A channel sits in one word of its pixel at shift, bits wide
+struct ChannelLayout
+{
+	bool present;
+	uint8_t word;
+	uint8_t shift;
+	uint8_t bits;
+	ComponentEncoding encoding;
+};
+
+// Pixels are wordCount words of wordSize bytes, wordSize is below 4 only for single word pixels
+struct PixelLayout
+{
+	uint32_t wordSize;
+	uint32_t wordCount;
+	ChannelLayout channels[4];
+};
+
+struct ConversionTables
+{
+	// sRGB code to linear, 256 entries
+	const float* pSrgbDecode;
+	// Linear scaled to [0, 65535] to sRGB code, padded for four byte gathers
+	const uint8_t* pSrgbEncode;
+};
+
+// Present channels only, both return how many leading pixels they converted, always a multiple of 8
+uint32_t DecodePixelsAvx2(const PixelLayout& layout, const ConversionTables& tables, const uint8_t* pSource, uint32_t count, float* const* ppPlanes);
+uint32_t EncodePixelsAvx2(const PixelLayout& layout, const ConversionTables& tables, const float* const* ppPlanes, uint32_t count, uint8_t* pDest);
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "BenchmarkRecorder.h"
+#include "FramePacer.h"
+#include "FrameRing.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Whatever the frame loop runs in, a window or the console
+class FrameHost
+{
+public:
+	virtual ~FrameHost() = default;
+
+	// Frame stats, a few times a second at most. UTF-8.
+	virtual void SetStatusText(const std::string& text) = 0;
+	// The loop is done, the host stops running frames and shuts the renderer down
+	virtual void RequestQuit() = 0;
+};
+
+// Device side of a frame, D3D12 in DXRenderer and simulated in NullRenderBackend.
+// Times are milliseconds on the backend's monotonic clock, GPU times included.
+class RenderBackend
+{
+public:
+	struct GpuFrame
+	{
+		uint64_t fenceValue;
+		double begin;
+		double end;
+	};
+
+	virtual ~RenderBackend() = default;
+
+	// The timeline the frame ring paces against
+	virtual FrameQueue& GetFrameQueue() = 0;
+	virtual double GetTime() = 0;
+	// Holds the CPU back for the pacer
+	virtual void Wait(double milliseconds) = 0;
+	// Blocks until the display can queue another frame, returns at once without a swap chain
+	virtual void WaitForDisplay() = 0;
+
+	// Frame start, nothing of the frame ending with fenceValue is recorded yet
+	virtual void Update(uint64_t fenceValue) = 0;
+	// Records and submits the frame, it renders into slot frameIndex and ends with fenceValue
+	virtual void Render(uint32_t frameIndex, uint64_t fenceValue) = 0;
+	// Returns the slot of the next frame, swap chains pick it themselves
+	virtual uint32_t Present(uint32_t frameIndex) = 0;
+	// Frames up to completedValue are done and their resources may be recycled.
+	// The GPU time of every frame that retired is appended to gpuFrames.
+	virtual void Retire(uint64_t completedValue, std::vector<GpuFrame>& gpuFrames) = 0;
+};
+
+// A frame from its start to its retirement, whatever the backend and host: frame pacing, frames in flight,
+// benchmark samples, the status line and when to stop. RunFrame is called from one thread only.
+class FrameLoop
+{
+public:
+	static constexpr double StatusInterval = 1000.0;
+	// Retired GPU frames the status line summarizes
+	static constexpr uint32_t StatusWindowSize = 256;
+
+	FrameLoop();
+
+	// Backend, host and benchmark must outlive the loop. It asks the host to quit once the benchmark is
+	// complete, or without one after frameLimit frames, 0 runs until the host quits on its own.
+	void Init(RenderBackend* pBackend, FrameHost* pHost, uint32_t frameCount, uint32_t frameIndex,
+		uint32_t frameLimit, BenchmarkRecorder* pBenchmark);
+
+	void RunFrame();
+	// Waits for everything submitted and retires it, the current slot is kept
+	void Flush();
+
+	FramePacer& GetFramePacer() { return mFramePacer; }
+	const FrameRing& GetFrameRing() const { return mFrameRing; }
+	uint32_t GetRenderedFrameCount() const { return mRenderedFrameCount; }
+	// Slot of the last presented frame
+	uint32_t GetLastFrameIndex() const { return mLastFrameIndex; }
+	bool IsQuitRequested() const { return mQuitRequested; }
+
+private:
+	void WaitForNextFrame();
+	void UpdateStatus(double now);
+	void EndFrameTiming(double frameStart);
+	void MoveToNextFrame(uint32_t nextFrameIndex);
+	void Retire(uint64_t completedValue);
+	void RequestQuit();
+
+	RenderBackend* mpBackend;
+	FrameHost* mpHost;
+	BenchmarkRecorder* mpBenchmark;
+	FrameRing mFrameRing;
+	FramePacer mFramePacer;
+
+	uint32_t mFrameLimit;
+	uint32_t mRenderedFrameCount;
+	uint32_t mLastFrameIndex;
+	bool mQuitRequested;
+	double mLastPresentTime;
+	bool mHasPresented;
+
+	std::vector<RenderBackend::GpuFrame> mRetiredFrames;
+	// Ring of the last StatusWindowSize GPU frame times
+	std::vector<double> mGpuFrameTimes;
+	uint32_t mNextGpuFrameTime;
+	double mLastGpuFrameTime;
+	double mLastStatusTime;
+	bool mHasStatus;
+};
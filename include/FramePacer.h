@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+
+// Decides how long to hold back the start of every frame, for two independent reasons:
+// a frame rate cap, deadlines spaced by the target frame time that keep their phase unless a frame runs
+// a whole interval late, and latency targeting, which delays the CPU by the time its recent submissions sat
+// queued before the GPU picked them up so input is sampled as late as possible.
+// No clock of its own, times are milliseconds on the caller's monotonic clock so traces can be replayed.
+class FramePacer
+{
+public:
+	struct Settings
+	{
+		// 0 leaves the frame rate uncapped
+		double targetFrameTime = 0.0;
+		bool lowLatency = false;
+		// Queue time kept as slack so GPU jitter doesn't leave it idle
+		double latencyMargin = 1.0;
+		// Share of the excess queue time taken off per retired frame, shrinking the delay is never damped
+		double latencyGain = 0.25;
+	};
+
+	static constexpr uint32_t PendingFrameCount = 16;
+	// Retired frames the queue time minimum is taken over
+	static constexpr uint32_t QueueWindowSize = 4;
+	static constexpr double MaxLatencyDelay = 50.0;
+
+	FramePacer();
+
+	void SetSettings(const Settings& settings);
+	const Settings& GetSettings() const { return mSettings; }
+
+	// Time to wait before starting the next frame
+	double GetWaitTime(double now) const;
+
+	// The frame started once the wait was over, ids must increase
+	void BeginFrame(uint64_t frameId, double now);
+	void SubmitFrame(uint64_t frameId, double now);
+	// GPU execution of a retired frame, on the caller's clock. Frames too old to still be pending are ignored.
+	void CompleteFrame(uint64_t frameId, double gpuBegin, double gpuEnd);
+
+	double GetLatencyDelay() const { return mLatencyDelay; }
+	// Last retired frame: how long it waited for the GPU, and start to GPU completion
+	double GetQueueTime() const { return mQueueTime; }
+	double GetFrameLatency() const { return mFrameLatency; }
+
+	void Reset();
+
+private:
+	struct PendingFrame
+	{
+		uint64_t id;
+		double start;
+		double submit;
+		bool valid;
+	};
+
+	Settings mSettings;
+	PendingFrame mPending[PendingFrameCount];
+
+	double mNextDeadline = 0.0;
+	bool mHasDeadline = false;
+
+	double mQueueWindow[QueueWindowSize];
+	uint32_t mQueueCount = 0;
+	uint32_t mQueueNext = 0;
+
+	double mLatencyDelay = 0.0;
+	double mQueueTime = 0.0;
+	double mFrameLatency = 0.0;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// The GPU timeline a FrameRing paces against, a fence signalled from the end of a queue
+class FrameQueue
+{
+public:
+	virtual ~FrameQueue() = default;
+
+	// Queues a signal of fenceValue behind everything submitted so far
+	virtual void Signal(uint64_t fenceValue) = 0;
+	virtual uint64_t GetCompletedValue() = 0;
+	// Blocks until the fence has reached fenceValue
+	virtual void Wait(uint64_t fenceValue) = 0;
+};
+
+// Frames in flight. Every slot remembers the fence value its last frame ended with, and the CPU only
+// blocks when it is about to reuse a slot the GPU hasn't retired yet, FrameCount frames ahead.
+// Frames are identified by the fence value they end with, values start at 1 and only grow.
+class FrameRing
+{
+public:
+	FrameRing();
+
+	void Init(FrameQueue* pQueue, uint32_t frameCount, uint32_t frameIndex = 0);
+
+	uint32_t GetFrameCount() const { return static_cast<uint32_t>(mSlotFenceValues.size()); }
+	uint32_t GetFrameIndex() const { return mFrameIndex; }
+	// The frame being recorded ends with this value
+	uint64_t GetFenceValue() const { return mFenceValue; }
+	// As of the last MoveToNextFrame or Flush
+	uint64_t GetCompletedValue() const { return mCompletedValue; }
+
+	// Ends the current frame and moves to the next slot in order, or to nextFrameIndex for swap chains
+	// that pick it themselves. Returns the value the GPU has completed once the slot is free.
+	uint64_t MoveToNextFrame();
+	uint64_t MoveToNextFrame(uint32_t nextFrameIndex);
+
+	// Signals and waits for everything submitted, the current slot is kept
+	uint64_t Flush();
+
+private:
+	FrameQueue* mpQueue;
+	std::vector<uint64_t> mSlotFenceValues;
+	uint32_t mFrameIndex;
+	uint64_t mFenceValue;
+	uint64_t mCompletedValue;
+};
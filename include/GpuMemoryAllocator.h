@@ -0,0 +1,105 @@
+#pragma once
+
+#include "stdafx.h"
+#include "TlsfAllocator.h"
+
+#include <memory>
+#include <mutex>
+
+using Microsoft::WRL::ComPtr;
+
+class GpuMemoryAllocator;
+
+struct HeapBlock
+{
+	ComPtr<ID3D12Heap> heap;
+	TlsfAllocator allocator;
+};
+
+// Placed resource living inside one of the allocator's heaps
+class GpuAllocation
+{
+public:
+	ID3D12Resource* GetResource() const { return mResource.Get(); }
+	ID3D12Heap* GetHeap() const;
+	UINT64 GetHeapOffset() const;
+	UINT64 GetSize() const;
+
+private:
+	friend class GpuMemoryAllocator;
+
+	ComPtr<ID3D12Resource> mResource;
+	HeapBlock* mpBlock = nullptr;
+	TlsfAllocator::Handle mHandle = TlsfAllocator::InvalidHandle;
+};
+
+// Sub-allocates resources from large ID3D12Heap blocks instead of one committed resource each.
+// Heaps are split by heap type and by resource category so it runs on resource heap tier 1.
+class GpuMemoryAllocator
+{
+public:
+	static const UINT64 DefaultBlockSize = 64 * 1024 * 1024;
+
+	struct Stats
+	{
+		UINT blockCount;
+		UINT64 reservedSize;
+		UINT64 usedSize;
+		UINT allocationCount;
+		// Worst block, see TlsfAllocator::Stats
+		double fragmentation;
+	};
+
+	void Init(ID3D12Device* pDevice, UINT64 blockSize = DefaultBlockSize);
+
+	GpuAllocation* CreateResource(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc,
+		D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* pClearValue);
+
+	// The GPU must be done with the resource
+	void Release(GpuAllocation* pAllocation);
+
+	Stats GetStats() const;
+
+	// Moves up to maxMoves allocations into lower free space, copies are recorded on pCommandList.
+	// Moved resources must be in the COMMON state and get a new ID3D12Resource, views on them have to be
+	// recreated by the caller. The old memory is reused only after Retire sees fenceValue completed.
+	std::vector<GpuAllocation*> Defragment(ID3D12GraphicsCommandList* pCommandList, UINT maxMoves, UINT64 fenceValue);
+	void Retire(UINT64 completedFenceValue);
+
+private:
+	enum class ResourceCategory
+	{
+		Buffer,
+		Texture,
+		RenderTargetTexture,
+		Count
+	};
+
+	struct Pool
+	{
+		D3D12_HEAP_TYPE heapType;
+		ResourceCategory category;
+		std::vector<std::unique_ptr<HeapBlock>> blocks;
+	};
+
+	struct PendingFree
+	{
+		HeapBlock* pBlock;
+		TlsfAllocator::Handle handle;
+		ComPtr<ID3D12Resource> resource;
+		UINT64 fenceValue;
+	};
+
+	static ResourceCategory GetCategory(const D3D12_RESOURCE_DESC& desc);
+	static D3D12_HEAP_FLAGS GetHeapFlags(ResourceCategory category);
+	Pool& GetPool(D3D12_HEAP_TYPE heapType, ResourceCategory category);
+	HeapBlock* CreateBlock(Pool& pool, UINT64 size, UINT64 alignment);
+
+	ComPtr<ID3D12Device> mDevice;
+	UINT64 mBlockSize = DefaultBlockSize;
+
+	mutable std::mutex mMutex;
+	std::vector<Pool> mPools;
+	std::vector<std::unique_ptr<GpuAllocation>> mAllocations;
+	std::vector<PendingFree> mPendingFrees;
+};
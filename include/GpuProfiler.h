@@ -0,0 +1,102 @@
+#pragma once
+
+#include "stdafx.h"
+#include "ChromeTraceWriter.h"
+#include "ProfileStats.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+using Microsoft::WRL::ComPtr;
+
+// GPU timing from timestamp queries. Scopes may begin and end in different command lists and be recorded
+// from several threads, the hierarchy is rebuilt from the timestamps once the frame retired.
+// Every frame resolves into its own slice of a readback ring which is only read after the frame's fence
+// completed, so reading results never stalls.
+class GpuProfiler
+{
+public:
+	static const UINT InvalidScope = ~0u;
+
+	// frameCount is the number of frames in flight, a slot per frame
+	void Init(ID3D12Device* pDevice, ID3D12CommandQueue* pQueue, UINT frameCount, UINT maxScopesPerFrame);
+
+	void BeginFrame();
+
+	// Thread safe. name is kept as is, it must outlive the profiler. Returns InvalidScope once the frame is full.
+	UINT BeginScope(ID3D12GraphicsCommandList* pCommandList, const char* name);
+	void EndScope(ID3D12GraphicsCommandList* pCommandList, UINT scope);
+
+	// Resolves the frame's timestamps, record it in the frame's last command list. fenceValue is signaled after it.
+	void EndFrame(ID3D12GraphicsCommandList* pCommandList, UINT64 fenceValue);
+
+	// Reads back every frame the GPU is done with
+	void Retire(UINT64 completedFenceValue);
+
+	const ProfileStats& GetStats() const { return mStats; }
+
+	// GPU timestamp on the QueryPerformanceCounter timeline, the one std::chrono::steady_clock uses on Windows
+	double GetCpuMicroseconds(UINT64 gpuTimestamp) const
+	{
+		return mCalibrationMicroseconds + (static_cast<double>(gpuTimestamp) - static_cast<double>(mCalibrationGpu)) * 1e6 / static_cast<double>(mTimestampFrequency);
+	}
+
+	// Retired frames are also added to writer, times are QueryPerformanceCounter based microseconds
+	void SetTraceWriter(ChromeTraceWriter* pWriter, uint32_t processId);
+
+	// Called from Retire with the scopes of every frame read back and the fence value it ended with
+	using FrameListener = std::function<void(const std::vector<ProfileNode>& nodes, UINT64 fenceValue)>;
+	void SetFrameListener(FrameListener listener) { mFrameListener = std::move(listener); }
+
+private:
+	struct Frame
+	{
+		std::unique_ptr<const char*[]> names;
+		std::atomic<UINT> scopeCount;
+		UINT64 fenceValue;
+		bool pending;
+	};
+
+	void ReadFrame(Frame& frame, UINT slot);
+
+	ComPtr<ID3D12QueryHeap> mQueryHeap;
+	ComPtr<ID3D12Resource> mReadback;
+	const UINT64* mpReadback = nullptr;
+
+	UINT mMaxScopes = 0;
+	UINT mFrameCount = 0;
+	UINT mCurrentSlot = 0;
+	bool mFrameActive = false;
+	std::unique_ptr<Frame[]> mFrames;
+
+	UINT64 mTimestampFrequency = 0;
+	// Same instant on both clocks, maps GPU timestamps onto the CPU timeline of the trace
+	UINT64 mCalibrationGpu = 0;
+	double mCalibrationMicroseconds = 0.0;
+
+	ProfileStats mStats;
+	std::vector<ProfileEvent> mEvents;
+	std::vector<ProfileNode> mNodes;
+
+	ChromeTraceWriter* mpTraceWriter = nullptr;
+	uint32_t mTraceProcessId = 0;
+	FrameListener mFrameListener;
+};
+
+// Scope covering the commands recorded into one list while it lives
+class GpuProfileScope
+{
+public:
+	GpuProfileScope(GpuProfiler& profiler, ID3D12GraphicsCommandList* pCommandList, const char* name)
+		: mProfiler(profiler), mpCommandList(pCommandList), mScope(profiler.BeginScope(pCommandList, name)) {}
+	~GpuProfileScope() { mProfiler.EndScope(mpCommandList, mScope); }
+
+	GpuProfileScope(const GpuProfileScope&) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+	GpuProfiler& mProfiler;
+	ID3D12GraphicsCommandList* mpCommandList;
+	UINT mScope;
+};
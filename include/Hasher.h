@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Incremental 64-bit FNV-1a. Stable across runs and platforms, so it can key data persisted on disk.
+// Hash structs field by field, padding bytes are not guaranteed to be zero.
+class Hasher
+{
+public:
+	static const uint64_t OffsetBasis = 14695981039346656037ull;
+	static const uint64_t Prime = 1099511628211ull;
+
+	void Add(const void* pData, size_t size);
+
+	template <typename T>
+	void AddValue(const T& value) { Add(&value, sizeof(value)); }
+
+	// Null terminated, null is hashed differently from the empty string
+	void AddString(const char* pString);
+
+	uint64_t Get() const { return mHash; }
+
+private:
+	uint64_t mHash = OffsetBasis;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "stdafx.h"
+
+class DXRenderer;
+
+// Drives the renderer without a window, frames go into offscreen targets until it asks to quit.
+// For batch jobs, CI and benchmarks, pair it with -warp where there is no GPU.
+class HeadlessCtx
+{
+public:
+	static int Run(DXRenderer* pRenderer);
+};
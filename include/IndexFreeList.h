@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Lock-free LIFO free list of indices in [0, capacity).
+// The head carries a tag that changes on every update so a stale compare-exchange can't succeed (ABA).
+class IndexFreeList
+{
+public:
+	static const uint32_t InvalidIndex = ~0u;
+
+	explicit IndexFreeList(uint32_t capacity = 0);
+
+	// Not thread safe, every index becomes free
+	void Reset(uint32_t capacity);
+
+	// Returns InvalidIndex when every index is in use
+	uint32_t Allocate();
+	void Free(uint32_t index);
+
+	uint32_t GetCapacity() const { return mCapacity; }
+
+private:
+	static uint64_t Pack(uint32_t tag, uint32_t index) { return (static_cast<uint64_t>(tag) << 32) | index; }
+	static uint32_t Tag(uint64_t head) { return static_cast<uint32_t>(head >> 32); }
+	static uint32_t Index(uint64_t head) { return static_cast<uint32_t>(head); }
+
+	std::unique_ptr<std::atomic<uint32_t>[]> mNext;
+	std::atomic<uint64_t> mHead;
+	uint32_t mCapacity;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads with one job deque each.
+// Owners pop from the back of their own deque, idle workers steal from the front of the others.
+// Threads outside the pool claim one of the caller slots for the duration of a ParallelFor, so several of
+// them can submit at once. Once every slot is taken, further callers wait for one to free up.
+class JobSystem
+{
+public:
+	typedef std::function<void(unsigned int threadIndex)> Job;
+
+	static const unsigned int DefaultCallerCount = 4;
+	static const unsigned int MaxCallerCount = 64;
+
+	// 0 picks one worker per hardware thread, minus the calling thread
+	explicit JobSystem(unsigned int workerCount = 0, unsigned int callerCount = DefaultCallerCount);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	unsigned int GetWorkerCount() const { return static_cast<unsigned int>(mWorkers.size()); }
+	// Workers plus the caller slots, the callers help out while they wait
+	unsigned int GetThreadCount() const { return static_cast<unsigned int>(mQueues.size()); }
+
+	// Runs func(index, threadIndex) for every index in [0, count) and returns once all of them finished.
+	// threadIndex is lower than GetThreadCount() and no two threads use the same one at the same time, so it can
+	// address per-thread pools. Workers always get their own index, external callers the slot they claimed.
+	// Nested calls from inside func keep the thread's index.
+	// The first exception thrown by func is rethrown here once every index has run.
+	void ParallelFor(unsigned int count, const std::function<void(unsigned int index, unsigned int threadIndex)>& func);
+
+private:
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	void Push(unsigned int queueIndex, Job job);
+	bool TryGetJob(unsigned int threadIndex, Job& job);
+	void WorkerMain(unsigned int threadIndex);
+	unsigned int ClaimCallerSlot();
+	void ReleaseCallerSlot(unsigned int threadIndex);
+
+	std::vector<std::thread> mWorkers;
+	std::vector<std::unique_ptr<WorkerQueue>> mQueues;
+
+	std::mutex mSleepMutex;
+	std::condition_variable mWakeCondition;
+	std::atomic<unsigned int> mQueuedJobs;
+	bool mShutdown;
+
+	// One bit per caller slot, set while a thread outside the pool holds it
+	std::atomic<uint64_t> mCallerSlots;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Bump allocator for short-lived scratch data. Nothing is freed individually, Reset releases
+// everything at once and keeps the memory, so a steady workload stops touching the heap after warming up.
+class LinearArena
+{
+public:
+	explicit LinearArena(size_t blockSize = 64 * 1024);
+
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+
+	// Alignment must be a power of two
+	void* Allocate(size_t size, size_t alignment);
+
+	// Uninitialized storage for count trivially constructible objects
+	template <typename T>
+	T* Allocate(size_t count) { return static_cast<T*>(Allocate(count * sizeof(T), alignof(T))); }
+
+	// Blocks grown into since the last reset are merged into one big enough for all of them
+	void Reset();
+
+	size_t GetCapacity() const;
+
+private:
+	struct Block
+	{
+		std::unique_ptr<uint8_t[]> data;
+		size_t size;
+	};
+
+	size_t mBlockSize;
+	std::vector<Block> mBlocks;
+	size_t mCurrentBlock;
+	size_t mOffset;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+// Read-only memory mapping of a whole file. Pages are read on first touch, nothing is copied up front.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Returns false when the file can't be opened or is empty
+	bool Open(const std::filesystem::path& path);
+	void Close();
+
+	const void* GetData() const { return mpView; }
+	size_t GetSize() const { return mSize; }
+
+private:
+	const void* mpView = nullptr;
+	size_t mSize = 0;
+
+#ifdef _WIN32
+	void* mFile = nullptr;
+	void* mMapping = nullptr;
+#endif
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class JobSystem;
+
+enum class MipFilter
+{
+	// 2x2 average for even sizes
+	Box,
+	// Kaiser windowed sinc, width 3, alpha 4
+	Kaiser,
+	// Lanczos with three lobes
+	Lanczos
+};
+
+// RGBA8 image with every level of its mip chain in one allocation, level 0 first.
+// Rows are tightly packed, subresource data can point straight into it.
+class MipChain
+{
+public:
+	struct Level
+	{
+		uint32_t width;
+		uint32_t height;
+		uint64_t rowPitch;
+		uint8_t* pData;
+	};
+
+	// levelCount 0 for the full chain down to 1x1
+	void Init(uint32_t width, uint32_t height, uint32_t levelCount = 0);
+
+	uint32_t GetLevelCount() const { return static_cast<uint32_t>(mLevels.size()); }
+	const Level& GetLevel(uint32_t level) const { return mLevels[level]; }
+	uint64_t GetSize() const { return mSize; }
+
+	static uint32_t GetFullLevelCount(uint32_t width, uint32_t height);
+
+private:
+	std::unique_ptr<uint8_t[]> mData;
+	uint64_t mSize = 0;
+	std::vector<Level> mLevels;
+};
+
+// Fills levels 1 and up of a chain from level 0. Every level is filtered from the one above in linear light,
+// separably, with colour channels decoded from sRGB first when srgb is set. Alpha is always linear.
+// Each level is split into bands of rows spread over the job system. The AVX2 kernels are used where available.
+class MipGenerator
+{
+public:
+	struct Settings
+	{
+		MipFilter filter = MipFilter::Box;
+		bool srgb = true;
+		bool allowAvx2 = true;
+	};
+
+	static void Generate(MipChain& chain, const Settings& settings, JobSystem* pJobSystem = nullptr);
+
+	// Output rows per job. Bands re-filter the few source rows they share with their neighbours.
+	static constexpr uint32_t RowsPerJob = 32;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+// Row kernels of MipGenerator, the AVX2 versions live in their own source built with AVX2 code generation.
+// Pixels are four floats, taps are tapCount source indices and weights per destination pixel or row.
+
+#include <cstdint>
+
+struct MipTaps
+{
+	uint32_t tapCount;
+	const uint32_t* pIndices;
+	const float* pWeights;
+};
+
+// 256 colour entries followed by 256 alpha entries
+void DecodeRowAvx2(const uint8_t* pSource, uint32_t width, const float* pDecodeTable, float* pDest);
+void FilterRowAvx2(const float* pSource, const MipTaps& taps, uint32_t destWidth, float* pDest);
+void FilterColumnsAvx2(const float* const* ppRows, const float* pWeights, uint32_t tapCount, uint32_t floatCount, float* pDest);
+// pEncodeTable maps linear colour scaled to [0, 65535] to sRGB, null encodes colour linearly
+void EncodeRowAvx2(const float* pSource, uint32_t width, const uint8_t* pEncodeTable, uint8_t* pDest);
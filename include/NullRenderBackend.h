@@ -0,0 +1,52 @@
+#pragma once
+
+#include "FrameLoop.h"
+#include "SimulatedFrameQueue.h"
+
+#include <deque>
+
+// A RenderBackend without a device or a window. Every frame costs a fixed CPU and GPU time on a
+// SimulatedFrameQueue, so the frame loop runs on any platform and its timing is deterministic.
+class NullRenderBackend : public RenderBackend
+{
+public:
+	NullRenderBackend(uint32_t frameCount, double cpuFrameTime, double gpuFrameTime);
+
+	void SetFrameTimes(double cpuFrameTime, double gpuFrameTime);
+
+	FrameQueue& GetFrameQueue() override { return mQueue; }
+	double GetTime() override { return mQueue.GetTime(); }
+	void Wait(double milliseconds) override;
+	void WaitForDisplay() override {}
+
+	void Update(uint64_t fenceValue) override;
+	void Render(uint32_t frameIndex, uint64_t fenceValue) override;
+	uint32_t Present(uint32_t frameIndex) override;
+	void Retire(uint64_t completedValue, std::vector<GpuFrame>& gpuFrames) override;
+
+	const SimulatedFrameQueue& GetQueue() const { return mQueue; }
+	uint32_t GetRenderedFrameCount() const { return mRenderedFrameCount; }
+	uint64_t GetRetiredValue() const { return mRetiredValue; }
+	// Frames rendered into a slot the GPU was still reading, or out of order. Always 0 unless the loop is broken.
+	uint32_t GetErrorCount() const { return mErrorCount; }
+
+private:
+	struct PendingFrame
+	{
+		uint32_t frameIndex;
+		GpuFrame gpuFrame;
+	};
+
+	SimulatedFrameQueue mQueue;
+	uint32_t mFrameCount;
+	double mCpuFrameTime;
+	double mGpuFrameTime;
+	// When the GPU is done with everything executed so far, as in the queue
+	double mGpuEnd;
+
+	std::deque<PendingFrame> mPending;
+	uint64_t mUpdatedValue;
+	uint64_t mRetiredValue;
+	uint32_t mRenderedFrameCount;
+	uint32_t mErrorCount;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "stdafx.h"
+#include "PipelineCacheFile.h"
+
+#include <mutex>
+
+using Microsoft::WRL::ComPtr;
+
+// Graphics pipelines keyed by a hash of their full description and kept across runs in an
+// ID3D12PipelineLibrary serialized to disk. The file is dropped when the adapter or driver changed.
+// Without pipeline library support it falls back to plain CreateGraphicsPipelineState.
+class PipelineCache
+{
+public:
+	void Init(ID3D12Device* pDevice, IDXGIAdapter* pAdapter, const std::wstring& path);
+
+	// rootSignatureHash stands in for desc.pRootSignature, hash the serialized root signature
+	ComPtr<ID3D12PipelineState> CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT64 rootSignatureHash);
+
+	// Writes the library back to disk when pipelines were added to it
+	void Save();
+
+	static UINT64 HashGraphicsPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT64 rootSignatureHash);
+
+private:
+	ComPtr<ID3D12Device> mDevice;
+	ComPtr<ID3D12PipelineLibrary> mLibrary;
+	std::wstring mPath;
+	PipelineCacheFile::Identity mIdentity = {};
+
+	// Backs the library, has to outlive it
+	std::vector<uint8_t> mFileData;
+
+	std::mutex mMutex;
+	bool mDirty = false;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// On-disk layout of the pipeline cache: a header identifying the adapter and driver the blob was
+// serialized with, followed by the opaque ID3D12PipelineLibrary blob.
+class PipelineCacheFile
+{
+public:
+	static const uint32_t Magic = 0x43505844; // "DXPC"
+	static const uint32_t Version = 1;
+
+	// Anything that changes here makes the cached blob useless
+	struct Identity
+	{
+		uint32_t vendorId;
+		uint32_t deviceId;
+		uint32_t subSysId;
+		uint32_t revision;
+		uint64_t driverVersion;
+	};
+
+	static std::vector<uint8_t> Write(const Identity& identity, const void* pBlob, uint64_t blobSize);
+
+	// Returns false when the file is truncated, corrupt or was written for another adapter or driver.
+	// On success [pBlob, pBlob + blobSize) points into data.
+	static bool Read(const std::vector<uint8_t>& data, const Identity& identity, const uint8_t*& pBlob, uint64_t& blobSize);
+
+private:
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		Identity identity;
+		uint64_t blobSize;
+		uint64_t blobHash;
+	};
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+// Waits with sub-millisecond accuracy: sleeps through most of the wait and spins the rest.
+// A high resolution waitable timer on Windows keeps the spinning short, elsewhere the OS sleep is used.
+class PreciseTimer
+{
+public:
+	PreciseTimer();
+	~PreciseTimer();
+
+	PreciseTimer(const PreciseTimer&) = delete;
+	PreciseTimer& operator=(const PreciseTimer&) = delete;
+
+	void Wait(double milliseconds);
+
+private:
+	// Time left to spin, sleeps may overshoot by about this much
+	double mSpinThreshold;
+
+#ifdef _WIN32
+	void* mTimer = nullptr;
+#endif
+};
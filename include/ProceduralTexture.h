@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+class JobSystem;
+
+enum class ProceduralPattern
+{
+	Checker,
+	LinearGradient,
+	RadialGradient,
+	ValueNoise,
+	PerlinNoise,
+	SimplexNoise
+};
+
+struct ProceduralTextureDesc
+{
+	ProceduralPattern pattern = ProceduralPattern::Checker;
+	uint32_t width = 256;
+	uint32_t height = 256;
+
+	// RGBA8 with R in the low byte, patterns blend from colorA at 0 to colorB at 1
+	uint32_t colorA = 0xFF000000;
+	uint32_t colorB = 0xFFFFFFFF;
+
+	// Checker, in pixels
+	uint32_t cellWidth = 32;
+	uint32_t cellHeight = 32;
+
+	// Linear gradient direction in radians, 0 runs left to right
+	float angle = 0.0f;
+
+	// Noise lattice cells across the texture. More than one octave sums fractal Brownian motion,
+	// every octave scaling the frequency by lacunarity and the amplitude by gain.
+	float frequency = 8.0f;
+	uint32_t octaves = 1;
+	float lacunarity = 2.0f;
+	float gain = 0.5f;
+	uint32_t seed = 0;
+};
+
+// Fills RGBA8 textures with procedural patterns, whole rows at a time with the widest SIMD kernel the CPU runs:
+// AVX2, SSE4.1, NEON or scalar. Every backend produces the same pixels up to rounding in the last bit.
+class ProceduralTexture
+{
+public:
+	enum class Isa
+	{
+		Scalar,
+		Sse41,
+		Avx2,
+		Neon
+	};
+
+	// Best the build and the CPU support
+	static Isa GetBestIsa();
+	static bool IsSupported(Isa isa);
+	static const char* GetIsaName(Isa isa);
+
+	// pDest addresses row 0, rows are rowPitch bytes apart, an upload footprint for instance.
+	// Bands of rows are spread over pJobSystem when there is one.
+	static void Generate(const ProceduralTextureDesc& desc, void* pDest, uint64_t rowPitch, JobSystem* pJobSystem = nullptr);
+
+	// Rows [firstRow, firstRow + rowCount) with a given kernel, pDest still addresses row 0. isa must be supported.
+	static void GenerateRows(const ProceduralTextureDesc& desc, uint32_t firstRow, uint32_t rowCount, void* pDest, uint64_t rowPitch, Isa isa);
+
+	static const uint32_t RowsPerJob = 16;
+};
@@ -0,0 +1,283 @@
+#pragma once
+
+// Pattern kernels shared by the per instruction set sources of ProceduralTexture, not meant to be included elsewhere.
+// V wraps one SIMD width: F holds floats, I unsigned 32 bit lanes, masks are all ones or zero per lane.
+
+#include "ProceduralTexture.h"
+
+#include <cmath>
+#include <cstdint>
+
+template<typename V>
+struct ProceduralKernels
+{
+	using F = typename V::F;
+	using I = typename V::I;
+
+	// Integer lattice hash, cheap enough to beat a permutation table once there is no gather
+	static I Hash(I x, I y, I seed)
+	{
+		I h = V::Xor(V::Xor(V::MulI(x, V::SetI(0x27d4eb2du)), V::MulI(y, V::SetI(0x165667b1u))), seed);
+		h = V::Xor(h, V::template ShiftRight<15>(h));
+		h = V::MulI(h, V::SetI(0x2c1b3c6du));
+		h = V::Xor(h, V::template ShiftRight<12>(h));
+		h = V::MulI(h, V::SetI(0x297a2d39u));
+		return V::Xor(h, V::template ShiftRight<15>(h));
+	}
+
+	// [0, 1) from the top 24 bits
+	static F HashToUnit(I h)
+	{
+		return V::Mul(V::ToFloat(V::template ShiftRight<8>(h)), V::Set(1.0f / 16777216.0f));
+	}
+
+	// Quintic, zero first and second derivative at the lattice points
+	static F Fade(F t)
+	{
+		const F inner = V::Add(V::Mul(t, V::Sub(V::Mul(t, V::Set(6.0f)), V::Set(15.0f))), V::Set(10.0f));
+		return V::Mul(V::Mul(V::Mul(t, t), t), inner);
+	}
+
+	static F Lerp(F a, F b, F t)
+	{
+		return V::Add(a, V::Mul(V::Sub(b, a), t));
+	}
+
+	// Dot with one of the four diagonals (+-1, +-1), hash bits flip the signs
+	static F Grad(I h, F x, F y)
+	{
+		const F signedX = V::FlipSign(x, V::template ShiftLeft<31>(h));
+		const F signedY = V::FlipSign(y, V::template ShiftLeft<30>(h));
+		return V::Add(signedX, signedY);
+	}
+
+	// The noise functions return [-1, 1]
+	static F ValueNoise(F x, F y, I seed)
+	{
+		const F x0 = V::Floor(x);
+		const F y0 = V::Floor(y);
+		const I ix = V::ToInt(x0);
+		const I iy = V::ToInt(y0);
+		const I one = V::SetI(1);
+		const F u = Fade(V::Sub(x, x0));
+		const F v = Fade(V::Sub(y, y0));
+
+		const F top = Lerp(HashToUnit(Hash(ix, iy, seed)), HashToUnit(Hash(V::AddI(ix, one), iy, seed)), u);
+		const F bottom = Lerp(HashToUnit(Hash(ix, V::AddI(iy, one), seed)), HashToUnit(Hash(V::AddI(ix, one), V::AddI(iy, one), seed)), u);
+		return V::Sub(V::Mul(Lerp(top, bottom, v), V::Set(2.0f)), V::Set(1.0f));
+	}
+
+	static F PerlinNoise(F x, F y, I seed)
+	{
+		const F x0 = V::Floor(x);
+		const F y0 = V::Floor(y);
+		const I ix = V::ToInt(x0);
+		const I iy = V::ToInt(y0);
+		const I one = V::SetI(1);
+		const F fx = V::Sub(x, x0);
+		const F fy = V::Sub(y, y0);
+		const F fx1 = V::Sub(fx, V::Set(1.0f));
+		const F fy1 = V::Sub(fy, V::Set(1.0f));
+		const F u = Fade(fx);
+		const F v = Fade(fy);
+
+		const F top = Lerp(Grad(Hash(ix, iy, seed), fx, fy), Grad(Hash(V::AddI(ix, one), iy, seed), fx1, fy), u);
+		const F bottom = Lerp(Grad(Hash(ix, V::AddI(iy, one), seed), fx, fy1), Grad(Hash(V::AddI(ix, one), V::AddI(iy, one), seed), fx1, fy1), u);
+		return Lerp(top, bottom, v);
+	}
+
+	static F SimplexCorner(I h, F x, F y)
+	{
+		const F t = V::Max(V::Sub(V::Set(0.5f), V::Add(V::Mul(x, x), V::Mul(y, y))), V::Set(0.0f));
+		const F t2 = V::Mul(t, t);
+		return V::Mul(V::Mul(t2, t2), Grad(h, x, y));
+	}
+
+	static F SimplexNoise(F x, F y, I seed)
+	{
+		const float skew = 0.36602540378f;
+		const float unskew = 0.21132486540f;
+
+		const F s = V::Mul(V::Add(x, y), V::Set(skew));
+		const F i = V::Floor(V::Add(x, s));
+		const F j = V::Floor(V::Add(y, s));
+		const F t = V::Mul(V::Add(i, j), V::Set(unskew));
+		const F x0 = V::Sub(x, V::Sub(i, t));
+		const F y0 = V::Sub(y, V::Sub(j, t));
+
+		// Lower or upper triangle of the skewed cell
+		const I lower = V::Greater(x0, y0);
+		const F i1 = V::Select(lower, V::Set(1.0f), V::Set(0.0f));
+		const F j1 = V::Sub(V::Set(1.0f), i1);
+
+		const F x1 = V::Add(V::Sub(x0, i1), V::Set(unskew));
+		const F y1 = V::Add(V::Sub(y0, j1), V::Set(unskew));
+		const F x2 = V::Add(x0, V::Set(2.0f * unskew - 1.0f));
+		const F y2 = V::Add(y0, V::Set(2.0f * unskew - 1.0f));
+
+		const I ii = V::ToInt(i);
+		const I jj = V::ToInt(j);
+		const I one = V::SetI(1);
+		const F n0 = SimplexCorner(Hash(ii, jj, seed), x0, y0);
+		const F n1 = SimplexCorner(Hash(V::AddI(ii, V::ToInt(i1)), V::AddI(jj, V::ToInt(j1)), seed), x1, y1);
+		const F n2 = SimplexCorner(Hash(V::AddI(ii, one), V::AddI(jj, one), seed), x2, y2);
+
+		// The sum peaks a little over 1/70 with diagonal gradients
+		return V::Mul(V::Add(V::Add(n0, n1), n2), V::Set(SimplexScale));
+	}
+
+	static constexpr float SimplexScale = 70.0f;
+
+	static F Noise(const ProceduralTextureDesc& desc, F x, F y)
+	{
+		F sum = V::Set(0.0f);
+		float amplitude = 1.0f;
+		float total = 0.0f;
+		F octaveX = x;
+		F octaveY = y;
+		const uint32_t octaves = desc.octaves > 0 ? desc.octaves : 1;
+
+		for (uint32_t octave = 0; octave < octaves; octave++)
+		{
+			// Every octave gets its own lattice so they don't line up at the origin
+			const I seed = V::SetI(desc.seed + octave * 0x9E3779B9u);
+			F n;
+			switch (desc.pattern)
+			{
+			case ProceduralPattern::ValueNoise: n = ValueNoise(octaveX, octaveY, seed); break;
+			case ProceduralPattern::PerlinNoise: n = PerlinNoise(octaveX, octaveY, seed); break;
+			default: n = SimplexNoise(octaveX, octaveY, seed); break;
+			}
+
+			sum = V::Add(sum, V::Mul(n, V::Set(amplitude)));
+			total += amplitude;
+			amplitude *= desc.gain;
+			octaveX = V::Mul(octaveX, V::Set(desc.lacunarity));
+			octaveY = V::Mul(octaveY, V::Set(desc.lacunarity));
+		}
+
+		return V::Add(V::Mul(sum, V::Set(0.5f / total)), V::Set(0.5f));
+	}
+
+	// 1 on odd cells
+	static I CheckerParity(const ProceduralTextureDesc& desc, F px, uint32_t y)
+	{
+		const uint32_t cellY = y / (desc.cellHeight ? desc.cellHeight : 1);
+		const I cellX = V::ToInt(V::Floor(V::Mul(px, V::Set(1.0f / (desc.cellWidth ? desc.cellWidth : 1)))));
+		return V::And(V::AddI(cellX, V::SetI(cellY)), V::SetI(1));
+	}
+
+	// Blend factor of V::Width pixels starting at column x
+	static F Pattern(const ProceduralTextureDesc& desc, uint32_t x, uint32_t y)
+	{
+		const F px = V::Add(V::Ramp(), V::Set(static_cast<float>(x) + 0.5f));
+		const float py = static_cast<float>(y) + 0.5f;
+
+		switch (desc.pattern)
+		{
+		case ProceduralPattern::Checker:
+			return V::ToFloat(CheckerParity(desc, px, y));
+		case ProceduralPattern::LinearGradient:
+		{
+			const float dirX = std::cos(desc.angle) / desc.width;
+			const float dirY = std::sin(desc.angle) / desc.height;
+			const float offset = 0.5f - 0.5f * desc.width * dirX + (py - 0.5f * desc.height) * dirY;
+			return V::Min(V::Max(V::Add(V::Mul(px, V::Set(dirX)), V::Set(offset)), V::Set(0.0f)), V::Set(1.0f));
+		}
+		case ProceduralPattern::RadialGradient:
+		{
+			const float radius = 0.5f * static_cast<float>(desc.width < desc.height ? desc.width : desc.height);
+			const F dx = V::Sub(px, V::Set(0.5f * desc.width));
+			const float dy = py - 0.5f * desc.height;
+			const F distance = V::Sqrt(V::Add(V::Mul(dx, dx), V::Set(dy * dy)));
+			return V::Min(V::Mul(distance, V::Set(1.0f / radius)), V::Set(1.0f));
+		}
+		default:
+		{
+			const float scaleX = desc.frequency / desc.width;
+			const float scaleY = desc.frequency / desc.height;
+			const F t = Noise(desc, V::Mul(px, V::Set(scaleX)), V::Set(py * scaleY));
+			return V::Min(V::Max(t, V::Set(0.0f)), V::Set(1.0f));
+		}
+		}
+	}
+
+	static I Channel(F t, uint32_t a, uint32_t b, uint32_t shift)
+	{
+		const float from = static_cast<float>((a >> shift) & 0xFF);
+		const float to = static_cast<float>((b >> shift) & 0xFF);
+		return V::ToInt(V::Add(V::Add(V::Mul(t, V::Set(to - from)), V::Set(from)), V::Set(0.5f)));
+	}
+
+	static I Pack(const ProceduralTextureDesc& desc, F t)
+	{
+		const I r = Channel(t, desc.colorA, desc.colorB, 0);
+		const I g = V::template ShiftLeft<8>(Channel(t, desc.colorA, desc.colorB, 8));
+		const I b = V::template ShiftLeft<16>(Channel(t, desc.colorA, desc.colorB, 16));
+		const I a = V::template ShiftLeft<24>(Channel(t, desc.colorA, desc.colorB, 24));
+		return V::Or(V::Or(r, g), V::Or(b, a));
+	}
+
+	// Columns [firstColumn, width) of row y, pRow addresses column 0. Returns the first column left for a narrower kernel.
+	static uint32_t Row(const ProceduralTextureDesc& desc, uint32_t y, uint32_t firstColumn, uint32_t* pRow)
+	{
+		uint32_t x = firstColumn;
+
+		// Only two colors, picked with a mask instead of blending every channel
+		if (desc.pattern == ProceduralPattern::Checker)
+		{
+			const I colorA = V::SetI(desc.colorA);
+			const I difference = V::SetI(desc.colorA ^ desc.colorB);
+			for (; x + V::Width <= desc.width; x += V::Width)
+			{
+				const F px = V::Add(V::Ramp(), V::Set(static_cast<float>(x) + 0.5f));
+				const I mask = V::SubI(V::SetI(0), CheckerParity(desc, px, y));
+				V::Store(pRow + x, V::Xor(colorA, V::And(difference, mask)));
+			}
+			return x;
+		}
+
+		for (; x + V::Width <= desc.width; x += V::Width)
+		{
+			V::Store(pRow + x, Pack(desc, Pattern(desc, x, y)));
+		}
+		return x;
+	}
+};
+
+// One lane, finishes the columns the vector kernels leave over
+struct ScalarVec
+{
+	using F = float;
+	using I = uint32_t;
+	static const uint32_t Width = 1;
+
+	static F Set(float value) { return value; }
+	static I SetI(uint32_t value) { return value; }
+	static F Ramp() { return 0.0f; }
+	static F Add(F a, F b) { return a + b; }
+	static F Sub(F a, F b) { return a - b; }
+	static F Mul(F a, F b) { return a * b; }
+	static F Min(F a, F b) { return a < b ? a : b; }
+	static F Max(F a, F b) { return a > b ? a : b; }
+	static F Floor(F a) { return std::floor(a); }
+	static F Sqrt(F a) { return std::sqrt(a); }
+	static I ToInt(F a) { return static_cast<uint32_t>(static_cast<int32_t>(a)); }
+	static F ToFloat(I a) { return static_cast<float>(static_cast<int32_t>(a)); }
+	static I AddI(I a, I b) { return a + b; }
+	static I SubI(I a, I b) { return a - b; }
+	static I MulI(I a, I b) { return a * b; }
+	static I And(I a, I b) { return a & b; }
+	static I Or(I a, I b) { return a | b; }
+	static I Xor(I a, I b) { return a ^ b; }
+	template<int N> static I ShiftLeft(I a) { return a << N; }
+	template<int N> static I ShiftRight(I a) { return a >> N; }
+	static I Greater(F a, F b) { return a > b ? ~0u : 0u; }
+	static F Select(I mask, F a, F b) { return mask ? a : b; }
+	// Flips where the sign bit of bits is set, other bits are ignored
+	static F FlipSign(F a, I bits)
+	{
+		return (bits & 0x80000000u) ? -a : a;
+	}
+	static void Store(uint32_t* pDest, I value) { *pDest = value; }
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ProfileTree.h"
+
+#include <unordered_map>
+
+// Rolling timings per scope over the last windowSize frames, scopes are told apart by their path in the tree.
+// Scopes appearing several times in a frame, one per command list for instance, count as their total.
+class ProfileStats
+{
+public:
+	// Milliseconds
+	struct Summary
+	{
+		const char* name;
+		uint32_t depth;
+		uint32_t sampleCount;
+		double last;
+		double min;
+		double avg;
+		double p99;
+	};
+
+	explicit ProfileStats(uint32_t windowSize = 256);
+
+	// ticksPerSecond converts the node times
+	void AddFrame(const std::vector<ProfileNode>& nodes, uint64_t ticksPerSecond);
+
+	// In the order scopes were first seen, which is tree order for a stable frame
+	void GetSummaries(std::vector<Summary>& summaries) const;
+
+	// Root scope lookup, false when it was never seen
+	bool GetSummary(const char* rootName, Summary& summary) const;
+
+	void Reset();
+
+private:
+	struct Series
+	{
+		const char* name;
+		uint32_t depth;
+		uint32_t next;
+		uint32_t count;
+		uint64_t lastFrame;
+		std::vector<double> samples;
+	};
+
+	Summary Summarize(const Series& series) const;
+
+	uint32_t mWindowSize;
+	uint64_t mFrame = 0;
+	std::unordered_map<uint64_t, uint32_t> mSeriesIndices;
+	std::vector<Series> mSeries;
+	mutable std::vector<double> mScratch;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One timed scope as captured, GPU timestamps or CPU ticks. Names are not copied and must outlive the profile.
+struct ProfileEvent
+{
+	const char* name;
+	uint64_t begin;
+	uint64_t end;
+};
+
+struct ProfileNode
+{
+	static const uint32_t InvalidParent = ~0u;
+
+	const char* name;
+	uint64_t begin;
+	uint64_t end;
+	uint32_t parent;
+	uint32_t depth;
+	// Hash of the names from the root down, identifies the scope across frames
+	uint64_t pathHash;
+};
+
+// Rebuilds the scope hierarchy of a frame from timing alone: a scope's parent is the innermost scope
+// enclosing it. Works whatever order the scopes were recorded in, scopes of command lists recorded
+// in parallel included, they are serialized on the queue.
+class ProfileTree
+{
+public:
+	// Nodes come out in depth-first order. Events ending before they begin, unresolved queries, are dropped.
+	static void Build(const ProfileEvent* pEvents, size_t eventCount, std::vector<ProfileNode>& nodes);
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "stdafx.h"
+#include "FrameRing.h"
+
+using Microsoft::WRL::ComPtr;
+
+// A command queue and the fence it signals, the D3D12 timeline behind the renderer's FrameRing
+class QueueFence : public FrameQueue
+{
+public:
+	QueueFence();
+	~QueueFence();
+
+	void Init(ID3D12Device* pDevice, ID3D12CommandQueue* pQueue);
+
+	void Signal(uint64_t fenceValue) override;
+	uint64_t GetCompletedValue() override;
+	void Wait(uint64_t fenceValue) override;
+
+	ID3D12Fence* GetFence() const { return mFence.Get(); }
+
+private:
+	ComPtr<ID3D12CommandQueue> mQueue;
+	ComPtr<ID3D12Fence> mFence;
+	HANDLE mEvent;
+};
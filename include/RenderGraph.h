@@ -0,0 +1,134 @@
+#pragma once
+
+#include "stdafx.h"
+#include "CommandListPool.h"
+#include "RenderGraphCompiler.h"
+#include "ResourceStateTracker.h"
+
+#include <functional>
+
+using Microsoft::WRL::ComPtr;
+
+typedef uint32_t RenderGraphHandle;
+
+class RenderGraph;
+
+// What a pass gets to record with. Commands go into GetCommandList(), which already holds the pass barriers.
+// Passes recording in parallel add their own closed lists, they run right after GetCommandList() in the order added.
+class RenderPassContext
+{
+public:
+	ID3D12GraphicsCommandList* GetCommandList() const { return mpCommandList; }
+	ID3D12Resource* GetResource(RenderGraphHandle handle) const;
+	void AddCommandList(ID3D12CommandList* pCommandList) { mCommandLists.push_back(pCommandList); }
+
+private:
+	friend class RenderGraph;
+
+	const RenderGraph* mpGraph = nullptr;
+	ID3D12GraphicsCommandList* mpCommandList = nullptr;
+	std::vector<ID3D12CommandList*> mCommandLists;
+};
+
+// Declarative frame: passes state which resources they read and write and in which state,
+// the graph orders and culls them, places transient resources in shared heaps where their lifetimes
+// don't overlap and records every barrier. Rebuild it every frame, transients are kept as long as the layout holds.
+class RenderGraph
+{
+public:
+	typedef std::function<void(RenderPassContext& context)> ExecuteFunc;
+
+	class PassBuilder
+	{
+	public:
+		PassBuilder& Read(RenderGraphHandle handle, D3D12_RESOURCE_STATES state);
+		PassBuilder& Write(RenderGraphHandle handle, D3D12_RESOURCE_STATES state);
+
+	private:
+		friend class RenderGraph;
+
+		PassBuilder(RenderGraph* pGraph, uint32_t pass) : mpGraph(pGraph), mPass(pass) {}
+
+		RenderGraph* mpGraph;
+		uint32_t mPass;
+	};
+
+	void Init(ID3D12Device* pDevice);
+
+	// Starts a new graph, handles from the previous one become invalid
+	void Reset();
+
+	// Imported resources keep their state across graphs through the tracker, finalState is the state to leave them in
+	RenderGraphHandle ImportResource(ID3D12Resource* pResource);
+	RenderGraphHandle ImportResource(ID3D12Resource* pResource, D3D12_RESOURCE_STATES finalState);
+	RenderGraphHandle CreateResource(const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* pClearValue = nullptr);
+
+	// Passes that write no imported resource and feed no other pass are culled unless they have side effects
+	PassBuilder AddPass(ExecuteFunc execute, bool hasSideEffects = false);
+
+	// Records the surviving passes with lists from pool. Imported resources are transitioned through tracker,
+	// which leaves their first transitions pending. fenceValue is signaled once the lists have executed.
+	void Execute(CommandListPool& pool, ResourceStateTracker& tracker, UINT64 fenceValue, std::vector<ID3D12CommandList*>& commandLists);
+
+	// Frees transient heaps replaced by a layout change once the GPU is done with them
+	void Retire(UINT64 completedFenceValue);
+
+	ID3D12Resource* GetResource(RenderGraphHandle handle) const { return mResources[handle].pResource; }
+	const RenderGraphCompiler::Result& GetCompileResult() const { return mCompiled; }
+
+private:
+	enum HeapClass
+	{
+		RenderTargetHeap,
+		TextureHeap,
+		BufferHeap,
+		HeapClassCount
+	};
+
+	struct GraphResource
+	{
+		ID3D12Resource* pResource;
+		bool imported;
+		// Transients only
+		D3D12_RESOURCE_DESC desc;
+		D3D12_CLEAR_VALUE clearValue;
+		bool hasClearValue;
+	};
+
+	// Placed transient, reused every frame as long as the graph keeps the same layout
+	struct Transient
+	{
+		ComPtr<ID3D12Resource> resource;
+		D3D12_RESOURCE_DESC desc;
+		UINT64 heapOffset;
+		HeapClass heapClass;
+		D3D12_RESOURCE_STATES state;
+	};
+
+	struct RetiredHeaps
+	{
+		std::vector<ComPtr<ID3D12Heap>> heaps;
+		std::vector<Transient> transients;
+		UINT64 fenceValue;
+	};
+
+	static HeapClass GetHeapClass(const D3D12_RESOURCE_DESC& desc);
+	static bool SameDesc(const D3D12_RESOURCE_DESC& a, const D3D12_RESOURCE_DESC& b);
+	RenderGraphHandle AddImported(ID3D12Resource* pResource, uint32_t finalState);
+	bool LayoutMatches() const;
+	void CreateTransients();
+	void RecordBarriers(ResourceStateTracker& tracker, ID3D12GraphicsCommandList* pCommandList, uint32_t position);
+
+	ComPtr<ID3D12Device> mDevice;
+
+	RenderGraphCompiler mCompiler;
+	RenderGraphCompiler::Result mCompiled;
+	std::vector<GraphResource> mResources;
+	std::vector<ExecuteFunc> mPasses;
+
+	// Indexed like mResources for the transients of the current layout
+	std::vector<Transient> mTransients;
+	ComPtr<ID3D12Heap> mHeaps[HeapClassCount];
+	UINT64 mLastFenceValue = 0;
+	std::vector<RetiredHeaps> mRetiredHeaps;
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// API independent half of the render graph. Passes declare which resources they read and write,
+// Compile orders them, culls the ones nothing depends on, works out transient lifetimes,
+// packs transients with disjoint lifetimes into the same memory and lists the barriers each pass needs.
+// States are opaque bit masks, reads of a resource in consecutive passes are merged into one combined state.
+// A pass that writes a resource must use it in that one state, a write can't be combined with other states.
+class RenderGraphCompiler
+{
+public:
+	static constexpr uint32_t InvalidIndex = ~0u;
+	static constexpr uint32_t InvalidState = ~0u;
+
+	struct Resource
+	{
+		// Transient resources only, memory requirements
+		uint64_t size;
+		uint64_t alignment;
+		// Transients only share memory with transients of the same heap class
+		uint32_t heapClass;
+		bool imported;
+		// Imported resources only, state to leave the resource in, InvalidState keeps the last one used
+		uint32_t finalState;
+	};
+
+	struct Barrier
+	{
+		enum class Type
+		{
+			Transition,
+			Aliasing
+		};
+
+		Type type;
+		uint32_t resource;
+		// Transition: state required from here on
+		uint32_t state;
+		// Aliasing: the transient that used the memory before, InvalidIndex when there are several
+		uint32_t resourceBefore;
+	};
+
+	struct Result
+	{
+		// Passes that survived culling, in execution order
+		std::vector<uint32_t> passOrder;
+
+		// Barriers of passOrder[i] are [barrierOffsets[i], barrierOffsets[i + 1]),
+		// the last range holds the final transitions of imported resources, recorded after every pass
+		std::vector<Barrier> barriers;
+		std::vector<uint32_t> barrierOffsets;
+
+		// Per resource, positions in passOrder, InvalidIndex when unused
+		std::vector<uint32_t> firstUse;
+		std::vector<uint32_t> lastUse;
+		// Per resource, state once the graph ran, InvalidState when unused
+		std::vector<uint32_t> finalStates;
+		// Per transient, offset inside the heap of its class, and whether it shares memory with another transient
+		std::vector<uint64_t> heapOffsets;
+		std::vector<bool> aliased;
+
+		// Per heap class
+		std::vector<uint64_t> heapSizes;
+	};
+
+	uint32_t AddResource(const Resource& resource);
+
+	// Passes that write an imported resource or have side effects are never culled
+	uint32_t AddPass(bool hasSideEffects);
+	void AddUse(uint32_t pass, uint32_t resource, uint32_t state, bool write);
+
+	// Returns false, leaving result partially filled, when a pass uses a resource it writes in more than one state
+	bool Compile(Result& result);
+
+	// Drops every pass and resource, keeps the storage
+	void Reset();
+
+	uint32_t GetResourceCount() const { return static_cast<uint32_t>(mResources.size()); }
+	uint32_t GetPassCount() const { return static_cast<uint32_t>(mPassSideEffects.size()); }
+
+private:
+	struct Use
+	{
+		uint32_t pass;
+		uint32_t resource;
+		uint32_t state;
+		bool write;
+	};
+
+	struct Edge
+	{
+		uint32_t from;
+		uint32_t to;
+		// Read after write or write after write, the only edges that keep a producer alive
+		bool producer;
+	};
+
+	struct Placement
+	{
+		uint32_t resource;
+		uint64_t begin;
+		uint64_t end;
+	};
+
+	struct PositionedBarrier
+	{
+		uint32_t position;
+		Barrier barrier;
+	};
+
+	void BuildEdges();
+	bool ValidateUses() const;
+	void CullPasses();
+	void SortPasses(Result& result);
+	void ComputeLifetimes(Result& result);
+	void AliasTransients(Result& result);
+	void ComputeBarriers(Result& result);
+
+	std::vector<Resource> mResources;
+	std::vector<bool> mPassSideEffects;
+	std::vector<Use> mUses;
+
+	// Scratch, kept between compilations to avoid reallocating every frame
+	std::vector<uint32_t> mCursors;
+	std::vector<uint32_t> mPassUseOffsets;
+	std::vector<Use> mPassUses;
+	std::vector<uint32_t> mLastWriters;
+	std::vector<std::vector<uint32_t>> mReaders;
+	std::vector<Edge> mEdges;
+	std::vector<uint32_t> mPredecessorOffsets;
+	std::vector<Edge> mPredecessors;
+	std::vector<uint32_t> mSuccessorOffsets;
+	std::vector<uint32_t> mSuccessors;
+	std::vector<bool> mPassAlive;
+	std::vector<uint32_t> mInDegrees;
+	std::vector<uint32_t> mPositionOfPass;
+	std::vector<uint32_t> mClassResources;
+	std::vector<Placement> mPlacements;
+	std::vector<Placement> mOverlaps;
+	std::vector<PositionedBarrier> mPositionedBarriers;
+	std::vector<uint32_t> mResourceUseOffsets;
+	std::vector<Use> mResourceUses;
+};
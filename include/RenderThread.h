@@ -0,0 +1,59 @@
+#pragma once
+
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+// Input forwarded from the window thread
+struct WindowEvent
+{
+	enum Type : uint32_t
+	{
+		KeyDown,
+		KeyUp
+	};
+
+	Type type;
+	uint32_t key;
+};
+
+// Runs frames on a thread of its own so the window thread only pumps messages. Events posted by the window
+// thread go through a lock free queue and are handed to the event function at the start of the next frame.
+class RenderThread
+{
+public:
+	using FrameFunc = std::function<void()>;
+	using EventFunc = std::function<void(const WindowEvent& event)>;
+
+	static const uint32_t EventQueueCapacity = 256;
+
+	RenderThread();
+	~RenderThread();
+
+	RenderThread(const RenderThread&) = delete;
+	RenderThread& operator=(const RenderThread&) = delete;
+
+	void Start(FrameFunc frameFunc, EventFunc eventFunc);
+
+	// Window thread only. Yields while the queue is full, input is never dropped as long as frames run.
+	void Post(const WindowEvent& event);
+
+	// Returns once the frame in progress finished, events still queued are discarded
+	void Stop();
+
+	bool IsRunning() const { return mThread.joinable(); }
+	uint64_t GetFrameCount() const { return mFrameCount.load(std::memory_order_relaxed); }
+
+private:
+	void Main();
+
+	SpscQueue<WindowEvent> mEvents;
+	FrameFunc mFrameFunc;
+	EventFunc mEventFunc;
+	std::atomic<bool> mStopRequested{ false };
+	std::atomic<uint64_t> mFrameCount{ 0 };
+	std::thread mThread;
+};
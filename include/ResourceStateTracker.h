@@ -0,0 +1,59 @@
+#pragma once
+
+#include "stdafx.h"
+#include "TransitionTracker.h"
+
+#include <mutex>
+
+// Tracks resource states per command list and turns transitions into batched barriers, see TransitionTracker.
+// States are tracked per subresource (mip and array slice, planes are not tracked separately).
+//
+// A transition whose before state is unknown while recording (first use in this command list) is kept
+// as pending and resolved against the global state at submission time:
+//   ResourceStateTracker::Lock();
+//   tracker.FlushPendingResourceBarriers(pPendingList);
+//   tracker.CommitFinalResourceStates();
+//   ResourceStateTracker::Unlock();
+// with pPendingList executed right before the tracked list.
+class ResourceStateTracker
+{
+public:
+	ResourceStateTracker();
+
+	// Queues a transition, FlushResourceBarriers must be called before the resource is used
+	void TransitionResource(ID3D12Resource* pResource, D3D12_RESOURCE_STATES stateAfter, UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+	// Declares the state a resource is in at this point without a barrier, for resources whose state the caller
+	// tracks itself (aliased transients), so the next transition is recorded here instead of left pending
+	void SetResourceState(ID3D12Resource* pResource, D3D12_RESOURCE_STATES state);
+	void UAVBarrier(ID3D12Resource* pResource = nullptr);
+	void AliasBarrier(ID3D12Resource* pResourceBefore = nullptr, ID3D12Resource* pResourceAfter = nullptr);
+
+	// Issues every queued barrier in a single call
+	void FlushResourceBarriers(ID3D12GraphicsCommandList* pCommandList);
+
+	// Global lock must be held. Returns the number of barriers recorded on pCommandList.
+	UINT FlushPendingResourceBarriers(ID3D12GraphicsCommandList* pCommandList);
+	void CommitFinalResourceStates();
+
+	// Forget everything recorded, for reuse with the next command list
+	void Reset();
+
+	static void Lock();
+	static void Unlock();
+
+	static void AddGlobalResourceState(ID3D12Resource* pResource, D3D12_RESOURCE_STATES state);
+	static void RemoveGlobalResourceState(ID3D12Resource* pResource);
+
+	// Emit enhanced barriers (ID3D12GraphicsCommandList7::Barrier) instead of ResourceBarrier where possible
+	static void SetUseEnhancedBarriers(bool useEnhancedBarriers);
+
+private:
+	static uint32_t GetSubresourceCount(TransitionTracker::Resource resource);
+	static void EmitBarriers(ID3D12GraphicsCommandList* pCommandList, const std::vector<TransitionTracker::Barrier>& trackedBarriers);
+
+	TransitionTracker mTransitions;
+
+	static std::mutex sGlobalMutex;
+	static TransitionTracker::StateMap sGlobalStates;
+	static bool sUseEnhancedBarriers;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+// Offset-only ring sub-allocator. Allocations are grouped into batches which are freed together
+// once the fence value the batch was tagged with has completed, oldest first.
+class RingAllocator
+{
+public:
+	static const uint64_t InvalidOffset = ~0ull;
+
+	explicit RingAllocator(uint64_t capacity = 0);
+
+	void Reset(uint64_t capacity);
+
+	// Alignment must be a power of two. Returns InvalidOffset when the ring has no room left.
+	uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+	// Tags everything allocated since the previous call with fenceValue
+	void FinishBatch(uint64_t fenceValue);
+
+	// Frees every batch whose fence value is lower than or equal to completedFenceValue
+	void Retire(uint64_t completedFenceValue);
+
+	uint64_t GetCapacity() const { return mCapacity; }
+	uint64_t GetUsedSize() const { return mUsedSize; }
+
+private:
+	struct Batch
+	{
+		uint64_t fenceValue;
+		uint64_t end;
+		uint64_t size;
+	};
+
+	std::deque<Batch> mBatches;
+	uint64_t mCapacity;
+	uint64_t mHead;
+	uint64_t mTail;
+	uint64_t mUsedSize;
+	uint64_t mPendingSize;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "stdafx.h"
+#include "LinearArena.h"
+#include "RootSignatureStoreFile.h"
+
+#include <mutex>
+#include <unordered_map>
+
+using Microsoft::WRL::ComPtr;
+
+// Root signatures keyed by a hash of their description. Identical descriptions share one root signature,
+// and serialized blobs are kept on disk so later runs create them without serializing.
+// When the device only supports 1.0, 1.1 descriptions are converted in a scratch arena, not on the heap.
+class RootSignatureRegistry
+{
+public:
+	void Init(ID3D12Device* pDevice, const std::wstring& path);
+
+	// Versions 1.0 and 1.1. pHash receives the key of the root signature, usable as PipelineCache's rootSignatureHash.
+	ComPtr<ID3D12RootSignature> GetOrCreate(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC& desc, UINT64* pHash = nullptr);
+
+	// Writes the store back to disk when blobs were added to it
+	void Save();
+
+	// Includes the version the description serializes to, the same description gives different blobs
+	static UINT64 HashRootSignatureDesc(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC& desc, D3D_ROOT_SIGNATURE_VERSION serializedVersion);
+
+private:
+	struct StoredBlob
+	{
+		const void* pData;
+		SIZE_T size;
+	};
+
+	ComPtr<ID3DBlob> Serialize(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC& desc, D3D_ROOT_SIGNATURE_VERSION version);
+	const D3D12_ROOT_SIGNATURE_DESC& ConvertTo_1_0(const D3D12_ROOT_SIGNATURE_DESC1& desc);
+
+	ComPtr<ID3D12Device> mDevice;
+	std::wstring mPath;
+	D3D_ROOT_SIGNATURE_VERSION mHighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
+
+	std::mutex mMutex;
+	std::unordered_map<UINT64, ComPtr<ID3D12RootSignature>> mRootSignatures;
+	std::unordered_map<UINT64, StoredBlob> mBlobs;
+
+	// Backs the blobs read from disk, and the ones serialized since
+	std::vector<uint8_t> mFileData;
+	std::vector<ComPtr<ID3DBlob>> mSerializedBlobs;
+	bool mDirty = false;
+
+	LinearArena mArena;
+	D3D12_ROOT_SIGNATURE_DESC mConvertedDesc = {};
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// On-disk layout of the serialized root signature store: a header, a table of entries keyed by the hash
+// of the root signature description, then the blobs. Serialized root signatures don't depend on the
+// adapter or driver, so unlike the pipeline cache nothing identifies the machine.
+class RootSignatureStoreFile
+{
+public:
+	static const uint32_t Magic = 0x53525844; // "DXRS"
+	static const uint32_t Version = 1;
+
+	struct Entry
+	{
+		uint64_t key;
+		const uint8_t* pBlob;
+		uint64_t blobSize;
+	};
+
+	static std::vector<uint8_t> Write(const std::vector<Entry>& entries);
+
+	// Returns false when the file is truncated or from another version. Entries whose blob doesn't
+	// match its hash are skipped. Blobs point into data.
+	static bool Read(const std::vector<uint8_t>& data, std::vector<Entry>& entries);
+
+private:
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t entryCount;
+	};
+
+	struct FileEntry
+	{
+		uint64_t key;
+		uint64_t offset;
+		uint64_t blobSize;
+		uint64_t blobHash;
+	};
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Read-only view of a shader archive written by tools/compile_shaders.py. Little endian:
+//   Header  { uint32 magic "DXSL", uint32 version, uint32 entryCount, uint32 reserved }
+//   Entry   { uint32 nameOffset, uint32 nameLength, uint64 dataOffset, uint64 dataSize, uint64 hash } x entryCount
+//   null terminated names, then blobs 16 byte aligned. Offsets are from the start of the archive.
+// Shaders are named "<file>:<entry point>", e.g. "shader.hlsl:VSMain".
+class ShaderArchive
+{
+public:
+	static const uint32_t Magic = 0x4C535844; // "DXSL"
+	static const uint32_t Version = 1;
+
+	struct Shader
+	{
+		const void* pData;
+		uint64_t size;
+		// Content hash the blob was cached under
+		uint64_t hash;
+	};
+
+	// The archive memory has to outlive this object. Returns false when it is truncated or malformed.
+	bool Parse(const void* pData, size_t size);
+
+	// nullptr when the archive holds no such shader
+	const Shader* Find(const std::string& name) const;
+
+	size_t GetShaderCount() const { return mShaders.size(); }
+
+private:
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+	};
+
+	struct Entry
+	{
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		uint64_t dataOffset;
+		uint64_t dataSize;
+		uint64_t hash;
+	};
+
+	std::unordered_map<std::string, Shader> mShaders;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Which shaders have to be recompiled when a file changes: every shader whose source is the file
+// or includes it, directly or through other includes. Includes are found by scanning for #include lines.
+class ShaderDependencyTracker
+{
+public:
+	// Returns false when the file can't be read. Defaults to reading from disk.
+	typedef std::function<bool(const std::filesystem::path& path, std::string& contents)> ReadFileFunc;
+
+	explicit ShaderDependencyTracker(std::vector<std::filesystem::path> includeDirs = {}, ReadFileFunc readFile = nullptr);
+
+	void AddShader(const std::string& name, const std::filesystem::path& sourcePath);
+
+	// Rescans the changed file for includes and returns the names of the shaders depending on it, sorted
+	std::vector<std::string> OnFileChanged(const std::filesystem::path& path);
+
+	// Every file the shader depends on, its source included
+	std::set<std::filesystem::path> GetDependencies(const std::string& name) const;
+
+private:
+	static std::filesystem::path Normalize(const std::filesystem::path& path);
+	void Scan(const std::filesystem::path& path, std::set<std::filesystem::path>& visited);
+	std::filesystem::path ResolveInclude(const std::string& include, const std::filesystem::path& includingFile) const;
+
+	std::vector<std::filesystem::path> mIncludeDirs;
+	ReadFileFunc mReadFile;
+
+	// Shader name to source file
+	std::map<std::string, std::filesystem::path> mShaders;
+	// File to the files it includes, only files that were scanned
+	std::map<std::filesystem::path, std::vector<std::filesystem::path>> mIncludes;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "stdafx.h"
+#include "FileWatcher.h"
+#include "ShaderDependencyTracker.h"
+#include "ShaderLibrary.h"
+#include "ShaderReloadScheduler.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+using Microsoft::WRL::ComPtr;
+
+// Development only: watches the shader sources, recompiles the shaders touched by a change and their include
+// dependents with tools/compile_shaders.py on a worker thread, rebuilds the pipelines using them and swaps
+// the new pipelines in at the next frame boundary. A shader that fails to compile keeps its old pipeline.
+class ShaderHotReload
+{
+public:
+	// Builds a pipeline from the recompiled shaders, runs on the worker thread
+	typedef std::function<ComPtr<ID3D12PipelineState>(const ShaderLibrary& library)> PipelineFactory;
+
+	~ShaderHotReload();
+
+	// shaders are "<file>:<entry point>" names, file relative to Assets/Shaders. Register before Start.
+	void RegisterPipeline(ComPtr<ID3D12PipelineState>* pPipelineState, std::vector<std::string> shaders, PipelineFactory factory);
+
+	// rootPath is the source tree, the one holding tools/ and Assets/. archivePath is the archive the build wrote,
+	// shaders are recompiled with the interpreter and arguments recorded next to it. Returns false when the
+	// sources can't be watched.
+	bool Start(const std::wstring& rootPath, const std::wstring& archivePath);
+	void Stop();
+
+	// Frame boundary, swaps in the pipelines rebuilt since the last call. The replaced pipelines are kept
+	// until the fence reaches lastSubmittedFenceValue, frames in flight may still use them.
+	void Update(UINT64 lastSubmittedFenceValue);
+	void Retire(UINT64 completedFenceValue);
+
+private:
+	struct Pipeline
+	{
+		ComPtr<ID3D12PipelineState>* pPipelineState;
+		std::vector<std::string> shaders;
+		PipelineFactory factory;
+	};
+
+	struct RetiredPipeline
+	{
+		ComPtr<ID3D12PipelineState> pipelineState;
+		UINT64 fenceValue;
+	};
+
+	void OnFileChanged(const std::filesystem::path& path);
+	void Rebuild(const std::vector<std::string>& shaders);
+	void LoadCompilerCommand(const std::filesystem::path& archivePath);
+	bool RunCompiler(const std::vector<std::string>& shaders, const std::wstring& outputPath);
+
+	std::filesystem::path mRootPath;
+	// Interpreter, script and arguments of the build's compile_shaders.py run
+	std::vector<std::wstring> mCompilerCommand;
+	std::vector<Pipeline> mPipelines;
+
+	// Tracker is only touched by the watcher thread once started
+	std::unique_ptr<ShaderDependencyTracker> mTracker;
+	std::unique_ptr<ShaderReloadScheduler> mScheduler;
+	FileWatcher mWatcher;
+
+	// Rebuilt pipelines waiting for the frame boundary, indexed like mPipelines
+	std::mutex mMutex;
+	std::vector<ComPtr<ID3D12PipelineState>> mReady;
+
+	std::vector<RetiredPipeline> mRetired;
+};
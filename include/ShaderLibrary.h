@@ -0,0 +1,28 @@
+#pragma once
+
+#include "stdafx.h"
+#include "ShaderArchive.h"
+
+// Precompiled shaders, memory-mapped from the archive tools/compile_shaders.py builds.
+// Bytecode points straight into the mapping, nothing is copied or compiled at runtime.
+class ShaderLibrary
+{
+public:
+	ShaderLibrary() = default;
+	~ShaderLibrary();
+
+	ShaderLibrary(const ShaderLibrary&) = delete;
+	ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+	void Open(const std::wstring& path);
+	void Close();
+
+	// name is "<file>:<entry point>", throws when the archive doesn't have it
+	D3D12_SHADER_BYTECODE GetBytecode(const std::string& name) const;
+
+private:
+	HANDLE mFile = INVALID_HANDLE_VALUE;
+	HANDLE mMapping = nullptr;
+	const void* mpView = nullptr;
+	ShaderArchive mArchive;
+};
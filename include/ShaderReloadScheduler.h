@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs shader recompiles on a background thread. Requests arriving close together are merged, editors tend to
+// write a file several times per save, so one compile covers them once the files have been quiet for the debounce delay.
+class ShaderReloadScheduler
+{
+public:
+	// Called on the scheduler thread with the sorted names of the shaders to rebuild
+	typedef std::function<void(const std::vector<std::string>& shaders)> CompileFunc;
+
+	explicit ShaderReloadScheduler(CompileFunc compile, std::chrono::milliseconds debounce = std::chrono::milliseconds(100));
+	~ShaderReloadScheduler();
+
+	ShaderReloadScheduler(const ShaderReloadScheduler&) = delete;
+	ShaderReloadScheduler& operator=(const ShaderReloadScheduler&) = delete;
+
+	void Request(const std::vector<std::string>& shaders);
+
+	// Blocks until nothing is pending or compiling
+	void WaitIdle();
+
+	// Drops pending requests, waits for a running compile to finish
+	void Stop();
+
+	uint64_t GetCompileCount() const;
+
+private:
+	void ThreadMain();
+
+	CompileFunc mCompile;
+	std::chrono::milliseconds mDebounce;
+
+	mutable std::mutex mMutex;
+	std::condition_variable mRequestCondition;
+	std::condition_variable mIdleCondition;
+	std::set<std::string> mPending;
+	std::chrono::steady_clock::time_point mLastRequest;
+	bool mCompiling = false;
+	bool mStop = false;
+	uint64_t mCompileCount = 0;
+
+	std::thread mThread;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "FrameRing.h"
+
+#include <deque>
+
+// A GPU timeline without a GPU. Work runs in submission order on a simulated clock, and signals complete
+// once the work queued ahead of them is done. Time only moves when the CPU side advances it or waits,
+// so pacing can be checked deterministically. Times are in milliseconds.
+class SimulatedFrameQueue : public FrameQueue
+{
+public:
+	SimulatedFrameQueue();
+
+	// Queues gpuTime of work behind everything submitted so far
+	void Execute(double gpuTime);
+	// CPU time passing, recording or simulating the app
+	void Advance(double cpuTime);
+
+	void Signal(uint64_t fenceValue) override;
+	uint64_t GetCompletedValue() override;
+	void Wait(uint64_t fenceValue) override;
+
+	double GetTime() const { return mTime; }
+	// Signals the GPU hasn't reached yet
+	uint32_t GetPendingCount() const { return static_cast<uint32_t>(mPending.size()); }
+	// Waits that had to block, and the time spent in them
+	uint32_t GetStallCount() const { return mStallCount; }
+	double GetStallTime() const { return mStallTime; }
+
+private:
+	struct PendingSignal
+	{
+		uint64_t fenceValue;
+		double time;
+	};
+
+	void Update();
+
+	std::deque<PendingSignal> mPending;
+	double mTime;
+	// When the GPU is done with everything queued so far
+	double mGpuTime;
+	uint64_t mCompletedValue;
+	uint32_t mStallCount;
+	double mStallTime;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock free queue for exactly one producer thread and one consumer thread.
+// Capacity is rounded up to a power of two. The indices keep counting and wrap, their difference is the size.
+template<typename T>
+class SpscQueue
+{
+public:
+	explicit SpscQueue(uint32_t capacity)
+	{
+		uint32_t size = 1;
+		while (size < capacity)
+		{
+			size <<= 1;
+		}
+		mMask = size - 1;
+		mItems = std::make_unique<T[]>(size);
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	// Producer only, false when full
+	bool TryPush(const T& item)
+	{
+		const uint32_t write = mWriteIndex.load(std::memory_order_relaxed);
+		if (write - mCachedReadIndex > mMask)
+		{
+			mCachedReadIndex = mReadIndex.load(std::memory_order_acquire);
+			if (write - mCachedReadIndex > mMask)
+				return false;
+		}
+
+		mItems[write & mMask] = item;
+		mWriteIndex.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only, false when empty
+	bool TryPop(T& item)
+	{
+		const uint32_t read = mReadIndex.load(std::memory_order_relaxed);
+		if (read == mCachedWriteIndex)
+		{
+			mCachedWriteIndex = mWriteIndex.load(std::memory_order_acquire);
+			if (read == mCachedWriteIndex)
+				return false;
+		}
+
+		item = mItems[read & mMask];
+		mReadIndex.store(read + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Exact only on the consumer side when the producer is idle, a hint otherwise
+	bool IsEmpty() const
+	{
+		return mReadIndex.load(std::memory_order_acquire) == mWriteIndex.load(std::memory_order_acquire);
+	}
+
+	uint32_t GetCapacity() const { return mMask + 1; }
+
+private:
+	static const size_t CacheLineSize = 64;
+
+	std::unique_ptr<T[]> mItems;
+	uint32_t mMask;
+
+	// Each side owns a line, with a copy of the other side's index so it only reloads it when it looks full or empty
+	alignas(CacheLineSize) std::atomic<uint32_t> mWriteIndex{ 0 };
+	uint32_t mCachedReadIndex = 0;
+	alignas(CacheLineSize) std::atomic<uint32_t> mReadIndex{ 0 };
+	uint32_t mCachedWriteIndex = 0;
+};
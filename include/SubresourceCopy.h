@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+class JobSystem;
+
+// Rows of rowSize bytes, the same layout as a D3D12_MEMCPY_DEST / D3D12_SUBRESOURCE_DATA pair
+struct SubresourceCopyDesc
+{
+	void* pDest;
+	size_t destRowPitch;
+	size_t destSlicePitch;
+	const void* pSource;
+	size_t sourceRowPitch;
+	size_t sourceSlicePitch;
+	size_t rowSize;
+	unsigned int rowCount;
+	unsigned int sliceCount;
+};
+
+// Copies subresources into upload memory. Streaming stores bypass the cache, which suits write-combined
+// destinations the CPU never reads back, and large copies are split into row bands across the job system.
+class SubresourceCopy
+{
+public:
+	struct Settings
+	{
+		bool streaming = true;
+		bool allowAvx2 = true;
+	};
+
+	static void Copy(const Settings& settings, const SubresourceCopyDesc* pCopies, unsigned int count, JobSystem* pJobSystem = nullptr);
+	static void CopyBuffer(const Settings& settings, void* pDest, const void* pSource, size_t size, JobSystem* pJobSystem = nullptr);
+
+	// Approximate bytes per job, and the total below which the calling thread copies alone
+	static constexpr size_t BytesPerJob = 512 * 1024;
+	static constexpr size_t MinParallelSize = 2 * 1024 * 1024;
+};
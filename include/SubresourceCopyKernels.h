@@ -0,0 +1,8 @@
+#pragma once
+
+// Copy kernels of SubresourceCopy, the AVX2 versions live in their own source built with AVX2 code generation
+
+#include <cstddef>
+
+// memcpy with non-temporal stores, callers must fence before the data is consumed
+void StreamCopyAvx2(void* pDest, const void* pSource, size_t size);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "stdafx.h"
+#include "SubresourceCopy.h"
+
+using Microsoft::WRL::ComPtr;
+
+// Drop-in for the d3dx12 UpdateSubresources overload that takes an intermediate offset.
+// The rows are copied by SubresourceCopy, so large uploads use streaming stores and spread across pJobSystem.
+// Returns the intermediate size used, or 0 when validation or mapping failed, like the stock helper.
+UINT64 UpdateSubresourcesParallel(ID3D12GraphicsCommandList* pCmdList, ID3D12Resource* pDestinationResource, ID3D12Resource* pIntermediate,
+	UINT64 intermediateOffset, UINT firstSubresource, UINT numSubresources, const D3D12_SUBRESOURCE_DATA* pSrcData,
+	JobSystem* pJobSystem = nullptr, const SubresourceCopy::Settings& settings = SubresourceCopy::Settings());
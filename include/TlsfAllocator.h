@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Two-level segregated fit allocator over an abstract range of offsets [0, size).
+// First level splits free blocks by power of two, second level linearly in SlCount steps,
+// so finding, splitting and merging blocks are all O(1).
+class TlsfAllocator
+{
+public:
+	typedef uint32_t Handle;
+	static const Handle InvalidHandle = ~0u;
+
+	struct Stats
+	{
+		uint64_t size;
+		uint64_t usedSize;
+		uint64_t freeSize;
+		uint64_t largestFreeBlock;
+		uint32_t allocationCount;
+		uint32_t freeBlockCount;
+		// 0 when the free space is one contiguous block, towards 1 as it gets scattered
+		double fragmentation;
+	};
+
+	struct Move
+	{
+		Handle source;
+		Handle destination;
+		uint64_t sourceOffset;
+		uint64_t destinationOffset;
+		uint64_t size;
+	};
+
+	explicit TlsfAllocator(uint64_t size = 0);
+
+	void Reset(uint64_t size);
+
+	// Alignment must be a power of two. Returns InvalidHandle when no free block fits.
+	Handle Allocate(uint64_t size, uint64_t alignment);
+	void Free(Handle handle);
+
+	uint64_t GetOffset(Handle handle) const { return mBlocks[handle].offset; }
+	uint64_t GetSize(Handle handle) const { return mBlocks[handle].size; }
+	bool IsEmpty() const { return mAllocationCount == 0; }
+
+	Stats GetStats() const;
+
+	// Plans up to maxMoves relocations of the highest allocations into lower free blocks.
+	// Destinations are allocated right away, sources stay allocated until the caller frees them
+	// after copying, so a source and its destination never overlap.
+	// Allocations canMove rejects are left in place and don't count against maxMoves.
+	void Defragment(uint32_t maxMoves, std::vector<Move>& moves, const std::function<bool(Handle)>& canMove = nullptr);
+
+private:
+	static const uint32_t SlLog2 = 5;
+	static const uint32_t SlCount = 1 << SlLog2;
+	static const uint32_t FlCount = 64 - SlLog2 + 1;
+
+	struct Block
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint64_t alignment;
+		Handle prevPhysical;
+		Handle nextPhysical;
+		Handle prevFree;
+		Handle nextFree;
+		bool isFree;
+	};
+
+	static void Mapping(uint64_t size, uint32_t& fl, uint32_t& sl);
+	Handle FindFreeBlock(uint64_t size) const;
+	bool Fits(Handle handle, uint64_t size, uint64_t alignment) const;
+	void InsertFree(Handle handle);
+	void RemoveFree(Handle handle);
+	Handle NewBlock();
+	void ReleaseBlock(Handle handle);
+
+	std::vector<Block> mBlocks;
+	std::vector<Handle> mUnusedBlocks;
+	Handle mFirstBlock;
+
+	uint64_t mFlBitmap;
+	uint32_t mSlBitmap[FlCount];
+	Handle mFreeHeads[FlCount][SlCount];
+
+	uint64_t mSize;
+	uint64_t mUsedSize;
+	uint32_t mAllocationCount;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// State bookkeeping behind ResourceStateTracker, without D3D12. Resources are opaque keys and states are
+// D3D12_RESOURCE_STATES bit masks. Tracks per subresource states, collapses A->B->C transitions into A->C,
+// and keeps transitions whose before state is unknown while recording (first use) pending until they are
+// resolved against the global states at submission.
+class TransitionTracker
+{
+public:
+	typedef const void* Resource;
+	typedef uint32_t (*SubresourceCountFunc)(Resource resource);
+
+	static const uint32_t AllSubresources = 0xFFFFFFFF;
+	// Every state bit set, never a valid combination
+	static const uint32_t UnknownState = 0xFFFFFF;
+
+	enum class BarrierType
+	{
+		Transition,
+		Uav,
+		Aliasing
+	};
+
+	struct Barrier
+	{
+		BarrierType type;
+		// Resource before for aliasing barriers, may be null for UAV and aliasing barriers
+		Resource resource;
+		Resource resourceAfter;
+		uint32_t subresource;
+		uint32_t stateBefore;
+		uint32_t stateAfter;
+	};
+
+	struct ResourceState
+	{
+		explicit ResourceState(uint32_t initialState = UnknownState) : state(initialState) {}
+
+		void SetSubresourceState(uint32_t subresource, uint32_t subresourceState);
+		uint32_t GetSubresourceState(uint32_t subresource) const;
+
+		// State of every subresource not in subresourceStates
+		uint32_t state;
+		std::map<uint32_t, uint32_t> subresourceStates;
+	};
+
+	typedef std::unordered_map<Resource, ResourceState> StateMap;
+
+	// getSubresourceCount is only called for resources whose subresources diverged
+	explicit TransitionTracker(SubresourceCountFunc getSubresourceCount);
+
+	void Transition(Resource resource, uint32_t stateAfter, uint32_t subresource = AllSubresources);
+	// Declares the state a resource is in without a barrier
+	void SetState(Resource resource, uint32_t state);
+	void UavBarrier(Resource resource);
+	void AliasBarrier(Resource resourceBefore, Resource resourceAfter);
+
+	// Barriers with known before states, in recording order
+	const std::vector<Barrier>& GetBarriers() const { return mBarriers; }
+	void ClearBarriers() { mBarriers.clear(); }
+
+	// Appends a barrier for every pending transition whose global state differs, then forgets them.
+	// Resources missing from globalStates are not tracked globally and are skipped.
+	void ResolvePendingBarriers(const StateMap& globalStates, std::vector<Barrier>& barriers);
+	// Writes the states this list leaves its resources in back to globalStates
+	void CommitFinalStates(StateMap& globalStates);
+
+	void Reset();
+
+private:
+	void AddTransition(Resource resource, uint32_t subresource, uint32_t stateBefore, uint32_t stateAfter);
+	void AddPending(Resource resource, uint32_t subresource, uint32_t stateAfter);
+
+	SubresourceCountFunc mGetSubresourceCount;
+	std::vector<Barrier> mBarriers;
+	std::vector<Barrier> mPendingBarriers;
+	StateMap mFinalStates;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "stdafx.h"
+#include "RingAllocator.h"
+
+using Microsoft::WRL::ComPtr;
+
+struct UploadAllocation
+{
+	ID3D12Resource* pResource;
+	UINT64 offset;
+	UINT8* pCpuAddress;
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress;
+};
+
+// Single persistently mapped upload buffer, sub-allocated as a ring and retired by fence value
+class UploadRing
+{
+public:
+	static const UINT64 ConstantBufferAlignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+	static const UINT64 TextureAlignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+
+	~UploadRing();
+
+	void Init(ID3D12Device* pDevice, UINT64 size);
+
+	// Throws when the ring is full, callers should retire completed batches first
+	UploadAllocation Allocate(UINT64 size, UINT64 alignment);
+	bool TryAllocate(UINT64 size, UINT64 alignment, UploadAllocation& allocation);
+
+	void FinishBatch(UINT64 fenceValue) { mAllocator.FinishBatch(fenceValue); }
+	void Retire(UINT64 completedFenceValue) { mAllocator.Retire(completedFenceValue); }
+
+	// For callers that sub-allocate the offsets themselves
+	RingAllocator& GetAllocator() { return mAllocator; }
+	UploadAllocation GetAllocation(UINT64 offset) const;
+
+	ID3D12Resource* GetResource() const { return mBuffer.Get(); }
+	UINT64 GetUsedSize() const { return mAllocator.GetUsedSize(); }
+
+private:
+	ComPtr<ID3D12Resource> mBuffer;
+	UINT8* mpMappedData = nullptr;
+	RingAllocator mAllocator;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "RingAllocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+enum class UploadPriority
+{
+	High,
+	Normal,
+	Low,
+	Count
+};
+
+// The copy queue an UploadScheduler feeds, D3D12 in UploadStreamer
+class UploadCopyQueue
+{
+public:
+	virtual ~UploadCopyQueue() = default;
+
+	// Records the copy of request id into the open command list, its data is staged at stagingOffset
+	virtual void RecordCopy(uint64_t id, uint64_t stagingOffset) = 0;
+	// Executes everything recorded since the last submission, then signals fenceValue
+	virtual void Submit(uint64_t fenceValue) = 0;
+	virtual uint64_t GetCompletedValue() = 0;
+	// Blocks until the copy fence has reached fenceValue
+	virtual void Wait(uint64_t fenceValue) = 0;
+};
+
+// Ordering, batching and staging of UploadStreamer requests, without D3D12 or threads.
+// Requests go out highest priority first and in order within a priority. A batch is closed once it reaches
+// the batch size, and is recorded into as few submissions as the staging ring allows. Not thread safe.
+class UploadScheduler
+{
+public:
+	struct Request
+	{
+		uint64_t id;
+		uint64_t stagingSize;
+		// Power of two
+		uint64_t stagingAlignment;
+	};
+
+	UploadScheduler();
+
+	// Staging memory is sub-allocated from pStagingRing, which must outlive the scheduler
+	void Init(RingAllocator* pStagingRing, uint64_t batchSize);
+
+	void Enqueue(const Request& request, UploadPriority priority);
+	bool IsEmpty() const;
+
+	// Takes requests highest priority first until they add up to the batch size, empty when nothing is queued
+	std::vector<Request> PopBatch();
+
+	// Stages and records the batch in order. When the ring fills up, what was recorded so far is submitted
+	// and the copy queue drained, so a batch may take several submissions.
+	// Returns false when a request is larger than the whole ring, requests before it were still submitted.
+	bool SubmitBatch(const std::vector<Request>& batch, UploadCopyQueue& queue);
+
+	uint64_t GetLastSubmittedFenceValue() const { return mLastSubmittedFenceValue; }
+
+private:
+	void Submit(UploadCopyQueue& queue);
+
+	RingAllocator* mpStagingRing;
+	uint64_t mBatchSize;
+	uint64_t mLastSubmittedFenceValue;
+	std::deque<Request> mRequests[static_cast<size_t>(UploadPriority::Count)];
+};
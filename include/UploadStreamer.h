@@ -0,0 +1,114 @@
+#pragma once
+
+#include "stdafx.h"
+#include "JobSystem.h"
+#include "SubresourceCopy.h"
+#include "UploadRing.h"
+#include "UploadScheduler.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+using Microsoft::WRL::ComPtr;
+
+// Streams buffer and texture data to default heap resources on a dedicated copy queue.
+// Requests are batched into copy command lists by a background thread, highest priority first, see UploadScheduler.
+// Destination resources must be in the COMMON state, they decay back to it once the copy queue is done.
+class UploadStreamer : private UploadCopyQueue
+{
+public:
+	static const UINT64 DefaultBatchSize = 8 * 1024 * 1024;
+
+	~UploadStreamer();
+
+	// pJobSystem's threads help the submission thread copy into staging memory, it takes one of the caller slots
+	// and has to outlive Shutdown. Without one the submission thread copies alone.
+	void Init(ID3D12Device* pDevice, UINT64 stagingSize, UINT64 batchSize = DefaultBatchSize, JobSystem* pJobSystem = nullptr);
+	void Shutdown();
+
+	// pSource must stay valid until the data has been staged, keepAlive is released at that point
+	void EnqueueBuffer(ID3D12Resource* pDest, UINT64 destOffset, const void* pSource, UINT64 size,
+		std::shared_ptr<const void> keepAlive, UploadPriority priority = UploadPriority::Normal);
+	void EnqueueTexture(ID3D12Resource* pDest, UINT firstSubresource, UINT numSubresources, const D3D12_SUBRESOURCE_DATA* pSubresources,
+		std::shared_ptr<const void> keepAlive, UploadPriority priority = UploadPriority::Normal);
+
+	// Called on the submission thread to write a subresource straight into staging memory laid out as footprint
+	typedef std::function<void(UINT subresource, const D3D12_SUBRESOURCE_FOOTPRINT& footprint, void* pData)> FillFunc;
+	void EnqueueGeneratedTexture(ID3D12Resource* pDest, UINT firstSubresource, UINT numSubresources, FillFunc fill,
+		UploadPriority priority = UploadPriority::Normal);
+
+	// Blocks until everything enqueued so far has been submitted, returns the copy fence value that covers it.
+	// Rethrows any failure that happened on the submission thread.
+	UINT64 Flush();
+
+	// Makes pQueue wait on the GPU timeline until the copy fence reaches fenceValue
+	void WaitOnQueue(ID3D12CommandQueue* pQueue, UINT64 fenceValue);
+
+	ID3D12CommandQueue* GetCommandQueue() const { return mCopyQueue.Get(); }
+
+private:
+	struct Request
+	{
+		ComPtr<ID3D12Resource> dest;
+		UINT64 destOffset;
+		UINT firstSubresource;
+		std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+		UINT64 stagingSize;
+		std::shared_ptr<const void> keepAlive;
+		FillFunc fill;
+		UINT fillCount;
+		bool isBuffer;
+	};
+
+	struct CommandAllocatorEntry
+	{
+		ComPtr<ID3D12CommandAllocator> allocator;
+		UINT64 fenceValue;
+	};
+
+	void Enqueue(Request&& request, UploadPriority priority);
+	void SubmissionThreadMain();
+	void FillTexture(Request& request, const UploadAllocation& staging);
+	void BeginCommandList();
+	void WaitForCopyFence(UINT64 fenceValue);
+
+	// UploadCopyQueue, called by the scheduler on the submission thread
+	void RecordCopy(uint64_t id, uint64_t stagingOffset) override;
+	void Submit(uint64_t fenceValue) override;
+	uint64_t GetCompletedValue() override;
+	void Wait(uint64_t fenceValue) override;
+
+	ComPtr<ID3D12Device> mDevice;
+	ComPtr<ID3D12CommandQueue> mCopyQueue;
+	ComPtr<ID3D12GraphicsCommandList> mCommandList;
+	bool mCommandListOpen = false;
+	std::deque<CommandAllocatorEntry> mCommandAllocators;
+	ComPtr<ID3D12CommandAllocator> mRecordingAllocator;
+	ComPtr<ID3D12Fence> mCopyFence;
+	HANDLE mCopyFenceEvent = nullptr;
+	UINT64 mLastSubmittedFenceValue = 0;
+	UploadRing mStagingRing;
+	JobSystem* mpJobSystem = nullptr;
+	SubresourceCopy::Settings mCopySettings;
+	// Requests of the batch being submitted, by id
+	std::unordered_map<uint64_t, Request> mBatchRequests;
+
+	// Guards everything below, and the scheduler's queues. Its staging ring is only used by the submission thread.
+	std::mutex mMutex;
+	std::condition_variable mRequestCondition;
+	std::condition_variable mIdleCondition;
+	UploadScheduler mScheduler;
+	std::unordered_map<uint64_t, Request> mRequests;
+	uint64_t mNextRequestId = 0;
+	bool mBatchInFlight = false;
+	bool mShutdown = false;
+	std::exception_ptr mError;
+
+	std::thread mSubmissionThread;
+};
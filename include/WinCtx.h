@@ -1,6 +1,9 @@
 #pragma once
 
 #include "stdafx.h"
+#include "RenderThread.h"
+
+#include <mutex>
 
 class DXRenderer;
 
@@ -10,11 +13,18 @@ public:
 	static int Run(DXRenderer* pRenderer, HINSTANCE hInstance, int nCmdShow);
 	static HWND GetHwnd() { return mHWnd; };
 
+	// Any thread, applied by the window thread so the render thread never waits on it
+	static void SetTitle(const std::wstring& title);
+
 protected:
 	static LRESULT CALLBACK WindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
 private:
 	static HWND mHWnd;
+	static RenderThread mRenderThread;
+
+	static std::mutex mTitleMutex;
+	static std::wstring mTitle;
 
 };
 
@@ -8,7 +8,6 @@
 #include "directx/d3dx12.h"
 #include <d3d12.h>
 #include <dxgi1_6.h>
-#include <D3Dcompiler.h>
 #include <DirectXMath.h>
 
 #include <wrl.h>
@@ -0,0 +1,154 @@
+#include "BenchmarkRecorder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+	// Nearest rank on sorted samples
+	double Percentile(const std::vector<double>& sorted, uint32_t percent)
+	{
+		const size_t rank = (sorted.size() * percent + 99) / 100;
+		return sorted[std::max<size_t>(rank, 1) - 1];
+	}
+
+	void AppendString(std::string& json, const std::string& text)
+	{
+		json += '"';
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				json += '\\';
+				json += c;
+			}
+			else if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				json += escaped;
+			}
+			else
+			{
+				json += c;
+			}
+		}
+		json += '"';
+	}
+}
+
+BenchmarkRecorder::BenchmarkRecorder(uint32_t warmupFrames, uint32_t measuredFrames)
+	: mWarmupFrames(warmupFrames), mMeasuredFrames(measuredFrames)
+{
+	for (std::vector<double>& samples : mSamples)
+	{
+		samples.reserve(measuredFrames);
+	}
+}
+
+void BenchmarkRecorder::AddSample(Series series, double milliseconds)
+{
+	std::vector<double>& samples = mSamples[series];
+	if (!IsWarmingUp() && samples.size() < mMeasuredFrames)
+		samples.push_back(milliseconds);
+}
+
+void BenchmarkRecorder::EndFrame()
+{
+	mFrame++;
+}
+
+void BenchmarkRecorder::SetInfo(const std::string& key, const std::string& value)
+{
+	for (auto& info : mInfo)
+	{
+		if (info.first == key)
+		{
+			info.second = value;
+			return;
+		}
+	}
+	mInfo.emplace_back(key, value);
+}
+
+BenchmarkRecorder::Summary BenchmarkRecorder::GetSummary(Series series) const
+{
+	return Summarize(mSamples[series]);
+}
+
+BenchmarkRecorder::Summary BenchmarkRecorder::Summarize(const std::vector<double>& samples)
+{
+	Summary summary = { static_cast<uint32_t>(samples.size()), 0.0, 0.0, 0.0, 0.0, 0.0, 0 };
+	if (samples.empty())
+		return summary;
+
+	std::vector<double> sorted(samples);
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0.0;
+	for (double sample : sorted)
+	{
+		total += sample;
+	}
+	summary.mean = total / sorted.size();
+	summary.p50 = Percentile(sorted, 50);
+	summary.p95 = Percentile(sorted, 95);
+	summary.p99 = Percentile(sorted, 99);
+	summary.max = sorted.back();
+
+	// Relative to the median so a steady slow run isn't all stutter
+	const double threshold = summary.p50 * StutterFactor;
+	summary.stutterCount = static_cast<uint32_t>(sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), threshold));
+	return summary;
+}
+
+std::string BenchmarkRecorder::ToJson() const
+{
+	std::string json;
+	char number[256];
+
+	snprintf(number, sizeof(number), "{\n\"warmupFrames\":%u,\n\"measuredFrames\":%u,\n\"stutterFactor\":%.17g,\n\"info\":{",
+		mWarmupFrames, mMeasuredFrames, StutterFactor);
+	json += number;
+	for (size_t i = 0; i < mInfo.size(); i++)
+	{
+		json += i == 0 ? "" : ",";
+		AppendString(json, mInfo[i].first);
+		json += ':';
+		AppendString(json, mInfo[i].second);
+	}
+	json += "},\n\"series\":{";
+
+	for (int series = 0; series < SeriesCount; series++)
+	{
+		const Summary summary = GetSummary(static_cast<Series>(series));
+		json += series == 0 ? "\n" : ",\n";
+		AppendString(json, GetSeriesName(static_cast<Series>(series)));
+		snprintf(number, sizeof(number),
+			":{\"count\":%u,\"mean\":%.6f,\"p50\":%.6f,\"p95\":%.6f,\"p99\":%.6f,\"max\":%.6f,\"stutters\":%u}",
+			summary.count, summary.mean, summary.p50, summary.p95, summary.p99, summary.max, summary.stutterCount);
+		json += number;
+	}
+
+	json += "\n}\n}\n";
+	return json;
+}
+
+bool BenchmarkRecorder::Write(const std::filesystem::path& path) const
+{
+	const std::string json = ToJson();
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	return static_cast<bool>(file.write(json.data(), json.size()));
+}
+
+const char* BenchmarkRecorder::GetSeriesName(Series series)
+{
+	switch (series)
+	{
+	case CpuFrameTime: return "cpuFrameTime";
+	case GpuFrameTime: return "gpuFrameTime";
+	case PresentInterval: return "presentInterval";
+	default: return "unknown";
+	}
+}
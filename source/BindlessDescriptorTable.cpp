@@ -0,0 +1,54 @@
+#include "BindlessDescriptorTable.h"
+#include "DXHelper.h"
+
+void BindlessDescriptorTable::Init(ID3D12Device* pDevice, DescriptorAllocator& heap)
+{
+	mDevice = pDevice;
+	mTable = heap.GetBindlessTable();
+	mDescriptorSize = heap.GetDescriptorSize();
+	mRegistry.Reset(mTable.count);
+
+	// An out of range index then reads black instead of a stale or garbage descriptor
+	for (UINT i = 0; i < mTable.count; i++)
+	{
+		WriteNullDescriptor(i);
+	}
+}
+
+UINT BindlessDescriptorTable::RegisterTexture(ID3D12Resource* pResource, const D3D12_SHADER_RESOURCE_VIEW_DESC* pDesc)
+{
+	bool isNew = false;
+	const UINT index = mRegistry.Acquire(reinterpret_cast<uintptr_t>(pResource), isNew);
+	if (index == BindlessRegistry::InvalidIndex)
+		ThrowIfFailed(E_OUTOFMEMORY);
+
+	if (isNew)
+		mDevice->CreateShaderResourceView(pResource, pDesc, CD3DX12_CPU_DESCRIPTOR_HANDLE(mTable.cpu, static_cast<INT>(index), mDescriptorSize));
+
+	return index;
+}
+
+void BindlessDescriptorTable::Release(ID3D12Resource* pResource, UINT64 fenceValue)
+{
+	mRegistry.Release(reinterpret_cast<uintptr_t>(pResource), fenceValue);
+}
+
+void BindlessDescriptorTable::Retire(UINT64 completedFenceValue)
+{
+	mFreedIndices.clear();
+	mRegistry.Retire(completedFenceValue, mFreedIndices);
+	for (uint32_t index : mFreedIndices)
+	{
+		WriteNullDescriptor(index);
+	}
+}
+
+void BindlessDescriptorTable::WriteNullDescriptor(UINT index)
+{
+	D3D12_SHADER_RESOURCE_VIEW_DESC nullDesc = {};
+	nullDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	nullDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	nullDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	nullDesc.Texture2D.MipLevels = 1;
+	mDevice->CreateShaderResourceView(nullptr, &nullDesc, CD3DX12_CPU_DESCRIPTOR_HANDLE(mTable.cpu, static_cast<INT>(index), mDescriptorSize));
+}
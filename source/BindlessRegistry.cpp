@@ -0,0 +1,91 @@
+#include "BindlessRegistry.h"
+
+#include <algorithm>
+#include <functional>
+
+BindlessRegistry::BindlessRegistry(uint32_t capacity)
+{
+	Reset(capacity);
+}
+
+void BindlessRegistry::Reset(uint32_t capacity)
+{
+	mCapacity = capacity;
+	mEntries.clear();
+	mPendingFrees.clear();
+
+	// Ascending order is already a valid min-heap
+	mFreeIndices.resize(capacity);
+	for (uint32_t i = 0; i < capacity; i++)
+	{
+		mFreeIndices[i] = i;
+	}
+}
+
+uint32_t BindlessRegistry::Acquire(uint64_t key, bool& isNew)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	isNew = false;
+	auto it = mEntries.find(key);
+	if (it != mEntries.end())
+	{
+		it->second.refCount++;
+		return it->second.index;
+	}
+
+	if (mFreeIndices.empty())
+		return InvalidIndex;
+
+	std::pop_heap(mFreeIndices.begin(), mFreeIndices.end(), std::greater<uint32_t>());
+	const uint32_t index = mFreeIndices.back();
+	mFreeIndices.pop_back();
+
+	mEntries.emplace(key, Entry{ index, 1 });
+	isNew = true;
+	return index;
+}
+
+void BindlessRegistry::Release(uint64_t key, uint64_t fenceValue)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto it = mEntries.find(key);
+	if (it == mEntries.end())
+		return;
+
+	if (--it->second.refCount == 0)
+	{
+		mPendingFrees.push_back({ it->second.index, fenceValue });
+		mEntries.erase(it);
+	}
+}
+
+void BindlessRegistry::Retire(uint64_t completedFenceValue, std::vector<uint32_t>& freedIndices)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto retired = std::partition(mPendingFrees.begin(), mPendingFrees.end(),
+		[completedFenceValue](const PendingFree& pending) { return pending.fenceValue > completedFenceValue; });
+	for (auto it = retired; it != mPendingFrees.end(); ++it)
+	{
+		freedIndices.push_back(it->index);
+		mFreeIndices.push_back(it->index);
+		std::push_heap(mFreeIndices.begin(), mFreeIndices.end(), std::greater<uint32_t>());
+	}
+	mPendingFrees.erase(retired, mPendingFrees.end());
+}
+
+uint32_t BindlessRegistry::Find(uint64_t key) const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto it = mEntries.find(key);
+	return it != mEntries.end() ? it->second.index : InvalidIndex;
+}
+
+uint32_t BindlessRegistry::GetResidentCount() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return static_cast<uint32_t>(mEntries.size());
+}
@@ -0,0 +1,41 @@
+#include "BitmapFile.h"
+
+#include <cstring>
+
+std::vector<uint8_t> BitmapFile::Write(uint32_t width, uint32_t height, const uint8_t* pPixels, uint64_t rowPitch)
+{
+	const uint32_t imageSize = width * height * 4;
+
+	FileHeader fileHeader = {};
+	fileHeader.type = 0x4D42; // "BM"
+	fileHeader.offBits = sizeof(FileHeader) + sizeof(InfoHeader);
+	fileHeader.size = fileHeader.offBits + imageSize;
+
+	// Negative height stores the rows top-down, as they come out of the GPU
+	InfoHeader infoHeader = {};
+	infoHeader.size = sizeof(InfoHeader);
+	infoHeader.width = static_cast<int32_t>(width);
+	infoHeader.height = -static_cast<int32_t>(height);
+	infoHeader.planes = 1;
+	infoHeader.bitCount = 32;
+	infoHeader.sizeImage = imageSize;
+
+	std::vector<uint8_t> data(fileHeader.size);
+	memcpy(data.data(), &fileHeader, sizeof(fileHeader));
+	memcpy(data.data() + sizeof(fileHeader), &infoHeader, sizeof(infoHeader));
+
+	// BMP wants BGRA
+	uint8_t* pDest = data.data() + fileHeader.offBits;
+	for (uint32_t y = 0; y < height; y++)
+	{
+		const uint8_t* pRow = pPixels + y * rowPitch;
+		for (uint32_t x = 0; x < width; x++, pDest += 4)
+		{
+			pDest[0] = pRow[x * 4 + 2];
+			pDest[1] = pRow[x * 4 + 1];
+			pDest[2] = pRow[x * 4 + 0];
+			pDest[3] = pRow[x * 4 + 3];
+		}
+	}
+	return data;
+}
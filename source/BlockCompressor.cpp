@@ -0,0 +1,776 @@
+#include "BlockCompressor.h"
+#include "BlockCompressorKernels.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define BLOCK_COMPRESSOR_X64 1
+#endif
+
+namespace
+{
+	const float MaxError = 3.0e38f;
+	const float RgbWeights[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+	const float RgbaWeights[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	const float SingleWeights[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+
+	// Position of each palette entry between the two endpoints
+	const float Bc1Positions[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+	const float Bc4Positions[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+	const int Bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	typedef float (*FindIndicesFunc)(const BlockPixels& pixels, const float (*pPalette)[4], uint32_t paletteSize, const float* pWeights, uint8_t* pIndices);
+
+	float FindIndicesScalar(const BlockPixels& pixels, const float (*pPalette)[4], uint32_t paletteSize, const float* pWeights, uint8_t* pIndices)
+	{
+		float total = 0.0f;
+		for (uint32_t p = 0; p < 16; p++)
+		{
+			float bestError = MaxError;
+			uint8_t bestIndex = 0;
+			for (uint32_t i = 0; i < paletteSize; i++)
+			{
+				float error = 0.0f;
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					const float difference = pixels.channels[c][p] - pPalette[i][c];
+					error += difference * difference * pWeights[c];
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = static_cast<uint8_t>(i);
+				}
+			}
+			pIndices[p] = bestIndex;
+			total += bestError;
+		}
+		return total;
+	}
+
+	struct Encoder
+	{
+		FindIndicesFunc findIndices;
+		BlockQuality quality;
+
+		uint32_t GetRefinementCount() const
+		{
+			switch (quality)
+			{
+			case BlockQuality::Fast: return 0;
+			case BlockQuality::Normal: return 2;
+			default: return 4;
+			}
+		}
+	};
+
+	Encoder GetEncoder(const BlockCompressor::Settings& settings)
+	{
+#ifdef BLOCK_COMPRESSOR_X64
+		if (settings.allowAvx2 && CpuFeatures::HasAvx2())
+			return { FindIndicesAvx2, settings.quality };
+#endif
+		return { FindIndicesScalar, settings.quality };
+	}
+
+	int Clamp(int value, int low, int high)
+	{
+		return value < low ? low : (value > high ? high : value);
+	}
+
+	int QuantizeChannel(float value, int maxValue)
+	{
+		return Clamp(static_cast<int>(std::lround(value * maxValue / 255.0f)), 0, maxValue);
+	}
+
+	// Endpoints at the extremes of the block along its principal axis
+	void FitLine(const BlockPixels& pixels, uint32_t channelCount, float endpoints[2][4])
+	{
+		float mean[4] = {};
+		for (uint32_t c = 0; c < channelCount; c++)
+		{
+			for (uint32_t p = 0; p < 16; p++)
+			{
+				mean[c] += pixels.channels[c][p];
+			}
+			mean[c] /= 16.0f;
+		}
+
+		float covariance[4][4] = {};
+		for (uint32_t p = 0; p < 16; p++)
+		{
+			for (uint32_t i = 0; i < channelCount; i++)
+			{
+				for (uint32_t j = 0; j < channelCount; j++)
+				{
+					covariance[i][j] += (pixels.channels[i][p] - mean[i]) * (pixels.channels[j][p] - mean[j]);
+				}
+			}
+		}
+
+		// Power iteration, starting from the row of the channel that varies the most
+		uint32_t widest = 0;
+		for (uint32_t c = 1; c < channelCount; c++)
+		{
+			if (covariance[c][c] > covariance[widest][widest])
+				widest = c;
+		}
+		float axis[4] = {};
+		std::copy(covariance[widest], covariance[widest] + channelCount, axis);
+		for (uint32_t iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = {};
+			float largest = 0.0f;
+			for (uint32_t i = 0; i < channelCount; i++)
+			{
+				for (uint32_t j = 0; j < channelCount; j++)
+				{
+					next[i] += covariance[i][j] * axis[j];
+				}
+				largest = std::max(largest, std::abs(next[i]));
+			}
+			if (largest == 0.0f)
+				break;
+			for (uint32_t i = 0; i < channelCount; i++)
+			{
+				axis[i] = next[i] / largest;
+			}
+		}
+
+		float length = 0.0f;
+		for (uint32_t c = 0; c < channelCount; c++)
+		{
+			length += axis[c] * axis[c];
+		}
+		length = std::sqrt(length);
+
+		float low = 0.0f;
+		float high = 0.0f;
+		if (length > 0.0f)
+		{
+			for (uint32_t c = 0; c < channelCount; c++)
+			{
+				axis[c] /= length;
+			}
+			low = MaxError;
+			high = -MaxError;
+			for (uint32_t p = 0; p < 16; p++)
+			{
+				float t = 0.0f;
+				for (uint32_t c = 0; c < channelCount; c++)
+				{
+					t += (pixels.channels[c][p] - mean[c]) * axis[c];
+				}
+				low = std::min(low, t);
+				high = std::max(high, t);
+			}
+		}
+
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = c < channelCount ? std::clamp(mean[c] + axis[c] * low, 0.0f, 255.0f) : 0.0f;
+			endpoints[1][c] = c < channelCount ? std::clamp(mean[c] + axis[c] * high, 0.0f, 255.0f) : 0.0f;
+		}
+	}
+
+	// Least squares endpoints for fixed indices, false when the indices do not span the two endpoints
+	bool RefineEndpoints(const BlockPixels& pixels, uint32_t channelCount, const uint8_t* pIndices, const float* pPositions, float endpoints[2][4])
+	{
+		float alpha2 = 0.0f;
+		float beta2 = 0.0f;
+		float alphaBeta = 0.0f;
+		float alphaX[4] = {};
+		float betaX[4] = {};
+		for (uint32_t p = 0; p < 16; p++)
+		{
+			const float beta = pPositions[pIndices[p]];
+			const float alpha = 1.0f - beta;
+			alpha2 += alpha * alpha;
+			beta2 += beta * beta;
+			alphaBeta += alpha * beta;
+			for (uint32_t c = 0; c < channelCount; c++)
+			{
+				alphaX[c] += alpha * pixels.channels[c][p];
+				betaX[c] += beta * pixels.channels[c][p];
+			}
+		}
+
+		const float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+		if (std::abs(determinant) < 1.0e-6f)
+			return false;
+
+		for (uint32_t c = 0; c < channelCount; c++)
+		{
+			endpoints[0][c] = std::clamp((alphaX[c] * beta2 - betaX[c] * alphaBeta) / determinant, 0.0f, 255.0f);
+			endpoints[1][c] = std::clamp((betaX[c] * alpha2 - alphaX[c] * alphaBeta) / determinant, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	// Endpoint search shared by the formats: fit, refine, then walk the quantized neighbours.
+	// Format supplies ChannelCount, ComponentCount, Endpoints, Quantize, Step, Evaluate and GetPositions.
+	template<typename Format>
+	float SearchEndpoints(const Encoder& encoder, const Format& format, const BlockPixels& pixels, typename Format::Endpoints& best, uint8_t* pBestIndices)
+	{
+		float endpoints[2][4];
+		FitLine(pixels, Format::ChannelCount, endpoints);
+		format.Quantize(endpoints, best);
+		float bestError = format.Evaluate(best, pBestIndices);
+
+		for (uint32_t iteration = 0; iteration < encoder.GetRefinementCount() && bestError > 0.0f; iteration++)
+		{
+			if (!RefineEndpoints(pixels, Format::ChannelCount, pBestIndices, format.GetPositions(), endpoints))
+				break;
+
+			typename Format::Endpoints candidate;
+			format.Quantize(endpoints, candidate);
+			uint8_t indices[16];
+			const float error = format.Evaluate(candidate, indices);
+			if (error >= bestError)
+				break;
+
+			best = candidate;
+			bestError = error;
+			std::copy(indices, indices + 16, pBestIndices);
+		}
+
+		if (encoder.quality != BlockQuality::High)
+			return bestError;
+
+		// Coordinate descent over every quantized endpoint component
+		bool improved = true;
+		for (uint32_t pass = 0; pass < 8 && improved && bestError > 0.0f; pass++)
+		{
+			improved = false;
+			for (uint32_t component = 0; component < Format::ComponentCount; component++)
+			{
+				for (int step : { -1, 1 })
+				{
+					typename Format::Endpoints candidate = best;
+					if (!format.Step(candidate, component, step))
+						continue;
+
+					uint8_t indices[16];
+					const float error = format.Evaluate(candidate, indices);
+					if (error < bestError)
+					{
+						best = candidate;
+						bestError = error;
+						std::copy(indices, indices + 16, pBestIndices);
+						improved = true;
+					}
+				}
+			}
+		}
+		return bestError;
+	}
+
+	void WriteLittleEndian(uint8_t* pDest, uint64_t value, uint32_t byteCount)
+	{
+		for (uint32_t i = 0; i < byteCount; i++)
+		{
+			pDest[i] = static_cast<uint8_t>(value >> (i * 8));
+		}
+	}
+
+	// Four colour BC1 block, also the colour half of BC3
+	struct ColorFormat
+	{
+		static const uint32_t ChannelCount = 3;
+		static const uint32_t ComponentCount = 6;
+
+		struct Endpoints
+		{
+			// 5:6:5
+			int values[2][3];
+		};
+
+		const Encoder& encoder;
+		const BlockPixels& pixels;
+
+		static uint16_t Pack(const int values[3])
+		{
+			return static_cast<uint16_t>((values[0] << 11) | (values[1] << 5) | values[2]);
+		}
+
+		static void Expand(const int values[3], float color[4])
+		{
+			color[0] = static_cast<float>((values[0] << 3) | (values[0] >> 2));
+			color[1] = static_cast<float>((values[1] << 2) | (values[1] >> 4));
+			color[2] = static_cast<float>((values[2] << 3) | (values[2] >> 2));
+			color[3] = 0.0f;
+		}
+
+		const float* GetPositions() const { return Bc1Positions; }
+
+		void Quantize(const float endpoints[2][4], Endpoints& result) const
+		{
+			for (uint32_t e = 0; e < 2; e++)
+			{
+				result.values[e][0] = QuantizeChannel(endpoints[e][0], 31);
+				result.values[e][1] = QuantizeChannel(endpoints[e][1], 63);
+				result.values[e][2] = QuantizeChannel(endpoints[e][2], 31);
+			}
+		}
+
+		bool Step(Endpoints& endpoints, uint32_t component, int step) const
+		{
+			int& value = endpoints.values[component / 3][component % 3];
+			const int maxValue = component % 3 == 1 ? 63 : 31;
+			if (value + step < 0 || value + step > maxValue)
+				return false;
+			value += step;
+			return true;
+		}
+
+		float Evaluate(const Endpoints& endpoints, uint8_t* pIndices) const
+		{
+			float palette[4][4];
+			Expand(endpoints.values[0], palette[0]);
+			Expand(endpoints.values[1], palette[1]);
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				palette[2][c] = std::floor((2.0f * palette[0][c] + palette[1][c] + 1.0f) / 3.0f);
+				palette[3][c] = std::floor((palette[0][c] + 2.0f * palette[1][c] + 1.0f) / 3.0f);
+			}
+			return encoder.findIndices(pixels, palette, 4, RgbWeights, pIndices);
+		}
+
+		static void Write(const Endpoints& endpoints, const uint8_t* pIndices, uint8_t* pBlock)
+		{
+			uint16_t color0 = Pack(endpoints.values[0]);
+			uint16_t color1 = Pack(endpoints.values[1]);
+
+			// The larger endpoint goes first to select the four colour mode
+			static const uint8_t Unchanged[4] = { 0, 1, 2, 3 };
+			static const uint8_t Swapped[4] = { 1, 0, 3, 2 };
+			const uint8_t* pRemap = color0 < color1 ? Swapped : Unchanged;
+			if (color0 < color1)
+				std::swap(color0, color1);
+
+			uint32_t indices = 0;
+			if (color0 != color1)
+			{
+				for (uint32_t p = 0; p < 16; p++)
+				{
+					indices |= static_cast<uint32_t>(pRemap[pIndices[p]]) << (p * 2);
+				}
+			}
+
+			WriteLittleEndian(pBlock, color0, 2);
+			WriteLittleEndian(pBlock + 2, color1, 2);
+			WriteLittleEndian(pBlock + 4, indices, 4);
+		}
+	};
+
+	// Single channel BC4 block, the alpha half of BC3 and both halves of BC5. Only the eight value mode is searched,
+	// the six value mode with explicit 0 and 255 is tried as an alternative when the block holds either.
+	struct SingleFormat
+	{
+		static const uint32_t ChannelCount = 1;
+		static const uint32_t ComponentCount = 2;
+
+		struct Endpoints
+		{
+			int values[2];
+		};
+
+		const Encoder& encoder;
+		const BlockPixels& pixels;
+		// Endpoint order picks the mode, the search keeps it
+		bool sixValues;
+
+		const float* GetPositions() const { return Bc4Positions; }
+
+		bool IsValid(const Endpoints& endpoints) const
+		{
+			return sixValues ? endpoints.values[0] <= endpoints.values[1] : endpoints.values[0] > endpoints.values[1];
+		}
+
+		void Quantize(const float endpoints[2][4], Endpoints& result) const
+		{
+			// Larger value first for the eight value mode
+			const int low = Clamp(static_cast<int>(std::lround(std::min(endpoints[0][0], endpoints[1][0]))), 0, 255);
+			const int high = Clamp(static_cast<int>(std::lround(std::max(endpoints[0][0], endpoints[1][0]))), 0, 255);
+			result.values[0] = sixValues ? low : high;
+			result.values[1] = sixValues ? high : low;
+			if (!sixValues && low == high)
+			{
+				if (high < 255)
+					result.values[0]++;
+				else
+					result.values[1]--;
+			}
+		}
+
+		bool Step(Endpoints& endpoints, uint32_t component, int step) const
+		{
+			Endpoints candidate = endpoints;
+			candidate.values[component] += step;
+			if (candidate.values[component] < 0 || candidate.values[component] > 255 || !IsValid(candidate))
+				return false;
+			endpoints = candidate;
+			return true;
+		}
+
+		void BuildPalette(const Endpoints& endpoints, float palette[8][4]) const
+		{
+			const int a0 = endpoints.values[0];
+			const int a1 = endpoints.values[1];
+			std::memset(palette, 0, sizeof(float) * 8 * 4);
+			palette[0][0] = static_cast<float>(a0);
+			palette[1][0] = static_cast<float>(a1);
+			if (a0 > a1)
+			{
+				for (int i = 2; i < 8; i++)
+				{
+					palette[i][0] = static_cast<float>(((8 - i) * a0 + (i - 1) * a1 + 3) / 7);
+				}
+			}
+			else
+			{
+				for (int i = 2; i < 6; i++)
+				{
+					palette[i][0] = static_cast<float>(((6 - i) * a0 + (i - 1) * a1 + 2) / 5);
+				}
+				palette[6][0] = 0.0f;
+				palette[7][0] = 255.0f;
+			}
+		}
+
+		float Evaluate(const Endpoints& endpoints, uint8_t* pIndices) const
+		{
+			float palette[8][4];
+			BuildPalette(endpoints, palette);
+			return encoder.findIndices(pixels, palette, 8, SingleWeights, pIndices);
+		}
+
+		static void Write(const Endpoints& endpoints, const uint8_t* pIndices, uint8_t* pBlock)
+		{
+			uint64_t indices = 0;
+			for (uint32_t p = 0; p < 16; p++)
+			{
+				indices |= static_cast<uint64_t>(pIndices[p]) << (p * 3);
+			}
+			pBlock[0] = static_cast<uint8_t>(endpoints.values[0]);
+			pBlock[1] = static_cast<uint8_t>(endpoints.values[1]);
+			WriteLittleEndian(pBlock + 2, indices, 6);
+		}
+	};
+
+	// BC7 mode 6: one subset, RGBA endpoints of 7 bits plus a p-bit each, 4 bit indices
+	struct Bc7Format
+	{
+		static const uint32_t ChannelCount = 4;
+		// Eight 7 bit values and the two p-bits
+		static const uint32_t ComponentCount = 10;
+
+		struct Endpoints
+		{
+			int values[2][4];
+			int pBits[2];
+		};
+
+		const Encoder& encoder;
+		const BlockPixels& pixels;
+
+		// Positions of the 16 weights, used for the least squares fit
+		float positions[16];
+
+		Bc7Format(const Encoder& blockEncoder, const BlockPixels& blockPixels)
+			: encoder(blockEncoder), pixels(blockPixels)
+		{
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				positions[i] = Bc7Weights[i] / 64.0f;
+			}
+		}
+
+		const float* GetPositions() const { return positions; }
+
+		void Quantize(const float endpoints[2][4], Endpoints& result) const
+		{
+			// Each endpoint takes the p-bit that lands closer
+			for (uint32_t e = 0; e < 2; e++)
+			{
+				float bestError = MaxError;
+				for (int pBit = 0; pBit < 2; pBit++)
+				{
+					int values[4];
+					float error = 0.0f;
+					for (uint32_t c = 0; c < 4; c++)
+					{
+						values[c] = Clamp(static_cast<int>(std::lround((endpoints[e][c] - pBit) / 2.0f)), 0, 127);
+						const float difference = static_cast<float>((values[c] << 1) | pBit) - endpoints[e][c];
+						error += difference * difference;
+					}
+					if (error < bestError)
+					{
+						bestError = error;
+						std::copy(values, values + 4, result.values[e]);
+						result.pBits[e] = pBit;
+					}
+				}
+			}
+		}
+
+		bool Step(Endpoints& endpoints, uint32_t component, int step) const
+		{
+			if (component >= 8)
+			{
+				// A p-bit only has one other value
+				if (step > 0)
+					return false;
+				endpoints.pBits[component - 8] ^= 1;
+				return true;
+			}
+
+			int& value = endpoints.values[component / 4][component % 4];
+			if (value + step < 0 || value + step > 127)
+				return false;
+			value += step;
+			return true;
+		}
+
+		float Evaluate(const Endpoints& endpoints, uint8_t* pIndices) const
+		{
+			int expanded[2][4];
+			for (uint32_t e = 0; e < 2; e++)
+			{
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					expanded[e][c] = (endpoints.values[e][c] << 1) | endpoints.pBits[e];
+				}
+			}
+
+			float palette[16][4];
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					palette[i][c] = static_cast<float>(((64 - Bc7Weights[i]) * expanded[0][c] + Bc7Weights[i] * expanded[1][c] + 32) >> 6);
+				}
+			}
+			return encoder.findIndices(pixels, palette, 16, RgbaWeights, pIndices);
+		}
+
+		static void Write(Endpoints endpoints, const uint8_t* pIndices, uint8_t* pBlock)
+		{
+			// The first index is stored without its top bit, swap the endpoints if it is set
+			uint8_t indices[16];
+			const bool swap = pIndices[0] >= 8;
+			for (uint32_t p = 0; p < 16; p++)
+			{
+				indices[p] = swap ? static_cast<uint8_t>(15 - pIndices[p]) : pIndices[p];
+			}
+			if (swap)
+			{
+				std::swap(endpoints.values[0], endpoints.values[1]);
+				std::swap(endpoints.pBits[0], endpoints.pBits[1]);
+			}
+
+			uint64_t bits[2] = {};
+			uint32_t position = 0;
+			const auto writeBits = [&](uint64_t value, uint32_t count)
+			{
+				for (uint32_t i = 0; i < count; i++, position++)
+				{
+					bits[position / 64] |= ((value >> i) & 1) << (position % 64);
+				}
+			};
+
+			writeBits(1 << 6, 7);
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				writeBits(endpoints.values[0][c], 7);
+				writeBits(endpoints.values[1][c], 7);
+			}
+			writeBits(endpoints.pBits[0], 1);
+			writeBits(endpoints.pBits[1], 1);
+			writeBits(indices[0], 3);
+			for (uint32_t p = 1; p < 16; p++)
+			{
+				writeBits(indices[p], 4);
+			}
+
+			WriteLittleEndian(pBlock, bits[0], 8);
+			WriteLittleEndian(pBlock + 8, bits[1], 8);
+		}
+	};
+
+	void EncodeColor(const Encoder& encoder, const BlockPixels& pixels, uint8_t* pBlock)
+	{
+		const ColorFormat format = { encoder, pixels };
+		ColorFormat::Endpoints endpoints;
+		uint8_t indices[16];
+		SearchEndpoints(encoder, format, pixels, endpoints, indices);
+		ColorFormat::Write(endpoints, indices, pBlock);
+	}
+
+	void EncodeSingle(const Encoder& encoder, const BlockPixels& pixels, uint32_t channel, uint8_t* pBlock)
+	{
+		BlockPixels single = {};
+		std::copy(pixels.channels[channel], pixels.channels[channel] + 16, single.channels[0]);
+
+		const SingleFormat eightValues = { encoder, single, false };
+		SingleFormat::Endpoints endpoints;
+		uint8_t indices[16];
+		const float error = SearchEndpoints(encoder, eightValues, single, endpoints, indices);
+
+		// Blocks touching 0 or 255 may do better with those two for free and six values spread over the rest
+		const bool hasExtremes = std::any_of(single.channels[0], single.channels[0] + 16, [](float value) { return value == 0.0f || value == 255.0f; });
+		if (encoder.quality != BlockQuality::Fast && hasExtremes && error > 0.0f)
+		{
+			float interior[2][4] = { { 255.0f }, { 0.0f } };
+			for (uint32_t p = 0; p < 16; p++)
+			{
+				const float value = single.channels[0][p];
+				if (value != 0.0f && value != 255.0f)
+				{
+					interior[0][0] = std::min(interior[0][0], value);
+					interior[1][0] = std::max(interior[1][0], value);
+				}
+			}
+			if (interior[0][0] > interior[1][0])
+				interior[0][0] = interior[1][0];
+
+			const SingleFormat sixValues = { encoder, single, true };
+			SingleFormat::Endpoints candidate;
+			sixValues.Quantize(interior, candidate);
+			uint8_t candidateIndices[16];
+			float candidateError = sixValues.Evaluate(candidate, candidateIndices);
+
+			if (encoder.quality == BlockQuality::High)
+			{
+				bool improved = true;
+				for (uint32_t pass = 0; pass < 8 && improved; pass++)
+				{
+					improved = false;
+					for (uint32_t component = 0; component < SingleFormat::ComponentCount; component++)
+					{
+						for (int step : { -1, 1 })
+						{
+							SingleFormat::Endpoints stepped = candidate;
+							uint8_t steppedIndices[16];
+							if (!sixValues.Step(stepped, component, step))
+								continue;
+							const float steppedError = sixValues.Evaluate(stepped, steppedIndices);
+							if (steppedError < candidateError)
+							{
+								candidate = stepped;
+								candidateError = steppedError;
+								std::copy(steppedIndices, steppedIndices + 16, candidateIndices);
+								improved = true;
+							}
+						}
+					}
+				}
+			}
+
+			if (candidateError < error)
+			{
+				endpoints = candidate;
+				std::copy(candidateIndices, candidateIndices + 16, indices);
+			}
+		}
+
+		SingleFormat::Write(endpoints, indices, pBlock);
+	}
+
+	void EncodeBc7(const Encoder& encoder, const BlockPixels& pixels, uint8_t* pBlock)
+	{
+		const Bc7Format format(encoder, pixels);
+		Bc7Format::Endpoints endpoints;
+		uint8_t indices[16];
+		SearchEndpoints(encoder, format, pixels, endpoints, indices);
+		Bc7Format::Write(endpoints, indices, pBlock);
+	}
+
+	void EncodeBlock(const Encoder& encoder, BlockFormat format, const BlockPixels& pixels, uint8_t* pBlock)
+	{
+		switch (format)
+		{
+		case BlockFormat::BC1:
+			EncodeColor(encoder, pixels, pBlock);
+			break;
+		case BlockFormat::BC3:
+			EncodeSingle(encoder, pixels, 3, pBlock);
+			EncodeColor(encoder, pixels, pBlock + 8);
+			break;
+		case BlockFormat::BC5:
+			EncodeSingle(encoder, pixels, 0, pBlock);
+			EncodeSingle(encoder, pixels, 1, pBlock + 8);
+			break;
+		default:
+			EncodeBc7(encoder, pixels, pBlock);
+			break;
+		}
+	}
+
+	void CompressBlockRows(const Encoder& encoder, BlockFormat format, uint32_t width, uint32_t height, const uint8_t* pSource, uint64_t sourceRowPitch,
+		uint8_t* pDest, uint64_t destRowPitch, uint32_t firstBlockRow, uint32_t blockRowCount)
+	{
+		const uint32_t blockSize = BlockCompressor::GetBlockSize(format);
+		const uint32_t blocksWide = BlockCompressor::GetBlockCount(width);
+		for (uint32_t by = firstBlockRow; by < firstBlockRow + blockRowCount; by++)
+		{
+			for (uint32_t bx = 0; bx < blocksWide; bx++)
+			{
+				BlockPixels pixels;
+				for (uint32_t p = 0; p < 16; p++)
+				{
+					const uint32_t x = std::min(bx * 4 + p % 4, width - 1);
+					const uint32_t y = std::min(by * 4 + p / 4, height - 1);
+					const uint8_t* pPixel = pSource + y * sourceRowPitch + x * 4;
+					for (uint32_t c = 0; c < 4; c++)
+					{
+						pixels.channels[c][p] = pPixel[c];
+					}
+				}
+				EncodeBlock(encoder, format, pixels, pDest + by * destRowPitch + bx * blockSize);
+			}
+		}
+	}
+}
+
+uint32_t BlockCompressor::GetBlockSize(BlockFormat format)
+{
+	return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+void BlockCompressor::CompressBlock(const Settings& settings, const uint8_t* pPixels, uint8_t* pBlock)
+{
+	BlockPixels pixels;
+	for (uint32_t p = 0; p < 16; p++)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			pixels.channels[c][p] = pPixels[p * 4 + c];
+		}
+	}
+	EncodeBlock(GetEncoder(settings), settings.format, pixels, pBlock);
+}
+
+void BlockCompressor::Compress(const Settings& settings, uint32_t width, uint32_t height, const uint8_t* pSource, uint64_t sourceRowPitch,
+	uint8_t* pDest, uint64_t destRowPitch, JobSystem* pJobSystem)
+{
+	const Encoder encoder = GetEncoder(settings);
+	const uint32_t blockRows = GetBlockCount(height);
+	const uint32_t jobCount = (blockRows + BlockRowsPerJob - 1) / BlockRowsPerJob;
+	if (!pJobSystem || jobCount <= 1)
+	{
+		CompressBlockRows(encoder, settings.format, width, height, pSource, sourceRowPitch, pDest, destRowPitch, 0, blockRows);
+		return;
+	}
+
+	pJobSystem->ParallelFor(jobCount, [&](unsigned int job, unsigned int)
+	{
+		const uint32_t firstBlockRow = job * BlockRowsPerJob;
+		CompressBlockRows(encoder, settings.format, width, height, pSource, sourceRowPitch, pDest, destRowPitch,
+			firstBlockRow, std::min(BlockRowsPerJob, blockRows - firstBlockRow));
+	});
+}
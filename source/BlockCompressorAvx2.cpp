@@ -0,0 +1,52 @@
+#include "BlockCompressorKernels.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+// Built with AVX2 code generation, only called once the CPU reported support for it
+
+float FindIndicesAvx2(const BlockPixels& pixels, const float (*pPalette)[4], uint32_t paletteSize, const float* pWeights, uint8_t* pIndices)
+{
+	const __m256 weights[4] = { _mm256_set1_ps(pWeights[0]), _mm256_set1_ps(pWeights[1]), _mm256_set1_ps(pWeights[2]), _mm256_set1_ps(pWeights[3]) };
+
+	__m256 total = _mm256_setzero_ps();
+	// Eight pixels per pass
+	for (uint32_t half = 0; half < 2; half++)
+	{
+		__m256 values[4];
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			values[c] = _mm256_loadu_ps(pixels.channels[c] + half * 8);
+		}
+
+		__m256 bestError = _mm256_set1_ps(3.0e38f);
+		__m256i bestIndex = _mm256_setzero_si256();
+		for (uint32_t i = 0; i < paletteSize; i++)
+		{
+			__m256 error = _mm256_setzero_ps();
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				const __m256 difference = _mm256_sub_ps(values[c], _mm256_set1_ps(pPalette[i][c]));
+				error = _mm256_fmadd_ps(_mm256_mul_ps(difference, difference), weights[c], error);
+			}
+
+			const __m256 closer = _mm256_cmp_ps(error, bestError, _CMP_LT_OQ);
+			bestError = _mm256_blendv_ps(bestError, error, closer);
+			bestIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestIndex), _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(i))), closer));
+		}
+		total = _mm256_add_ps(total, bestError);
+
+		const __m256i words = _mm256_packus_epi32(bestIndex, bestIndex);
+		const __m256i bytes = _mm256_packus_epi16(words, words);
+		const __m128i indices = _mm_unpacklo_epi32(_mm256_castsi256_si128(bytes), _mm256_extracti128_si256(bytes, 1));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(pIndices + half * 8), indices);
+	}
+
+	__m128 sum = _mm_add_ps(_mm256_castps256_ps128(total), _mm256_extractf128_ps(total, 1));
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum);
+}
+
+#endif
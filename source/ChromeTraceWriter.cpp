@@ -0,0 +1,377 @@
+#include "ChromeTraceWriter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+namespace
+{
+	// Protobuf wire format, as much as the Perfetto packets below need
+	class ProtoWriter
+	{
+	public:
+		void AddVarint(uint32_t field, uint64_t value)
+		{
+			AddRawVarint(static_cast<uint64_t>(field) << 3);
+			AddRawVarint(value);
+		}
+
+		void AddDouble(uint32_t field, double value)
+		{
+			AddRawVarint(static_cast<uint64_t>(field) << 3 | 1);
+			uint8_t bytes[sizeof(value)];
+			memcpy(bytes, &value, sizeof(value));
+			mData.insert(mData.end(), bytes, bytes + sizeof(bytes));
+		}
+
+		void AddBytes(uint32_t field, const void* pData, size_t size)
+		{
+			AddRawVarint(static_cast<uint64_t>(field) << 3 | 2);
+			AddRawVarint(size);
+			mData.insert(mData.end(), static_cast<const uint8_t*>(pData), static_cast<const uint8_t*>(pData) + size);
+		}
+
+		void AddString(uint32_t field, const std::string& value) { AddBytes(field, value.data(), value.size()); }
+		void AddMessage(uint32_t field, const ProtoWriter& message) { AddBytes(field, message.mData.data(), message.mData.size()); }
+
+		const std::vector<uint8_t>& GetData() const { return mData; }
+
+	private:
+		void AddRawVarint(uint64_t value)
+		{
+			for (; value >= 0x80; value >>= 7)
+				mData.push_back(static_cast<uint8_t>(value | 0x80));
+			mData.push_back(static_cast<uint8_t>(value));
+		}
+
+		std::vector<uint8_t> mData;
+	};
+
+	// Field numbers from Perfetto's trace_packet.proto, track_descriptor.proto and track_event.proto
+	namespace Perfetto
+	{
+		const uint32_t TracePacket = 1;
+
+		const uint32_t PacketTimestamp = 8;
+		const uint32_t PacketSequenceId = 10;
+		const uint32_t PacketTrackEvent = 11;
+		const uint32_t PacketSequenceFlags = 13;
+		const uint32_t PacketTrackDescriptor = 60;
+		const uint64_t SequenceIncrementalStateCleared = 1;
+
+		const uint32_t TrackUuid = 1;
+		const uint32_t TrackName = 2;
+		const uint32_t TrackProcess = 3;
+		const uint32_t TrackParentUuid = 5;
+		const uint32_t TrackCounter = 8;
+		const uint32_t ProcessPid = 1;
+		const uint32_t ProcessName = 6;
+
+		const uint32_t EventType = 9;
+		const uint32_t EventTrackUuid = 11;
+		const uint32_t EventCategories = 22;
+		const uint32_t EventName = 23;
+		const uint32_t EventDoubleCounterValue = 44;
+		const uint64_t TypeSliceBegin = 1;
+		const uint64_t TypeSliceEnd = 2;
+		const uint64_t TypeInstant = 3;
+		const uint64_t TypeCounter = 4;
+	}
+
+	uint64_t ToNanoseconds(double microseconds)
+	{
+		return microseconds > 0.0 ? static_cast<uint64_t>(std::llround(microseconds * 1000.0)) : 0;
+	}
+}
+
+ChromeTraceWriter::ChromeTraceWriter(size_t maxEvents)
+	: mMaxEvents(maxEvents)
+{
+}
+
+void ChromeTraceWriter::AddCompleteEvent(const char* name, const char* category, uint32_t processId, uint32_t threadId, double timestamp, double duration)
+{
+	AddEvent({ name, category, 'X', processId, threadId, timestamp, duration });
+}
+
+void ChromeTraceWriter::AddInstantEvent(const char* name, const char* category, uint32_t processId, uint32_t threadId, double timestamp)
+{
+	AddEvent({ name, category, 'i', processId, threadId, timestamp, 0.0 });
+}
+
+void ChromeTraceWriter::AddCounterEvent(const char* name, uint32_t processId, double timestamp, double value)
+{
+	AddEvent({ name, "counter", 'C', processId, 0, timestamp, value });
+}
+
+void ChromeTraceWriter::SetProcessName(uint32_t processId, const char* name)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mEvents.push_back({ name, "process_name", 'M', processId, 0, 0.0, 0.0 });
+}
+
+void ChromeTraceWriter::SetThreadName(uint32_t processId, uint32_t threadId, const char* name)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mEvents.push_back({ name, "thread_name", 'M', processId, threadId, 0.0, 0.0 });
+}
+
+std::string ChromeTraceWriter::ToJson() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::string json;
+	json.reserve(64 + mEvents.size() * 96);
+	json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	char number[128];
+	for (size_t i = 0; i < mEvents.size(); i++)
+	{
+		const Event& event = mEvents[i];
+		json += i == 0 ? "\n{" : ",\n{";
+
+		// Metadata events carry their label as an argument, the category slot holds the metadata name
+		if (event.phase == 'M')
+		{
+			json += "\"name\":\"";
+			json += event.category;
+			json += "\",\"ph\":\"M\"";
+			snprintf(number, sizeof(number), ",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":", event.processId, event.threadId);
+			json += number;
+			AppendEscaped(json, event.name);
+			json += "}}";
+			continue;
+		}
+
+		json += "\"name\":";
+		AppendEscaped(json, event.name);
+		json += ",\"cat\":";
+		AppendEscaped(json, event.category ? event.category : "");
+
+		switch (event.phase)
+		{
+		case 'i':
+			// Thread scoped instant
+			snprintf(number, sizeof(number), ",\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f}",
+				event.processId, event.threadId, event.timestamp);
+			break;
+		case 'C':
+			snprintf(number, sizeof(number), ",\"ph\":\"C\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%.17g}}",
+				event.processId, event.threadId, event.timestamp, event.duration);
+			break;
+		default:
+			snprintf(number, sizeof(number), ",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				event.processId, event.threadId, event.timestamp, event.duration);
+			break;
+		}
+		json += number;
+	}
+
+	json += "\n]}\n";
+	return json;
+}
+
+std::vector<uint8_t> ChromeTraceWriter::ToPerfetto() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	// Labels first, metadata events may come after the events they name
+	std::map<uint32_t, std::string> processNames;
+	std::map<std::pair<uint32_t, uint32_t>, std::string> threadNames;
+	for (const Event& event : mEvents)
+	{
+		if (event.phase != 'M')
+			continue;
+		if (strcmp(event.category, "process_name") == 0)
+			processNames[event.processId] = event.name;
+		else
+			threadNames[{ event.processId, event.threadId }] = event.name;
+	}
+
+	ProtoWriter trace;
+	uint64_t nextUuid = 1;
+	bool firstPacket = true;
+	const auto addDescriptor = [&](const ProtoWriter& descriptor)
+	{
+		ProtoWriter packet;
+		packet.AddVarint(Perfetto::PacketSequenceId, 1);
+		if (firstPacket)
+			packet.AddVarint(Perfetto::PacketSequenceFlags, Perfetto::SequenceIncrementalStateCleared);
+		packet.AddMessage(Perfetto::PacketTrackDescriptor, descriptor);
+		trace.AddMessage(Perfetto::TracePacket, packet);
+		firstPacket = false;
+	};
+
+	std::map<uint32_t, uint64_t> processTracks;
+	const auto getProcessTrack = [&](uint32_t processId)
+	{
+		auto inserted = processTracks.emplace(processId, nextUuid);
+		if (inserted.second)
+		{
+			// Offset by one, pid 0 is the idle task to the trace processor
+			ProtoWriter process;
+			process.AddVarint(Perfetto::ProcessPid, static_cast<uint64_t>(processId) + 1);
+			auto name = processNames.find(processId);
+			process.AddString(Perfetto::ProcessName, name != processNames.end() ? name->second : "Process " + std::to_string(processId));
+
+			ProtoWriter descriptor;
+			descriptor.AddVarint(Perfetto::TrackUuid, nextUuid++);
+			descriptor.AddMessage(Perfetto::TrackProcess, process);
+			addDescriptor(descriptor);
+		}
+		return inserted.first->second;
+	};
+
+	// Threads and counters are plain named tracks under their process
+	std::map<std::pair<uint32_t, std::string>, uint64_t> childTracks;
+	const auto getChildTrack = [&](uint32_t processId, const std::string& name, bool counter)
+	{
+		const uint64_t parent = getProcessTrack(processId);
+		auto inserted = childTracks.emplace(std::make_pair(processId, (counter ? "C" : "T") + name), nextUuid);
+		if (inserted.second)
+		{
+			ProtoWriter descriptor;
+			descriptor.AddVarint(Perfetto::TrackUuid, nextUuid++);
+			descriptor.AddVarint(Perfetto::TrackParentUuid, parent);
+			descriptor.AddString(Perfetto::TrackName, name);
+			if (counter)
+				descriptor.AddMessage(Perfetto::TrackCounter, ProtoWriter());
+			addDescriptor(descriptor);
+		}
+		return inserted.first->second;
+	};
+	const auto getThreadTrack = [&](uint32_t processId, uint32_t threadId)
+	{
+		auto name = threadNames.find({ processId, threadId });
+		return getChildTrack(processId, name != threadNames.end() ? name->second : "Thread " + std::to_string(threadId), false);
+	};
+
+	// Complete events become a begin and an end. At the same time ends go first, then begins, longer slices
+	// first, then the ends of empty slices, so each track's slices nest the way the JSON ones do.
+	struct Edge
+	{
+		uint64_t timestamp;
+		uint32_t order;
+		uint64_t end;
+		const Event* pEvent;
+		bool isEnd;
+	};
+	std::vector<Edge> edges;
+	edges.reserve(mEvents.size() * 2);
+	for (const Event& event : mEvents)
+	{
+		if (event.phase == 'M')
+			continue;
+
+		const uint64_t begin = ToNanoseconds(event.timestamp);
+		const uint64_t end = event.phase == 'X' ? ToNanoseconds(event.timestamp + event.duration) : begin;
+		edges.push_back({ begin, 1, end, &event, false });
+		if (event.phase == 'X')
+			edges.push_back({ end, end > begin ? 0u : 2u, end, &event, true });
+	}
+	std::stable_sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b)
+	{
+		if (a.timestamp != b.timestamp)
+			return a.timestamp < b.timestamp;
+		if (a.order != b.order)
+			return a.order < b.order;
+		return a.order == 1 && a.end > b.end;
+	});
+
+	for (const Edge& edge : edges)
+	{
+		const Event& event = *edge.pEvent;
+
+		ProtoWriter trackEvent;
+		if (event.phase == 'C')
+		{
+			trackEvent.AddVarint(Perfetto::EventType, Perfetto::TypeCounter);
+			trackEvent.AddVarint(Perfetto::EventTrackUuid, getChildTrack(event.processId, event.name, true));
+			trackEvent.AddDouble(Perfetto::EventDoubleCounterValue, event.duration);
+		}
+		else
+		{
+			trackEvent.AddVarint(Perfetto::EventType,
+				edge.isEnd ? Perfetto::TypeSliceEnd : event.phase == 'i' ? Perfetto::TypeInstant : Perfetto::TypeSliceBegin);
+			trackEvent.AddVarint(Perfetto::EventTrackUuid, getThreadTrack(event.processId, event.threadId));
+			if (!edge.isEnd)
+			{
+				if (event.category)
+					trackEvent.AddString(Perfetto::EventCategories, event.category);
+				trackEvent.AddString(Perfetto::EventName, event.name);
+			}
+		}
+
+		ProtoWriter packet;
+		packet.AddVarint(Perfetto::PacketTimestamp, edge.timestamp);
+		packet.AddVarint(Perfetto::PacketSequenceId, 1);
+		packet.AddMessage(Perfetto::PacketTrackEvent, trackEvent);
+		trace.AddMessage(Perfetto::TracePacket, packet);
+	}
+	return trace.GetData();
+}
+
+bool ChromeTraceWriter::Write(const std::filesystem::path& path) const
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+	const std::filesystem::path extension = path.extension();
+	if (extension == ".pftrace" || extension == ".perfetto-trace")
+	{
+		const std::vector<uint8_t> data = ToPerfetto();
+		return static_cast<bool>(file.write(reinterpret_cast<const char*>(data.data()), data.size()));
+	}
+
+	const std::string json = ToJson();
+	return static_cast<bool>(file.write(json.data(), json.size()));
+}
+
+size_t ChromeTraceWriter::GetEventCount() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mEvents.size();
+}
+
+void ChromeTraceWriter::Clear()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mEvents.clear();
+}
+
+void ChromeTraceWriter::AddEvent(Event&& event)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mEvents.size() < mMaxEvents)
+		mEvents.push_back(std::move(event));
+}
+
+void ChromeTraceWriter::AppendEscaped(std::string& json, const std::string& text)
+{
+	json += '"';
+	for (char c : text)
+	{
+		switch (c)
+		{
+		case '"': json += "\\\""; break;
+		case '\\': json += "\\\\"; break;
+		case '\n': json += "\\n"; break;
+		case '\t': json += "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				json += escaped;
+			}
+			else
+			{
+				json += c;
+			}
+			break;
+		}
+	}
+	json += '"';
+}
@@ -0,0 +1,30 @@
+#include "CommandListPool.h"
+#include "DXHelper.h"
+
+void CommandListPool::Init(ID3D12Device* pDevice, D3D12_COMMAND_LIST_TYPE type)
+{
+	mDevice = pDevice;
+	mType = type;
+	ThrowIfFailed(mDevice->CreateCommandAllocator(mType, IID_PPV_ARGS(&mCommandAllocator)));
+}
+
+void CommandListPool::Reset()
+{
+	ThrowIfFailed(mCommandAllocator->Reset());
+	mUsedCount = 0;
+}
+
+ID3D12GraphicsCommandList* CommandListPool::Acquire(ID3D12PipelineState* pInitialState)
+{
+	if (mUsedCount == mCommandLists.size())
+	{
+		ComPtr<ID3D12GraphicsCommandList> commandList;
+		ThrowIfFailed(mDevice->CreateCommandList(0, mType, mCommandAllocator.Get(), pInitialState, IID_PPV_ARGS(&commandList)));
+		mCommandLists.push_back(commandList);
+		return mCommandLists[mUsedCount++].Get();
+	}
+
+	ID3D12GraphicsCommandList* pCommandList = mCommandLists[mUsedCount++].Get();
+	ThrowIfFailed(pCommandList->Reset(mCommandAllocator.Get(), pInitialState));
+	return pCommandList;
+}
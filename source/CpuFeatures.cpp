@@ -0,0 +1,68 @@
+#include "CpuFeatures.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CPU_FEATURES_X64 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace
+{
+	struct Features
+	{
+		bool sse41 = false;
+		bool avx2 = false;
+
+		Features()
+		{
+#if defined(CPU_FEATURES_X64) && defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			const int maxLeaf = info[0];
+			__cpuid(info, 1);
+			sse41 = (info[2] & (1 << 19)) != 0;
+			const bool fma = (info[2] & (1 << 12)) != 0;
+			const bool f16c = (info[2] & (1 << 29)) != 0;
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			const bool avx = (info[2] & (1 << 28)) != 0;
+			// The OS must save the YMM registers too
+			const bool ymmEnabled = osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+			if (maxLeaf >= 7 && ymmEnabled && fma && f16c)
+			{
+				__cpuidex(info, 7, 0);
+				avx2 = (info[1] & (1 << 5)) != 0;
+			}
+#elif defined(CPU_FEATURES_X64)
+			__builtin_cpu_init();
+			sse41 = __builtin_cpu_supports("sse4.1");
+			avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+#endif
+		}
+	};
+
+	const Features& GetFeatures()
+	{
+		static const Features features;
+		return features;
+	}
+}
+
+bool CpuFeatures::HasSse41()
+{
+	return GetFeatures().sse41;
+}
+
+bool CpuFeatures::HasAvx2()
+{
+	return GetFeatures().avx2;
+}
+
+bool CpuFeatures::HasNeon()
+{
+#if defined(_M_ARM64) || defined(__aarch64__)
+	return true;
+#else
+	return false;
+#endif
+}
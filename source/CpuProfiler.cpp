@@ -0,0 +1,148 @@
+#include "CpuProfiler.h"
+
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> CpuProfiler::sEnabled(false);
+std::atomic<uint64_t> CpuProfiler::sDroppedEvents(0);
+
+struct CpuProfiler::Registry
+{
+	std::mutex mutex;
+	// Never freed, a thread may exit before its last events were flushed
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+	uint32_t nextThreadId = 1;
+
+	// Ticks to steady_clock, measured between the first enable and each flush
+	uint64_t startTicks = 0;
+	double startMicroseconds = 0.0;
+	double microsecondsPerTick = 0.0;
+};
+
+namespace
+{
+	double SteadyMicroseconds()
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+void CpuProfiler::SetEnabled(bool enabled)
+{
+	if (enabled)
+	{
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		if (registry.startTicks == 0)
+		{
+			registry.startTicks = GetTicks();
+			registry.startMicroseconds = SteadyMicroseconds();
+		}
+	}
+
+	sEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void CpuProfiler::SetThreadName(const char* name)
+{
+	ThreadBuffer* pBuffer = sThreadBuffer ? sThreadBuffer : RegisterThread();
+
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	pBuffer->name = name;
+	pBuffer->nameChanged = true;
+}
+
+void CpuProfiler::RecordCounter(const char* name, double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	Record(name, GetTicks(), bits, CounterEvent);
+}
+
+void CpuProfiler::RecordFrameMark()
+{
+	const uint64_t ticks = GetTicks();
+	Record("Frame", ticks, ticks, FrameEvent);
+}
+
+void CpuProfiler::Flush(ChromeTraceWriter& writer, uint32_t processId)
+{
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	if (registry.startTicks == 0)
+		return;
+
+	// Longer intervals give a better ratio, recalibrated on every flush
+	const uint64_t ticks = GetTicks();
+	const double microseconds = SteadyMicroseconds();
+	if (ticks > registry.startTicks && microseconds > registry.startMicroseconds)
+		registry.microsecondsPerTick = (microseconds - registry.startMicroseconds) / static_cast<double>(ticks - registry.startTicks);
+
+	for (const std::unique_ptr<ThreadBuffer>& pBuffer : registry.buffers)
+	{
+		if (pBuffer->nameChanged)
+		{
+			writer.SetThreadName(processId, pBuffer->threadId, pBuffer->name.c_str());
+			pBuffer->nameChanged = false;
+		}
+
+		const uint32_t write = pBuffer->writeIndex.load(std::memory_order_acquire);
+		uint32_t read = pBuffer->readIndex.load(std::memory_order_relaxed);
+		for (; read != write; read++)
+		{
+			const Event& event = pBuffer->events[read % BufferCapacity];
+			const double timestamp = TicksToMicroseconds(registry, event.begin);
+			switch (event.type)
+			{
+			case ScopeEvent:
+				writer.AddCompleteEvent(event.name, "cpu", processId, pBuffer->threadId, timestamp,
+					static_cast<double>(event.end - event.begin) * registry.microsecondsPerTick);
+				break;
+			case CounterEvent:
+			{
+				double value;
+				memcpy(&value, &event.end, sizeof(value));
+				writer.AddCounterEvent(event.name, processId, timestamp, value);
+				break;
+			}
+			case FrameEvent:
+				writer.AddInstantEvent(event.name, "frame", processId, pBuffer->threadId, timestamp);
+				break;
+			}
+		}
+
+		// Hands the slots back to the recording thread
+		pBuffer->readIndex.store(read, std::memory_order_release);
+	}
+}
+
+CpuProfiler::Registry& CpuProfiler::GetRegistry()
+{
+	static Registry registry;
+	return registry;
+}
+
+CpuProfiler::ThreadBuffer* CpuProfiler::RegisterThread()
+{
+	auto pBuffer = std::make_unique<ThreadBuffer>();
+	pBuffer->events = std::make_unique<Event[]>(BufferCapacity);
+	pBuffer->nameChanged = false;
+	pBuffer->writeIndex = 0;
+	pBuffer->cachedReadIndex = 0;
+	pBuffer->readIndex = 0;
+
+	Registry& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	pBuffer->threadId = registry.nextThreadId++;
+	sThreadBuffer = pBuffer.get();
+	registry.buffers.push_back(std::move(pBuffer));
+	return sThreadBuffer;
+}
+
+double CpuProfiler::TicksToMicroseconds(const Registry& registry, uint64_t ticks)
+{
+	return registry.startMicroseconds + (static_cast<double>(ticks) - static_cast<double>(registry.startTicks)) * registry.microsecondsPerTick;
+}
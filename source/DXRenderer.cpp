@@ -1,6 +1,35 @@
 #include "DXRenderer.h"
-#include "WinCtx.h"
 #include "DXHelper.h"
+#include "BitmapFile.h"
+#include "DdsFile.h"
+#include "FormatConverter.h"
+#include "MappedFile.h"
+#include "ProceduralTexture.h"
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace
+{
+	DXGI_FORMAT GetBlockCompressedFormat(BlockFormat format, bool srgb)
+	{
+		switch (format)
+		{
+		case BlockFormat::BC1: return srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+		case BlockFormat::BC3: return srgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+		case BlockFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+		default: return srgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+		}
+	}
+
+	// Shaders output linear colour to sRGB views and scRGB float swap chains, sRGB codes to the rest
+	bool IsLinearTarget(DXGI_FORMAT format)
+	{
+		return FormatConverter::IsSrgb(format) || format == DXGI_FORMAT_R16G16B16A16_FLOAT;
+	}
+}
 
 
 DXRenderer::DXRenderer(UINT width, UINT height, std::wstring name)
@@ -9,13 +38,32 @@ DXRenderer::DXRenderer(UINT width, UINT height, std::wstring name)
 	mHeight(height), 
 	mTitle(name), 
 	mUseWarpDevice(false),
-	mFrameIndex(0), 
+	mHeadless(false),
+	mFrameLimit(DefaultFrameLimit),
+	mFrameLatencyWaitable(nullptr),
+	mMaxFrameLatency(DefaultMaxFrameLatency),
+	mVsync(true),
+	mTearingSupported(false),
+	mVertexBuffer(nullptr),
+	mTexture(nullptr),
+	mTextureIndex(0),
+	mCompressTextures(true),
+	mTextureFormat(DXGI_FORMAT_R8G8B8A8_UNORM),
 	mViewport(0.0f, 0.0f, static_cast<FLOAT>(width), static_cast<float>(height)),
 	mScissorRect(0, 0, static_cast<LONG>(width), static_cast<LONG>(height)),
-	mRtvDescrptiorSize(0)
+	mRtvDescrptiorSize(0),
+	mBackBufferFormat(DXGI_FORMAT_R8G8B8A8_UNORM),
+	mRenderTargetFormat(DXGI_FORMAT_R8G8B8A8_UNORM),
+	mRootSignatureHash(0)
 {
-	//WCHAR assetsPath[512];
-	//TODO: Setup Helper class
+	// Assets are deployed next to the executable
+	WCHAR modulePath[MAX_PATH];
+	const DWORD length = GetModuleFileNameW(nullptr, modulePath, _countof(modulePath));
+	if (length > 0 && length < _countof(modulePath))
+	{
+		mAssetsPath = modulePath;
+		mAssetsPath.erase(mAssetsPath.find_last_of(L'\\') + 1);
+	}
 
 	mAspectRatio = static_cast<float>(width) / static_cast<float>(height);
 }
@@ -24,13 +72,40 @@ DXRenderer::~DXRenderer()
 {
 }
 
-void DXRenderer::OnInit()
+void DXRenderer::OnInit(FrameHost* pHost, HWND hWnd)
 {
-	LoadPipeline();
+	if (!mTracePath.empty())
+	{
+		CpuProfiler::SetEnabled(true);
+		CpuProfiler::SetThreadName("Main");
+		mTraceWriter.SetProcessName(CpuTraceProcessId, "CPU");
+	}
+
+	mJobSystem = std::make_unique<JobSystem>();
+
+	if (!mBenchmarkPath.empty())
+	{
+		mBenchmark = std::make_unique<BenchmarkRecorder>(BenchmarkWarmupFrames, mFrameLimit);
+		mBenchmark->SetInfo("resolution", std::to_string(mWidth) + "x" + std::to_string(mHeight));
+		mBenchmark->SetInfo("headless", mHeadless ? "true" : "false");
+		mBenchmark->SetInfo("warp", mUseWarpDevice ? "true" : "false");
+		mBenchmark->SetInfo("vsync", mVsync ? "true" : "false");
+	}
+
+	mGpuProfiler.SetFrameListener([this](const std::vector<ProfileNode>& nodes, UINT64 fenceValue)
+	{
+		OnGpuFrameRetired(nodes, fenceValue);
+	});
+
+	LoadPipeline(hWnd);
 	LoadAssets();
+
+	// Headless runs stop after mFrameLimit frames, windows when they are closed
+	mFrameLoop.Init(this, pHost, FrameCount, mSwapChain ? mSwapChain->GetCurrentBackBufferIndex() : 0,
+		mHeadless ? mFrameLimit : 0, mBenchmark.get());
 }
 
-void DXRenderer::LoadPipeline()
+void DXRenderer::LoadPipeline(HWND hWnd)
 {
 	UINT dxgiFactoryFlags = 0;
 
@@ -65,31 +140,48 @@ void DXRenderer::LoadPipeline()
 		ThrowIfFailed(D3D12CreateDevice(hardwareAdapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&mDevice)));
 	}
 
+	mGpuAllocator.Init(mDevice.Get());
+	mRenderGraph.Init(mDevice.Get());
+
+	// Cached pipelines are only valid for the adapter and driver they were built with
+	ComPtr<IDXGIAdapter> adapter;
+	ThrowIfFailed(factory->EnumAdapterByLuid(mDevice->GetAdapterLuid(), IID_PPV_ARGS(&adapter)));
+	mPipelineCache.Init(mDevice.Get(), adapter.Get(), GetAssetFullPath(L"PipelineCache.bin"));
+
+	if (mBenchmark)
+	{
+		DXGI_ADAPTER_DESC adapterDesc;
+		ThrowIfFailed(adapter->GetDesc(&adapterDesc));
+		char adapterName[_countof(adapterDesc.Description) * 3];
+		WideCharToMultiByte(CP_UTF8, 0, adapterDesc.Description, -1, adapterName, sizeof(adapterName), nullptr, nullptr);
+		mBenchmark->SetInfo("adapter", adapterName);
+	}
+	mRootSignatureRegistry.Init(mDevice.Get(), GetAssetFullPath(L"RootSignatures.bin"));
+
+	// Enhanced barriers need both the runtime and the driver
+	D3D12_FEATURE_DATA_D3D12_OPTIONS12 options12 = {};
+	if (SUCCEEDED(mDevice->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS12, &options12, sizeof(options12))))
+	{
+		ResourceStateTracker::SetUseEnhancedBarriers(options12.EnhancedBarriersSupported == TRUE);
+	}
+
 	// Command Queue Description and Creation
 	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
 	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
 	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
 
 	ThrowIfFailed(mDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&mCommandQueue)));
+	mQueueFence.Init(mDevice.Get(), mCommandQueue.Get());
 
-	// Swap Chain Description and Creation
-	DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
-	swapChainDesc.BufferCount = FrameCount;
-	swapChainDesc.Width = mWidth;
-	swapChainDesc.Height = mHeight;
-	swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-	swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-	swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-	swapChainDesc.SampleDesc.Count = 1;
-
-	ComPtr<IDXGISwapChain1> swapChain;
-	ThrowIfFailed(factory->CreateSwapChainForHwnd(mCommandQueue.Get(), WinCtx::GetHwnd(), &swapChainDesc, nullptr, nullptr, &swapChain));
+	mGpuProfiler.Init(mDevice.Get(), mCommandQueue.Get(), FrameCount, MaxGpuScopesPerFrame);
+	if (!mTracePath.empty())
+		mGpuProfiler.SetTraceWriter(&mTraceWriter, GpuTraceProcessId);
 
-	// Block fullscreen transition
-	ThrowIfFailed(factory->MakeWindowAssociation(WinCtx::GetHwnd(), DXGI_MWA_NO_ALT_ENTER));
-
-	ThrowIfFailed(swapChain.As(&mSwapChain));
-	mFrameIndex = mSwapChain->GetCurrentBackBufferIndex();
+	// Swap Chain Description and Creation, without a window frames go into plain offscreen targets instead
+	if (hWnd)
+	{
+		CreateSwapChain(factory.Get(), hWnd);
+	}
 
 	// Descriptor Heap Creation
 	{
@@ -102,49 +194,106 @@ void DXRenderer::LoadPipeline()
 
 		mRtvDescrptiorSize = mDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 
-		// Shader Resource View
-		D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
-		srvHeapDesc.NumDescriptors = 1;
-		srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-		srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-		ThrowIfFailed(mDevice->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&mSrvHeap)));
+		// Shader visible CBV/SRV/UAV heap shared by every view, bindless, persistent and per-frame transient regions
+		mCbvSrvUavHeap.Init(mDevice.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, PersistentDescriptorCount, TransientDescriptorCount, BindlessDescriptorCount);
+		mBindlessTable.Init(mDevice.Get(), mCbvSrvUavHeap);
 	}
 
 	// Frame Resources Creation
 	{
 		CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(mRtvHeap->GetCPUDescriptorHandleForHeapStart());
 
+		// Offscreen targets start in COMMON, which is PRESENT as far as the tracker is concerned
+		const CD3DX12_HEAP_PROPERTIES defaultHeap(D3D12_HEAP_TYPE_DEFAULT);
+		const CD3DX12_RESOURCE_DESC targetDesc = CD3DX12_RESOURCE_DESC::Tex2D(mRenderTargetFormat, mWidth, mHeight, 1, 1, 1, 0,
+			D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+
+		// Flip model buffers can't be sRGB themselves, only their views, offscreen targets take the view format directly
+		D3D12_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+		rtvDesc.Format = mRenderTargetFormat;
+		rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
+
 		// One RTV for every frame
 		for (UINT n = 0; n < FrameCount; n++)
 		{
-			ThrowIfFailed(mSwapChain->GetBuffer(n, IID_PPV_ARGS(&mRenderTargets[n])));
-			mDevice->CreateRenderTargetView(mRenderTargets[n].Get(), nullptr, rtvHandle);
+			if (mSwapChain)
+			{
+				ThrowIfFailed(mSwapChain->GetBuffer(n, IID_PPV_ARGS(&mRenderTargets[n])));
+			}
+			else
+			{
+				ThrowIfFailed(mDevice->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &targetDesc,
+					D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&mRenderTargets[n])));
+			}
+			mDevice->CreateRenderTargetView(mRenderTargets[n].Get(), &rtvDesc, rtvHandle);
+			ResourceStateTracker::AddGlobalResourceState(mRenderTargets[n].Get(), D3D12_RESOURCE_STATE_PRESENT);
 			rtvHandle.Offset(1, mRtvDescrptiorSize);
 		}
 	}
 
-	ThrowIfFailed(mDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&mCommandAllocator)));
+	// One command list pool per recording thread and frame in flight
+	for (UINT n = 0; n < FrameCount; n++)
+	{
+		mFrames[n].commandListPools.resize(mJobSystem->GetThreadCount());
+		for (CommandListPool& pool : mFrames[n].commandListPools)
+		{
+			pool.Init(mDevice.Get(), D3D12_COMMAND_LIST_TYPE_DIRECT);
+		}
+		mFrames[n].graphCommandListPool.Init(mDevice.Get(), D3D12_COMMAND_LIST_TYPE_DIRECT);
+	}
+}
+
+void DXRenderer::CreateSwapChain(IDXGIFactory4* pFactory, HWND hWnd)
+{
+	DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
+	swapChainDesc.BufferCount = FrameCount;
+	swapChainDesc.Width = mWidth;
+	swapChainDesc.Height = mHeight;
+	swapChainDesc.Format = mBackBufferFormat;
+	swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+	swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+	swapChainDesc.SampleDesc.Count = 1;
+	swapChainDesc.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+
+	// Uncapped presents tear where the display allows it, otherwise they are still limited to the refresh rate
+	ComPtr<IDXGIFactory5> factory5;
+	BOOL allowTearing = FALSE;
+	if (SUCCEEDED(pFactory->QueryInterface(IID_PPV_ARGS(&factory5))) &&
+		SUCCEEDED(factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing))))
+	{
+		mTearingSupported = allowTearing == TRUE;
+	}
+	if (mTearingSupported)
+		swapChainDesc.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+
+	ComPtr<IDXGISwapChain1> swapChain;
+	ThrowIfFailed(pFactory->CreateSwapChainForHwnd(mCommandQueue.Get(), hWnd, &swapChainDesc, nullptr, nullptr, &swapChain));
+
+	// Block fullscreen transition
+	ThrowIfFailed(pFactory->MakeWindowAssociation(hWnd, DXGI_MWA_NO_ALT_ENTER));
+
+	ThrowIfFailed(swapChain.As(&mSwapChain));
+
+	// Waiting on this instead of Present blocking caps how many frames queue up ahead of the display
+	ThrowIfFailed(mSwapChain->SetMaximumFrameLatency(mMaxFrameLatency));
+	mFrameLatencyWaitable = mSwapChain->GetFrameLatencyWaitableObject();
 }
 
 void DXRenderer::LoadAssets()
 {
 	// Root Signature Creation
 	{
-		D3D12_FEATURE_DATA_ROOT_SIGNATURE featureData = {};
-		featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
-		if (FAILED(mDevice->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &featureData, sizeof(featureData))))
-		{
-			featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
-		}
-
+		// Bindless: every texture in one unbounded table, slots are filled and cleared while the table is bound
 		CD3DX12_DESCRIPTOR_RANGE1 ranges[1];
-		ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC);
+		ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0, 1,
+			D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE);
 
-		CD3DX12_ROOT_PARAMETER1 rootParam[1];
-		rootParam[0].InitAsDescriptorTable(1, &ranges[0], D3D12_SHADER_VISIBILITY_PIXEL);
+		CD3DX12_ROOT_PARAMETER1 rootParam[RootParameterCount];
+		rootParam[BindlessTableParameter].InitAsDescriptorTable(1, &ranges[0], D3D12_SHADER_VISIBILITY_PIXEL);
+		rootParam[DrawConstantsParameter].InitAsConstants(DrawConstantCount, 0, 0, D3D12_SHADER_VISIBILITY_PIXEL);
 
 		CD3DX12_STATIC_SAMPLER_DESC sampler = {};
-		sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
+		sampler.Filter = D3D12_FILTER_MIN_MAG_POINT_MIP_LINEAR;
 		sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
 		sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
 		sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
@@ -161,56 +310,31 @@ void DXRenderer::LoadAssets()
 		CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
 		rootSignatureDesc.Init_1_1(_countof(rootParam), rootParam, 1, &sampler, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
-		ComPtr<ID3DBlob> signature;
-		ComPtr<ID3DBlob> error;
-		ThrowIfFailed(D3DX12SerializeVersionedRootSignature(&rootSignatureDesc, featureData.HighestVersion, &signature, &error));
-		ThrowIfFailed(mDevice->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&mRootSignature)));
+		// Serialized once, later runs create it from the stored blob
+		mRootSignature = mRootSignatureRegistry.GetOrCreate(rootSignatureDesc, &mRootSignatureHash);
+		mRootSignatureRegistry.Save();
 	}
 
 	// Pipeline State Creation
 	{
-		// Shader Compilation 
-		ComPtr<ID3DBlob> vertexShader;
-		ComPtr<ID3DBlob> pixelShader;
-
-#if defined(_DEBUG)
-		UINT compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#else
-		UINT compileFlags = 0;
-#endif
+		// Precompiled to DXIL by tools/compile_shaders.py as a pre-build step, only mapped here
+		mShaderLibrary.Open(GetAssetFullPath(L"Shaders.dxsl"));
 
-		std::wstring shaderPath = L"D:\\Workspace\\DXRT\\Assets\\Shaders\\shader.hlsl";
+		mPipelineState = CreateScenePipeline(mShaderLibrary);
 
-		ThrowIfFailed(D3DCompileFromFile(shaderPath.c_str(), nullptr, nullptr, "VSMain", "vs_5_0", compileFlags, 0, &vertexShader, nullptr));
-		ThrowIfFailed(D3DCompileFromFile(shaderPath.c_str(), nullptr, nullptr, "PSMain", "ps_5_0", compileFlags, 0, &pixelShader, nullptr));
+		// Every pipeline is created at load, persist whatever had to be compiled
+		mPipelineCache.Save();
 
-		// Vertex Input Layout
-		D3D12_INPUT_ELEMENT_DESC inputElementDescs[] =
+		if (!mShaderReloadRoot.empty())
 		{
-			{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-			{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0}
-		};
-
-		D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
-		psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
-		psoDesc.pRootSignature = mRootSignature.Get();
-		psoDesc.VS = CD3DX12_SHADER_BYTECODE(vertexShader.Get());
-		psoDesc.PS = CD3DX12_SHADER_BYTECODE(pixelShader.Get());
-		psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
-		psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
-		psoDesc.DepthStencilState.DepthEnable = FALSE;
-		psoDesc.DepthStencilState.StencilEnable = FALSE;
-		psoDesc.SampleMask = UINT_MAX;
-		psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-		psoDesc.NumRenderTargets = 1;
-		psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
-		psoDesc.SampleDesc.Count = 1;
-		ThrowIfFailed(mDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&mPipelineState)));
+			mShaderHotReload.RegisterPipeline(&mPipelineState, { "shader.hlsl:VSMain", "shader.hlsl:PSMain" },
+				[this](const ShaderLibrary& library) { return CreateScenePipeline(library); });
+			mShaderHotReload.Start(mShaderReloadRoot, GetAssetFullPath(L"Shaders.dxsl"));
+		}
 	}
 
 
-	// Command List Creation and close it for now
-	ThrowIfFailed(mDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, mCommandAllocator.Get(), nullptr, IID_PPV_ARGS(&mCommandList)));
+	mUploadStreamer.Init(mDevice.Get(), StreamingStagingSize, UploadStreamer::DefaultBatchSize, mJobSystem.get());
 
 	// Vertex Buffer Creation
 	{
@@ -223,213 +347,402 @@ void DXRenderer::LoadAssets()
 
 		const UINT vertexBufferSize = sizeof(triangleVertices);
 
-		CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_UPLOAD);
 		CD3DX12_RESOURCE_DESC resourceDescBuffer = CD3DX12_RESOURCE_DESC::Buffer(vertexBufferSize);
+		mVertexBuffer = mGpuAllocator.CreateResource(D3D12_HEAP_TYPE_DEFAULT, resourceDescBuffer, D3D12_RESOURCE_STATE_COMMON, nullptr);
+		ResourceStateTracker::AddGlobalResourceState(mVertexBuffer->GetResource(), D3D12_RESOURCE_STATE_COMMON);
 
-		ThrowIfFailed(mDevice->CreateCommittedResource(
-			&heapProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&resourceDescBuffer,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(&mVertexBuffer)
-		));
-
-		// Copy triangle data to vertex buffer
-		UINT8* pVertexDataBegin;
-		CD3DX12_RANGE readRange(0, 0);
-		ThrowIfFailed(mVertexBuffer->Map(0, &readRange, reinterpret_cast<void**>(&pVertexDataBegin)));
-		memcpy(pVertexDataBegin, triangleVertices, sizeof(triangleVertices));
-		mVertexBuffer->Unmap(0, nullptr);
+		// Stream triangle data on the copy queue, the buffer decays back to COMMON once the copy queue is done
+		auto vertexData = std::make_shared<std::vector<Vertex>>(std::begin(triangleVertices), std::end(triangleVertices));
+		mUploadStreamer.EnqueueBuffer(mVertexBuffer->GetResource(), 0, vertexData->data(), vertexBufferSize, vertexData);
 
 		// Init v buffer view
-		mVertexBufferView.BufferLocation = mVertexBuffer->GetGPUVirtualAddress();
+		mVertexBufferView.BufferLocation = mVertexBuffer->GetResource()->GetGPUVirtualAddress();
 		mVertexBufferView.StrideInBytes = sizeof(Vertex);
 		mVertexBufferView.SizeInBytes = vertexBufferSize;
-	}
 
-	ComPtr<ID3D12Resource> textureUploadHeap;
+		mDrawItems.push_back({ mVertexBufferView, _countof(triangleVertices), 0 });
+	}
 
 	// Texture Creation
 	{
-		D3D12_RESOURCE_DESC textureDesc = {};
-		textureDesc.MipLevels = 1;
-		textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		textureDesc.Width = TextureWidth;
-		textureDesc.Height = TextureHeight;
-		textureDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-		textureDesc.DepthOrArraySize = 1;
-		textureDesc.SampleDesc.Count = 1;
-		textureDesc.SampleDesc.Quality = 0;
-		textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-
-
-		CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_DEFAULT);
-		ThrowIfFailed(mDevice->CreateCommittedResource(
-			&heapProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&textureDesc,
-			D3D12_RESOURCE_STATE_COPY_DEST,
-			nullptr,
-			IID_PPV_ARGS(&mTexture)));
-
-		const UINT64 uploadBufferSize = GetRequiredIntermediateSize(mTexture.Get(), 0, 1);
-
-		CD3DX12_HEAP_PROPERTIES heapProperties2(D3D12_HEAP_TYPE_UPLOAD);
-		CD3DX12_RESOURCE_DESC resourceDescBuffer = CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize);
-
-		ThrowIfFailed(mDevice->CreateCommittedResource(
-			&heapProperties2,
-			D3D12_HEAP_FLAG_NONE,
-			&resourceDescBuffer,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(&textureUploadHeap)));
-
-		std::vector<UINT8> texture = GenerateTextureData();
-
-		D3D12_SUBRESOURCE_DATA textureData = {};
-		textureData.pData = &texture[0];
-		textureData.RowPitch = TextureWidth * TexturePixelSize;
-		textureData.SlicePitch = textureData.RowPitch * TextureHeight;
-
-		UpdateSubresources(mCommandList.Get(), mTexture.Get(), textureUploadHeap.Get(), 0, 0, 1, &textureData);
-		auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(mTexture.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-		mCommandList->ResourceBarrier(1, &barrier);
+		const D3D12_RESOURCE_DESC textureDesc = mTexturePath.empty() ? CreateProceduralTexture() : LoadTextureFile(mTexturePath);
 
 		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 		srvDesc.Format = textureDesc.Format;
 		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		srvDesc.Texture2D.MipLevels = 1;
-		mDevice->CreateShaderResourceView(mTexture.Get(), &srvDesc, mSrvHeap->GetCPUDescriptorHandleForHeapStart());
-	}
+		srvDesc.Texture2D.MipLevels = textureDesc.MipLevels;
+		mTextureIndex = mBindlessTable.RegisterTexture(mTexture->GetResource(), &srvDesc);
 
-	ThrowIfFailed(mCommandList->Close());
-	ID3D12CommandList* ppCommandLists[] = { mCommandList.Get() };
-	mCommandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
-
-	// Synchronization Objects Creation
-	{
-		ThrowIfFailed(mDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence)));
-		mFenceValue = 1;
-
-		mFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-		if (mFenceEvent == nullptr)
-			ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
-
-		WaitForPreviousFrame();
+		// Every draw samples the one texture for now
+		for (DrawItem& draw : mDrawItems)
+		{
+			draw.textureIndex = mTextureIndex;
+		}
 	}
+
+	// Direct queue waits for the copies on the GPU timeline, the CPU carries on
+	mUploadStreamer.WaitOnQueue(mCommandQueue.Get(), mUploadStreamer.Flush());
 }
 
-std::vector<UINT8> DXRenderer::GenerateTextureData()
+// Checker with a full mip chain, block compressed or converted to the -texformat format
+D3D12_RESOURCE_DESC DXRenderer::CreateProceduralTexture()
 {
-	const UINT rowPitch = TextureWidth * TexturePixelSize;
-	const UINT cellPitch = rowPitch >> 3;
-	const UINT cellHeight = TextureWidth >> 3;
-	const UINT textureSize = rowPitch * TextureHeight;
+	std::shared_ptr<MipChain> mipChain = std::make_shared<MipChain>();
+	mipChain->Init(TextureWidth, TextureHeight);
+
+	// The chain holds sRGB codes, linear targets sample them through sRGB formats or convert them to linear
+	const bool linear = IsLinearTarget(mRenderTargetFormat);
+	const DXGI_FORMAT chainFormat = linear ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
 
-	std::vector<UINT8> data(textureSize);
-	UINT8* pData = &data[0];
+	D3D12_RESOURCE_DESC textureDesc = {};
+	textureDesc.MipLevels = static_cast<UINT16>(mipChain->GetLevelCount());
+	if (mCompressTextures)
+		textureDesc.Format = GetBlockCompressedFormat(mTextureCompression.format, linear);
+	else
+		textureDesc.Format = mTextureFormat == DXGI_FORMAT_R8G8B8A8_UNORM ? chainFormat : mTextureFormat;
+	textureDesc.Width = TextureWidth;
+	textureDesc.Height = TextureHeight;
+	textureDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+	textureDesc.DepthOrArraySize = 1;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+
+
+	mTexture = mGpuAllocator.CreateResource(D3D12_HEAP_TYPE_DEFAULT, textureDesc, D3D12_RESOURCE_STATE_COMMON, nullptr);
+	ResourceStateTracker::AddGlobalResourceState(mTexture->GetResource(), D3D12_RESOURCE_STATE_COMMON);
+
+	ProceduralTextureDesc checker;
+	checker.width = TextureWidth;
+	checker.height = TextureHeight;
+	checker.cellWidth = TextureWidth / 8;
+	checker.cellHeight = TextureHeight / 8;
+
+	const MipChain::Level& baseLevel = mipChain->GetLevel(0);
+	ProceduralTexture::Generate(checker, baseLevel.pData, baseLevel.rowPitch, mJobSystem.get());
+	MipGenerator::Generate(*mipChain, MipGenerator::Settings(), mJobSystem.get());
+
+	// The whole chain goes up in one request, the first frame transitions it out of COMMON
+	std::vector<D3D12_SUBRESOURCE_DATA> subresources(mipChain->GetLevelCount());
+	std::shared_ptr<const void> keepAlive = mipChain;
+	if (mCompressTextures)
+	{
+		// A row of 4x4 blocks is one row of the copy, the same layout GetCopyableFootprints reports for BCn
+		const UINT blockSize = BlockCompressor::GetBlockSize(mTextureCompression.format);
+		std::vector<UINT64> offsets(mipChain->GetLevelCount());
+		UINT64 size = 0;
+		for (UINT i = 0; i < mipChain->GetLevelCount(); i++)
+		{
+			const MipChain::Level& level = mipChain->GetLevel(i);
+			offsets[i] = size;
+			size += UINT64(BlockCompressor::GetBlockCount(level.width)) * BlockCompressor::GetBlockCount(level.height) * blockSize;
+		}
 
-	for (UINT n = 0; n < textureSize; n += TexturePixelSize)
+		std::shared_ptr<std::vector<uint8_t>> blocks = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(size));
+		for (UINT i = 0; i < mipChain->GetLevelCount(); i++)
+		{
+			const MipChain::Level& level = mipChain->GetLevel(i);
+			const UINT64 rowPitch = UINT64(BlockCompressor::GetBlockCount(level.width)) * blockSize;
+			BlockCompressor::Compress(mTextureCompression, level.width, level.height, level.pData, level.rowPitch,
+				blocks->data() + offsets[i], rowPitch, mJobSystem.get());
+
+			subresources[i].pData = blocks->data() + offsets[i];
+			subresources[i].RowPitch = static_cast<LONG_PTR>(rowPitch);
+			subresources[i].SlicePitch = static_cast<LONG_PTR>(rowPitch * BlockCompressor::GetBlockCount(level.height));
+		}
+		keepAlive = blocks;
+	}
+	else if (textureDesc.Format != chainFormat)
 	{
-		UINT x = n % rowPitch;
-		UINT y = n / rowPitch;
-		UINT i = x / cellPitch;
-		UINT j = y / cellHeight;
+		// Every level in one batch across the job system
+		const UINT pixelSize = FormatConverter::GetPixelSize(textureDesc.Format);
+		std::vector<FormatConversionDesc> conversions(mipChain->GetLevelCount());
+		UINT64 size = 0;
+		for (UINT i = 0; i < mipChain->GetLevelCount(); i++)
+		{
+			const MipChain::Level& level = mipChain->GetLevel(i);
+			const UINT64 rowPitch = UINT64(level.width) * pixelSize;
+			conversions[i] = { level.width, level.height, 1, level.pData, level.rowPitch, level.rowPitch * level.height,
+				nullptr, rowPitch, rowPitch * level.height };
+			size += rowPitch * level.height;
+		}
 
-		if (i % 2 == j % 2)
+		std::shared_ptr<std::vector<uint8_t>> pixels = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(size));
+		UINT64 offset = 0;
+		for (UINT i = 0; i < mipChain->GetLevelCount(); i++)
 		{
-			pData[n] = 0x00;
-			pData[n + 1] = 0x00;
-			pData[n + 2] = 0x00;
-			pData[n + 3] = 0xFF;
+			conversions[i].pDest = pixels->data() + offset;
+			offset += conversions[i].destSlicePitch;
+
+			subresources[i].pData = conversions[i].pDest;
+			subresources[i].RowPitch = static_cast<LONG_PTR>(conversions[i].destRowPitch);
+			subresources[i].SlicePitch = static_cast<LONG_PTR>(conversions[i].destSlicePitch);
 		}
-		else
+
+		if (!FormatConverter::Convert(FormatConverter::Settings(), chainFormat, textureDesc.Format, conversions.data(),
+			static_cast<uint32_t>(conversions.size()), mJobSystem.get()))
 		{
-			pData[n] = 0xFF;
-			pData[n + 1] = 0xFF;
-			pData[n + 2] = 0xFF;
-			pData[n + 3] = 0xFF;
+			ThrowIfFailed(E_INVALIDARG);
 		}
+		keepAlive = pixels;
 	}
+	else
+	{
+		for (UINT i = 0; i < mipChain->GetLevelCount(); i++)
+		{
+			const MipChain::Level& level = mipChain->GetLevel(i);
+			subresources[i].pData = level.pData;
+			subresources[i].RowPitch = static_cast<LONG_PTR>(level.rowPitch);
+			subresources[i].SlicePitch = static_cast<LONG_PTR>(level.rowPitch * level.height);
+		}
+	}
+	mUploadStreamer.EnqueueTexture(mTexture->GetResource(), 0, static_cast<UINT>(subresources.size()), subresources.data(), keepAlive);
 
-	return data;
+	return textureDesc;
 }
 
-void DXRenderer::OnUpdate()
+// DDS file uploaded straight from its mapping, the copy into staging memory is the only one made
+D3D12_RESOURCE_DESC DXRenderer::LoadTextureFile(const std::wstring& path)
 {
+	std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+	if (!file->Open(path))
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+
+	DdsFile dds;
+	if (!dds.Parse(file->GetData(), file->GetSize()))
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+
+	// The scene shader samples a single Texture2D
+	if (dds.GetDimension() != DdsFile::Dimension::Texture2D || dds.GetArraySize() != 1)
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED));
+
+	D3D12_RESOURCE_DESC textureDesc = {};
+	textureDesc.MipLevels = static_cast<UINT16>(dds.GetMipCount());
+	textureDesc.Format = dds.GetFormat();
+	textureDesc.Width = dds.GetWidth();
+	textureDesc.Height = dds.GetHeight();
+	textureDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+	textureDesc.DepthOrArraySize = 1;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+
+	// The packed rows in the file have to match the rows the copy reads
+	const std::vector<DdsFile::Subresource>& fileSubresources = dds.GetSubresources();
+	const UINT subresourceCount = static_cast<UINT>(fileSubresources.size());
+	std::vector<UINT> rowCounts(subresourceCount);
+	std::vector<UINT64> rowSizes(subresourceCount);
+	mDevice->GetCopyableFootprints(&textureDesc, 0, subresourceCount, 0, nullptr, rowCounts.data(), rowSizes.data(), nullptr);
+
+	std::vector<D3D12_SUBRESOURCE_DATA> subresources(subresourceCount);
+	for (UINT i = 0; i < subresourceCount; i++)
+	{
+		const DdsFile::Subresource& source = fileSubresources[i];
+		if (rowSizes[i] != source.rowPitch || rowCounts[i] != source.rowCount)
+			ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+
+		subresources[i].pData = source.pData;
+		subresources[i].RowPitch = static_cast<LONG_PTR>(source.rowPitch);
+		subresources[i].SlicePitch = static_cast<LONG_PTR>(source.slicePitch);
+	}
+
+	mTexture = mGpuAllocator.CreateResource(D3D12_HEAP_TYPE_DEFAULT, textureDesc, D3D12_RESOURCE_STATE_COMMON, nullptr);
+	ResourceStateTracker::AddGlobalResourceState(mTexture->GetResource(), D3D12_RESOURCE_STATE_COMMON);
+
+	// The mapping stays open until the upload thread has staged it
+	mUploadStreamer.EnqueueTexture(mTexture->GetResource(), 0, subresourceCount, subresources.data(), file);
+	return textureDesc;
 }
 
-void DXRenderer::OnRender()
+ComPtr<ID3D12PipelineState> DXRenderer::CreateScenePipeline(const ShaderLibrary& library)
 {
-	PopulateCommandList();
+	// Vertex Input Layout
+	D3D12_INPUT_ELEMENT_DESC inputElementDescs[] =
+	{
+		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0}
+	};
+
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+	psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
+	psoDesc.pRootSignature = mRootSignature.Get();
+	psoDesc.VS = library.GetBytecode("shader.hlsl:VSMain");
+	psoDesc.PS = library.GetBytecode("shader.hlsl:PSMain");
+	psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+	psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+	psoDesc.DepthStencilState.DepthEnable = FALSE;
+	psoDesc.DepthStencilState.StencilEnable = FALSE;
+	psoDesc.SampleMask = UINT_MAX;
+	psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+	psoDesc.NumRenderTargets = 1;
+	psoDesc.RTVFormats[0] = mRenderTargetFormat;
+	psoDesc.SampleDesc.Count = 1;
+	return mPipelineCache.CreateGraphicsPipelineState(psoDesc, mRootSignatureHash);
+}
 
-	ID3D12CommandList* ppCommandLists[] = { mCommandList.Get() };
-	mCommandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+void DXRenderer::RunFrame()
+{
+	mFrameLoop.RunFrame();
 
-	ThrowIfFailed(mSwapChain->Present(1, 0));
-	
-	WaitForPreviousFrame();
+	// Outside the frame's scopes so they are complete
+	if (CpuProfiler::IsEnabled())
+		CpuProfiler::Flush(mTraceWriter, CpuTraceProcessId);
 }
 
 void DXRenderer::OnDestroy()
 {
-	WaitForPreviousFrame();
+	mShaderHotReload.Stop();
+	mFrameLoop.Flush();
+	mPipelineCache.Save();
+
+	if (!mReadbackPath.empty())
+		SaveLastFrame(mReadbackPath);
 
-	CloseHandle(mFenceEvent);
+	mGpuProfiler.SetFrameListener(nullptr);
+	if (mBenchmark)
+		mBenchmark->Write(mBenchmarkPath);
+
+	if (mFrameLatencyWaitable)
+	{
+		CloseHandle(mFrameLatencyWaitable);
+		mFrameLatencyWaitable = nullptr;
+	}
+
+	if (!mTracePath.empty())
+	{
+		CpuProfiler::Flush(mTraceWriter, CpuTraceProcessId);
+		mTraceWriter.Write(mTracePath);
+	}
+	mUploadStreamer.Shutdown();
+
+	for (UINT n = 0; n < FrameCount; n++)
+	{
+		ResourceStateTracker::RemoveGlobalResourceState(mRenderTargets[n].Get());
+	}
+	ResourceStateTracker::RemoveGlobalResourceState(mVertexBuffer->GetResource());
+	ResourceStateTracker::RemoveGlobalResourceState(mTexture->GetResource());
 }
 
 
-void DXRenderer::PopulateCommandList()
+void DXRenderer::PopulateCommandList(UINT frameIndex, UINT64 fenceValue)
 {
-	ThrowIfFailed(mCommandAllocator->Reset());
-	
-	ThrowIfFailed(mCommandList->Reset(mCommandAllocator.Get(), mPipelineState.Get()));
+	PROFILE_FUNCTION();
 
-	mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
+	FrameContext& frame = mFrames[frameIndex];
 
-	ID3D12DescriptorHeap* ppHeaps[] = {mSrvHeap.Get()};
-	mCommandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
-	mCommandList->SetGraphicsRootDescriptorTable(0, mSrvHeap->GetGPUDescriptorHandleForHeapStart());
+	// Safe to reset, MoveToNextFrame waited for the GPU to retire this frame's previous use
+	for (CommandListPool& pool : frame.commandListPools)
+	{
+		pool.Reset();
+	}
+	frame.graphCommandListPool.Reset();
+	mGpuProfiler.BeginFrame();
 
-	mCommandList->RSSetViewports(1, &mViewport);
-	mCommandList->RSSetScissorRects(1, &mScissorRect);
+	const UINT drawCount = static_cast<UINT>(mDrawItems.size());
+	const UINT chunkCount = (drawCount + DrawsPerChunk - 1) / DrawsPerChunk;
+	PROFILE_COUNTER("Draws", drawCount);
 
+	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(mRtvHeap->GetCPUDescriptorHandleForHeapStart(), frameIndex, mRtvDescrptiorSize);
 
-	auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(mRenderTargets[mFrameIndex].Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
-	mCommandList->ResourceBarrier(1, &barrier);
+	mStateTracker.Reset();
+	mRenderGraph.Reset();
 
-	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(mRtvHeap->GetCPUDescriptorHandleForHeapStart(), mFrameIndex, mRtvDescrptiorSize);
-	mCommandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
+	const RenderGraphHandle backBuffer = mRenderGraph.ImportResource(mRenderTargets[frameIndex].Get(), D3D12_RESOURCE_STATE_PRESENT);
+	const RenderGraphHandle texture = mRenderGraph.ImportResource(mTexture->GetResource());
+	const RenderGraphHandle vertexBuffer = mRenderGraph.ImportResource(mVertexBuffer->GetResource());
 
-	// Record Commands
-	const float clearColor[] = { 0.3f, 0.3f, 0.8f, 1.0f };
-	mCommandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
-	mCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	mCommandList->IASetVertexBuffers(0, 1, &mVertexBufferView);
-	mCommandList->DrawInstanced(3, 1, 0, 0);
+	// Scene, the scope ends in the frame's last list, after the chunk lists
+	UINT sceneScope = GpuProfiler::InvalidScope;
+	mRenderGraph.AddPass([&](RenderPassContext& context)
+	{
+		sceneScope = mGpuProfiler.BeginScope(context.GetCommandList(), "Scene");
+
+		const float clearColor[] = { 0.3f, 0.3f, 0.8f, 1.0f };
+		context.GetCommandList()->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
+
+		// Every chunk goes into its own list, recorded by whichever thread picks it up
+		std::vector<ID3D12CommandList*> chunkLists(chunkCount);
+		mJobSystem->ParallelFor(chunkCount, [&](UINT chunk, UINT threadIndex)
+		{
+			ID3D12GraphicsCommandList* pCommandList = frame.commandListPools[threadIndex].Acquire(mPipelineState.Get());
+
+			const UINT firstDraw = chunk * DrawsPerChunk;
+			{
+				PROFILE_SCOPE("Record scene chunk");
+				GpuProfileScope scope(mGpuProfiler, pCommandList, "Scene chunk");
+				RecordSceneChunk(pCommandList, frameIndex, firstDraw, min(DrawsPerChunk, drawCount - firstDraw));
+			}
+
+			ThrowIfFailed(pCommandList->Close());
+			chunkLists[chunk] = pCommandList;
+		});
 
-	barrier = CD3DX12_RESOURCE_BARRIER::Transition(mRenderTargets[mFrameIndex].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
-	mCommandList->ResourceBarrier(1, &barrier);
+		for (ID3D12CommandList* pCommandList : chunkLists)
+		{
+			context.AddCommandList(pCommandList);
+		}
+	})
+		.Write(backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET)
+		.Read(texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE)
+		.Read(vertexBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+
+	// First slot is kept for the pending barriers, recorded once the graph has run
+	mFrameCommandLists.assign(1, nullptr);
+	mRenderGraph.Execute(frame.graphCommandListPool, mStateTracker, fenceValue, mFrameCommandLists);
+
+	// Resolve first-use transitions against the states left by previous submissions, runs ahead of the graph
+	UINT frameScope;
+	{
+		ID3D12GraphicsCommandList* pCommandList = frame.graphCommandListPool.Acquire(nullptr);
+		frameScope = mGpuProfiler.BeginScope(pCommandList, "Frame");
+
+		ResourceStateTracker::Lock();
+		mStateTracker.FlushPendingResourceBarriers(pCommandList);
+		mStateTracker.CommitFinalResourceStates();
+		ResourceStateTracker::Unlock();
+
+		ThrowIfFailed(pCommandList->Close());
+		mFrameCommandLists.front() = pCommandList;
+	}
+
+	// Closes the open GPU scopes and resolves the frame's timestamps
+	{
+		ID3D12GraphicsCommandList* pCommandList = frame.graphCommandListPool.Acquire(nullptr);
+		mGpuProfiler.EndScope(pCommandList, sceneScope);
+		mGpuProfiler.EndScope(pCommandList, frameScope);
+		mGpuProfiler.EndFrame(pCommandList, fenceValue);
 
-	ThrowIfFailed(mCommandList->Close());
+		ThrowIfFailed(pCommandList->Close());
+		mFrameCommandLists.push_back(pCommandList);
+	}
 }
 
-void DXRenderer::WaitForPreviousFrame()
+void DXRenderer::RecordSceneChunk(ID3D12GraphicsCommandList* pCommandList, UINT frameIndex, UINT firstDraw, UINT drawCount)
 {
-	const UINT64 fenceVal = mFenceValue;
-	ThrowIfFailed(mCommandQueue->Signal(mFence.Get(), fenceVal));
-	mFenceValue++;
+	// Command lists don't inherit state, every chunk sets up the full pipeline
+	pCommandList->SetGraphicsRootSignature(mRootSignature.Get());
+
+	ID3D12DescriptorHeap* ppHeaps[] = {mCbvSrvUavHeap.GetHeap()};
+	pCommandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+	// Bound once, draws only change the root constants
+	pCommandList->SetGraphicsRootDescriptorTable(BindlessTableParameter, mBindlessTable.GetGpuHandle());
+
+	pCommandList->RSSetViewports(1, &mViewport);
+	pCommandList->RSSetScissorRects(1, &mScissorRect);
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(mRtvHeap->GetCPUDescriptorHandleForHeapStart(), frameIndex, mRtvDescrptiorSize);
+	pCommandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
 
-	if (mFence->GetCompletedValue() < fenceVal)
+	// Record Commands
+	pCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	for (UINT n = firstDraw; n < firstDraw + drawCount; n++)
 	{
-		ThrowIfFailed(mFence->SetEventOnCompletion(fenceVal, mFenceEvent));
-		WaitForSingleObject(mFenceEvent, INFINITE);
+		const DrawItem& draw = mDrawItems[n];
+		pCommandList->SetGraphicsRoot32BitConstant(DrawConstantsParameter, draw.textureIndex, 0);
+		pCommandList->IASetVertexBuffers(0, 1, &draw.vertexBufferView);
+		pCommandList->DrawInstanced(draw.vertexCount, 1, 0, 0);
 	}
-
-	mFrameIndex = mSwapChain->GetCurrentBackBufferIndex();
 }
 
 void DXRenderer::OnKeyDown(UINT8)
@@ -493,10 +806,140 @@ void DXRenderer::GetHardwareAdapter(IDXGIFactory1* pFactory, IDXGIAdapter1** ppA
 	*ppAdapter = adapter.Detach();
 }
 
-void DXRenderer::SetCustomWindowText(LPCWSTR text)
+// Milliseconds, steady_clock shares the QueryPerformanceCounter timeline GPU times are mapped onto
+double DXRenderer::GetTime()
 {
-	std::wstring windowText = mTitle + L": " + text;
-	SetWindowText(WinCtx::GetHwnd(), windowText.c_str());
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void DXRenderer::Wait(double milliseconds)
+{
+	mPaceTimer.Wait(milliseconds);
+}
+
+// The swap chain's latency limit, the pacer holds back whatever it wants on top
+void DXRenderer::WaitForDisplay()
+{
+	if (mFrameLatencyWaitable)
+		WaitForSingleObjectEx(mFrameLatencyWaitable, 1000, TRUE);
+}
+
+void DXRenderer::Update(uint64_t fenceValue)
+{
+	PROFILE_FUNCTION();
+
+	// Frame boundary, nothing is recording with the scene pipeline
+	mShaderHotReload.Update(fenceValue - 1);
+}
+
+void DXRenderer::Render(uint32_t frameIndex, uint64_t fenceValue)
+{
+	PROFILE_FUNCTION();
+
+	PopulateCommandList(frameIndex, fenceValue);
+	PROFILE_COUNTER("Command lists", mFrameCommandLists.size());
+
+	// Single submission keeps the recorded order
+	PROFILE_SCOPE("ExecuteCommandLists");
+	mCommandQueue->ExecuteCommandLists(static_cast<UINT>(mFrameCommandLists.size()), mFrameCommandLists.data());
+
+	// Everything handed out for the frame just submitted is tagged with the value it ends with
+	mCbvSrvUavHeap.FinishBatch(fenceValue);
+}
+
+uint32_t DXRenderer::Present(uint32_t frameIndex)
+{
+	if (!mSwapChain)
+		return (frameIndex + 1) % FrameCount;
+
+	PROFILE_FUNCTION();
+	const UINT presentFlags = !mVsync && mTearingSupported ? DXGI_PRESENT_ALLOW_TEARING : 0;
+	ThrowIfFailed(mSwapChain->Present(mVsync ? 1 : 0, presentFlags));
+	return mSwapChain->GetCurrentBackBufferIndex();
+}
+
+void DXRenderer::Retire(uint64_t completedValue, std::vector<GpuFrame>& gpuFrames)
+{
+	mCbvSrvUavHeap.Retire(completedValue);
+	mBindlessTable.Retire(completedValue);
+	mGpuProfiler.Retire(completedValue);
+	mGpuAllocator.Retire(completedValue);
+	mRenderGraph.Retire(completedValue);
+	mShaderHotReload.Retire(completedValue);
+
+	gpuFrames.insert(gpuFrames.end(), mRetiredGpuFrames.begin(), mRetiredGpuFrames.end());
+	mRetiredGpuFrames.clear();
+}
+
+// A GPU frame is the "Frame" root, it spans every list of the frame
+void DXRenderer::OnGpuFrameRetired(const std::vector<ProfileNode>& nodes, UINT64 fenceValue)
+{
+	for (const ProfileNode& node : nodes)
+	{
+		if (node.depth != 0 || strcmp(node.name, "Frame") != 0)
+			continue;
+
+		const double begin = mGpuProfiler.GetCpuMicroseconds(node.begin) / 1000.0;
+		const double end = mGpuProfiler.GetCpuMicroseconds(node.end) / 1000.0;
+		mRetiredGpuFrames.push_back({ fenceValue, begin, end });
+	}
+}
+
+// Copies the last presented target back to the CPU, only call with the GPU idle
+void DXRenderer::SaveLastFrame(const std::wstring& path)
+{
+	ID3D12Resource* pRenderTarget = mRenderTargets[mFrameLoop.GetLastFrameIndex()].Get();
+	const D3D12_RESOURCE_DESC targetDesc = pRenderTarget->GetDesc();
+
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+	UINT64 readbackSize = 0;
+	mDevice->GetCopyableFootprints(&targetDesc, 0, 1, 0, &footprint, nullptr, nullptr, &readbackSize);
+
+	ComPtr<ID3D12Resource> readback;
+	const CD3DX12_HEAP_PROPERTIES readbackHeap(D3D12_HEAP_TYPE_READBACK);
+	const CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(readbackSize);
+	ThrowIfFailed(mDevice->CreateCommittedResource(&readbackHeap, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+		D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&readback)));
+
+	// The target decayed to COMMON, copies promote it to COPY_SOURCE implicitly
+	CommandListPool& pool = mFrames[mFrameLoop.GetFrameRing().GetFrameIndex()].graphCommandListPool;
+	pool.Reset();
+	ID3D12GraphicsCommandList* pCommandList = pool.Acquire(nullptr);
+	const CD3DX12_TEXTURE_COPY_LOCATION dest(readback.Get(), footprint);
+	const CD3DX12_TEXTURE_COPY_LOCATION source(pRenderTarget, 0);
+	pCommandList->CopyTextureRegion(&dest, 0, 0, 0, &source, nullptr);
+	ThrowIfFailed(pCommandList->Close());
+
+	ID3D12CommandList* ppCommandLists[] = { pCommandList };
+	mCommandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+	mFrameLoop.Flush();
+
+	void* pData = nullptr;
+	const D3D12_RANGE readRange = { 0, static_cast<SIZE_T>(readbackSize) };
+	ThrowIfFailed(readback->Map(0, &readRange, &pData));
+
+	// Bitmaps hold 8-bit sRGB codes, other targets are converted to them first
+	const UINT width = footprint.Footprint.Width;
+	const UINT height = footprint.Footprint.Height;
+	const DXGI_FORMAT bitmapFormat = IsLinearTarget(mRenderTargetFormat) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+	const uint8_t* pPixels = static_cast<const uint8_t*>(pData) + footprint.Offset;
+	UINT64 rowPitch = footprint.Footprint.RowPitch;
+	std::vector<uint8_t> converted;
+	if (mRenderTargetFormat != bitmapFormat)
+	{
+		converted.resize(size_t(width) * 4 * height);
+		const FormatConversionDesc conversion = { width, height, 1, pPixels, rowPitch, rowPitch * height,
+			converted.data(), UINT64(width) * 4, UINT64(width) * 4 * height };
+		FormatConverter::Convert(FormatConverter::Settings(), mRenderTargetFormat, bitmapFormat, &conversion, 1, mJobSystem.get());
+		pPixels = converted.data();
+		rowPitch = conversion.destRowPitch;
+	}
+	const std::vector<uint8_t> bitmap = BitmapFile::Write(width, height, pPixels, rowPitch);
+	const D3D12_RANGE writtenRange = { 0, 0 };
+	readback->Unmap(0, &writtenRange);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(bitmap.data()), bitmap.size());
 }
 
 _Use_decl_annotations_
@@ -510,5 +953,124 @@ void DXRenderer::ParseCommandLineArgs(WCHAR* argv[], int argc)
 			mUseWarpDevice = true;
 			mTitle = mTitle + L" (WARP)";
 		}
+		else if ((_wcsnicmp(argv[i], L"-hotreload", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/hotreload", wcslen(argv[i])) == 0) && i + 1 < argc)
+		{
+			// Source tree to watch and rebuild shaders from
+			mShaderReloadRoot = argv[++i];
+		}
+		else if ((_wcsnicmp(argv[i], L"-trace", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/trace", wcslen(argv[i])) == 0) && i + 1 < argc)
+		{
+			// Trace of the CPU and GPU scopes, written on exit. Perfetto protobuf for .pftrace, Chrome JSON otherwise.
+			mTracePath = argv[++i];
+		}
+		else if (_wcsnicmp(argv[i], L"-headless", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/headless", wcslen(argv[i])) == 0)
+		{
+			mHeadless = true;
+		}
+		else if ((_wcsnicmp(argv[i], L"-frames", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/frames", wcslen(argv[i])) == 0) && i + 1 < argc)
+		{
+			// Frames to render headless, or to measure with -benchmark
+			mFrameLimit = static_cast<UINT>(_wtoi(argv[++i]));
+		}
+		else if ((_wcsnicmp(argv[i], L"-readback", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/readback", wcslen(argv[i])) == 0) && i + 1 < argc)
+		{
+			// Last frame written as a BMP on exit
+			mReadbackPath = argv[++i];
+		}
+		else if ((_wcsnicmp(argv[i], L"-fps", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/fps", wcslen(argv[i])) == 0) && i + 1 < argc)
+		{
+			// Frame rate cap, 0 for none
+			FramePacer::Settings settings = mFrameLoop.GetFramePacer().GetSettings();
+			const double fps = _wtof(argv[++i]);
+			settings.targetFrameTime = fps > 0.0 ? 1000.0 / fps : 0.0;
+			mFrameLoop.GetFramePacer().SetSettings(settings);
+		}
+		else if (_wcsnicmp(argv[i], L"-lowlatency", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/lowlatency", wcslen(argv[i])) == 0)
+		{
+			FramePacer::Settings settings = mFrameLoop.GetFramePacer().GetSettings();
+			settings.lowLatency = true;
+			mFrameLoop.GetFramePacer().SetSettings(settings);
+		}
+		else if (_wcsnicmp(argv[i], L"-novsync", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/novsync", wcslen(argv[i])) == 0)
+		{
+			mVsync = false;
+		}
+		else if ((_wcsnicmp(argv[i], L"-latency", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/latency", wcslen(argv[i])) == 0) && i + 1 < argc)
+		{
+			// Frames allowed to queue for presentation, 1 to 16
+			mMaxFrameLatency = std::clamp(static_cast<UINT>(_wtoi(argv[++i])), 1u, 16u);
+		}
+		else if ((_wcsnicmp(argv[i], L"-benchmark", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/benchmark", wcslen(argv[i])) == 0) && i + 1 < argc)
+		{
+			// Report written as JSON on exit
+			mBenchmarkPath = argv[++i];
+		}
+		else if ((_wcsnicmp(argv[i], L"-texture", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/texture", wcslen(argv[i])) == 0) && i + 1 < argc)
+		{
+			// 2D DDS file to draw, used as it is stored
+			mTexturePath = argv[++i];
+		}
+		else if ((_wcsnicmp(argv[i], L"-texformat", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/texformat", wcslen(argv[i])) == 0) && i + 1 < argc)
+		{
+			// rgba8, rgba16f, r11g11b10f, rgb10a2, bc1, bc3, bc5 or bc7
+			const std::wstring format = argv[++i];
+			mCompressTextures = false;
+			if (_wcsicmp(format.c_str(), L"rgba8") == 0)
+				mTextureFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+			else if (_wcsicmp(format.c_str(), L"rgba16f") == 0)
+				mTextureFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
+			else if (_wcsicmp(format.c_str(), L"r11g11b10f") == 0)
+				mTextureFormat = DXGI_FORMAT_R11G11B10_FLOAT;
+			else if (_wcsicmp(format.c_str(), L"rgb10a2") == 0)
+				mTextureFormat = DXGI_FORMAT_R10G10B10A2_UNORM;
+			else
+			{
+				mCompressTextures = true;
+				if (_wcsicmp(format.c_str(), L"bc1") == 0)
+					mTextureCompression.format = BlockFormat::BC1;
+				else if (_wcsicmp(format.c_str(), L"bc3") == 0)
+					mTextureCompression.format = BlockFormat::BC3;
+				else if (_wcsicmp(format.c_str(), L"bc5") == 0)
+					mTextureCompression.format = BlockFormat::BC5;
+				else
+					mTextureCompression.format = BlockFormat::BC7;
+			}
+		}
+		else if ((_wcsnicmp(argv[i], L"-backbuffer", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/backbuffer", wcslen(argv[i])) == 0) && i + 1 < argc)
+		{
+			// rgba8, rgba8srgb, rgb10a2 or rgba16f (scRGB)
+			const std::wstring format = argv[++i];
+			mBackBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+			if (_wcsicmp(format.c_str(), L"rgb10a2") == 0)
+				mBackBufferFormat = DXGI_FORMAT_R10G10B10A2_UNORM;
+			else if (_wcsicmp(format.c_str(), L"rgba16f") == 0)
+				mBackBufferFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
+			mRenderTargetFormat = _wcsicmp(format.c_str(), L"rgba8srgb") == 0 ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : mBackBufferFormat;
+		}
+		else if ((_wcsnicmp(argv[i], L"-texquality", wcslen(argv[i])) == 0 ||
+			_wcsnicmp(argv[i], L"/texquality", wcslen(argv[i])) == 0) && i + 1 < argc)
+		{
+			// fast, normal or high
+			const std::wstring quality = argv[++i];
+			if (_wcsicmp(quality.c_str(), L"fast") == 0)
+				mTextureCompression.quality = BlockQuality::Fast;
+			else if (_wcsicmp(quality.c_str(), L"high") == 0)
+				mTextureCompression.quality = BlockQuality::High;
+			else
+				mTextureCompression.quality = BlockQuality::Normal;
+		}
 	}
 }
\ No newline at end of file
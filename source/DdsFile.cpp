@@ -0,0 +1,306 @@
+#include "DdsFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	const uint32_t FourCCDx10 = 0x30315844; // "DX10"
+
+	// Header flags and caps
+	const uint32_t HeaderFlagDepth = 0x800000;
+	const uint32_t Caps2Cubemap = 0x200;
+	const uint32_t Caps2CubemapAllFaces = 0xFC00;
+	const uint32_t Caps2Volume = 0x200000;
+
+	// Pixel format flags
+	const uint32_t PixelAlphaPixels = 0x1;
+	const uint32_t PixelAlpha = 0x2;
+	const uint32_t PixelFourCC = 0x4;
+	const uint32_t PixelRgb = 0x40;
+	const uint32_t PixelLuminance = 0x20000;
+
+	// D3D10_RESOURCE_DIMENSION and D3D10_RESOURCE_MISC_TEXTURECUBE
+	const uint32_t ResourceDimensionTexture1D = 2;
+	const uint32_t ResourceDimensionTexture2D = 3;
+	const uint32_t ResourceDimensionTexture3D = 4;
+	const uint32_t MiscTextureCube = 0x4;
+
+	// D3D12 resource limits
+	const uint32_t MaxTextureSize = 16384;
+	const uint32_t MaxVolumeSize = 2048;
+	const uint32_t MaxArraySize = 2048;
+
+	constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+	{
+		return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+	}
+
+	bool InRange(DXGI_FORMAT format, DXGI_FORMAT first, DXGI_FORMAT last)
+	{
+		return format >= first && format <= last;
+	}
+
+	uint32_t GetFullMipCount(uint32_t width, uint32_t height, uint32_t depth)
+	{
+		uint32_t mipCount = 1;
+		for (uint32_t size = std::max({ width, height, depth }); size > 1; size /= 2)
+		{
+			mipCount++;
+		}
+		return mipCount;
+	}
+}
+
+bool DdsFile::GetFormatSize(DXGI_FORMAT format, uint32_t& bytes, bool& blockCompressed)
+{
+	blockCompressed = false;
+	if (InRange(format, DXGI_FORMAT_R32G32B32A32_TYPELESS, DXGI_FORMAT_R32G32B32A32_SINT))
+		bytes = 16;
+	else if (InRange(format, DXGI_FORMAT_R32G32B32_TYPELESS, DXGI_FORMAT_R32G32B32_SINT))
+		bytes = 12;
+	else if (InRange(format, DXGI_FORMAT_R16G16B16A16_TYPELESS, DXGI_FORMAT_X32_TYPELESS_G8X24_UINT))
+		bytes = 8;
+	else if (InRange(format, DXGI_FORMAT_R10G10B10A2_TYPELESS, DXGI_FORMAT_X24_TYPELESS_G8_UINT) ||
+		format == DXGI_FORMAT_R9G9B9E5_SHAREDEXP ||
+		InRange(format, DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_FORMAT_B8G8R8X8_UNORM_SRGB))
+		bytes = 4;
+	else if (InRange(format, DXGI_FORMAT_R8G8_TYPELESS, DXGI_FORMAT_R16_SINT) ||
+		InRange(format, DXGI_FORMAT_B5G6R5_UNORM, DXGI_FORMAT_B5G5R5A1_UNORM) ||
+		format == DXGI_FORMAT_B4G4R4A4_UNORM)
+		bytes = 2;
+	else if (InRange(format, DXGI_FORMAT_R8_TYPELESS, DXGI_FORMAT_A8_UNORM))
+		bytes = 1;
+	else if (InRange(format, DXGI_FORMAT_BC1_TYPELESS, DXGI_FORMAT_BC1_UNORM_SRGB) ||
+		InRange(format, DXGI_FORMAT_BC4_TYPELESS, DXGI_FORMAT_BC4_SNORM))
+	{
+		bytes = 8;
+		blockCompressed = true;
+	}
+	else if (InRange(format, DXGI_FORMAT_BC2_TYPELESS, DXGI_FORMAT_BC3_UNORM_SRGB) ||
+		InRange(format, DXGI_FORMAT_BC5_TYPELESS, DXGI_FORMAT_BC5_SNORM) ||
+		InRange(format, DXGI_FORMAT_BC6H_TYPELESS, DXGI_FORMAT_BC7_UNORM_SRGB))
+	{
+		bytes = 16;
+		blockCompressed = true;
+	}
+	else
+		return false;
+
+	return true;
+}
+
+DXGI_FORMAT DdsFile::GetLegacyFormat(const PixelFormat& pixelFormat)
+{
+	const auto hasMasks = [&](uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+	{
+		return pixelFormat.rBitMask == r && pixelFormat.gBitMask == g && pixelFormat.bBitMask == b && pixelFormat.aBitMask == a;
+	};
+
+	if (pixelFormat.flags & PixelFourCC)
+	{
+		switch (pixelFormat.fourCC)
+		{
+		case MakeFourCC('D', 'X', 'T', '1'): return DXGI_FORMAT_BC1_UNORM;
+		case MakeFourCC('D', 'X', 'T', '2'):
+		case MakeFourCC('D', 'X', 'T', '3'): return DXGI_FORMAT_BC2_UNORM;
+		case MakeFourCC('D', 'X', 'T', '4'):
+		case MakeFourCC('D', 'X', 'T', '5'): return DXGI_FORMAT_BC3_UNORM;
+		case MakeFourCC('A', 'T', 'I', '1'):
+		case MakeFourCC('B', 'C', '4', 'U'): return DXGI_FORMAT_BC4_UNORM;
+		case MakeFourCC('B', 'C', '4', 'S'): return DXGI_FORMAT_BC4_SNORM;
+		case MakeFourCC('A', 'T', 'I', '2'):
+		case MakeFourCC('B', 'C', '5', 'U'): return DXGI_FORMAT_BC5_UNORM;
+		case MakeFourCC('B', 'C', '5', 'S'): return DXGI_FORMAT_BC5_SNORM;
+		// D3DFORMAT values stored as the fourCC
+		case 36: return DXGI_FORMAT_R16G16B16A16_UNORM;
+		case 110: return DXGI_FORMAT_R16G16B16A16_SNORM;
+		case 111: return DXGI_FORMAT_R16_FLOAT;
+		case 112: return DXGI_FORMAT_R16G16_FLOAT;
+		case 113: return DXGI_FORMAT_R16G16B16A16_FLOAT;
+		case 114: return DXGI_FORMAT_R32_FLOAT;
+		case 115: return DXGI_FORMAT_R32G32_FLOAT;
+		case 116: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+		default: return DXGI_FORMAT_UNKNOWN;
+		}
+	}
+
+	if (pixelFormat.flags & PixelRgb)
+	{
+		switch (pixelFormat.rgbBitCount)
+		{
+		case 32:
+			if (hasMasks(0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000))
+				return DXGI_FORMAT_R8G8B8A8_UNORM;
+			if (hasMasks(0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000))
+				return DXGI_FORMAT_B8G8R8A8_UNORM;
+			if (hasMasks(0x00FF0000, 0x0000FF00, 0x000000FF, 0))
+				return DXGI_FORMAT_B8G8R8X8_UNORM;
+			// Written swapped by D3DX, the masks are read as they were meant
+			if (hasMasks(0x3FF00000, 0x000FFC00, 0x000003FF, 0xC0000000) || hasMasks(0x000003FF, 0x000FFC00, 0x3FF00000, 0xC0000000))
+				return DXGI_FORMAT_R10G10B10A2_UNORM;
+			if (hasMasks(0x0000FFFF, 0xFFFF0000, 0, 0))
+				return DXGI_FORMAT_R16G16_UNORM;
+			if (hasMasks(0xFFFFFFFF, 0, 0, 0))
+				return DXGI_FORMAT_R32_FLOAT;
+			break;
+		case 16:
+			if (hasMasks(0xF800, 0x07E0, 0x001F, 0))
+				return DXGI_FORMAT_B5G6R5_UNORM;
+			if (hasMasks(0x7C00, 0x03E0, 0x001F, 0x8000))
+				return DXGI_FORMAT_B5G5R5A1_UNORM;
+			if (hasMasks(0x0F00, 0x00F0, 0x000F, 0xF000))
+				return DXGI_FORMAT_B4G4R4A4_UNORM;
+			break;
+		}
+		return DXGI_FORMAT_UNKNOWN;
+	}
+
+	if (pixelFormat.flags & PixelLuminance)
+	{
+		if (pixelFormat.rgbBitCount == 8 && hasMasks(0xFF, 0, 0, 0))
+			return DXGI_FORMAT_R8_UNORM;
+		if (pixelFormat.rgbBitCount == 16 && hasMasks(0xFFFF, 0, 0, 0))
+			return DXGI_FORMAT_R16_UNORM;
+		if (pixelFormat.rgbBitCount == 16 && (pixelFormat.flags & PixelAlphaPixels) && hasMasks(0xFF, 0, 0, 0xFF00))
+			return DXGI_FORMAT_R8G8_UNORM;
+		return DXGI_FORMAT_UNKNOWN;
+	}
+
+	if ((pixelFormat.flags & PixelAlpha) && pixelFormat.rgbBitCount == 8)
+		return DXGI_FORMAT_A8_UNORM;
+
+	return DXGI_FORMAT_UNKNOWN;
+}
+
+bool DdsFile::Parse(const void* pData, size_t size)
+{
+	*this = DdsFile();
+
+	const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+	uint32_t magic = 0;
+	Header header;
+	if (size < sizeof(magic) + sizeof(Header))
+		return false;
+	memcpy(&magic, pBytes, sizeof(magic));
+	memcpy(&header, pBytes + sizeof(magic), sizeof(header));
+	if (magic != Magic || header.size != sizeof(Header) || header.pixelFormat.size != sizeof(PixelFormat))
+		return false;
+
+	size_t offset = sizeof(magic) + sizeof(Header);
+	uint32_t depth = 1;
+	uint32_t arraySize = 1;
+	if ((header.pixelFormat.flags & PixelFourCC) && header.pixelFormat.fourCC == FourCCDx10)
+	{
+		HeaderDx10 extension;
+		if (size - offset < sizeof(HeaderDx10))
+			return false;
+		memcpy(&extension, pBytes + offset, sizeof(extension));
+		offset += sizeof(HeaderDx10);
+
+		mFormat = static_cast<DXGI_FORMAT>(extension.dxgiFormat);
+		arraySize = extension.arraySize;
+		switch (extension.resourceDimension)
+		{
+		case ResourceDimensionTexture1D:
+			mDimension = Dimension::Texture1D;
+			if (header.height > 1)
+				return false;
+			break;
+		case ResourceDimensionTexture2D:
+			mDimension = Dimension::Texture2D;
+			if (extension.miscFlag & MiscTextureCube)
+			{
+				mCubemap = true;
+				arraySize = arraySize <= MaxArraySize / 6 ? arraySize * 6 : 0;
+			}
+			break;
+		case ResourceDimensionTexture3D:
+			mDimension = Dimension::Texture3D;
+			depth = header.depth;
+			if (arraySize != 1)
+				return false;
+			break;
+		default:
+			return false;
+		}
+	}
+	else
+	{
+		mFormat = GetLegacyFormat(header.pixelFormat);
+		if (header.caps2 & Caps2Cubemap)
+		{
+			// Partial cubemaps have no D3D12 equivalent
+			if ((header.caps2 & Caps2CubemapAllFaces) != Caps2CubemapAllFaces)
+				return false;
+			mCubemap = true;
+			arraySize = 6;
+		}
+		else if ((header.caps2 & Caps2Volume) && (header.flags & HeaderFlagDepth))
+		{
+			mDimension = Dimension::Texture3D;
+			depth = header.depth;
+		}
+	}
+
+	uint32_t bytes = 0;
+	bool blockCompressed = false;
+	if (!GetFormatSize(mFormat, bytes, blockCompressed))
+		return false;
+
+	mWidth = header.width;
+	mHeight = mDimension == Dimension::Texture1D ? 1 : header.height;
+	mDepth = depth;
+	mArraySize = arraySize;
+	mMipCount = header.mipMapCount > 0 ? header.mipMapCount : 1;
+
+	const uint32_t maxSize = mDimension == Dimension::Texture3D ? MaxVolumeSize : MaxTextureSize;
+	if (mWidth == 0 || mHeight == 0 || mDepth == 0 || mWidth > maxSize || mHeight > maxSize || mDepth > maxSize ||
+		mArraySize == 0 || mArraySize > MaxArraySize || mMipCount > GetFullMipCount(mWidth, mHeight, mDepth))
+		return false;
+	if (mCubemap && mWidth != mHeight)
+		return false;
+
+	// Sizes stay far below 2^64 within the limits above, only the file bounds need checking
+	mSubresources.reserve(mArraySize * mMipCount);
+	for (uint32_t slice = 0; slice < mArraySize; slice++)
+	{
+		uint32_t mipWidth = mWidth;
+		uint32_t mipHeight = mHeight;
+		uint32_t mipDepth = mDepth;
+		for (uint32_t mip = 0; mip < mMipCount; mip++)
+		{
+			Subresource subresource;
+			subresource.width = mipWidth;
+			subresource.height = mipHeight;
+			subresource.depth = mipDepth;
+			if (blockCompressed)
+			{
+				subresource.rowPitch = uint64_t((mipWidth + 3) / 4) * bytes;
+				subresource.rowCount = (mipHeight + 3) / 4;
+			}
+			else
+			{
+				subresource.rowPitch = uint64_t(mipWidth) * bytes;
+				subresource.rowCount = mipHeight;
+			}
+			subresource.slicePitch = subresource.rowPitch * subresource.rowCount;
+
+			const uint64_t subresourceSize = subresource.slicePitch * mipDepth;
+			if (subresourceSize > size - offset)
+			{
+				mSubresources.clear();
+				return false;
+			}
+			subresource.pData = pBytes + offset;
+			offset += static_cast<size_t>(subresourceSize);
+			mSubresources.push_back(subresource);
+
+			mipWidth = std::max(1u, mipWidth / 2);
+			mipHeight = std::max(1u, mipHeight / 2);
+			mipDepth = std::max(1u, mipDepth / 2);
+		}
+	}
+
+	return true;
+}
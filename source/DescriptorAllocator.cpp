@@ -0,0 +1,72 @@
+#include "DescriptorAllocator.h"
+#include "DXHelper.h"
+
+void DescriptorAllocator::Init(ID3D12Device* pDevice, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT persistentCount, UINT transientCount, UINT bindlessCount)
+{
+	// Only CBV/SRV/UAV and sampler heaps can be bound to shaders
+	mShaderVisible = type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV || type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
+
+	mIndices.Init(persistentCount, transientCount, bindlessCount);
+
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+	heapDesc.NumDescriptors = mIndices.GetDescriptorCount();
+	heapDesc.Type = type;
+	heapDesc.Flags = mShaderVisible ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+	ThrowIfFailed(pDevice->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&mHeap)));
+
+	mDescriptorSize = pDevice->GetDescriptorHandleIncrementSize(type);
+	mCpuStart = CD3DX12_CPU_DESCRIPTOR_HANDLE(mHeap->GetCPUDescriptorHandleForHeapStart());
+	mGpuStart = mShaderVisible ? CD3DX12_GPU_DESCRIPTOR_HANDLE(mHeap->GetGPUDescriptorHandleForHeapStart()) : CD3DX12_GPU_DESCRIPTOR_HANDLE(D3D12_DEFAULT);
+}
+
+DescriptorHandle DescriptorAllocator::AllocatePersistent()
+{
+	const UINT index = mIndices.AllocatePersistent();
+	if (index == DescriptorIndexAllocator::InvalidIndex)
+		ThrowIfFailed(E_OUTOFMEMORY);
+
+	return GetHandle(index);
+}
+
+void DescriptorAllocator::FreePersistent(const DescriptorHandle& handle)
+{
+	mIndices.FreePersistent(handle.index);
+}
+
+DescriptorHandle DescriptorAllocator::AllocateTransient(UINT count)
+{
+	const UINT index = mIndices.AllocateTransient(count);
+	if (index == DescriptorIndexAllocator::InvalidIndex)
+		ThrowIfFailed(E_OUTOFMEMORY);
+
+	DescriptorHandle handle = GetHandle(index);
+	handle.count = count;
+	return handle;
+}
+
+void DescriptorAllocator::FinishBatch(UINT64 fenceValue)
+{
+	mIndices.FinishBatch(fenceValue);
+}
+
+void DescriptorAllocator::Retire(UINT64 completedFenceValue)
+{
+	mIndices.Retire(completedFenceValue);
+}
+
+DescriptorHandle DescriptorAllocator::GetBindlessTable() const
+{
+	DescriptorHandle handle = GetHandle(0);
+	handle.count = mIndices.GetBindlessCount();
+	return handle;
+}
+
+DescriptorHandle DescriptorAllocator::GetHandle(UINT index) const
+{
+	DescriptorHandle handle;
+	handle.cpu = CD3DX12_CPU_DESCRIPTOR_HANDLE(mCpuStart, static_cast<INT>(index), mDescriptorSize);
+	handle.gpu = mShaderVisible ? CD3DX12_GPU_DESCRIPTOR_HANDLE(mGpuStart, static_cast<INT>(index), mDescriptorSize) : mGpuStart;
+	handle.index = index;
+	handle.count = 1;
+	return handle;
+}
@@ -0,0 +1,52 @@
+#include "DescriptorIndexAllocator.h"
+
+void DescriptorIndexAllocator::Init(uint32_t persistentCount, uint32_t transientCount, uint32_t bindlessCount)
+{
+	mBindlessCount = bindlessCount;
+	mPersistentCount = persistentCount;
+	mTransientCount = transientCount;
+	mPersistentFreeList.Reset(persistentCount);
+	mTransientRing.Reset(transientCount);
+}
+
+uint32_t DescriptorIndexAllocator::AllocatePersistent()
+{
+	const uint32_t index = mPersistentFreeList.Allocate();
+	return index == IndexFreeList::InvalidIndex ? InvalidIndex : mBindlessCount + index;
+}
+
+void DescriptorIndexAllocator::FreePersistent(uint32_t index)
+{
+	mPersistentFreeList.Free(index - mBindlessCount);
+}
+
+uint32_t DescriptorIndexAllocator::AllocateTransient(uint32_t count)
+{
+	uint64_t offset;
+	{
+		std::lock_guard<std::mutex> lock(mTransientMutex);
+		offset = mTransientRing.Allocate(count, 1);
+	}
+	if (offset == RingAllocator::InvalidOffset)
+		return InvalidIndex;
+
+	return mBindlessCount + mPersistentCount + static_cast<uint32_t>(offset);
+}
+
+void DescriptorIndexAllocator::FinishBatch(uint64_t fenceValue)
+{
+	if (mTransientCount == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(mTransientMutex);
+	mTransientRing.FinishBatch(fenceValue);
+}
+
+void DescriptorIndexAllocator::Retire(uint64_t completedFenceValue)
+{
+	if (mTransientCount == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(mTransientMutex);
+	mTransientRing.Retire(completedFenceValue);
+}
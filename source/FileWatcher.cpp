@@ -0,0 +1,213 @@
+#include "FileWatcher.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+
+FileWatcher::~FileWatcher()
+{
+	Stop();
+}
+
+#ifdef _WIN32
+
+bool FileWatcher::Start(const std::filesystem::path& directory, ChangeFunc onChange)
+{
+	Stop();
+
+	HANDLE directoryHandle = CreateFileW(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+	if (directoryHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	mDirectory = std::filesystem::absolute(directory);
+	mOnChange = std::move(onChange);
+	mDirectoryHandle = directoryHandle;
+	mStopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	mThread = std::thread(&FileWatcher::ThreadMain, this);
+	return true;
+}
+
+void FileWatcher::Stop()
+{
+	if (mThread.joinable())
+	{
+		SetEvent(mStopEvent);
+		mThread.join();
+	}
+
+	if (mDirectoryHandle)
+		CloseHandle(mDirectoryHandle);
+	if (mStopEvent)
+		CloseHandle(mStopEvent);
+	mDirectoryHandle = nullptr;
+	mStopEvent = nullptr;
+}
+
+void FileWatcher::ThreadMain()
+{
+	// DWORD aligned as ReadDirectoryChangesW requires
+	std::vector<DWORD> buffer(16 * 1024);
+	OVERLAPPED overlapped = {};
+	overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	const HANDLE events[] = { overlapped.hEvent, mStopEvent };
+
+	for (;;)
+	{
+		ResetEvent(overlapped.hEvent);
+		if (!ReadDirectoryChangesW(mDirectoryHandle, buffer.data(), static_cast<DWORD>(buffer.size() * sizeof(DWORD)), TRUE,
+			FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, nullptr, &overlapped, nullptr))
+			break;
+
+		if (WaitForMultipleObjects(_countof(events), events, FALSE, INFINITE) != WAIT_OBJECT_0)
+		{
+			CancelIoEx(mDirectoryHandle, &overlapped);
+			DWORD ignored;
+			GetOverlappedResult(mDirectoryHandle, &overlapped, &ignored, TRUE);
+			break;
+		}
+
+		DWORD bytes = 0;
+		if (!GetOverlappedResult(mDirectoryHandle, &overlapped, &bytes, FALSE))
+			break;
+		// Zero bytes means the buffer overflowed and the changes are lost, nothing sensible to report
+		if (bytes == 0)
+			continue;
+
+		const BYTE* pEntry = reinterpret_cast<const BYTE*>(buffer.data());
+		for (;;)
+		{
+			const FILE_NOTIFY_INFORMATION* pInfo = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(pEntry);
+			if (pInfo->Action != FILE_ACTION_REMOVED && pInfo->Action != FILE_ACTION_RENAMED_OLD_NAME)
+			{
+				const std::wstring name(pInfo->FileName, pInfo->FileNameLength / sizeof(WCHAR));
+				mOnChange((mDirectory / name).lexically_normal());
+			}
+
+			if (pInfo->NextEntryOffset == 0)
+				break;
+			pEntry += pInfo->NextEntryOffset;
+		}
+	}
+
+	CloseHandle(overlapped.hEvent);
+}
+
+#else
+
+bool FileWatcher::Start(const std::filesystem::path& directory, ChangeFunc onChange)
+{
+	Stop();
+
+	std::error_code error;
+	if (!std::filesystem::is_directory(directory, error))
+		return false;
+
+	mInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (mInotify < 0)
+		return false;
+	if (pipe(mStopPipe) != 0)
+	{
+		close(mInotify);
+		mInotify = -1;
+		return false;
+	}
+
+	mDirectory = std::filesystem::absolute(directory);
+	mOnChange = std::move(onChange);
+	AddWatches(mDirectory);
+	mThread = std::thread(&FileWatcher::ThreadMain, this);
+	return true;
+}
+
+void FileWatcher::Stop()
+{
+	if (mThread.joinable())
+	{
+		const char stop = 0;
+		(void)write(mStopPipe[1], &stop, 1);
+		mThread.join();
+	}
+
+	if (mInotify >= 0)
+		close(mInotify);
+	for (int& fd : mStopPipe)
+	{
+		if (fd >= 0)
+			close(fd);
+		fd = -1;
+	}
+	mInotify = -1;
+	mWatches.clear();
+}
+
+// inotify isn't recursive, every directory of the tree gets its own watch
+void FileWatcher::AddWatches(const std::filesystem::path& directory)
+{
+	const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+	int watch = inotify_add_watch(mInotify, directory.c_str(), mask);
+	if (watch >= 0)
+		mWatches[watch] = directory;
+
+	std::error_code error;
+	for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+	{
+		if (it->is_directory(error))
+		{
+			watch = inotify_add_watch(mInotify, it->path().c_str(), mask);
+			if (watch >= 0)
+				mWatches[watch] = it->path();
+		}
+	}
+}
+
+void FileWatcher::ThreadMain()
+{
+	alignas(inotify_event) char buffer[16 * 1024];
+	pollfd fds[2] = { { mInotify, POLLIN, 0 }, { mStopPipe[0], POLLIN, 0 } };
+
+	for (;;)
+	{
+		if (poll(fds, 2, -1) < 0)
+			continue;
+		if (fds[1].revents)
+			return;
+
+		const ssize_t bytes = read(mInotify, buffer, sizeof(buffer));
+		if (bytes <= 0)
+			continue;
+
+		for (const char* pEntry = buffer; pEntry < buffer + bytes;)
+		{
+			const inotify_event* pEvent = reinterpret_cast<const inotify_event*>(pEntry);
+			pEntry += sizeof(inotify_event) + pEvent->len;
+
+			auto watch = mWatches.find(pEvent->wd);
+			if (watch == mWatches.end() || pEvent->len == 0)
+				continue;
+
+			const std::filesystem::path path = (watch->second / pEvent->name).lexically_normal();
+			if (pEvent->mask & IN_ISDIR)
+			{
+				if (pEvent->mask & (IN_CREATE | IN_MOVED_TO))
+					AddWatches(path);
+			}
+			// A created file is reported again by IN_CLOSE_WRITE once written
+			else if (pEvent->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+			{
+				mOnChange(path);
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,500 @@
+#include "FormatConverter.h"
+#include "FormatConverterKernels.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define FORMAT_CONVERTER_X64 1
+#endif
+
+namespace
+{
+	// D3D_FORMAT_COMPONENT_NAME and D3D_FORMAT_COMPONENT_INTERPRETATION, trimmed to what the converter handles
+	enum ComponentName : uint8_t
+	{
+		ComponentR,
+		ComponentG,
+		ComponentB,
+		ComponentA,
+		ComponentX,
+		ComponentNone
+	};
+
+	enum class ComponentInterpretation : uint8_t
+	{
+		Unorm,
+		Snorm,
+		Float
+	};
+
+	// Components from the lowest bits up, the way D3D12_PROPERTY_LAYOUT_FORMAT_TABLE lists them
+	struct FormatDetail
+	{
+		DXGI_FORMAT format;
+		uint8_t bitsPerComponent[4];
+		ComponentName componentNames[4];
+		ComponentInterpretation interpretation;
+		bool srgb;
+	};
+
+	const FormatDetail FormatDetails[] =
+	{
+		{ DXGI_FORMAT_R32G32B32A32_FLOAT, { 32, 32, 32, 32 }, { ComponentR, ComponentG, ComponentB, ComponentA }, ComponentInterpretation::Float, false },
+		{ DXGI_FORMAT_R32G32B32_FLOAT, { 32, 32, 32, 0 }, { ComponentR, ComponentG, ComponentB, ComponentNone }, ComponentInterpretation::Float, false },
+		{ DXGI_FORMAT_R16G16B16A16_FLOAT, { 16, 16, 16, 16 }, { ComponentR, ComponentG, ComponentB, ComponentA }, ComponentInterpretation::Float, false },
+		{ DXGI_FORMAT_R16G16B16A16_UNORM, { 16, 16, 16, 16 }, { ComponentR, ComponentG, ComponentB, ComponentA }, ComponentInterpretation::Unorm, false },
+		{ DXGI_FORMAT_R16G16B16A16_SNORM, { 16, 16, 16, 16 }, { ComponentR, ComponentG, ComponentB, ComponentA }, ComponentInterpretation::Snorm, false },
+		{ DXGI_FORMAT_R32G32_FLOAT, { 32, 32, 0, 0 }, { ComponentR, ComponentG, ComponentNone, ComponentNone }, ComponentInterpretation::Float, false },
+		{ DXGI_FORMAT_R10G10B10A2_UNORM, { 10, 10, 10, 2 }, { ComponentR, ComponentG, ComponentB, ComponentA }, ComponentInterpretation::Unorm, false },
+		{ DXGI_FORMAT_R11G11B10_FLOAT, { 11, 11, 10, 0 }, { ComponentR, ComponentG, ComponentB, ComponentNone }, ComponentInterpretation::Float, false },
+		{ DXGI_FORMAT_R8G8B8A8_UNORM, { 8, 8, 8, 8 }, { ComponentR, ComponentG, ComponentB, ComponentA }, ComponentInterpretation::Unorm, false },
+		{ DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, { 8, 8, 8, 8 }, { ComponentR, ComponentG, ComponentB, ComponentA }, ComponentInterpretation::Unorm, true },
+		{ DXGI_FORMAT_R8G8B8A8_SNORM, { 8, 8, 8, 8 }, { ComponentR, ComponentG, ComponentB, ComponentA }, ComponentInterpretation::Snorm, false },
+		{ DXGI_FORMAT_R16G16_FLOAT, { 16, 16, 0, 0 }, { ComponentR, ComponentG, ComponentNone, ComponentNone }, ComponentInterpretation::Float, false },
+		{ DXGI_FORMAT_R16G16_UNORM, { 16, 16, 0, 0 }, { ComponentR, ComponentG, ComponentNone, ComponentNone }, ComponentInterpretation::Unorm, false },
+		{ DXGI_FORMAT_R16G16_SNORM, { 16, 16, 0, 0 }, { ComponentR, ComponentG, ComponentNone, ComponentNone }, ComponentInterpretation::Snorm, false },
+		{ DXGI_FORMAT_R32_FLOAT, { 32, 0, 0, 0 }, { ComponentR, ComponentNone, ComponentNone, ComponentNone }, ComponentInterpretation::Float, false },
+		{ DXGI_FORMAT_R8G8_UNORM, { 8, 8, 0, 0 }, { ComponentR, ComponentG, ComponentNone, ComponentNone }, ComponentInterpretation::Unorm, false },
+		{ DXGI_FORMAT_R8G8_SNORM, { 8, 8, 0, 0 }, { ComponentR, ComponentG, ComponentNone, ComponentNone }, ComponentInterpretation::Snorm, false },
+		{ DXGI_FORMAT_R16_FLOAT, { 16, 0, 0, 0 }, { ComponentR, ComponentNone, ComponentNone, ComponentNone }, ComponentInterpretation::Float, false },
+		{ DXGI_FORMAT_R16_UNORM, { 16, 0, 0, 0 }, { ComponentR, ComponentNone, ComponentNone, ComponentNone }, ComponentInterpretation::Unorm, false },
+		{ DXGI_FORMAT_R16_SNORM, { 16, 0, 0, 0 }, { ComponentR, ComponentNone, ComponentNone, ComponentNone }, ComponentInterpretation::Snorm, false },
+		{ DXGI_FORMAT_R8_UNORM, { 8, 0, 0, 0 }, { ComponentR, ComponentNone, ComponentNone, ComponentNone }, ComponentInterpretation::Unorm, false },
+		{ DXGI_FORMAT_R8_SNORM, { 8, 0, 0, 0 }, { ComponentR, ComponentNone, ComponentNone, ComponentNone }, ComponentInterpretation::Snorm, false },
+		{ DXGI_FORMAT_A8_UNORM, { 8, 0, 0, 0 }, { ComponentA, ComponentNone, ComponentNone, ComponentNone }, ComponentInterpretation::Unorm, false },
+		{ DXGI_FORMAT_B5G6R5_UNORM, { 5, 6, 5, 0 }, { ComponentB, ComponentG, ComponentR, ComponentNone }, ComponentInterpretation::Unorm, false },
+		{ DXGI_FORMAT_B5G5R5A1_UNORM, { 5, 5, 5, 1 }, { ComponentB, ComponentG, ComponentR, ComponentA }, ComponentInterpretation::Unorm, false },
+		{ DXGI_FORMAT_B8G8R8A8_UNORM, { 8, 8, 8, 8 }, { ComponentB, ComponentG, ComponentR, ComponentA }, ComponentInterpretation::Unorm, false },
+		{ DXGI_FORMAT_B8G8R8X8_UNORM, { 8, 8, 8, 8 }, { ComponentB, ComponentG, ComponentR, ComponentX }, ComponentInterpretation::Unorm, false },
+		{ DXGI_FORMAT_B8G8R8A8_UNORM_SRGB, { 8, 8, 8, 8 }, { ComponentB, ComponentG, ComponentR, ComponentA }, ComponentInterpretation::Unorm, true },
+		{ DXGI_FORMAT_B8G8R8X8_UNORM_SRGB, { 8, 8, 8, 8 }, { ComponentB, ComponentG, ComponentR, ComponentX }, ComponentInterpretation::Unorm, true },
+		{ DXGI_FORMAT_B4G4R4A4_UNORM, { 4, 4, 4, 4 }, { ComponentB, ComponentG, ComponentR, ComponentA }, ComponentInterpretation::Unorm, false }
+	};
+
+	const FormatDetail* FindFormatDetail(DXGI_FORMAT format)
+	{
+		for (const FormatDetail& detail : FormatDetails)
+		{
+			if (detail.format == format)
+				return &detail;
+		}
+		return nullptr;
+	}
+
+	uint32_t GetBitsPerUnit(const FormatDetail& detail)
+	{
+		return detail.bitsPerComponent[0] + detail.bitsPerComponent[1] + detail.bitsPerComponent[2] + detail.bitsPerComponent[3];
+	}
+
+	// No component crosses a 32-bit boundary in any format above, so each lands in one word
+	PixelLayout GetPixelLayout(const FormatDetail& detail)
+	{
+		const uint32_t pixelSize = GetBitsPerUnit(detail) / 8;
+
+		PixelLayout layout = {};
+		layout.wordSize = std::min(pixelSize, 4u);
+		layout.wordCount = pixelSize / layout.wordSize;
+
+		uint32_t offset = 0;
+		for (uint32_t n = 0; n < 4; n++)
+		{
+			const uint32_t bits = detail.bitsPerComponent[n];
+			const ComponentName name = detail.componentNames[n];
+			if (name <= ComponentA)
+			{
+				ChannelLayout& channel = layout.channels[name];
+				channel.present = true;
+				channel.word = static_cast<uint8_t>(offset / 32);
+				channel.shift = static_cast<uint8_t>(offset % 32);
+				channel.bits = static_cast<uint8_t>(bits);
+				switch (detail.interpretation)
+				{
+				case ComponentInterpretation::Snorm: channel.encoding = ComponentEncoding::Snorm; break;
+				case ComponentInterpretation::Float: channel.encoding = ComponentEncoding::Float; break;
+				default: channel.encoding = detail.srgb && name != ComponentA ? ComponentEncoding::Srgb : ComponentEncoding::Unorm; break;
+				}
+			}
+			offset += bits;
+		}
+		return layout;
+	}
+
+	double SrgbToLinear(double value)
+	{
+		return value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+	}
+
+	double LinearToSrgb(double value)
+	{
+		return value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+	}
+
+	struct SrgbTables
+	{
+		float decode[256];
+		uint8_t encode[65536 + 4];
+
+		SrgbTables()
+		{
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				decode[i] = static_cast<float>(SrgbToLinear(i / 255.0));
+			}
+			for (uint32_t i = 0; i < 65536; i++)
+			{
+				encode[i] = static_cast<uint8_t>(LinearToSrgb(i / 65535.0) * 255.0 + 0.5);
+			}
+			std::fill(encode + 65536, encode + 65536 + 4, encode[65535]);
+		}
+	};
+
+	uint32_t GetMask(uint32_t bits)
+	{
+		return bits == 32 ? 0xffffffffu : (1u << bits) - 1;
+	}
+
+	float BitsToFloat(uint32_t bits)
+	{
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	uint32_t FloatToBits(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	// Same results as F16C, NaNs keep their sign and top payload bits and turn quiet
+	float HalfToFloat(uint32_t half)
+	{
+		const uint32_t sign = (half & 0x8000) << 16;
+		const uint32_t exponent = (half >> 10) & 0x1f;
+		const uint32_t mantissa = half & 0x3ff;
+		if (exponent == 0x1f)
+			return BitsToFloat(sign | 0x7f800000 | (mantissa ? 0x400000 | (mantissa << 13) : 0));
+		if (exponent == 0)
+		{
+			const float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+			return sign ? -magnitude : magnitude;
+		}
+		return BitsToFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+	}
+
+	// Unsigned 11 and 10-bit floats: 5 exponent bits over mantissaBits
+	float SmallFloatToFloat(uint32_t value, uint32_t mantissaBits)
+	{
+		const uint32_t exponent = value >> mantissaBits;
+		const uint32_t mantissa = value & ((1u << mantissaBits) - 1);
+		if (exponent == 0x1f)
+			return BitsToFloat(mantissa ? 0x7fc00000 : 0x7f800000);
+		if (exponent == 0)
+			return static_cast<float>(mantissa) * BitsToFloat((127 - 14 - mantissaBits) << 23);
+		return BitsToFloat(((exponent + 112) << 23) | (mantissa << (23 - mantissaBits)));
+	}
+
+	// Finite non-negative float bits to a 5-bit exponent float, rounded to nearest even, without overflow handling
+	uint32_t RoundToSmallFloat(uint32_t bits, uint32_t mantissaBits)
+	{
+		const uint32_t exponent = bits >> 23;
+		if (exponent >= 113)
+		{
+			const uint32_t rebased = bits - (112u << 23);
+			const uint32_t shift = 23 - mantissaBits;
+			return (rebased + (1u << (shift - 1)) - 1 + ((rebased >> shift) & 1)) >> shift;
+		}
+
+		// Denormal, shifts past 24 bits round to zero
+		const uint32_t mantissa = (bits & 0x7fffff) | 0x800000;
+		const uint32_t shift = std::min(136 - mantissaBits - exponent, 31u);
+		return (mantissa + (1u << (shift - 1)) - 1 + ((mantissa >> shift) & 1)) >> shift;
+	}
+
+	uint32_t FloatToHalf(float value)
+	{
+		const uint32_t bits = FloatToBits(value);
+		const uint32_t sign = (bits >> 16) & 0x8000;
+		const uint32_t magnitude = bits & 0x7fffffff;
+		if (magnitude > 0x7f800000)
+			return sign | 0x7e00 | ((magnitude >> 13) & 0x3ff);
+		if (magnitude == 0x7f800000)
+			return sign | 0x7c00;
+		return sign | std::min(RoundToSmallFloat(magnitude, 10), 0x7c00u);
+	}
+
+	uint32_t FloatToSmallFloat(float value, uint32_t mantissaBits)
+	{
+		const uint32_t bits = FloatToBits(value);
+		const uint32_t magnitude = bits & 0x7fffffff;
+		const uint32_t infinity = 0x1fu << mantissaBits;
+		if (magnitude > 0x7f800000)
+			return infinity | ((1u << mantissaBits) - 1);
+		if (bits >> 31)
+			return 0;
+		if (magnitude == 0x7f800000)
+			return infinity;
+		return std::min(RoundToSmallFloat(magnitude, mantissaBits), infinity - 1);
+	}
+
+	float DecodeChannel(const ChannelLayout& channel, const ConversionTables& tables, uint32_t word)
+	{
+		const uint32_t mask = GetMask(channel.bits);
+		const uint32_t value = (word >> channel.shift) & mask;
+		switch (channel.encoding)
+		{
+		case ComponentEncoding::Unorm:
+			return static_cast<float>(value) / static_cast<float>(mask);
+		case ComponentEncoding::Snorm:
+		{
+			const int32_t signedValue = static_cast<int32_t>(value << (32 - channel.bits)) >> (32 - channel.bits);
+			const float result = static_cast<float>(signedValue) / static_cast<float>(mask >> 1);
+			return result < -1.0f ? -1.0f : result;
+		}
+		case ComponentEncoding::Srgb:
+			return tables.pSrgbDecode[value];
+		default:
+			if (channel.bits == 32)
+				return BitsToFloat(value);
+			if (channel.bits == 16)
+				return HalfToFloat(value);
+			return SmallFloatToFloat(value, channel.bits - 5);
+		}
+	}
+
+	// Out of range and NaN inputs clamp the way the AVX2 min and max do
+	uint32_t EncodeChannel(const ChannelLayout& channel, const ConversionTables& tables, float value)
+	{
+		const uint32_t mask = GetMask(channel.bits);
+		switch (channel.encoding)
+		{
+		case ComponentEncoding::Unorm:
+		case ComponentEncoding::Srgb:
+		{
+			value = value > 0.0f ? value : 0.0f;
+			value = value < 1.0f ? value : 1.0f;
+			if (channel.encoding == ComponentEncoding::Srgb)
+				return tables.pSrgbEncode[static_cast<uint32_t>(std::nearbyint(value * 65535.0f))];
+			return static_cast<uint32_t>(std::nearbyint(value * static_cast<float>(mask)));
+		}
+		case ComponentEncoding::Snorm:
+		{
+			value = value == value ? value : 0.0f;
+			value = value > -1.0f ? value : -1.0f;
+			value = value < 1.0f ? value : 1.0f;
+			return static_cast<uint32_t>(static_cast<int32_t>(std::nearbyint(value * static_cast<float>(mask >> 1)))) & mask;
+		}
+		default:
+			if (channel.bits == 32)
+				return FloatToBits(value);
+			if (channel.bits == 16)
+				return FloatToHalf(value);
+			return FloatToSmallFloat(value, channel.bits - 5);
+		}
+	}
+
+	uint32_t ReadWord(const uint8_t* pSource, uint32_t wordSize)
+	{
+		uint32_t word = 0;
+		memcpy(&word, pSource, wordSize);
+		return word;
+	}
+
+	void DecodePixelsScalar(const PixelLayout& layout, const ConversionTables& tables, const uint8_t* pSource, uint32_t first, uint32_t count,
+		float* const* ppPlanes)
+	{
+		const uint32_t pixelSize = layout.wordSize * layout.wordCount;
+		for (uint32_t x = first; x < count; x++)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				const ChannelLayout& channel = layout.channels[c];
+				if (channel.present)
+				{
+					const uint32_t word = ReadWord(pSource + x * pixelSize + channel.word * layout.wordSize, layout.wordSize);
+					ppPlanes[c][x] = DecodeChannel(channel, tables, word);
+				}
+			}
+		}
+	}
+
+	void EncodePixelsScalar(const PixelLayout& layout, const ConversionTables& tables, const float* const* ppPlanes, uint32_t first, uint32_t count,
+		uint8_t* pDest)
+	{
+		const uint32_t pixelSize = layout.wordSize * layout.wordCount;
+		for (uint32_t x = first; x < count; x++)
+		{
+			uint32_t words[4] = {};
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				const ChannelLayout& channel = layout.channels[c];
+				if (channel.present)
+					words[channel.word] |= EncodeChannel(channel, tables, ppPlanes[c][x]) << channel.shift;
+			}
+			for (uint32_t w = 0; w < layout.wordCount; w++)
+			{
+				memcpy(pDest + x * pixelSize + w * layout.wordSize, &words[w], layout.wordSize);
+			}
+		}
+	}
+
+	struct Conversion
+	{
+		static constexpr uint32_t ChunkPixels = 256;
+
+		PixelLayout source;
+		PixelLayout dest;
+		uint32_t sourcePixelSize;
+		uint32_t destPixelSize;
+		ConversionTables tables;
+		bool copy;
+		bool avx2;
+
+		void ConvertRow(const uint8_t* pSource, uint8_t* pDest, uint32_t width) const
+		{
+			if (copy)
+			{
+				memcpy(pDest, pSource, size_t(width) * sourcePixelSize);
+				return;
+			}
+
+			alignas(32) float planes[4][ChunkPixels];
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				if (!source.channels[c].present)
+					std::fill(planes[c], planes[c] + ChunkPixels, c == 3 ? 1.0f : 0.0f);
+			}
+
+			for (uint32_t x = 0; x < width; x += ChunkPixels)
+			{
+				const uint32_t count = std::min(ChunkPixels, width - x);
+				float* ppPlanes[4] = { planes[0], planes[1], planes[2], planes[3] };
+				const uint8_t* pSourcePixels = pSource + size_t(x) * sourcePixelSize;
+				uint8_t* pDestPixels = pDest + size_t(x) * destPixelSize;
+
+				uint32_t decoded = 0;
+				uint32_t encoded = 0;
+#ifdef FORMAT_CONVERTER_X64
+				if (avx2)
+					decoded = DecodePixelsAvx2(source, tables, pSourcePixels, count, ppPlanes);
+#endif
+				DecodePixelsScalar(source, tables, pSourcePixels, decoded, count, ppPlanes);
+#ifdef FORMAT_CONVERTER_X64
+				if (avx2)
+					encoded = EncodePixelsAvx2(dest, tables, ppPlanes, count, pDestPixels);
+#endif
+				EncodePixelsScalar(dest, tables, ppPlanes, encoded, count, pDestPixels);
+			}
+		}
+	};
+
+	// Rows [firstRow, firstRow + rowCount) of one slice of one subresource
+	struct RowBand
+	{
+		uint32_t subresource;
+		uint32_t slice;
+		uint32_t firstRow;
+		uint32_t rowCount;
+	};
+}
+
+bool FormatConverter::IsSupported(DXGI_FORMAT format)
+{
+	return FindFormatDetail(format) != nullptr;
+}
+
+bool FormatConverter::IsSrgb(DXGI_FORMAT format)
+{
+	const FormatDetail* pDetail = FindFormatDetail(format);
+	return pDetail && pDetail->srgb;
+}
+
+uint32_t FormatConverter::GetPixelSize(DXGI_FORMAT format)
+{
+	const FormatDetail* pDetail = FindFormatDetail(format);
+	return pDetail ? GetBitsPerUnit(*pDetail) / 8 : 0;
+}
+
+bool FormatConverter::Convert(const Settings& settings, DXGI_FORMAT sourceFormat, DXGI_FORMAT destFormat,
+	const FormatConversionDesc* pSubresources, uint32_t count, JobSystem* pJobSystem)
+{
+	const FormatDetail* pSourceDetail = FindFormatDetail(sourceFormat);
+	const FormatDetail* pDestDetail = FindFormatDetail(destFormat);
+	if (!pSourceDetail || !pDestDetail)
+		return false;
+
+	static const SrgbTables srgbTables;
+
+	Conversion conversion;
+	conversion.source = GetPixelLayout(*pSourceDetail);
+	conversion.dest = GetPixelLayout(*pDestDetail);
+	conversion.sourcePixelSize = GetBitsPerUnit(*pSourceDetail) / 8;
+	conversion.destPixelSize = GetBitsPerUnit(*pDestDetail) / 8;
+	conversion.tables = { srgbTables.decode, srgbTables.encode };
+	conversion.copy = sourceFormat == destFormat;
+#ifdef FORMAT_CONVERTER_X64
+	conversion.avx2 = settings.allowAvx2 && CpuFeatures::HasAvx2();
+#else
+	(void)settings;
+	conversion.avx2 = false;
+#endif
+
+	uint64_t pixelCount = 0;
+	for (uint32_t n = 0; n < count; n++)
+	{
+		pixelCount += uint64_t(pSubresources[n].width) * pSubresources[n].height * pSubresources[n].depth;
+	}
+
+	const auto convertRows = [&](const FormatConversionDesc& subresource, uint32_t slice, uint32_t firstRow, uint32_t rowCount)
+	{
+		const uint8_t* pSource = static_cast<const uint8_t*>(subresource.pSource) + subresource.sourceSlicePitch * slice;
+		uint8_t* pDest = static_cast<uint8_t*>(subresource.pDest) + subresource.destSlicePitch * slice;
+		for (uint32_t row = firstRow; row < firstRow + rowCount; row++)
+		{
+			conversion.ConvertRow(pSource + subresource.sourceRowPitch * row, pDest + subresource.destRowPitch * row, subresource.width);
+		}
+	};
+
+	if (!pJobSystem || pixelCount <= PixelsPerJob)
+	{
+		for (uint32_t n = 0; n < count; n++)
+		{
+			for (uint32_t slice = 0; slice < pSubresources[n].depth; slice++)
+			{
+				convertRows(pSubresources[n], slice, 0, pSubresources[n].height);
+			}
+		}
+		return true;
+	}
+
+	// Small mips and slices make small jobs, bands never cross them
+	std::vector<RowBand> bands;
+	for (uint32_t n = 0; n < count; n++)
+	{
+		const FormatConversionDesc& subresource = pSubresources[n];
+		if (subresource.width == 0)
+			continue;
+
+		const uint32_t rowsPerBand = std::max(PixelsPerJob / subresource.width, 1u);
+		for (uint32_t slice = 0; slice < subresource.depth; slice++)
+		{
+			for (uint32_t row = 0; row < subresource.height; row += rowsPerBand)
+			{
+				bands.push_back({ n, slice, row, std::min(rowsPerBand, subresource.height - row) });
+			}
+		}
+	}
+
+	pJobSystem->ParallelFor(static_cast<unsigned int>(bands.size()), [&](unsigned int index, unsigned int)
+	{
+		const RowBand& band = bands[index];
+		convertRows(pSubresources[band.subresource], band.slice, band.firstRow, band.rowCount);
+	});
+	return true;
+}
@@ -0,0 +1,262 @@
+#include "FormatConverterKernels.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+// Built with AVX2 code generation, only called once the CPU reported support for it.
+// Every step mirrors the scalar kernels in FormatConverter.cpp so both give the same bits.
+
+namespace
+{
+	uint32_t GetMask(uint32_t bits)
+	{
+		return bits == 32 ? 0xffffffffu : (1u << bits) - 1;
+	}
+
+	// Word w of eight pixels, zero extended to 32 bits
+	__m256i LoadWords(const PixelLayout& layout, const uint8_t* pPixels, uint32_t word)
+	{
+		switch (layout.wordSize)
+		{
+		case 1:
+			return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pPixels)));
+		case 2:
+			return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pPixels)));
+		default:
+			if (layout.wordCount == 1)
+				return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pPixels));
+			{
+				const __m256i indices = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+					_mm256_set1_epi32(static_cast<int>(layout.wordCount))), _mm256_set1_epi32(static_cast<int>(word)));
+				return _mm256_i32gather_epi32(reinterpret_cast<const int*>(pPixels), indices, 4);
+			}
+		}
+	}
+
+	// wordCount words per pixel for eight pixels, interleaved back into memory order
+	void StoreWords(const PixelLayout& layout, const __m256i* pWords, uint8_t* pPixels)
+	{
+		switch (layout.wordSize)
+		{
+		case 1:
+		{
+			const __m256i shorts = _mm256_packus_epi32(pWords[0], pWords[0]);
+			const __m256i bytes = _mm256_packus_epi16(shorts, shorts);
+			const __m256i packed = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(pPixels), _mm256_castsi256_si128(packed));
+			return;
+		}
+		case 2:
+		{
+			const __m256i shorts = _mm256_permute4x64_epi64(_mm256_packus_epi32(pWords[0], pWords[0]), 0x08);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pPixels), _mm256_castsi256_si128(shorts));
+			return;
+		}
+		default:
+			break;
+		}
+
+		__m256i* pDest = reinterpret_cast<__m256i*>(pPixels);
+		switch (layout.wordCount)
+		{
+		case 1:
+			_mm256_storeu_si256(pDest, pWords[0]);
+			break;
+		case 2:
+		{
+			const __m256i low = _mm256_unpacklo_epi32(pWords[0], pWords[1]);
+			const __m256i high = _mm256_unpackhi_epi32(pWords[0], pWords[1]);
+			_mm256_storeu_si256(pDest, _mm256_permute2x128_si256(low, high, 0x20));
+			_mm256_storeu_si256(pDest + 1, _mm256_permute2x128_si256(low, high, 0x31));
+			break;
+		}
+		case 4:
+		{
+			const __m256i t0 = _mm256_unpacklo_epi32(pWords[0], pWords[1]);
+			const __m256i t1 = _mm256_unpackhi_epi32(pWords[0], pWords[1]);
+			const __m256i t2 = _mm256_unpacklo_epi32(pWords[2], pWords[3]);
+			const __m256i t3 = _mm256_unpackhi_epi32(pWords[2], pWords[3]);
+			const __m256i p0 = _mm256_unpacklo_epi64(t0, t2);
+			const __m256i p1 = _mm256_unpackhi_epi64(t0, t2);
+			const __m256i p2 = _mm256_unpacklo_epi64(t1, t3);
+			const __m256i p3 = _mm256_unpackhi_epi64(t1, t3);
+			_mm256_storeu_si256(pDest, _mm256_permute2x128_si256(p0, p1, 0x20));
+			_mm256_storeu_si256(pDest + 1, _mm256_permute2x128_si256(p2, p3, 0x20));
+			_mm256_storeu_si256(pDest + 2, _mm256_permute2x128_si256(p0, p1, 0x31));
+			_mm256_storeu_si256(pDest + 3, _mm256_permute2x128_si256(p2, p3, 0x31));
+			break;
+		}
+		default:
+		{
+			alignas(32) uint32_t words[4][8];
+			for (uint32_t w = 0; w < layout.wordCount; w++)
+			{
+				_mm256_store_si256(reinterpret_cast<__m256i*>(words[w]), pWords[w]);
+			}
+			uint32_t* pDestWords = reinterpret_cast<uint32_t*>(pPixels);
+			for (uint32_t x = 0; x < 8; x++)
+			{
+				for (uint32_t w = 0; w < layout.wordCount; w++)
+				{
+					pDestWords[x * layout.wordCount + w] = words[w][x];
+				}
+			}
+			break;
+		}
+		}
+	}
+
+	__m256 SmallFloatToFloat(__m256i value, uint32_t mantissaBits)
+	{
+		const __m256i exponent = _mm256_srl_epi32(value, _mm_cvtsi32_si128(static_cast<int>(mantissaBits)));
+		const __m256i mantissa = _mm256_and_si256(value, _mm256_set1_epi32((1 << mantissaBits) - 1));
+
+		const __m256i normal = _mm256_or_si256(_mm256_slli_epi32(_mm256_add_epi32(exponent, _mm256_set1_epi32(112)), 23),
+			_mm256_sll_epi32(mantissa, _mm_cvtsi32_si128(static_cast<int>(23 - mantissaBits))));
+		const __m256 denormal = _mm256_mul_ps(_mm256_cvtepi32_ps(mantissa),
+			_mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>((127 - 14 - mantissaBits) << 23))));
+		const __m256i special = _mm256_blendv_epi8(_mm256_set1_epi32(0x7fc00000), _mm256_set1_epi32(0x7f800000),
+			_mm256_cmpeq_epi32(mantissa, _mm256_setzero_si256()));
+
+		__m256 result = _mm256_blendv_ps(_mm256_castsi256_ps(normal), denormal,
+			_mm256_castsi256_ps(_mm256_cmpeq_epi32(exponent, _mm256_setzero_si256())));
+		result = _mm256_blendv_ps(result, _mm256_castsi256_ps(special), _mm256_castsi256_ps(_mm256_cmpeq_epi32(exponent, _mm256_set1_epi32(0x1f))));
+		return result;
+	}
+
+	// RoundToSmallFloat, the rebased normal and the denormal result are both computed and blended
+	__m256i RoundToSmallFloat(__m256i bits, uint32_t mantissaBits)
+	{
+		const __m256i one = _mm256_set1_epi32(1);
+		const __m256i exponent = _mm256_srli_epi32(bits, 23);
+
+		const int normalShift = static_cast<int>(23 - mantissaBits);
+		const __m128i normalShiftCount = _mm_cvtsi32_si128(normalShift);
+		const __m256i rebased = _mm256_sub_epi32(bits, _mm256_set1_epi32(112 << 23));
+		const __m256i normal = _mm256_srl_epi32(_mm256_add_epi32(_mm256_add_epi32(rebased, _mm256_set1_epi32((1 << (normalShift - 1)) - 1)),
+			_mm256_and_si256(_mm256_srl_epi32(rebased, normalShiftCount), one)), normalShiftCount);
+
+		const __m256i mantissa = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x7fffff)), _mm256_set1_epi32(0x800000));
+		const __m256i shift = _mm256_min_epu32(_mm256_sub_epi32(_mm256_set1_epi32(static_cast<int>(136 - mantissaBits)), exponent), _mm256_set1_epi32(31));
+		const __m256i half = _mm256_sub_epi32(_mm256_sllv_epi32(one, _mm256_sub_epi32(shift, one)), one);
+		const __m256i denormal = _mm256_srlv_epi32(_mm256_add_epi32(_mm256_add_epi32(mantissa, half),
+			_mm256_and_si256(_mm256_srlv_epi32(mantissa, shift), one)), shift);
+
+		return _mm256_blendv_epi8(denormal, normal, _mm256_cmpgt_epi32(exponent, _mm256_set1_epi32(112)));
+	}
+
+	__m256i FloatToSmallFloat(__m256 value, uint32_t mantissaBits)
+	{
+		const __m256i bits = _mm256_castps_si256(value);
+		const __m256i magnitude = _mm256_and_si256(bits, _mm256_set1_epi32(0x7fffffff));
+		const __m256i infinity = _mm256_set1_epi32(0x1f << mantissaBits);
+
+		__m256i result = _mm256_min_epu32(RoundToSmallFloat(magnitude, mantissaBits), _mm256_sub_epi32(infinity, _mm256_set1_epi32(1)));
+		result = _mm256_blendv_epi8(result, infinity, _mm256_cmpeq_epi32(magnitude, _mm256_set1_epi32(0x7f800000)));
+		result = _mm256_andnot_si256(_mm256_srai_epi32(bits, 31), result);
+		result = _mm256_blendv_epi8(result, _mm256_set1_epi32((0x20 << mantissaBits) - 1), _mm256_cmpgt_epi32(magnitude, _mm256_set1_epi32(0x7f800000)));
+		return result;
+	}
+
+	__m256 DecodeChannel(const ChannelLayout& channel, const ConversionTables& tables, __m256i words)
+	{
+		const uint32_t mask = GetMask(channel.bits);
+		const __m256i value = _mm256_and_si256(_mm256_srl_epi32(words, _mm_cvtsi32_si128(channel.shift)), _mm256_set1_epi32(static_cast<int>(mask)));
+		switch (channel.encoding)
+		{
+		case ComponentEncoding::Unorm:
+			return _mm256_div_ps(_mm256_cvtepi32_ps(value), _mm256_set1_ps(static_cast<float>(mask)));
+		case ComponentEncoding::Snorm:
+		{
+			const __m128i extend = _mm_cvtsi32_si128(32 - channel.bits);
+			const __m256i signedValue = _mm256_sra_epi32(_mm256_sll_epi32(value, extend), extend);
+			return _mm256_max_ps(_mm256_div_ps(_mm256_cvtepi32_ps(signedValue), _mm256_set1_ps(static_cast<float>(mask >> 1))), _mm256_set1_ps(-1.0f));
+		}
+		case ComponentEncoding::Srgb:
+			return _mm256_i32gather_ps(tables.pSrgbDecode, value, 4);
+		default:
+			if (channel.bits == 32)
+				return _mm256_castsi256_ps(value);
+			if (channel.bits == 16)
+				return _mm256_cvtph_ps(_mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(value, value), 0x08)));
+			return SmallFloatToFloat(value, channel.bits - 5u);
+		}
+	}
+
+	__m256i EncodeChannel(const ChannelLayout& channel, const ConversionTables& tables, __m256 value)
+	{
+		const uint32_t mask = GetMask(channel.bits);
+		switch (channel.encoding)
+		{
+		case ComponentEncoding::Unorm:
+		case ComponentEncoding::Srgb:
+		{
+			// max returns its second operand for NaN
+			value = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+			if (channel.encoding == ComponentEncoding::Srgb)
+			{
+				const __m256i indices = _mm256_cvtps_epi32(_mm256_mul_ps(value, _mm256_set1_ps(65535.0f)));
+				const __m256i codes = _mm256_i32gather_epi32(reinterpret_cast<const int*>(tables.pSrgbEncode), indices, 1);
+				return _mm256_and_si256(codes, _mm256_set1_epi32(0xff));
+			}
+			return _mm256_cvtps_epi32(_mm256_mul_ps(value, _mm256_set1_ps(static_cast<float>(mask))));
+		}
+		case ComponentEncoding::Snorm:
+		{
+			value = _mm256_and_ps(value, _mm256_cmp_ps(value, value, _CMP_ORD_Q));
+			value = _mm256_min_ps(_mm256_max_ps(value, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f));
+			const __m256i code = _mm256_cvtps_epi32(_mm256_mul_ps(value, _mm256_set1_ps(static_cast<float>(mask >> 1))));
+			return _mm256_and_si256(code, _mm256_set1_epi32(static_cast<int>(mask)));
+		}
+		default:
+			if (channel.bits == 32)
+				return _mm256_castps_si256(value);
+			if (channel.bits == 16)
+				return _mm256_cvtepu16_epi32(_mm256_cvtps_ph(value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+			return FloatToSmallFloat(value, channel.bits - 5u);
+		}
+	}
+}
+
+uint32_t DecodePixelsAvx2(const PixelLayout& layout, const ConversionTables& tables, const uint8_t* pSource, uint32_t count, float* const* ppPlanes)
+{
+	const uint32_t pixelSize = layout.wordSize * layout.wordCount;
+
+	uint32_t x = 0;
+	for (; x + 8 <= count; x += 8)
+	{
+		const uint8_t* pPixels = pSource + x * pixelSize;
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			const ChannelLayout& channel = layout.channels[c];
+			if (channel.present)
+				_mm256_store_ps(ppPlanes[c] + x, DecodeChannel(channel, tables, LoadWords(layout, pPixels, channel.word)));
+		}
+	}
+	return x;
+}
+
+uint32_t EncodePixelsAvx2(const PixelLayout& layout, const ConversionTables& tables, const float* const* ppPlanes, uint32_t count, uint8_t* pDest)
+{
+	const uint32_t pixelSize = layout.wordSize * layout.wordCount;
+
+	uint32_t x = 0;
+	for (; x + 8 <= count; x += 8)
+	{
+		__m256i words[4] = { _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256() };
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			const ChannelLayout& channel = layout.channels[c];
+			if (channel.present)
+			{
+				const __m256i code = EncodeChannel(channel, tables, _mm256_load_ps(ppPlanes[c] + x));
+				words[channel.word] = _mm256_or_si256(words[channel.word], _mm256_sll_epi32(code, _mm_cvtsi32_si128(channel.shift)));
+			}
+		}
+		StoreWords(layout, words, pDest + x * pixelSize);
+	}
+	return x;
+}
+
+#endif
@@ -0,0 +1,157 @@
+#include "FrameLoop.h"
+#include "CpuProfiler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+FrameLoop::FrameLoop()
+	:
+	mpBackend(nullptr),
+	mpHost(nullptr),
+	mpBenchmark(nullptr),
+	mFrameLimit(0),
+	mRenderedFrameCount(0),
+	mLastFrameIndex(0),
+	mQuitRequested(false),
+	mLastPresentTime(0.0),
+	mHasPresented(false),
+	mNextGpuFrameTime(0),
+	mLastGpuFrameTime(0.0),
+	mLastStatusTime(0.0),
+	mHasStatus(false)
+{
+}
+
+void FrameLoop::Init(RenderBackend* pBackend, FrameHost* pHost, uint32_t frameCount, uint32_t frameIndex,
+	uint32_t frameLimit, BenchmarkRecorder* pBenchmark)
+{
+	mpBackend = pBackend;
+	mpHost = pHost;
+	mpBenchmark = pBenchmark;
+	mFrameLimit = frameLimit;
+	mFrameRing.Init(&pBackend->GetFrameQueue(), frameCount, frameIndex);
+	mGpuFrameTimes.reserve(StatusWindowSize);
+}
+
+void FrameLoop::RunFrame()
+{
+	WaitForNextFrame();
+
+	const uint32_t frameIndex = mFrameRing.GetFrameIndex();
+	const uint64_t fenceValue = mFrameRing.GetFenceValue();
+	const double frameStart = mpBackend->GetTime();
+	UpdateStatus(frameStart);
+
+	mpBackend->Update(fenceValue);
+	mpBackend->Render(frameIndex, fenceValue);
+	mFramePacer.SubmitFrame(fenceValue, mpBackend->GetTime());
+
+	const uint32_t nextFrameIndex = mpBackend->Present(frameIndex);
+	mLastFrameIndex = frameIndex;
+	EndFrameTiming(frameStart);
+
+	MoveToNextFrame(nextFrameIndex);
+}
+
+void FrameLoop::Flush()
+{
+	Retire(mFrameRing.Flush());
+}
+
+// Frame start: the display's latency limit first, then whatever the pacer holds back on top
+void FrameLoop::WaitForNextFrame()
+{
+	PROFILE_FUNCTION();
+
+	mpBackend->WaitForDisplay();
+
+	const double wait = mFramePacer.GetWaitTime(mpBackend->GetTime());
+	if (wait > 0.0)
+		mpBackend->Wait(wait);
+
+	mFramePacer.BeginFrame(mFrameRing.GetFenceValue(), mpBackend->GetTime());
+}
+
+// GPU timings once a second, often enough to read them
+void FrameLoop::UpdateStatus(double now)
+{
+	if (mGpuFrameTimes.empty() || (mHasStatus && now - mLastStatusTime < StatusInterval))
+		return;
+
+	std::vector<double> sorted = mGpuFrameTimes;
+	std::sort(sorted.begin(), sorted.end());
+	double total = 0.0;
+	for (double time : sorted)
+		total += time;
+	const double p99 = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+
+	char text[192];
+	snprintf(text, sizeof(text), "GPU %.2f ms (min %.2f, avg %.2f, p99 %.2f), latency %.2f ms", mLastGpuFrameTime, sorted.front(),
+		total / static_cast<double>(sorted.size()), p99, mFramePacer.GetFrameLatency());
+	mpHost->SetStatusText(text);
+	mLastStatusTime = now;
+	mHasStatus = true;
+}
+
+// Before the frame fence wait, CPU time is what the frame cost to record and submit
+void FrameLoop::EndFrameTiming(double frameStart)
+{
+	mRenderedFrameCount++;
+
+	if (mpBenchmark)
+	{
+		const double now = mpBackend->GetTime();
+		mpBenchmark->AddSample(BenchmarkRecorder::CpuFrameTime, now - frameStart);
+		if (mHasPresented)
+			mpBenchmark->AddSample(BenchmarkRecorder::PresentInterval, now - mLastPresentTime);
+		mLastPresentTime = now;
+		mHasPresented = true;
+
+		mpBenchmark->EndFrame();
+		if (mpBenchmark->IsComplete())
+			RequestQuit();
+	}
+	else if (mFrameLimit != 0 && mRenderedFrameCount >= mFrameLimit)
+	{
+		RequestQuit();
+	}
+}
+
+void FrameLoop::MoveToNextFrame(uint32_t nextFrameIndex)
+{
+	PROFILE_FUNCTION();
+
+	// Only blocks when the CPU is a whole ring of frames ahead of the GPU
+	Retire(mFrameRing.MoveToNextFrame(nextFrameIndex));
+}
+
+void FrameLoop::Retire(uint64_t completedValue)
+{
+	mRetiredFrames.clear();
+	mpBackend->Retire(completedValue, mRetiredFrames);
+
+	for (const RenderBackend::GpuFrame& frame : mRetiredFrames)
+	{
+		const double gpuTime = frame.end - frame.begin;
+		mFramePacer.CompleteFrame(frame.fenceValue, frame.begin, frame.end);
+		if (mpBenchmark)
+			mpBenchmark->AddSample(BenchmarkRecorder::GpuFrameTime, gpuTime);
+
+		if (mGpuFrameTimes.size() < StatusWindowSize)
+			mGpuFrameTimes.push_back(gpuTime);
+		else
+			mGpuFrameTimes[mNextGpuFrameTime] = gpuTime;
+		mNextGpuFrameTime = (mNextGpuFrameTime + 1) % StatusWindowSize;
+		mLastGpuFrameTime = gpuTime;
+	}
+}
+
+// The benchmark report is written by the owner, once the last GPU times were retired
+void FrameLoop::RequestQuit()
+{
+	if (mQuitRequested)
+		return;
+
+	mQuitRequested = true;
+	mpHost->RequestQuit();
+}
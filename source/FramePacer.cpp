@@ -0,0 +1,97 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+
+FramePacer::FramePacer()
+{
+	Reset();
+}
+
+void FramePacer::SetSettings(const Settings& settings)
+{
+	// A new cap starts a new phase
+	if (settings.targetFrameTime != mSettings.targetFrameTime)
+		mHasDeadline = false;
+	if (!settings.lowLatency)
+		mLatencyDelay = 0.0;
+
+	mSettings = settings;
+}
+
+double FramePacer::GetWaitTime(double now) const
+{
+	double wait = 0.0;
+	if (mSettings.targetFrameTime > 0.0 && mHasDeadline)
+		wait = mNextDeadline - now;
+	if (mSettings.lowLatency)
+		wait = std::max(wait, mLatencyDelay);
+
+	return std::max(wait, 0.0);
+}
+
+void FramePacer::BeginFrame(uint64_t frameId, double now)
+{
+	if (mSettings.targetFrameTime > 0.0)
+	{
+		// Late by less than an interval, the next frame catches up. Later than that, the phase restarts here.
+		const double deadline = mHasDeadline ? mNextDeadline : now;
+		mNextDeadline = deadline + mSettings.targetFrameTime;
+		if (mNextDeadline <= now)
+			mNextDeadline = now + mSettings.targetFrameTime;
+		mHasDeadline = true;
+	}
+
+	PendingFrame& frame = mPending[frameId % PendingFrameCount];
+	frame.id = frameId;
+	frame.start = now;
+	frame.submit = now;
+	frame.valid = true;
+}
+
+void FramePacer::SubmitFrame(uint64_t frameId, double now)
+{
+	PendingFrame& frame = mPending[frameId % PendingFrameCount];
+	if (frame.valid && frame.id == frameId)
+		frame.submit = now;
+}
+
+void FramePacer::CompleteFrame(uint64_t frameId, double gpuBegin, double gpuEnd)
+{
+	PendingFrame& frame = mPending[frameId % PendingFrameCount];
+	if (!frame.valid || frame.id != frameId)
+		return;
+	frame.valid = false;
+
+	mQueueTime = std::max(gpuBegin - frame.submit, 0.0);
+	mFrameLatency = gpuEnd - frame.start;
+
+	mQueueWindow[mQueueNext] = mQueueTime;
+	mQueueNext = (mQueueNext + 1) % QueueWindowSize;
+	mQueueCount = std::min(mQueueCount + 1, QueueWindowSize);
+
+	if (!mSettings.lowLatency)
+		return;
+
+	// The smallest recent queue time is what can be given up safely. Feedback arrives frames late,
+	// growing the delay slowly keeps it from overshooting into a starved GPU.
+	const double minQueueTime = *std::min_element(mQueueWindow, mQueueWindow + mQueueCount);
+	const double excess = minQueueTime - mSettings.latencyMargin;
+	mLatencyDelay += excess > 0.0 ? excess * mSettings.latencyGain : excess;
+	mLatencyDelay = std::clamp(mLatencyDelay, 0.0, MaxLatencyDelay);
+}
+
+void FramePacer::Reset()
+{
+	for (PendingFrame& frame : mPending)
+	{
+		frame = { 0, 0.0, 0.0, false };
+	}
+
+	mHasDeadline = false;
+	mNextDeadline = 0.0;
+	mQueueCount = 0;
+	mQueueNext = 0;
+	mLatencyDelay = 0.0;
+	mQueueTime = 0.0;
+	mFrameLatency = 0.0;
+}
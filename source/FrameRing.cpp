@@ -0,0 +1,53 @@
+#include "FrameRing.h"
+
+FrameRing::FrameRing()
+	:
+	mpQueue(nullptr),
+	mFrameIndex(0),
+	mFenceValue(1),
+	mCompletedValue(0)
+{
+}
+
+void FrameRing::Init(FrameQueue* pQueue, uint32_t frameCount, uint32_t frameIndex)
+{
+	mpQueue = pQueue;
+	mSlotFenceValues.assign(frameCount, 0);
+	mFrameIndex = frameIndex;
+	mFenceValue = 1;
+	mCompletedValue = mpQueue->GetCompletedValue();
+}
+
+uint64_t FrameRing::MoveToNextFrame()
+{
+	return MoveToNextFrame((mFrameIndex + 1) % GetFrameCount());
+}
+
+uint64_t FrameRing::MoveToNextFrame(uint32_t nextFrameIndex)
+{
+	// Tag the frame just submitted so its slot is recycled only after the GPU is done with it
+	mSlotFenceValues[mFrameIndex] = mFenceValue;
+	mpQueue->Signal(mFenceValue);
+	mFenceValue++;
+
+	// Only blocks when the CPU is FrameCount frames ahead of the GPU
+	mFrameIndex = nextFrameIndex;
+	mCompletedValue = mpQueue->GetCompletedValue();
+	if (mCompletedValue < mSlotFenceValues[mFrameIndex])
+	{
+		mpQueue->Wait(mSlotFenceValues[mFrameIndex]);
+		mCompletedValue = mpQueue->GetCompletedValue();
+	}
+	return mCompletedValue;
+}
+
+uint64_t FrameRing::Flush()
+{
+	const uint64_t fenceValue = mFenceValue;
+	mpQueue->Signal(fenceValue);
+	mFenceValue++;
+
+	mpQueue->Wait(fenceValue);
+	mCompletedValue = mpQueue->GetCompletedValue();
+	return mCompletedValue;
+}
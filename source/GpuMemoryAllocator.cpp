@@ -0,0 +1,270 @@
+#include "GpuMemoryAllocator.h"
+#include "DXHelper.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+	UINT64 AlignUp(UINT64 value, UINT64 alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+ID3D12Heap* GpuAllocation::GetHeap() const
+{
+	return mpBlock->heap.Get();
+}
+
+UINT64 GpuAllocation::GetHeapOffset() const
+{
+	return mpBlock->allocator.GetOffset(mHandle);
+}
+
+UINT64 GpuAllocation::GetSize() const
+{
+	return mpBlock->allocator.GetSize(mHandle);
+}
+
+void GpuMemoryAllocator::Init(ID3D12Device* pDevice, UINT64 blockSize)
+{
+	mDevice = pDevice;
+	mBlockSize = blockSize;
+}
+
+GpuAllocation* GpuMemoryAllocator::CreateResource(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc,
+	D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* pClearValue)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	const ResourceCategory category = GetCategory(desc);
+	D3D12_RESOURCE_DESC placedDesc = desc;
+	D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = {};
+
+	// Small textures may be placed on 4KB boundaries, the runtime tells us whether this one qualifies
+	if (category == ResourceCategory::Texture && desc.SampleDesc.Count <= 1)
+	{
+		placedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+		allocationInfo = mDevice->GetResourceAllocationInfo(0, 1, &placedDesc);
+		if (allocationInfo.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+		{
+			placedDesc.Alignment = 0;
+			allocationInfo = mDevice->GetResourceAllocationInfo(0, 1, &placedDesc);
+		}
+	}
+	else
+	{
+		placedDesc.Alignment = 0;
+		allocationInfo = mDevice->GetResourceAllocationInfo(0, 1, &placedDesc);
+	}
+
+	if (allocationInfo.SizeInBytes == UINT64_MAX)
+		ThrowIfFailed(E_INVALIDARG);
+
+	Pool& pool = GetPool(heapType, category);
+	HeapBlock* pBlock = nullptr;
+	TlsfAllocator::Handle handle = TlsfAllocator::InvalidHandle;
+
+	for (std::unique_ptr<HeapBlock>& block : pool.blocks)
+	{
+		handle = block->allocator.Allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment);
+		if (handle != TlsfAllocator::InvalidHandle)
+		{
+			pBlock = block.get();
+			break;
+		}
+	}
+
+	// No room anywhere, resources bigger than a block get a heap of their own size
+	if (pBlock == nullptr)
+	{
+		pBlock = CreateBlock(pool, max(mBlockSize, allocationInfo.SizeInBytes), allocationInfo.Alignment);
+		handle = pBlock->allocator.Allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment);
+		if (handle == TlsfAllocator::InvalidHandle)
+			ThrowIfFailed(E_OUTOFMEMORY);
+	}
+
+	auto allocation = std::make_unique<GpuAllocation>();
+	allocation->mpBlock = pBlock;
+	allocation->mHandle = handle;
+
+	ThrowIfFailed(mDevice->CreatePlacedResource(
+		pBlock->heap.Get(),
+		pBlock->allocator.GetOffset(handle),
+		&placedDesc,
+		initialState,
+		pClearValue,
+		IID_PPV_ARGS(&allocation->mResource)));
+
+	mAllocations.push_back(std::move(allocation));
+	return mAllocations.back().get();
+}
+
+void GpuMemoryAllocator::Release(GpuAllocation* pAllocation)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	pAllocation->mpBlock->allocator.Free(pAllocation->mHandle);
+
+	auto it = std::find_if(mAllocations.begin(), mAllocations.end(),
+		[pAllocation](const std::unique_ptr<GpuAllocation>& allocation) { return allocation.get() == pAllocation; });
+	if (it != mAllocations.end())
+	{
+		std::swap(*it, mAllocations.back());
+		mAllocations.pop_back();
+	}
+}
+
+GpuMemoryAllocator::Stats GpuMemoryAllocator::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	Stats stats = {};
+	for (const Pool& pool : mPools)
+	{
+		for (const std::unique_ptr<HeapBlock>& block : pool.blocks)
+		{
+			const TlsfAllocator::Stats blockStats = block->allocator.GetStats();
+			stats.blockCount++;
+			stats.reservedSize += blockStats.size;
+			stats.usedSize += blockStats.usedSize;
+			stats.allocationCount += blockStats.allocationCount;
+			stats.fragmentation = max(stats.fragmentation, blockStats.fragmentation);
+		}
+	}
+	return stats;
+}
+
+std::vector<GpuAllocation*> GpuMemoryAllocator::Defragment(ID3D12GraphicsCommandList* pCommandList, UINT maxMoves, UINT64 fenceValue)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::vector<GpuAllocation*> movedAllocations;
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	std::vector<TlsfAllocator::Move> moves;
+
+	for (Pool& pool : mPools)
+	{
+		for (std::unique_ptr<HeapBlock>& block : pool.blocks)
+		{
+			if (movedAllocations.size() >= maxMoves)
+				break;
+
+			// Sources of earlier moves the GPU may still be copying from have no owner, they go away on Retire
+			std::unordered_map<TlsfAllocator::Handle, GpuAllocation*> owners;
+			for (const std::unique_ptr<GpuAllocation>& allocation : mAllocations)
+			{
+				if (allocation->mpBlock == block.get())
+					owners.emplace(allocation->mHandle, allocation.get());
+			}
+
+			moves.clear();
+			block->allocator.Defragment(maxMoves - static_cast<UINT>(movedAllocations.size()), moves,
+				[&owners](TlsfAllocator::Handle handle) { return owners.count(handle) != 0; });
+
+			for (const TlsfAllocator::Move& move : moves)
+			{
+				GpuAllocation* pAllocation = owners[move.source];
+
+				const D3D12_RESOURCE_DESC desc = pAllocation->mResource->GetDesc();
+				const bool isBuffer = desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER;
+
+				ComPtr<ID3D12Resource> resource;
+				ThrowIfFailed(mDevice->CreatePlacedResource(
+					block->heap.Get(),
+					move.destinationOffset,
+					&desc,
+					isBuffer ? D3D12_RESOURCE_STATE_COMMON : D3D12_RESOURCE_STATE_COPY_DEST,
+					nullptr,
+					IID_PPV_ARGS(&resource)));
+
+				// Source is promoted from COMMON to COPY_SOURCE, buffers are promoted to COPY_DEST as well
+				pCommandList->CopyResource(resource.Get(), pAllocation->mResource.Get());
+				if (!isBuffer)
+				{
+					barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COMMON));
+				}
+
+				mPendingFrees.push_back({ block.get(), move.source, pAllocation->mResource, fenceValue });
+				pAllocation->mResource = resource;
+				pAllocation->mHandle = move.destination;
+				movedAllocations.push_back(pAllocation);
+			}
+		}
+	}
+
+	if (!barriers.empty())
+		pCommandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+
+	return movedAllocations;
+}
+
+void GpuMemoryAllocator::Retire(UINT64 completedFenceValue)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto it = std::remove_if(mPendingFrees.begin(), mPendingFrees.end(), [&](PendingFree& pending)
+	{
+		if (pending.fenceValue > completedFenceValue)
+			return false;
+
+		pending.pBlock->allocator.Free(pending.handle);
+		return true;
+	});
+	mPendingFrees.erase(it, mPendingFrees.end());
+}
+
+GpuMemoryAllocator::ResourceCategory GpuMemoryAllocator::GetCategory(const D3D12_RESOURCE_DESC& desc)
+{
+	if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+		return ResourceCategory::Buffer;
+
+	if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+		return ResourceCategory::RenderTargetTexture;
+
+	return ResourceCategory::Texture;
+}
+
+D3D12_HEAP_FLAGS GpuMemoryAllocator::GetHeapFlags(ResourceCategory category)
+{
+	switch (category)
+	{
+	case ResourceCategory::Buffer:
+		return D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+	case ResourceCategory::Texture:
+		return D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+	default:
+		return D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+	}
+}
+
+GpuMemoryAllocator::Pool& GpuMemoryAllocator::GetPool(D3D12_HEAP_TYPE heapType, ResourceCategory category)
+{
+	for (Pool& pool : mPools)
+	{
+		if (pool.heapType == heapType && pool.category == category)
+			return pool;
+	}
+
+	mPools.push_back({ heapType, category, {} });
+	return mPools.back();
+}
+
+HeapBlock* GpuMemoryAllocator::CreateBlock(Pool& pool, UINT64 size, UINT64 alignment)
+{
+	// Render targets may be multisampled and need 4MB placement, everything else fits in 64KB
+	const UINT64 heapAlignment = max(alignment, pool.category == ResourceCategory::RenderTargetTexture
+		? static_cast<UINT64>(D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT)
+		: static_cast<UINT64>(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT));
+	size = AlignUp(size, heapAlignment);
+
+	CD3DX12_HEAP_DESC heapDesc(size, pool.heapType, heapAlignment, GetHeapFlags(pool.category));
+
+	auto block = std::make_unique<HeapBlock>();
+	ThrowIfFailed(mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(&block->heap)));
+	block->allocator.Reset(size);
+
+	pool.blocks.push_back(std::move(block));
+	return pool.blocks.back().get();
+}
@@ -0,0 +1,147 @@
+#include "GpuProfiler.h"
+#include "DXHelper.h"
+
+void GpuProfiler::Init(ID3D12Device* pDevice, ID3D12CommandQueue* pQueue, UINT frameCount, UINT maxScopesPerFrame)
+{
+	mFrameCount = frameCount;
+	mMaxScopes = maxScopesPerFrame;
+	const UINT queryCount = frameCount * maxScopesPerFrame * 2;
+
+	D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+	queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	queryHeapDesc.Count = queryCount;
+	ThrowIfFailed(pDevice->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&mQueryHeap)));
+
+	const CD3DX12_HEAP_PROPERTIES readbackHeap(D3D12_HEAP_TYPE_READBACK);
+	const CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(static_cast<UINT64>(queryCount) * sizeof(UINT64));
+	ThrowIfFailed(pDevice->CreateCommittedResource(&readbackHeap, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+		D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&mReadback)));
+
+	// Persistently mapped, a slot is only read once its frame retired
+	void* pData = nullptr;
+	ThrowIfFailed(mReadback->Map(0, nullptr, &pData));
+	mpReadback = static_cast<const UINT64*>(pData);
+
+	mFrames = std::make_unique<Frame[]>(frameCount);
+	for (UINT i = 0; i < frameCount; i++)
+	{
+		mFrames[i].names = std::make_unique<const char*[]>(maxScopesPerFrame);
+		mFrames[i].scopeCount = 0;
+		mFrames[i].fenceValue = 0;
+		mFrames[i].pending = false;
+	}
+
+	ThrowIfFailed(pQueue->GetTimestampFrequency(&mTimestampFrequency));
+
+	UINT64 cpuTimestamp = 0;
+	LARGE_INTEGER cpuFrequency;
+	QueryPerformanceFrequency(&cpuFrequency);
+	ThrowIfFailed(pQueue->GetClockCalibration(&mCalibrationGpu, &cpuTimestamp));
+	mCalibrationMicroseconds = static_cast<double>(cpuTimestamp) * 1e6 / static_cast<double>(cpuFrequency.QuadPart);
+}
+
+void GpuProfiler::BeginFrame()
+{
+	mCurrentSlot = (mCurrentSlot + 1) % mFrameCount;
+	Frame& frame = mFrames[mCurrentSlot];
+
+	// The slot's previous frame hasn't been read yet, skip profiling this one rather than wait
+	mFrameActive = !frame.pending;
+	if (mFrameActive)
+		frame.scopeCount = 0;
+}
+
+UINT GpuProfiler::BeginScope(ID3D12GraphicsCommandList* pCommandList, const char* name)
+{
+	if (!mFrameActive)
+		return InvalidScope;
+
+	Frame& frame = mFrames[mCurrentSlot];
+	const UINT scope = frame.scopeCount.fetch_add(1);
+	if (scope >= mMaxScopes)
+		return InvalidScope;
+
+	frame.names[scope] = name;
+	pCommandList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, (mCurrentSlot * mMaxScopes + scope) * 2);
+	return scope;
+}
+
+void GpuProfiler::EndScope(ID3D12GraphicsCommandList* pCommandList, UINT scope)
+{
+	if (scope == InvalidScope)
+		return;
+
+	pCommandList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, (mCurrentSlot * mMaxScopes + scope) * 2 + 1);
+}
+
+void GpuProfiler::EndFrame(ID3D12GraphicsCommandList* pCommandList, UINT64 fenceValue)
+{
+	if (!mFrameActive)
+		return;
+
+	Frame& frame = mFrames[mCurrentSlot];
+	const UINT scopeCount = min(frame.scopeCount.load(), mMaxScopes);
+	frame.scopeCount = scopeCount;
+	frame.fenceValue = fenceValue;
+	frame.pending = true;
+	mFrameActive = false;
+
+	if (scopeCount == 0)
+		return;
+
+	const UINT firstQuery = mCurrentSlot * mMaxScopes * 2;
+	pCommandList->ResolveQueryData(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, firstQuery, scopeCount * 2,
+		mReadback.Get(), static_cast<UINT64>(firstQuery) * sizeof(UINT64));
+}
+
+void GpuProfiler::Retire(UINT64 completedFenceValue)
+{
+	for (UINT slot = 0; slot < mFrameCount; slot++)
+	{
+		Frame& frame = mFrames[slot];
+		if (frame.pending && frame.fenceValue <= completedFenceValue)
+		{
+			ReadFrame(frame, slot);
+			frame.pending = false;
+		}
+	}
+}
+
+void GpuProfiler::SetTraceWriter(ChromeTraceWriter* pWriter, uint32_t processId)
+{
+	mpTraceWriter = pWriter;
+	mTraceProcessId = processId;
+	if (mpTraceWriter)
+	{
+		mpTraceWriter->SetProcessName(processId, "GPU");
+		mpTraceWriter->SetThreadName(processId, 0, "Direct queue");
+	}
+}
+
+void GpuProfiler::ReadFrame(Frame& frame, UINT slot)
+{
+	const UINT scopeCount = frame.scopeCount;
+	if (scopeCount == 0)
+		return;
+
+	const UINT64* pTimestamps = mpReadback + static_cast<size_t>(slot) * mMaxScopes * 2;
+	mEvents.clear();
+	for (UINT i = 0; i < scopeCount; i++)
+	{
+		mEvents.push_back({ frame.names[i], pTimestamps[i * 2], pTimestamps[i * 2 + 1] });
+	}
+
+	ProfileTree::Build(mEvents.data(), mEvents.size(), mNodes);
+	mStats.AddFrame(mNodes, mTimestampFrequency);
+	if (mFrameListener)
+		mFrameListener(mNodes, frame.fenceValue);
+
+	if (mpTraceWriter)
+	{
+		const double microsecondsPerTick = 1e6 / static_cast<double>(mTimestampFrequency);
+		for (const ProfileNode& node : mNodes)
+		{
+			mpTraceWriter->AddCompleteEvent(node.name, "gpu", mTraceProcessId, 0, GetCpuMicroseconds(node.begin), static_cast<double>(node.end - node.begin) * microsecondsPerTick);
+		}
+	}
+}
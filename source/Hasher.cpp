@@ -0,0 +1,23 @@
+#include "Hasher.h"
+
+void Hasher::Add(const void* pData, size_t size)
+{
+	const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+	for (size_t n = 0; n < size; n++)
+	{
+		mHash ^= pBytes[n];
+		mHash *= Prime;
+	}
+}
+
+void Hasher::AddString(const char* pString)
+{
+	if (pString == nullptr)
+	{
+		AddValue(static_cast<uint8_t>(0xff));
+		return;
+	}
+
+	// Terminator included so consecutive strings can't run into each other
+	Add(pString, strlen(pString) + 1);
+}
@@ -0,0 +1,53 @@
+#include "HeadlessCtx.h"
+#include "DXRenderer.h"
+
+#include <cstdio>
+
+namespace
+{
+	// Stats go to the console, the loop ends when the renderer asks to quit
+	class ConsoleHost : public FrameHost
+	{
+	public:
+		explicit ConsoleHost(const std::wstring& title) : mTitle(title), mQuitRequested(false) {}
+
+		void SetStatusText(const std::string& text) override
+		{
+			printf("%ls: %s\n", mTitle.c_str(), text.c_str());
+		}
+
+		void RequestQuit() override
+		{
+			mQuitRequested = true;
+		}
+
+		bool IsQuitRequested() const { return mQuitRequested; }
+
+	private:
+		std::wstring mTitle;
+		bool mQuitRequested;
+	};
+}
+
+int HeadlessCtx::Run(DXRenderer* pRenderer)
+{
+	// WinMain has no console of its own, borrow the launching one so stats reach the terminal
+	if (AttachConsole(ATTACH_PARENT_PROCESS))
+	{
+		FILE* pStream = nullptr;
+		freopen_s(&pStream, "CONOUT$", "w", stdout);
+	}
+
+	ConsoleHost host(pRenderer->GetTitle());
+	pRenderer->OnInit(&host, nullptr);
+
+	while (!host.IsQuitRequested())
+	{
+		PROFILE_FRAME();
+		pRenderer->RunFrame();
+	}
+
+	pRenderer->OnDestroy();
+
+	return 0;
+}
@@ -0,0 +1,49 @@
+#include "IndexFreeList.h"
+
+IndexFreeList::IndexFreeList(uint32_t capacity)
+	:
+	mHead(Pack(0, InvalidIndex)),
+	mCapacity(0)
+{
+	Reset(capacity);
+}
+
+void IndexFreeList::Reset(uint32_t capacity)
+{
+	mCapacity = capacity;
+	mNext.reset(capacity > 0 ? new std::atomic<uint32_t>[capacity] : nullptr);
+
+	// Chain every index in ascending order
+	for (uint32_t n = 0; n < capacity; n++)
+	{
+		mNext[n].store(n + 1 < capacity ? n + 1 : InvalidIndex, std::memory_order_relaxed);
+	}
+	mHead.store(Pack(0, capacity > 0 ? 0 : InvalidIndex), std::memory_order_release);
+}
+
+uint32_t IndexFreeList::Allocate()
+{
+	uint64_t head = mHead.load(std::memory_order_acquire);
+	while (true)
+	{
+		const uint32_t index = Index(head);
+		if (index == InvalidIndex)
+			return InvalidIndex;
+
+		// May read a stale link if another thread popped the index meanwhile, the tag makes the exchange fail then
+		const uint32_t next = mNext[index].load(std::memory_order_relaxed);
+		if (mHead.compare_exchange_weak(head, Pack(Tag(head) + 1, next), std::memory_order_acquire, std::memory_order_acquire))
+			return index;
+	}
+}
+
+void IndexFreeList::Free(uint32_t index)
+{
+	uint64_t head = mHead.load(std::memory_order_relaxed);
+	while (true)
+	{
+		mNext[index].store(Index(head), std::memory_order_relaxed);
+		if (mHead.compare_exchange_weak(head, Pack(Tag(head) + 1, index), std::memory_order_release, std::memory_order_relaxed))
+			return;
+	}
+}
@@ -0,0 +1,208 @@
+#include "JobSystem.h"
+#include "CpuProfiler.h"
+
+#include <algorithm>
+
+namespace
+{
+	// The system the thread is working for and its index there, set for workers and for callers inside ParallelFor
+	struct ThreadSlot
+	{
+		const JobSystem* pJobSystem;
+		unsigned int threadIndex;
+	};
+
+	thread_local ThreadSlot tThreadSlot = { nullptr, 0 };
+}
+
+JobSystem::JobSystem(unsigned int workerCount, unsigned int callerCount)
+	:
+	mQueuedJobs(0),
+	mShutdown(false),
+	mCallerSlots(0)
+{
+	if (workerCount == 0)
+	{
+		const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	// Caller slots come after the workers
+	callerCount = std::clamp(callerCount, 1u, MaxCallerCount);
+	for (unsigned int n = 0; n < workerCount + callerCount; n++)
+	{
+		mQueues.push_back(std::make_unique<WorkerQueue>());
+	}
+
+	for (unsigned int n = 0; n < workerCount; n++)
+	{
+		mWorkers.emplace_back(&JobSystem::WorkerMain, this, n);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mShutdown = true;
+	}
+	mWakeCondition.notify_all();
+
+	for (std::thread& worker : mWorkers)
+	{
+		worker.join();
+	}
+}
+
+void JobSystem::ParallelFor(unsigned int count, const std::function<void(unsigned int index, unsigned int threadIndex)>& func)
+{
+	if (count == 0)
+		return;
+
+	// Workers and callers already inside this system keep their index, everyone else claims a caller slot
+	const ThreadSlot previousSlot = tThreadSlot;
+	const bool nested = previousSlot.pJobSystem == this;
+	const unsigned int callerIndex = nested ? previousSlot.threadIndex : ClaimCallerSlot();
+	tThreadSlot = { this, callerIndex };
+
+	std::atomic<unsigned int> remaining(count);
+	std::mutex exceptionMutex;
+	std::exception_ptr firstException;
+
+	// Spread the indices round robin so every worker starts with local work, the caller's share goes to its own queue
+	const unsigned int queueCount = GetWorkerCount() + 1;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const unsigned int queueIndex = i % queueCount;
+		Push(queueIndex == GetWorkerCount() ? callerIndex : queueIndex,
+			[&func, &remaining, &exceptionMutex, &firstException, i](unsigned int threadIndex)
+		{
+			try
+			{
+				func(i, threadIndex);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(exceptionMutex);
+				if (!firstException)
+					firstException = std::current_exception();
+			}
+			remaining.fetch_sub(1, std::memory_order_release);
+		});
+	}
+
+	// Help instead of blocking, the caller's queue may also be stolen from
+	while (remaining.load(std::memory_order_acquire) > 0)
+	{
+		Job job;
+		if (TryGetJob(callerIndex, job))
+		{
+			job(callerIndex);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	tThreadSlot = previousSlot;
+	if (!nested)
+		ReleaseCallerSlot(callerIndex);
+
+	// Surface worker failures on the calling thread
+	if (firstException)
+		std::rethrow_exception(firstException);
+}
+
+void JobSystem::Push(unsigned int queueIndex, Job job)
+{
+	// Count the job before it can be popped, otherwise TryGetJob's decrement could wrap the counter
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mQueuedJobs.fetch_add(1);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mQueues[queueIndex]->mutex);
+		mQueues[queueIndex]->jobs.push_back(std::move(job));
+	}
+	mWakeCondition.notify_one();
+}
+
+bool JobSystem::TryGetJob(unsigned int threadIndex, Job& job)
+{
+	// Own queue first, newest job is the most likely to be cache warm
+	{
+		WorkerQueue& queue = *mQueues[threadIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			mQueuedJobs.fetch_sub(1);
+			return true;
+		}
+	}
+
+	// Steal the oldest job from the other queues
+	const unsigned int queueCount = static_cast<unsigned int>(mQueues.size());
+	for (unsigned int n = 1; n < queueCount; n++)
+	{
+		WorkerQueue& queue = *mQueues[(threadIndex + n) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			mQueuedJobs.fetch_sub(1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::WorkerMain(unsigned int threadIndex)
+{
+	tThreadSlot = { this, threadIndex };
+	if (CpuProfiler::IsEnabled())
+		CpuProfiler::SetThreadName("Job worker");
+
+	while (true)
+	{
+		Job job;
+		if (TryGetJob(threadIndex, job))
+		{
+			job(threadIndex);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mWakeCondition.wait(lock, [this] { return mShutdown || mQueuedJobs.load() > 0; });
+		if (mShutdown && mQueuedJobs.load() == 0)
+			return;
+	}
+}
+
+unsigned int JobSystem::ClaimCallerSlot()
+{
+	const unsigned int callerCount = GetThreadCount() - GetWorkerCount();
+	while (true)
+	{
+		uint64_t slots = mCallerSlots.load(std::memory_order_relaxed);
+		for (unsigned int n = 0; n < callerCount; n++)
+		{
+			const uint64_t bit = 1ull << n;
+			if ((slots & bit) == 0 && mCallerSlots.compare_exchange_weak(slots, slots | bit, std::memory_order_acquire))
+				return GetWorkerCount() + n;
+		}
+
+		// Every slot is busy, their ParallelFor calls only need the workers to finish
+		std::this_thread::yield();
+	}
+}
+
+void JobSystem::ReleaseCallerSlot(unsigned int threadIndex)
+{
+	mCallerSlots.fetch_and(~(1ull << (threadIndex - GetWorkerCount())), std::memory_order_release);
+}
@@ -0,0 +1,56 @@
+#include "LinearArena.h"
+
+#include <algorithm>
+
+LinearArena::LinearArena(size_t blockSize)
+	:
+	mBlockSize(blockSize),
+	mCurrentBlock(0),
+	mOffset(0)
+{
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment)
+{
+	for (; mCurrentBlock < mBlocks.size(); mCurrentBlock++, mOffset = 0)
+	{
+		Block& block = mBlocks[mCurrentBlock];
+		const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+		const size_t offset = static_cast<size_t>(((base + mOffset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base);
+		if (offset <= block.size && size <= block.size - offset)
+		{
+			mOffset = offset + size;
+			return block.data.get() + offset;
+		}
+	}
+
+	// new[] is aligned for any fundamental type, larger alignments get slack
+	const size_t blockSize = std::max(mBlockSize, size + alignment);
+	mBlocks.push_back({ std::make_unique<uint8_t[]>(blockSize), blockSize });
+	mCurrentBlock = mBlocks.size() - 1;
+	mOffset = 0;
+	return Allocate(size, alignment);
+}
+
+void LinearArena::Reset()
+{
+	if (mBlocks.size() > 1)
+	{
+		const size_t capacity = GetCapacity();
+		mBlocks.clear();
+		mBlocks.push_back({ std::make_unique<uint8_t[]>(capacity), capacity });
+	}
+
+	mCurrentBlock = 0;
+	mOffset = 0;
+}
+
+size_t LinearArena::GetCapacity() const
+{
+	size_t capacity = 0;
+	for (const Block& block : mBlocks)
+	{
+		capacity += block.size;
+	}
+	return capacity;
+}
@@ -0,0 +1,352 @@
+#include "MipGenerator.h"
+#include "MipGeneratorKernels.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define MIP_GENERATOR_X64 1
+#endif
+
+namespace
+{
+	const double Pi = 3.14159265358979323846;
+
+	// Filter supports in destination pixels
+	const double KaiserRadius = 3.0;
+	const double KaiserAlpha = 4.0;
+	const double LanczosRadius = 3.0;
+
+	double Sinc(double x)
+	{
+		return x == 0.0 ? 1.0 : std::sin(Pi * x) / (Pi * x);
+	}
+
+	// Modified Bessel function of the first kind, order zero
+	double BesselI0(double x)
+	{
+		double sum = 1.0;
+		double term = 1.0;
+		for (int k = 1; k < 32; k++)
+		{
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+		}
+		return sum;
+	}
+
+	double GetFilterRadius(MipFilter filter)
+	{
+		switch (filter)
+		{
+		case MipFilter::Kaiser: return KaiserRadius;
+		case MipFilter::Lanczos: return LanczosRadius;
+		default: return 0.5;
+		}
+	}
+
+	double EvaluateFilter(MipFilter filter, double x)
+	{
+		x = std::abs(x);
+		switch (filter)
+		{
+		case MipFilter::Kaiser:
+		{
+			if (x >= KaiserRadius)
+				return 0.0;
+			const double t = x / KaiserRadius;
+			return Sinc(x) * BesselI0(KaiserAlpha * std::sqrt(1.0 - t * t)) / BesselI0(KaiserAlpha);
+		}
+		case MipFilter::Lanczos:
+			return x >= LanczosRadius ? 0.0 : Sinc(x) * Sinc(x / LanczosRadius);
+		default:
+			return x < 0.5 ? 1.0 : (x == 0.5 ? 0.5 : 0.0);
+		}
+	}
+
+	// Source taps of every destination pixel along one axis, padded with zero weights to the same count
+	struct TapTable
+	{
+		uint32_t tapCount = 0;
+		std::vector<uint32_t> indices;
+		std::vector<float> weights;
+
+		MipTaps Get(uint32_t dest) const { return { tapCount, indices.data() + dest * tapCount, weights.data() + dest * tapCount }; }
+
+		void Init(uint32_t sourceSize, uint32_t destSize, MipFilter filter)
+		{
+			const double scale = static_cast<double>(sourceSize) / destSize;
+			const double support = GetFilterRadius(filter) * scale;
+			const auto getFirst = [&](uint32_t d) { return static_cast<int64_t>(std::ceil((d + 0.5) * scale - support - 0.5)); };
+			const auto getLast = [&](uint32_t d) { return static_cast<int64_t>(std::floor((d + 0.5) * scale + support - 0.5)); };
+
+			tapCount = 1;
+			for (uint32_t d = 0; d < destSize; d++)
+			{
+				tapCount = std::max(tapCount, static_cast<uint32_t>(getLast(d) - getFirst(d) + 1));
+			}
+
+			indices.assign(destSize * tapCount, 0);
+			weights.assign(destSize * tapCount, 0.0f);
+			for (uint32_t d = 0; d < destSize; d++)
+			{
+				const double center = (d + 0.5) * scale;
+				const int64_t first = getFirst(d);
+				const int64_t last = getLast(d);
+
+				double sum = 0.0;
+				for (int64_t s = first; s <= last; s++)
+				{
+					sum += EvaluateFilter(filter, (s + 0.5 - center) / scale);
+				}
+
+				for (int64_t s = first; s <= last; s++)
+				{
+					const uint32_t tap = d * tapCount + static_cast<uint32_t>(s - first);
+					// Edges repeat the border pixel
+					indices[tap] = static_cast<uint32_t>(std::clamp<int64_t>(s, 0, sourceSize - 1));
+					weights[tap] = static_cast<float>(EvaluateFilter(filter, (s + 0.5 - center) / scale) / sum);
+				}
+				for (uint32_t k = static_cast<uint32_t>(last - first + 1); k < tapCount; k++)
+				{
+					indices[d * tapCount + k] = indices[d * tapCount];
+				}
+			}
+		}
+	};
+
+	float SrgbToLinear(float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	float LinearToSrgb(float value)
+	{
+		return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	}
+
+	struct DecodeTable
+	{
+		// 256 colour entries followed by 256 alpha entries
+		float values[512];
+
+		explicit DecodeTable(bool srgb)
+		{
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				values[i] = srgb ? SrgbToLinear(i / 255.0f) : i / 255.0f;
+				values[256 + i] = i / 255.0f;
+			}
+		}
+	};
+
+	struct EncodeTable
+	{
+		// Linear colour scaled to [0, 65535], padded for four byte gathers
+		uint8_t values[65536 + 4];
+
+		EncodeTable()
+		{
+			for (uint32_t i = 0; i < 65536; i++)
+			{
+				values[i] = static_cast<uint8_t>(LinearToSrgb(i / 65535.0f) * 255.0f + 0.5f);
+			}
+			std::fill(values + 65536, values + 65536 + 4, values[65535]);
+		}
+	};
+
+	void DecodeRowScalar(const uint8_t* pSource, uint32_t width, const float* pDecodeTable, float* pDest)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				pDest[x * 4 + c] = pDecodeTable[pSource[x * 4 + c] + (c == 3 ? 256 : 0)];
+			}
+		}
+	}
+
+	void FilterRowScalar(const float* pSource, const MipTaps& taps, uint32_t destWidth, float* pDest)
+	{
+		for (uint32_t x = 0; x < destWidth; x++)
+		{
+			float sum[4] = {};
+			for (uint32_t k = 0; k < taps.tapCount; k++)
+			{
+				const float* pPixel = pSource + taps.pIndices[x * taps.tapCount + k] * 4;
+				const float weight = taps.pWeights[x * taps.tapCount + k];
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					sum[c] += pPixel[c] * weight;
+				}
+			}
+			std::copy(sum, sum + 4, pDest + x * 4);
+		}
+	}
+
+	void FilterColumnsScalar(const float* const* ppRows, const float* pWeights, uint32_t tapCount, uint32_t floatCount, float* pDest)
+	{
+		for (uint32_t x = 0; x < floatCount; x++)
+		{
+			float sum = 0.0f;
+			for (uint32_t k = 0; k < tapCount; k++)
+			{
+				sum += ppRows[k][x] * pWeights[k];
+			}
+			pDest[x] = sum;
+		}
+	}
+
+	void EncodeRowScalar(const float* pSource, uint32_t width, const uint8_t* pEncodeTable, uint8_t* pDest)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				const float value = std::clamp(pSource[x * 4 + c], 0.0f, 1.0f);
+				if (c < 3 && pEncodeTable)
+					pDest[x * 4 + c] = pEncodeTable[static_cast<uint32_t>(value * 65535.0f + 0.5f)];
+				else
+					pDest[x * 4 + c] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+			}
+		}
+	}
+
+	struct Kernels
+	{
+		decltype(&DecodeRowScalar) decodeRow;
+		decltype(&FilterRowScalar) filterRow;
+		decltype(&FilterColumnsScalar) filterColumns;
+		decltype(&EncodeRowScalar) encodeRow;
+	};
+
+	Kernels GetKernels(bool allowAvx2)
+	{
+#ifdef MIP_GENERATOR_X64
+		if (allowAvx2 && CpuFeatures::HasAvx2())
+			return { DecodeRowAvx2, FilterRowAvx2, FilterColumnsAvx2, EncodeRowAvx2 };
+#endif
+		(void)allowAvx2;
+		return { DecodeRowScalar, FilterRowScalar, FilterColumnsScalar, EncodeRowScalar };
+	}
+
+	struct LevelPass
+	{
+		const MipChain::Level* pSource;
+		const MipChain::Level* pDest;
+		TapTable columns;
+		TapTable rows;
+		const float* pDecodeTable;
+		const uint8_t* pEncodeTable;
+		Kernels kernels;
+
+		// Decodes and horizontally filters the source rows a band reads, then filters them vertically
+		void FilterBand(uint32_t firstRow, uint32_t rowCount) const
+		{
+			const MipTaps firstTaps = rows.Get(firstRow);
+			const MipTaps lastTaps = rows.Get(firstRow + rowCount - 1);
+			const uint32_t firstSource = *std::min_element(firstTaps.pIndices, firstTaps.pIndices + rows.tapCount);
+			const uint32_t lastSource = *std::max_element(lastTaps.pIndices, lastTaps.pIndices + rows.tapCount);
+
+			const uint32_t destFloats = pDest->width * 4;
+			std::vector<float> decoded(pSource->width * 4);
+			std::vector<float> filtered((lastSource - firstSource + 1) * destFloats);
+			for (uint32_t y = firstSource; y <= lastSource; y++)
+			{
+				kernels.decodeRow(pSource->pData + y * pSource->rowPitch, pSource->width, pDecodeTable, decoded.data());
+				kernels.filterRow(decoded.data(), columns.Get(0), pDest->width, filtered.data() + (y - firstSource) * destFloats);
+			}
+
+			std::vector<const float*> tapRows(rows.tapCount);
+			std::vector<float> result(destFloats);
+			for (uint32_t y = firstRow; y < firstRow + rowCount; y++)
+			{
+				const MipTaps taps = rows.Get(y);
+				for (uint32_t k = 0; k < taps.tapCount; k++)
+				{
+					tapRows[k] = filtered.data() + (taps.pIndices[k] - firstSource) * destFloats;
+				}
+				kernels.filterColumns(tapRows.data(), taps.pWeights, taps.tapCount, destFloats, result.data());
+				kernels.encodeRow(result.data(), pDest->width, pEncodeTable, pDest->pData + y * pDest->rowPitch);
+			}
+		}
+	};
+}
+
+void MipChain::Init(uint32_t width, uint32_t height, uint32_t levelCount)
+{
+	if (levelCount == 0)
+		levelCount = GetFullLevelCount(width, height);
+
+	mLevels.resize(levelCount);
+	mSize = 0;
+	for (Level& level : mLevels)
+	{
+		level.width = width;
+		level.height = height;
+		level.rowPitch = width * 4ull;
+		mSize += level.rowPitch * height;
+
+		width = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+	}
+
+	mData.reset(new uint8_t[mSize]);
+	uint8_t* pData = mData.get();
+	for (Level& level : mLevels)
+	{
+		level.pData = pData;
+		pData += level.rowPitch * level.height;
+	}
+}
+
+uint32_t MipChain::GetFullLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t levelCount = 1;
+	for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+	{
+		levelCount++;
+	}
+	return levelCount;
+}
+
+void MipGenerator::Generate(MipChain& chain, const Settings& settings, JobSystem* pJobSystem)
+{
+	static const EncodeTable encodeTable;
+	const DecodeTable decodeTable(settings.srgb);
+
+	for (uint32_t level = 1; level < chain.GetLevelCount(); level++)
+	{
+		LevelPass pass;
+		pass.pSource = &chain.GetLevel(level - 1);
+		pass.pDest = &chain.GetLevel(level);
+		pass.columns.Init(pass.pSource->width, pass.pDest->width, settings.filter);
+		pass.rows.Init(pass.pSource->height, pass.pDest->height, settings.filter);
+		pass.pDecodeTable = decodeTable.values;
+		pass.pEncodeTable = settings.srgb ? encodeTable.values : nullptr;
+		pass.kernels = GetKernels(settings.allowAvx2);
+
+		// Each level reads the one before it, so only the bands of a level run in parallel.
+		// Bands also bound the filtered rows held in memory when running serially.
+		const uint32_t height = pass.pDest->height;
+		const uint32_t jobCount = (height + RowsPerJob - 1) / RowsPerJob;
+		const auto filterBand = [&](unsigned int job, unsigned int)
+		{
+			const uint32_t firstRow = job * RowsPerJob;
+			pass.FilterBand(firstRow, std::min(RowsPerJob, height - firstRow));
+		};
+
+		if (!pJobSystem || jobCount <= 1)
+		{
+			for (uint32_t job = 0; job < jobCount; job++)
+			{
+				filterBand(job, 0);
+			}
+			continue;
+		}
+
+		pJobSystem->ParallelFor(jobCount, filterBand);
+	}
+}
@@ -0,0 +1,126 @@
+#include "MipGeneratorKernels.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+// Built with AVX2 code generation, only called once the CPU reported support for it
+
+void DecodeRowAvx2(const uint8_t* pSource, uint32_t width, const float* pDecodeTable, float* pDest)
+{
+	// Alpha bytes index the second half of the table
+	const __m256i alphaOffset = _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256);
+
+	uint32_t x = 0;
+	for (; x + 2 <= width; x += 2)
+	{
+		const __m256i bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSource + x * 4)));
+		_mm256_storeu_ps(pDest + x * 4, _mm256_i32gather_ps(pDecodeTable, _mm256_add_epi32(bytes, alphaOffset), 4));
+	}
+	for (; x < width; x++)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			pDest[x * 4 + c] = pDecodeTable[pSource[x * 4 + c] + (c == 3 ? 256 : 0)];
+		}
+	}
+}
+
+void FilterRowAvx2(const float* pSource, const MipTaps& taps, uint32_t destWidth, float* pDest)
+{
+	const uint32_t tapCount = taps.tapCount;
+
+	// Two destination pixels per register
+	uint32_t x = 0;
+	for (; x + 2 <= destWidth; x += 2)
+	{
+		const uint32_t* pIndices0 = taps.pIndices + x * tapCount;
+		const uint32_t* pIndices1 = pIndices0 + tapCount;
+		const float* pWeights0 = taps.pWeights + x * tapCount;
+		const float* pWeights1 = pWeights0 + tapCount;
+
+		__m256 sum = _mm256_setzero_ps();
+		for (uint32_t k = 0; k < tapCount; k++)
+		{
+			const __m256 pixels = _mm256_set_m128(_mm_loadu_ps(pSource + pIndices1[k] * 4), _mm_loadu_ps(pSource + pIndices0[k] * 4));
+			const __m256 weights = _mm256_set_m128(_mm_set1_ps(pWeights1[k]), _mm_set1_ps(pWeights0[k]));
+			sum = _mm256_fmadd_ps(pixels, weights, sum);
+		}
+		_mm256_storeu_ps(pDest + x * 4, sum);
+	}
+	for (; x < destWidth; x++)
+	{
+		__m128 sum = _mm_setzero_ps();
+		for (uint32_t k = 0; k < tapCount; k++)
+		{
+			const __m128 pixel = _mm_loadu_ps(pSource + taps.pIndices[x * tapCount + k] * 4);
+			sum = _mm_fmadd_ps(pixel, _mm_set1_ps(taps.pWeights[x * tapCount + k]), sum);
+		}
+		_mm_storeu_ps(pDest + x * 4, sum);
+	}
+}
+
+void FilterColumnsAvx2(const float* const* ppRows, const float* pWeights, uint32_t tapCount, uint32_t floatCount, float* pDest)
+{
+	uint32_t x = 0;
+	for (; x + 8 <= floatCount; x += 8)
+	{
+		__m256 sum = _mm256_setzero_ps();
+		for (uint32_t k = 0; k < tapCount; k++)
+		{
+			sum = _mm256_fmadd_ps(_mm256_loadu_ps(ppRows[k] + x), _mm256_set1_ps(pWeights[k]), sum);
+		}
+		_mm256_storeu_ps(pDest + x, sum);
+	}
+	for (; x < floatCount; x++)
+	{
+		float sum = 0.0f;
+		for (uint32_t k = 0; k < tapCount; k++)
+		{
+			sum += ppRows[k][x] * pWeights[k];
+		}
+		pDest[x] = sum;
+	}
+}
+
+void EncodeRowAvx2(const float* pSource, uint32_t width, const uint8_t* pEncodeTable, uint8_t* pDest)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	// Colour lanes go through the table, alpha lanes are scaled to 255
+	const __m256 alphaLanes = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1));
+	const __m256 tableScale = _mm256_blendv_ps(_mm256_set1_ps(pEncodeTable ? 65535.0f : 255.0f), _mm256_set1_ps(255.0f), alphaLanes);
+	const __m256i byteMask = _mm256_set1_epi32(0xFF);
+
+	uint32_t x = 0;
+	for (; x + 2 <= width; x += 2)
+	{
+		const __m256 clamped = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(pSource + x * 4), zero), one);
+		__m256i values = _mm256_cvttps_epi32(_mm256_fmadd_ps(clamped, tableScale, half));
+		if (pEncodeTable)
+		{
+			// The table is padded so four byte gathers stay inside it
+			const __m256i encoded = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(pEncodeTable), values, 1), byteMask);
+			values = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(encoded), _mm256_castsi256_ps(values), alphaLanes));
+		}
+
+		const __m256i words = _mm256_packus_epi32(values, values);
+		const __m256i bytes = _mm256_packus_epi16(words, words);
+		const __m128i pixels = _mm_unpacklo_epi32(_mm256_castsi256_si128(bytes), _mm256_extracti128_si256(bytes, 1));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(pDest + x * 4), pixels);
+	}
+	for (; x < width; x++)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			const float value = pSource[x * 4 + c] < 0.0f ? 0.0f : (pSource[x * 4 + c] > 1.0f ? 1.0f : pSource[x * 4 + c]);
+			if (c < 3 && pEncodeTable)
+				pDest[x * 4 + c] = pEncodeTable[static_cast<uint32_t>(value * 65535.0f + 0.5f)];
+			else
+				pDest[x * 4 + c] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+		}
+	}
+}
+
+#endif
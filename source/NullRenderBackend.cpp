@@ -0,0 +1,71 @@
+#include "NullRenderBackend.h"
+
+#include <algorithm>
+
+NullRenderBackend::NullRenderBackend(uint32_t frameCount, double cpuFrameTime, double gpuFrameTime)
+	:
+	mFrameCount(frameCount),
+	mCpuFrameTime(cpuFrameTime),
+	mGpuFrameTime(gpuFrameTime),
+	mGpuEnd(0.0),
+	mUpdatedValue(0),
+	mRetiredValue(0),
+	mRenderedFrameCount(0),
+	mErrorCount(0)
+{
+}
+
+void NullRenderBackend::SetFrameTimes(double cpuFrameTime, double gpuFrameTime)
+{
+	mCpuFrameTime = cpuFrameTime;
+	mGpuFrameTime = gpuFrameTime;
+}
+
+void NullRenderBackend::Wait(double milliseconds)
+{
+	mQueue.Advance(milliseconds);
+}
+
+void NullRenderBackend::Update(uint64_t fenceValue)
+{
+	if (fenceValue <= mUpdatedValue)
+		mErrorCount++;
+	mUpdatedValue = fenceValue;
+}
+
+void NullRenderBackend::Render(uint32_t frameIndex, uint64_t fenceValue)
+{
+	if (fenceValue != mUpdatedValue || frameIndex >= mFrameCount)
+		mErrorCount++;
+	// The slot's previous frame must have retired before it is recorded into again
+	for (const PendingFrame& pending : mPending)
+	{
+		if (pending.frameIndex == frameIndex)
+			mErrorCount++;
+	}
+
+	mQueue.Advance(mCpuFrameTime);
+
+	// Same schedule as the queue, an idle GPU starts on the work as soon as it arrives
+	const double begin = std::max(mGpuEnd, mQueue.GetTime());
+	mGpuEnd = begin + mGpuFrameTime;
+	mQueue.Execute(mGpuFrameTime);
+
+	mPending.push_back({ frameIndex, { fenceValue, begin, mGpuEnd } });
+	mRenderedFrameCount++;
+}
+
+uint32_t NullRenderBackend::Present(uint32_t frameIndex)
+{
+	return (frameIndex + 1) % mFrameCount;
+}
+
+void NullRenderBackend::Retire(uint64_t completedValue, std::vector<GpuFrame>& gpuFrames)
+{
+	while (!mPending.empty() && mPending.front().gpuFrame.fenceValue <= completedValue)
+	{
+		gpuFrames.push_back(mPending.front().gpuFrame);
+		mPending.pop_front();
+	}
+	mRetiredValue = std::max(mRetiredValue, completedValue);
+}
@@ -0,0 +1,205 @@
+#include "PipelineCache.h"
+#include "DXHelper.h"
+#include "Hasher.h"
+
+#include <fstream>
+
+namespace
+{
+	void AddBytecode(Hasher& hasher, const D3D12_SHADER_BYTECODE& bytecode)
+	{
+		hasher.AddValue(static_cast<UINT64>(bytecode.BytecodeLength));
+		if (bytecode.pShaderBytecode)
+			hasher.Add(bytecode.pShaderBytecode, bytecode.BytecodeLength);
+	}
+
+	void AddStencilOp(Hasher& hasher, const D3D12_DEPTH_STENCILOP_DESC& desc)
+	{
+		hasher.AddValue(desc.StencilFailOp);
+		hasher.AddValue(desc.StencilDepthFailOp);
+		hasher.AddValue(desc.StencilPassOp);
+		hasher.AddValue(desc.StencilFunc);
+	}
+}
+
+void PipelineCache::Init(ID3D12Device* pDevice, IDXGIAdapter* pAdapter, const std::wstring& path)
+{
+	mDevice = pDevice;
+	mPath = path;
+
+	DXGI_ADAPTER_DESC adapterDesc = {};
+	ThrowIfFailed(pAdapter->GetDesc(&adapterDesc));
+
+	// User mode driver version, zero when the adapter won't tell
+	LARGE_INTEGER driverVersion = {};
+	pAdapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion);
+
+	mIdentity.vendorId = adapterDesc.VendorId;
+	mIdentity.deviceId = adapterDesc.DeviceId;
+	mIdentity.subSysId = adapterDesc.SubSysId;
+	mIdentity.revision = adapterDesc.Revision;
+	mIdentity.driverVersion = static_cast<uint64_t>(driverVersion.QuadPart);
+
+	ComPtr<ID3D12Device1> device1;
+	if (FAILED(pDevice->QueryInterface(IID_PPV_ARGS(&device1))))
+		return;
+
+	std::ifstream file(mPath, std::ios::binary | std::ios::ate);
+	if (file)
+	{
+		mFileData.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		if (!file.read(reinterpret_cast<char*>(mFileData.data()), mFileData.size()))
+			mFileData.clear();
+	}
+
+	const uint8_t* pBlob = nullptr;
+	uint64_t blobSize = 0;
+	if (PipelineCacheFile::Read(mFileData, mIdentity, pBlob, blobSize) &&
+		SUCCEEDED(device1->CreatePipelineLibrary(pBlob, static_cast<SIZE_T>(blobSize), IID_PPV_ARGS(&mLibrary))))
+		return;
+
+	// No file, another adapter or driver (D3D12_ERROR_ADAPTER_NOT_FOUND, D3D12_ERROR_DRIVER_VERSION_MISMATCH) or a corrupt blob
+	mFileData.clear();
+	if (FAILED(device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&mLibrary))))
+		mLibrary.Reset();
+}
+
+ComPtr<ID3D12PipelineState> PipelineCache::CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT64 rootSignatureHash)
+{
+	ComPtr<ID3D12PipelineState> pipelineState;
+
+	if (!mLibrary)
+	{
+		ThrowIfFailed(mDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState)));
+		return pipelineState;
+	}
+
+	WCHAR name[17];
+	swprintf_s(name, L"%016llx", HashGraphicsPipelineDesc(desc, rootSignatureHash));
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (SUCCEEDED(mLibrary->LoadGraphicsPipeline(name, &desc, IID_PPV_ARGS(&pipelineState))))
+			return pipelineState;
+	}
+
+	// Compiled outside the lock so pipelines can be created from several threads
+	ThrowIfFailed(mDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState)));
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	// Fails when another thread stored the same pipeline first, which is fine
+	if (SUCCEEDED(mLibrary->StorePipeline(name, pipelineState.Get())))
+		mDirty = true;
+
+	return pipelineState;
+}
+
+void PipelineCache::Save()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if (!mLibrary || !mDirty)
+		return;
+
+	std::vector<uint8_t> blob(mLibrary->GetSerializedSize());
+	ThrowIfFailed(mLibrary->Serialize(blob.data(), blob.size()));
+
+	const std::vector<uint8_t> data = PipelineCacheFile::Write(mIdentity, blob.data(), blob.size());
+
+	// Written aside and moved over the old file, an interrupted save never leaves a torn cache.
+	// Failing to write is not an error, the next run just compiles again.
+	const std::wstring tempPath = mPath + L".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.write(reinterpret_cast<const char*>(data.data()), data.size()))
+			return;
+	}
+
+	if (MoveFileExW(tempPath.c_str(), mPath.c_str(), MOVEFILE_REPLACE_EXISTING))
+		mDirty = false;
+	else
+		DeleteFileW(tempPath.c_str());
+}
+
+UINT64 PipelineCache::HashGraphicsPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT64 rootSignatureHash)
+{
+	Hasher hasher;
+	hasher.AddValue(rootSignatureHash);
+
+	AddBytecode(hasher, desc.VS);
+	AddBytecode(hasher, desc.PS);
+	AddBytecode(hasher, desc.DS);
+	AddBytecode(hasher, desc.HS);
+	AddBytecode(hasher, desc.GS);
+
+	hasher.AddValue(desc.StreamOutput.NumEntries);
+	for (UINT n = 0; n < desc.StreamOutput.NumEntries; n++)
+	{
+		const D3D12_SO_DECLARATION_ENTRY& entry = desc.StreamOutput.pSODeclaration[n];
+		hasher.AddValue(entry.Stream);
+		hasher.AddString(entry.SemanticName);
+		hasher.AddValue(entry.SemanticIndex);
+		hasher.AddValue(entry.StartComponent);
+		hasher.AddValue(entry.ComponentCount);
+		hasher.AddValue(entry.OutputSlot);
+	}
+	hasher.AddValue(desc.StreamOutput.NumStrides);
+	if (desc.StreamOutput.NumStrides > 0)
+		hasher.Add(desc.StreamOutput.pBufferStrides, desc.StreamOutput.NumStrides * sizeof(UINT));
+	hasher.AddValue(desc.StreamOutput.RasterizedStream);
+
+	hasher.AddValue(desc.BlendState.AlphaToCoverageEnable);
+	hasher.AddValue(desc.BlendState.IndependentBlendEnable);
+	for (const D3D12_RENDER_TARGET_BLEND_DESC& target : desc.BlendState.RenderTarget)
+	{
+		hasher.AddValue(target.BlendEnable);
+		hasher.AddValue(target.LogicOpEnable);
+		hasher.AddValue(target.SrcBlend);
+		hasher.AddValue(target.DestBlend);
+		hasher.AddValue(target.BlendOp);
+		hasher.AddValue(target.SrcBlendAlpha);
+		hasher.AddValue(target.DestBlendAlpha);
+		hasher.AddValue(target.BlendOpAlpha);
+		hasher.AddValue(target.LogicOp);
+		hasher.AddValue(target.RenderTargetWriteMask);
+	}
+	hasher.AddValue(desc.SampleMask);
+
+	// Only 4 byte members, no padding
+	hasher.AddValue(desc.RasterizerState);
+
+	hasher.AddValue(desc.DepthStencilState.DepthEnable);
+	hasher.AddValue(desc.DepthStencilState.DepthWriteMask);
+	hasher.AddValue(desc.DepthStencilState.DepthFunc);
+	hasher.AddValue(desc.DepthStencilState.StencilEnable);
+	hasher.AddValue(desc.DepthStencilState.StencilReadMask);
+	hasher.AddValue(desc.DepthStencilState.StencilWriteMask);
+	AddStencilOp(hasher, desc.DepthStencilState.FrontFace);
+	AddStencilOp(hasher, desc.DepthStencilState.BackFace);
+
+	hasher.AddValue(desc.InputLayout.NumElements);
+	for (UINT n = 0; n < desc.InputLayout.NumElements; n++)
+	{
+		const D3D12_INPUT_ELEMENT_DESC& element = desc.InputLayout.pInputElementDescs[n];
+		hasher.AddString(element.SemanticName);
+		hasher.AddValue(element.SemanticIndex);
+		hasher.AddValue(element.Format);
+		hasher.AddValue(element.InputSlot);
+		hasher.AddValue(element.AlignedByteOffset);
+		hasher.AddValue(element.InputSlotClass);
+		hasher.AddValue(element.InstanceDataStepRate);
+	}
+
+	hasher.AddValue(desc.IBStripCutValue);
+	hasher.AddValue(desc.PrimitiveTopologyType);
+	hasher.AddValue(desc.NumRenderTargets);
+	hasher.AddValue(desc.RTVFormats);
+	hasher.AddValue(desc.DSVFormat);
+	hasher.AddValue(desc.SampleDesc.Count);
+	hasher.AddValue(desc.SampleDesc.Quality);
+	hasher.AddValue(desc.NodeMask);
+	hasher.AddValue(desc.Flags);
+
+	return hasher.Get();
+}
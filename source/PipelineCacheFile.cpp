@@ -0,0 +1,56 @@
+#include "PipelineCacheFile.h"
+#include "Hasher.h"
+
+#include <cstring>
+
+namespace
+{
+	uint64_t HashBlob(const void* pBlob, uint64_t blobSize)
+	{
+		Hasher hasher;
+		hasher.Add(pBlob, static_cast<size_t>(blobSize));
+		return hasher.Get();
+	}
+}
+
+std::vector<uint8_t> PipelineCacheFile::Write(const Identity& identity, const void* pBlob, uint64_t blobSize)
+{
+	Header header = {};
+	header.magic = Magic;
+	header.version = Version;
+	header.identity = identity;
+	header.blobSize = blobSize;
+	header.blobHash = HashBlob(pBlob, blobSize);
+
+	std::vector<uint8_t> data(sizeof(header) + static_cast<size_t>(blobSize));
+	memcpy(data.data(), &header, sizeof(header));
+	if (blobSize > 0)
+		memcpy(data.data() + sizeof(header), pBlob, static_cast<size_t>(blobSize));
+	return data;
+}
+
+bool PipelineCacheFile::Read(const std::vector<uint8_t>& data, const Identity& identity, const uint8_t*& pBlob, uint64_t& blobSize)
+{
+	if (data.size() < sizeof(Header))
+		return false;
+
+	Header header;
+	memcpy(&header, data.data(), sizeof(header));
+
+	if (header.magic != Magic || header.version != Version)
+		return false;
+
+	if (header.identity.vendorId != identity.vendorId || header.identity.deviceId != identity.deviceId ||
+		header.identity.subSysId != identity.subSysId || header.identity.revision != identity.revision ||
+		header.identity.driverVersion != identity.driverVersion)
+		return false;
+
+	if (header.blobSize != data.size() - sizeof(Header))
+		return false;
+
+	pBlob = data.data() + sizeof(Header);
+	blobSize = header.blobSize;
+
+	// A torn write must not reach the driver
+	return HashBlob(pBlob, blobSize) == header.blobHash;
+}
@@ -0,0 +1,69 @@
+#include "PreciseTimer.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+
+PreciseTimer::PreciseTimer()
+{
+	// High resolution timers need Windows 10 1803, plain ones fire on the scheduler tick
+	mTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	mSpinThreshold = 0.5;
+	if (!mTimer)
+	{
+		mTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+		mSpinThreshold = 2.0;
+	}
+}
+
+PreciseTimer::~PreciseTimer()
+{
+	if (mTimer)
+		CloseHandle(mTimer);
+}
+
+#else
+
+PreciseTimer::PreciseTimer()
+	: mSpinThreshold(0.2)
+{
+}
+
+PreciseTimer::~PreciseTimer()
+{
+}
+
+#endif
+
+void PreciseTimer::Wait(double milliseconds)
+{
+	using Clock = std::chrono::steady_clock;
+	const Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(milliseconds));
+
+	const double sleepTime = milliseconds - mSpinThreshold;
+	if (sleepTime > 0.0)
+	{
+#ifdef _WIN32
+		// Relative due time in 100ns units
+		LARGE_INTEGER dueTime;
+		dueTime.QuadPart = -static_cast<LONGLONG>(sleepTime * 10000.0);
+		if (mTimer && SetWaitableTimer(mTimer, &dueTime, 0, nullptr, nullptr, FALSE))
+			WaitForSingleObject(mTimer, INFINITE);
+#else
+		std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(sleepTime));
+#endif
+	}
+
+	while (Clock::now() < end)
+	{
+		std::this_thread::yield();
+	}
+}
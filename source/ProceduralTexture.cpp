@@ -0,0 +1,113 @@
+#include "ProceduralTexture.h"
+#include "ProceduralTextureKernels.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define PROCEDURAL_TEXTURE_X64 1
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define PROCEDURAL_TEXTURE_NEON 1
+#endif
+
+// Per instruction set sources, each built with the code generation flags it needs
+#ifdef PROCEDURAL_TEXTURE_X64
+void GenerateRowSse41(const ProceduralTextureDesc& desc, uint32_t y, uint32_t* pRow);
+void GenerateRowAvx2(const ProceduralTextureDesc& desc, uint32_t y, uint32_t* pRow);
+#endif
+#ifdef PROCEDURAL_TEXTURE_NEON
+void GenerateRowNeon(const ProceduralTextureDesc& desc, uint32_t y, uint32_t* pRow);
+#endif
+
+namespace
+{
+	void GenerateRowScalar(const ProceduralTextureDesc& desc, uint32_t y, uint32_t* pRow)
+	{
+		ProceduralKernels<ScalarVec>::Row(desc, y, 0, pRow);
+	}
+
+	typedef void (*RowFunc)(const ProceduralTextureDesc& desc, uint32_t y, uint32_t* pRow);
+
+	RowFunc GetRowFunc(ProceduralTexture::Isa isa)
+	{
+		switch (isa)
+		{
+#ifdef PROCEDURAL_TEXTURE_X64
+		case ProceduralTexture::Isa::Sse41: return GenerateRowSse41;
+		case ProceduralTexture::Isa::Avx2: return GenerateRowAvx2;
+#endif
+#ifdef PROCEDURAL_TEXTURE_NEON
+		case ProceduralTexture::Isa::Neon: return GenerateRowNeon;
+#endif
+		default: return GenerateRowScalar;
+		}
+	}
+}
+
+ProceduralTexture::Isa ProceduralTexture::GetBestIsa()
+{
+	for (Isa isa : { Isa::Avx2, Isa::Sse41, Isa::Neon })
+	{
+		if (IsSupported(isa))
+			return isa;
+	}
+	return Isa::Scalar;
+}
+
+bool ProceduralTexture::IsSupported(Isa isa)
+{
+	switch (isa)
+	{
+	case Isa::Scalar:
+		return true;
+#ifdef PROCEDURAL_TEXTURE_X64
+	case Isa::Sse41:
+		return CpuFeatures::HasSse41();
+	case Isa::Avx2:
+		return CpuFeatures::HasAvx2();
+#endif
+#ifdef PROCEDURAL_TEXTURE_NEON
+	case Isa::Neon:
+		return CpuFeatures::HasNeon();
+#endif
+	default:
+		return false;
+	}
+}
+
+const char* ProceduralTexture::GetIsaName(Isa isa)
+{
+	switch (isa)
+	{
+	case Isa::Sse41: return "SSE4.1";
+	case Isa::Avx2: return "AVX2";
+	case Isa::Neon: return "NEON";
+	default: return "Scalar";
+	}
+}
+
+void ProceduralTexture::Generate(const ProceduralTextureDesc& desc, void* pDest, uint64_t rowPitch, JobSystem* pJobSystem)
+{
+	const Isa isa = GetBestIsa();
+	const uint32_t jobCount = (desc.height + RowsPerJob - 1) / RowsPerJob;
+	if (!pJobSystem || jobCount <= 1)
+	{
+		GenerateRows(desc, 0, desc.height, pDest, rowPitch, isa);
+		return;
+	}
+
+	pJobSystem->ParallelFor(jobCount, [&](unsigned int job, unsigned int)
+	{
+		const uint32_t firstRow = job * RowsPerJob;
+		const uint32_t rowCount = desc.height - firstRow < RowsPerJob ? desc.height - firstRow : RowsPerJob;
+		GenerateRows(desc, firstRow, rowCount, pDest, rowPitch, isa);
+	});
+}
+
+void ProceduralTexture::GenerateRows(const ProceduralTextureDesc& desc, uint32_t firstRow, uint32_t rowCount, void* pDest, uint64_t rowPitch, Isa isa)
+{
+	const RowFunc rowFunc = GetRowFunc(isa);
+	for (uint32_t y = firstRow; y < firstRow + rowCount; y++)
+	{
+		rowFunc(desc, y, reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(pDest) + y * rowPitch));
+	}
+}
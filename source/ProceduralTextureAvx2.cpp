@@ -0,0 +1,52 @@
+#include "ProceduralTextureKernels.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+// Built with AVX2 code generation, only called once the CPU reported support for it
+namespace
+{
+	struct Avx2Vec
+	{
+		using F = __m256;
+		using I = __m256i;
+		static const uint32_t Width = 8;
+
+		static F Set(float value) { return _mm256_set1_ps(value); }
+		static I SetI(uint32_t value) { return _mm256_set1_epi32(static_cast<int>(value)); }
+		static F Ramp() { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+		static F Add(F a, F b) { return _mm256_add_ps(a, b); }
+		static F Sub(F a, F b) { return _mm256_sub_ps(a, b); }
+		static F Mul(F a, F b) { return _mm256_mul_ps(a, b); }
+		static F Min(F a, F b) { return _mm256_min_ps(a, b); }
+		static F Max(F a, F b) { return _mm256_max_ps(a, b); }
+		static F Floor(F a) { return _mm256_floor_ps(a); }
+		static F Sqrt(F a) { return _mm256_sqrt_ps(a); }
+		static I ToInt(F a) { return _mm256_cvttps_epi32(a); }
+		static F ToFloat(I a) { return _mm256_cvtepi32_ps(a); }
+		static I AddI(I a, I b) { return _mm256_add_epi32(a, b); }
+		static I SubI(I a, I b) { return _mm256_sub_epi32(a, b); }
+		static I MulI(I a, I b) { return _mm256_mullo_epi32(a, b); }
+		static I And(I a, I b) { return _mm256_and_si256(a, b); }
+		static I Or(I a, I b) { return _mm256_or_si256(a, b); }
+		static I Xor(I a, I b) { return _mm256_xor_si256(a, b); }
+		template<int N> static I ShiftLeft(I a) { return _mm256_slli_epi32(a, N); }
+		template<int N> static I ShiftRight(I a) { return _mm256_srli_epi32(a, N); }
+		static I Greater(F a, F b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+		static F Select(I mask, F a, F b) { return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(mask)); }
+		static F FlipSign(F a, I bits)
+		{
+			return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_and_si256(bits, _mm256_set1_epi32(static_cast<int>(0x80000000u)))));
+		}
+		static void Store(uint32_t* pDest, I value) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDest), value); }
+	};
+}
+
+void GenerateRowAvx2(const ProceduralTextureDesc& desc, uint32_t y, uint32_t* pRow)
+{
+	const uint32_t x = ProceduralKernels<Avx2Vec>::Row(desc, y, 0, pRow);
+	ProceduralKernels<ScalarVec>::Row(desc, y, x, pRow);
+}
+
+#endif
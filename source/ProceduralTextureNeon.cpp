@@ -0,0 +1,55 @@
+#include "ProceduralTextureKernels.h"
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+
+#include <arm_neon.h>
+
+namespace
+{
+	struct NeonVec
+	{
+		using F = float32x4_t;
+		using I = uint32x4_t;
+		static const uint32_t Width = 4;
+
+		static F Set(float value) { return vdupq_n_f32(value); }
+		static I SetI(uint32_t value) { return vdupq_n_u32(value); }
+		static F Ramp()
+		{
+			static const float ramp[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+			return vld1q_f32(ramp);
+		}
+		static F Add(F a, F b) { return vaddq_f32(a, b); }
+		static F Sub(F a, F b) { return vsubq_f32(a, b); }
+		static F Mul(F a, F b) { return vmulq_f32(a, b); }
+		static F Min(F a, F b) { return vminq_f32(a, b); }
+		static F Max(F a, F b) { return vmaxq_f32(a, b); }
+		static F Floor(F a) { return vrndmq_f32(a); }
+		static F Sqrt(F a) { return vsqrtq_f32(a); }
+		static I ToInt(F a) { return vreinterpretq_u32_s32(vcvtq_s32_f32(a)); }
+		static F ToFloat(I a) { return vcvtq_f32_s32(vreinterpretq_s32_u32(a)); }
+		static I AddI(I a, I b) { return vaddq_u32(a, b); }
+		static I SubI(I a, I b) { return vsubq_u32(a, b); }
+		static I MulI(I a, I b) { return vmulq_u32(a, b); }
+		static I And(I a, I b) { return vandq_u32(a, b); }
+		static I Or(I a, I b) { return vorrq_u32(a, b); }
+		static I Xor(I a, I b) { return veorq_u32(a, b); }
+		template<int N> static I ShiftLeft(I a) { return vshlq_n_u32(a, N); }
+		template<int N> static I ShiftRight(I a) { return vshrq_n_u32(a, N); }
+		static I Greater(F a, F b) { return vcgtq_f32(a, b); }
+		static F Select(I mask, F a, F b) { return vbslq_f32(mask, a, b); }
+		static F FlipSign(F a, I bits)
+		{
+			return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vandq_u32(bits, vdupq_n_u32(0x80000000u))));
+		}
+		static void Store(uint32_t* pDest, I value) { vst1q_u32(pDest, value); }
+	};
+}
+
+void GenerateRowNeon(const ProceduralTextureDesc& desc, uint32_t y, uint32_t* pRow)
+{
+	const uint32_t x = ProceduralKernels<NeonVec>::Row(desc, y, 0, pRow);
+	ProceduralKernels<ScalarVec>::Row(desc, y, x, pRow);
+}
+
+#endif
@@ -0,0 +1,51 @@
+#include "ProceduralTextureKernels.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <smmintrin.h>
+
+namespace
+{
+	struct Sse41Vec
+	{
+		using F = __m128;
+		using I = __m128i;
+		static const uint32_t Width = 4;
+
+		static F Set(float value) { return _mm_set1_ps(value); }
+		static I SetI(uint32_t value) { return _mm_set1_epi32(static_cast<int>(value)); }
+		static F Ramp() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+		static F Add(F a, F b) { return _mm_add_ps(a, b); }
+		static F Sub(F a, F b) { return _mm_sub_ps(a, b); }
+		static F Mul(F a, F b) { return _mm_mul_ps(a, b); }
+		static F Min(F a, F b) { return _mm_min_ps(a, b); }
+		static F Max(F a, F b) { return _mm_max_ps(a, b); }
+		static F Floor(F a) { return _mm_floor_ps(a); }
+		static F Sqrt(F a) { return _mm_sqrt_ps(a); }
+		static I ToInt(F a) { return _mm_cvttps_epi32(a); }
+		static F ToFloat(I a) { return _mm_cvtepi32_ps(a); }
+		static I AddI(I a, I b) { return _mm_add_epi32(a, b); }
+		static I SubI(I a, I b) { return _mm_sub_epi32(a, b); }
+		static I MulI(I a, I b) { return _mm_mullo_epi32(a, b); }
+		static I And(I a, I b) { return _mm_and_si128(a, b); }
+		static I Or(I a, I b) { return _mm_or_si128(a, b); }
+		static I Xor(I a, I b) { return _mm_xor_si128(a, b); }
+		template<int N> static I ShiftLeft(I a) { return _mm_slli_epi32(a, N); }
+		template<int N> static I ShiftRight(I a) { return _mm_srli_epi32(a, N); }
+		static I Greater(F a, F b) { return _mm_castps_si128(_mm_cmpgt_ps(a, b)); }
+		static F Select(I mask, F a, F b) { return _mm_blendv_ps(b, a, _mm_castsi128_ps(mask)); }
+		static F FlipSign(F a, I bits)
+		{
+			return _mm_xor_ps(a, _mm_castsi128_ps(_mm_and_si128(bits, _mm_set1_epi32(static_cast<int>(0x80000000u)))));
+		}
+		static void Store(uint32_t* pDest, I value) { _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), value); }
+	};
+}
+
+void GenerateRowSse41(const ProceduralTextureDesc& desc, uint32_t y, uint32_t* pRow)
+{
+	const uint32_t x = ProceduralKernels<Sse41Vec>::Row(desc, y, 0, pRow);
+	ProceduralKernels<ScalarVec>::Row(desc, y, x, pRow);
+}
+
+#endif
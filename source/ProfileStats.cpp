@@ -0,0 +1,92 @@
+#include "ProfileStats.h"
+#include "Hasher.h"
+
+#include <algorithm>
+
+ProfileStats::ProfileStats(uint32_t windowSize)
+	: mWindowSize(std::max(windowSize, 1u))
+{
+}
+
+void ProfileStats::AddFrame(const std::vector<ProfileNode>& nodes, uint64_t ticksPerSecond)
+{
+	mFrame++;
+	const double msPerTick = 1000.0 / static_cast<double>(ticksPerSecond);
+
+	for (const ProfileNode& node : nodes)
+	{
+		auto inserted = mSeriesIndices.emplace(node.pathHash, static_cast<uint32_t>(mSeries.size()));
+		if (inserted.second)
+			mSeries.push_back({ node.name, node.depth, 0, 0, 0, std::vector<double>(mWindowSize) });
+
+		Series& series = mSeries[inserted.first->second];
+		const double duration = static_cast<double>(node.end - node.begin) * msPerTick;
+
+		// Repeated scope, add to this frame's sample
+		if (series.lastFrame == mFrame)
+		{
+			series.samples[(series.next + mWindowSize - 1) % mWindowSize] += duration;
+			continue;
+		}
+
+		series.samples[series.next] = duration;
+		series.next = (series.next + 1) % mWindowSize;
+		series.count = std::min(series.count + 1, mWindowSize);
+		series.lastFrame = mFrame;
+	}
+}
+
+void ProfileStats::GetSummaries(std::vector<Summary>& summaries) const
+{
+	summaries.clear();
+	for (const Series& series : mSeries)
+	{
+		summaries.push_back(Summarize(series));
+	}
+}
+
+bool ProfileStats::GetSummary(const char* rootName, Summary& summary) const
+{
+	Hasher hasher;
+	hasher.AddString(rootName);
+
+	auto it = mSeriesIndices.find(hasher.Get());
+	if (it == mSeriesIndices.end())
+		return false;
+
+	summary = Summarize(mSeries[it->second]);
+	return true;
+}
+
+void ProfileStats::Reset()
+{
+	mFrame = 0;
+	mSeriesIndices.clear();
+	mSeries.clear();
+}
+
+ProfileStats::Summary ProfileStats::Summarize(const Series& series) const
+{
+	Summary summary = { series.name, series.depth, series.count, 0.0, 0.0, 0.0, 0.0 };
+	if (series.count == 0)
+		return summary;
+
+	// The window isn't full until count reaches it, its valid samples are the first count then
+	mScratch.assign(series.samples.begin(), series.samples.begin() + series.count);
+	summary.last = series.samples[(series.next + mWindowSize - 1) % mWindowSize];
+
+	double total = 0.0;
+	summary.min = mScratch[0];
+	for (double sample : mScratch)
+	{
+		total += sample;
+		summary.min = std::min(summary.min, sample);
+	}
+	summary.avg = total / series.count;
+
+	// Nearest rank
+	const size_t rank = (static_cast<size_t>(series.count) * 99 + 99) / 100 - 1;
+	std::nth_element(mScratch.begin(), mScratch.begin() + rank, mScratch.end());
+	summary.p99 = mScratch[rank];
+	return summary;
+}
@@ -0,0 +1,48 @@
+#include "ProfileTree.h"
+#include "Hasher.h"
+
+#include <algorithm>
+
+void ProfileTree::Build(const ProfileEvent* pEvents, size_t eventCount, std::vector<ProfileNode>& nodes)
+{
+	nodes.clear();
+	for (size_t i = 0; i < eventCount; i++)
+	{
+		const ProfileEvent& event = pEvents[i];
+		if (event.end >= event.begin)
+			nodes.push_back({ event.name, event.begin, event.end, ProfileNode::InvalidParent, 0, 0 });
+	}
+
+	// Parents before their children: earlier begin first, the longer scope first on a tie
+	std::stable_sort(nodes.begin(), nodes.end(), [](const ProfileNode& a, const ProfileNode& b)
+	{
+		return a.begin != b.begin ? a.begin < b.begin : a.end > b.end;
+	});
+
+	// Open scopes, innermost last. The stack is the parent chain of the node being placed.
+	uint32_t stack[64];
+	uint32_t stackSize = 0;
+	for (uint32_t i = 0; i < nodes.size(); i++)
+	{
+		ProfileNode& node = nodes[i];
+		while (stackSize > 0 && nodes[stack[stackSize - 1]].end < node.end)
+		{
+			stackSize--;
+		}
+
+		Hasher hasher;
+		if (stackSize > 0)
+		{
+			const ProfileNode& parent = nodes[stack[stackSize - 1]];
+			node.parent = stack[stackSize - 1];
+			node.depth = parent.depth + 1;
+			hasher.AddValue(parent.pathHash);
+		}
+		hasher.AddString(node.name);
+		node.pathHash = hasher.Get();
+
+		// Deeper than anything sensible, later scopes attach to the deepest kept level
+		if (stackSize < sizeof(stack) / sizeof(stack[0]))
+			stack[stackSize++] = i;
+	}
+}
@@ -0,0 +1,43 @@
+#include "QueueFence.h"
+#include "DXHelper.h"
+
+QueueFence::QueueFence()
+	:
+	mEvent(nullptr)
+{
+}
+
+QueueFence::~QueueFence()
+{
+	if (mEvent)
+		CloseHandle(mEvent);
+}
+
+void QueueFence::Init(ID3D12Device* pDevice, ID3D12CommandQueue* pQueue)
+{
+	mQueue = pQueue;
+	ThrowIfFailed(pDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence)));
+
+	mEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (mEvent == nullptr)
+		ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+}
+
+void QueueFence::Signal(uint64_t fenceValue)
+{
+	ThrowIfFailed(mQueue->Signal(mFence.Get(), fenceValue));
+}
+
+uint64_t QueueFence::GetCompletedValue()
+{
+	return mFence->GetCompletedValue();
+}
+
+void QueueFence::Wait(uint64_t fenceValue)
+{
+	if (mFence->GetCompletedValue() < fenceValue)
+	{
+		ThrowIfFailed(mFence->SetEventOnCompletion(fenceValue, mEvent));
+		WaitForSingleObject(mEvent, INFINITE);
+	}
+}
@@ -0,0 +1,286 @@
+#include "RenderGraph.h"
+#include "CpuProfiler.h"
+#include "DXHelper.h"
+
+ID3D12Resource* RenderPassContext::GetResource(RenderGraphHandle handle) const
+{
+	return mpGraph->GetResource(handle);
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(RenderGraphHandle handle, D3D12_RESOURCE_STATES state)
+{
+	mpGraph->mCompiler.AddUse(mPass, handle, static_cast<uint32_t>(state), false);
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(RenderGraphHandle handle, D3D12_RESOURCE_STATES state)
+{
+	mpGraph->mCompiler.AddUse(mPass, handle, static_cast<uint32_t>(state), true);
+	return *this;
+}
+
+void RenderGraph::Init(ID3D12Device* pDevice)
+{
+	mDevice = pDevice;
+}
+
+void RenderGraph::Reset()
+{
+	mCompiler.Reset();
+	mResources.clear();
+	mPasses.clear();
+}
+
+RenderGraphHandle RenderGraph::ImportResource(ID3D12Resource* pResource)
+{
+	return AddImported(pResource, RenderGraphCompiler::InvalidState);
+}
+
+RenderGraphHandle RenderGraph::ImportResource(ID3D12Resource* pResource, D3D12_RESOURCE_STATES finalState)
+{
+	return AddImported(pResource, static_cast<uint32_t>(finalState));
+}
+
+RenderGraphHandle RenderGraph::AddImported(ID3D12Resource* pResource, uint32_t finalState)
+{
+	GraphResource resource = {};
+	resource.pResource = pResource;
+	resource.imported = true;
+	mResources.push_back(resource);
+
+	RenderGraphCompiler::Resource compilerResource = {};
+	compilerResource.imported = true;
+	compilerResource.finalState = finalState;
+	return mCompiler.AddResource(compilerResource);
+}
+
+RenderGraphHandle RenderGraph::CreateResource(const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* pClearValue)
+{
+	GraphResource resource = {};
+	resource.desc = desc;
+	resource.desc.Alignment = 0;
+	resource.hasClearValue = pClearValue != nullptr;
+	if (pClearValue)
+		resource.clearValue = *pClearValue;
+	mResources.push_back(resource);
+
+	const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = mDevice->GetResourceAllocationInfo(0, 1, &resource.desc);
+
+	RenderGraphCompiler::Resource compilerResource = {};
+	compilerResource.size = allocationInfo.SizeInBytes;
+	compilerResource.alignment = allocationInfo.Alignment;
+	compilerResource.heapClass = GetHeapClass(desc);
+	compilerResource.imported = false;
+	compilerResource.finalState = RenderGraphCompiler::InvalidState;
+	return mCompiler.AddResource(compilerResource);
+}
+
+RenderGraph::PassBuilder RenderGraph::AddPass(ExecuteFunc execute, bool hasSideEffects)
+{
+	mPasses.push_back(std::move(execute));
+	return PassBuilder(this, mCompiler.AddPass(hasSideEffects));
+}
+
+void RenderGraph::Execute(CommandListPool& pool, ResourceStateTracker& tracker, UINT64 fenceValue, std::vector<ID3D12CommandList*>& commandLists)
+{
+	PROFILE_FUNCTION();
+
+	// A pass reading and writing the same resource in different states
+	if (!mCompiler.Compile(mCompiled))
+		ThrowIfFailed(E_INVALIDARG);
+
+	if (!LayoutMatches())
+		CreateTransients();
+
+	for (uint32_t n = 0; n < mResources.size(); n++)
+	{
+		if (mTransients[n].resource)
+			mResources[n].pResource = mTransients[n].resource.Get();
+	}
+
+	const uint32_t positionCount = static_cast<uint32_t>(mCompiled.passOrder.size());
+	for (uint32_t position = 0; position < positionCount; position++)
+	{
+		ID3D12GraphicsCommandList* pCommandList = pool.Acquire(nullptr);
+		RecordBarriers(tracker, pCommandList, position);
+
+		RenderPassContext context;
+		context.mpGraph = this;
+		context.mpCommandList = pCommandList;
+		mPasses[mCompiled.passOrder[position]](context);
+
+		ThrowIfFailed(pCommandList->Close());
+		commandLists.push_back(pCommandList);
+		commandLists.insert(commandLists.end(), context.mCommandLists.begin(), context.mCommandLists.end());
+	}
+
+	// Imported resources handed back in the state the caller asked for
+	if (mCompiled.barrierOffsets[positionCount] != mCompiled.barrierOffsets[positionCount + 1])
+	{
+		ID3D12GraphicsCommandList* pCommandList = pool.Acquire(nullptr);
+		RecordBarriers(tracker, pCommandList, positionCount);
+
+		ThrowIfFailed(pCommandList->Close());
+		commandLists.push_back(pCommandList);
+	}
+
+	for (uint32_t n = 0; n < mResources.size(); n++)
+	{
+		if (mTransients[n].resource && mCompiled.finalStates[n] != RenderGraphCompiler::InvalidState)
+			mTransients[n].state = static_cast<D3D12_RESOURCE_STATES>(mCompiled.finalStates[n]);
+	}
+
+	mLastFenceValue = fenceValue;
+}
+
+void RenderGraph::Retire(UINT64 completedFenceValue)
+{
+	auto it = mRetiredHeaps.begin();
+	while (it != mRetiredHeaps.end())
+	{
+		if (it->fenceValue <= completedFenceValue)
+			it = mRetiredHeaps.erase(it);
+		else
+			++it;
+	}
+}
+
+RenderGraph::HeapClass RenderGraph::GetHeapClass(const D3D12_RESOURCE_DESC& desc)
+{
+	if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+		return BufferHeap;
+
+	if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+		return RenderTargetHeap;
+
+	return TextureHeap;
+}
+
+bool RenderGraph::SameDesc(const D3D12_RESOURCE_DESC& a, const D3D12_RESOURCE_DESC& b)
+{
+	// Field by field, the struct has padding
+	return a.Dimension == b.Dimension && a.Alignment == b.Alignment && a.Width == b.Width && a.Height == b.Height &&
+		a.DepthOrArraySize == b.DepthOrArraySize && a.MipLevels == b.MipLevels && a.Format == b.Format &&
+		a.SampleDesc.Count == b.SampleDesc.Count && a.SampleDesc.Quality == b.SampleDesc.Quality &&
+		a.Layout == b.Layout && a.Flags == b.Flags;
+}
+
+bool RenderGraph::LayoutMatches() const
+{
+	if (mTransients.size() != mResources.size())
+		return false;
+
+	const RenderGraphCompiler::Result& compiled = mCompiled;
+	for (uint32_t n = 0; n < mResources.size(); n++)
+	{
+		const bool used = !mResources[n].imported && compiled.firstUse[n] != RenderGraphCompiler::InvalidIndex;
+		const Transient& transient = mTransients[n];
+
+		if (used != (transient.resource != nullptr))
+			return false;
+
+		if (used && (!SameDesc(transient.desc, mResources[n].desc) || transient.heapOffset != compiled.heapOffsets[n] ||
+			transient.heapClass != GetHeapClass(mResources[n].desc)))
+			return false;
+	}
+
+	return true;
+}
+
+void RenderGraph::CreateTransients()
+{
+	// Resources of the old layout may still be in flight
+	RetiredHeaps retired;
+	retired.fenceValue = mLastFenceValue;
+	for (ComPtr<ID3D12Heap>& heap : mHeaps)
+	{
+		if (heap)
+			retired.heaps.push_back(std::move(heap));
+	}
+	retired.transients = std::move(mTransients);
+	if (!retired.heaps.empty())
+		mRetiredHeaps.push_back(std::move(retired));
+
+	static const D3D12_HEAP_FLAGS heapFlags[HeapClassCount] =
+	{
+		D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS
+	};
+
+	for (uint32_t heapClass = 0; heapClass < mCompiled.heapSizes.size(); heapClass++)
+	{
+		if (mCompiled.heapSizes[heapClass] == 0)
+			continue;
+
+		// MSAA targets need the larger placement alignment from the heap as well
+		UINT64 alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		for (uint32_t n = 0; n < mResources.size(); n++)
+		{
+			if (!mResources[n].imported && GetHeapClass(mResources[n].desc) == static_cast<HeapClass>(heapClass) &&
+				mResources[n].desc.SampleDesc.Count > 1)
+				alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+		}
+
+		CD3DX12_HEAP_DESC heapDesc((mCompiled.heapSizes[heapClass] + alignment - 1) & ~(alignment - 1),
+			D3D12_HEAP_TYPE_DEFAULT, alignment, heapFlags[heapClass]);
+		ThrowIfFailed(mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(&mHeaps[heapClass])));
+	}
+
+	mTransients.assign(mResources.size(), Transient());
+	for (uint32_t n = 0; n < mResources.size(); n++)
+	{
+		const GraphResource& resource = mResources[n];
+		if (resource.imported || mCompiled.firstUse[n] == RenderGraphCompiler::InvalidIndex)
+			continue;
+
+		Transient& transient = mTransients[n];
+		transient.desc = resource.desc;
+		transient.heapOffset = mCompiled.heapOffsets[n];
+		transient.heapClass = GetHeapClass(resource.desc);
+		transient.state = D3D12_RESOURCE_STATE_COMMON;
+
+		ThrowIfFailed(mDevice->CreatePlacedResource(mHeaps[transient.heapClass].Get(), transient.heapOffset, &transient.desc,
+			transient.state, resource.hasClearValue ? &resource.clearValue : nullptr, IID_PPV_ARGS(&transient.resource)));
+	}
+}
+
+void RenderGraph::RecordBarriers(ResourceStateTracker& tracker, ID3D12GraphicsCommandList* pCommandList, uint32_t position)
+{
+	const uint32_t begin = mCompiled.barrierOffsets[position];
+	const uint32_t end = mCompiled.barrierOffsets[position + 1];
+
+	for (uint32_t n = begin; n < end; n++)
+	{
+		const RenderGraphCompiler::Barrier& barrier = mCompiled.barriers[n];
+		ID3D12Resource* pResource = mResources[barrier.resource].pResource;
+
+		if (barrier.type == RenderGraphCompiler::Barrier::Type::Aliasing)
+		{
+			ID3D12Resource* pResourceBefore = barrier.resourceBefore != RenderGraphCompiler::InvalidIndex ? mResources[barrier.resourceBefore].pResource : nullptr;
+			tracker.AliasBarrier(pResourceBefore, pResource);
+			continue;
+		}
+
+		// Transients are only known to the graph, hand their state over on first use so the transition lands after the aliasing barrier
+		if (mTransients[barrier.resource].resource && mCompiled.firstUse[barrier.resource] == position)
+			tracker.SetResourceState(pResource, mTransients[barrier.resource].state);
+
+		tracker.TransitionResource(pResource, static_cast<D3D12_RESOURCE_STATES>(barrier.state));
+	}
+
+	tracker.FlushResourceBarriers(pCommandList);
+
+	// Aliased render targets and depth buffers hold garbage metadata until discarded or cleared
+	for (uint32_t n = begin; n < end; n++)
+	{
+		const RenderGraphCompiler::Barrier& barrier = mCompiled.barriers[n];
+		if (barrier.type != RenderGraphCompiler::Barrier::Type::Transition || !mCompiled.aliased[barrier.resource] ||
+			mCompiled.firstUse[barrier.resource] != position || !mTransients[barrier.resource].resource)
+			continue;
+
+		const D3D12_RESOURCE_STATES state = static_cast<D3D12_RESOURCE_STATES>(barrier.state);
+		if (state == D3D12_RESOURCE_STATE_RENDER_TARGET || state == D3D12_RESOURCE_STATE_DEPTH_WRITE)
+			pCommandList->DiscardResource(mResources[barrier.resource].pResource, nullptr);
+	}
+}
@@ -0,0 +1,475 @@
+#include "RenderGraphCompiler.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace
+{
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+uint32_t RenderGraphCompiler::AddResource(const Resource& resource)
+{
+	mResources.push_back(resource);
+	return static_cast<uint32_t>(mResources.size() - 1);
+}
+
+uint32_t RenderGraphCompiler::AddPass(bool hasSideEffects)
+{
+	mPassSideEffects.push_back(hasSideEffects);
+	return static_cast<uint32_t>(mPassSideEffects.size() - 1);
+}
+
+void RenderGraphCompiler::AddUse(uint32_t pass, uint32_t resource, uint32_t state, bool write)
+{
+	mUses.push_back({ pass, resource, state, write });
+}
+
+void RenderGraphCompiler::Reset()
+{
+	mResources.clear();
+	mPassSideEffects.clear();
+	mUses.clear();
+}
+
+bool RenderGraphCompiler::Compile(Result& result)
+{
+	BuildEdges();
+	if (!ValidateUses())
+		return false;
+
+	CullPasses();
+	SortPasses(result);
+	ComputeLifetimes(result);
+	AliasTransients(result);
+	ComputeBarriers(result);
+	return true;
+}
+
+void RenderGraphCompiler::BuildEdges()
+{
+	const uint32_t passCount = GetPassCount();
+	const uint32_t resourceCount = GetResourceCount();
+
+	// Group uses by pass, keeping declaration order inside a pass
+	mPassUseOffsets.assign(passCount + 1, 0);
+	for (const Use& use : mUses)
+	{
+		mPassUseOffsets[use.pass + 1]++;
+	}
+	for (uint32_t n = 0; n < passCount; n++)
+	{
+		mPassUseOffsets[n + 1] += mPassUseOffsets[n];
+	}
+
+	mPassUses.resize(mUses.size());
+	mCursors.assign(mPassUseOffsets.begin(), mPassUseOffsets.end() - 1);
+	for (const Use& use : mUses)
+	{
+		mPassUses[mCursors[use.pass]++] = use;
+	}
+
+	// Passes run in declaration order as far as a resource is concerned:
+	// readers depend on the last writer, writers on the last writer and every reader since
+	mLastWriters.assign(resourceCount, InvalidIndex);
+	if (mReaders.size() < resourceCount)
+		mReaders.resize(resourceCount);
+	for (uint32_t n = 0; n < resourceCount; n++)
+	{
+		mReaders[n].clear();
+	}
+
+	mEdges.clear();
+	for (uint32_t pass = 0; pass < passCount; pass++)
+	{
+		for (uint32_t n = mPassUseOffsets[pass]; n < mPassUseOffsets[pass + 1]; n++)
+		{
+			const Use& use = mPassUses[n];
+			const uint32_t lastWriter = mLastWriters[use.resource];
+			std::vector<uint32_t>& readers = mReaders[use.resource];
+
+			if (lastWriter != InvalidIndex && lastWriter != pass)
+				mEdges.push_back({ lastWriter, pass, true });
+
+			if (use.write)
+			{
+				for (uint32_t reader : readers)
+				{
+					if (reader != pass)
+						mEdges.push_back({ reader, pass, false });
+				}
+				readers.clear();
+				mLastWriters[use.resource] = pass;
+			}
+			else if (readers.empty() || readers.back() != pass)
+			{
+				readers.push_back(pass);
+			}
+		}
+	}
+
+	// Predecessor and successor lists, both indexed by pass
+	mPredecessorOffsets.assign(passCount + 1, 0);
+	mSuccessorOffsets.assign(passCount + 1, 0);
+	for (const Edge& edge : mEdges)
+	{
+		mPredecessorOffsets[edge.to + 1]++;
+		mSuccessorOffsets[edge.from + 1]++;
+	}
+	for (uint32_t n = 0; n < passCount; n++)
+	{
+		mPredecessorOffsets[n + 1] += mPredecessorOffsets[n];
+		mSuccessorOffsets[n + 1] += mSuccessorOffsets[n];
+	}
+
+	mPredecessors.resize(mEdges.size());
+	mCursors.assign(mPredecessorOffsets.begin(), mPredecessorOffsets.end() - 1);
+	for (const Edge& edge : mEdges)
+	{
+		mPredecessors[mCursors[edge.to]++] = edge;
+	}
+
+	mSuccessors.resize(mEdges.size());
+	mCursors.assign(mSuccessorOffsets.begin(), mSuccessorOffsets.end() - 1);
+	for (const Edge& edge : mEdges)
+	{
+		mSuccessors[mCursors[edge.from]++] = edge.to;
+	}
+}
+
+bool RenderGraphCompiler::ValidateUses() const
+{
+	// A write state ORed with anything else is not a valid state, e.g. RENDER_TARGET | PIXEL_SHADER_RESOURCE
+	for (uint32_t pass = 0; pass < GetPassCount(); pass++)
+	{
+		for (uint32_t n = mPassUseOffsets[pass]; n < mPassUseOffsets[pass + 1]; n++)
+		{
+			for (uint32_t m = n + 1; m < mPassUseOffsets[pass + 1]; m++)
+			{
+				const Use& a = mPassUses[n];
+				const Use& b = mPassUses[m];
+				if (a.resource == b.resource && (a.write || b.write) && a.state != b.state)
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+void RenderGraphCompiler::CullPasses()
+{
+	const uint32_t passCount = GetPassCount();
+
+	mPassAlive.assign(passCount, false);
+	for (uint32_t pass = 0; pass < passCount; pass++)
+	{
+		if (mPassSideEffects[pass])
+		{
+			mPassAlive[pass] = true;
+			continue;
+		}
+
+		for (uint32_t n = mPassUseOffsets[pass]; n < mPassUseOffsets[pass + 1]; n++)
+		{
+			if (mPassUses[n].write && mResources[mPassUses[n].resource].imported)
+				mPassAlive[pass] = true;
+		}
+	}
+
+	// Edges always point forward in declaration order, so one backward sweep reaches every producer
+	for (uint32_t pass = passCount; pass-- > 0;)
+	{
+		if (!mPassAlive[pass])
+			continue;
+
+		for (uint32_t n = mPredecessorOffsets[pass]; n < mPredecessorOffsets[pass + 1]; n++)
+		{
+			if (mPredecessors[n].producer)
+				mPassAlive[mPredecessors[n].from] = true;
+		}
+	}
+}
+
+void RenderGraphCompiler::SortPasses(Result& result)
+{
+	const uint32_t passCount = GetPassCount();
+
+	mInDegrees.assign(passCount, 0);
+	for (const Edge& edge : mEdges)
+	{
+		if (mPassAlive[edge.from] && mPassAlive[edge.to])
+			mInDegrees[edge.to]++;
+	}
+
+	// Kahn's algorithm, declaration order breaks ties so independent passes keep the order they were added in
+	std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> ready;
+	for (uint32_t pass = 0; pass < passCount; pass++)
+	{
+		if (mPassAlive[pass] && mInDegrees[pass] == 0)
+			ready.push(pass);
+	}
+
+	result.passOrder.clear();
+	mPositionOfPass.assign(passCount, InvalidIndex);
+	while (!ready.empty())
+	{
+		const uint32_t pass = ready.top();
+		ready.pop();
+
+		mPositionOfPass[pass] = static_cast<uint32_t>(result.passOrder.size());
+		result.passOrder.push_back(pass);
+
+		for (uint32_t n = mSuccessorOffsets[pass]; n < mSuccessorOffsets[pass + 1]; n++)
+		{
+			const uint32_t successor = mSuccessors[n];
+			if (mPassAlive[successor] && --mInDegrees[successor] == 0)
+				ready.push(successor);
+		}
+	}
+}
+
+void RenderGraphCompiler::ComputeLifetimes(Result& result)
+{
+	const uint32_t resourceCount = GetResourceCount();
+
+	result.firstUse.assign(resourceCount, InvalidIndex);
+	result.lastUse.assign(resourceCount, InvalidIndex);
+
+	for (uint32_t position = 0; position < result.passOrder.size(); position++)
+	{
+		const uint32_t pass = result.passOrder[position];
+		for (uint32_t n = mPassUseOffsets[pass]; n < mPassUseOffsets[pass + 1]; n++)
+		{
+			const uint32_t resource = mPassUses[n].resource;
+			if (result.firstUse[resource] == InvalidIndex)
+				result.firstUse[resource] = position;
+			result.lastUse[resource] = position;
+		}
+	}
+}
+
+void RenderGraphCompiler::AliasTransients(Result& result)
+{
+	const uint32_t resourceCount = GetResourceCount();
+
+	result.heapOffsets.assign(resourceCount, 0);
+	result.aliased.assign(resourceCount, false);
+	result.heapSizes.clear();
+	mPositionedBarriers.clear();
+
+	uint32_t heapClassCount = 0;
+	for (const Resource& resource : mResources)
+	{
+		if (!resource.imported)
+			heapClassCount = std::max(heapClassCount, resource.heapClass + 1);
+	}
+	result.heapSizes.assign(heapClassCount, 0);
+
+	for (uint32_t heapClass = 0; heapClass < heapClassCount; heapClass++)
+	{
+		mClassResources.clear();
+		for (uint32_t resource = 0; resource < resourceCount; resource++)
+		{
+			if (!mResources[resource].imported && mResources[resource].heapClass == heapClass && result.firstUse[resource] != InvalidIndex)
+				mClassResources.push_back(resource);
+		}
+
+		// Earliest first, larger ones first among those starting together so small ones fill the gaps
+		std::sort(mClassResources.begin(), mClassResources.end(), [&](uint32_t a, uint32_t b)
+		{
+			if (result.firstUse[a] != result.firstUse[b])
+				return result.firstUse[a] < result.firstUse[b];
+			if (mResources[a].size != mResources[b].size)
+				return mResources[a].size > mResources[b].size;
+			return a < b;
+		});
+
+		mPlacements.clear();
+		for (uint32_t resource : mClassResources)
+		{
+			const uint64_t size = mResources[resource].size;
+			const uint64_t alignment = std::max<uint64_t>(mResources[resource].alignment, 1);
+
+			// Placements are sorted by first use, so a placement is alive during this resource iff it ends at or after its first use
+			mOverlaps.clear();
+			for (const Placement& placement : mPlacements)
+			{
+				if (result.lastUse[placement.resource] >= result.firstUse[resource])
+					mOverlaps.push_back(placement);
+			}
+			std::sort(mOverlaps.begin(), mOverlaps.end(), [](const Placement& a, const Placement& b) { return a.begin < b.begin; });
+
+			// Lowest gap between live placements that fits
+			uint64_t offset = 0;
+			for (const Placement& overlap : mOverlaps)
+			{
+				if (AlignUp(offset, alignment) + size <= overlap.begin)
+					break;
+				offset = std::max(offset, overlap.end);
+			}
+			offset = AlignUp(offset, alignment);
+
+			const Placement placed = { resource, offset, offset + size };
+			result.heapOffsets[resource] = offset;
+			result.heapSizes[heapClass] = std::max(result.heapSizes[heapClass], placed.end);
+
+			// Everything placed before in the same memory is dead by now, the memory changes hands here
+			uint32_t resourceBefore = InvalidIndex;
+			uint32_t previousCount = 0;
+			for (const Placement& placement : mPlacements)
+			{
+				if (placement.begin < placed.end && placed.begin < placement.end)
+				{
+					resourceBefore = placement.resource;
+					previousCount++;
+					result.aliased[placement.resource] = true;
+				}
+			}
+
+			if (previousCount > 0)
+			{
+				result.aliased[resource] = true;
+
+				Barrier barrier = { Barrier::Type::Aliasing, resource, InvalidState, previousCount == 1 ? resourceBefore : InvalidIndex };
+				mPositionedBarriers.push_back({ result.firstUse[resource], barrier });
+			}
+
+			mPlacements.push_back(placed);
+		}
+
+		// The first user of shared memory takes it over from whichever transient used it last in the previous execution
+		for (uint32_t resource : mClassResources)
+		{
+			bool hasBarrier = false;
+			for (const PositionedBarrier& positioned : mPositionedBarriers)
+			{
+				if (positioned.barrier.resource == resource)
+					hasBarrier = true;
+			}
+
+			if (result.aliased[resource] && !hasBarrier)
+			{
+				Barrier barrier = { Barrier::Type::Aliasing, resource, InvalidState, InvalidIndex };
+				mPositionedBarriers.push_back({ result.firstUse[resource], barrier });
+			}
+		}
+	}
+}
+
+void RenderGraphCompiler::ComputeBarriers(Result& result)
+{
+	const uint32_t resourceCount = GetResourceCount();
+	const uint32_t positionCount = static_cast<uint32_t>(result.passOrder.size());
+
+	// Uses of every resource in execution order, pass stands for the position in passOrder from here on
+	mResourceUseOffsets.assign(resourceCount + 1, 0);
+	for (const Use& use : mUses)
+	{
+		if (mPositionOfPass[use.pass] != InvalidIndex)
+			mResourceUseOffsets[use.resource + 1]++;
+	}
+	for (uint32_t n = 0; n < resourceCount; n++)
+	{
+		mResourceUseOffsets[n + 1] += mResourceUseOffsets[n];
+	}
+
+	mResourceUses.resize(mResourceUseOffsets[resourceCount]);
+	mCursors.assign(mResourceUseOffsets.begin(), mResourceUseOffsets.end() - 1);
+	for (uint32_t position = 0; position < positionCount; position++)
+	{
+		const uint32_t pass = result.passOrder[position];
+		for (uint32_t n = mPassUseOffsets[pass]; n < mPassUseOffsets[pass + 1]; n++)
+		{
+			Use use = mPassUses[n];
+			use.pass = position;
+			mResourceUses[mCursors[use.resource]++] = use;
+		}
+	}
+
+	result.finalStates.assign(resourceCount, InvalidState);
+	for (uint32_t resource = 0; resource < resourceCount; resource++)
+	{
+		const uint32_t begin = mResourceUseOffsets[resource];
+		const uint32_t end = mResourceUseOffsets[resource + 1];
+		uint32_t currentState = InvalidState;
+
+		uint32_t n = begin;
+		while (n < end)
+		{
+			// One pass using the resource several times needs a single state covering all of them
+			const uint32_t position = mResourceUses[n].pass;
+			uint32_t state = 0;
+			bool write = false;
+			uint32_t next = n;
+			for (; next < end && mResourceUses[next].pass == position; next++)
+			{
+				state |= mResourceUses[next].state;
+				write |= mResourceUses[next].write;
+			}
+
+			// A run of read-only passes shares one combined read state, so it costs a single transition
+			if (!write)
+			{
+				while (next < end)
+				{
+					const uint32_t nextPosition = mResourceUses[next].pass;
+					uint32_t runState = 0;
+					uint32_t runEnd = next;
+					bool runWrite = false;
+					for (; runEnd < end && mResourceUses[runEnd].pass == nextPosition; runEnd++)
+					{
+						runState |= mResourceUses[runEnd].state;
+						runWrite |= mResourceUses[runEnd].write;
+					}
+
+					if (runWrite)
+						break;
+
+					state |= runState;
+					next = runEnd;
+				}
+			}
+
+			if (state != currentState)
+			{
+				Barrier barrier = { Barrier::Type::Transition, resource, state, InvalidIndex };
+				mPositionedBarriers.push_back({ position, barrier });
+				currentState = state;
+			}
+
+			n = next;
+		}
+
+		const Resource& desc = mResources[resource];
+		if (desc.imported && desc.finalState != InvalidState && currentState != InvalidState && currentState != desc.finalState)
+		{
+			Barrier barrier = { Barrier::Type::Transition, resource, desc.finalState, InvalidIndex };
+			mPositionedBarriers.push_back({ positionCount, barrier });
+			currentState = desc.finalState;
+		}
+
+		result.finalStates[resource] = currentState;
+	}
+
+	// Bucket by position, stable so aliasing barriers stay ahead of the transitions of the same pass
+	result.barrierOffsets.assign(positionCount + 2, 0);
+	for (const PositionedBarrier& positioned : mPositionedBarriers)
+	{
+		result.barrierOffsets[positioned.position + 1]++;
+	}
+	for (uint32_t n = 0; n <= positionCount; n++)
+	{
+		result.barrierOffsets[n + 1] += result.barrierOffsets[n];
+	}
+
+	result.barriers.resize(mPositionedBarriers.size());
+	mCursors.assign(result.barrierOffsets.begin(), result.barrierOffsets.end() - 1);
+	for (const PositionedBarrier& positioned : mPositionedBarriers)
+	{
+		result.barriers[mCursors[positioned.position]++] = positioned.barrier;
+	}
+}
@@ -0,0 +1,62 @@
+#include "RenderThread.h"
+#include "CpuProfiler.h"
+
+RenderThread::RenderThread()
+	: mEvents(EventQueueCapacity)
+{
+}
+
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+void RenderThread::Start(FrameFunc frameFunc, EventFunc eventFunc)
+{
+	mFrameFunc = std::move(frameFunc);
+	mEventFunc = std::move(eventFunc);
+	mStopRequested.store(false, std::memory_order_relaxed);
+	mThread = std::thread(&RenderThread::Main, this);
+}
+
+void RenderThread::Post(const WindowEvent& event)
+{
+	while (!mEvents.TryPush(event))
+	{
+		if (mStopRequested.load(std::memory_order_relaxed))
+			return;
+		std::this_thread::yield();
+	}
+}
+
+void RenderThread::Stop()
+{
+	if (!mThread.joinable())
+		return;
+
+	mStopRequested.store(true, std::memory_order_relaxed);
+	mThread.join();
+
+	WindowEvent event;
+	while (mEvents.TryPop(event))
+	{
+	}
+}
+
+void RenderThread::Main()
+{
+	if (CpuProfiler::IsEnabled())
+		CpuProfiler::SetThreadName("Render");
+
+	while (!mStopRequested.load(std::memory_order_relaxed))
+	{
+		WindowEvent event;
+		while (mEvents.TryPop(event))
+		{
+			mEventFunc(event);
+		}
+
+		mFrameFunc();
+		mFrameCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,261 @@
+#include "ResourceStateTracker.h"
+#include "DXHelper.h"
+
+std::mutex ResourceStateTracker::sGlobalMutex;
+TransitionTracker::StateMap ResourceStateTracker::sGlobalStates;
+bool ResourceStateTracker::sUseEnhancedBarriers = false;
+
+namespace
+{
+	ID3D12Resource* ToResource(TransitionTracker::Resource resource)
+	{
+		return static_cast<ID3D12Resource*>(const_cast<void*>(resource));
+	}
+}
+
+ResourceStateTracker::ResourceStateTracker()
+	:
+	mTransitions(&GetSubresourceCount)
+{
+}
+
+void ResourceStateTracker::TransitionResource(ID3D12Resource* pResource, D3D12_RESOURCE_STATES stateAfter, UINT subresource)
+{
+	mTransitions.Transition(pResource, stateAfter, subresource);
+}
+
+void ResourceStateTracker::SetResourceState(ID3D12Resource* pResource, D3D12_RESOURCE_STATES state)
+{
+	mTransitions.SetState(pResource, state);
+}
+
+void ResourceStateTracker::UAVBarrier(ID3D12Resource* pResource)
+{
+	mTransitions.UavBarrier(pResource);
+}
+
+void ResourceStateTracker::AliasBarrier(ID3D12Resource* pResourceBefore, ID3D12Resource* pResourceAfter)
+{
+	mTransitions.AliasBarrier(pResourceBefore, pResourceAfter);
+}
+
+void ResourceStateTracker::FlushResourceBarriers(ID3D12GraphicsCommandList* pCommandList)
+{
+	if (mTransitions.GetBarriers().empty())
+		return;
+
+	EmitBarriers(pCommandList, mTransitions.GetBarriers());
+	mTransitions.ClearBarriers();
+}
+
+UINT ResourceStateTracker::FlushPendingResourceBarriers(ID3D12GraphicsCommandList* pCommandList)
+{
+	std::vector<TransitionTracker::Barrier> resolvedBarriers;
+	mTransitions.ResolvePendingBarriers(sGlobalStates, resolvedBarriers);
+
+	if (!resolvedBarriers.empty())
+		EmitBarriers(pCommandList, resolvedBarriers);
+
+	return static_cast<UINT>(resolvedBarriers.size());
+}
+
+void ResourceStateTracker::CommitFinalResourceStates()
+{
+	mTransitions.CommitFinalStates(sGlobalStates);
+}
+
+void ResourceStateTracker::Reset()
+{
+	mTransitions.Reset();
+}
+
+void ResourceStateTracker::Lock()
+{
+	sGlobalMutex.lock();
+}
+
+void ResourceStateTracker::Unlock()
+{
+	sGlobalMutex.unlock();
+}
+
+void ResourceStateTracker::AddGlobalResourceState(ID3D12Resource* pResource, D3D12_RESOURCE_STATES state)
+{
+	std::lock_guard<std::mutex> lock(sGlobalMutex);
+	sGlobalStates[pResource].SetSubresourceState(D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, state);
+}
+
+void ResourceStateTracker::RemoveGlobalResourceState(ID3D12Resource* pResource)
+{
+	std::lock_guard<std::mutex> lock(sGlobalMutex);
+	sGlobalStates.erase(pResource);
+}
+
+void ResourceStateTracker::SetUseEnhancedBarriers(bool useEnhancedBarriers)
+{
+	sUseEnhancedBarriers = useEnhancedBarriers;
+}
+
+uint32_t ResourceStateTracker::GetSubresourceCount(TransitionTracker::Resource resource)
+{
+	const D3D12_RESOURCE_DESC desc = ToResource(resource)->GetDesc();
+	if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+		return 1;
+
+	const UINT arraySize = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : desc.DepthOrArraySize;
+	return desc.MipLevels * arraySize;
+}
+
+#if defined(D3D12_SDK_VERSION) && (D3D12_SDK_VERSION >= 608)
+namespace
+{
+	struct EnhancedState
+	{
+		D3D12_BARRIER_SYNC sync;
+		D3D12_BARRIER_ACCESS access;
+		D3D12_BARRIER_LAYOUT layout;
+	};
+
+	EnhancedState ToEnhancedState(D3D12_RESOURCE_STATES state)
+	{
+		static const struct
+		{
+			D3D12_RESOURCE_STATES state;
+			EnhancedState enhanced;
+		} table[] =
+		{
+			{ D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, { D3D12_BARRIER_SYNC_ALL_SHADING, D3D12_BARRIER_ACCESS_VERTEX_BUFFER | D3D12_BARRIER_ACCESS_CONSTANT_BUFFER, D3D12_BARRIER_LAYOUT_GENERIC_READ } },
+			{ D3D12_RESOURCE_STATE_INDEX_BUFFER, { D3D12_BARRIER_SYNC_INDEX_INPUT, D3D12_BARRIER_ACCESS_INDEX_BUFFER, D3D12_BARRIER_LAYOUT_GENERIC_READ } },
+			{ D3D12_RESOURCE_STATE_RENDER_TARGET, { D3D12_BARRIER_SYNC_RENDER_TARGET, D3D12_BARRIER_ACCESS_RENDER_TARGET, D3D12_BARRIER_LAYOUT_RENDER_TARGET } },
+			{ D3D12_RESOURCE_STATE_UNORDERED_ACCESS, { D3D12_BARRIER_SYNC_ALL_SHADING | D3D12_BARRIER_SYNC_CLEAR_UNORDERED_ACCESS_VIEW, D3D12_BARRIER_ACCESS_UNORDERED_ACCESS, D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS } },
+			{ D3D12_RESOURCE_STATE_DEPTH_WRITE, { D3D12_BARRIER_SYNC_DEPTH_STENCIL, D3D12_BARRIER_ACCESS_DEPTH_STENCIL_WRITE, D3D12_BARRIER_LAYOUT_DEPTH_STENCIL_WRITE } },
+			{ D3D12_RESOURCE_STATE_DEPTH_READ, { D3D12_BARRIER_SYNC_DEPTH_STENCIL, D3D12_BARRIER_ACCESS_DEPTH_STENCIL_READ, D3D12_BARRIER_LAYOUT_DEPTH_STENCIL_READ } },
+			{ D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, { D3D12_BARRIER_SYNC_NON_PIXEL_SHADING, D3D12_BARRIER_ACCESS_SHADER_RESOURCE, D3D12_BARRIER_LAYOUT_SHADER_RESOURCE } },
+			{ D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, { D3D12_BARRIER_SYNC_PIXEL_SHADING, D3D12_BARRIER_ACCESS_SHADER_RESOURCE, D3D12_BARRIER_LAYOUT_SHADER_RESOURCE } },
+			{ D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, { D3D12_BARRIER_SYNC_EXECUTE_INDIRECT, D3D12_BARRIER_ACCESS_INDIRECT_ARGUMENT, D3D12_BARRIER_LAYOUT_GENERIC_READ } },
+			{ D3D12_RESOURCE_STATE_COPY_DEST, { D3D12_BARRIER_SYNC_COPY, D3D12_BARRIER_ACCESS_COPY_DEST, D3D12_BARRIER_LAYOUT_COPY_DEST } },
+			{ D3D12_RESOURCE_STATE_COPY_SOURCE, { D3D12_BARRIER_SYNC_COPY, D3D12_BARRIER_ACCESS_COPY_SOURCE, D3D12_BARRIER_LAYOUT_COPY_SOURCE } },
+			{ D3D12_RESOURCE_STATE_RESOLVE_DEST, { D3D12_BARRIER_SYNC_RESOLVE, D3D12_BARRIER_ACCESS_RESOLVE_DEST, D3D12_BARRIER_LAYOUT_RESOLVE_DEST } },
+			{ D3D12_RESOURCE_STATE_RESOLVE_SOURCE, { D3D12_BARRIER_SYNC_RESOLVE, D3D12_BARRIER_ACCESS_RESOLVE_SOURCE, D3D12_BARRIER_LAYOUT_RESOLVE_SOURCE } },
+		};
+
+		// COMMON and PRESENT
+		if (state == D3D12_RESOURCE_STATE_COMMON)
+			return { D3D12_BARRIER_SYNC_ALL, D3D12_BARRIER_ACCESS_COMMON, D3D12_BARRIER_LAYOUT_COMMON };
+
+		// Combined read states accumulate, and fall back to the generic read layout when their layouts differ
+		EnhancedState enhanced = { D3D12_BARRIER_SYNC_NONE, D3D12_BARRIER_ACCESS_COMMON, D3D12_BARRIER_LAYOUT_UNDEFINED };
+		for (const auto& entry : table)
+		{
+			if ((state & entry.state) != entry.state)
+				continue;
+
+			enhanced.sync |= entry.enhanced.sync;
+			enhanced.access |= entry.enhanced.access;
+			enhanced.layout = enhanced.layout == D3D12_BARRIER_LAYOUT_UNDEFINED || enhanced.layout == entry.enhanced.layout
+				? entry.enhanced.layout
+				: D3D12_BARRIER_LAYOUT_GENERIC_READ;
+		}
+		return enhanced;
+	}
+}
+#endif
+
+void ResourceStateTracker::EmitBarriers(ID3D12GraphicsCommandList* pCommandList, const std::vector<TransitionTracker::Barrier>& trackedBarriers)
+{
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	barriers.reserve(trackedBarriers.size());
+	for (const TransitionTracker::Barrier& barrier : trackedBarriers)
+	{
+		switch (barrier.type)
+		{
+		case TransitionTracker::BarrierType::Transition:
+			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(ToResource(barrier.resource),
+				static_cast<D3D12_RESOURCE_STATES>(barrier.stateBefore), static_cast<D3D12_RESOURCE_STATES>(barrier.stateAfter), barrier.subresource));
+			break;
+		case TransitionTracker::BarrierType::Uav:
+			barriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(ToResource(barrier.resource)));
+			break;
+		case TransitionTracker::BarrierType::Aliasing:
+			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(ToResource(barrier.resource), ToResource(barrier.resourceAfter)));
+			break;
+		}
+	}
+
+#if defined(D3D12_SDK_VERSION) && (D3D12_SDK_VERSION >= 608)
+	ComPtr<ID3D12GraphicsCommandList7> commandList7;
+	bool canUseEnhanced = sUseEnhancedBarriers && SUCCEEDED(pCommandList->QueryInterface(IID_PPV_ARGS(&commandList7)));
+
+	// Aliasing barriers have no direct enhanced equivalent without knowing the layouts, keep those batches legacy
+	for (const D3D12_RESOURCE_BARRIER& barrier : barriers)
+	{
+		if (barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_ALIASING)
+			canUseEnhanced = false;
+	}
+
+	if (canUseEnhanced)
+	{
+		std::vector<D3D12_BUFFER_BARRIER> bufferBarriers;
+		std::vector<D3D12_TEXTURE_BARRIER> textureBarriers;
+		std::vector<D3D12_GLOBAL_BARRIER> globalBarriers;
+
+		for (const D3D12_RESOURCE_BARRIER& barrier : barriers)
+		{
+			// UAV writes also come from clears and copies, not just shaders, so they sync on all work.
+			// Only a barrier without a resource covers every UAV.
+			if (barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_UAV)
+			{
+				ID3D12Resource* pUavResource = barrier.UAV.pResource;
+				if (!pUavResource)
+				{
+					globalBarriers.push_back(CD3DX12_GLOBAL_BARRIER(D3D12_BARRIER_SYNC_ALL, D3D12_BARRIER_SYNC_ALL,
+						D3D12_BARRIER_ACCESS_UNORDERED_ACCESS, D3D12_BARRIER_ACCESS_UNORDERED_ACCESS));
+				}
+				else if (pUavResource->GetDesc().Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+				{
+					bufferBarriers.push_back(CD3DX12_BUFFER_BARRIER(D3D12_BARRIER_SYNC_ALL, D3D12_BARRIER_SYNC_ALL,
+						D3D12_BARRIER_ACCESS_UNORDERED_ACCESS, D3D12_BARRIER_ACCESS_UNORDERED_ACCESS, pUavResource));
+				}
+				else
+				{
+					textureBarriers.push_back(CD3DX12_TEXTURE_BARRIER(D3D12_BARRIER_SYNC_ALL, D3D12_BARRIER_SYNC_ALL,
+						D3D12_BARRIER_ACCESS_UNORDERED_ACCESS, D3D12_BARRIER_ACCESS_UNORDERED_ACCESS,
+						D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS, D3D12_BARRIER_LAYOUT_UNORDERED_ACCESS, pUavResource,
+						CD3DX12_BARRIER_SUBRESOURCE_RANGE(0xffffffff)));
+				}
+				continue;
+			}
+
+			ID3D12Resource* pResource = barrier.Transition.pResource;
+			const EnhancedState before = ToEnhancedState(barrier.Transition.StateBefore);
+			const EnhancedState after = ToEnhancedState(barrier.Transition.StateAfter);
+
+			if (pResource->GetDesc().Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+			{
+				bufferBarriers.push_back(CD3DX12_BUFFER_BARRIER(before.sync, after.sync, before.access, after.access, pResource));
+			}
+			else
+			{
+				const CD3DX12_BARRIER_SUBRESOURCE_RANGE range = barrier.Transition.Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES
+					? CD3DX12_BARRIER_SUBRESOURCE_RANGE(0xffffffff)
+					: CD3DX12_BARRIER_SUBRESOURCE_RANGE(barrier.Transition.Subresource);
+				textureBarriers.push_back(CD3DX12_TEXTURE_BARRIER(before.sync, after.sync, before.access, after.access,
+					before.layout, after.layout, pResource, range));
+			}
+		}
+
+		std::vector<D3D12_BARRIER_GROUP> groups;
+		if (!bufferBarriers.empty())
+			groups.push_back(CD3DX12_BARRIER_GROUP(static_cast<UINT32>(bufferBarriers.size()), bufferBarriers.data()));
+		if (!textureBarriers.empty())
+			groups.push_back(CD3DX12_BARRIER_GROUP(static_cast<UINT32>(textureBarriers.size()), textureBarriers.data()));
+		if (!globalBarriers.empty())
+			groups.push_back(CD3DX12_BARRIER_GROUP(static_cast<UINT32>(globalBarriers.size()), globalBarriers.data()));
+
+		commandList7->Barrier(static_cast<UINT32>(groups.size()), groups.data());
+		return;
+	}
+#endif
+
+	pCommandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+}
@@ -0,0 +1,82 @@
+#include "RingAllocator.h"
+
+RingAllocator::RingAllocator(uint64_t capacity)
+{
+	Reset(capacity);
+}
+
+void RingAllocator::Reset(uint64_t capacity)
+{
+	mBatches.clear();
+	mCapacity = capacity;
+	mHead = 0;
+	mTail = 0;
+	mUsedSize = 0;
+	mPendingSize = 0;
+}
+
+uint64_t RingAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+	if (size == 0 || size > mCapacity)
+		return InvalidOffset;
+
+	// Nothing alive, restart at the beginning to keep the free space contiguous
+	if (mUsedSize == 0 && mBatches.empty())
+	{
+		mHead = 0;
+		mTail = 0;
+	}
+
+	const uint64_t alignedHead = (mHead + alignment - 1) & ~(alignment - 1);
+	uint64_t offset = InvalidOffset;
+
+	if (mHead > mTail || (mHead == mTail && mUsedSize == 0))
+	{
+		// Free space is [head, capacity) followed by [0, tail)
+		if (alignedHead + size <= mCapacity)
+		{
+			offset = alignedHead;
+		}
+		else if (size <= mTail)
+		{
+			// Wrap around, the end of the ring is wasted until this batch retires
+			offset = 0;
+		}
+	}
+	else if (mHead < mTail)
+	{
+		if (alignedHead + size <= mTail)
+		{
+			offset = alignedHead;
+		}
+	}
+
+	if (offset == InvalidOffset)
+		return InvalidOffset;
+
+	const uint64_t consumed = (offset >= mHead ? offset - mHead : mCapacity - mHead) + size;
+	mHead = offset + size;
+	mUsedSize += consumed;
+	mPendingSize += consumed;
+
+	return offset;
+}
+
+void RingAllocator::FinishBatch(uint64_t fenceValue)
+{
+	if (mPendingSize == 0)
+		return;
+
+	mBatches.push_back({ fenceValue, mHead, mPendingSize });
+	mPendingSize = 0;
+}
+
+void RingAllocator::Retire(uint64_t completedFenceValue)
+{
+	while (!mBatches.empty() && mBatches.front().fenceValue <= completedFenceValue)
+	{
+		mTail = mBatches.front().end;
+		mUsedSize -= mBatches.front().size;
+		mBatches.pop_front();
+	}
+}
@@ -0,0 +1,236 @@
+#include "RootSignatureRegistry.h"
+#include "DXHelper.h"
+#include "Hasher.h"
+
+#include <fstream>
+
+namespace
+{
+	template <typename Range>
+	void AddRange(Hasher& hasher, const Range& range)
+	{
+		hasher.AddValue(range.RangeType);
+		hasher.AddValue(range.NumDescriptors);
+		hasher.AddValue(range.BaseShaderRegister);
+		hasher.AddValue(range.RegisterSpace);
+		hasher.AddValue(range.OffsetInDescriptorsFromTableStart);
+	}
+
+	void AddRangeFlags(Hasher&, const D3D12_DESCRIPTOR_RANGE&) {}
+	void AddRangeFlags(Hasher& hasher, const D3D12_DESCRIPTOR_RANGE1& range) { hasher.AddValue(range.Flags); }
+	void AddDescriptorFlags(Hasher&, const D3D12_ROOT_DESCRIPTOR&) {}
+	void AddDescriptorFlags(Hasher& hasher, const D3D12_ROOT_DESCRIPTOR1& descriptor) { hasher.AddValue(descriptor.Flags); }
+
+	// Field by field, the descriptions are full of pointers and padding
+	template <typename Desc>
+	void AddDesc(Hasher& hasher, const Desc& desc)
+	{
+		hasher.AddValue(desc.Flags);
+		hasher.AddValue(desc.NumParameters);
+		for (UINT i = 0; i < desc.NumParameters; i++)
+		{
+			const auto& parameter = desc.pParameters[i];
+			hasher.AddValue(parameter.ParameterType);
+			hasher.AddValue(parameter.ShaderVisibility);
+
+			switch (parameter.ParameterType)
+			{
+			case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
+				hasher.AddValue(parameter.DescriptorTable.NumDescriptorRanges);
+				for (UINT r = 0; r < parameter.DescriptorTable.NumDescriptorRanges; r++)
+				{
+					AddRange(hasher, parameter.DescriptorTable.pDescriptorRanges[r]);
+					AddRangeFlags(hasher, parameter.DescriptorTable.pDescriptorRanges[r]);
+				}
+				break;
+			case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
+				hasher.AddValue(parameter.Constants.ShaderRegister);
+				hasher.AddValue(parameter.Constants.RegisterSpace);
+				hasher.AddValue(parameter.Constants.Num32BitValues);
+				break;
+			default:
+				hasher.AddValue(parameter.Descriptor.ShaderRegister);
+				hasher.AddValue(parameter.Descriptor.RegisterSpace);
+				AddDescriptorFlags(hasher, parameter.Descriptor);
+				break;
+			}
+		}
+
+		// Only 4 byte members, no padding
+		hasher.AddValue(desc.NumStaticSamplers);
+		if (desc.NumStaticSamplers > 0)
+			hasher.Add(desc.pStaticSamplers, desc.NumStaticSamplers * sizeof(D3D12_STATIC_SAMPLER_DESC));
+	}
+}
+
+void RootSignatureRegistry::Init(ID3D12Device* pDevice, const std::wstring& path)
+{
+	mDevice = pDevice;
+	mPath = path;
+
+	D3D12_FEATURE_DATA_ROOT_SIGNATURE featureData = {};
+	featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
+	if (FAILED(mDevice->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &featureData, sizeof(featureData))))
+	{
+		featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
+	}
+	mHighestVersion = featureData.HighestVersion >= D3D_ROOT_SIGNATURE_VERSION_1_1 ? D3D_ROOT_SIGNATURE_VERSION_1_1 : D3D_ROOT_SIGNATURE_VERSION_1_0;
+
+	std::ifstream file(mPath, std::ios::binary | std::ios::ate);
+	if (file)
+	{
+		mFileData.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		if (!file.read(reinterpret_cast<char*>(mFileData.data()), mFileData.size()))
+			mFileData.clear();
+	}
+
+	std::vector<RootSignatureStoreFile::Entry> entries;
+	if (!RootSignatureStoreFile::Read(mFileData, entries))
+		mFileData.clear();
+
+	for (const RootSignatureStoreFile::Entry& entry : entries)
+	{
+		mBlobs[entry.key] = { entry.pBlob, static_cast<SIZE_T>(entry.blobSize) };
+	}
+}
+
+ComPtr<ID3D12RootSignature> RootSignatureRegistry::GetOrCreate(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC& desc, UINT64* pHash)
+{
+	if (desc.Version != D3D_ROOT_SIGNATURE_VERSION_1_0 && desc.Version != D3D_ROOT_SIGNATURE_VERSION_1_1)
+		ThrowIfFailed(E_INVALIDARG);
+
+	// 1.0 descriptions serialize as 1.0 whatever the device supports
+	const D3D_ROOT_SIGNATURE_VERSION version = desc.Version == D3D_ROOT_SIGNATURE_VERSION_1_0 ? D3D_ROOT_SIGNATURE_VERSION_1_0 : mHighestVersion;
+	const UINT64 hash = HashRootSignatureDesc(desc, version);
+	if (pHash)
+		*pHash = hash;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	ComPtr<ID3D12RootSignature>& rootSignature = mRootSignatures[hash];
+	if (rootSignature)
+		return rootSignature;
+
+	auto stored = mBlobs.find(hash);
+	if (stored != mBlobs.end() &&
+		SUCCEEDED(mDevice->CreateRootSignature(0, stored->second.pData, stored->second.size, IID_PPV_ARGS(&rootSignature))))
+		return rootSignature;
+
+	ComPtr<ID3DBlob> blob = Serialize(desc, version);
+	ThrowIfFailed(mDevice->CreateRootSignature(0, blob->GetBufferPointer(), blob->GetBufferSize(), IID_PPV_ARGS(&rootSignature)));
+
+	mBlobs[hash] = { blob->GetBufferPointer(), blob->GetBufferSize() };
+	mSerializedBlobs.push_back(std::move(blob));
+	mDirty = true;
+
+	return rootSignature;
+}
+
+void RootSignatureRegistry::Save()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if (!mDirty)
+		return;
+
+	std::vector<RootSignatureStoreFile::Entry> entries;
+	entries.reserve(mBlobs.size());
+	for (const auto& blob : mBlobs)
+	{
+		entries.push_back({ blob.first, static_cast<const uint8_t*>(blob.second.pData), blob.second.size });
+	}
+	const std::vector<uint8_t> data = RootSignatureStoreFile::Write(entries);
+
+	// Same as the pipeline cache, written aside and moved over the old file
+	const std::wstring tempPath = mPath + L".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.write(reinterpret_cast<const char*>(data.data()), data.size()))
+			return;
+	}
+
+	if (MoveFileExW(tempPath.c_str(), mPath.c_str(), MOVEFILE_REPLACE_EXISTING))
+		mDirty = false;
+	else
+		DeleteFileW(tempPath.c_str());
+}
+
+UINT64 RootSignatureRegistry::HashRootSignatureDesc(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC& desc, D3D_ROOT_SIGNATURE_VERSION serializedVersion)
+{
+	Hasher hasher;
+	hasher.AddValue(desc.Version);
+	hasher.AddValue(serializedVersion);
+	if (desc.Version == D3D_ROOT_SIGNATURE_VERSION_1_0)
+		AddDesc(hasher, desc.Desc_1_0);
+	else
+		AddDesc(hasher, desc.Desc_1_1);
+	return hasher.Get();
+}
+
+ComPtr<ID3DBlob> RootSignatureRegistry::Serialize(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC& desc, D3D_ROOT_SIGNATURE_VERSION version)
+{
+	ComPtr<ID3DBlob> blob;
+	ComPtr<ID3DBlob> error;
+
+	if (version == D3D_ROOT_SIGNATURE_VERSION_1_1)
+	{
+		ThrowIfFailed(D3D12SerializeVersionedRootSignature(&desc, &blob, &error));
+	}
+	else
+	{
+		const D3D12_ROOT_SIGNATURE_DESC& desc_1_0 = desc.Version == D3D_ROOT_SIGNATURE_VERSION_1_0 ? desc.Desc_1_0 : ConvertTo_1_0(desc.Desc_1_1);
+		const HRESULT hr = D3D12SerializeRootSignature(&desc_1_0, D3D_ROOT_SIGNATURE_VERSION_1_0, &blob, &error);
+		mArena.Reset();
+		ThrowIfFailed(hr);
+	}
+	return blob;
+}
+
+// Drops the 1.1 flags. Everything lands in mArena, valid until the next reset.
+const D3D12_ROOT_SIGNATURE_DESC& RootSignatureRegistry::ConvertTo_1_0(const D3D12_ROOT_SIGNATURE_DESC1& desc)
+{
+	D3D12_ROOT_PARAMETER* pParameters = mArena.Allocate<D3D12_ROOT_PARAMETER>(desc.NumParameters);
+	for (UINT i = 0; i < desc.NumParameters; i++)
+	{
+		const D3D12_ROOT_PARAMETER1& source = desc.pParameters[i];
+		D3D12_ROOT_PARAMETER& parameter = pParameters[i];
+		parameter.ParameterType = source.ParameterType;
+		parameter.ShaderVisibility = source.ShaderVisibility;
+
+		switch (source.ParameterType)
+		{
+		case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
+		{
+			const UINT rangeCount = source.DescriptorTable.NumDescriptorRanges;
+			D3D12_DESCRIPTOR_RANGE* pRanges = mArena.Allocate<D3D12_DESCRIPTOR_RANGE>(rangeCount);
+			for (UINT r = 0; r < rangeCount; r++)
+			{
+				const D3D12_DESCRIPTOR_RANGE1& range = source.DescriptorTable.pDescriptorRanges[r];
+				pRanges[r].RangeType = range.RangeType;
+				pRanges[r].NumDescriptors = range.NumDescriptors;
+				pRanges[r].BaseShaderRegister = range.BaseShaderRegister;
+				pRanges[r].RegisterSpace = range.RegisterSpace;
+				pRanges[r].OffsetInDescriptorsFromTableStart = range.OffsetInDescriptorsFromTableStart;
+			}
+			parameter.DescriptorTable.NumDescriptorRanges = rangeCount;
+			parameter.DescriptorTable.pDescriptorRanges = pRanges;
+			break;
+		}
+		case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
+			parameter.Constants = source.Constants;
+			break;
+		default:
+			parameter.Descriptor.ShaderRegister = source.Descriptor.ShaderRegister;
+			parameter.Descriptor.RegisterSpace = source.Descriptor.RegisterSpace;
+			break;
+		}
+	}
+
+	mConvertedDesc.NumParameters = desc.NumParameters;
+	mConvertedDesc.pParameters = pParameters;
+	mConvertedDesc.NumStaticSamplers = desc.NumStaticSamplers;
+	mConvertedDesc.pStaticSamplers = desc.pStaticSamplers;
+	mConvertedDesc.Flags = desc.Flags;
+	return mConvertedDesc;
+}
@@ -0,0 +1,84 @@
+#include "RootSignatureStoreFile.h"
+#include "Hasher.h"
+
+#include <cstring>
+
+namespace
+{
+	uint64_t HashBlob(const void* pBlob, uint64_t blobSize)
+	{
+		Hasher hasher;
+		hasher.Add(pBlob, static_cast<size_t>(blobSize));
+		return hasher.Get();
+	}
+}
+
+std::vector<uint8_t> RootSignatureStoreFile::Write(const std::vector<Entry>& entries)
+{
+	Header header = {};
+	header.magic = Magic;
+	header.version = Version;
+	header.entryCount = entries.size();
+
+	size_t size = sizeof(Header) + entries.size() * sizeof(FileEntry);
+	for (const Entry& entry : entries)
+	{
+		size += static_cast<size_t>(entry.blobSize);
+	}
+
+	std::vector<uint8_t> data(size);
+	memcpy(data.data(), &header, sizeof(header));
+
+	uint64_t offset = sizeof(Header) + entries.size() * sizeof(FileEntry);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const Entry& entry = entries[i];
+
+		FileEntry fileEntry = {};
+		fileEntry.key = entry.key;
+		fileEntry.offset = offset;
+		fileEntry.blobSize = entry.blobSize;
+		fileEntry.blobHash = HashBlob(entry.pBlob, entry.blobSize);
+		memcpy(data.data() + sizeof(Header) + i * sizeof(FileEntry), &fileEntry, sizeof(fileEntry));
+
+		if (entry.blobSize > 0)
+			memcpy(data.data() + offset, entry.pBlob, static_cast<size_t>(entry.blobSize));
+		offset += entry.blobSize;
+	}
+	return data;
+}
+
+bool RootSignatureStoreFile::Read(const std::vector<uint8_t>& data, std::vector<Entry>& entries)
+{
+	entries.clear();
+
+	if (data.size() < sizeof(Header))
+		return false;
+
+	Header header;
+	memcpy(&header, data.data(), sizeof(header));
+
+	if (header.magic != Magic || header.version != Version)
+		return false;
+
+	if (header.entryCount > (data.size() - sizeof(Header)) / sizeof(FileEntry))
+		return false;
+
+	entries.reserve(static_cast<size_t>(header.entryCount));
+	for (uint64_t i = 0; i < header.entryCount; i++)
+	{
+		FileEntry fileEntry;
+		memcpy(&fileEntry, data.data() + sizeof(Header) + i * sizeof(FileEntry), sizeof(fileEntry));
+
+		if (fileEntry.offset > data.size() || fileEntry.blobSize > data.size() - fileEntry.offset)
+			continue;
+
+		const uint8_t* pBlob = data.data() + fileEntry.offset;
+		// A torn write must not reach the runtime
+		if (HashBlob(pBlob, fileEntry.blobSize) != fileEntry.blobHash)
+			continue;
+
+		entries.push_back({ fileEntry.key, pBlob, fileEntry.blobSize });
+	}
+	return true;
+}
@@ -0,0 +1,45 @@
+#include "ShaderArchive.h"
+
+#include <cstring>
+
+bool ShaderArchive::Parse(const void* pData, size_t size)
+{
+	mShaders.clear();
+
+	const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+	if (size < sizeof(Header))
+		return false;
+
+	Header header;
+	memcpy(&header, pBytes, sizeof(header));
+	if (header.magic != Magic || header.version != Version)
+		return false;
+
+	if (header.entryCount > (size - sizeof(Header)) / sizeof(Entry))
+		return false;
+
+	for (uint32_t n = 0; n < header.entryCount; n++)
+	{
+		Entry entry;
+		memcpy(&entry, pBytes + sizeof(Header) + n * sizeof(Entry), sizeof(entry));
+
+		// Bounds checked without overflowing, the file comes from disk
+		if (entry.nameOffset > size || entry.nameLength > size - entry.nameOffset ||
+			entry.dataOffset > size || entry.dataSize > size - entry.dataOffset)
+		{
+			mShaders.clear();
+			return false;
+		}
+
+		std::string name(reinterpret_cast<const char*>(pBytes + entry.nameOffset), entry.nameLength);
+		mShaders[name] = { pBytes + entry.dataOffset, entry.dataSize, entry.hash };
+	}
+
+	return true;
+}
+
+const ShaderArchive::Shader* ShaderArchive::Find(const std::string& name) const
+{
+	auto it = mShaders.find(name);
+	return it != mShaders.end() ? &it->second : nullptr;
+}
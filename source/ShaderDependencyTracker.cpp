@@ -0,0 +1,149 @@
+#include "ShaderDependencyTracker.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	bool ReadFileFromDisk(const std::filesystem::path& path, std::string& contents)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+
+		std::ostringstream stream;
+		stream << file.rdbuf();
+		contents = stream.str();
+		return true;
+	}
+
+	// Names in #include "name" and #include <name>, comments are not stripped
+	std::vector<std::string> FindIncludes(const std::string& contents)
+	{
+		std::vector<std::string> includes;
+		std::istringstream lines(contents);
+		std::string line;
+		while (std::getline(lines, line))
+		{
+			size_t pos = line.find_first_not_of(" \t");
+			if (pos == std::string::npos || line[pos] != '#')
+				continue;
+
+			pos = line.find_first_not_of(" \t", pos + 1);
+			if (pos == std::string::npos || line.compare(pos, 7, "include") != 0)
+				continue;
+
+			pos = line.find_first_of("\"<", pos + 7);
+			if (pos == std::string::npos)
+				continue;
+
+			const size_t end = line.find(line[pos] == '"' ? '"' : '>', pos + 1);
+			if (end != std::string::npos)
+				includes.push_back(line.substr(pos + 1, end - pos - 1));
+		}
+		return includes;
+	}
+}
+
+ShaderDependencyTracker::ShaderDependencyTracker(std::vector<std::filesystem::path> includeDirs, ReadFileFunc readFile)
+	: mIncludeDirs(std::move(includeDirs)), mReadFile(readFile ? std::move(readFile) : ReadFileFromDisk)
+{
+}
+
+void ShaderDependencyTracker::AddShader(const std::string& name, const std::filesystem::path& sourcePath)
+{
+	const std::filesystem::path path = Normalize(sourcePath);
+	mShaders[name] = path;
+
+	std::set<std::filesystem::path> visited;
+	Scan(path, visited);
+}
+
+std::vector<std::string> ShaderDependencyTracker::OnFileChanged(const std::filesystem::path& changedPath)
+{
+	const std::filesystem::path path = Normalize(changedPath);
+
+	// Its includes may have changed too, files it pulls in for the first time get scanned as well
+	std::set<std::filesystem::path> visited;
+	mIncludes.erase(path);
+	Scan(path, visited);
+
+	std::vector<std::string> affected;
+	for (const auto& shader : mShaders)
+	{
+		if (GetDependencies(shader.first).count(path) > 0)
+			affected.push_back(shader.first);
+	}
+	return affected;
+}
+
+std::set<std::filesystem::path> ShaderDependencyTracker::GetDependencies(const std::string& name) const
+{
+	std::set<std::filesystem::path> dependencies;
+
+	auto shader = mShaders.find(name);
+	if (shader == mShaders.end())
+		return dependencies;
+
+	std::vector<std::filesystem::path> stack = { shader->second };
+	while (!stack.empty())
+	{
+		const std::filesystem::path path = stack.back();
+		stack.pop_back();
+		if (!dependencies.insert(path).second)
+			continue;
+
+		auto includes = mIncludes.find(path);
+		if (includes != mIncludes.end())
+			stack.insert(stack.end(), includes->second.begin(), includes->second.end());
+	}
+	return dependencies;
+}
+
+std::filesystem::path ShaderDependencyTracker::Normalize(const std::filesystem::path& path)
+{
+	return std::filesystem::absolute(path).lexically_normal();
+}
+
+void ShaderDependencyTracker::Scan(const std::filesystem::path& path, std::set<std::filesystem::path>& visited)
+{
+	if (!visited.insert(path).second)
+		return;
+
+	// Already known and unchanged
+	if (mIncludes.count(path) > 0)
+		return;
+
+	std::string contents;
+	std::vector<std::filesystem::path>& includes = mIncludes[path];
+	if (!mReadFile(path, contents))
+		return;
+
+	for (const std::string& include : FindIncludes(contents))
+	{
+		std::filesystem::path resolved = ResolveInclude(include, path);
+		if (resolved.empty())
+			continue;
+
+		includes.push_back(resolved);
+		Scan(resolved, visited);
+	}
+}
+
+std::filesystem::path ShaderDependencyTracker::ResolveInclude(const std::string& include, const std::filesystem::path& includingFile) const
+{
+	std::string contents;
+	const std::filesystem::path local = Normalize(includingFile.parent_path() / include);
+	if (std::filesystem::exists(local) || mReadFile(local, contents))
+		return local;
+
+	for (const std::filesystem::path& directory : mIncludeDirs)
+	{
+		const std::filesystem::path candidate = Normalize(directory / include);
+		if (std::filesystem::exists(candidate) || mReadFile(candidate, contents))
+			return candidate;
+	}
+
+	// Unresolved, the compiler reports it
+	return std::filesystem::path();
+}
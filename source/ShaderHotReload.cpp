@@ -0,0 +1,171 @@
+#include "ShaderHotReload.h"
+#include "DXHelper.h"
+
+#include <algorithm>
+#include <fstream>
+
+ShaderHotReload::~ShaderHotReload()
+{
+	Stop();
+}
+
+void ShaderHotReload::RegisterPipeline(ComPtr<ID3D12PipelineState>* pPipelineState, std::vector<std::string> shaders, PipelineFactory factory)
+{
+	mPipelines.push_back({ pPipelineState, std::move(shaders), std::move(factory) });
+}
+
+bool ShaderHotReload::Start(const std::wstring& rootPath, const std::wstring& archivePath)
+{
+	Stop();
+
+	mRootPath = std::filesystem::absolute(rootPath).lexically_normal();
+	LoadCompilerCommand(archivePath);
+	const std::filesystem::path shaderPath = mRootPath / L"Assets" / L"Shaders";
+
+	mTracker = std::make_unique<ShaderDependencyTracker>();
+	for (const Pipeline& pipeline : mPipelines)
+	{
+		for (const std::string& shader : pipeline.shaders)
+		{
+			mTracker->AddShader(shader, shaderPath / shader.substr(0, shader.find(':')));
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mReady.assign(mPipelines.size(), nullptr);
+	}
+
+	mScheduler = std::make_unique<ShaderReloadScheduler>([this](const std::vector<std::string>& shaders) { Rebuild(shaders); });
+	if (!mWatcher.Start(shaderPath, [this](const std::filesystem::path& path) { OnFileChanged(path); }))
+	{
+		mScheduler.reset();
+		return false;
+	}
+	return true;
+}
+
+void ShaderHotReload::Stop()
+{
+	// Watcher first, it feeds the scheduler
+	mWatcher.Stop();
+	mScheduler.reset();
+	mTracker.reset();
+}
+
+void ShaderHotReload::Update(UINT64 lastSubmittedFenceValue)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	for (size_t i = 0; i < mReady.size(); i++)
+	{
+		if (mReady[i] == nullptr)
+			continue;
+
+		ComPtr<ID3D12PipelineState>& current = *mPipelines[i].pPipelineState;
+		mRetired.push_back({ std::move(current), lastSubmittedFenceValue });
+		current = std::move(mReady[i]);
+	}
+}
+
+void ShaderHotReload::Retire(UINT64 completedFenceValue)
+{
+	mRetired.erase(std::remove_if(mRetired.begin(), mRetired.end(),
+		[completedFenceValue](const RetiredPipeline& retired) { return retired.fenceValue <= completedFenceValue; }), mRetired.end());
+}
+
+void ShaderHotReload::OnFileChanged(const std::filesystem::path& path)
+{
+	mScheduler->Request(mTracker->OnFileChanged(path));
+}
+
+// Scheduler thread
+void ShaderHotReload::Rebuild(const std::vector<std::string>& shaders)
+{
+	// Every shader of an affected pipeline goes into the archive, the factory needs all of them
+	std::vector<size_t> pipelines;
+	std::vector<std::string> compileShaders;
+	for (size_t i = 0; i < mPipelines.size(); i++)
+	{
+		const std::vector<std::string>& pipelineShaders = mPipelines[i].shaders;
+		const bool affected = std::any_of(pipelineShaders.begin(), pipelineShaders.end(),
+			[&shaders](const std::string& shader) { return std::binary_search(shaders.begin(), shaders.end(), shader); });
+		if (affected)
+		{
+			pipelines.push_back(i);
+			compileShaders.insert(compileShaders.end(), pipelineShaders.begin(), pipelineShaders.end());
+		}
+	}
+	if (pipelines.empty())
+		return;
+
+	std::sort(compileShaders.begin(), compileShaders.end());
+	compileShaders.erase(std::unique(compileShaders.begin(), compileShaders.end()), compileShaders.end());
+
+	const std::wstring outputPath = (mRootPath / L".shadercache" / L"HotReload.dxsl").wstring();
+	if (!RunCompiler(compileShaders, outputPath))
+		return;
+
+	ShaderLibrary library;
+	library.Open(outputPath);
+
+	for (size_t i : pipelines)
+	{
+		ComPtr<ID3D12PipelineState> pipelineState = mPipelines[i].factory(library);
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		mReady[i] = std::move(pipelineState);
+	}
+}
+
+// compile_shaders.py writes <archive>.args on a full build: the interpreter, then one argument per line, UTF-8.
+// Without it, the flags the pre-build step passes for this configuration.
+void ShaderHotReload::LoadCompilerCommand(const std::filesystem::path& archivePath)
+{
+	mCompilerCommand.clear();
+
+	std::ifstream file(archivePath.wstring() + L".args");
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		std::wstring argument(MultiByteToWideChar(CP_UTF8, 0, line.data(), static_cast<int>(line.size()), nullptr, 0), L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, line.data(), static_cast<int>(line.size()), argument.data(), static_cast<int>(argument.size()));
+		mCompilerCommand.push_back(std::move(argument));
+	}
+	if (mCompilerCommand.size() >= 2)
+		return;
+
+	mCompilerCommand = { L"python", (mRootPath / L"tools" / L"compile_shaders.py").wstring(),
+		L"--manifest", (mRootPath / L"Assets" / L"Shaders" / L"Shaders.json").wstring() };
+#ifdef _DEBUG
+	mCompilerCommand.push_back(L"--debug");
+#endif
+}
+
+// Compile errors are printed by the tool on the inherited console
+bool ShaderHotReload::RunCompiler(const std::vector<std::string>& shaders, const std::wstring& outputPath)
+{
+	std::wstring commandLine;
+	for (const std::wstring& argument : mCompilerCommand)
+	{
+		commandLine += (commandLine.empty() ? L"\"" : L" \"") + argument + L"\"";
+	}
+	commandLine += L" --output \"" + outputPath + L"\"";
+	for (const std::string& shader : shaders)
+	{
+		commandLine += L" --only \"" + std::wstring(shader.begin(), shader.end()) + L"\"";
+	}
+
+	STARTUPINFOW startupInfo = { sizeof(startupInfo) };
+	PROCESS_INFORMATION processInfo = {};
+	if (!CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, FALSE, 0, nullptr, mRootPath.c_str(), &startupInfo, &processInfo))
+		return false;
+
+	WaitForSingleObject(processInfo.hProcess, INFINITE);
+	DWORD exitCode = 1;
+	GetExitCodeProcess(processInfo.hProcess, &exitCode);
+	CloseHandle(processInfo.hThread);
+	CloseHandle(processInfo.hProcess);
+	return exitCode == 0;
+}
@@ -0,0 +1,56 @@
+#include "ShaderLibrary.h"
+#include "DXHelper.h"
+
+ShaderLibrary::~ShaderLibrary()
+{
+	Close();
+}
+
+void ShaderLibrary::Open(const std::wstring& path)
+{
+	Close();
+
+	mFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (mFile == INVALID_HANDLE_VALUE)
+		ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(mFile, &size))
+		ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+
+	mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mMapping == nullptr)
+		ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+
+	mpView = MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+	if (mpView == nullptr)
+		ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+
+	if (!mArchive.Parse(mpView, static_cast<size_t>(size.QuadPart)))
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+}
+
+void ShaderLibrary::Close()
+{
+	mArchive = ShaderArchive();
+
+	if (mpView)
+		UnmapViewOfFile(mpView);
+	if (mMapping)
+		CloseHandle(mMapping);
+	if (mFile != INVALID_HANDLE_VALUE)
+		CloseHandle(mFile);
+
+	mpView = nullptr;
+	mMapping = nullptr;
+	mFile = INVALID_HANDLE_VALUE;
+}
+
+D3D12_SHADER_BYTECODE ShaderLibrary::GetBytecode(const std::string& name) const
+{
+	const ShaderArchive::Shader* pShader = mArchive.Find(name);
+	if (pShader == nullptr)
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_NOT_FOUND));
+
+	return CD3DX12_SHADER_BYTECODE(pShader->pData, static_cast<SIZE_T>(pShader->size));
+}
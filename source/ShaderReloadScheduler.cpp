@@ -0,0 +1,91 @@
+#include "ShaderReloadScheduler.h"
+
+ShaderReloadScheduler::ShaderReloadScheduler(CompileFunc compile, std::chrono::milliseconds debounce)
+	: mCompile(std::move(compile)), mDebounce(debounce)
+{
+	mThread = std::thread(&ShaderReloadScheduler::ThreadMain, this);
+}
+
+ShaderReloadScheduler::~ShaderReloadScheduler()
+{
+	Stop();
+}
+
+void ShaderReloadScheduler::Request(const std::vector<std::string>& shaders)
+{
+	if (shaders.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mPending.insert(shaders.begin(), shaders.end());
+		mLastRequest = std::chrono::steady_clock::now();
+	}
+	mRequestCondition.notify_one();
+}
+
+void ShaderReloadScheduler::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mIdleCondition.wait(lock, [this] { return mStop || (mPending.empty() && !mCompiling); });
+}
+
+void ShaderReloadScheduler::Stop()
+{
+	if (!mThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+		mPending.clear();
+	}
+	mRequestCondition.notify_all();
+	mThread.join();
+	mIdleCondition.notify_all();
+}
+
+uint64_t ShaderReloadScheduler::GetCompileCount() const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mCompileCount;
+}
+
+void ShaderReloadScheduler::ThreadMain()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	for (;;)
+	{
+		mRequestCondition.wait(lock, [this] { return mStop || !mPending.empty(); });
+		if (mStop)
+			return;
+
+		// Every new request pushes the deadline back
+		while (!mStop && std::chrono::steady_clock::now() < mLastRequest + mDebounce)
+		{
+			mRequestCondition.wait_until(lock, mLastRequest + mDebounce);
+		}
+		if (mStop)
+			return;
+
+		const std::vector<std::string> shaders(mPending.begin(), mPending.end());
+		mPending.clear();
+		mCompiling = true;
+
+		lock.unlock();
+		// Failures are the compile function's business, a broken shader must not stop later reloads
+		try
+		{
+			mCompile(shaders);
+		}
+		catch (...)
+		{
+		}
+		lock.lock();
+
+		mCompiling = false;
+		mCompileCount++;
+		if (mPending.empty())
+			mIdleCondition.notify_all();
+	}
+}
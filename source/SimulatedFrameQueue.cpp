@@ -0,0 +1,66 @@
+#include "SimulatedFrameQueue.h"
+
+#include <algorithm>
+
+SimulatedFrameQueue::SimulatedFrameQueue()
+	:
+	mTime(0.0),
+	mGpuTime(0.0),
+	mCompletedValue(0),
+	mStallCount(0),
+	mStallTime(0.0)
+{
+}
+
+void SimulatedFrameQueue::Execute(double gpuTime)
+{
+	// An idle GPU starts on the work as soon as it arrives
+	mGpuTime = std::max(mGpuTime, mTime) + gpuTime;
+}
+
+void SimulatedFrameQueue::Advance(double cpuTime)
+{
+	mTime += cpuTime;
+	Update();
+}
+
+void SimulatedFrameQueue::Signal(uint64_t fenceValue)
+{
+	mPending.push_back({ fenceValue, std::max(mGpuTime, mTime) });
+	Update();
+}
+
+uint64_t SimulatedFrameQueue::GetCompletedValue()
+{
+	Update();
+	return mCompletedValue;
+}
+
+void SimulatedFrameQueue::Wait(uint64_t fenceValue)
+{
+	Update();
+	if (mCompletedValue >= fenceValue)
+		return;
+
+	// Signals that were never queued would block forever on a real fence
+	const auto it = std::find_if(mPending.begin(), mPending.end(), [fenceValue](const PendingSignal& signal)
+	{
+		return signal.fenceValue >= fenceValue;
+	});
+	if (it == mPending.end())
+		return;
+
+	mStallCount++;
+	mStallTime += it->time - mTime;
+	mTime = it->time;
+	Update();
+}
+
+void SimulatedFrameQueue::Update()
+{
+	while (!mPending.empty() && mPending.front().time <= mTime)
+	{
+		mCompletedValue = std::max(mCompletedValue, mPending.front().fenceValue);
+		mPending.pop_front();
+	}
+}
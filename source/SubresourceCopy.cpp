@@ -0,0 +1,148 @@
+#include "SubresourceCopy.h"
+#include "SubresourceCopyKernels.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define SUBRESOURCE_COPY_X64 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// Contiguous buffers are cut into rows of this size so they can be split like textures
+	const size_t BufferRowSize = 64 * 1024;
+
+	typedef void (*CopyRowFunc)(void* pDest, const void* pSource, size_t size);
+
+	void CopyRowScalar(void* pDest, const void* pSource, size_t size)
+	{
+		memcpy(pDest, pSource, size);
+	}
+
+	CopyRowFunc SelectCopyRow(const SubresourceCopy::Settings& settings)
+	{
+#ifdef SUBRESOURCE_COPY_X64
+		if (settings.streaming && settings.allowAvx2 && CpuFeatures::HasAvx2())
+			return StreamCopyAvx2;
+#else
+		(void)settings;
+#endif
+		return CopyRowScalar;
+	}
+
+	// Rows [firstRow, firstRow + rowCount) of one slice of one copy
+	struct RowBand
+	{
+		unsigned int copy;
+		unsigned int slice;
+		unsigned int firstRow;
+		unsigned int rowCount;
+	};
+
+	void CopyBand(CopyRowFunc copyRow, const SubresourceCopyDesc& copy, unsigned int slice, unsigned int firstRow, unsigned int rowCount)
+	{
+		uint8_t* pDest = static_cast<uint8_t*>(copy.pDest) + copy.destSlicePitch * slice + copy.destRowPitch * firstRow;
+		const uint8_t* pSource = static_cast<const uint8_t*>(copy.pSource) + copy.sourceSlicePitch * slice + copy.sourceRowPitch * firstRow;
+
+		// Tightly packed rows are one run
+		if (copy.destRowPitch == copy.rowSize && copy.sourceRowPitch == copy.rowSize)
+		{
+			copyRow(pDest, pSource, copy.rowSize * rowCount);
+			return;
+		}
+
+		for (unsigned int row = 0; row < rowCount; row++)
+		{
+			copyRow(pDest, pSource, copy.rowSize);
+			pDest += copy.destRowPitch;
+			pSource += copy.sourceRowPitch;
+		}
+	}
+
+	void FinishStores(CopyRowFunc copyRow)
+	{
+		// Streaming stores are weakly ordered, drain them before the job counts as done
+#ifdef SUBRESOURCE_COPY_X64
+		if (copyRow != CopyRowScalar)
+			_mm_sfence();
+#else
+		(void)copyRow;
+#endif
+	}
+}
+
+void SubresourceCopy::Copy(const Settings& settings, const SubresourceCopyDesc* pCopies, unsigned int count, JobSystem* pJobSystem)
+{
+	const CopyRowFunc copyRow = SelectCopyRow(settings);
+
+	size_t totalSize = 0;
+	for (unsigned int n = 0; n < count; n++)
+	{
+		totalSize += pCopies[n].rowSize * pCopies[n].rowCount * pCopies[n].sliceCount;
+	}
+
+	if (pJobSystem == nullptr || pJobSystem->GetThreadCount() < 2 || totalSize < MinParallelSize)
+	{
+		for (unsigned int n = 0; n < count; n++)
+		{
+			for (unsigned int slice = 0; slice < pCopies[n].sliceCount; slice++)
+			{
+				CopyBand(copyRow, pCopies[n], slice, 0, pCopies[n].rowCount);
+			}
+		}
+		FinishStores(copyRow);
+		return;
+	}
+
+	// Bands never cross a slice, small slices just make small jobs
+	std::vector<RowBand> bands;
+	for (unsigned int n = 0; n < count; n++)
+	{
+		const SubresourceCopyDesc& copy = pCopies[n];
+		if (copy.rowSize == 0)
+			continue;
+
+		const unsigned int rowsPerBand = static_cast<unsigned int>(std::max<size_t>(BytesPerJob / copy.rowSize, 1));
+		for (unsigned int slice = 0; slice < copy.sliceCount; slice++)
+		{
+			for (unsigned int row = 0; row < copy.rowCount; row += rowsPerBand)
+			{
+				bands.push_back({ n, slice, row, std::min(rowsPerBand, copy.rowCount - row) });
+			}
+		}
+	}
+
+	pJobSystem->ParallelFor(static_cast<unsigned int>(bands.size()), [&](unsigned int index, unsigned int)
+	{
+		const RowBand& band = bands[index];
+		CopyBand(copyRow, pCopies[band.copy], band.slice, band.firstRow, band.rowCount);
+		FinishStores(copyRow);
+	});
+}
+
+void SubresourceCopy::CopyBuffer(const Settings& settings, void* pDest, const void* pSource, size_t size, JobSystem* pJobSystem)
+{
+	const size_t rowCount = size / BufferRowSize;
+	const size_t remainder = size - rowCount * BufferRowSize;
+
+	SubresourceCopyDesc copies[2];
+	unsigned int count = 0;
+	if (rowCount > 0)
+	{
+		copies[count++] = { pDest, BufferRowSize, size, pSource, BufferRowSize, size, BufferRowSize, static_cast<unsigned int>(rowCount), 1 };
+	}
+	if (remainder > 0)
+	{
+		const size_t offset = rowCount * BufferRowSize;
+		copies[count++] = { static_cast<uint8_t*>(pDest) + offset, remainder, remainder,
+			static_cast<const uint8_t*>(pSource) + offset, remainder, remainder, remainder, 1, 1 };
+	}
+
+	Copy(settings, copies, count, pJobSystem);
+}
@@ -0,0 +1,49 @@
+#include "SubresourceCopyKernels.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+#include <immintrin.h>
+
+#include <cstdint>
+#include <cstring>
+
+void StreamCopyAvx2(void* pDest, const void* pSource, size_t size)
+{
+	uint8_t* pDestBytes = static_cast<uint8_t*>(pDest);
+	const uint8_t* pSourceBytes = static_cast<const uint8_t*>(pSource);
+
+	// Stream stores need an aligned destination, the source is loaded unaligned
+	size_t head = (32 - (reinterpret_cast<uintptr_t>(pDestBytes) & 31)) & 31;
+	if (head > size)
+		head = size;
+	memcpy(pDestBytes, pSourceBytes, head);
+	pDestBytes += head;
+	pSourceBytes += head;
+	size -= head;
+
+	// Two full cache lines per iteration so write combining buffers flush whole
+	for (; size >= 128; size -= 128)
+	{
+		const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSourceBytes));
+		const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSourceBytes + 32));
+		const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSourceBytes + 64));
+		const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSourceBytes + 96));
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(pDestBytes), a);
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(pDestBytes + 32), b);
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(pDestBytes + 64), c);
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(pDestBytes + 96), d);
+		pDestBytes += 128;
+		pSourceBytes += 128;
+	}
+
+	for (; size >= 32; size -= 32)
+	{
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(pDestBytes), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSourceBytes)));
+		pDestBytes += 32;
+		pSourceBytes += 32;
+	}
+
+	memcpy(pDestBytes, pSourceBytes, size);
+}
+
+#endif
@@ -0,0 +1,62 @@
+#include "SubresourceUpload.h"
+
+UINT64 UpdateSubresourcesParallel(ID3D12GraphicsCommandList* pCmdList, ID3D12Resource* pDestinationResource, ID3D12Resource* pIntermediate,
+	UINT64 intermediateOffset, UINT firstSubresource, UINT numSubresources, const D3D12_SUBRESOURCE_DATA* pSrcData,
+	JobSystem* pJobSystem, const SubresourceCopy::Settings& settings)
+{
+	const D3D12_RESOURCE_DESC destinationDesc = pDestinationResource->GetDesc();
+	const D3D12_RESOURCE_DESC intermediateDesc = pIntermediate->GetDesc();
+
+	ComPtr<ID3D12Device> device;
+	if (FAILED(pDestinationResource->GetDevice(IID_PPV_ARGS(&device))))
+		return 0;
+
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubresources);
+	std::vector<UINT> rowCounts(numSubresources);
+	std::vector<UINT64> rowSizes(numSubresources);
+	UINT64 requiredSize = 0;
+	device->GetCopyableFootprints(&destinationDesc, firstSubresource, numSubresources, intermediateOffset,
+		layouts.data(), rowCounts.data(), rowSizes.data(), &requiredSize);
+
+	// Same validation as the stock helper
+	if (numSubresources == 0 ||
+		intermediateDesc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER ||
+		intermediateDesc.Width < requiredSize + layouts[0].Offset ||
+		requiredSize > SIZE_T(-1) ||
+		(destinationDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER && (firstSubresource != 0 || numSubresources != 1)))
+	{
+		return 0;
+	}
+
+	UINT8* pData;
+	if (FAILED(pIntermediate->Map(0, nullptr, reinterpret_cast<void**>(&pData))))
+		return 0;
+
+	std::vector<SubresourceCopyDesc> copies(numSubresources);
+	for (UINT i = 0; i < numSubresources; i++)
+	{
+		const D3D12_SUBRESOURCE_FOOTPRINT& footprint = layouts[i].Footprint;
+		const SIZE_T destSlicePitch = SIZE_T(footprint.RowPitch) * SIZE_T(rowCounts[i]);
+		copies[i] = { pData + layouts[i].Offset, footprint.RowPitch, destSlicePitch,
+			pSrcData[i].pData, static_cast<size_t>(pSrcData[i].RowPitch), static_cast<size_t>(pSrcData[i].SlicePitch),
+			static_cast<size_t>(rowSizes[i]), rowCounts[i], footprint.Depth };
+	}
+	SubresourceCopy::Copy(settings, copies.data(), numSubresources, pJobSystem);
+	pIntermediate->Unmap(0, nullptr);
+
+	if (destinationDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+	{
+		pCmdList->CopyBufferRegion(pDestinationResource, 0, pIntermediate, layouts[0].Offset, layouts[0].Footprint.Width);
+	}
+	else
+	{
+		for (UINT i = 0; i < numSubresources; i++)
+		{
+			const CD3DX12_TEXTURE_COPY_LOCATION dest(pDestinationResource, i + firstSubresource);
+			const CD3DX12_TEXTURE_COPY_LOCATION source(pIntermediate, layouts[i]);
+			pCmdList->CopyTextureRegion(&dest, 0, 0, 0, &source, nullptr);
+		}
+	}
+
+	return requiredSize;
+}
@@ -0,0 +1,330 @@
+#include "TlsfAllocator.h"
+
+#include <bit>
+
+namespace
+{
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	uint32_t Log2(uint64_t value)
+	{
+		return 63 - static_cast<uint32_t>(std::countl_zero(value));
+	}
+}
+
+TlsfAllocator::TlsfAllocator(uint64_t size)
+{
+	Reset(size);
+}
+
+void TlsfAllocator::Reset(uint64_t size)
+{
+	mBlocks.clear();
+	mUnusedBlocks.clear();
+	mFlBitmap = 0;
+	for (uint32_t fl = 0; fl < FlCount; fl++)
+	{
+		mSlBitmap[fl] = 0;
+		for (uint32_t sl = 0; sl < SlCount; sl++)
+		{
+			mFreeHeads[fl][sl] = InvalidHandle;
+		}
+	}
+
+	mSize = size;
+	mUsedSize = 0;
+	mAllocationCount = 0;
+	mFirstBlock = InvalidHandle;
+
+	if (size == 0)
+		return;
+
+	// One free block spanning the whole range
+	mFirstBlock = NewBlock();
+	Block& block = mBlocks[mFirstBlock];
+	block.offset = 0;
+	block.size = size;
+	block.prevPhysical = InvalidHandle;
+	block.nextPhysical = InvalidHandle;
+	InsertFree(mFirstBlock);
+}
+
+TlsfAllocator::Handle TlsfAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+	if (size == 0 || size > mSize)
+		return InvalidHandle;
+
+	// Most free blocks start aligned already, only pay for the worst case padding when they don't
+	Handle handle = FindFreeBlock(size);
+	if (handle == InvalidHandle || !Fits(handle, size, alignment))
+	{
+		handle = alignment > 1 ? FindFreeBlock(size + alignment - 1) : InvalidHandle;
+		if (handle == InvalidHandle || !Fits(handle, size, alignment))
+			return InvalidHandle;
+	}
+
+	RemoveFree(handle);
+
+	// Leading padding goes back to the free lists, or to the previous block when that one is free
+	const uint64_t padding = AlignUp(mBlocks[handle].offset, alignment) - mBlocks[handle].offset;
+	if (padding > 0)
+	{
+		const Handle prev = mBlocks[handle].prevPhysical;
+		if (prev != InvalidHandle && mBlocks[prev].isFree)
+		{
+			RemoveFree(prev);
+			mBlocks[prev].size += padding;
+			InsertFree(prev);
+		}
+		else
+		{
+			const Handle paddingBlock = NewBlock();
+			Block& block = mBlocks[handle];
+			Block& pad = mBlocks[paddingBlock];
+			pad.offset = block.offset;
+			pad.size = padding;
+			pad.prevPhysical = prev;
+			pad.nextPhysical = handle;
+			if (prev != InvalidHandle)
+				mBlocks[prev].nextPhysical = paddingBlock;
+			else
+				mFirstBlock = paddingBlock;
+			block.prevPhysical = paddingBlock;
+			InsertFree(paddingBlock);
+		}
+
+		mBlocks[handle].offset += padding;
+		mBlocks[handle].size -= padding;
+	}
+
+	// Split off the remainder
+	if (mBlocks[handle].size > size)
+	{
+		const Handle remainder = NewBlock();
+		Block& block = mBlocks[handle];
+		Block& rest = mBlocks[remainder];
+		rest.offset = block.offset + size;
+		rest.size = block.size - size;
+		rest.prevPhysical = handle;
+		rest.nextPhysical = block.nextPhysical;
+		if (block.nextPhysical != InvalidHandle)
+			mBlocks[block.nextPhysical].prevPhysical = remainder;
+		block.nextPhysical = remainder;
+		block.size = size;
+		InsertFree(remainder);
+	}
+
+	Block& block = mBlocks[handle];
+	block.alignment = alignment;
+	block.isFree = false;
+
+	mUsedSize += size;
+	mAllocationCount++;
+	return handle;
+}
+
+void TlsfAllocator::Free(Handle handle)
+{
+	mUsedSize -= mBlocks[handle].size;
+	mAllocationCount--;
+
+	// Merge with the following free block
+	const Handle next = mBlocks[handle].nextPhysical;
+	if (next != InvalidHandle && mBlocks[next].isFree)
+	{
+		RemoveFree(next);
+		mBlocks[handle].size += mBlocks[next].size;
+		mBlocks[handle].nextPhysical = mBlocks[next].nextPhysical;
+		if (mBlocks[next].nextPhysical != InvalidHandle)
+			mBlocks[mBlocks[next].nextPhysical].prevPhysical = handle;
+		ReleaseBlock(next);
+	}
+
+	// Merge into the preceding free block
+	const Handle prev = mBlocks[handle].prevPhysical;
+	if (prev != InvalidHandle && mBlocks[prev].isFree)
+	{
+		RemoveFree(prev);
+		mBlocks[prev].size += mBlocks[handle].size;
+		mBlocks[prev].nextPhysical = mBlocks[handle].nextPhysical;
+		if (mBlocks[handle].nextPhysical != InvalidHandle)
+			mBlocks[mBlocks[handle].nextPhysical].prevPhysical = prev;
+		ReleaseBlock(handle);
+		handle = prev;
+	}
+
+	InsertFree(handle);
+}
+
+TlsfAllocator::Stats TlsfAllocator::GetStats() const
+{
+	Stats stats = {};
+	stats.size = mSize;
+	stats.usedSize = mUsedSize;
+	stats.freeSize = mSize - mUsedSize;
+	stats.allocationCount = mAllocationCount;
+
+	for (Handle handle = mFirstBlock; handle != InvalidHandle; handle = mBlocks[handle].nextPhysical)
+	{
+		const Block& block = mBlocks[handle];
+		if (block.isFree)
+		{
+			stats.freeBlockCount++;
+			if (block.size > stats.largestFreeBlock)
+				stats.largestFreeBlock = block.size;
+		}
+	}
+
+	stats.fragmentation = stats.freeSize > 0 ? 1.0 - static_cast<double>(stats.largestFreeBlock) / static_cast<double>(stats.freeSize) : 0.0;
+	return stats;
+}
+
+void TlsfAllocator::Defragment(uint32_t maxMoves, std::vector<Move>& moves, const std::function<bool(Handle)>& canMove)
+{
+	std::vector<Handle> allocations;
+	for (Handle handle = mFirstBlock; handle != InvalidHandle; handle = mBlocks[handle].nextPhysical)
+	{
+		if (!mBlocks[handle].isFree)
+			allocations.push_back(handle);
+	}
+
+	// Highest offsets first, they are the ones keeping the free space split
+	uint32_t moveCount = 0;
+	for (auto it = allocations.rbegin(); it != allocations.rend() && moveCount < maxMoves; ++it)
+	{
+		const Handle source = *it;
+		if (canMove && !canMove(source))
+			continue;
+
+		const Handle destination = Allocate(mBlocks[source].size, mBlocks[source].alignment);
+		if (destination == InvalidHandle)
+			continue;
+
+		if (mBlocks[destination].offset < mBlocks[source].offset)
+		{
+			moves.push_back({ source, destination, mBlocks[source].offset, mBlocks[destination].offset, mBlocks[source].size });
+			moveCount++;
+		}
+		else
+		{
+			Free(destination);
+		}
+	}
+}
+
+void TlsfAllocator::Mapping(uint64_t size, uint32_t& fl, uint32_t& sl)
+{
+	if (size < SlCount)
+	{
+		fl = 0;
+		sl = static_cast<uint32_t>(size);
+	}
+	else
+	{
+		const uint32_t log2 = Log2(size);
+		fl = log2 - SlLog2 + 1;
+		sl = static_cast<uint32_t>(size >> (log2 - SlLog2)) ^ SlCount;
+	}
+}
+
+TlsfAllocator::Handle TlsfAllocator::FindFreeBlock(uint64_t size) const
+{
+	// Round up to the next class so any block found is large enough
+	if (size >= SlCount)
+		size += (1ull << (Log2(size) - SlLog2)) - 1;
+
+	uint32_t fl, sl;
+	Mapping(size, fl, sl);
+	if (fl >= FlCount)
+		return InvalidHandle;
+
+	uint32_t slMap = mSlBitmap[fl] & (~0u << sl);
+	if (slMap == 0)
+	{
+		const uint64_t flMap = fl + 1 < 64 ? mFlBitmap & (~0ull << (fl + 1)) : 0;
+		if (flMap == 0)
+			return InvalidHandle;
+
+		fl = static_cast<uint32_t>(std::countr_zero(flMap));
+		slMap = mSlBitmap[fl];
+	}
+
+	sl = static_cast<uint32_t>(std::countr_zero(slMap));
+	return mFreeHeads[fl][sl];
+}
+
+bool TlsfAllocator::Fits(Handle handle, uint64_t size, uint64_t alignment) const
+{
+	const Block& block = mBlocks[handle];
+	return AlignUp(block.offset, alignment) + size <= block.offset + block.size;
+}
+
+void TlsfAllocator::InsertFree(Handle handle)
+{
+	uint32_t fl, sl;
+	Mapping(mBlocks[handle].size, fl, sl);
+
+	Block& block = mBlocks[handle];
+	block.isFree = true;
+	block.prevFree = InvalidHandle;
+	block.nextFree = mFreeHeads[fl][sl];
+	if (block.nextFree != InvalidHandle)
+		mBlocks[block.nextFree].prevFree = handle;
+
+	mFreeHeads[fl][sl] = handle;
+	mFlBitmap |= 1ull << fl;
+	mSlBitmap[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::RemoveFree(Handle handle)
+{
+	uint32_t fl, sl;
+	Mapping(mBlocks[handle].size, fl, sl);
+
+	Block& block = mBlocks[handle];
+	if (block.prevFree != InvalidHandle)
+		mBlocks[block.prevFree].nextFree = block.nextFree;
+	else
+		mFreeHeads[fl][sl] = block.nextFree;
+
+	if (block.nextFree != InvalidHandle)
+		mBlocks[block.nextFree].prevFree = block.prevFree;
+
+	if (mFreeHeads[fl][sl] == InvalidHandle)
+	{
+		mSlBitmap[fl] &= ~(1u << sl);
+		if (mSlBitmap[fl] == 0)
+			mFlBitmap &= ~(1ull << fl);
+	}
+
+	block.isFree = false;
+}
+
+TlsfAllocator::Handle TlsfAllocator::NewBlock()
+{
+	Handle handle;
+	if (!mUnusedBlocks.empty())
+	{
+		handle = mUnusedBlocks.back();
+		mUnusedBlocks.pop_back();
+	}
+	else
+	{
+		handle = static_cast<Handle>(mBlocks.size());
+		mBlocks.push_back({});
+	}
+
+	mBlocks[handle] = {};
+	mBlocks[handle].alignment = 1;
+	mBlocks[handle].prevFree = InvalidHandle;
+	mBlocks[handle].nextFree = InvalidHandle;
+	return handle;
+}
+
+void TlsfAllocator::ReleaseBlock(Handle handle)
+{
+	mUnusedBlocks.push_back(handle);
+}
@@ -0,0 +1,166 @@
+#include "TransitionTracker.h"
+
+#include <iterator>
+
+void TransitionTracker::ResourceState::SetSubresourceState(uint32_t subresource, uint32_t subresourceState)
+{
+	if (subresource == AllSubresources)
+	{
+		state = subresourceState;
+		subresourceStates.clear();
+	}
+	else
+	{
+		subresourceStates[subresource] = subresourceState;
+	}
+}
+
+uint32_t TransitionTracker::ResourceState::GetSubresourceState(uint32_t subresource) const
+{
+	auto it = subresourceStates.find(subresource);
+	return it != subresourceStates.end() ? it->second : state;
+}
+
+TransitionTracker::TransitionTracker(SubresourceCountFunc getSubresourceCount)
+	:
+	mGetSubresourceCount(getSubresourceCount)
+{
+}
+
+void TransitionTracker::Transition(Resource resource, uint32_t stateAfter, uint32_t subresource)
+{
+	auto it = mFinalStates.find(resource);
+	if (it == mFinalStates.end())
+	{
+		// First use in this command list, the before state is only known at submission
+		AddPending(resource, subresource, stateAfter);
+		mFinalStates[resource].SetSubresourceState(subresource, stateAfter);
+		return;
+	}
+
+	ResourceState& resourceState = it->second;
+	if (subresource == AllSubresources && !resourceState.subresourceStates.empty())
+	{
+		// Subresources diverged, transition each one on its own
+		const uint32_t subresourceCount = mGetSubresourceCount(resource);
+		for (uint32_t n = 0; n < subresourceCount; n++)
+		{
+			const uint32_t stateBefore = resourceState.GetSubresourceState(n);
+			if (stateBefore == UnknownState)
+				AddPending(resource, n, stateAfter);
+			else
+				AddTransition(resource, n, stateBefore, stateAfter);
+		}
+	}
+	else
+	{
+		const uint32_t stateBefore = resourceState.GetSubresourceState(subresource);
+		if (stateBefore == UnknownState)
+			AddPending(resource, subresource, stateAfter);
+		else
+			AddTransition(resource, subresource, stateBefore, stateAfter);
+	}
+
+	resourceState.SetSubresourceState(subresource, stateAfter);
+}
+
+void TransitionTracker::SetState(Resource resource, uint32_t state)
+{
+	mFinalStates[resource].SetSubresourceState(AllSubresources, state);
+}
+
+void TransitionTracker::UavBarrier(Resource resource)
+{
+	mBarriers.push_back({ BarrierType::Uav, resource, nullptr, AllSubresources, 0, 0 });
+}
+
+void TransitionTracker::AliasBarrier(Resource resourceBefore, Resource resourceAfter)
+{
+	mBarriers.push_back({ BarrierType::Aliasing, resourceBefore, resourceAfter, AllSubresources, 0, 0 });
+}
+
+void TransitionTracker::ResolvePendingBarriers(const StateMap& globalStates, std::vector<Barrier>& barriers)
+{
+	for (const Barrier& pending : mPendingBarriers)
+	{
+		auto it = globalStates.find(pending.resource);
+		if (it == globalStates.end())
+			continue;
+
+		const ResourceState& globalState = it->second;
+		if (pending.subresource == AllSubresources && !globalState.subresourceStates.empty())
+		{
+			const uint32_t subresourceCount = mGetSubresourceCount(pending.resource);
+			for (uint32_t n = 0; n < subresourceCount; n++)
+			{
+				const uint32_t stateBefore = globalState.GetSubresourceState(n);
+				if (stateBefore != pending.stateAfter)
+					barriers.push_back({ BarrierType::Transition, pending.resource, nullptr, n, stateBefore, pending.stateAfter });
+			}
+		}
+		else
+		{
+			const uint32_t stateBefore = globalState.GetSubresourceState(pending.subresource);
+			if (stateBefore != pending.stateAfter)
+				barriers.push_back({ BarrierType::Transition, pending.resource, nullptr, pending.subresource, stateBefore, pending.stateAfter });
+		}
+	}
+
+	mPendingBarriers.clear();
+}
+
+void TransitionTracker::CommitFinalStates(StateMap& globalStates)
+{
+	for (const auto& finalState : mFinalStates)
+	{
+		auto it = globalStates.find(finalState.first);
+		if (it == globalStates.end())
+			continue;
+
+		if (finalState.second.state != UnknownState)
+			it->second.SetSubresourceState(AllSubresources, finalState.second.state);
+
+		for (const auto& subresourceState : finalState.second.subresourceStates)
+		{
+			it->second.SetSubresourceState(subresourceState.first, subresourceState.second);
+		}
+	}
+
+	mFinalStates.clear();
+}
+
+void TransitionTracker::Reset()
+{
+	mBarriers.clear();
+	mPendingBarriers.clear();
+	mFinalStates.clear();
+}
+
+void TransitionTracker::AddTransition(Resource resource, uint32_t subresource, uint32_t stateBefore, uint32_t stateAfter)
+{
+	if (stateBefore == stateAfter)
+		return;
+
+	// Collapse A->B followed by B->C into A->C when nothing else touched the resource in between
+	for (auto it = mBarriers.rbegin(); it != mBarriers.rend(); ++it)
+	{
+		if (it->type == BarrierType::Transition && it->resource != resource)
+			continue;
+
+		if (it->type == BarrierType::Transition && it->subresource == subresource && it->stateAfter == stateBefore)
+		{
+			it->stateAfter = stateAfter;
+			if (it->stateBefore == it->stateAfter)
+				mBarriers.erase(std::next(it).base());
+			return;
+		}
+		break;
+	}
+
+	mBarriers.push_back({ BarrierType::Transition, resource, nullptr, subresource, stateBefore, stateAfter });
+}
+
+void TransitionTracker::AddPending(Resource resource, uint32_t subresource, uint32_t stateAfter)
+{
+	mPendingBarriers.push_back({ BarrierType::Transition, resource, nullptr, subresource, UnknownState, stateAfter });
+}
@@ -0,0 +1,59 @@
+#include "UploadRing.h"
+#include "DXHelper.h"
+
+UploadRing::~UploadRing()
+{
+	if (mBuffer)
+	{
+		mBuffer->Unmap(0, nullptr);
+	}
+}
+
+void UploadRing::Init(ID3D12Device* pDevice, UINT64 size)
+{
+	CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_UPLOAD);
+	CD3DX12_RESOURCE_DESC resourceDescBuffer = CD3DX12_RESOURCE_DESC::Buffer(size);
+
+	ThrowIfFailed(pDevice->CreateCommittedResource(
+		&heapProperties,
+		D3D12_HEAP_FLAG_NONE,
+		&resourceDescBuffer,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&mBuffer)));
+
+	// Upload heaps may stay mapped for their whole lifetime, the CPU never reads back
+	CD3DX12_RANGE readRange(0, 0);
+	ThrowIfFailed(mBuffer->Map(0, &readRange, reinterpret_cast<void**>(&mpMappedData)));
+
+	mAllocator.Reset(size);
+}
+
+UploadAllocation UploadRing::Allocate(UINT64 size, UINT64 alignment)
+{
+	UploadAllocation allocation;
+	if (!TryAllocate(size, alignment, allocation))
+		ThrowIfFailed(E_OUTOFMEMORY);
+
+	return allocation;
+}
+
+bool UploadRing::TryAllocate(UINT64 size, UINT64 alignment, UploadAllocation& allocation)
+{
+	const UINT64 offset = mAllocator.Allocate(size, alignment);
+	if (offset == RingAllocator::InvalidOffset)
+		return false;
+
+	allocation = GetAllocation(offset);
+	return true;
+}
+
+UploadAllocation UploadRing::GetAllocation(UINT64 offset) const
+{
+	UploadAllocation allocation;
+	allocation.pResource = mBuffer.Get();
+	allocation.offset = offset;
+	allocation.pCpuAddress = mpMappedData + offset;
+	allocation.gpuAddress = mBuffer->GetGPUVirtualAddress() + offset;
+	return allocation;
+}
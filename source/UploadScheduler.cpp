@@ -0,0 +1,90 @@
+#include "UploadScheduler.h"
+
+UploadScheduler::UploadScheduler()
+	:
+	mpStagingRing(nullptr),
+	mBatchSize(0),
+	mLastSubmittedFenceValue(0)
+{
+}
+
+void UploadScheduler::Init(RingAllocator* pStagingRing, uint64_t batchSize)
+{
+	mpStagingRing = pStagingRing;
+	mBatchSize = batchSize;
+}
+
+void UploadScheduler::Enqueue(const Request& request, UploadPriority priority)
+{
+	mRequests[static_cast<size_t>(priority)].push_back(request);
+}
+
+bool UploadScheduler::IsEmpty() const
+{
+	for (const std::deque<Request>& requests : mRequests)
+	{
+		if (!requests.empty())
+			return false;
+	}
+	return true;
+}
+
+std::vector<UploadScheduler::Request> UploadScheduler::PopBatch()
+{
+	// Highest priority first, until the batch is big enough to be worth a submission
+	std::vector<Request> batch;
+	uint64_t batchSize = 0;
+	for (std::deque<Request>& requests : mRequests)
+	{
+		while (batchSize < mBatchSize && !requests.empty())
+		{
+			batchSize += requests.front().stagingSize;
+			batch.push_back(requests.front());
+			requests.pop_front();
+		}
+	}
+	return batch;
+}
+
+bool UploadScheduler::SubmitBatch(const std::vector<Request>& batch, UploadCopyQueue& queue)
+{
+	mpStagingRing->Retire(queue.GetCompletedValue());
+
+	bool hasCommands = false;
+	for (const Request& request : batch)
+	{
+		uint64_t offset;
+		while ((offset = mpStagingRing->Allocate(request.stagingSize, request.stagingAlignment)) == RingAllocator::InvalidOffset)
+		{
+			// Staging ring is full, push out what we have and wait for the copy queue to drain it
+			if (hasCommands)
+			{
+				Submit(queue);
+				hasCommands = false;
+			}
+			else if (mpStagingRing->GetUsedSize() == 0)
+			{
+				// Nothing left to retire, the request can never fit
+				return false;
+			}
+
+			queue.Wait(mLastSubmittedFenceValue);
+			mpStagingRing->Retire(mLastSubmittedFenceValue);
+		}
+
+		queue.RecordCopy(request.id, offset);
+		hasCommands = true;
+	}
+
+	if (hasCommands)
+		Submit(queue);
+	return true;
+}
+
+void UploadScheduler::Submit(UploadCopyQueue& queue)
+{
+	const uint64_t fenceValue = mLastSubmittedFenceValue + 1;
+	queue.Submit(fenceValue);
+	mpStagingRing->FinishBatch(fenceValue);
+	mLastSubmittedFenceValue = fenceValue;
+}
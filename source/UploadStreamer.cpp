@@ -0,0 +1,281 @@
+#include "UploadStreamer.h"
+#include "DXHelper.h"
+#include "SubresourceUpload.h"
+
+UploadStreamer::~UploadStreamer()
+{
+	Shutdown();
+}
+
+void UploadStreamer::Init(ID3D12Device* pDevice, UINT64 stagingSize, UINT64 batchSize, JobSystem* pJobSystem)
+{
+	mDevice = pDevice;
+	mpJobSystem = pJobSystem;
+
+	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+	ThrowIfFailed(mDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&mCopyQueue)));
+
+	ThrowIfFailed(mDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mCopyFence)));
+	mCopyFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (mCopyFenceEvent == nullptr)
+		ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+
+	mStagingRing.Init(mDevice.Get(), stagingSize);
+	mScheduler.Init(&mStagingRing.GetAllocator(), batchSize);
+
+	mSubmissionThread = std::thread(&UploadStreamer::SubmissionThreadMain, this);
+}
+
+void UploadStreamer::Shutdown()
+{
+	if (!mSubmissionThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mShutdown = true;
+	}
+	mRequestCondition.notify_all();
+	mSubmissionThread.join();
+
+	// Staging memory and allocators must outlive the copies that read them
+	WaitForCopyFence(mLastSubmittedFenceValue);
+	CloseHandle(mCopyFenceEvent);
+	mCopyFenceEvent = nullptr;
+}
+
+void UploadStreamer::EnqueueBuffer(ID3D12Resource* pDest, UINT64 destOffset, const void* pSource, UINT64 size,
+	std::shared_ptr<const void> keepAlive, UploadPriority priority)
+{
+	Request request;
+	request.dest = pDest;
+	request.destOffset = destOffset;
+	request.firstSubresource = 0;
+	request.subresources.push_back({ pSource, static_cast<LONG_PTR>(size), static_cast<LONG_PTR>(size) });
+	request.stagingSize = size;
+	request.keepAlive = std::move(keepAlive);
+	request.fillCount = 0;
+	request.isBuffer = true;
+
+	Enqueue(std::move(request), priority);
+}
+
+void UploadStreamer::EnqueueTexture(ID3D12Resource* pDest, UINT firstSubresource, UINT numSubresources, const D3D12_SUBRESOURCE_DATA* pSubresources,
+	std::shared_ptr<const void> keepAlive, UploadPriority priority)
+{
+	Request request;
+	request.dest = pDest;
+	request.destOffset = 0;
+	request.firstSubresource = firstSubresource;
+	request.subresources.assign(pSubresources, pSubresources + numSubresources);
+	request.stagingSize = GetRequiredIntermediateSize(pDest, firstSubresource, numSubresources);
+	request.keepAlive = std::move(keepAlive);
+	request.fillCount = 0;
+	request.isBuffer = false;
+
+	Enqueue(std::move(request), priority);
+}
+
+void UploadStreamer::EnqueueGeneratedTexture(ID3D12Resource* pDest, UINT firstSubresource, UINT numSubresources, FillFunc fill,
+	UploadPriority priority)
+{
+	Request request;
+	request.dest = pDest;
+	request.destOffset = 0;
+	request.firstSubresource = firstSubresource;
+	request.stagingSize = GetRequiredIntermediateSize(pDest, firstSubresource, numSubresources);
+	request.fill = std::move(fill);
+	request.fillCount = numSubresources;
+	request.isBuffer = false;
+
+	Enqueue(std::move(request), priority);
+}
+
+UINT64 UploadStreamer::Flush()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mIdleCondition.wait(lock, [this]
+	{
+		return mError || (!mBatchInFlight && mScheduler.IsEmpty());
+	});
+
+	if (mError)
+		std::rethrow_exception(mError);
+
+	return mLastSubmittedFenceValue;
+}
+
+void UploadStreamer::WaitOnQueue(ID3D12CommandQueue* pQueue, UINT64 fenceValue)
+{
+	ThrowIfFailed(pQueue->Wait(mCopyFence.Get(), fenceValue));
+}
+
+void UploadStreamer::Enqueue(Request&& request, UploadPriority priority)
+{
+	UploadScheduler::Request scheduled;
+	scheduled.stagingSize = request.stagingSize;
+	scheduled.stagingAlignment = request.isBuffer ? sizeof(UINT) : UploadRing::TextureAlignment;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		scheduled.id = mNextRequestId++;
+		mRequests.emplace(scheduled.id, std::move(request));
+		mScheduler.Enqueue(scheduled, priority);
+	}
+	mRequestCondition.notify_one();
+}
+
+void UploadStreamer::SubmissionThreadMain()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (true)
+	{
+		const std::vector<UploadScheduler::Request> batch = mScheduler.PopBatch();
+		if (batch.empty())
+		{
+			if (mShutdown)
+				return;
+
+			mRequestCondition.wait(lock);
+			continue;
+		}
+
+		for (const UploadScheduler::Request& scheduled : batch)
+		{
+			auto it = mRequests.find(scheduled.id);
+			mBatchRequests.emplace(scheduled.id, std::move(it->second));
+			mRequests.erase(it);
+		}
+		mBatchInFlight = true;
+		lock.unlock();
+
+		std::exception_ptr error;
+		try
+		{
+			if (!mScheduler.SubmitBatch(batch, *this))
+				ThrowIfFailed(E_OUTOFMEMORY);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+		// Requests a failed batch did not get to
+		mBatchRequests.clear();
+
+		lock.lock();
+		mBatchInFlight = false;
+		mError = error;
+		mIdleCondition.notify_all();
+		if (mError)
+			return;
+	}
+}
+
+void UploadStreamer::RecordCopy(uint64_t id, uint64_t stagingOffset)
+{
+	if (!mCommandListOpen)
+		BeginCommandList();
+
+	auto it = mBatchRequests.find(id);
+	Request& request = it->second;
+	const UploadAllocation staging = mStagingRing.GetAllocation(stagingOffset);
+	if (request.isBuffer)
+	{
+		SubresourceCopy::CopyBuffer(mCopySettings, staging.pCpuAddress, request.subresources[0].pData,
+			static_cast<size_t>(request.stagingSize), mpJobSystem);
+		mCommandList->CopyBufferRegion(request.dest.Get(), request.destOffset, staging.pResource, staging.offset, request.stagingSize);
+	}
+	else if (request.fill)
+	{
+		FillTexture(request, staging);
+	}
+	else
+	{
+		const UINT64 stagedSize = UpdateSubresourcesParallel(mCommandList.Get(), request.dest.Get(), staging.pResource, staging.offset,
+			request.firstSubresource, static_cast<UINT>(request.subresources.size()), request.subresources.data(),
+			mpJobSystem, mCopySettings);
+		if (stagedSize == 0)
+			ThrowIfFailed(E_INVALIDARG);
+	}
+
+	// Source data now lives in the staging ring, the command list holds the destination
+	mBatchRequests.erase(it);
+}
+
+void UploadStreamer::FillTexture(Request& request, const UploadAllocation& staging)
+{
+	const D3D12_RESOURCE_DESC desc = request.dest->GetDesc();
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(request.fillCount);
+	mDevice->GetCopyableFootprints(&desc, request.firstSubresource, request.fillCount, staging.offset, layouts.data(), nullptr, nullptr, nullptr);
+
+	UINT8* pStaging = staging.pCpuAddress;
+	for (UINT i = 0; i < request.fillCount; i++)
+	{
+		const UINT subresource = request.firstSubresource + i;
+		request.fill(subresource, layouts[i].Footprint, pStaging + (layouts[i].Offset - staging.offset));
+
+		const CD3DX12_TEXTURE_COPY_LOCATION dest(request.dest.Get(), subresource);
+		const CD3DX12_TEXTURE_COPY_LOCATION source(staging.pResource, layouts[i]);
+		mCommandList->CopyTextureRegion(&dest, 0, 0, 0, &source, nullptr);
+	}
+}
+
+void UploadStreamer::BeginCommandList()
+{
+	// Recycle the oldest allocator if the copy queue is done with it
+	if (!mCommandAllocators.empty() && mCommandAllocators.front().fenceValue <= mCopyFence->GetCompletedValue())
+	{
+		mRecordingAllocator = mCommandAllocators.front().allocator;
+		mCommandAllocators.pop_front();
+		ThrowIfFailed(mRecordingAllocator->Reset());
+	}
+	else
+	{
+		ThrowIfFailed(mDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&mRecordingAllocator)));
+	}
+
+	if (mCommandList)
+	{
+		ThrowIfFailed(mCommandList->Reset(mRecordingAllocator.Get(), nullptr));
+	}
+	else
+	{
+		ThrowIfFailed(mDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, mRecordingAllocator.Get(), nullptr, IID_PPV_ARGS(&mCommandList)));
+	}
+	mCommandListOpen = true;
+}
+
+void UploadStreamer::Submit(uint64_t fenceValue)
+{
+	ThrowIfFailed(mCommandList->Close());
+	mCommandListOpen = false;
+	ID3D12CommandList* ppCommandLists[] = { mCommandList.Get() };
+	mCopyQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+
+	ThrowIfFailed(mCopyQueue->Signal(mCopyFence.Get(), fenceValue));
+	mCommandAllocators.push_back({ mRecordingAllocator, fenceValue });
+	mRecordingAllocator.Reset();
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	mLastSubmittedFenceValue = fenceValue;
+}
+
+uint64_t UploadStreamer::GetCompletedValue()
+{
+	return mCopyFence->GetCompletedValue();
+}
+
+void UploadStreamer::Wait(uint64_t fenceValue)
+{
+	WaitForCopyFence(fenceValue);
+}
+
+void UploadStreamer::WaitForCopyFence(UINT64 fenceValue)
+{
+	if (mCopyFence->GetCompletedValue() < fenceValue)
+	{
+		ThrowIfFailed(mCopyFence->SetEventOnCompletion(fenceValue, mCopyFenceEvent));
+		WaitForSingleObject(mCopyFenceEvent, INFINITE);
+	}
+}
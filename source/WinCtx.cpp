@@ -2,14 +2,40 @@
 #include "DXRenderer.h"
 
 HWND WinCtx::mHWnd = nullptr;
+RenderThread WinCtx::mRenderThread;
+std::mutex WinCtx::mTitleMutex;
+std::wstring WinCtx::mTitle;
 
-int WinCtx::Run(DXRenderer* pRenderer, HINSTANCE hInstance, int nCmdShow)
+namespace
 {
-    int argc;
-    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
-    pRenderer->ParseCommandLineArgs(argv, argc);
-    LocalFree(argv);
+    const UINT WM_APP_TITLE = WM_APP;
+
+    // Stats go into the title bar, quitting closes the window
+    class WindowHost : public FrameHost
+    {
+    public:
+        explicit WindowHost(const std::wstring& title) : mTitle(title) {}
 
+        void SetStatusText(const std::string& text) override
+        {
+            std::wstring wideText(text.size(), L'\0');
+            wideText.resize(MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()),
+                wideText.data(), static_cast<int>(wideText.size())));
+            WinCtx::SetTitle(mTitle + L": " + wideText);
+        }
+
+        void RequestQuit() override
+        {
+            PostMessage(WinCtx::GetHwnd(), WM_CLOSE, 0, 0);
+        }
+
+    private:
+        std::wstring mTitle;
+    };
+}
+
+int WinCtx::Run(DXRenderer* pRenderer, HINSTANCE hInstance, int nCmdShow)
+{
     WNDCLASSEX wndClass = { 0 };
     wndClass.cbSize = sizeof(WNDCLASSEX);
     wndClass.style = CS_HREDRAW | CS_VREDRAW;
@@ -36,21 +62,35 @@ int WinCtx::Run(DXRenderer* pRenderer, HINSTANCE hInstance, int nCmdShow)
         pRenderer
     );
 
-    pRenderer->OnInit();
+    WindowHost host(pRenderer->GetTitle());
+    pRenderer->OnInit(&host, mHWnd);
 
     SetProcessDPIAware();
     ShowWindow(mHWnd, nCmdShow);
 
+    // Frames run on their own thread, this one sleeps until a message arrives
+    mRenderThread.Start(
+        [pRenderer]()
+        {
+            PROFILE_FRAME();
+            pRenderer->RunFrame();
+        },
+        [pRenderer](const WindowEvent& event)
+        {
+            if (event.type == WindowEvent::KeyDown)
+                pRenderer->OnKeyDown(static_cast<UINT8>(event.key));
+            else
+                pRenderer->OnKeyUp(static_cast<UINT8>(event.key));
+        });
+
     MSG msg = {};
-    while (msg.message != WM_QUIT)
+    while (GetMessage(&msg, NULL, 0, 0) > 0)
     {
-        if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
-        {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
-        }
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
     }
 
+    mRenderThread.Stop();
     pRenderer->OnDestroy();
 
     return static_cast<char>(msg.wParam);
@@ -58,8 +98,6 @@ int WinCtx::Run(DXRenderer* pRenderer, HINSTANCE hInstance, int nCmdShow)
 
 LRESULT WinCtx::WindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
-    DXRenderer* pRenderer = reinterpret_cast<DXRenderer*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
-
     switch (uMsg)
     {
     case WM_CREATE:
@@ -69,24 +107,28 @@ LRESULT WinCtx::WindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         }
         return 0;
     case WM_KEYUP:
-        if (pRenderer)
+        if (mRenderThread.IsRunning())
         {
-            pRenderer->OnKeyUp(static_cast<UINT8>(wParam));
+            mRenderThread.Post({ WindowEvent::KeyUp, static_cast<UINT8>(wParam) });
         }
         return 0;
     case WM_KEYDOWN:
-        if (pRenderer)
+        if (mRenderThread.IsRunning())
         {
-            pRenderer->OnKeyDown(static_cast<UINT8>(wParam));
+            mRenderThread.Post({ WindowEvent::KeyDown, static_cast<UINT8>(wParam) });
         }
         return 0;
-    case WM_PAINT:
-        if (pRenderer)
+    case WM_APP_TITLE:
         {
-            pRenderer->OnUpdate();
-            pRenderer->OnRender();
+            std::lock_guard<std::mutex> lock(mTitleMutex);
+            SetWindowText(hWnd, mTitle.c_str());
         }
         return 0;
+    case WM_CLOSE:
+        // The swap chain must not present into a destroyed window
+        mRenderThread.Stop();
+        DestroyWindow(hWnd);
+        return 0;
     case WM_DESTROY:
         PostQuitMessage(0);
         return 0;
@@ -94,3 +136,13 @@ LRESULT WinCtx::WindowProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 
     return DefWindowProc(hWnd, uMsg, wParam, lParam);
 }
+
+void WinCtx::SetTitle(const std::wstring& title)
+{
+    {
+        std::lock_guard<std::mutex> lock(mTitleMutex);
+        mTitle = title;
+    }
+    if (mHWnd)
+        PostMessage(mHWnd, WM_APP_TITLE, 0, 0);
+}
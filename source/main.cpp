@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "WinCtx.h"
+#include "HeadlessCtx.h"
 #include "DXRenderer.h"
 
 
@@ -7,5 +8,14 @@ _Use_decl_annotations_
 int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int nCmdShow)
 {
     DXRenderer renderer(1920, 1080, L"DXRT");
+
+    int argc;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    renderer.ParseCommandLineArgs(argv, argc);
+    LocalFree(argv);
+
+    if (renderer.IsHeadless())
+        return HeadlessCtx::Run(&renderer);
+
     return WinCtx::Run(&renderer, hInstance, nCmdShow);
 }
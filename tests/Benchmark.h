@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// Shared by the *Benchmark.cpp executables. They print one line per case, and run briefly with --quick,
+// which is how ctest smoke-tests them.
+namespace Benchmark
+{
+	inline bool IsQuick(int argc, char** argv)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			if (strcmp(argv[i], "--quick") == 0)
+				return true;
+		}
+		return false;
+	}
+
+	inline double GetSeconds()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Fastest of repeatCount runs, in seconds
+	template<typename Function>
+	double Measure(uint32_t repeatCount, Function&& function)
+	{
+		double best = 1e30;
+		for (uint32_t i = 0; i < repeatCount; i++)
+		{
+			const double start = GetSeconds();
+			function();
+			best = std::min(best, GetSeconds() - start);
+		}
+		return best;
+	}
+
+	// Keeps the compiler from dropping work whose result is otherwise unused
+	template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#if defined(__GNUC__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+}
@@ -0,0 +1,162 @@
+#include "TestFramework.h"
+#include "BenchmarkRecorder.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// A steady 60 Hz stream with a spike every spikeInterval frames
+	double SyntheticFrameTime(uint32_t frame, uint32_t spikeInterval)
+	{
+		return spikeInterval != 0 && frame % spikeInterval == spikeInterval - 1 ? 50.0 : 16.0 + (frame % 3) * 0.25;
+	}
+
+	bool Contains(const std::string& text, const std::string& part)
+	{
+		return text.find(part) != std::string::npos;
+	}
+}
+
+TEST_CASE(WarmupFramesAreDropped)
+{
+	BenchmarkRecorder recorder(10, 5);
+	for (uint32_t frame = 0; frame < 15; frame++)
+	{
+		CHECK(recorder.IsWarmingUp() == (frame < 10));
+		CHECK(!recorder.IsComplete());
+		// Warm-up frames are slow, measured ones aren't
+		recorder.AddSample(BenchmarkRecorder::CpuFrameTime, frame < 10 ? 100.0 : 10.0 + frame);
+		recorder.EndFrame();
+	}
+	CHECK(recorder.IsComplete());
+
+	const BenchmarkRecorder::Summary summary = recorder.GetSummary(BenchmarkRecorder::CpuFrameTime);
+	CHECK(summary.count == 5);
+	CHECK(summary.max == 24.0);
+	CHECK(summary.mean == 22.0);
+}
+
+TEST_CASE(SeriesFillIndependentlyAndStopAtMeasuredFrames)
+{
+	BenchmarkRecorder recorder(2, 10);
+	// GPU times arrive two frames late, the present interval needs a previous frame
+	for (uint32_t frame = 0; frame < 12; frame++)
+	{
+		recorder.AddSample(BenchmarkRecorder::CpuFrameTime, 4.0);
+		if (frame >= 2)
+			recorder.AddSample(BenchmarkRecorder::GpuFrameTime, 8.0);
+		if (frame >= 1)
+			recorder.AddSample(BenchmarkRecorder::PresentInterval, 16.0);
+		recorder.EndFrame();
+	}
+	CHECK(recorder.IsComplete());
+	CHECK(recorder.GetSummary(BenchmarkRecorder::CpuFrameTime).count == 10);
+	CHECK(recorder.GetSummary(BenchmarkRecorder::PresentInterval).count == 10);
+	CHECK(recorder.GetSummary(BenchmarkRecorder::GpuFrameTime).count == 10);
+
+	// Late samples past the measured frames are dropped
+	for (uint32_t i = 0; i < 5; i++)
+		recorder.AddSample(BenchmarkRecorder::GpuFrameTime, 1000.0);
+	CHECK(recorder.GetSummary(BenchmarkRecorder::GpuFrameTime).count == 10);
+	CHECK(recorder.GetSummary(BenchmarkRecorder::GpuFrameTime).max == 8.0);
+}
+
+TEST_CASE(PercentilesUseTheNearestRank)
+{
+	// 1 to 100 in a shuffled order
+	std::vector<double> samples;
+	for (uint32_t i = 0; i < 100; i++)
+		samples.push_back(static_cast<double>((i * 37) % 100 + 1));
+
+	const BenchmarkRecorder::Summary summary = BenchmarkRecorder::Summarize(samples);
+	CHECK(summary.count == 100);
+	CHECK(summary.mean == 50.5);
+	CHECK(summary.p50 == 50.0);
+	CHECK(summary.p95 == 95.0);
+	CHECK(summary.p99 == 99.0);
+	CHECK(summary.max == 100.0);
+
+	// Few samples, the high percentiles are the maximum
+	const BenchmarkRecorder::Summary small = BenchmarkRecorder::Summarize({ 3.0, 1.0, 2.0 });
+	CHECK(small.p50 == 2.0);
+	CHECK(small.p95 == 3.0);
+	CHECK(small.p99 == 3.0);
+
+	const BenchmarkRecorder::Summary single = BenchmarkRecorder::Summarize({ 7.0 });
+	CHECK(single.p50 == 7.0 && single.p99 == 7.0 && single.max == 7.0);
+}
+
+TEST_CASE(StuttersAreFramesOverTwiceTheMedian)
+{
+	BenchmarkRecorder recorder(0, 600);
+	for (uint32_t frame = 0; frame < 600; frame++)
+	{
+		recorder.AddSample(BenchmarkRecorder::CpuFrameTime, SyntheticFrameTime(frame, 60));
+		recorder.AddSample(BenchmarkRecorder::GpuFrameTime, SyntheticFrameTime(frame, 0));
+		recorder.EndFrame();
+	}
+
+	const BenchmarkRecorder::Summary cpu = recorder.GetSummary(BenchmarkRecorder::CpuFrameTime);
+	CHECK(cpu.stutterCount == 10);
+	CHECK(cpu.max == 50.0);
+	CHECK(cpu.p50 >= 16.0 && cpu.p50 <= 16.5);
+	// One frame in 60 is under 2%, p99 still sees it
+	CHECK(cpu.p95 <= 16.5);
+	CHECK(cpu.p99 == 50.0);
+
+	const BenchmarkRecorder::Summary gpu = recorder.GetSummary(BenchmarkRecorder::GpuFrameTime);
+	CHECK(gpu.stutterCount == 0);
+
+	// A steady slow run isn't stutter, exactly twice the median isn't either
+	CHECK(BenchmarkRecorder::Summarize(std::vector<double>(50, 100.0)).stutterCount == 0);
+	CHECK(BenchmarkRecorder::Summarize({ 10.0, 10.0, 20.0 }).stutterCount == 0);
+	CHECK(BenchmarkRecorder::Summarize({ 10.0, 10.0, 20.5 }).stutterCount == 1);
+}
+
+TEST_CASE(EmptySeriesSummarizesToZero)
+{
+	BenchmarkRecorder recorder(5, 10);
+	const BenchmarkRecorder::Summary summary = recorder.GetSummary(BenchmarkRecorder::PresentInterval);
+	CHECK(summary.count == 0);
+	CHECK(summary.mean == 0.0 && summary.p50 == 0.0 && summary.p99 == 0.0 && summary.max == 0.0);
+	CHECK(summary.stutterCount == 0);
+	CHECK(Contains(recorder.ToJson(), "\"presentInterval\":{\"count\":0,"));
+}
+
+TEST_CASE(JsonReportsEverySeriesAndEscapesInfo)
+{
+	BenchmarkRecorder recorder(1, 4);
+	recorder.SetInfo("adapter", "Test \"GPU\" \\ 1");
+	recorder.SetInfo("resolution", "640x480");
+	recorder.SetInfo("adapter", "Replaced \"GPU\"\n");
+	for (uint32_t frame = 0; frame < 5; frame++)
+	{
+		recorder.AddSample(BenchmarkRecorder::CpuFrameTime, 2.0 * (frame + 1));
+		recorder.EndFrame();
+	}
+
+	const std::string json = recorder.ToJson();
+	CHECK(Contains(json, "\"warmupFrames\":1,"));
+	CHECK(Contains(json, "\"measuredFrames\":4,"));
+	CHECK(Contains(json, "\"stutterFactor\":2,"));
+	// Setting a key again replaces it in place
+	CHECK(Contains(json, "\"info\":{\"adapter\":\"Replaced \\\"GPU\\\"\\u000a\",\"resolution\":\"640x480\"}"));
+	CHECK(!Contains(json, "Test"));
+	CHECK(Contains(json, "\"cpuFrameTime\":{\"count\":4,\"mean\":7.000000,\"p50\":6.000000,\"p95\":10.000000,"
+		"\"p99\":10.000000,\"max\":10.000000,\"stutters\":0}"));
+	CHECK(Contains(json, "\"gpuFrameTime\":{\"count\":0,"));
+	CHECK(Contains(json, "\"presentInterval\":{\"count\":0,"));
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "dxrt-benchmark-test.json";
+	REQUIRE(recorder.Write(path));
+	std::ifstream file(path, std::ios::binary);
+	std::stringstream written;
+	written << file.rdbuf();
+	file.close();
+	std::filesystem::remove(path);
+	CHECK(written.str() == json);
+}
@@ -0,0 +1,204 @@
+#include "TestFramework.h"
+#include "BindlessRegistry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	uint32_t Acquire(BindlessRegistry& registry, uint64_t key)
+	{
+		bool isNew = false;
+		return registry.Acquire(key, isNew);
+	}
+}
+
+TEST_CASE(AcquireIsReferenceCounted)
+{
+	BindlessRegistry registry(16);
+	bool isNew = false;
+	const uint32_t index = registry.Acquire(100, isNew);
+	CHECK(index == 0);
+	CHECK(isNew);
+
+	// Later acquires share the index and leave the descriptor alone
+	CHECK(registry.Acquire(100, isNew) == index);
+	CHECK(!isNew);
+	CHECK(registry.Acquire(100, isNew) == index);
+	CHECK(registry.GetResidentCount() == 1);
+
+	// Resident until the last of the three references is gone
+	std::vector<uint32_t> freed;
+	registry.Release(100, 1);
+	registry.Release(100, 1);
+	registry.Retire(10, freed);
+	CHECK(freed.empty());
+	CHECK(registry.Find(100) == index);
+
+	registry.Release(100, 2);
+	CHECK(registry.Find(100) == BindlessRegistry::InvalidIndex);
+	CHECK(registry.GetResidentCount() == 0);
+	registry.Retire(2, freed);
+	CHECK(freed == std::vector<uint32_t>{ index });
+
+	// Unknown keys and extra releases are ignored
+	registry.Release(100, 3);
+	registry.Release(555, 3);
+	freed.clear();
+	registry.Retire(10, freed);
+	CHECK(freed.empty());
+
+	// A new acquire after the free starts over
+	CHECK(registry.Acquire(100, isNew) == index);
+	CHECK(isNew);
+}
+
+TEST_CASE(FreedIndicesAreReusedLowestFirst)
+{
+	BindlessRegistry registry(8);
+	for (uint64_t key = 0; key < 8; key++)
+		CHECK(Acquire(registry, key) == key);
+
+	// Freed out of order, in two batches
+	std::vector<uint32_t> freed;
+	registry.Release(6, 1);
+	registry.Release(2, 1);
+	registry.Release(4, 2);
+	registry.Retire(1, freed);
+	registry.Release(1, 3);
+	registry.Retire(3, freed);
+	std::sort(freed.begin(), freed.end());
+	CHECK(freed == (std::vector<uint32_t>{ 1, 2, 4, 6 }));
+
+	CHECK(Acquire(registry, 10) == 1);
+	CHECK(Acquire(registry, 11) == 2);
+	CHECK(Acquire(registry, 12) == 4);
+	CHECK(Acquire(registry, 13) == 6);
+	CHECK(registry.GetResidentCount() == 8);
+}
+
+TEST_CASE(IndicesWaitForTheirFence)
+{
+	BindlessRegistry registry(2);
+	CHECK(Acquire(registry, 1) == 0);
+	CHECK(Acquire(registry, 2) == 1);
+	registry.Release(1, 5);
+	registry.Release(2, 7);
+
+	// Nothing frees before the frame that last used the index completed
+	std::vector<uint32_t> freed;
+	registry.Retire(4, freed);
+	CHECK(freed.empty());
+	CHECK(Acquire(registry, 3) == BindlessRegistry::InvalidIndex);
+
+	registry.Retire(5, freed);
+	CHECK(freed == std::vector<uint32_t>{ 0 });
+	CHECK(Acquire(registry, 3) == 0);
+	CHECK(Acquire(registry, 4) == BindlessRegistry::InvalidIndex);
+
+	freed.clear();
+	registry.Retire(6, freed);
+	CHECK(freed.empty());
+	registry.Retire(7, freed);
+	CHECK(freed == std::vector<uint32_t>{ 1 });
+	CHECK(Acquire(registry, 4) == 1);
+}
+
+TEST_CASE(FullRegistryReturnsInvalidIndex)
+{
+	BindlessRegistry registry(3);
+	for (uint64_t key = 0; key < 3; key++)
+		CHECK(Acquire(registry, key) == key);
+
+	bool isNew = true;
+	CHECK(registry.Acquire(3, isNew) == BindlessRegistry::InvalidIndex);
+	CHECK(!isNew);
+	CHECK(registry.Find(3) == BindlessRegistry::InvalidIndex);
+	// Resident resources can still be acquired again
+	CHECK(registry.Acquire(1, isNew) == 1);
+	CHECK(registry.GetResidentCount() == 3);
+
+	BindlessRegistry empty;
+	CHECK(Acquire(empty, 1) == BindlessRegistry::InvalidIndex);
+
+	// Reset forgets everything, pending frees included
+	registry.Release(0, 1);
+	registry.Reset(2);
+	std::vector<uint32_t> freed;
+	registry.Retire(100, freed);
+	CHECK(freed.empty());
+	CHECK(registry.GetCapacity() == 2);
+	CHECK(registry.GetResidentCount() == 0);
+	CHECK(Acquire(registry, 1) == 0);
+}
+
+TEST_CASE(ConcurrentAcquiresAreUnique)
+{
+	const uint32_t capacity = 4096;
+	const uint32_t threadCount = 4;
+	BindlessRegistry registry(capacity);
+
+	// Every thread acquires the same shared keys and a share of its own, shared keys get one index between them
+	const uint64_t sharedKeyCount = 256;
+	std::vector<std::vector<uint32_t>> own(threadCount);
+	std::vector<std::vector<uint32_t>> shared(threadCount);
+	std::atomic<uint32_t> newShared(0);
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < threadCount; t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (uint64_t n = 0; n < (capacity - sharedKeyCount) / threadCount; n++)
+			{
+				bool isNew = false;
+				own[t].push_back(registry.Acquire((uint64_t(t + 1) << 32) | n, isNew));
+				if (n < sharedKeyCount)
+				{
+					shared[t].push_back(registry.Acquire(n, isNew));
+					newShared += isNew ? 1 : 0;
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	CHECK(newShared == sharedKeyCount);
+	for (uint32_t t = 1; t < threadCount; t++)
+		CHECK(shared[t] == shared[0]);
+
+	std::vector<uint32_t> all = shared[0];
+	for (const std::vector<uint32_t>& indices : own)
+		all.insert(all.end(), indices.begin(), indices.end());
+	std::sort(all.begin(), all.end());
+	REQUIRE(all.size() == capacity);
+	for (uint32_t n = 0; n < capacity; n++)
+		CHECK(all[n] == n);
+	CHECK(registry.GetResidentCount() == capacity);
+	CHECK(Acquire(registry, ~0ull) == BindlessRegistry::InvalidIndex);
+
+	// Concurrent releases of every reference free each index once
+	threads.clear();
+	for (uint32_t t = 0; t < threadCount; t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (uint64_t n = 0; n < own[t].size(); n++)
+			{
+				registry.Release((uint64_t(t + 1) << 32) | n, 1);
+				if (n < sharedKeyCount)
+					registry.Release(n, 1);
+			}
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	std::vector<uint32_t> freed;
+	registry.Retire(1, freed);
+	std::sort(freed.begin(), freed.end());
+	CHECK(freed == all);
+	CHECK(registry.GetResidentCount() == 0);
+}
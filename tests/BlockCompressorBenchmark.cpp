@@ -0,0 +1,83 @@
+#include "Benchmark.h"
+#include "BlockCompressor.h"
+#include "BlockDecoder.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+#include "ProceduralTexture.h"
+
+#include <thread>
+#include <vector>
+
+// Block compression throughput and PSNR per format and quality, on 2048x2048 fBm colour noise with a radial alpha
+// gradient. Scalar and AVX2 run single threaded; the best backend then runs on the job system.
+// PSNR comes from the reference decoder in BlockDecoder.h.
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const uint32_t size = quick ? 128 : 2048;
+	const BlockFormat formats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC5, BlockFormat::BC7 };
+	const char* formatNames[] = { "BC1", "BC3", "BC5", "BC7" };
+	const BlockQuality qualities[] = { BlockQuality::Fast, BlockQuality::Normal, BlockQuality::High };
+	const char* qualityNames[] = { "fast", "normal", "high" };
+
+	std::vector<uint8_t> image(size_t(size) * size * 4);
+	std::vector<uint8_t> channel(image.size());
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		ProceduralTextureDesc desc;
+		desc.pattern = c == 3 ? ProceduralPattern::RadialGradient : ProceduralPattern::PerlinNoise;
+		desc.width = size;
+		desc.height = size;
+		desc.frequency = size / 64.0f;
+		desc.octaves = 5;
+		desc.seed = c * 7 + 1;
+		ProceduralTexture::Generate(desc, channel.data(), uint64_t(size) * 4);
+		for (size_t i = 0; i < size_t(size) * size; i++)
+			image[i * 4 + c] = channel[i * 4];
+	}
+
+	JobSystem jobs;
+	printf("%ux%u, %u hardware threads\n", size, size, std::thread::hardware_concurrency());
+
+	bool failed = false;
+	for (uint32_t f = 0; f < 4; f++)
+	{
+		const uint64_t rowPitch = uint64_t(size / 4) * BlockCompressor::GetBlockSize(formats[f]);
+		std::vector<uint8_t> blocks(rowPitch * (size / 4));
+		for (uint32_t q = 0; q < 3; q++)
+		{
+			BlockCompressor::Settings settings;
+			settings.format = formats[f];
+			settings.quality = qualities[q];
+			auto measure = [&](JobSystem* pJobSystem)
+			{
+				const double time = Benchmark::Measure(1, [&]()
+				{
+					BlockCompressor::Compress(settings, size, size, image.data(), uint64_t(size) * 4, blocks.data(), rowPitch, pJobSystem);
+				});
+				return double(size) * size / time / 1e6;
+			};
+
+			settings.allowAvx2 = false;
+			const double scalar = measure(nullptr);
+			const std::vector<uint8_t> scalarBlocks = blocks;
+			printf("%s %-6s PSNR %5.2f dB, scalar %6.2f Mpixel/s", formatNames[f], qualityNames[q],
+				BlockDecoder::GetPsnr(formats[f], size, size, image, blocks), scalar);
+
+			settings.allowAvx2 = true;
+			if (CpuFeatures::HasAvx2())
+			{
+				printf(", AVX2 %6.2f Mpixel/s", measure(nullptr));
+				// Errors are integral, both backends pick the same endpoints
+				if (blocks != scalarBlocks)
+					failed = true;
+			}
+			printf(", jobs %6.2f Mpixel/s\n", measure(&jobs));
+			if (blocks != scalarBlocks)
+				failed = true;
+		}
+	}
+	if (failed)
+		printf("Output differs between backends\n");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,215 @@
+#include "TestFramework.h"
+#include "BlockCompressor.h"
+#include "BlockDecoder.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+#include "ProceduralTexture.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	const BlockFormat AllFormats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC5, BlockFormat::BC7 };
+	const BlockQuality AllQualities[] = { BlockQuality::Fast, BlockQuality::Normal, BlockQuality::High };
+
+	// Perlin noise in each colour channel and a radial alpha gradient
+	std::vector<uint8_t> MakeNoiseImage(uint32_t width, uint32_t height)
+	{
+		std::vector<uint8_t> image(size_t(width) * height * 4);
+		std::vector<uint8_t> channel(image.size());
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			ProceduralTextureDesc desc;
+			desc.pattern = c == 3 ? ProceduralPattern::RadialGradient : ProceduralPattern::PerlinNoise;
+			desc.width = width;
+			desc.height = height;
+			desc.frequency = width / 64.0f;
+			desc.octaves = 5;
+			desc.seed = c * 7 + 1;
+			ProceduralTexture::Generate(desc, channel.data(), uint64_t(width) * 4);
+			for (size_t i = 0; i < size_t(width) * height; i++)
+				image[i * 4 + c] = channel[i * 4];
+		}
+		return image;
+	}
+
+	std::vector<uint8_t> Compress(const BlockCompressor::Settings& settings, uint32_t width, uint32_t height, const std::vector<uint8_t>& image,
+		JobSystem* pJobSystem = nullptr)
+	{
+		const uint64_t rowPitch = uint64_t(BlockCompressor::GetBlockCount(width)) * BlockCompressor::GetBlockSize(settings.format);
+		std::vector<uint8_t> blocks(rowPitch * BlockCompressor::GetBlockCount(height));
+		BlockCompressor::Compress(settings, width, height, image.data(), uint64_t(width) * 4, blocks.data(), rowPitch, pJobSystem);
+		return blocks;
+	}
+
+	int GetMaxError(BlockFormat format, const uint8_t* pBlock, const uint8_t source[64])
+	{
+		uint8_t pixels[64];
+		if (!BlockDecoder::DecodeBlock(format, pBlock, pixels))
+			return 256;
+		int maxError = 0;
+		for (uint32_t p = 0; p < 16; p++)
+		{
+			for (uint32_t c = 0; c < BlockDecoder::GetChannelCount(format); c++)
+				maxError = std::max(maxError, std::abs(int(pixels[p * 4 + c]) - int(source[p * 4 + c])));
+		}
+		return maxError;
+	}
+}
+
+TEST_CASE(BlockSizesMatchTheFormats)
+{
+	CHECK(BlockCompressor::GetBlockSize(BlockFormat::BC1) == 8);
+	CHECK(BlockCompressor::GetBlockSize(BlockFormat::BC3) == 16);
+	CHECK(BlockCompressor::GetBlockSize(BlockFormat::BC5) == 16);
+	CHECK(BlockCompressor::GetBlockSize(BlockFormat::BC7) == 16);
+	CHECK(BlockCompressor::GetBlockCount(1) == 1);
+	CHECK(BlockCompressor::GetBlockCount(4) == 1);
+	CHECK(BlockCompressor::GetBlockCount(131) == 33);
+}
+
+TEST_CASE(ConstantBlocksDecodeCloseToTheSource)
+{
+	uint8_t source[64];
+	for (uint32_t p = 0; p < 16; p++)
+	{
+		source[p * 4] = 200;
+		source[p * 4 + 1] = 17;
+		source[p * 4 + 2] = 99;
+		source[p * 4 + 3] = 255;
+	}
+	for (BlockFormat format : AllFormats)
+	{
+		for (BlockQuality quality : AllQualities)
+		{
+			BlockCompressor::Settings settings;
+			settings.format = format;
+			settings.quality = quality;
+			uint8_t block[16];
+			BlockCompressor::CompressBlock(settings, source, block);
+			// 5:6:5 endpoints can't hit every colour, interpolation gets within a few codes
+			CHECK(GetMaxError(format, block, source) <= (format == BlockFormat::BC1 || format == BlockFormat::BC3 ? 3 : 1));
+		}
+	}
+}
+
+TEST_CASE(OpaqueBlackAndWhiteBlocksAreExact)
+{
+	uint8_t source[64];
+	for (uint32_t p = 0; p < 16; p++)
+	{
+		const uint8_t value = (p * 7) % 3 != 0 ? 255 : 0;
+		memset(source + p * 4, value, 3);
+		source[p * 4 + 3] = 255;
+	}
+	for (BlockFormat format : AllFormats)
+	{
+		BlockCompressor::Settings settings;
+		settings.format = format;
+		settings.quality = BlockQuality::Fast;
+		uint8_t block[16];
+		BlockCompressor::CompressBlock(settings, source, block);
+		// A BC7 endpoint shares its p-bit between black and opaque alpha, one of them is off by a code
+		CHECK(GetMaxError(format, block, source) <= (format == BlockFormat::BC7 ? 1 : 0));
+	}
+}
+
+TEST_CASE(Avx2AndJobsMatchScalarByteForByte)
+{
+	JobSystem jobs(3);
+	// Odd sizes leave partial blocks on both edges and a partial last job
+	const uint32_t width = 131;
+	const uint32_t height = 70;
+	const std::vector<uint8_t> image = MakeNoiseImage(width, height);
+	for (BlockFormat format : AllFormats)
+	{
+		for (BlockQuality quality : AllQualities)
+		{
+			BlockCompressor::Settings settings;
+			settings.format = format;
+			settings.quality = quality;
+			settings.allowAvx2 = false;
+			const std::vector<uint8_t> scalar = Compress(settings, width, height, image);
+			CHECK(Compress(settings, width, height, image, &jobs) == scalar);
+			if (CpuFeatures::HasAvx2())
+			{
+				settings.allowAvx2 = true;
+				CHECK(Compress(settings, width, height, image) == scalar);
+				CHECK(Compress(settings, width, height, image, &jobs) == scalar);
+			}
+		}
+	}
+}
+
+TEST_CASE(PsnrOnNoiseMeetsEachFormatFloor)
+{
+	// A little under what each format and quality measures on this image, higher quality never loses
+	const double floors[4][3] = { { 41.0, 41.2, 41.8 }, { 42.2, 42.4, 43.0 }, { 54.8, 55.2, 56.0 }, { 43.6, 43.6, 43.6 } };
+	const std::vector<uint8_t> image = MakeNoiseImage(128, 128);
+	for (uint32_t f = 0; f < 4; f++)
+	{
+		double previous = 0.0;
+		for (uint32_t q = 0; q < 3; q++)
+		{
+			BlockCompressor::Settings settings;
+			settings.format = AllFormats[f];
+			settings.quality = AllQualities[q];
+			const double psnr = BlockDecoder::GetPsnr(settings.format, 128, 128, image, Compress(settings, 128, 128, image));
+			CHECK(psnr >= floors[f][q]);
+			CHECK(psnr >= previous - 0.01);
+			previous = psnr;
+		}
+	}
+}
+
+TEST_CASE(EdgeBlocksRepeatTheLastRowAndColumn)
+{
+	const uint32_t width = 6;
+	const uint32_t height = 5;
+	const std::vector<uint8_t> image = MakeNoiseImage(width, height);
+
+	// The same image padded to 8x8 by hand
+	std::vector<uint8_t> padded(8 * 8 * 4);
+	for (uint32_t y = 0; y < 8; y++)
+	{
+		for (uint32_t x = 0; x < 8; x++)
+			memcpy(&padded[(y * 8 + x) * 4], &image[(std::min(y, height - 1) * width + std::min(x, width - 1)) * 4], 4);
+	}
+
+	for (BlockFormat format : AllFormats)
+	{
+		BlockCompressor::Settings settings;
+		settings.format = format;
+		CHECK(Compress(settings, width, height, image) == Compress(settings, 8, 8, padded));
+	}
+}
+
+TEST_CASE(DestinationPaddingIsLeftAlone)
+{
+	const uint32_t size = 32;
+	const std::vector<uint8_t> image = MakeNoiseImage(size, size);
+	for (BlockFormat format : AllFormats)
+	{
+		BlockCompressor::Settings settings;
+		settings.format = format;
+		const uint64_t rowSize = uint64_t(size / 4) * BlockCompressor::GetBlockSize(format);
+		const uint64_t rowPitch = rowSize + 40;
+		std::vector<uint8_t> blocks(rowPitch * (size / 4), 0xCD);
+		BlockCompressor::Compress(settings, size, size, image.data(), size * 4, blocks.data(), rowPitch);
+
+		const std::vector<uint8_t> packed = Compress(settings, size, size, image);
+		uint32_t mismatches = 0;
+		uint32_t paddingWrites = 0;
+		for (uint32_t y = 0; y < size / 4; y++)
+		{
+			mismatches += memcmp(&blocks[y * rowPitch], &packed[y * rowSize], rowSize) != 0 ? 1 : 0;
+			paddingWrites += uint32_t(std::count_if(blocks.begin() + y * rowPitch + rowSize, blocks.begin() + (y + 1) * rowPitch,
+				[](uint8_t value) { return value != 0xCD; }));
+		}
+		CHECK(mismatches == 0);
+		CHECK(paddingWrites == 0);
+	}
+}
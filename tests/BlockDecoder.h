@@ -0,0 +1,186 @@
+#pragma once
+
+#include "BlockCompressor.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Reference BCn decoders for the modes BlockCompressor writes, following the D3D spec rather than the encoder,
+// shared by BlockCompressorTests and BlockCompressorBenchmark.
+namespace BlockDecoder
+{
+	inline void Decode565(uint16_t color, int rgb[3])
+	{
+		const int r = color >> 11;
+		const int g = (color >> 5) & 63;
+		const int b = color & 31;
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	// BC3 colour blocks always use four colours
+	inline void DecodeColor(const uint8_t* pBlock, uint8_t pixels[64], bool alwaysFourColors)
+	{
+		const uint16_t color0 = static_cast<uint16_t>(pBlock[0] | (pBlock[1] << 8));
+		const uint16_t color1 = static_cast<uint16_t>(pBlock[2] | (pBlock[3] << 8));
+		const uint32_t indices = pBlock[4] | (pBlock[5] << 8) | (pBlock[6] << 16) | (static_cast<uint32_t>(pBlock[7]) << 24);
+		const bool fourColors = alwaysFourColors || color0 > color1;
+
+		int palette[4][4];
+		Decode565(color0, palette[0]);
+		Decode565(color1, palette[1]);
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			if (fourColors)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		for (uint32_t i = 0; i < 4; i++)
+			palette[i][3] = 255;
+		if (!fourColors)
+			palette[3][3] = 0;
+
+		for (uint32_t p = 0; p < 16; p++)
+		{
+			const int* pColor = palette[(indices >> (p * 2)) & 3];
+			for (uint32_t c = 0; c < 4; c++)
+				pixels[p * 4 + c] = static_cast<uint8_t>(pColor[c]);
+		}
+	}
+
+	inline void DecodeSingle(const uint8_t* pBlock, uint8_t pixels[64], uint32_t channel)
+	{
+		const int value0 = pBlock[0];
+		const int value1 = pBlock[1];
+		int palette[8] = { value0, value1 };
+		if (value0 > value1)
+		{
+			for (int i = 2; i < 8; i++)
+				palette[i] = ((8 - i) * value0 + (i - 1) * value1 + 3) / 7;
+		}
+		else
+		{
+			for (int i = 2; i < 6; i++)
+				palette[i] = ((6 - i) * value0 + (i - 1) * value1 + 2) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t indices = 0;
+		for (uint32_t i = 0; i < 6; i++)
+			indices |= static_cast<uint64_t>(pBlock[2 + i]) << (i * 8);
+		for (uint32_t p = 0; p < 16; p++)
+			pixels[p * 4 + channel] = static_cast<uint8_t>(palette[(indices >> (p * 3)) & 7]);
+	}
+
+	// Mode 6 only, false for anything else
+	inline bool DecodeBc7(const uint8_t* pBlock, uint8_t pixels[64])
+	{
+		uint32_t position = 0;
+		auto read = [&](uint32_t bitCount)
+		{
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < bitCount; i++, position++)
+				value |= ((pBlock[position / 8] >> (position % 8)) & 1u) << i;
+			return value;
+		};
+
+		if (read(7) != 0x40)
+			return false;
+		int endpoints[2][4];
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = static_cast<int>(read(7));
+			endpoints[1][c] = static_cast<int>(read(7));
+		}
+		const int pBit0 = static_cast<int>(read(1));
+		const int pBit1 = static_cast<int>(read(1));
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = (endpoints[0][c] << 1) | pBit0;
+			endpoints[1][c] = (endpoints[1][c] << 1) | pBit1;
+		}
+
+		static const int Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+		for (uint32_t p = 0; p < 16; p++)
+		{
+			// The anchor index drops its top bit
+			const int weight = Weights[read(p == 0 ? 3 : 4)];
+			for (uint32_t c = 0; c < 4; c++)
+				pixels[p * 4 + c] = static_cast<uint8_t>(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+		}
+		return true;
+	}
+
+	inline bool DecodeBlock(BlockFormat format, const uint8_t* pBlock, uint8_t pixels[64])
+	{
+		switch (format)
+		{
+		case BlockFormat::BC1:
+			DecodeColor(pBlock, pixels, false);
+			return true;
+		case BlockFormat::BC3:
+			DecodeColor(pBlock + 8, pixels, true);
+			DecodeSingle(pBlock, pixels, 3);
+			return true;
+		case BlockFormat::BC5:
+			memset(pixels, 0, 64);
+			DecodeSingle(pBlock, pixels, 0);
+			DecodeSingle(pBlock + 8, pixels, 1);
+			return true;
+		default:
+			return DecodeBc7(pBlock, pixels);
+		}
+	}
+
+	// Channels the format stores, BC1 drops alpha and BC5 keeps red and green
+	inline uint32_t GetChannelCount(BlockFormat format)
+	{
+		return format == BlockFormat::BC1 ? 3 : format == BlockFormat::BC5 ? 2 : 4;
+	}
+
+	// Over the stored channels of a tightly packed width x height RGBA8 image, 99 when lossless
+	inline double GetPsnr(BlockFormat format, uint32_t width, uint32_t height, const std::vector<uint8_t>& source, const std::vector<uint8_t>& blocks)
+	{
+		const uint32_t blockWidth = BlockCompressor::GetBlockCount(width);
+		const uint32_t blockSize = BlockCompressor::GetBlockSize(format);
+		const uint32_t channelCount = GetChannelCount(format);
+		double squaredError = 0.0;
+		uint64_t sampleCount = 0;
+		for (uint32_t by = 0; by < BlockCompressor::GetBlockCount(height); by++)
+		{
+			for (uint32_t bx = 0; bx < blockWidth; bx++)
+			{
+				uint8_t pixels[64];
+				if (!DecodeBlock(format, blocks.data() + (uint64_t(by) * blockWidth + bx) * blockSize, pixels))
+					return 0.0;
+				for (uint32_t p = 0; p < 16; p++)
+				{
+					const uint32_t x = bx * 4 + p % 4;
+					const uint32_t y = by * 4 + p / 4;
+					if (x >= width || y >= height)
+						continue;
+					for (uint32_t c = 0; c < channelCount; c++)
+					{
+						const double difference = double(pixels[p * 4 + c]) - source[(uint64_t(y) * width + x) * 4 + c];
+						squaredError += difference * difference;
+						sampleCount++;
+					}
+				}
+			}
+		}
+		if (squaredError == 0.0)
+			return 99.0;
+		return 10.0 * std::log10(255.0 * 255.0 * sampleCount / squaredError);
+	}
+}
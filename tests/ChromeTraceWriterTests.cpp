@@ -0,0 +1,261 @@
+#include "TestFramework.h"
+#include "ChromeTraceWriter.h"
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace
+{
+	// Just enough of the protobuf wire format to walk a Perfetto trace
+	struct ProtoField
+	{
+		uint32_t number;
+		uint64_t value;
+		std::string bytes;
+	};
+
+	bool ReadVarint(const std::string& data, size_t& pos, uint64_t& value)
+	{
+		value = 0;
+		for (uint32_t shift = 0; pos < data.size() && shift < 64; shift += 7)
+		{
+			const uint8_t byte = static_cast<uint8_t>(data[pos++]);
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	bool ParseMessage(const std::string& data, std::vector<ProtoField>& fields)
+	{
+		fields.clear();
+		size_t pos = 0;
+		while (pos < data.size())
+		{
+			uint64_t tag;
+			ProtoField field = {};
+			if (!ReadVarint(data, pos, tag))
+				return false;
+			field.number = static_cast<uint32_t>(tag >> 3);
+
+			switch (tag & 7)
+			{
+			case 0:
+				if (!ReadVarint(data, pos, field.value))
+					return false;
+				break;
+			case 1:
+				if (data.size() - pos < 8)
+					return false;
+				memcpy(&field.value, data.data() + pos, 8);
+				pos += 8;
+				break;
+			case 2:
+				if (!ReadVarint(data, pos, field.value) || field.value > data.size() - pos)
+					return false;
+				field.bytes = data.substr(pos, static_cast<size_t>(field.value));
+				pos += static_cast<size_t>(field.value);
+				break;
+			default:
+				return false;
+			}
+			fields.push_back(field);
+		}
+		return true;
+	}
+
+	const ProtoField* FindField(const std::vector<ProtoField>& fields, uint32_t number)
+	{
+		for (const ProtoField& field : fields)
+		{
+			if (field.number == number)
+				return &field;
+		}
+		return nullptr;
+	}
+
+	size_t CountOf(const std::string& text, const std::string& pattern)
+	{
+		size_t count = 0;
+		for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+			count++;
+		return count;
+	}
+}
+
+TEST_CASE(WritesEveryEventKind)
+{
+	ChromeTraceWriter writer;
+	writer.SetProcessName(1, "GPU");
+	writer.SetThreadName(1, 2, "Direct queue");
+	writer.AddCompleteEvent("Opaque", "gpu", 1, 2, 1000.5, 250.25);
+	writer.AddInstantEvent("Present", "cpu", 3, 4, 2000.0);
+	writer.AddCounterEvent("Memory", 1, 3000.0, 0.5);
+	CHECK(writer.GetEventCount() == 5);
+
+	const std::string json = writer.ToJson();
+	CHECK(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+	CHECK(json.find("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}") != std::string::npos);
+	CHECK(json.find("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"Direct queue\"}}") != std::string::npos);
+	CHECK(json.find("{\"name\":\"Opaque\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":1000.500,\"dur\":250.250}") != std::string::npos);
+	CHECK(json.find("{\"name\":\"Present\",\"cat\":\"cpu\",\"ph\":\"i\",\"s\":\"t\",\"pid\":3,\"tid\":4,\"ts\":2000.000}") != std::string::npos);
+	CHECK(json.find("{\"name\":\"Memory\",\"cat\":\"counter\",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":3000.000,\"args\":{\"value\":0.5}}") != std::string::npos);
+	CHECK(json.size() >= 4 && json.compare(json.size() - 4, 4, "\n]}\n") == 0);
+	CHECK(CountOf(json, ",\n{") == 4);
+}
+
+TEST_CASE(NamesAreEscaped)
+{
+	ChromeTraceWriter writer;
+	writer.AddCompleteEvent("Say \"hi\"\\\n\t\x01", nullptr, 0, 0, 0.0, 1.0);
+	const std::string json = writer.ToJson();
+	CHECK(json.find("\"name\":\"Say \\\"hi\\\"\\\\\\n\\t\\u0001\",\"cat\":\"\"") != std::string::npos);
+}
+
+TEST_CASE(EventsPastTheLimitAreDropped)
+{
+	ChromeTraceWriter writer(3);
+	for (uint32_t n = 0; n < 10; n++)
+		writer.AddCompleteEvent("Scope", "cpu", 0, 0, n, 1.0);
+	CHECK(writer.GetEventCount() == 3);
+	CHECK(CountOf(writer.ToJson(), "\"ph\":\"X\"") == 3);
+
+	writer.Clear();
+	CHECK(writer.GetEventCount() == 0);
+	CHECK(writer.ToJson() == "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n]}\n");
+}
+
+TEST_CASE(WritesTheFile)
+{
+	ChromeTraceWriter writer;
+	writer.AddCompleteEvent("Frame", "cpu", 0, 0, 0.0, 16.6);
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "dxrt-chrome-trace-test.json";
+	REQUIRE(writer.Write(path));
+
+	std::ifstream file(path, std::ios::binary);
+	std::ostringstream contents;
+	contents << file.rdbuf();
+	CHECK(contents.str() == writer.ToJson());
+	file.close();
+	std::filesystem::remove(path);
+}
+
+TEST_CASE(PerfettoTracksAndNestedSlices)
+{
+	ChromeTraceWriter writer;
+	writer.SetProcessName(0, "CPU");
+	writer.SetThreadName(0, 1, "Main");
+	// Recorded as scopes close, children first, and sharing bounds with their parent
+	writer.AddCompleteEvent("Inner", "cpu", 0, 1, 100.0, 5.0);
+	writer.AddCompleteEvent("Outer", "cpu", 0, 1, 100.0, 10.0);
+	writer.AddCompleteEvent("Next", "cpu", 0, 1, 110.0, 2.0);
+	writer.AddInstantEvent("Frame", "frame", 0, 1, 110.0);
+	writer.AddCounterEvent("Memory", 0, 105.0, 1.5);
+	writer.AddCompleteEvent("Opaque", "gpu", 1, 0, 101.0, 3.0);
+
+	std::vector<ProtoField> packets;
+	const std::vector<uint8_t> data = writer.ToPerfetto();
+	REQUIRE(ParseMessage(std::string(data.begin(), data.end()), packets));
+
+	// Trace.packet, TracePacket.track_descriptor and track_event, TrackDescriptor and TrackEvent fields
+	std::map<uint64_t, std::string> trackNames;
+	std::vector<std::string> mainTrack;
+	uint64_t lastTimestamp = 0;
+	uint32_t counterCount = 0;
+	for (const ProtoField& packetField : packets)
+	{
+		CHECK(packetField.number == 1);
+		std::vector<ProtoField> packet;
+		REQUIRE(ParseMessage(packetField.bytes, packet));
+		const ProtoField* pSequence = FindField(packet, 10);
+		CHECK(pSequence && pSequence->value == 1);
+
+		std::vector<ProtoField> message;
+		if (const ProtoField* pDescriptor = FindField(packet, 60))
+		{
+			REQUIRE(ParseMessage(pDescriptor->bytes, message));
+			const ProtoField* pUuid = FindField(message, 1);
+			REQUIRE(pUuid != nullptr);
+			std::string name;
+			if (const ProtoField* pProcess = FindField(message, 3))
+			{
+				std::vector<ProtoField> process;
+				REQUIRE(ParseMessage(pProcess->bytes, process));
+				const ProtoField* pPid = FindField(process, 1);
+				const ProtoField* pName = FindField(process, 6);
+				REQUIRE(pPid && pName);
+				name = "process " + std::to_string(pPid->value) + " " + pName->bytes;
+			}
+			else
+			{
+				const ProtoField* pParent = FindField(message, 5);
+				const ProtoField* pName = FindField(message, 2);
+				REQUIRE(pParent && pName);
+				CHECK(trackNames.count(pParent->value) == 1);
+				name = (FindField(message, 8) ? "counter " : "track ") + pName->bytes;
+			}
+			CHECK(trackNames.emplace(pUuid->value, name).second);
+			continue;
+		}
+
+		const ProtoField* pTimestamp = FindField(packet, 8);
+		const ProtoField* pEvent = FindField(packet, 11);
+		REQUIRE(pTimestamp && pEvent);
+		CHECK(pTimestamp->value >= lastTimestamp);
+		lastTimestamp = pTimestamp->value;
+
+		REQUIRE(ParseMessage(pEvent->bytes, message));
+		const ProtoField* pType = FindField(message, 9);
+		const ProtoField* pTrack = FindField(message, 11);
+		REQUIRE(pType && pTrack);
+		REQUIRE(trackNames.count(pTrack->value) == 1);
+		if (pType->value == 4)
+		{
+			const ProtoField* pValue = FindField(message, 44);
+			REQUIRE(pValue != nullptr);
+			double value;
+			memcpy(&value, &pValue->value, sizeof(value));
+			CHECK(value == 1.5);
+			CHECK(trackNames[pTrack->value] == "counter Memory");
+			counterCount++;
+		}
+		else if (trackNames[pTrack->value] == "track Main")
+		{
+			const ProtoField* pName = FindField(message, 23);
+			mainTrack.push_back(std::to_string(pType->value) + (pName ? pName->bytes : "") + "@" + std::to_string(pTimestamp->value));
+		}
+	}
+
+	CHECK(counterCount == 1);
+	CHECK(trackNames.size() == 5);
+	// Unnamed processes and threads get a label from their id, pids are offset by one
+	CHECK(trackNames[1] == "process 1 CPU");
+	uint32_t gpuTrackCount = 0;
+	for (const auto& track : trackNames)
+		gpuTrackCount += track.second == "process 2 Process 1" || track.second == "track Thread 0" ? 1 : 0;
+	CHECK(gpuTrackCount == 2);
+
+	// 1 begin, 2 end, 3 instant. Ends at a time go before begins, the outer of two slices begins first.
+	const std::vector<std::string> expected = {
+		"1Outer@100000", "1Inner@100000", "2@105000", "2@110000", "1Next@110000", "3Frame@110000", "2@112000" };
+	CHECK(mainTrack == expected);
+}
+
+TEST_CASE(PerfettoFileIsPickedByExtension)
+{
+	ChromeTraceWriter writer;
+	writer.AddCompleteEvent("Frame", "cpu", 0, 0, 0.0, 16.6);
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "dxrt-perfetto-test.pftrace";
+	REQUIRE(writer.Write(path));
+
+	std::ifstream file(path, std::ios::binary);
+	std::ostringstream contents;
+	contents << file.rdbuf();
+	const std::vector<uint8_t> expected = writer.ToPerfetto();
+	CHECK(contents.str() == std::string(expected.begin(), expected.end()));
+	file.close();
+	std::filesystem::remove(path);
+}
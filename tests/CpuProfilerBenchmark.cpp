@@ -0,0 +1,79 @@
+#include "Benchmark.h"
+#include "CpuProfiler.h"
+
+// Cost of one PROFILE_SCOPE, disabled and enabled, against the 20 ns per scope budget. A batch fits in the
+// thread's buffer and is flushed between timings, as the renderer does once a frame.
+// The budget is held against the measured enabled scope. What it costs besides its two clock reads is
+// reported next to it, to tell a slow clock from slow recording.
+namespace
+{
+	const uint32_t BatchSize = 16384;
+	const double BudgetNanoseconds = 20.0;
+
+	void ProfiledBatch()
+	{
+		for (uint32_t n = 0; n < BatchSize; n++)
+		{
+			PROFILE_SCOPE("Scope");
+		}
+	}
+
+	void TicksBatch()
+	{
+		for (uint32_t n = 0; n < BatchSize; n++)
+		{
+			Benchmark::DoNotOptimize(CpuProfiler::GetTicks());
+		}
+	}
+
+	// Best batch, in nanoseconds per iteration
+	template <typename Function>
+	double MeasureBatches(uint32_t batchCount, ChromeTraceWriter& writer, Function&& function)
+	{
+		double best = 1e30;
+		for (uint32_t batch = 0; batch < batchCount; batch++)
+		{
+			const double start = Benchmark::GetSeconds();
+			function();
+			best = std::min(best, Benchmark::GetSeconds() - start);
+
+			CpuProfiler::Flush(writer, 0);
+			writer.Clear();
+		}
+		return best / BatchSize * 1e9;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const uint32_t batchCount = quick ? 4 : 200;
+	ChromeTraceWriter writer(BatchSize);
+
+	const double disabled = MeasureBatches(batchCount, writer, ProfiledBatch);
+	const double ticks = MeasureBatches(batchCount, writer, TicksBatch);
+
+	CpuProfiler::SetEnabled(true);
+	// First scope on the thread registers its buffer, keep it out of the timings
+	ProfiledBatch();
+	CpuProfiler::Flush(writer, 0);
+	const bool recorded = writer.GetEventCount() == BatchSize;
+	writer.Clear();
+
+	const double enabled = MeasureBatches(batchCount, writer, ProfiledBatch);
+	CpuProfiler::SetEnabled(false);
+
+	const double recording = enabled - 2.0 * ticks;
+	const bool withinBudget = enabled <= BudgetNanoseconds;
+
+	printf("Disabled scope: %.2f ns\n", disabled);
+	printf("Clock read: %.2f ns\n", ticks);
+	printf("Enabled scope: %.2f ns\n", enabled);
+	printf("Enabled scope besides its two clock reads: %.2f ns\n", recording);
+	printf("Budget of %.0f ns per enabled scope: %s\n", BudgetNanoseconds, withinBudget ? "met" : "not met on this machine");
+	printf("Dropped events: %llu\n", static_cast<unsigned long long>(CpuProfiler::GetDroppedEventCount()));
+
+	// Timings of a short smoke run on a loaded machine mean little, only full runs hold the budget
+	const bool budgetMet = quick || withinBudget;
+	return recorded && CpuProfiler::GetDroppedEventCount() == 0 && budgetMet ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+#include "TestFramework.h"
+#include "CpuProfiler.h"
+
+#include <thread>
+
+namespace
+{
+	size_t CountOf(const std::string& text, const std::string& pattern)
+	{
+		size_t count = 0;
+		for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+			count++;
+		return count;
+	}
+}
+
+// The profiler is process wide, each case drains what it recorded before it returns
+TEST_CASE(RecordsScopesCountersAndFrames)
+{
+	ChromeTraceWriter writer;
+	CpuProfiler::SetEnabled(true);
+	CpuProfiler::SetThreadName("Test main");
+	{
+		PROFILE_SCOPE("Outer");
+		{
+			PROFILE_SCOPE("Inner");
+		}
+		PROFILE_COUNTER("Draws", 42);
+	}
+	PROFILE_FRAME();
+	CpuProfiler::Flush(writer, 7);
+	CpuProfiler::SetEnabled(false);
+
+	const std::string json = writer.ToJson();
+	CHECK(json.find("\"args\":{\"name\":\"Test main\"}") != std::string::npos);
+	CHECK(CountOf(json, "\"ph\":\"X\"") == 2);
+	CHECK(json.find("\"name\":\"Inner\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":7") != std::string::npos);
+	CHECK(json.find("\"name\":\"Draws\",\"cat\":\"counter\",\"ph\":\"C\",\"pid\":7") != std::string::npos);
+	CHECK(json.find("\"value\":42}") != std::string::npos);
+	CHECK(json.find("\"name\":\"Frame\",\"cat\":\"frame\",\"ph\":\"i\"") != std::string::npos);
+
+	// Nothing is recorded while disabled, and a flush hands out each event once
+	writer.Clear();
+	{
+		PROFILE_SCOPE("Disabled");
+	}
+	CpuProfiler::Flush(writer, 7);
+	CHECK(writer.GetEventCount() == 0);
+}
+
+TEST_CASE(FullBufferDropsUntilTheNextFlush)
+{
+	// Larger than the 64K event buffer
+	const uint32_t eventCount = 70000;
+	ChromeTraceWriter writer(1 << 20);
+	CpuProfiler::SetEnabled(true);
+	const uint64_t droppedBefore = CpuProfiler::GetDroppedEventCount();
+
+	for (uint32_t n = 0; n < eventCount; n++)
+		CpuProfiler::RecordScope("Scope", n + 1, n + 2);
+	const uint64_t dropped = CpuProfiler::GetDroppedEventCount() - droppedBefore;
+	CHECK(dropped > 0);
+	CpuProfiler::Flush(writer, 0);
+	CHECK(writer.GetEventCount() + dropped == eventCount);
+
+	// Room again once flushed, across the wrap of the ring
+	writer.Clear();
+	for (uint32_t round = 0; round < 3; round++)
+	{
+		for (uint32_t n = 0; n < eventCount / 2; n++)
+			CpuProfiler::RecordScope("Scope", n + 1, n + 2);
+		CpuProfiler::Flush(writer, 0);
+	}
+	CpuProfiler::SetEnabled(false);
+	CHECK(CpuProfiler::GetDroppedEventCount() - droppedBefore == dropped);
+	CHECK(writer.GetEventCount() == 3 * (eventCount / 2));
+}
+
+TEST_CASE(EveryThreadGetsItsOwnTrack)
+{
+	ChromeTraceWriter writer;
+	CpuProfiler::SetEnabled(true);
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < 4; t++)
+	{
+		threads.emplace_back([]()
+		{
+			CpuProfiler::SetThreadName("Worker");
+			for (uint32_t n = 0; n < 1000; n++)
+			{
+				PROFILE_SCOPE("Job");
+			}
+		});
+	}
+	// Flushing while they record takes events as they come, nothing is lost or seen twice
+	for (uint32_t n = 0; n < 10; n++)
+		CpuProfiler::Flush(writer, 0);
+	for (std::thread& thread : threads)
+		thread.join();
+	CpuProfiler::Flush(writer, 0);
+	CpuProfiler::SetEnabled(false);
+
+	const std::string json = writer.ToJson();
+	CHECK(CountOf(json, "\"name\":\"Job\"") == 4000);
+	CHECK(CountOf(json, "\"args\":{\"name\":\"Worker\"}") == 4);
+}
@@ -0,0 +1,245 @@
+#include "TestFramework.h"
+#include "DdsFile.h"
+#include "DdsTestFile.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	DdsTestFile::Desc Make2D(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t mipCount)
+	{
+		DdsTestFile::Desc desc;
+		desc.format = format;
+		desc.width = width;
+		desc.height = height;
+		desc.mipCount = mipCount;
+		return desc;
+	}
+}
+
+TEST_CASE(FormatSizesCoverPixelsAndBlocks)
+{
+	uint32_t bytes = 0;
+	bool blockCompressed = false;
+	CHECK(DdsFile::GetFormatSize(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, bytes, blockCompressed) && bytes == 4 && !blockCompressed);
+	CHECK(DdsFile::GetFormatSize(DXGI_FORMAT_R32G32B32_FLOAT, bytes, blockCompressed) && bytes == 12 && !blockCompressed);
+	CHECK(DdsFile::GetFormatSize(DXGI_FORMAT_B5G6R5_UNORM, bytes, blockCompressed) && bytes == 2 && !blockCompressed);
+	CHECK(DdsFile::GetFormatSize(DXGI_FORMAT_BC1_UNORM_SRGB, bytes, blockCompressed) && bytes == 8 && blockCompressed);
+	CHECK(DdsFile::GetFormatSize(DXGI_FORMAT_BC4_SNORM, bytes, blockCompressed) && bytes == 8 && blockCompressed);
+	CHECK(DdsFile::GetFormatSize(DXGI_FORMAT_BC7_UNORM, bytes, blockCompressed) && bytes == 16 && blockCompressed);
+	CHECK(!DdsFile::GetFormatSize(DXGI_FORMAT_UNKNOWN, bytes, blockCompressed));
+	CHECK(!DdsFile::GetFormatSize(DXGI_FORMAT_NV12, bytes, blockCompressed));
+}
+
+TEST_CASE(MipChainPointsIntoTheFile)
+{
+	const DdsTestFile::Desc desc = Make2D(DXGI_FORMAT_R8G8B8A8_UNORM, 300, 77, 9);
+	const std::vector<uint8_t> data = DdsTestFile::Write(desc, 1);
+	DdsFile file;
+	REQUIRE(file.Parse(data.data(), data.size()));
+	CHECK(file.GetDimension() == DdsFile::Dimension::Texture2D);
+	CHECK(file.GetFormat() == DXGI_FORMAT_R8G8B8A8_UNORM);
+	CHECK(file.GetWidth() == 300 && file.GetHeight() == 77 && file.GetDepth() == 1);
+	CHECK(file.GetMipCount() == 9 && file.GetArraySize() == 1 && !file.IsCubemap());
+
+	const std::vector<DdsFile::Subresource>& subresources = file.GetSubresources();
+	REQUIRE(subresources.size() == 9);
+	// Zero copy: the first mip starts right after the headers, each one follows the last
+	const uint8_t* pExpected = data.data() + DdsTestFile::HeaderSize + DdsTestFile::Dx10HeaderSize;
+	uint32_t width = 300;
+	uint32_t height = 77;
+	for (const DdsFile::Subresource& subresource : subresources)
+	{
+		CHECK(subresource.pData == pExpected);
+		CHECK(subresource.width == width && subresource.height == height && subresource.depth == 1);
+		CHECK(subresource.rowPitch == width * 4);
+		CHECK(subresource.rowCount == height);
+		CHECK(subresource.slicePitch == subresource.rowPitch * height);
+		pExpected += subresource.slicePitch;
+		width = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+	}
+	CHECK(pExpected == data.data() + data.size());
+}
+
+TEST_CASE(BlockCompressedPitchesCountRowsOfBlocks)
+{
+	const std::vector<uint8_t> data = DdsTestFile::Write(Make2D(DXGI_FORMAT_BC7_UNORM, 30, 9, 5), 2);
+	DdsFile file;
+	REQUIRE(file.Parse(data.data(), data.size()));
+	const std::vector<DdsFile::Subresource>& subresources = file.GetSubresources();
+	REQUIRE(subresources.size() == 5);
+	// 30x9, 15x4, 7x2, 3x1, 1x1
+	const uint64_t rowPitches[] = { 8 * 16, 4 * 16, 2 * 16, 16, 16 };
+	const uint32_t rowCounts[] = { 3, 1, 1, 1, 1 };
+	for (uint32_t mip = 0; mip < 5; mip++)
+	{
+		CHECK(subresources[mip].rowPitch == rowPitches[mip]);
+		CHECK(subresources[mip].rowCount == rowCounts[mip]);
+	}
+	CHECK(subresources[1].width == 15 && subresources[1].height == 4);
+}
+
+TEST_CASE(ArraysAndCubemapsAreSliceMajor)
+{
+	DdsTestFile::Desc desc = Make2D(DXGI_FORMAT_BC1_UNORM, 32, 32, 6);
+	desc.arraySize = 3;
+	desc.cubemap = true;
+	const std::vector<uint8_t> data = DdsTestFile::Write(desc, 3);
+	DdsFile file;
+	REQUIRE(file.Parse(data.data(), data.size()));
+	CHECK(file.IsCubemap());
+	CHECK(file.GetArraySize() == 18);
+	const std::vector<DdsFile::Subresource>& subresources = file.GetSubresources();
+	REQUIRE(subresources.size() == 18 * 6);
+
+	// D3D12 order, mip + slice * mipCount: every slice starts over at the full size
+	const uint64_t chainSize = DdsTestFile::GetDataSize(Make2D(DXGI_FORMAT_BC1_UNORM, 32, 32, 6));
+	for (uint32_t slice = 0; slice < 18; slice++)
+	{
+		const DdsFile::Subresource& top = subresources[slice * 6];
+		CHECK(top.width == 32);
+		CHECK(static_cast<const uint8_t*>(top.pData) == static_cast<const uint8_t*>(subresources[0].pData) + slice * chainSize);
+		CHECK(subresources[slice * 6 + 5].width == 1);
+	}
+}
+
+TEST_CASE(VolumesAndLinesHaveTheirDimensions)
+{
+	DdsTestFile::Desc volume = Make2D(DXGI_FORMAT_R16G16B16A16_FLOAT, 32, 16, 6);
+	volume.dimension = DdsFile::Dimension::Texture3D;
+	volume.depth = 8;
+	std::vector<uint8_t> data = DdsTestFile::Write(volume, 4);
+	DdsFile file;
+	REQUIRE(file.Parse(data.data(), data.size()));
+	CHECK(file.GetDimension() == DdsFile::Dimension::Texture3D);
+	CHECK(file.GetDepth() == 8);
+	REQUIRE(file.GetSubresources().size() == 6);
+	CHECK(file.GetSubresources()[0].depth == 8);
+	CHECK(file.GetSubresources()[3].depth == 1);
+	CHECK(file.GetSubresources()[3].width == 4 && file.GetSubresources()[3].height == 2);
+
+	DdsTestFile::Desc line = Make2D(DXGI_FORMAT_R8_UNORM, 512, 1, 10);
+	line.dimension = DdsFile::Dimension::Texture1D;
+	line.arraySize = 2;
+	data = DdsTestFile::Write(line, 5);
+	REQUIRE(file.Parse(data.data(), data.size()));
+	CHECK(file.GetDimension() == DdsFile::Dimension::Texture1D);
+	CHECK(file.GetHeight() == 1 && file.GetArraySize() == 2);
+	CHECK(file.GetSubresources().size() == 20);
+}
+
+TEST_CASE(LegacyHeadersMapToDxgiFormats)
+{
+	for (const DdsTestFile::Desc& desc : DdsTestFile::GetVariety())
+	{
+		if (desc.dx10)
+			continue;
+		const std::vector<uint8_t> data = DdsTestFile::Write(desc, 6);
+		DdsFile file;
+		REQUIRE(file.Parse(data.data(), data.size()));
+		CHECK(file.GetFormat() == desc.format);
+		CHECK(file.IsCubemap() == desc.cubemap);
+		CHECK(file.GetArraySize() == (desc.cubemap ? 6u : 1u));
+		CHECK(file.GetDimension() == desc.dimension);
+		const DdsFile::Subresource& last = file.GetSubresources().back();
+		CHECK(static_cast<const uint8_t*>(last.pData) + last.slicePitch * last.depth == data.data() + data.size());
+	}
+}
+
+TEST_CASE(EveryLayoutCoversTheWholeFile)
+{
+	for (const DdsTestFile::Desc& desc : DdsTestFile::GetVariety())
+	{
+		const std::vector<uint8_t> data = DdsTestFile::Write(desc, 7);
+		DdsFile file;
+		REQUIRE(file.Parse(data.data(), data.size()));
+		const uint32_t sliceCount = desc.arraySize * (desc.cubemap ? 6 : 1);
+		CHECK(file.GetSubresources().size() == sliceCount * desc.mipCount);
+		uint64_t size = 0;
+		for (const DdsFile::Subresource& subresource : file.GetSubresources())
+			size += subresource.slicePitch * subresource.depth;
+		CHECK(size == DdsTestFile::GetDataSize(desc));
+	}
+}
+
+TEST_CASE(MalformedHeadersAreRejected)
+{
+	const DdsTestFile::Desc desc = Make2D(DXGI_FORMAT_R8G8B8A8_UNORM, 64, 64, 7);
+	const std::vector<uint8_t> valid = DdsTestFile::Write(desc, 8);
+	auto parseWith = [&valid](size_t offset, uint32_t value)
+	{
+		std::vector<uint8_t> data = valid;
+		memcpy(data.data() + offset, &value, sizeof(value));
+		DdsFile file;
+		return file.Parse(data.data(), data.size());
+	};
+
+	// Offsets into the magic, the header and the DX10 extension
+	CHECK(!parseWith(0, 0x20534445));
+	CHECK(!parseWith(4, 123));
+	CHECK(!parseWith(4 + 72, 31));
+	CHECK(!parseWith(4 + 8, 0));
+	CHECK(!parseWith(4 + 12, 0));
+	CHECK(!parseWith(4 + 12, 16385));
+	// More mips than the size allows
+	CHECK(!parseWith(4 + 24, 8));
+	CHECK(!parseWith(128, DXGI_FORMAT_UNKNOWN));
+	CHECK(!parseWith(128 + 4, 7));
+	CHECK(!parseWith(128 + 12, 0));
+	CHECK(!parseWith(128 + 12, 2049));
+
+	// A cube whose faces aren't square
+	DdsTestFile::Desc cube = Make2D(DXGI_FORMAT_R8G8B8A8_UNORM, 64, 32, 1);
+	cube.cubemap = true;
+	const std::vector<uint8_t> data = DdsTestFile::Write(cube, 9);
+	DdsFile file;
+	CHECK(!file.Parse(data.data(), data.size()));
+}
+
+TEST_CASE(TruncatedFilesFailCleanly)
+{
+	for (const DdsTestFile::Desc& desc : DdsTestFile::GetVariety())
+	{
+		// Small files only, every offset through them
+		if (DdsTestFile::GetDataSize(desc) > 64 * 1024)
+			continue;
+		const std::vector<uint8_t> data = DdsTestFile::Write(desc, 10);
+		uint32_t parsed = 0;
+		for (size_t size = 0; size < data.size(); size += 7)
+		{
+			DdsFile file;
+			parsed += file.Parse(data.data(), size) ? 1 : 0;
+			CHECK(file.GetSubresources().empty());
+		}
+		CHECK(parsed == 0);
+	}
+}
+
+TEST_CASE(CorruptHeadersStayInBounds)
+{
+	std::mt19937 rng(11);
+	for (const DdsTestFile::Desc& desc : DdsTestFile::GetVariety())
+	{
+		const std::vector<uint8_t> valid = DdsTestFile::Write(desc, 12);
+		const size_t headerSize = DdsTestFile::HeaderSize + (desc.dx10 ? DdsTestFile::Dx10HeaderSize : 0);
+		uint32_t outOfBounds = 0;
+		for (uint32_t i = 0; i < 100; i++)
+		{
+			std::vector<uint8_t> data = valid;
+			data[rng() % headerSize] = static_cast<uint8_t>(rng());
+			DdsFile file;
+			if (!file.Parse(data.data(), data.size()))
+				continue;
+			for (const DdsFile::Subresource& subresource : file.GetSubresources())
+			{
+				const uint8_t* pBegin = static_cast<const uint8_t*>(subresource.pData);
+				const uint8_t* pEnd = pBegin + subresource.slicePitch * subresource.depth;
+				outOfBounds += pBegin < data.data() + headerSize || pEnd > data.data() + data.size() ? 1 : 0;
+			}
+		}
+		CHECK(outOfBounds == 0);
+	}
+}
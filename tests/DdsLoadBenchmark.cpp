@@ -0,0 +1,91 @@
+#include "Benchmark.h"
+#include "DdsFile.h"
+#include "DdsTestFile.h"
+#include "MappedFile.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// DDS load time across a generated corpus: each file is mapped and parsed, then every cache line of its subresources
+// is read once, as the staging copy does. The baseline reads each file into a heap vector first.
+// The page cache is warm after the first pass; cold numbers need the cache dropped between runs.
+namespace
+{
+	// Parses and touches every subresource, returns false if a file doesn't parse
+	bool Touch(const void* pData, size_t size, uint64_t& sum, uint64_t& bytes)
+	{
+		DdsFile file;
+		if (!file.Parse(pData, size))
+			return false;
+		for (const DdsFile::Subresource& subresource : file.GetSubresources())
+		{
+			const uint8_t* pBytes = static_cast<const uint8_t*>(subresource.pData);
+			const uint64_t subresourceSize = subresource.slicePitch * subresource.depth;
+			for (uint64_t i = 0; i < subresourceSize; i += 64)
+				sum += pBytes[i];
+			bytes += subresourceSize;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const uint32_t fileCount = quick ? 100 : 4000;
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "dxrt-dds-corpus";
+
+	const std::vector<DdsTestFile::Desc> variety = DdsTestFile::GetVariety();
+	std::vector<std::filesystem::path> paths;
+	uint64_t corpusSize = 0;
+	std::filesystem::create_directories(directory);
+	for (uint32_t i = 0; i < fileCount; i++)
+	{
+		const std::vector<uint8_t> data = DdsTestFile::Write(variety[i % variety.size()], i);
+		paths.push_back(directory / (std::to_string(i) + ".dds"));
+		std::ofstream(paths.back(), std::ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size());
+		corpusSize += data.size();
+	}
+	printf("%u files, %.1f MB\n", fileCount, corpusSize / 1048576.0);
+
+	bool failed = false;
+	uint64_t mappedSum = 0;
+	uint64_t readSum = 0;
+	uint64_t bytes = 0;
+	const double mappedTime = Benchmark::Measure(quick ? 1 : 3, [&]()
+	{
+		mappedSum = 0;
+		bytes = 0;
+		for (const std::filesystem::path& path : paths)
+		{
+			MappedFile file;
+			if (!file.Open(path) || !Touch(file.GetData(), file.GetSize(), mappedSum, bytes))
+				failed = true;
+		}
+	});
+	const double readTime = Benchmark::Measure(quick ? 1 : 3, [&]()
+	{
+		readSum = 0;
+		uint64_t readBytes = 0;
+		for (const std::filesystem::path& path : paths)
+		{
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+			file.seekg(0);
+			file.read(reinterpret_cast<char*>(data.data()), data.size());
+			if (!Touch(data.data(), data.size(), readSum, readBytes))
+				failed = true;
+		}
+	});
+
+	printf("mapped: %.1f ms, %.1f us per file, %.0f MB/s\n", mappedTime * 1e3, mappedTime * 1e6 / fileCount, bytes / 1048576.0 / mappedTime);
+	printf("read into a vector: %.1f ms, %.1f us per file, %.0f MB/s\n", readTime * 1e3, readTime * 1e6 / fileCount, bytes / 1048576.0 / readTime);
+
+	std::filesystem::remove_all(directory);
+	failed = failed || mappedSum != readSum;
+	if (failed)
+		printf("A file failed to load, or the two paths read different bytes\n");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "DdsFile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Writes DDS files for DdsFileTests and DdsLoadBenchmark, independently of the parser's own structs.
+namespace DdsTestFile
+{
+	struct Desc
+	{
+		DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		// With the DX10 extension, otherwise the legacy pixel format below
+		bool dx10 = true;
+		DdsFile::Dimension dimension = DdsFile::Dimension::Texture2D;
+		uint32_t width = 1;
+		uint32_t height = 1;
+		uint32_t depth = 1;
+		uint32_t mipCount = 1;
+		// Cubes, not faces, when cubemap is set
+		uint32_t arraySize = 1;
+		bool cubemap = false;
+
+		uint32_t pixelFlags = 0;
+		uint32_t fourCC = 0;
+		uint32_t rgbBitCount = 0;
+		uint32_t masks[4] = {};
+	};
+
+	// Legacy pixel format flags
+	const uint32_t PixelFourCC = 0x4;
+	const uint32_t PixelRgb = 0x40;
+	const uint32_t PixelAlphaPixels = 0x1;
+
+	const uint32_t HeaderSize = 4 + 124;
+	const uint32_t Dx10HeaderSize = 20;
+
+	// Subresource bytes, array slices times the mip chain
+	inline uint64_t GetDataSize(const Desc& desc)
+	{
+		uint32_t bytes = 0;
+		bool blockCompressed = false;
+		DdsFile::GetFormatSize(desc.format, bytes, blockCompressed);
+		uint64_t size = 0;
+		uint32_t width = desc.width;
+		uint32_t height = desc.height;
+		uint32_t depth = desc.depth;
+		for (uint32_t mip = 0; mip < desc.mipCount; mip++)
+		{
+			if (blockCompressed)
+				size += uint64_t((width + 3) / 4) * bytes * ((height + 3) / 4) * depth;
+			else
+				size += uint64_t(width) * bytes * height * depth;
+			width = std::max(1u, width / 2);
+			height = std::max(1u, height / 2);
+			depth = std::max(1u, depth / 2);
+		}
+		return size * desc.arraySize * (desc.cubemap ? 6 : 1);
+	}
+
+	// Header followed by random subresource bytes
+	inline std::vector<uint8_t> Write(const Desc& desc, uint32_t seed)
+	{
+		std::vector<uint8_t> file;
+		auto write = [&file](uint32_t value)
+		{
+			for (uint32_t i = 0; i < 4; i++)
+				file.push_back(static_cast<uint8_t>(value >> (i * 8)));
+		};
+
+		const bool volume = desc.dimension == DdsFile::Dimension::Texture3D;
+		write(DdsFile::Magic);
+		write(124);
+		// Caps, height, width, pixel format, mip count and depth
+		write(0x1007 | 0x20000 | (volume ? 0x800000 : 0));
+		write(desc.height);
+		write(desc.width);
+		write(0);
+		write(volume ? desc.depth : 0);
+		write(desc.mipCount);
+		for (uint32_t i = 0; i < 11; i++)
+			write(0);
+
+		write(32);
+		if (desc.dx10)
+		{
+			write(PixelFourCC);
+			write(0x30315844);
+			for (uint32_t i = 0; i < 5; i++)
+				write(0);
+		}
+		else
+		{
+			write(desc.pixelFlags);
+			write(desc.fourCC);
+			write(desc.rgbBitCount);
+			for (uint32_t mask : desc.masks)
+				write(mask);
+		}
+
+		write(0x1000);
+		uint32_t caps2 = 0;
+		if (!desc.dx10 && desc.cubemap)
+			caps2 = 0x200 | 0xFC00;
+		else if (!desc.dx10 && volume)
+			caps2 = 0x200000;
+		write(caps2);
+		for (uint32_t i = 0; i < 3; i++)
+			write(0);
+
+		if (desc.dx10)
+		{
+			write(desc.format);
+			write(desc.dimension == DdsFile::Dimension::Texture1D ? 2 : volume ? 4 : 3);
+			write(desc.cubemap ? 0x4 : 0);
+			write(desc.arraySize);
+			write(0);
+		}
+
+		const size_t headerSize = file.size();
+		file.resize(headerSize + GetDataSize(desc));
+		std::mt19937 rng(seed);
+		for (size_t i = headerSize; i < file.size(); i++)
+			file[i] = static_cast<uint8_t>(rng());
+		return file;
+	}
+
+	// One of each kind of layout, for each of a spread of formats, plus legacy headers
+	inline std::vector<Desc> GetVariety()
+	{
+		using Dimension = DdsFile::Dimension;
+		std::vector<Desc> descs;
+		const DXGI_FORMAT formats[] = { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC5_UNORM,
+			DXGI_FORMAT_BC7_UNORM_SRGB, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R8_UNORM,
+			DXGI_FORMAT_BC6H_UF16, DXGI_FORMAT_B8G8R8A8_UNORM };
+		for (DXGI_FORMAT format : formats)
+		{
+			auto add = [&](Dimension dimension, uint32_t width, uint32_t height, uint32_t depth, uint32_t mipCount, uint32_t arraySize, bool cubemap)
+			{
+				Desc desc;
+				desc.format = format;
+				desc.dimension = dimension;
+				desc.width = width;
+				desc.height = height;
+				desc.depth = depth;
+				desc.mipCount = mipCount;
+				desc.arraySize = arraySize;
+				desc.cubemap = cubemap;
+				descs.push_back(desc);
+			};
+			add(Dimension::Texture2D, 256, 256, 1, 9, 1, false);
+			add(Dimension::Texture2D, 300, 77, 1, 9, 1, false);
+			add(Dimension::Texture2D, 64, 64, 1, 7, 4, false);
+			add(Dimension::Texture2D, 128, 128, 1, 8, 1, true);
+			add(Dimension::Texture2D, 32, 32, 1, 6, 3, true);
+			add(Dimension::Texture1D, 512, 1, 1, 10, 2, false);
+			add(Dimension::Texture3D, 32, 16, 8, 6, 1, false);
+			add(Dimension::Texture2D, 512, 512, 1, 1, 1, false);
+		}
+
+		auto addLegacy = [&](DXGI_FORMAT format, Dimension dimension, uint32_t size, uint32_t depth, uint32_t mipCount, bool cubemap,
+			uint32_t pixelFlags, uint32_t fourCC, uint32_t rgbBitCount, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+		{
+			Desc desc;
+			desc.format = format;
+			desc.dx10 = false;
+			desc.dimension = dimension;
+			desc.width = size;
+			desc.height = size;
+			desc.depth = depth;
+			desc.mipCount = mipCount;
+			desc.cubemap = cubemap;
+			desc.pixelFlags = pixelFlags;
+			desc.fourCC = fourCC;
+			desc.rgbBitCount = rgbBitCount;
+			desc.masks[0] = r;
+			desc.masks[1] = g;
+			desc.masks[2] = b;
+			desc.masks[3] = a;
+			descs.push_back(desc);
+		};
+		addLegacy(DXGI_FORMAT_BC1_UNORM, Dimension::Texture2D, 256, 1, 9, false, PixelFourCC, 0x31545844, 0, 0, 0, 0, 0);
+		addLegacy(DXGI_FORMAT_BC3_UNORM, Dimension::Texture2D, 128, 1, 8, true, PixelFourCC, 0x35545844, 0, 0, 0, 0, 0);
+		addLegacy(DXGI_FORMAT_R8G8B8A8_UNORM, Dimension::Texture2D, 100, 1, 7, false, PixelRgb | PixelAlphaPixels, 0, 32,
+			0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000);
+		addLegacy(DXGI_FORMAT_B8G8R8A8_UNORM, Dimension::Texture3D, 16, 16, 5, false, PixelRgb | PixelAlphaPixels, 0, 32,
+			0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+		addLegacy(DXGI_FORMAT_B5G6R5_UNORM, Dimension::Texture2D, 64, 1, 1, false, PixelRgb, 0, 16, 0xF800, 0x07E0, 0x001F, 0);
+		// D3DFMT_A16B16G16R16F as the fourCC
+		addLegacy(DXGI_FORMAT_R16G16B16A16_FLOAT, Dimension::Texture2D, 64, 1, 7, false, PixelFourCC, 113, 0, 0, 0, 0, 0);
+		return descs;
+	}
+}
@@ -0,0 +1,112 @@
+#include "Benchmark.h"
+#include "DescriptorIndexAllocator.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Allocation throughput of DescriptorAllocator's index bookkeeping: persistent descriptors from the
+// lock-free IndexFreeList, alone and contended by several threads, and per-frame transient tables.
+namespace
+{
+	void Report(const char* name, double operations, double time)
+	{
+		printf("%-32s %8.1f M ops/s %8.1f ns per op\n", name, operations / time / 1e6, time / operations * 1e9);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const uint32_t capacity = 16384;
+	const uint32_t roundCount = quick ? 10 : 1000;
+	uint64_t failures = 0;
+
+	// Fill and drain the whole free list, the pattern of loading then unloading a level
+	{
+		IndexFreeList freeList(capacity);
+		std::vector<uint32_t> indices(capacity);
+		const double time = Benchmark::Measure(3, [&]()
+		{
+			for (uint32_t round = 0; round < roundCount; round++)
+			{
+				for (uint32_t n = 0; n < capacity; n++)
+					indices[n] = freeList.Allocate();
+				for (uint32_t n = 0; n < capacity; n++)
+					freeList.Free(indices[n]);
+			}
+		});
+		for (uint32_t index : indices)
+			failures += index == IndexFreeList::InvalidIndex ? 1 : 0;
+		Report("IndexFreeList fill/drain", 2.0 * capacity * roundCount, time);
+	}
+
+	// Short lived descriptors churned by every thread at once
+	const unsigned int threadCount = quick ? 2 : std::max(2u, std::thread::hardware_concurrency());
+	for (unsigned int threads = 1; threads <= threadCount; threads *= 2)
+	{
+		DescriptorIndexAllocator allocator;
+		allocator.Init(capacity, 0, 1024);
+		const uint32_t churnCount = quick ? 10000 : 1000000;
+		std::atomic<uint64_t> threadFailures = 0;
+
+		const double time = Benchmark::Measure(3, [&]()
+		{
+			std::vector<std::thread> workers;
+			for (unsigned int t = 0; t < threads; t++)
+			{
+				workers.emplace_back([&]()
+				{
+					uint32_t held[8];
+					for (uint32_t n = 0; n < churnCount; n += 8)
+					{
+						for (uint32_t& index : held)
+							index = allocator.AllocatePersistent();
+						for (uint32_t index : held)
+						{
+							if (index == DescriptorIndexAllocator::InvalidIndex)
+								threadFailures++;
+							else
+								allocator.FreePersistent(index);
+						}
+					}
+				});
+			}
+			for (std::thread& worker : workers)
+				worker.join();
+		});
+		failures += threadFailures;
+
+		char name[64];
+		snprintf(name, sizeof(name), "Persistent churn, %u threads", threads);
+		Report(name, 2.0 * churnCount * threads, time);
+	}
+
+	// Transient tables of a few descriptors, retired two frames later
+	{
+		DescriptorIndexAllocator allocator;
+		allocator.Init(0, capacity);
+		const uint32_t frameCount = quick ? 100 : 10000;
+		const uint32_t tablesPerFrame = 1000;
+		const double time = Benchmark::Measure(3, [&]()
+		{
+			allocator.Init(0, capacity);
+			for (uint64_t frame = 1; frame <= frameCount; frame++)
+			{
+				for (uint32_t n = 0; n < tablesPerFrame; n++)
+				{
+					const uint32_t index = allocator.AllocateTransient(1 + n % 4);
+					failures += index == DescriptorIndexAllocator::InvalidIndex ? 1 : 0;
+					Benchmark::DoNotOptimize(index);
+				}
+				allocator.FinishBatch(frame);
+				if (frame > 2)
+					allocator.Retire(frame - 2);
+			}
+		});
+		Report("Transient tables", double(frameCount) * tablesPerFrame, time);
+	}
+
+	printf("%llu failed\n", static_cast<unsigned long long>(failures));
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+#include "TestFramework.h"
+#include "DescriptorIndexAllocator.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+TEST_CASE(RegionsFollowTheBindlessTable)
+{
+	DescriptorIndexAllocator allocator;
+	allocator.Init(4, 8, 16);
+	CHECK(allocator.GetBindlessCount() == 16);
+	CHECK(allocator.GetDescriptorCount() == 28);
+
+	for (uint32_t n = 0; n < 4; n++)
+		CHECK(allocator.AllocatePersistent() == 16 + n);
+	CHECK(allocator.AllocatePersistent() == DescriptorIndexAllocator::InvalidIndex);
+
+	allocator.FreePersistent(18);
+	CHECK(allocator.AllocatePersistent() == 18);
+
+	CHECK(allocator.AllocateTransient(3) == 20);
+	CHECK(allocator.AllocateTransient(5) == 23);
+	CHECK(allocator.AllocateTransient(1) == DescriptorIndexAllocator::InvalidIndex);
+}
+
+TEST_CASE(TransientTablesRetireByFenceValue)
+{
+	DescriptorIndexAllocator allocator;
+	allocator.Init(0, 8);
+	CHECK(allocator.AllocateTransient(6) == 0);
+	allocator.FinishBatch(1);
+	CHECK(allocator.AllocateTransient(4) == DescriptorIndexAllocator::InvalidIndex);
+
+	allocator.Retire(1);
+	CHECK(allocator.AllocateTransient(4) == 0);
+}
+
+TEST_CASE(EmptyRegionsNeverAllocate)
+{
+	DescriptorIndexAllocator allocator;
+	allocator.Init(0, 0, 64);
+	CHECK(allocator.GetDescriptorCount() == 64);
+	CHECK(allocator.AllocatePersistent() == DescriptorIndexAllocator::InvalidIndex);
+	CHECK(allocator.AllocateTransient(1) == DescriptorIndexAllocator::InvalidIndex);
+	allocator.FinishBatch(1);
+	allocator.Retire(1);
+}
+
+TEST_CASE(ConcurrentPersistentIndicesAreUnique)
+{
+	const uint32_t capacity = 4096;
+	const uint32_t threadCount = 4;
+	DescriptorIndexAllocator allocator;
+	allocator.Init(capacity, 0);
+
+	// Every thread churns, then keeps its share, so all indices end up handed out exactly once
+	std::vector<std::vector<uint32_t>> held(threadCount);
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < threadCount; t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (uint32_t n = 0; n < 10000; n++)
+			{
+				const uint32_t index = allocator.AllocatePersistent();
+				if (index != DescriptorIndexAllocator::InvalidIndex)
+					allocator.FreePersistent(index);
+			}
+			for (uint32_t n = 0; n < capacity / threadCount; n++)
+				held[t].push_back(allocator.AllocatePersistent());
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	std::vector<uint32_t> all;
+	for (const std::vector<uint32_t>& indices : held)
+		all.insert(all.end(), indices.begin(), indices.end());
+	std::sort(all.begin(), all.end());
+	REQUIRE(all.size() == capacity);
+	for (uint32_t n = 0; n < capacity; n++)
+		CHECK(all[n] == n);
+	CHECK(allocator.AllocatePersistent() == DescriptorIndexAllocator::InvalidIndex);
+}
@@ -0,0 +1,90 @@
+#include "Benchmark.h"
+#include "CpuFeatures.h"
+#include "FormatConverter.h"
+#include "JobSystem.h"
+
+#include <random>
+#include <thread>
+#include <vector>
+
+// Format conversion throughput on a 4K image for the conversions the loader and backbuffer readback use,
+// scalar and AVX2 on one thread, then AVX2 on the job system. Fails if the backends disagree.
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const uint32_t width = quick ? 384 : 3840;
+	const uint32_t height = quick ? 216 : 2160;
+
+	struct Conversion
+	{
+		DXGI_FORMAT source;
+		DXGI_FORMAT dest;
+		const char* pName;
+	};
+	const Conversion conversions[] =
+	{
+		{ DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R16G16B16A16_FLOAT, "sRGB8 -> RGBA16F" },
+		{ DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R10G10B10A2_UNORM, "RGBA16F -> RGB10A2" },
+		{ DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R8G8B8A8_UNORM, "RGBA16F -> RGBA8" },
+		{ DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R11G11B10_FLOAT, "RGBA32F -> R11G11B10F" },
+		{ DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_B8G8R8A8_UNORM, "RGBA8 -> BGRA8" }
+	};
+
+	// Random bytes, with floats kept to the 0 to 4 range of HDR colour
+	std::vector<uint8_t> source(size_t(width) * height * 16);
+	std::mt19937 rng(1);
+	for (uint8_t& value : source)
+		value = static_cast<uint8_t>(rng());
+	std::vector<float> floats(size_t(width) * height * 4);
+	for (float& value : floats)
+		value = float(rng() % 40000) / 10000.0f;
+
+	JobSystem jobs;
+	printf("%ux%u, %u hardware threads\n", width, height, std::thread::hardware_concurrency());
+
+	bool failed = false;
+	for (const Conversion& conversion : conversions)
+	{
+		const uint32_t sourcePixelSize = FormatConverter::GetPixelSize(conversion.source);
+		const uint32_t destPixelSize = FormatConverter::GetPixelSize(conversion.dest);
+		std::vector<uint8_t> input(size_t(width) * height * sourcePixelSize);
+		if (conversion.source == DXGI_FORMAT_R32G32B32A32_FLOAT)
+			memcpy(input.data(), floats.data(), input.size());
+		else if (conversion.source == DXGI_FORMAT_R16G16B16A16_FLOAT)
+		{
+			// Halves of the same range, through the converter itself
+			const FormatConversionDesc desc = { width, height, 1, floats.data(), uint64_t(width) * 16, uint64_t(width) * 16 * height,
+				input.data(), uint64_t(width) * 8, uint64_t(width) * 8 * height };
+			FormatConverter::Convert(FormatConverter::Settings(), DXGI_FORMAT_R32G32B32A32_FLOAT, conversion.source, &desc, 1);
+		}
+		else
+			memcpy(input.data(), source.data(), input.size());
+
+		std::vector<uint8_t> scalarOutput(size_t(width) * height * destPixelSize);
+		std::vector<uint8_t> output(scalarOutput.size());
+		auto measure = [&](bool allowAvx2, JobSystem* pJobSystem, std::vector<uint8_t>& dest)
+		{
+			FormatConverter::Settings settings;
+			settings.allowAvx2 = allowAvx2;
+			const FormatConversionDesc desc = { width, height, 1, input.data(), uint64_t(width) * sourcePixelSize,
+				uint64_t(width) * sourcePixelSize * height, dest.data(), uint64_t(width) * destPixelSize, uint64_t(width) * destPixelSize * height };
+			const double time = Benchmark::Measure(quick ? 1 : 5, [&]()
+			{
+				FormatConverter::Convert(settings, conversion.source, conversion.dest, &desc, 1, pJobSystem);
+			});
+			return double(width) * height / time / 1e6;
+		};
+
+		printf("%-22s scalar %6.1f Mpixel/s", conversion.pName, measure(false, nullptr, scalarOutput));
+		if (CpuFeatures::HasAvx2())
+		{
+			printf(", AVX2 %6.1f Mpixel/s", measure(true, nullptr, output));
+			failed = failed || output != scalarOutput;
+		}
+		printf(", jobs %6.1f Mpixel/s\n", measure(true, &jobs, output));
+		failed = failed || output != scalarOutput;
+	}
+	if (failed)
+		printf("Output differs between backends\n");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,347 @@
+#include "TestFramework.h"
+#include "CpuFeatures.h"
+#include "FormatConverter.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	const DXGI_FORMAT AllFormats[] =
+	{
+		DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R16G16B16A16_UNORM,
+		DXGI_FORMAT_R16G16B16A16_SNORM, DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_R10G10B10A2_UNORM, DXGI_FORMAT_R11G11B10_FLOAT,
+		DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_SNORM, DXGI_FORMAT_R16G16_FLOAT,
+		DXGI_FORMAT_R16G16_UNORM, DXGI_FORMAT_R16G16_SNORM, DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R8G8_UNORM, DXGI_FORMAT_R8G8_SNORM,
+		DXGI_FORMAT_R16_FLOAT, DXGI_FORMAT_R16_UNORM, DXGI_FORMAT_R16_SNORM, DXGI_FORMAT_R8_UNORM, DXGI_FORMAT_R8_SNORM, DXGI_FORMAT_A8_UNORM,
+		DXGI_FORMAT_B5G6R5_UNORM, DXGI_FORMAT_B5G5R5A1_UNORM, DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_FORMAT_B8G8R8X8_UNORM,
+		DXGI_FORMAT_B8G8R8A8_UNORM_SRGB, DXGI_FORMAT_B8G8R8X8_UNORM_SRGB, DXGI_FORMAT_B4G4R4A4_UNORM
+	};
+
+	// One tightly packed subresource
+	bool Convert(bool allowAvx2, DXGI_FORMAT sourceFormat, DXGI_FORMAT destFormat, uint32_t width, uint32_t height, const void* pSource, void* pDest,
+		JobSystem* pJobSystem = nullptr, uint32_t depth = 1)
+	{
+		FormatConverter::Settings settings;
+		settings.allowAvx2 = allowAvx2;
+		const uint64_t sourceRowPitch = uint64_t(width) * FormatConverter::GetPixelSize(sourceFormat);
+		const uint64_t destRowPitch = uint64_t(width) * FormatConverter::GetPixelSize(destFormat);
+		const FormatConversionDesc desc = { width, height, depth, pSource, sourceRowPitch, sourceRowPitch * height, pDest, destRowPitch,
+			destRowPitch * height };
+		return FormatConverter::Convert(settings, sourceFormat, destFormat, &desc, 1, pJobSystem);
+	}
+
+	float BitsToFloat(uint32_t bits)
+	{
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	uint32_t FloatToBits(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	// Unsigned 5-bit exponent floats from the definition, halves are this plus a sign
+	double ReferenceSmallFloat(uint32_t code, uint32_t mantissaBits)
+	{
+		const uint32_t exponent = code >> mantissaBits;
+		const uint32_t mantissa = code & ((1u << mantissaBits) - 1);
+		if (exponent == 31)
+			return mantissa ? NAN : INFINITY;
+		if (exponent == 0)
+			return std::ldexp(double(mantissa), -14 - int(mantissaBits));
+		return std::ldexp(1.0 + std::ldexp(double(mantissa), -int(mantissaBits)), int(exponent) - 15);
+	}
+
+	// Finite codes below infinity, nearest to value with ties to the even code
+	uint32_t NearestSmallFloat(double value, uint32_t mantissaBits)
+	{
+		const uint32_t infinity = 31u << mantissaBits;
+		uint32_t low = 0;
+		uint32_t high = infinity - 1;
+		while (low < high)
+		{
+			const uint32_t middle = (low + high + 1) / 2;
+			if (ReferenceSmallFloat(middle, mantissaBits) <= value)
+				low = middle;
+			else
+				high = middle - 1;
+		}
+		if (low == infinity - 1)
+			return low;
+		const double below = value - ReferenceSmallFloat(low, mantissaBits);
+		const double above = ReferenceSmallFloat(low + 1, mantissaBits) - value;
+		return below < above || (below == above && (low & 1) == 0) ? low : low + 1;
+	}
+
+	// IEEE half with F16C overflow: from halfway past the largest finite value up is infinity
+	uint32_t ReferenceHalf(float value)
+	{
+		const uint32_t sign = (FloatToBits(value) >> 16) & 0x8000;
+		const double magnitude = std::fabs(double(value));
+		if (magnitude >= 65520.0)
+			return sign | 0x7c00;
+		return sign | NearestSmallFloat(magnitude, 10);
+	}
+}
+
+TEST_CASE(FormatQueriesMatchTheTable)
+{
+	for (DXGI_FORMAT format : AllFormats)
+		CHECK(FormatConverter::IsSupported(format));
+	CHECK(FormatConverter::GetPixelSize(DXGI_FORMAT_R32G32B32_FLOAT) == 12);
+	CHECK(FormatConverter::GetPixelSize(DXGI_FORMAT_R11G11B10_FLOAT) == 4);
+	CHECK(FormatConverter::GetPixelSize(DXGI_FORMAT_B5G6R5_UNORM) == 2);
+	CHECK(FormatConverter::GetPixelSize(DXGI_FORMAT_A8_UNORM) == 1);
+	CHECK(FormatConverter::IsSrgb(DXGI_FORMAT_B8G8R8X8_UNORM_SRGB));
+	CHECK(!FormatConverter::IsSrgb(DXGI_FORMAT_R8G8B8A8_UNORM));
+
+	// Block compressed formats are out of scope, and nothing is written for them
+	CHECK(!FormatConverter::IsSupported(DXGI_FORMAT_BC1_UNORM));
+	CHECK(FormatConverter::GetPixelSize(DXGI_FORMAT_BC1_UNORM) == 0);
+	const uint8_t source[16] = {};
+	uint8_t dest[4] = { 1, 2, 3, 4 };
+	CHECK(!Convert(false, DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM, 1, 1, source, dest));
+	CHECK(!Convert(false, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_BC7_UNORM, 1, 1, source, dest));
+	CHECK(dest[0] == 1 && dest[3] == 4);
+}
+
+TEST_CASE(Avx2IsBitExactForEveryFormatPair)
+{
+	if (!CpuFeatures::HasAvx2())
+		return;
+
+	std::mt19937 rng(7);
+	uint32_t mismatches = 0;
+	for (DXGI_FORMAT sourceFormat : AllFormats)
+	{
+		for (DXGI_FORMAT destFormat : AllFormats)
+		{
+			// Widths around the 8 pixel vectors
+			for (uint32_t width : { 1u, 7u, 8u, 9u, 257u })
+			{
+				const uint32_t sourcePixelSize = FormatConverter::GetPixelSize(sourceFormat);
+				const uint32_t destPixelSize = FormatConverter::GetPixelSize(destFormat);
+				// Random bits cover NaNs, infinities and denormals; every third float is a plain value of any magnitude
+				std::vector<uint8_t> source(size_t(width) * sourcePixelSize * 3);
+				for (uint8_t& value : source)
+					value = static_cast<uint8_t>(rng());
+				if (sourcePixelSize % 4 == 0)
+				{
+					for (size_t i = 0; i < source.size() / 4; i += 3)
+					{
+						const float value = std::ldexp(float(rng() % 2000) / 1000.0f - 0.5f, int(rng() % 40) - 20);
+						memcpy(&source[i * 4], &value, 4);
+					}
+				}
+
+				std::vector<uint8_t> scalar(size_t(width) * destPixelSize * 3, 0xCD);
+				std::vector<uint8_t> avx2(scalar.size(), 0xAB);
+				CHECK(Convert(false, sourceFormat, destFormat, width, 3, source.data(), scalar.data()));
+				CHECK(Convert(true, sourceFormat, destFormat, width, 3, source.data(), avx2.data()));
+				mismatches += scalar != avx2 ? 1 : 0;
+			}
+		}
+	}
+	CHECK(mismatches == 0);
+}
+
+TEST_CASE(HalfDecodeIsExactForEveryCode)
+{
+	std::vector<uint16_t> halves(65536);
+	for (uint32_t i = 0; i < 65536; i++)
+		halves[i] = static_cast<uint16_t>(i);
+	for (bool allowAvx2 : { false, true })
+	{
+		std::vector<float> floats(65536);
+		REQUIRE(Convert(allowAvx2, DXGI_FORMAT_R16_FLOAT, DXGI_FORMAT_R32_FLOAT, 65536, 1, halves.data(), floats.data()));
+		uint32_t wrong = 0;
+		for (uint32_t i = 0; i < 65536; i++)
+		{
+			const double magnitude = ReferenceSmallFloat(i & 0x7fff, 10);
+			const uint32_t bits = FloatToBits(floats[i]);
+			if (std::isnan(magnitude))
+			{
+				// Quiet, with the sign and payload kept
+				wrong += bits != (((i & 0x8000) << 16) | 0x7fc00000 | ((i & 0x3ff) << 13)) ? 1 : 0;
+				continue;
+			}
+			wrong += double(floats[i]) != ((i & 0x8000) ? -magnitude : magnitude) || (bits >> 31) != (i >> 15) ? 1 : 0;
+		}
+		CHECK(wrong == 0);
+	}
+}
+
+TEST_CASE(HalfEncodeRoundsToNearestEven)
+{
+	// A spread across every exponent, plus each midpoint between neighbouring halves and the floats either side of it
+	std::vector<float> floats;
+	for (uint64_t bits = 0; bits < (uint64_t(1) << 32); bits += 4093)
+		floats.push_back(BitsToFloat(static_cast<uint32_t>(bits)));
+	for (uint32_t code = 0; code < 0x7bff; code++)
+	{
+		const float middle = static_cast<float>((ReferenceSmallFloat(code, 10) + ReferenceSmallFloat(code + 1, 10)) / 2.0);
+		for (float value : { middle, std::nextafter(middle, 0.0f), std::nextafter(middle, 1e9f) })
+		{
+			floats.push_back(value);
+			floats.push_back(-value);
+		}
+	}
+	floats.push_back(65519.99f);
+	floats.push_back(65520.0f);
+
+	const uint32_t count = static_cast<uint32_t>(floats.size());
+	for (bool allowAvx2 : { false, true })
+	{
+		std::vector<uint16_t> halves(count);
+		REQUIRE(Convert(allowAvx2, DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R16_FLOAT, count, 1, floats.data(), halves.data()));
+		uint32_t wrong = 0;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (std::isnan(floats[i]))
+				wrong += (halves[i] & 0x7e00) != 0x7e00 ? 1 : 0;
+			else
+				wrong += halves[i] != ReferenceHalf(floats[i]) ? 1 : 0;
+		}
+		CHECK(wrong == 0);
+	}
+}
+
+TEST_CASE(SmallFloatsDecodeExactlyAndEncodeToNearest)
+{
+	// Every 11-bit code in red and green, and every 10-bit one in blue
+	std::vector<uint32_t> packed(2048);
+	for (uint32_t i = 0; i < 2048; i++)
+		packed[i] = i | (i << 11) | ((i >> 1) << 22);
+	std::vector<float> rgb(2048 * 3);
+	REQUIRE(Convert(false, DXGI_FORMAT_R11G11B10_FLOAT, DXGI_FORMAT_R32G32B32_FLOAT, 2048, 1, packed.data(), rgb.data()));
+	uint32_t wrongDecodes = 0;
+	for (uint32_t i = 0; i < 2048; i++)
+	{
+		const double red = ReferenceSmallFloat(i, 6);
+		const double blue = ReferenceSmallFloat(i >> 1, 5);
+		wrongDecodes += std::isnan(red) ? !std::isnan(rgb[i * 3]) : rgb[i * 3] != float(red);
+		wrongDecodes += std::isnan(blue) ? !std::isnan(rgb[i * 3 + 2]) : rgb[i * 3 + 2] != float(blue);
+	}
+	CHECK(wrongDecodes == 0);
+
+	std::mt19937 rng(5);
+	std::vector<float> values;
+	for (uint32_t i = 0; i < 100000; i++)
+	{
+		const float value = std::ldexp(float(rng() % 1000000) / 1000000.0f, int(rng() % 40) - 25);
+		values.insert(values.end(), { value, value, value });
+	}
+	// Negatives clamp to zero and overflow to the largest finite value
+	values.insert(values.end(), { -1.0f, -1e-30f, -0.0f, 1e9f, 70000.0f, 65024.0f });
+
+	const uint32_t count = static_cast<uint32_t>(values.size() / 3);
+	std::vector<uint32_t> scalar(count);
+	std::vector<uint32_t> avx2(count);
+	REQUIRE(Convert(false, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R11G11B10_FLOAT, count, 1, values.data(), scalar.data()));
+	REQUIRE(Convert(true, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R11G11B10_FLOAT, count, 1, values.data(), avx2.data()));
+	CHECK(scalar == avx2);
+	uint32_t wrongEncodes = 0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const double value = std::max(double(values[i * 3]), 0.0);
+		wrongEncodes += (scalar[i] & 0x7ff) != NearestSmallFloat(value, 6) ? 1 : 0;
+		wrongEncodes += (scalar[i] >> 22) != NearestSmallFloat(value, 5) ? 1 : 0;
+	}
+	CHECK(wrongEncodes == 0);
+}
+
+TEST_CASE(EightBitRoundTripsAreLossless)
+{
+	std::vector<uint8_t> pixels(256 * 4);
+	for (uint32_t i = 0; i < 256; i++)
+		memset(&pixels[i * 4], static_cast<int>(i), 4);
+	for (DXGI_FORMAT middle : { DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R16G16B16A16_UNORM, DXGI_FORMAT_R16G16B16A16_FLOAT })
+	{
+		for (DXGI_FORMAT format : { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_B8G8R8A8_UNORM_SRGB })
+		{
+			for (bool allowAvx2 : { false, true })
+			{
+				std::vector<uint8_t> wide(256 * 16);
+				std::vector<uint8_t> back(256 * 4);
+				CHECK(Convert(allowAvx2, format, middle, 256, 1, pixels.data(), wide.data()));
+				CHECK(Convert(allowAvx2, middle, format, 256, 1, wide.data(), back.data()));
+				CHECK(back == pixels);
+			}
+		}
+	}
+}
+
+TEST_CASE(KnownValues)
+{
+	for (bool allowAvx2 : { false, true })
+	{
+		const uint8_t rgba[4] = { 10, 20, 30, 40 };
+		uint8_t bgra[4] = {};
+		CHECK(Convert(allowAvx2, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_B8G8R8A8_UNORM, 1, 1, rgba, bgra));
+		CHECK(bgra[0] == 30 && bgra[1] == 20 && bgra[2] == 10 && bgra[3] == 40);
+
+		// Out of range values clamp, 0.5 rounds to the even code
+		const float colour[4] = { 1.0f, 0.5f, -3.0f, 0.34f };
+		uint32_t rgb10a2 = 0;
+		CHECK(Convert(allowAvx2, DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R10G10B10A2_UNORM, 1, 1, colour, &rgb10a2));
+		CHECK(rgb10a2 == (1023u | (512u << 10) | (1u << 30)));
+		uint16_t b5g6r5 = 0;
+		CHECK(Convert(allowAvx2, DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_B5G6R5_UNORM, 1, 1, colour, &b5g6r5));
+		CHECK(b5g6r5 == ((31u << 11) | (32u << 5)));
+
+		// Linear value of sRGB 128, alpha is not encoded
+		const float linear[4] = { 0.2158605f, 0.0f, 0.0f, 1.0f };
+		uint8_t srgb[4] = {};
+		CHECK(Convert(allowAvx2, DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 1, 1, linear, srgb));
+		CHECK(srgb[0] == 128 && srgb[1] == 0 && srgb[3] == 255);
+
+		// Missing channels read as 0, alpha as 1
+		const uint8_t alpha = 77;
+		float a8[4] = {};
+		CHECK(Convert(allowAvx2, DXGI_FORMAT_A8_UNORM, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 1, &alpha, a8));
+		CHECK(a8[0] == 0.0f && a8[3] == 77 / 255.0f);
+		const uint8_t red = 255;
+		float r8[4] = {};
+		CHECK(Convert(allowAvx2, DXGI_FORMAT_R8_UNORM, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 1, &red, r8));
+		CHECK(r8[0] == 1.0f && r8[1] == 0.0f && r8[3] == 1.0f);
+
+		// Both -128 and -127 are -1
+		const int8_t snorm[3] = { -128, -127, 127 };
+		float snormFloats[3] = {};
+		CHECK(Convert(allowAvx2, DXGI_FORMAT_R8_SNORM, DXGI_FORMAT_R32_FLOAT, 3, 1, snorm, snormFloats));
+		CHECK(snormFloats[0] == -1.0f && snormFloats[1] == -1.0f && snormFloats[2] == 1.0f);
+
+		// X is written as 0
+		const uint8_t opaque[4] = { 1, 2, 3, 200 };
+		uint8_t bgrx[4] = {};
+		CHECK(Convert(allowAvx2, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_B8G8R8X8_UNORM, 1, 1, opaque, bgrx));
+		CHECK(bgrx[0] == 3 && bgrx[2] == 1 && bgrx[3] == 0);
+	}
+}
+
+TEST_CASE(ParallelMatchesSerial)
+{
+	JobSystem jobs(3);
+	const uint32_t width = 1000;
+	const uint32_t height = 300;
+	const uint32_t depth = 2;
+	std::vector<uint8_t> source(size_t(width) * height * depth * 4);
+	std::mt19937 rng(3);
+	for (uint8_t& value : source)
+		value = static_cast<uint8_t>(rng());
+
+	std::vector<uint8_t> serial(size_t(width) * height * depth * 8, 0);
+	std::vector<uint8_t> parallel(serial.size(), 1);
+	CHECK(Convert(true, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R16G16B16A16_FLOAT, width, height, source.data(), serial.data(), nullptr, depth));
+	CHECK(Convert(true, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R16G16B16A16_FLOAT, width, height, source.data(), parallel.data(), &jobs, depth));
+	CHECK(serial == parallel);
+}
@@ -0,0 +1,167 @@
+#include "TestFramework.h"
+#include "FrameLoop.h"
+#include "NullRenderBackend.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+	class FakeHost : public FrameHost
+	{
+	public:
+		void SetStatusText(const std::string& text) override { mStatusTexts.push_back(text); }
+		void RequestQuit() override { mQuitCount++; }
+
+		std::vector<std::string> mStatusTexts;
+		uint32_t mQuitCount = 0;
+	};
+
+	bool IsNear(double a, double b, double tolerance = 1e-6)
+	{
+		return std::fabs(a - b) <= tolerance;
+	}
+
+	// Frames until the loop asks to quit, or maxFrames
+	uint32_t RunUntilQuit(FrameLoop& loop, FakeHost& host, uint32_t maxFrames)
+	{
+		uint32_t frames = 0;
+		while (host.mQuitCount == 0 && frames < maxFrames)
+		{
+			loop.RunFrame();
+			frames++;
+		}
+		return frames;
+	}
+}
+
+TEST_CASE(FrameLimitQuitsOnceAndEveryFrameRetires)
+{
+	NullRenderBackend backend(2, 2.0, 5.0);
+	FakeHost host;
+	FrameLoop loop;
+	loop.Init(&backend, &host, 2, 0, 10, nullptr);
+
+	CHECK(RunUntilQuit(loop, host, 100) == 10);
+	CHECK(loop.IsQuitRequested());
+	CHECK(loop.GetRenderedFrameCount() == 10);
+	CHECK(backend.GetRenderedFrameCount() == 10);
+
+	// Extra frames after the request don't ask again
+	loop.RunFrame();
+	CHECK(host.mQuitCount == 1);
+
+	loop.Flush();
+	CHECK(backend.GetRetiredValue() >= 11);
+	CHECK(backend.GetErrorCount() == 0);
+}
+
+TEST_CASE(NoLimitRunsUntilTheHostStops)
+{
+	NullRenderBackend backend(3, 1.0, 1.0);
+	FakeHost host;
+	FrameLoop loop;
+	loop.Init(&backend, &host, 3, 0, 0, nullptr);
+
+	CHECK(RunUntilQuit(loop, host, 500) == 500);
+	CHECK(!loop.IsQuitRequested());
+	CHECK(backend.GetErrorCount() == 0);
+}
+
+TEST_CASE(GpuBoundLoopRunsAtGpuRateWithoutReusingBusySlots)
+{
+	for (uint32_t frameCount = 1; frameCount <= 3; frameCount++)
+	{
+		NullRenderBackend backend(frameCount, 2.0, 10.0);
+		FakeHost host;
+		FrameLoop loop;
+		loop.Init(&backend, &host, frameCount, 0, 100, nullptr);
+
+		RunUntilQuit(loop, host, 1000);
+		loop.Flush();
+		CHECK(backend.GetErrorCount() == 0);
+		// A single slot serializes CPU and GPU, deeper rings overlap them
+		const double expected = frameCount == 1 ? 100 * 12.0 : 100 * 10.0 + 2.0;
+		CHECK(IsNear(backend.GetQueue().GetTime(), expected));
+	}
+}
+
+TEST_CASE(StatusTextOnceASecondFromRetiredGpuFrames)
+{
+	NullRenderBackend backend(2, 1.0, 10.0);
+	FakeHost host;
+	FrameLoop loop;
+	loop.Init(&backend, &host, 2, 0, 0, nullptr);
+
+	// 10 ms a frame, 3.5 seconds
+	for (uint32_t i = 0; i < 350; i++)
+		loop.RunFrame();
+
+	REQUIRE(host.mStatusTexts.size() >= 3);
+	CHECK(host.mStatusTexts.size() <= 4);
+	CHECK(host.mStatusTexts.back().rfind("GPU 10.00 ms (min 10.00, avg 10.00, p99 10.00)", 0) == 0);
+}
+
+TEST_CASE(BenchmarkEndsTheLoopWithEverySeries)
+{
+	NullRenderBackend backend(2, 3.0, 1.0);
+	FakeHost host;
+	BenchmarkRecorder benchmark(5, 20);
+	FrameLoop loop;
+	// The frame limit only applies without a benchmark
+	loop.Init(&backend, &host, 2, 0, 3, &benchmark);
+
+	CHECK(RunUntilQuit(loop, host, 100) == 25);
+	CHECK(benchmark.IsComplete());
+	loop.Flush();
+
+	const BenchmarkRecorder::Summary cpu = benchmark.GetSummary(BenchmarkRecorder::CpuFrameTime);
+	const BenchmarkRecorder::Summary gpu = benchmark.GetSummary(BenchmarkRecorder::GpuFrameTime);
+	const BenchmarkRecorder::Summary present = benchmark.GetSummary(BenchmarkRecorder::PresentInterval);
+	CHECK(cpu.count == 20);
+	CHECK(gpu.count == 20);
+	CHECK(present.count == 20);
+	// CPU bound, a frame is presented every time the CPU is done with one
+	CHECK(IsNear(cpu.max, 3.0));
+	CHECK(IsNear(gpu.max, 1.0));
+	CHECK(IsNear(present.p50, 3.0));
+}
+
+TEST_CASE(FrameRateCapHoldsTheTargetFrameTime)
+{
+	NullRenderBackend backend(2, 2.0, 4.0);
+	FakeHost host;
+	FrameLoop loop;
+	FramePacer::Settings settings;
+	settings.targetFrameTime = 16.0;
+	loop.GetFramePacer().SetSettings(settings);
+	loop.Init(&backend, &host, 2, 0, 61, nullptr);
+
+	RunUntilQuit(loop, host, 1000);
+	// 60 whole intervals between the first and last frame start, plus the last frame's CPU time
+	CHECK(IsNear(backend.GetQueue().GetTime(), 60 * 16.0 + 2.0, 0.01));
+	CHECK(backend.GetErrorCount() == 0);
+}
+
+TEST_CASE(LowLatencyShortensGpuBoundFrameLatency)
+{
+	double latency[2] = {};
+	for (uint32_t lowLatency = 0; lowLatency < 2; lowLatency++)
+	{
+		NullRenderBackend backend(3, 1.0, 10.0);
+		FakeHost host;
+		FrameLoop loop;
+		FramePacer::Settings settings;
+		settings.lowLatency = lowLatency != 0;
+		loop.GetFramePacer().SetSettings(settings);
+		loop.Init(&backend, &host, 3, 0, 200, nullptr);
+
+		RunUntilQuit(loop, host, 1000);
+		latency[lowLatency] = loop.GetFramePacer().GetFrameLatency();
+		CHECK(backend.GetErrorCount() == 0);
+	}
+	// Three frames queued without pacing, about one with it
+	CHECK(latency[0] > 25.0);
+	CHECK(latency[1] < 15.0);
+}
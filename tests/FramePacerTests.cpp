@@ -0,0 +1,386 @@
+#include "TestFramework.h"
+#include "FrameLoop.h"
+#include "FramePacer.h"
+#include "NullRenderBackend.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	bool IsNear(double a, double b, double tolerance = 1e-9)
+	{
+		return std::fabs(a - b) <= tolerance;
+	}
+
+	// One frame through the pacer: started at start, submitted 1 ms later, waited queueTime for the GPU
+	void RunFrame(FramePacer& pacer, uint64_t frameId, double start, double queueTime, double gpuTime = 5.0)
+	{
+		pacer.BeginFrame(frameId, start);
+		pacer.SubmitFrame(frameId, start + 1.0);
+		pacer.CompleteFrame(frameId, start + 1.0 + queueTime, start + 1.0 + queueTime + gpuTime);
+	}
+
+	struct TraceFrame
+	{
+		double cpu;
+		double gpu;
+	};
+
+	// data/make_frame_traces.py, "cpu,gpu" milliseconds per frame
+	std::vector<TraceFrame> LoadTrace(const char* pName)
+	{
+		std::vector<TraceFrame> trace;
+		std::ifstream file(std::string(DXRT_TEST_DATA_DIR "/") + pName);
+		std::string line;
+		std::getline(file, line);
+		while (std::getline(file, line))
+		{
+			TraceFrame frame;
+			if (sscanf(line.c_str(), "%lf,%lf", &frame.cpu, &frame.gpu) == 2)
+				trace.push_back(frame);
+		}
+		return trace;
+	}
+
+	class FakeHost : public FrameHost
+	{
+	public:
+		void SetStatusText(const std::string&) override {}
+		void RequestQuit() override {}
+	};
+
+	// Plays a trace through the frame loop, one frame's CPU and GPU times at a time, and keeps the start and
+	// GPU completion of every frame
+	class TraceBackend : public NullRenderBackend
+	{
+	public:
+		TraceBackend(uint32_t frameCount, const std::vector<TraceFrame>& trace)
+			: NullRenderBackend(frameCount, 0.0, 0.0), mTrace(trace)
+		{
+		}
+
+		void Update(uint64_t fenceValue) override
+		{
+			NullRenderBackend::Update(fenceValue);
+			mStarts[fenceValue] = GetTime();
+			mFrameStarts.push_back(GetTime());
+		}
+
+		void Render(uint32_t frameIndex, uint64_t fenceValue) override
+		{
+			const TraceFrame& frame = mTrace[mFrameStarts.size() - 1];
+			SetFrameTimes(frame.cpu, frame.gpu);
+			NullRenderBackend::Render(frameIndex, fenceValue);
+		}
+
+		void Retire(uint64_t completedValue, std::vector<GpuFrame>& gpuFrames) override
+		{
+			const size_t first = gpuFrames.size();
+			NullRenderBackend::Retire(completedValue, gpuFrames);
+			for (size_t i = first; i < gpuFrames.size(); i++)
+				mLatencies.push_back(gpuFrames[i].end - mStarts[gpuFrames[i].fenceValue]);
+		}
+
+		const std::vector<TraceFrame>& mTrace;
+		std::unordered_map<uint64_t, double> mStarts;
+		std::vector<double> mFrameStarts;
+		// Frame start to GPU completion, in retirement order
+		std::vector<double> mLatencies;
+	};
+
+	struct Replay
+	{
+		// Mean latency over the frames after warmup, and the time the whole trace took
+		double latency;
+		double duration;
+		std::vector<double> frameStarts;
+		double latencyDelay;
+		uint32_t errorCount;
+	};
+
+	// The renderer's two frames in flight
+	Replay ReplayTrace(const std::vector<TraceFrame>& trace, const FramePacer::Settings& settings, uint32_t warmup = 20)
+	{
+		TraceBackend backend(2, trace);
+		FakeHost host;
+		FrameLoop loop;
+		loop.GetFramePacer().SetSettings(settings);
+		loop.Init(&backend, &host, 2, 0, 0, nullptr);
+		for (size_t i = 0; i < trace.size(); i++)
+			loop.RunFrame();
+		const double latencyDelay = loop.GetFramePacer().GetLatencyDelay();
+		loop.Flush();
+
+		Replay replay;
+		double total = 0.0;
+		for (size_t i = warmup; i < backend.mLatencies.size(); i++)
+			total += backend.mLatencies[i];
+		replay.latency = total / static_cast<double>(backend.mLatencies.size() - warmup);
+		replay.duration = backend.GetTime();
+		replay.frameStarts = backend.mFrameStarts;
+		replay.latencyDelay = latencyDelay;
+		replay.errorCount = backend.GetErrorCount();
+		return replay;
+	}
+
+	FramePacer::Settings LowLatency(bool enabled)
+	{
+		FramePacer::Settings settings;
+		settings.lowLatency = enabled;
+		return settings;
+	}
+}
+
+TEST_CASE(CapKeepsItsPhaseThroughShortHitches)
+{
+	FramePacer pacer;
+	FramePacer::Settings settings;
+	settings.targetFrameTime = 10.0;
+	pacer.SetSettings(settings);
+
+	// No deadline before the first frame
+	CHECK(pacer.GetWaitTime(0.0) == 0.0);
+	pacer.BeginFrame(1, 0.0);
+	CHECK(IsNear(pacer.GetWaitTime(3.0), 7.0));
+
+	// 4 ms late, less than an interval: the next deadline stays on the grid and the frame after catches up
+	pacer.BeginFrame(2, 14.0);
+	CHECK(IsNear(pacer.GetWaitTime(16.0), 4.0));
+	pacer.BeginFrame(3, 20.0);
+	CHECK(IsNear(pacer.GetWaitTime(20.0), 10.0));
+
+	// Just under a whole interval late still catches up
+	pacer.BeginFrame(4, 39.5);
+	CHECK(IsNear(pacer.GetWaitTime(39.5), 0.5));
+}
+
+TEST_CASE(CapResyncsAfterMissingAWholeInterval)
+{
+	FramePacer pacer;
+	FramePacer::Settings settings;
+	settings.targetFrameTime = 10.0;
+	pacer.SetSettings(settings);
+
+	pacer.BeginFrame(1, 0.0);
+	pacer.BeginFrame(2, 10.0);
+	// The deadline was 20, 30 would be the next one and is already gone: the phase restarts here
+	pacer.BeginFrame(3, 31.0);
+	CHECK(IsNear(pacer.GetWaitTime(31.0), 10.0));
+	pacer.BeginFrame(4, 41.0);
+	CHECK(IsNear(pacer.GetWaitTime(45.0), 6.0));
+
+	// Exactly one interval late also resyncs, instead of starting the next frame at once
+	pacer.BeginFrame(5, 61.0);
+	CHECK(IsNear(pacer.GetWaitTime(61.0), 10.0));
+}
+
+TEST_CASE(LatencyDelayGrowsByTheGainAndShrinksAtOnce)
+{
+	FramePacer pacer;
+	FramePacer::Settings settings = LowLatency(true);
+	settings.latencyMargin = 1.0;
+	settings.latencyGain = 0.25;
+	pacer.SetSettings(settings);
+
+	// 9 ms queued, 8 over the margin: a quarter of it per retired frame
+	RunFrame(pacer, 1, 0.0, 9.0);
+	CHECK(IsNear(pacer.GetQueueTime(), 9.0));
+	CHECK(IsNear(pacer.GetFrameLatency(), 15.0));
+	CHECK(IsNear(pacer.GetLatencyDelay(), 2.0));
+	RunFrame(pacer, 2, 20.0, 9.0);
+	CHECK(IsNear(pacer.GetLatencyDelay(), 4.0));
+	CHECK(IsNear(pacer.GetWaitTime(30.0), 4.0));
+
+	// Under the margin, the whole shortfall comes off in one frame
+	RunFrame(pacer, 3, 40.0, 0.2);
+	CHECK(IsNear(pacer.GetLatencyDelay(), 3.2));
+
+	// The window minimum keeps the short queue time in play while it is one of the last QueueWindowSize frames
+	for (uint64_t frameId = 4; frameId < 4 + FramePacer::QueueWindowSize - 1; frameId++)
+		RunFrame(pacer, frameId, frameId * 20.0, 9.0);
+	const double delay = 3.2 - 0.8 * (FramePacer::QueueWindowSize - 1);
+	CHECK(IsNear(pacer.GetLatencyDelay(), delay));
+	// Once it drops out, growing is damped again
+	RunFrame(pacer, 10, 200.0, 9.0);
+	CHECK(IsNear(pacer.GetLatencyDelay(), delay + 2.0));
+
+	// Never below 0
+	for (uint64_t frameId = 11; frameId < 20; frameId++)
+		RunFrame(pacer, frameId, frameId * 20.0, 0.0);
+	CHECK(pacer.GetLatencyDelay() == 0.0);
+	CHECK(pacer.GetWaitTime(400.0) == 0.0);
+}
+
+TEST_CASE(LatencyDelayIsClampedToTheMaximum)
+{
+	FramePacer pacer;
+	pacer.SetSettings(LowLatency(true));
+	for (uint64_t frameId = 1; frameId < 100; frameId++)
+		RunFrame(pacer, frameId, frameId * 1000.0, 500.0);
+	CHECK(pacer.GetLatencyDelay() == FramePacer::MaxLatencyDelay);
+	CHECK(pacer.GetWaitTime(0.0) == FramePacer::MaxLatencyDelay);
+
+	// Queue times are measured without pacing too, the delay only moves with low latency on
+	FramePacer unpaced;
+	RunFrame(unpaced, 1, 0.0, 500.0);
+	CHECK(IsNear(unpaced.GetQueueTime(), 500.0));
+	CHECK(unpaced.GetLatencyDelay() == 0.0);
+	CHECK(unpaced.GetWaitTime(0.0) == 0.0);
+}
+
+TEST_CASE(SetSettingsResetsTheStateItInvalidates)
+{
+	FramePacer pacer;
+	FramePacer::Settings settings = LowLatency(true);
+	settings.targetFrameTime = 10.0;
+	pacer.SetSettings(settings);
+	RunFrame(pacer, 1, 0.0, 9.0);
+	CHECK(pacer.GetLatencyDelay() > 0.0);
+	CHECK(IsNear(pacer.GetWaitTime(1.0), 9.0));
+
+	// Same cap, the phase stays
+	settings.latencyGain = 0.5;
+	pacer.SetSettings(settings);
+	CHECK(IsNear(pacer.GetWaitTime(1.0), 9.0));
+
+	// A new cap drops the deadline, the next frame starts a new phase
+	settings.targetFrameTime = 20.0;
+	pacer.SetSettings(settings);
+	CHECK(IsNear(pacer.GetWaitTime(1.0), pacer.GetLatencyDelay()));
+	pacer.BeginFrame(2, 5.0);
+	CHECK(IsNear(pacer.GetWaitTime(5.0), 20.0));
+
+	// Turning low latency off drops the delay, back on it starts over from 0
+	settings.targetFrameTime = 0.0;
+	settings.lowLatency = false;
+	pacer.SetSettings(settings);
+	CHECK(pacer.GetLatencyDelay() == 0.0);
+	CHECK(pacer.GetWaitTime(5.0) == 0.0);
+	settings.lowLatency = true;
+	pacer.SetSettings(settings);
+	CHECK(pacer.GetLatencyDelay() == 0.0);
+
+	// Reset forgets every frame too
+	RunFrame(pacer, 3, 30.0, 9.0);
+	pacer.BeginFrame(4, 50.0);
+	pacer.Reset();
+	pacer.CompleteFrame(4, 60.0, 70.0);
+	CHECK(pacer.GetQueueTime() == 0.0);
+	CHECK(pacer.GetFrameLatency() == 0.0);
+	CHECK(pacer.GetLatencyDelay() == 0.0);
+}
+
+TEST_CASE(StaleAndUnknownFrameIdsAreIgnored)
+{
+	FramePacer pacer;
+	pacer.SetSettings(LowLatency(true));
+
+	// Never begun
+	pacer.CompleteFrame(7, 10.0, 20.0);
+	CHECK(pacer.GetQueueTime() == 0.0);
+	CHECK(pacer.GetLatencyDelay() == 0.0);
+
+	// Completing the same frame twice only counts once
+	RunFrame(pacer, 1, 0.0, 9.0);
+	const double delay = pacer.GetLatencyDelay();
+	pacer.CompleteFrame(1, 50.0, 60.0);
+	CHECK(pacer.GetLatencyDelay() == delay);
+	CHECK(IsNear(pacer.GetQueueTime(), 9.0));
+
+	// A frame whose slot was taken by one PendingFrameCount later is out of the window, for submits too
+	const uint64_t old = 2;
+	const uint64_t recent = old + FramePacer::PendingFrameCount;
+	pacer.BeginFrame(old, 100.0);
+	pacer.BeginFrame(recent, 110.0);
+	pacer.SubmitFrame(old, 200.0);
+	pacer.CompleteFrame(old, 101.0, 102.0);
+	CHECK(IsNear(pacer.GetQueueTime(), 9.0));
+	CHECK(pacer.GetLatencyDelay() == delay);
+
+	// The recent one still completes, its submit time untouched by the stale submit
+	pacer.CompleteFrame(recent, 112.0, 115.0);
+	CHECK(IsNear(pacer.GetQueueTime(), 2.0));
+	CHECK(IsNear(pacer.GetFrameLatency(), 5.0));
+}
+
+TEST_CASE(GpuBoundTraceLatency)
+{
+	const std::vector<TraceFrame> trace = LoadTrace("GpuBoundTrace.csv");
+	REQUIRE(trace.size() == 300);
+
+	// 3 ms CPU, 10 ms GPU: unpaced, every frame waits behind a whole queued frame
+	const Replay unpaced = ReplayTrace(trace, LowLatency(false));
+	const Replay paced = ReplayTrace(trace, LowLatency(true));
+	printf("GPU bound: %.2f ms unpaced, %.2f ms low latency, %.1f vs %.1f ms for the trace\n", unpaced.latency, paced.latency,
+		unpaced.duration, paced.duration);
+	CHECK(IsNear(unpaced.latency, 20.0, 0.01));
+	// Down to CPU time, margin and GPU time, and the GPU never starves
+	CHECK(paced.latency < 14.5);
+	CHECK(paced.duration <= unpaced.duration * 1.01);
+	CHECK(unpaced.errorCount == 0 && paced.errorCount == 0);
+}
+
+TEST_CASE(CpuBoundTraceIsLeftAlone)
+{
+	const std::vector<TraceFrame> trace = LoadTrace("CpuBoundTrace.csv");
+	REQUIRE(trace.size() == 300);
+
+	// Nothing ever queues, so there is nothing to take off
+	const Replay unpaced = ReplayTrace(trace, LowLatency(false));
+	const Replay paced = ReplayTrace(trace, LowLatency(true));
+	CHECK(IsNear(unpaced.latency, 14.0, 0.01));
+	CHECK(IsNear(paced.latency, unpaced.latency, 0.01));
+	CHECK(IsNear(paced.duration, unpaced.duration, 0.01));
+	CHECK(paced.latencyDelay == 0.0);
+}
+
+TEST_CASE(HitchTraceKeepsThenRestartsTheCapPhase)
+{
+	const std::vector<TraceFrame> trace = LoadTrace("HitchTrace.csv");
+	REQUIRE(trace.size() == 120);
+
+	FramePacer::Settings settings;
+	settings.targetFrameTime = 16.0;
+	const Replay replay = ReplayTrace(trace, settings);
+	REQUIRE(replay.frameStarts.size() == 120);
+	CHECK(replay.errorCount == 0);
+
+	// On the grid up to the 20 ms hitch of frame 30, which starts frame 31 4 ms late
+	uint32_t offGrid = 0;
+	for (uint32_t i = 0; i <= 30; i++)
+		offGrid += IsNear(replay.frameStarts[i], i * 16.0, 1e-6) ? 0 : 1;
+	CHECK(offGrid == 0);
+	CHECK(IsNear(replay.frameStarts[31], 30 * 16.0 + 20.0, 1e-6));
+
+	// Caught up right after, the frames until the long hitch are back on the same grid
+	for (uint32_t i = 32; i <= 60; i++)
+		offGrid += IsNear(replay.frameStarts[i], i * 16.0, 1e-6) ? 0 : 1;
+	CHECK(offGrid == 0);
+
+	// Frame 60's 40 ms misses a whole interval, the cap resyncs to when frame 61 started
+	const double resync = replay.frameStarts[61];
+	CHECK(IsNear(resync, 60 * 16.0 + 40.0, 1e-6));
+	for (uint32_t i = 62; i < 120; i++)
+		offGrid += IsNear(replay.frameStarts[i], resync + (i - 61) * 16.0, 1e-6) ? 0 : 1;
+	CHECK(offGrid == 0);
+}
+
+TEST_CASE(JitteryTraceLatency)
+{
+	const std::vector<TraceFrame> trace = LoadTrace("JitteryTrace.csv");
+	REQUIRE(trace.size() == 2000);
+
+	const Replay unpaced = ReplayTrace(trace, LowLatency(false));
+	const Replay paced = ReplayTrace(trace, LowLatency(true));
+	printf("Jittery: %.2f ms unpaced, %.2f ms low latency, %.1f vs %.1f ms for the trace\n", unpaced.latency, paced.latency,
+		unpaced.duration, paced.duration);
+	CHECK(paced.latency < unpaced.latency * 0.85);
+	// Keeping the margin costs a little throughput when the GPU gets faster than the delay expects
+	CHECK(paced.duration <= unpaced.duration * 1.03);
+	CHECK(unpaced.errorCount == 0 && paced.errorCount == 0);
+}
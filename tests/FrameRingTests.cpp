@@ -0,0 +1,171 @@
+#include "TestFramework.h"
+#include "FrameRing.h"
+#include "SimulatedFrameQueue.h"
+
+#include <algorithm>
+
+namespace
+{
+	struct RunResult
+	{
+		uint32_t maxFramesInFlight = 0;
+		double totalTime = 0.0;
+	};
+
+	// Records for cpuTime, submits gpuTime of work and moves on, frameCount times
+	RunResult Run(FrameRing& ring, SimulatedFrameQueue& queue, uint32_t frameCount, double cpuTime, double gpuTime)
+	{
+		RunResult result;
+		for (uint32_t i = 0; i < frameCount; i++)
+		{
+			queue.Advance(cpuTime);
+			queue.Execute(gpuTime);
+			ring.MoveToNextFrame();
+			result.maxFramesInFlight = std::max(result.maxFramesInFlight, queue.GetPendingCount());
+		}
+		result.totalTime = queue.GetTime();
+		return result;
+	}
+}
+
+TEST_CASE(FenceValuesStartAtOneAndIncrease)
+{
+	SimulatedFrameQueue queue;
+	FrameRing ring;
+	ring.Init(&queue, 3);
+	CHECK(ring.GetFrameCount() == 3);
+	CHECK(ring.GetFrameIndex() == 0);
+	CHECK(ring.GetFenceValue() == 1);
+
+	for (uint32_t i = 1; i <= 7; i++)
+	{
+		ring.MoveToNextFrame();
+		CHECK(ring.GetFenceValue() == i + 1);
+		CHECK(ring.GetFrameIndex() == i % 3);
+	}
+}
+
+TEST_CASE(GpuBoundBlocksOnlyWhenRingIsFull)
+{
+	for (uint32_t frameCount = 1; frameCount <= 4; frameCount++)
+	{
+		SimulatedFrameQueue queue;
+		FrameRing ring;
+		ring.Init(&queue, frameCount);
+
+		// The first frameCount - 1 frames go out without waiting
+		for (uint32_t i = 0; i + 1 < frameCount; i++)
+		{
+			queue.Advance(1.0);
+			queue.Execute(10.0);
+			ring.MoveToNextFrame();
+		}
+		CHECK(queue.GetStallCount() == 0);
+
+		const RunResult result = Run(ring, queue, 50, 1.0, 10.0);
+		// Never more frames queued than the ring has slots, and a wait for the oldest on every frame
+		CHECK(result.maxFramesInFlight <= frameCount);
+		CHECK(result.maxFramesInFlight == frameCount - 1);
+		CHECK(queue.GetStallCount() == 50);
+	}
+}
+
+TEST_CASE(CpuBoundNeverBlocks)
+{
+	SimulatedFrameQueue queue;
+	FrameRing ring;
+	ring.Init(&queue, 2);
+
+	Run(ring, queue, 100, 10.0, 4.0);
+	CHECK(queue.GetStallCount() == 0);
+	CHECK(queue.GetStallTime() == 0.0);
+}
+
+TEST_CASE(DeeperRingOverlapsCpuAndGpu)
+{
+	// A single slot serializes the CPU and the GPU, the old WaitForPreviousFrame behaviour
+	SimulatedFrameQueue serialQueue;
+	FrameRing serialRing;
+	serialRing.Init(&serialQueue, 1);
+	const RunResult serial = Run(serialRing, serialQueue, 100, 6.0, 6.0);
+	CHECK(serial.totalTime >= 100 * 12.0);
+
+	// Two slots let the CPU record frame n + 1 while the GPU runs frame n
+	SimulatedFrameQueue queue;
+	FrameRing ring;
+	ring.Init(&queue, 2);
+	const RunResult overlapped = Run(ring, queue, 100, 6.0, 6.0);
+	CHECK(overlapped.totalTime <= 100 * 6.0 + 6.0);
+}
+
+TEST_CASE(JitterIsAbsorbedByTheRing)
+{
+	// GPU frames alternate 2 and 10 ms, 6 on average, which is as long as the CPU takes
+	SimulatedFrameQueue queue;
+	FrameRing ring;
+	ring.Init(&queue, 3);
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		queue.Advance(6.0);
+		queue.Execute(i % 2 ? 10.0 : 2.0);
+		ring.MoveToNextFrame();
+	}
+	CHECK(queue.GetStallTime() == 0.0);
+}
+
+TEST_CASE(ReusedSlotWaitsForItsOwnFrame)
+{
+	SimulatedFrameQueue queue;
+	FrameRing ring;
+	ring.Init(&queue, 2);
+
+	// Frame 1 is long, frame 2 short. Coming back to slot 0 only needs frame 1.
+	queue.Execute(20.0);
+	ring.MoveToNextFrame();
+	queue.Execute(1.0);
+	const uint64_t completed = ring.MoveToNextFrame();
+	CHECK(completed >= 1);
+	CHECK(queue.GetTime() == 20.0);
+	CHECK(ring.GetFrameIndex() == 0);
+	CHECK(queue.GetPendingCount() == 1);
+}
+
+TEST_CASE(SwapChainPicksTheNextIndex)
+{
+	SimulatedFrameQueue queue;
+	FrameRing ring;
+	ring.Init(&queue, 3, 2);
+	CHECK(ring.GetFrameIndex() == 2);
+
+	queue.Execute(5.0);
+	ring.MoveToNextFrame(0);
+	CHECK(ring.GetFrameIndex() == 0);
+	queue.Execute(5.0);
+	ring.MoveToNextFrame(2);
+	// Slot 2 was last used by fence value 1
+	CHECK(ring.GetCompletedValue() >= 1);
+	CHECK(queue.GetStallCount() == 1);
+}
+
+TEST_CASE(FlushRetiresEverything)
+{
+	SimulatedFrameQueue queue;
+	FrameRing ring;
+	ring.Init(&queue, 3);
+	Run(ring, queue, 5, 1.0, 8.0);
+
+	const uint64_t flushValue = ring.GetFenceValue();
+	const uint32_t frameIndex = ring.GetFrameIndex();
+	CHECK(ring.Flush() == flushValue);
+	CHECK(queue.GetPendingCount() == 0);
+	CHECK(ring.GetFrameIndex() == frameIndex);
+	CHECK(ring.GetFenceValue() == flushValue + 1);
+
+	// Nothing left in flight, the next frames go straight through
+	const uint32_t stalls = queue.GetStallCount();
+	queue.Execute(1.0);
+	ring.MoveToNextFrame();
+	queue.Execute(1.0);
+	ring.MoveToNextFrame();
+	CHECK(queue.GetStallCount() == stalls);
+}
@@ -0,0 +1,69 @@
+#include "TestFramework.h"
+#include "Hasher.h"
+
+namespace
+{
+	uint64_t HashBytes(const char* pString)
+	{
+		Hasher hasher;
+		hasher.Add(pString, strlen(pString));
+		return hasher.Get();
+	}
+}
+
+TEST_CASE(MatchesReferenceFnv1a)
+{
+	// Published FNV-1a 64-bit test vectors
+	CHECK(HashBytes("") == 0xcbf29ce484222325ull);
+	CHECK(HashBytes("a") == 0xaf63dc4c8601ec8cull);
+	CHECK(HashBytes("foobar") == 0x85944171f73967e8ull);
+	CHECK(Hasher().Get() == Hasher::OffsetBasis);
+}
+
+TEST_CASE(IncrementalEqualsOneShot)
+{
+	const char* pText = "D3D12 pipeline state stream";
+	Hasher pieces;
+	pieces.Add(pText, 5);
+	pieces.Add(pText + 5, 10);
+	pieces.Add(pText + 15, strlen(pText) - 15);
+	CHECK(pieces.Get() == HashBytes(pText));
+}
+
+TEST_CASE(ValuesHashTheirBytes)
+{
+	const uint32_t value = 0x12345678;
+	Hasher byValue;
+	byValue.AddValue(value);
+	Hasher byBytes;
+	byBytes.Add(&value, sizeof(value));
+	CHECK(byValue.Get() == byBytes.Get());
+
+	// Width matters, the same number in another type is a different key
+	Hasher wide;
+	wide.AddValue(static_cast<uint64_t>(value));
+	CHECK(wide.Get() != byValue.Get());
+}
+
+TEST_CASE(StringsKeepTheirBoundaries)
+{
+	Hasher ab;
+	ab.AddString("ab");
+	ab.AddString("c");
+	Hasher bc;
+	bc.AddString("a");
+	bc.AddString("bc");
+	CHECK(ab.Get() != bc.Get());
+
+	Hasher empty;
+	empty.AddString("");
+	Hasher null;
+	null.AddString(nullptr);
+	CHECK(empty.Get() != null.Get());
+	CHECK(empty.Get() != Hasher().Get());
+
+	Hasher again;
+	again.AddString("ab");
+	again.AddString("c");
+	CHECK(again.Get() == ab.Get());
+}
@@ -0,0 +1,84 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+
+#include <thread>
+#include <vector>
+
+// Scene recording the way DXRenderer::PopulateCommandList splits it, chunks of draws recorded into
+// per-thread command lists, against a stub list that costs about what a driver spends per draw.
+namespace
+{
+	const uint32_t DrawsPerChunk = 256;
+
+	struct StubCommandList
+	{
+		std::vector<uint32_t> words;
+
+		void Draw(uint32_t drawIndex)
+		{
+			// Root constant, vertex buffer view and draw, plus validation work the driver does per call
+			uint32_t hash = drawIndex * 2654435761u;
+			for (uint32_t n = 0; n < 64; n++)
+				hash = (hash ^ (hash >> 15)) * 2246822519u + n;
+			words.push_back(drawIndex);
+			words.push_back(hash);
+			words.push_back(3);
+		}
+	};
+
+	void RecordChunk(StubCommandList& list, uint32_t chunk, uint32_t drawCount)
+	{
+		const uint32_t firstDraw = chunk * DrawsPerChunk;
+		const uint32_t lastDraw = std::min(firstDraw + DrawsPerChunk, drawCount);
+		for (uint32_t draw = firstDraw; draw < lastDraw; draw++)
+			list.Draw(draw);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const uint32_t drawCount = quick ? 4096 : 65536;
+	const uint32_t chunkCount = (drawCount + DrawsPerChunk - 1) / DrawsPerChunk;
+	const uint32_t frameCount = quick ? 2 : 20;
+	const unsigned int maxThreads = quick ? 2 : std::max(2u, std::thread::hardware_concurrency());
+
+	printf("%u draws in %u chunks per frame\n", drawCount, chunkCount);
+	printf("threads  ms/frame  speedup  efficiency\n");
+
+	// One thread is the plain loop, every other count is the job system with threads - 1 workers
+	double serialTime = 0.0;
+	for (unsigned int threads = 1; threads <= maxThreads; threads++)
+	{
+		std::unique_ptr<JobSystem> jobs = threads > 1 ? std::make_unique<JobSystem>(threads - 1, 1) : nullptr;
+		std::vector<StubCommandList> lists(jobs ? jobs->GetThreadCount() : 1);
+
+		const double time = Benchmark::Measure(3, [&]()
+		{
+			for (uint32_t frame = 0; frame < frameCount; frame++)
+			{
+				for (StubCommandList& list : lists)
+					list.words.clear();
+
+				if (jobs)
+				{
+					jobs->ParallelFor(chunkCount, [&](unsigned int chunk, unsigned int threadIndex)
+					{
+						RecordChunk(lists[threadIndex], chunk, drawCount);
+					});
+				}
+				else
+				{
+					for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+						RecordChunk(lists[0], chunk, drawCount);
+				}
+			}
+		}) / frameCount;
+
+		if (threads == 1)
+			serialTime = time;
+		const double speedup = serialTime / time;
+		printf("%7u  %8.3f  %7.2f  %9.0f%%\n", threads, time * 1000.0, speedup, 100.0 * speedup / threads);
+	}
+	return 0;
+}
@@ -0,0 +1,190 @@
+#include "TestFramework.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Flags a threadIndex used by two threads at once
+	class IndexOwnership
+	{
+	public:
+		explicit IndexOwnership(unsigned int threadCount)
+			: mBusy(std::make_unique<std::atomic<bool>[]>(threadCount)), mThreadCount(threadCount)
+		{
+			for (unsigned int n = 0; n < threadCount; n++)
+				mBusy[n] = false;
+		}
+
+		void Enter(unsigned int threadIndex)
+		{
+			if (threadIndex >= mThreadCount)
+			{
+				mOutOfRange++;
+				return;
+			}
+			if (mBusy[threadIndex].exchange(true))
+				mCollisions++;
+		}
+
+		void Leave(unsigned int threadIndex)
+		{
+			if (threadIndex < mThreadCount)
+				mBusy[threadIndex] = false;
+		}
+
+		unsigned int GetCollisions() const { return mCollisions; }
+		unsigned int GetOutOfRange() const { return mOutOfRange; }
+
+	private:
+		std::unique_ptr<std::atomic<bool>[]> mBusy;
+		unsigned int mThreadCount;
+		std::atomic<unsigned int> mCollisions{ 0 };
+		std::atomic<unsigned int> mOutOfRange{ 0 };
+	};
+
+	void Spin(unsigned int iterations)
+	{
+		volatile unsigned int sink = 0;
+		for (unsigned int n = 0; n < iterations; n++)
+			sink = sink + n;
+	}
+}
+
+TEST_CASE(EveryIndexRunsOnce)
+{
+	JobSystem jobs(3);
+	for (unsigned int count : { 1u, 2u, 7u, 1000u, 10000u })
+	{
+		std::vector<std::atomic<unsigned int>> runs(count);
+		jobs.ParallelFor(count, [&](unsigned int index, unsigned int)
+		{
+			runs[index]++;
+		});
+
+		unsigned int wrong = 0;
+		for (const std::atomic<unsigned int>& run : runs)
+			wrong += run != 1 ? 1 : 0;
+		CHECK(wrong == 0);
+	}
+}
+
+TEST_CASE(ThreadCountCoversWorkersAndCallers)
+{
+	JobSystem jobs(3, 2);
+	CHECK(jobs.GetWorkerCount() == 3);
+	CHECK(jobs.GetThreadCount() == 5);
+
+	IndexOwnership ownership(jobs.GetThreadCount());
+	jobs.ParallelFor(500, [&](unsigned int, unsigned int threadIndex)
+	{
+		ownership.Enter(threadIndex);
+		Spin(1000);
+		ownership.Leave(threadIndex);
+	});
+	CHECK(ownership.GetOutOfRange() == 0);
+	CHECK(ownership.GetCollisions() == 0);
+}
+
+TEST_CASE(ConcurrentCallersGetTheirOwnIndex)
+{
+	// Fewer slots than callers as well, the extra ones wait for a slot instead of sharing it
+	for (unsigned int callerCount : { 4u, 2u })
+	{
+		JobSystem jobs(2, callerCount);
+		IndexOwnership ownership(jobs.GetThreadCount());
+		std::atomic<unsigned int> total(0);
+
+		std::vector<std::thread> callers;
+		for (unsigned int c = 0; c < 4; c++)
+		{
+			callers.emplace_back([&]()
+			{
+				for (unsigned int n = 0; n < 50; n++)
+				{
+					jobs.ParallelFor(16, [&](unsigned int, unsigned int threadIndex)
+					{
+						ownership.Enter(threadIndex);
+						Spin(500);
+						ownership.Leave(threadIndex);
+						total++;
+					});
+				}
+			});
+		}
+		for (std::thread& caller : callers)
+			caller.join();
+
+		CHECK(total == 4 * 50 * 16);
+		CHECK(ownership.GetOutOfRange() == 0);
+		CHECK(ownership.GetCollisions() == 0);
+	}
+}
+
+TEST_CASE(NestedCallsRunEveryIndex)
+{
+	JobSystem jobs(3);
+	std::atomic<unsigned int> total(0);
+	std::atomic<unsigned int> outOfRange(0);
+
+	jobs.ParallelFor(8, [&](unsigned int, unsigned int)
+	{
+		jobs.ParallelFor(8, [&](unsigned int, unsigned int threadIndex)
+		{
+			total++;
+			if (threadIndex >= jobs.GetThreadCount())
+				outOfRange++;
+		});
+	});
+	CHECK(total == 64);
+	CHECK(outOfRange == 0);
+}
+
+TEST_CASE(SameThreadSameIndexWhenNested)
+{
+	JobSystem jobs(2);
+	std::atomic<unsigned int> mismatches(0);
+
+	// Jobs the outer caller runs inline keep its slot
+	jobs.ParallelFor(4, [&](unsigned int, unsigned int outerIndex)
+	{
+		const std::thread::id outerThread = std::this_thread::get_id();
+		jobs.ParallelFor(4, [&](unsigned int, unsigned int innerIndex)
+		{
+			if (std::this_thread::get_id() == outerThread && innerIndex != outerIndex)
+				mismatches++;
+		});
+	});
+	CHECK(mismatches == 0);
+}
+
+TEST_CASE(FirstExceptionIsRethrownAfterEveryIndex)
+{
+	JobSystem jobs(3);
+	std::atomic<unsigned int> ran(0);
+	bool caught = false;
+	try
+	{
+		jobs.ParallelFor(100, [&](unsigned int index, unsigned int)
+		{
+			ran++;
+			if (index % 10 == 3)
+				throw std::runtime_error("job failed");
+		});
+	}
+	catch (const std::runtime_error&)
+	{
+		caught = true;
+	}
+	CHECK(caught);
+	CHECK(ran == 100);
+
+	// The slot was given back, the system is still usable
+	std::atomic<unsigned int> after(0);
+	jobs.ParallelFor(10, [&](unsigned int, unsigned int) { after++; });
+	CHECK(after == 10);
+}
@@ -0,0 +1,102 @@
+#include "TestFramework.h"
+#include "LinearArena.h"
+
+#include <cstring>
+#include <random>
+
+TEST_CASE(AllocationsAreAlignedAndDisjoint)
+{
+	LinearArena arena(256);
+	std::mt19937 rng(1);
+
+	struct Allocation
+	{
+		uint8_t* pData;
+		size_t size;
+	};
+	std::vector<Allocation> allocations;
+	for (uint32_t n = 0; n < 500; n++)
+	{
+		const size_t size = rng() % 300;
+		const size_t alignment = size_t(1) << (rng() % 7);
+		uint8_t* pData = static_cast<uint8_t*>(arena.Allocate(size, alignment));
+		REQUIRE(pData != nullptr);
+		CHECK(reinterpret_cast<uintptr_t>(pData) % alignment == 0);
+		memset(pData, static_cast<int>(n), size);
+		allocations.push_back({ pData, size });
+	}
+
+	// Nothing was written over by a later allocation
+	for (size_t n = 0; n < allocations.size(); n++)
+	{
+		for (size_t i = 0; i < allocations[n].size; i++)
+			CHECK(allocations[n].pData[i] == static_cast<uint8_t>(n));
+	}
+}
+
+TEST_CASE(OversizedAllocationGetsItsOwnBlock)
+{
+	LinearArena arena(64);
+	void* pSmall = arena.Allocate(16, 8);
+	uint8_t* pLarge = static_cast<uint8_t*>(arena.Allocate(1000, 256));
+	CHECK(reinterpret_cast<uintptr_t>(pLarge) % 256 == 0);
+	memset(pLarge, 0xcd, 1000);
+	CHECK(arena.GetCapacity() >= 64 + 1000);
+	CHECK(pSmall != pLarge);
+}
+
+TEST_CASE(ResetReusesTheMemory)
+{
+	LinearArena arena(1024);
+	void* pFirst = arena.Allocate(100, 16);
+	arena.Allocate(200, 16);
+	CHECK(arena.GetCapacity() == 1024);
+
+	arena.Reset();
+	CHECK(arena.Allocate(100, 16) == pFirst);
+	CHECK(arena.GetCapacity() == 1024);
+}
+
+TEST_CASE(SteadyWorkloadStopsGrowingAfterOneReset)
+{
+	LinearArena arena(128);
+	const auto workload = [&]()
+	{
+		for (uint32_t n = 0; n < 100; n++)
+		{
+			uint32_t* pValues = arena.Allocate<uint32_t>(n % 13 + 1);
+			pValues[0] = n;
+		}
+	};
+
+	workload();
+	const size_t grownCapacity = arena.GetCapacity();
+	CHECK(grownCapacity > 128);
+
+	// The blocks are merged into one that holds the whole workload
+	arena.Reset();
+	CHECK(arena.GetCapacity() == grownCapacity);
+	for (uint32_t frame = 0; frame < 10; frame++)
+	{
+		workload();
+		arena.Reset();
+		CHECK(arena.GetCapacity() == grownCapacity);
+	}
+}
+
+TEST_CASE(TypedAllocationUsesTheTypeAlignment)
+{
+	struct alignas(32) Wide
+	{
+		float values[8];
+	};
+
+	LinearArena arena(4096);
+	arena.Allocate(1, 1);
+	Wide* pWide = arena.Allocate<Wide>(4);
+	CHECK(reinterpret_cast<uintptr_t>(pWide) % 32 == 0);
+	arena.Allocate(3, 1);
+	uint64_t* pValues = arena.Allocate<uint64_t>(2);
+	CHECK(reinterpret_cast<uintptr_t>(pValues) % alignof(uint64_t) == 0);
+	CHECK(reinterpret_cast<uint8_t*>(pValues) >= reinterpret_cast<uint8_t*>(pWide + 4));
+}
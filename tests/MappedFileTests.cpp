@@ -0,0 +1,62 @@
+#include "TestFramework.h"
+#include "MappedFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace
+{
+	std::filesystem::path WriteTempFile(const char* pName, const std::string& contents)
+	{
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / pName;
+		std::ofstream(path, std::ios::binary).write(contents.data(), contents.size());
+		return path;
+	}
+}
+
+TEST_CASE(MapsTheWholeFile)
+{
+	std::string contents(100000, '\0');
+	for (size_t i = 0; i < contents.size(); i++)
+		contents[i] = static_cast<char>(i * 31);
+	const std::filesystem::path path = WriteTempFile("dxrt-mapped-file-test.bin", contents);
+
+	MappedFile file;
+	REQUIRE(file.Open(path));
+	CHECK(file.GetSize() == contents.size());
+	CHECK(memcmp(file.GetData(), contents.data(), contents.size()) == 0);
+
+	file.Close();
+	CHECK(file.GetData() == nullptr);
+	CHECK(file.GetSize() == 0);
+	std::filesystem::remove(path);
+}
+
+TEST_CASE(ReopeningReplacesTheMapping)
+{
+	const std::filesystem::path first = WriteTempFile("dxrt-mapped-file-first.bin", "first file");
+	const std::filesystem::path second = WriteTempFile("dxrt-mapped-file-second.bin", "second");
+
+	MappedFile file;
+	REQUIRE(file.Open(first));
+	REQUIRE(file.Open(second));
+	CHECK(file.GetSize() == 6);
+	CHECK(memcmp(file.GetData(), "second", 6) == 0);
+	file.Close();
+	std::filesystem::remove(first);
+	std::filesystem::remove(second);
+}
+
+TEST_CASE(MissingAndEmptyFilesFail)
+{
+	MappedFile file;
+	CHECK(!file.Open(std::filesystem::temp_directory_path() / "dxrt-mapped-file-missing.bin"));
+	CHECK(file.GetData() == nullptr);
+
+	const std::filesystem::path empty = WriteTempFile("dxrt-mapped-file-empty.bin", "");
+	CHECK(!file.Open(empty));
+	CHECK(file.GetData() == nullptr);
+	CHECK(file.GetSize() == 0);
+	std::filesystem::remove(empty);
+}
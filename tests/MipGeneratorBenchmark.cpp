@@ -0,0 +1,54 @@
+#include "Benchmark.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+#include "MipGenerator.h"
+
+#include <random>
+#include <thread>
+
+// Full sRGB mip chains from 4K and 8K level 0, per filter, scalar and AVX2, on one thread and on the job system.
+// Throughput is level 0 pixels per second.
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const uint32_t sizes[] = { 4096, 8192 };
+	const MipFilter filters[] = { MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos };
+	const char* filterNames[] = { "box", "Kaiser", "Lanczos" };
+
+	JobSystem jobs;
+	printf("%u hardware threads\n", std::thread::hardware_concurrency());
+
+	for (uint32_t size : sizes)
+	{
+		if (quick)
+			size /= 16;
+		MipChain chain;
+		chain.Init(size, size);
+		const MipChain::Level& level = chain.GetLevel(0);
+		std::mt19937 rng(1);
+		for (uint64_t i = 0; i < level.rowPitch * level.height; i++)
+			level.pData[i] = static_cast<uint8_t>(rng());
+
+		for (uint32_t f = 0; f < 3; f++)
+		{
+			for (bool allowAvx2 : { false, true })
+			{
+				if (allowAvx2 && !CpuFeatures::HasAvx2())
+					continue;
+				for (JobSystem* pJobSystem : { static_cast<JobSystem*>(nullptr), &jobs })
+				{
+					MipGenerator::Settings settings;
+					settings.filter = filters[f];
+					settings.allowAvx2 = allowAvx2;
+					const double time = Benchmark::Measure(quick ? 1 : 2, [&]()
+					{
+						MipGenerator::Generate(chain, settings, pJobSystem);
+					});
+					printf("%ux%u %-7s %-6s %-8s %8.1f ms, %5.0f Mpixel/s\n", size, size, filterNames[f], allowAvx2 ? "AVX2" : "scalar",
+						pJobSystem ? "jobs" : "1 thread", time * 1e3, double(size) * size / time / 1e6);
+				}
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,222 @@
+#include "TestFramework.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <utility>
+
+namespace
+{
+	const MipFilter AllFilters[] = { MipFilter::Box, MipFilter::Kaiser, MipFilter::Lanczos };
+
+	void FillRandom(MipChain& chain, uint32_t seed)
+	{
+		const MipChain::Level& level = chain.GetLevel(0);
+		std::mt19937 rng(seed);
+		for (uint64_t i = 0; i < level.rowPitch * level.height; i++)
+			level.pData[i] = static_cast<uint8_t>(rng());
+	}
+
+	// One pixel on, one off, colour and alpha alike
+	void FillChecker(MipChain& chain)
+	{
+		const MipChain::Level& level = chain.GetLevel(0);
+		for (uint32_t y = 0; y < level.height; y++)
+		{
+			for (uint32_t x = 0; x < level.width; x++)
+				memset(level.pData + y * level.rowPitch + x * 4, ((x ^ y) & 1) ? 0xFF : 0x00, 4);
+		}
+	}
+
+	// Over every level but the first
+	int GetMaxDifference(const MipChain& a, const MipChain& b)
+	{
+		int maxDifference = 0;
+		for (uint32_t i = 1; i < a.GetLevelCount(); i++)
+		{
+			const MipChain::Level& levelA = a.GetLevel(i);
+			const MipChain::Level& levelB = b.GetLevel(i);
+			for (uint64_t n = 0; n < levelA.rowPitch * levelA.height; n++)
+				maxDifference = std::max(maxDifference, std::abs(int(levelA.pData[n]) - int(levelB.pData[n])));
+		}
+		return maxDifference;
+	}
+}
+
+TEST_CASE(ChainLevelsHalveDownToOnePixel)
+{
+	MipChain chain;
+	chain.Init(13, 5);
+	REQUIRE(chain.GetLevelCount() == 4);
+	const uint32_t widths[] = { 13, 6, 3, 1 };
+	const uint32_t heights[] = { 5, 2, 1, 1 };
+	uint64_t size = 0;
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		const MipChain::Level& level = chain.GetLevel(i);
+		CHECK(level.width == widths[i]);
+		CHECK(level.height == heights[i]);
+		CHECK(level.rowPitch == level.width * 4);
+		// Tightly packed, level after level
+		CHECK(level.pData == chain.GetLevel(0).pData + size);
+		size += level.rowPitch * level.height;
+	}
+	CHECK(chain.GetSize() == size);
+
+	CHECK(MipChain::GetFullLevelCount(1, 1) == 1);
+	CHECK(MipChain::GetFullLevelCount(256, 256) == 9);
+	CHECK(MipChain::GetFullLevelCount(4096, 1) == 13);
+	CHECK(MipChain::GetFullLevelCount(255, 3) == 8);
+
+	chain.Init(256, 256, 3);
+	CHECK(chain.GetLevelCount() == 3);
+	CHECK(chain.GetLevel(2).width == 64);
+}
+
+TEST_CASE(BoxFilterAveragesInLinearLight)
+{
+	for (bool allowAvx2 : { false, true })
+	{
+		MipChain chain;
+		chain.Init(64, 64);
+		FillChecker(chain);
+		MipGenerator::Settings settings;
+		settings.allowAvx2 = allowAvx2;
+		MipGenerator::Generate(chain, settings);
+
+		// Half of linear white is sRGB 188, alpha stays linear
+		for (uint32_t i = 1; i < chain.GetLevelCount(); i++)
+		{
+			const uint8_t* pPixel = chain.GetLevel(i).pData;
+			CHECK(pPixel[0] == 188 && pPixel[1] == 188 && pPixel[2] == 188);
+			CHECK(pPixel[3] == 128);
+		}
+
+		// Without sRGB, colour is averaged as stored
+		FillChecker(chain);
+		settings.srgb = false;
+		MipGenerator::Generate(chain, settings);
+		CHECK(chain.GetLevel(1).pData[0] == 128);
+	}
+}
+
+TEST_CASE(ConstantImagesStayConstant)
+{
+	JobSystem jobs(3);
+	for (MipFilter filter : AllFilters)
+	{
+		for (bool srgb : { false, true })
+		{
+			MipChain chain;
+			chain.Init(99, 45);
+			memset(chain.GetLevel(0).pData, 77, chain.GetLevel(0).rowPitch * 45);
+			MipGenerator::Settings settings;
+			settings.filter = filter;
+			settings.srgb = srgb;
+			MipGenerator::Generate(chain, settings, &jobs);
+
+			uint32_t wrong = 0;
+			for (uint32_t i = 1; i < chain.GetLevelCount(); i++)
+			{
+				const MipChain::Level& level = chain.GetLevel(i);
+				for (uint64_t n = 0; n < level.rowPitch * level.height; n++)
+					wrong += level.pData[n] != 77 ? 1 : 0;
+			}
+			CHECK(wrong == 0);
+		}
+	}
+}
+
+TEST_CASE(Avx2StaysWithinOneOfScalar)
+{
+	if (!CpuFeatures::HasAvx2())
+		return;
+
+	const std::pair<uint32_t, uint32_t> sizes[] = { { 257, 131 }, { 1, 77 }, { 300, 1 }, { 512, 256 }, { 7, 3 } };
+	for (MipFilter filter : AllFilters)
+	{
+		for (bool srgb : { false, true })
+		{
+			for (const auto& size : sizes)
+			{
+				MipChain scalar;
+				MipChain avx2;
+				scalar.Init(size.first, size.second);
+				avx2.Init(size.first, size.second);
+				FillRandom(scalar, size.first);
+				FillRandom(avx2, size.first);
+
+				MipGenerator::Settings settings;
+				settings.filter = filter;
+				settings.srgb = srgb;
+				settings.allowAvx2 = false;
+				MipGenerator::Generate(scalar, settings);
+				settings.allowAvx2 = true;
+				MipGenerator::Generate(avx2, settings);
+				CHECK(GetMaxDifference(scalar, avx2) <= 1);
+			}
+		}
+	}
+}
+
+TEST_CASE(ParallelBandsMatchSerial)
+{
+	JobSystem jobs(3);
+	for (MipFilter filter : AllFilters)
+	{
+		// Tall enough for several bands, with a partial last one
+		MipChain serial;
+		MipChain parallel;
+		serial.Init(200, 333);
+		parallel.Init(200, 333);
+		FillRandom(serial, 7);
+		FillRandom(parallel, 7);
+
+		MipGenerator::Settings settings;
+		settings.filter = filter;
+		MipGenerator::Generate(serial, settings);
+		MipGenerator::Generate(parallel, settings, &jobs);
+		CHECK(GetMaxDifference(serial, parallel) == 0);
+	}
+}
+
+TEST_CASE(FiltersAgreeOnALinearRamp)
+{
+	// Normalized symmetric filters reproduce a ramp, whatever their width
+	MipChain box;
+	MipChain lanczos;
+	box.Init(64, 64);
+	lanczos.Init(64, 64);
+	for (MipChain* pChain : { &box, &lanczos })
+	{
+		const MipChain::Level& level = pChain->GetLevel(0);
+		for (uint32_t y = 0; y < 64; y++)
+		{
+			for (uint32_t x = 0; x < 64; x++)
+			{
+				uint8_t* pPixel = level.pData + y * level.rowPitch + x * 4;
+				pPixel[0] = pPixel[1] = pPixel[2] = static_cast<uint8_t>(x * 4);
+				pPixel[3] = 255;
+			}
+		}
+	}
+
+	MipGenerator::Settings settings;
+	settings.srgb = false;
+	MipGenerator::Generate(box, settings);
+	settings.filter = MipFilter::Lanczos;
+	MipGenerator::Generate(lanczos, settings);
+
+	// Away from the clamped edges
+	const MipChain::Level& boxLevel = box.GetLevel(1);
+	const MipChain::Level& lanczosLevel = lanczos.GetLevel(1);
+	int maxDifference = 0;
+	for (uint32_t x = 4; x < 28; x++)
+		maxDifference = std::max(maxDifference, std::abs(int(boxLevel.pData[x * 4]) - int(lanczosLevel.pData[x * 4])));
+	CHECK(maxDifference <= 1);
+	CHECK(boxLevel.pData[16 * 4] == 130);
+}
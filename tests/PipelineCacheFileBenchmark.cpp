@@ -0,0 +1,46 @@
+#include "Benchmark.h"
+#include "Hasher.h"
+#include "PipelineCacheFile.h"
+
+#include <vector>
+
+// Startup cost of validating the pipeline cache: Read hashes the whole pipeline library blob before it is
+// handed to the driver, so Hasher throughput bounds how quickly a warm start gets going.
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const size_t blobSize = quick ? 1024 * 1024 : 64 * 1024 * 1024;
+
+	std::vector<uint8_t> blob(blobSize);
+	for (size_t n = 0; n < blobSize; n++)
+		blob[n] = static_cast<uint8_t>(n * 2654435761u >> 24);
+
+	const PipelineCacheFile::Identity identity = { 0x10de, 0x2204, 0x1, 0xa1, 0x001f000000001234ull };
+	std::vector<uint8_t> data;
+	const double writeTime = Benchmark::Measure(3, [&]()
+	{
+		data = PipelineCacheFile::Write(identity, blob.data(), blob.size());
+	});
+
+	bool valid = true;
+	const double readTime = Benchmark::Measure(3, [&]()
+	{
+		const uint8_t* pBlob;
+		uint64_t size;
+		valid &= PipelineCacheFile::Read(data, identity, pBlob, size);
+	});
+
+	uint64_t hash = 0;
+	const double hashTime = Benchmark::Measure(3, [&]()
+	{
+		Hasher hasher;
+		hasher.Add(blob.data(), blob.size());
+		hash = hasher.Get();
+	});
+	Benchmark::DoNotOptimize(hash);
+
+	const double megabytes = blobSize / (1024.0 * 1024.0);
+	printf("Hasher: %.0f MB/s\n", megabytes / hashTime);
+	printf("PipelineCacheFile %.0f MB blob: write %.2f ms, validated read %.2f ms\n", megabytes, writeTime * 1e3, readTime * 1e3);
+	return valid ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include "TestFramework.h"
+#include "PipelineCacheFile.h"
+
+#include <cstring>
+
+namespace
+{
+	const PipelineCacheFile::Identity TestIdentity = { 0x10de, 0x2204, 0x1, 0xa1, 0x001f000000001234ull };
+
+	std::vector<uint8_t> MakeBlob(size_t size)
+	{
+		std::vector<uint8_t> blob(size);
+		for (size_t n = 0; n < size; n++)
+			blob[n] = static_cast<uint8_t>(n * 7 + 3);
+		return blob;
+	}
+}
+
+TEST_CASE(RoundTripsTheBlob)
+{
+	const std::vector<uint8_t> blob = MakeBlob(1000);
+	const std::vector<uint8_t> data = PipelineCacheFile::Write(TestIdentity, blob.data(), blob.size());
+	CHECK(data.size() > blob.size());
+
+	const uint8_t* pBlob = nullptr;
+	uint64_t blobSize = 0;
+	REQUIRE(PipelineCacheFile::Read(data, TestIdentity, pBlob, blobSize));
+	REQUIRE(blobSize == blob.size());
+	CHECK(memcmp(pBlob, blob.data(), blob.size()) == 0);
+	// Points into the file data, no copy
+	CHECK(pBlob >= data.data() && pBlob + blobSize == data.data() + data.size());
+}
+
+TEST_CASE(EmptyBlobIsValid)
+{
+	const std::vector<uint8_t> data = PipelineCacheFile::Write(TestIdentity, nullptr, 0);
+	const uint8_t* pBlob = nullptr;
+	uint64_t blobSize = 1;
+	CHECK(PipelineCacheFile::Read(data, TestIdentity, pBlob, blobSize));
+	CHECK(blobSize == 0);
+}
+
+TEST_CASE(OtherAdapterOrDriverIsRejected)
+{
+	const std::vector<uint8_t> blob = MakeBlob(64);
+	const std::vector<uint8_t> data = PipelineCacheFile::Write(TestIdentity, blob.data(), blob.size());
+	const uint8_t* pBlob;
+	uint64_t blobSize;
+
+	for (uint32_t field = 0; field < 5; field++)
+	{
+		PipelineCacheFile::Identity other = TestIdentity;
+		switch (field)
+		{
+		case 0: other.vendorId++; break;
+		case 1: other.deviceId++; break;
+		case 2: other.subSysId++; break;
+		case 3: other.revision++; break;
+		case 4: other.driverVersion++; break;
+		}
+		CHECK(!PipelineCacheFile::Read(data, other, pBlob, blobSize));
+	}
+}
+
+TEST_CASE(DamagedFilesAreRejected)
+{
+	const std::vector<uint8_t> blob = MakeBlob(256);
+	const std::vector<uint8_t> data = PipelineCacheFile::Write(TestIdentity, blob.data(), blob.size());
+	const uint8_t* pBlob;
+	uint64_t blobSize;
+
+	CHECK(!PipelineCacheFile::Read({}, TestIdentity, pBlob, blobSize));
+
+	// Truncated anywhere, in the header or in the blob
+	for (size_t size : { size_t(4), size_t(16), data.size() - blob.size() - 1, data.size() - blob.size(), data.size() - 1 })
+	{
+		const std::vector<uint8_t> truncated(data.begin(), data.begin() + size);
+		CHECK(!PipelineCacheFile::Read(truncated, TestIdentity, pBlob, blobSize));
+	}
+
+	// Trailing bytes
+	std::vector<uint8_t> longer = data;
+	longer.push_back(0);
+	CHECK(!PipelineCacheFile::Read(longer, TestIdentity, pBlob, blobSize));
+
+	// A single flipped bit in the blob, as a torn write would leave behind
+	for (size_t offset : { data.size() - blob.size(), data.size() - blob.size() / 2, data.size() - 1 })
+	{
+		std::vector<uint8_t> corrupt = data;
+		corrupt[offset] ^= 0x10;
+		CHECK(!PipelineCacheFile::Read(corrupt, TestIdentity, pBlob, blobSize));
+	}
+
+	// Wrong magic or version
+	std::vector<uint8_t> magic = data;
+	magic[0] ^= 0xff;
+	CHECK(!PipelineCacheFile::Read(magic, TestIdentity, pBlob, blobSize));
+	std::vector<uint8_t> version = data;
+	version[4]++;
+	CHECK(!PipelineCacheFile::Read(version, TestIdentity, pBlob, blobSize));
+}
@@ -0,0 +1,203 @@
+#include "TestFramework.h"
+#include "JobSystem.h"
+#include "ProceduralTexture.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	using Isa = ProceduralTexture::Isa;
+
+	const Isa AllIsas[] = { Isa::Scalar, Isa::Sse41, Isa::Avx2, Isa::Neon };
+	const ProceduralPattern AllPatterns[] = { ProceduralPattern::Checker, ProceduralPattern::LinearGradient, ProceduralPattern::RadialGradient,
+		ProceduralPattern::ValueNoise, ProceduralPattern::PerlinNoise, ProceduralPattern::SimplexNoise };
+	const uint8_t Padding = 0xCD;
+
+	// The per-byte loop DXRenderer used to build its checker texture with, cells an eighth of the width
+	std::vector<uint8_t> GenerateOldChecker(uint32_t width, uint32_t height)
+	{
+		const uint32_t rowPitch = width * 4;
+		const uint32_t cellPitch = rowPitch >> 3;
+		const uint32_t cellHeight = width >> 3;
+		const uint32_t size = rowPitch * height;
+		std::vector<uint8_t> data(size);
+		for (uint32_t n = 0; n < size; n += 4)
+		{
+			const uint32_t x = n % rowPitch;
+			const uint32_t y = n / rowPitch;
+			const uint32_t i = x / cellPitch;
+			const uint32_t j = y / cellHeight;
+			const bool black = i % 2 == j % 2;
+			data[n] = black ? 0x00 : 0xFF;
+			data[n + 1] = black ? 0x00 : 0xFF;
+			data[n + 2] = black ? 0x00 : 0xFF;
+			data[n + 3] = 0xFF;
+		}
+		return data;
+	}
+
+	// Odd sizes, a padded pitch and colours that aren't black and white
+	ProceduralTextureDesc GetOddDesc(ProceduralPattern pattern, uint32_t octaves)
+	{
+		ProceduralTextureDesc desc;
+		desc.pattern = pattern;
+		desc.width = 203;
+		desc.height = 77;
+		desc.colorA = 0x80102030;
+		desc.colorB = 0xFFF0E0D0;
+		desc.cellWidth = 7;
+		desc.cellHeight = 5;
+		desc.angle = 0.7f;
+		desc.frequency = 13.3f;
+		desc.octaves = octaves;
+		desc.seed = 1234;
+		return desc;
+	}
+
+	const uint64_t OddPitch = 256 * 4;
+
+	std::vector<uint8_t> GenerateOdd(const ProceduralTextureDesc& desc, Isa isa)
+	{
+		std::vector<uint8_t> pixels(OddPitch * desc.height, Padding);
+		ProceduralTexture::GenerateRows(desc, 0, desc.height, pixels.data(), OddPitch, isa);
+		return pixels;
+	}
+}
+
+TEST_CASE(ScalarIsAlwaysSupportedAndBestIsSupported)
+{
+	CHECK(ProceduralTexture::IsSupported(Isa::Scalar));
+	CHECK(ProceduralTexture::IsSupported(ProceduralTexture::GetBestIsa()));
+	CHECK(strcmp(ProceduralTexture::GetIsaName(Isa::Avx2), "AVX2") == 0);
+#if defined(__x86_64__) || defined(_M_X64)
+	CHECK(!ProceduralTexture::IsSupported(Isa::Neon));
+#endif
+}
+
+TEST_CASE(CheckerMatchesTheOldLoopOnEveryBackend)
+{
+	ProceduralTextureDesc desc;
+	const std::vector<uint8_t> expected = GenerateOldChecker(desc.width, desc.height);
+	for (Isa isa : AllIsas)
+	{
+		if (!ProceduralTexture::IsSupported(isa))
+			continue;
+		std::vector<uint8_t> pixels(expected.size(), Padding);
+		ProceduralTexture::GenerateRows(desc, 0, desc.height, pixels.data(), desc.width * 4, isa);
+		CHECK(pixels == expected);
+	}
+}
+
+TEST_CASE(BackendsAgreeWithScalarOnOddSizesAndPitches)
+{
+	for (ProceduralPattern pattern : AllPatterns)
+	{
+		for (uint32_t octaves : { 1u, 5u })
+		{
+			const ProceduralTextureDesc desc = GetOddDesc(pattern, octaves);
+			const std::vector<uint8_t> reference = GenerateOdd(desc, Isa::Scalar);
+
+			// Row padding is left alone
+			uint32_t paddingWrites = 0;
+			for (uint32_t y = 0; y < desc.height; y++)
+			{
+				for (uint64_t b = desc.width * 4; b < OddPitch; b++)
+					paddingWrites += reference[y * OddPitch + b] != Padding ? 1 : 0;
+			}
+			CHECK(paddingWrites == 0);
+
+			// Same pixels up to rounding in the last bit
+			for (Isa isa : AllIsas)
+			{
+				if (isa == Isa::Scalar || !ProceduralTexture::IsSupported(isa))
+					continue;
+				const std::vector<uint8_t> pixels = GenerateOdd(desc, isa);
+				int maxDifference = 0;
+				for (size_t i = 0; i < pixels.size(); i++)
+					maxDifference = std::max(maxDifference, std::abs(int(pixels[i]) - int(reference[i])));
+				CHECK(maxDifference <= 1);
+			}
+		}
+	}
+}
+
+TEST_CASE(PixelsStayBetweenTheTwoColours)
+{
+	for (ProceduralPattern pattern : AllPatterns)
+	{
+		const ProceduralTextureDesc desc = GetOddDesc(pattern, 4);
+		const std::vector<uint8_t> pixels = GenerateOdd(desc, ProceduralTexture::GetBestIsa());
+
+		uint32_t outside = 0;
+		int minRed = 255;
+		int maxRed = 0;
+		for (uint32_t y = 0; y < desc.height; y++)
+		{
+			for (uint32_t x = 0; x < desc.width; x++)
+			{
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					const int a = (desc.colorA >> (c * 8)) & 0xFF;
+					const int b = (desc.colorB >> (c * 8)) & 0xFF;
+					const int value = pixels[y * OddPitch + x * 4 + c];
+					outside += value < std::min(a, b) || value > std::max(a, b) ? 1 : 0;
+				}
+				minRed = std::min(minRed, int(pixels[y * OddPitch + x * 4]));
+				maxRed = std::max(maxRed, int(pixels[y * OddPitch + x * 4]));
+			}
+		}
+		CHECK(outside == 0);
+		// Every pattern uses a good part of the range, noise isn't flat
+		CHECK(maxRed - minRed > 64);
+	}
+}
+
+TEST_CASE(SeedChangesNoiseButNotTheChecker)
+{
+	for (ProceduralPattern pattern : { ProceduralPattern::ValueNoise, ProceduralPattern::PerlinNoise, ProceduralPattern::SimplexNoise })
+	{
+		ProceduralTextureDesc desc = GetOddDesc(pattern, 1);
+		const std::vector<uint8_t> first = GenerateOdd(desc, Isa::Scalar);
+		CHECK(GenerateOdd(desc, Isa::Scalar) == first);
+		desc.seed++;
+		CHECK(GenerateOdd(desc, Isa::Scalar) != first);
+	}
+
+	ProceduralTextureDesc checker = GetOddDesc(ProceduralPattern::Checker, 1);
+	const std::vector<uint8_t> first = GenerateOdd(checker, Isa::Scalar);
+	checker.seed++;
+	CHECK(GenerateOdd(checker, Isa::Scalar) == first);
+}
+
+TEST_CASE(RowRangesOnlyWriteTheirRows)
+{
+	const ProceduralTextureDesc desc = GetOddDesc(ProceduralPattern::PerlinNoise, 2);
+	const std::vector<uint8_t> whole = GenerateOdd(desc, Isa::Scalar);
+
+	std::vector<uint8_t> pixels(OddPitch * desc.height, Padding);
+	ProceduralTexture::GenerateRows(desc, 10, 20, pixels.data(), OddPitch, Isa::Scalar);
+	for (uint32_t y = 0; y < desc.height; y++)
+	{
+		const bool inside = y >= 10 && y < 30;
+		const uint8_t* pRow = pixels.data() + y * OddPitch;
+		if (inside)
+			CHECK(memcmp(pRow, whole.data() + y * OddPitch, OddPitch) == 0);
+		else
+			CHECK(std::count(pRow, pRow + OddPitch, Padding) == OddPitch);
+	}
+}
+
+TEST_CASE(ParallelMatchesSerial)
+{
+	JobSystem jobs(3);
+	for (ProceduralPattern pattern : AllPatterns)
+	{
+		const ProceduralTextureDesc desc = GetOddDesc(pattern, 3);
+		std::vector<uint8_t> parallel(OddPitch * desc.height, Padding);
+		ProceduralTexture::Generate(desc, parallel.data(), OddPitch, &jobs);
+		CHECK(parallel == GenerateOdd(desc, ProceduralTexture::GetBestIsa()));
+	}
+}
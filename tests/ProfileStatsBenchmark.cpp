@@ -0,0 +1,70 @@
+#include "Benchmark.h"
+#include "ProfileStats.h"
+
+#include <random>
+#include <string>
+
+// Per-frame CPU cost of the GPU profiler once its timestamps are read back: rebuild the scope tree,
+// add it to the rolling statistics, and summarize every scope as the overlay does each frame.
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const uint32_t frameCount = quick ? 50 : 2000;
+	const uint32_t passCount = 40;
+	const uint32_t drawsPerPass = 6;
+
+	std::vector<std::string> names(passCount);
+	for (uint32_t p = 0; p < passCount; p++)
+		names[p] = "Pass " + std::to_string(p);
+
+	// Frame, passes and their draws, with jittered timings and resolved out of order
+	std::mt19937 rng(42);
+	std::vector<std::vector<ProfileEvent>> frames(64);
+	for (std::vector<ProfileEvent>& events : frames)
+	{
+		uint64_t time = 0;
+		events.push_back({ "Frame", 0, 0 });
+		for (uint32_t p = 0; p < passCount; p++)
+		{
+			const uint64_t passBegin = time++;
+			for (uint32_t d = 0; d < drawsPerPass; d++)
+			{
+				const uint64_t duration = 100 + rng() % 400;
+				events.push_back({ "Draw", time, time + duration });
+				time += duration + 1;
+			}
+			events.push_back({ names[p].c_str(), passBegin, time++ });
+		}
+		events[0].end = time;
+		std::shuffle(events.begin(), events.end(), rng);
+	}
+
+	ProfileStats stats(256);
+	std::vector<ProfileNode> nodes;
+	std::vector<ProfileStats::Summary> summaries;
+	const double buildTime = Benchmark::Measure(3, [&]()
+	{
+		for (uint32_t frame = 0; frame < frameCount; frame++)
+		{
+			const std::vector<ProfileEvent>& events = frames[frame % frames.size()];
+			ProfileTree::Build(events.data(), events.size(), nodes);
+		}
+	});
+	const double addTime = Benchmark::Measure(3, [&]()
+	{
+		for (uint32_t frame = 0; frame < frameCount; frame++)
+			stats.AddFrame(nodes, 1000000);
+	});
+	const double summaryTime = Benchmark::Measure(3, [&]()
+	{
+		for (uint32_t frame = 0; frame < frameCount; frame++)
+			stats.GetSummaries(summaries);
+	});
+	Benchmark::DoNotOptimize(summaries.data());
+
+	const size_t scopeCount = frames[0].size();
+	printf("ProfileTree::Build: %zu scopes, %.1f us per frame\n", scopeCount, buildTime / frameCount * 1e6);
+	printf("ProfileStats::AddFrame: %.1f us per frame\n", addTime / frameCount * 1e6);
+	printf("ProfileStats::GetSummaries: %zu series over 256 frames, %.1f us per frame\n", summaries.size(), summaryTime / frameCount * 1e6);
+	return nodes.size() == scopeCount && summaries.size() == 1 + 2 * passCount ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#include "TestFramework.h"
+#include "ProfileStats.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	// Ticks are microseconds, so a scope of 1000 ticks is 1 ms
+	const uint64_t TicksPerSecond = 1000000;
+
+	std::vector<ProfileNode> MakeFrame(uint64_t frameTicks, uint64_t passTicks)
+	{
+		const ProfileEvent events[] = {
+			{ "Frame", 0, frameTicks },
+			{ "Pass", 0, passTicks },
+		};
+		std::vector<ProfileNode> nodes;
+		ProfileTree::Build(events, 2, nodes);
+		return nodes;
+	}
+
+	bool Near(double a, double b)
+	{
+		return std::fabs(a - b) < 1e-9;
+	}
+}
+
+TEST_CASE(SummarizesEveryScopeInTreeOrder)
+{
+	ProfileStats stats;
+	stats.AddFrame(MakeFrame(4000, 1000), TicksPerSecond);
+	stats.AddFrame(MakeFrame(2000, 1500), TicksPerSecond);
+	stats.AddFrame(MakeFrame(3000, 2000), TicksPerSecond);
+
+	std::vector<ProfileStats::Summary> summaries;
+	stats.GetSummaries(summaries);
+	REQUIRE(summaries.size() == 2);
+	CHECK(strcmp(summaries[0].name, "Frame") == 0);
+	CHECK(summaries[0].depth == 0);
+	CHECK(summaries[0].sampleCount == 3);
+	CHECK(Near(summaries[0].last, 3.0));
+	CHECK(Near(summaries[0].min, 2.0));
+	CHECK(Near(summaries[0].avg, 3.0));
+	CHECK(Near(summaries[0].p99, 4.0));
+
+	CHECK(strcmp(summaries[1].name, "Pass") == 0);
+	CHECK(summaries[1].depth == 1);
+	CHECK(Near(summaries[1].last, 2.0));
+	CHECK(Near(summaries[1].min, 1.0));
+	CHECK(Near(summaries[1].avg, 1.5));
+	CHECK(Near(summaries[1].p99, 2.0));
+}
+
+TEST_CASE(WindowKeepsOnlyTheLatestFrames)
+{
+	ProfileStats stats(4);
+	for (uint64_t frame = 1; frame <= 10; frame++)
+		stats.AddFrame(MakeFrame(frame * 1000, 0), TicksPerSecond);
+
+	// Frames 7 to 10 are left
+	ProfileStats::Summary summary;
+	REQUIRE(stats.GetSummary("Frame", summary));
+	CHECK(summary.sampleCount == 4);
+	CHECK(Near(summary.last, 10.0));
+	CHECK(Near(summary.min, 7.0));
+	CHECK(Near(summary.avg, 8.5));
+	CHECK(Near(summary.p99, 10.0));
+}
+
+TEST_CASE(P99IsTheNearestRank)
+{
+	ProfileStats stats(256);
+	// 1..200 ms in a scrambled order, rank ceil(0.99 * 200) = 198
+	for (uint64_t n = 0; n < 200; n++)
+		stats.AddFrame(MakeFrame(1000 * (1 + (n * 77) % 200), 0), TicksPerSecond);
+
+	ProfileStats::Summary summary;
+	REQUIRE(stats.GetSummary("Frame", summary));
+	CHECK(Near(summary.p99, 198.0));
+	CHECK(Near(summary.min, 1.0));
+	CHECK(Near(summary.avg, 100.5));
+
+	// A single spike among many identical frames shows only once it is in the top percent
+	ProfileStats spiky(100);
+	for (uint32_t n = 0; n < 99; n++)
+		spiky.AddFrame(MakeFrame(1000, 0), TicksPerSecond);
+	spiky.AddFrame(MakeFrame(50000, 0), TicksPerSecond);
+	REQUIRE(spiky.GetSummary("Frame", summary));
+	CHECK(Near(summary.p99, 1.0));
+	spiky.AddFrame(MakeFrame(50000, 0), TicksPerSecond);
+	REQUIRE(spiky.GetSummary("Frame", summary));
+	CHECK(Near(summary.p99, 50.0));
+}
+
+TEST_CASE(RepeatedScopesCountAsTheirTotal)
+{
+	// One scope per command list, serialized on the queue
+	const ProfileEvent events[] = {
+		{ "Frame", 0, 10000 },
+		{ "Draw", 1000, 2000 },
+		{ "Draw", 3000, 5000 },
+		{ "Draw", 6000, 6500 },
+	};
+	std::vector<ProfileNode> nodes;
+	ProfileTree::Build(events, 4, nodes);
+
+	ProfileStats stats;
+	stats.AddFrame(nodes, TicksPerSecond);
+	stats.AddFrame(nodes, TicksPerSecond);
+
+	std::vector<ProfileStats::Summary> summaries;
+	stats.GetSummaries(summaries);
+	REQUIRE(summaries.size() == 2);
+	CHECK(summaries[1].sampleCount == 2);
+	CHECK(Near(summaries[1].last, 3.5));
+	CHECK(Near(summaries[1].avg, 3.5));
+}
+
+TEST_CASE(ScopesMissingFromAFrameKeepTheirHistory)
+{
+	ProfileStats stats;
+	const ProfileEvent withBloom[] = { { "Frame", 0, 5000 }, { "Bloom", 1000, 2000 } };
+	const ProfileEvent withoutBloom[] = { { "Frame", 0, 4000 } };
+	std::vector<ProfileNode> nodes;
+
+	ProfileTree::Build(withBloom, 2, nodes);
+	stats.AddFrame(nodes, TicksPerSecond);
+	ProfileTree::Build(withoutBloom, 1, nodes);
+	stats.AddFrame(nodes, TicksPerSecond);
+
+	std::vector<ProfileStats::Summary> summaries;
+	stats.GetSummaries(summaries);
+	REQUIRE(summaries.size() == 2);
+	CHECK(summaries[0].sampleCount == 2);
+	CHECK(summaries[1].sampleCount == 1);
+	CHECK(Near(summaries[1].last, 1.0));
+}
+
+TEST_CASE(OnlyRootScopesAreFoundByName)
+{
+	ProfileStats stats;
+	stats.AddFrame(MakeFrame(2000, 1000), TicksPerSecond);
+
+	ProfileStats::Summary summary;
+	CHECK(stats.GetSummary("Frame", summary));
+	CHECK(!stats.GetSummary("Pass", summary));
+	CHECK(!stats.GetSummary("Unknown", summary));
+
+	stats.Reset();
+	CHECK(!stats.GetSummary("Frame", summary));
+	std::vector<ProfileStats::Summary> summaries;
+	stats.GetSummaries(summaries);
+	CHECK(summaries.empty());
+
+	// Ticks are converted with the rate of the frame they came with
+	stats.AddFrame(MakeFrame(2000, 1000), 2 * TicksPerSecond);
+	REQUIRE(stats.GetSummary("Frame", summary));
+	CHECK(Near(summary.last, 1.0));
+}
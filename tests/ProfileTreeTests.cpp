@@ -0,0 +1,181 @@
+#include "TestFramework.h"
+#include "Hasher.h"
+#include "ProfileTree.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+namespace
+{
+	uint64_t HashPath(std::initializer_list<const char*> names)
+	{
+		uint64_t hash = 0;
+		bool root = true;
+		for (const char* pName : names)
+		{
+			Hasher hasher;
+			if (!root)
+				hasher.AddValue(hash);
+			hasher.AddString(pName);
+			hash = hasher.Get();
+			root = false;
+		}
+		return hash;
+	}
+
+	std::string Describe(const std::vector<ProfileNode>& nodes)
+	{
+		// name:depth:parent name, in node order
+		std::string text;
+		for (const ProfileNode& node : nodes)
+		{
+			text += node.name;
+			text += ':' + std::to_string(node.depth) + ':';
+			text += node.parent == ProfileNode::InvalidParent ? "-" : nodes[node.parent].name;
+			text += ' ';
+		}
+		return text;
+	}
+}
+
+TEST_CASE(NestingComesFromTimingAlone)
+{
+	// Recorded in end order, as scopes close
+	const ProfileEvent events[] = {
+		{ "Shadows", 10, 20 },
+		{ "Opaque", 25, 60 },
+		{ "Sky", 62, 70 },
+		{ "Scene", 5, 80 },
+		{ "Post", 85, 95 },
+		{ "Frame", 0, 100 },
+		{ "Present", 110, 120 },
+	};
+	std::vector<ProfileNode> nodes;
+	ProfileTree::Build(events, sizeof(events) / sizeof(events[0]), nodes);
+
+	CHECK(Describe(nodes) == "Frame:0:- Scene:1:Frame Shadows:2:Scene Opaque:2:Scene Sky:2:Scene Post:1:Frame Present:0:- ");
+	REQUIRE(nodes.size() == 7);
+	CHECK(nodes[0].pathHash == HashPath({ "Frame" }));
+	CHECK(nodes[3].pathHash == HashPath({ "Frame", "Scene", "Opaque" }));
+	CHECK(nodes[6].pathHash == HashPath({ "Present" }));
+}
+
+TEST_CASE(SharedBoundsNestTheLongerScopeOutside)
+{
+	// Same begin: the longer one is the parent. Same begin and end: first recorded is the parent.
+	const ProfileEvent events[] = {
+		{ "Inner", 0, 50 },
+		{ "Outer", 0, 100 },
+		{ "Twin A", 60, 80 },
+		{ "Twin B", 60, 80 },
+		// Touching scopes are siblings
+		{ "Tail", 80, 100 },
+	};
+	std::vector<ProfileNode> nodes;
+	ProfileTree::Build(events, sizeof(events) / sizeof(events[0]), nodes);
+
+	CHECK(Describe(nodes) == "Outer:0:- Inner:1:Outer Twin A:1:Outer Twin B:2:Twin A Tail:1:Outer ");
+}
+
+TEST_CASE(UnresolvedQueriesAreDropped)
+{
+	const ProfileEvent events[] = {
+		{ "Frame", 0, 100 },
+		{ "Never resolved", 50, 0 },
+		{ "Pass", 10, 20 },
+		{ "Instant", 30, 30 },
+	};
+	std::vector<ProfileNode> nodes = { { "Stale", 0, 0, 0, 0, 0 } };
+	ProfileTree::Build(events, sizeof(events) / sizeof(events[0]), nodes);
+
+	CHECK(Describe(nodes) == "Frame:0:- Pass:1:Frame Instant:1:Frame ");
+
+	ProfileTree::Build(nullptr, 0, nodes);
+	CHECK(nodes.empty());
+}
+
+TEST_CASE(SameScopeUnderDifferentParentsHasDifferentPaths)
+{
+	const ProfileEvent events[] = {
+		{ "Shadows", 0, 50 },
+		{ "Draw", 10, 20 },
+		{ "Opaque", 50, 100 },
+		{ "Draw", 60, 70 },
+		{ "Draw", 75, 90 },
+	};
+	std::vector<ProfileNode> nodes;
+	ProfileTree::Build(events, sizeof(events) / sizeof(events[0]), nodes);
+
+	REQUIRE(nodes.size() == 5);
+	CHECK(nodes[1].pathHash == HashPath({ "Shadows", "Draw" }));
+	CHECK(nodes[3].pathHash == HashPath({ "Opaque", "Draw" }));
+	CHECK(nodes[1].pathHash != nodes[3].pathHash);
+	// Repeats under one parent share the path
+	CHECK(nodes[3].pathHash == nodes[4].pathHash);
+}
+
+TEST_CASE(ShuffledInputGivesTheSameTree)
+{
+	// A balanced tree four levels deep
+	std::vector<ProfileEvent> events;
+	static const char* const names[] = { "L0", "L1", "L2", "L3" };
+	for (uint64_t a = 0; a < 3; a++)
+	{
+		const uint64_t base = a * 1000;
+		events.push_back({ names[0], base, base + 900 });
+		for (uint64_t b = 0; b < 3; b++)
+		{
+			const uint64_t base1 = base + 10 + b * 290;
+			events.push_back({ names[1], base1, base1 + 280 });
+			for (uint64_t c = 0; c < 3; c++)
+			{
+				const uint64_t base2 = base1 + 5 + c * 90;
+				events.push_back({ names[2], base2, base2 + 80 });
+				events.push_back({ names[3], base2 + 10, base2 + 20 });
+			}
+		}
+	}
+
+	std::vector<ProfileNode> expected;
+	ProfileTree::Build(events.data(), events.size(), expected);
+	REQUIRE(expected.size() == events.size());
+	for (size_t i = 0; i < expected.size(); i++)
+	{
+		const uint32_t depth = static_cast<uint32_t>(expected[i].name[1] - '0');
+		CHECK(expected[i].depth == depth);
+		if (depth > 0)
+		{
+			REQUIRE(expected[i].parent < i);
+			const ProfileNode& parent = expected[expected[i].parent];
+			CHECK(parent.depth == depth - 1);
+			CHECK(parent.begin <= expected[i].begin && expected[i].end <= parent.end);
+		}
+	}
+
+	std::mt19937 rng(3);
+	std::vector<ProfileNode> nodes;
+	for (uint32_t n = 0; n < 20; n++)
+	{
+		std::shuffle(events.begin(), events.end(), rng);
+		ProfileTree::Build(events.data(), events.size(), nodes);
+		CHECK(Describe(nodes) == Describe(expected));
+	}
+}
+
+TEST_CASE(DeepNestingIsCapped)
+{
+	std::vector<std::string> names(100);
+	std::vector<ProfileEvent> events;
+	for (uint64_t n = 0; n < names.size(); n++)
+	{
+		names[n] = "Scope" + std::to_string(n);
+		events.push_back({ names[n].c_str(), n, 1000 - n });
+	}
+
+	std::vector<ProfileNode> nodes;
+	ProfileTree::Build(events.data(), events.size(), nodes);
+	REQUIRE(nodes.size() == 100);
+	for (size_t n = 0; n < nodes.size(); n++)
+		CHECK(nodes[n].depth == std::min<size_t>(n, 64));
+}
@@ -0,0 +1,73 @@
+#include "Benchmark.h"
+#include "RenderGraphCompiler.h"
+
+#include <random>
+
+// Compile time of frame sized graphs, up to 2000 passes. Every pass writes its own transient and reads what
+// the previous passes wrote, the last one writes the back buffer, so the whole graph stays alive and
+// short lived transients alias each other.
+// The graph is rebuilt every frame, so this is a per frame CPU cost.
+namespace
+{
+	const uint32_t RenderTarget = 0x4;
+	const uint32_t PixelShaderResource = 0x80;
+	const uint32_t Present = 0x0;
+
+	void BuildGraph(RenderGraphCompiler& compiler, uint32_t passCount, uint32_t resourceCount, uint32_t importedCount, uint32_t seed)
+	{
+		std::mt19937 rng(seed);
+		compiler.Reset();
+		for (uint32_t n = 0; n < resourceCount; n++)
+		{
+			if (n < importedCount)
+				compiler.AddResource({ 0, 0, 0, true, Present });
+			else
+				compiler.AddResource({ (1 + rng() % 8) * 1024 * 1024ull, 64 * 1024, static_cast<uint32_t>(rng() % 2), false, RenderGraphCompiler::InvalidState });
+		}
+
+		const uint32_t transientCount = resourceCount - importedCount;
+		for (uint32_t pass = 0; pass < passCount; pass++)
+		{
+			compiler.AddPass(false);
+			compiler.AddUse(pass, importedCount + pass % transientCount, RenderTarget, true);
+			if (pass >= 1)
+				compiler.AddUse(pass, importedCount + (pass - 1) % transientCount, PixelShaderResource, false);
+			if (pass >= 8 && rng() % 4 == 0)
+				compiler.AddUse(pass, importedCount + (pass - 8) % transientCount, PixelShaderResource, false);
+			if (pass + 1 == passCount)
+				compiler.AddUse(pass, 0, RenderTarget, true);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const uint32_t compileCount = quick ? 5 : 200;
+	const uint32_t passCounts[] = { 100, 600, 2000 };
+
+	bool failed = false;
+	for (uint32_t passCount : passCounts)
+	{
+		RenderGraphCompiler compiler;
+		RenderGraphCompiler::Result result;
+		const uint32_t resourceCount = passCount + 4;
+
+		// Building is part of the per frame cost, so it is timed along with compilation
+		const double time = Benchmark::Measure(3, [&]()
+		{
+			for (uint32_t n = 0; n < compileCount; n++)
+			{
+				BuildGraph(compiler, passCount, resourceCount, 4, n);
+				failed |= !compiler.Compile(result);
+			}
+		});
+
+		uint64_t heapSize = 0;
+		for (uint64_t size : result.heapSizes)
+			heapSize += size;
+		printf("%5u passes %4u resources: %7.3f ms per compile, %zu passes alive, %zu barriers, %.0f MB of transient heaps\n",
+			passCount, resourceCount, time / compileCount * 1e3, result.passOrder.size(), result.barriers.size(), heapSize / (1024.0 * 1024.0));
+	}
+	return failed ? 1 : 0;
+}
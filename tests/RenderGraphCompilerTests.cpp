@@ -0,0 +1,300 @@
+#include "TestFramework.h"
+#include "RenderGraphCompiler.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	// D3D12_RESOURCE_STATES values the tests use
+	const uint32_t RenderTarget = 0x4;
+	const uint32_t UnorderedAccess = 0x8;
+	const uint32_t DepthWrite = 0x10;
+	const uint32_t NonPixelShaderResource = 0x40;
+	const uint32_t PixelShaderResource = 0x80;
+	const uint32_t Present = 0x0;
+
+	typedef RenderGraphCompiler::Barrier Barrier;
+
+	RenderGraphCompiler::Resource Transient(uint64_t size, uint64_t alignment = 256, uint32_t heapClass = 0)
+	{
+		return { size, alignment, heapClass, false, RenderGraphCompiler::InvalidState };
+	}
+
+	RenderGraphCompiler::Resource Imported(uint32_t finalState)
+	{
+		return { 0, 0, 0, true, finalState };
+	}
+
+	std::vector<Barrier> GetBarriers(const RenderGraphCompiler::Result& result, uint32_t position)
+	{
+		return std::vector<Barrier>(result.barriers.begin() + result.barrierOffsets[position],
+			result.barriers.begin() + result.barrierOffsets[position + 1]);
+	}
+
+	bool HasTransition(const std::vector<Barrier>& barriers, uint32_t resource, uint32_t state)
+	{
+		for (const Barrier& barrier : barriers)
+		{
+			if (barrier.type == Barrier::Type::Transition && barrier.resource == resource && barrier.state == state)
+				return true;
+		}
+		return false;
+	}
+
+	uint32_t CountTransitions(const std::vector<Barrier>& barriers, uint32_t resource)
+	{
+		uint32_t count = 0;
+		for (const Barrier& barrier : barriers)
+			count += barrier.type == Barrier::Type::Transition && barrier.resource == resource ? 1 : 0;
+		return count;
+	}
+}
+
+TEST_CASE(UnusedPassesAreCulled)
+{
+	RenderGraphCompiler compiler;
+	const uint32_t backBuffer = compiler.AddResource(Imported(Present));
+	const uint32_t color = compiler.AddResource(Transient(1000));
+	const uint32_t unused = compiler.AddResource(Transient(1000));
+
+	const uint32_t scene = compiler.AddPass(false);
+	compiler.AddUse(scene, color, RenderTarget, true);
+	const uint32_t orphan = compiler.AddPass(false);
+	compiler.AddUse(orphan, unused, RenderTarget, true);
+	const uint32_t sideEffect = compiler.AddPass(true);
+	const uint32_t post = compiler.AddPass(false);
+	compiler.AddUse(post, color, PixelShaderResource, false);
+	compiler.AddUse(post, backBuffer, RenderTarget, true);
+
+	RenderGraphCompiler::Result result;
+	REQUIRE(compiler.Compile(result));
+	CHECK(result.passOrder == std::vector<uint32_t>({ scene, sideEffect, post }));
+	CHECK(result.firstUse[unused] == RenderGraphCompiler::InvalidIndex);
+	CHECK(result.firstUse[color] == 0);
+	CHECK(result.lastUse[color] == 2);
+
+	// The back buffer goes back to present after the last pass
+	const std::vector<Barrier> final = GetBarriers(result, static_cast<uint32_t>(result.passOrder.size()));
+	CHECK(HasTransition(final, backBuffer, Present));
+	CHECK(result.finalStates[backBuffer] == Present);
+}
+
+TEST_CASE(ConsecutiveReadsShareOneTransition)
+{
+	RenderGraphCompiler compiler;
+	const uint32_t output = compiler.AddResource(Imported(RenderGraphCompiler::InvalidState));
+	const uint32_t shadow = compiler.AddResource(Transient(4096));
+
+	const uint32_t render = compiler.AddPass(false);
+	compiler.AddUse(render, shadow, DepthWrite, true);
+	const uint32_t lightA = compiler.AddPass(false);
+	compiler.AddUse(lightA, shadow, PixelShaderResource, false);
+	compiler.AddUse(lightA, output, RenderTarget, true);
+	const uint32_t lightB = compiler.AddPass(false);
+	compiler.AddUse(lightB, shadow, NonPixelShaderResource, false);
+	compiler.AddUse(lightB, output, RenderTarget, true);
+
+	RenderGraphCompiler::Result result;
+	REQUIRE(compiler.Compile(result));
+	REQUIRE(result.passOrder.size() == 3);
+	CHECK(HasTransition(GetBarriers(result, 0), shadow, DepthWrite));
+	CHECK(HasTransition(GetBarriers(result, 1), shadow, PixelShaderResource | NonPixelShaderResource));
+	CHECK(CountTransitions(GetBarriers(result, 2), shadow) == 0);
+	// Output stays a render target, the imported resource keeps its last state
+	CHECK(CountTransitions(GetBarriers(result, 2), output) == 0);
+	CHECK(result.finalStates[output] == RenderTarget);
+}
+
+TEST_CASE(ReadAndWriteInDifferentStatesIsRejected)
+{
+	RenderGraphCompiler compiler;
+	const uint32_t output = compiler.AddResource(Imported(Present));
+	const uint32_t color = compiler.AddResource(Transient(1000));
+
+	const uint32_t pass = compiler.AddPass(false);
+	compiler.AddUse(pass, color, RenderTarget, true);
+	compiler.AddUse(pass, color, PixelShaderResource, false);
+	compiler.AddUse(pass, output, RenderTarget, true);
+
+	RenderGraphCompiler::Result result;
+	CHECK(!compiler.Compile(result));
+
+	// Two write states are no better
+	compiler.Reset();
+	const uint32_t target = compiler.AddResource(Imported(Present));
+	const uint32_t other = compiler.AddPass(false);
+	compiler.AddUse(other, target, RenderTarget, true);
+	compiler.AddUse(other, target, DepthWrite, true);
+	CHECK(!compiler.Compile(result));
+}
+
+TEST_CASE(ReadWriteInOneStateIsAccepted)
+{
+	// A UAV both read and written by the same dispatch
+	RenderGraphCompiler compiler;
+	const uint32_t buffer = compiler.AddResource(Imported(RenderGraphCompiler::InvalidState));
+	const uint32_t pass = compiler.AddPass(false);
+	compiler.AddUse(pass, buffer, UnorderedAccess, false);
+	compiler.AddUse(pass, buffer, UnorderedAccess, true);
+
+	RenderGraphCompiler::Result result;
+	REQUIRE(compiler.Compile(result));
+	const std::vector<Barrier> barriers = GetBarriers(result, 0);
+	REQUIRE(barriers.size() == 1);
+	CHECK(HasTransition(barriers, buffer, UnorderedAccess));
+
+	// Several reads in different states in one pass combine fine
+	compiler.Reset();
+	const uint32_t texture = compiler.AddResource(Imported(RenderGraphCompiler::InvalidState));
+	const uint32_t output = compiler.AddResource(Imported(RenderGraphCompiler::InvalidState));
+	const uint32_t reader = compiler.AddPass(false);
+	compiler.AddUse(reader, texture, PixelShaderResource, false);
+	compiler.AddUse(reader, texture, NonPixelShaderResource, false);
+	compiler.AddUse(reader, output, RenderTarget, true);
+	REQUIRE(compiler.Compile(result));
+	CHECK(HasTransition(GetBarriers(result, 0), texture, PixelShaderResource | NonPixelShaderResource));
+}
+
+TEST_CASE(TransientsWithDisjointLifetimesShareMemory)
+{
+	RenderGraphCompiler compiler;
+	const uint32_t output = compiler.AddResource(Imported(Present));
+	const uint32_t a = compiler.AddResource(Transient(4096, 4096));
+	const uint32_t b = compiler.AddResource(Transient(4096, 4096));
+	const uint32_t c = compiler.AddResource(Transient(4096, 4096));
+
+	// a -> b, then b -> c, a is dead once b is written so c can take its memory
+	const uint32_t first = compiler.AddPass(false);
+	compiler.AddUse(first, a, RenderTarget, true);
+	const uint32_t second = compiler.AddPass(false);
+	compiler.AddUse(second, a, PixelShaderResource, false);
+	compiler.AddUse(second, b, RenderTarget, true);
+	const uint32_t third = compiler.AddPass(false);
+	compiler.AddUse(third, b, PixelShaderResource, false);
+	compiler.AddUse(third, c, RenderTarget, true);
+	const uint32_t fourth = compiler.AddPass(false);
+	compiler.AddUse(fourth, c, PixelShaderResource, false);
+	compiler.AddUse(fourth, output, RenderTarget, true);
+
+	RenderGraphCompiler::Result result;
+	REQUIRE(compiler.Compile(result));
+	CHECK(result.heapSizes.size() == 1);
+	CHECK(result.heapSizes[0] == 2 * 4096);
+	CHECK(result.heapOffsets[a] == result.heapOffsets[c]);
+	CHECK(result.heapOffsets[a] != result.heapOffsets[b]);
+	CHECK(result.aliased[a] && result.aliased[c]);
+
+	// c takes over a's memory with an aliasing barrier ahead of its first use
+	bool found = false;
+	for (const Barrier& barrier : GetBarriers(result, 2))
+	{
+		if (barrier.type == Barrier::Type::Aliasing && barrier.resource == c && barrier.resourceBefore == a)
+			found = true;
+	}
+	CHECK(found);
+}
+
+TEST_CASE(RandomGraphsNeverOverlapLiveTransients)
+{
+	std::mt19937 rng(1);
+	uint32_t rejectedCount = 0;
+	for (uint32_t iteration = 0; iteration < 300; iteration++)
+	{
+		RenderGraphCompiler compiler;
+		const uint32_t resourceCount = 1 + rng() % 40;
+		const uint32_t passCount = 1 + rng() % 60;
+
+		std::vector<RenderGraphCompiler::Resource> resources;
+		for (uint32_t n = 0; n < resourceCount; n++)
+		{
+			RenderGraphCompiler::Resource resource = Transient(1 + rng() % 5000, 1ull << (rng() % 10), rng() % 2);
+			if (rng() % 5 == 0)
+				resource = Imported(rng() % 3 ? RenderGraphCompiler::InvalidState : Present);
+			resources.push_back(resource);
+			compiler.AddResource(resource);
+		}
+
+		// Keep track of whether some pass mixes a write with another state, the graph must be rejected then
+		bool valid = true;
+		for (uint32_t pass = 0; pass < passCount; pass++)
+		{
+			compiler.AddPass(rng() % 10 == 0);
+			std::vector<std::pair<uint32_t, std::pair<uint32_t, bool>>> uses;
+			const uint32_t useCount = rng() % 4;
+			for (uint32_t n = 0; n < useCount; n++)
+			{
+				const uint32_t resource = rng() % resourceCount;
+				const uint32_t state = 1u << (rng() % 5);
+				const bool write = rng() % 2 == 0;
+				for (const auto& use : uses)
+				{
+					if (use.first == resource && (use.second.second || write) && use.second.first != state)
+						valid = false;
+				}
+				uses.push_back({ resource, { state, write } });
+				compiler.AddUse(pass, resource, state, write);
+			}
+		}
+
+		RenderGraphCompiler::Result result;
+		const bool compiled = compiler.Compile(result);
+		CHECK(compiled == valid);
+		if (!compiled)
+		{
+			rejectedCount++;
+			continue;
+		}
+
+		REQUIRE(result.barrierOffsets.size() == result.passOrder.size() + 2);
+		for (size_t n = 1; n < result.passOrder.size(); n++)
+			CHECK(result.passOrder[n - 1] < result.passOrder[n]);
+
+		for (uint32_t i = 0; i < resourceCount; i++)
+		{
+			if (resources[i].imported || result.firstUse[i] == RenderGraphCompiler::InvalidIndex)
+				continue;
+			CHECK(result.heapOffsets[i] % resources[i].alignment == 0);
+
+			for (uint32_t j = i + 1; j < resourceCount; j++)
+			{
+				if (resources[j].imported || result.firstUse[j] == RenderGraphCompiler::InvalidIndex || resources[i].heapClass != resources[j].heapClass)
+					continue;
+
+				const bool liveTogether = result.firstUse[i] <= result.lastUse[j] && result.firstUse[j] <= result.lastUse[i];
+				const bool sharedMemory = result.heapOffsets[i] < result.heapOffsets[j] + resources[j].size &&
+					result.heapOffsets[j] < result.heapOffsets[i] + resources[i].size;
+				CHECK(!(liveTogether && sharedMemory));
+				if (sharedMemory)
+					CHECK(result.aliased[i] && result.aliased[j]);
+			}
+		}
+	}
+
+	// Both kinds of graph were generated
+	CHECK(rejectedCount > 0);
+	CHECK(rejectedCount < 300);
+}
+
+TEST_CASE(ResetAllowsRecompiling)
+{
+	RenderGraphCompiler compiler;
+	RenderGraphCompiler::Result result;
+	for (uint32_t frame = 0; frame < 3; frame++)
+	{
+		compiler.Reset();
+		const uint32_t output = compiler.AddResource(Imported(Present));
+		const uint32_t color = compiler.AddResource(Transient(1024));
+		const uint32_t scene = compiler.AddPass(false);
+		compiler.AddUse(scene, color, RenderTarget, true);
+		const uint32_t post = compiler.AddPass(false);
+		compiler.AddUse(post, color, PixelShaderResource, false);
+		compiler.AddUse(post, output, RenderTarget, true);
+
+		REQUIRE(compiler.Compile(result));
+		CHECK(compiler.GetPassCount() == 2);
+		CHECK(compiler.GetResourceCount() == 2);
+		CHECK(result.passOrder.size() == 2);
+		CHECK(result.heapSizes[0] == 1024);
+	}
+}
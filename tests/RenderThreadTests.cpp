@@ -0,0 +1,184 @@
+#include "TestFramework.h"
+#include "RenderThread.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// What the render thread saw, only touched on it until Stop returns
+	struct Recording
+	{
+		std::vector<uint32_t> keys;
+		std::vector<WindowEvent::Type> types;
+		// Frames run before each event was handed over
+		std::vector<uint64_t> eventFrames;
+		uint64_t frames = 0;
+		std::atomic<bool> frameRunning{ false };
+	};
+
+	void Start(RenderThread& thread, Recording& recording, std::chrono::microseconds frameTime = std::chrono::microseconds(0))
+	{
+		thread.Start(
+			[&recording, frameTime]()
+			{
+				recording.frameRunning.store(true);
+				if (frameTime.count() > 0)
+					std::this_thread::sleep_for(frameTime);
+				recording.frames++;
+				recording.frameRunning.store(false);
+			},
+			[&recording](const WindowEvent& event)
+			{
+				recording.keys.push_back(event.key);
+				recording.types.push_back(event.type);
+				recording.eventFrames.push_back(recording.frames);
+			});
+	}
+
+	// Until the render thread has run frameCount more frames
+	void WaitForFrames(const RenderThread& thread, uint64_t frameCount)
+	{
+		const uint64_t target = thread.GetFrameCount() + frameCount;
+		while (thread.GetFrameCount() < target)
+			std::this_thread::yield();
+	}
+}
+
+TEST_CASE(FramesRunUntilStopped)
+{
+	RenderThread thread;
+	Recording recording;
+	CHECK(!thread.IsRunning());
+
+	Start(thread, recording);
+	CHECK(thread.IsRunning());
+	WaitForFrames(thread, 100);
+
+	thread.Stop();
+	CHECK(!thread.IsRunning());
+	CHECK(recording.frames == thread.GetFrameCount());
+	CHECK(recording.frames >= 100);
+
+	// No frames once it returned, a second Stop does nothing
+	const uint64_t frames = recording.frames;
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	CHECK(recording.frames == frames);
+	thread.Stop();
+}
+
+TEST_CASE(EventsArriveInOrderBetweenFrames)
+{
+	RenderThread thread;
+	Recording recording;
+	Start(thread, recording, std::chrono::microseconds(200));
+
+	for (uint32_t key = 0; key < 64; key++)
+	{
+		thread.Post({ key % 2 == 0 ? WindowEvent::KeyDown : WindowEvent::KeyUp, key });
+		if (key % 8 == 7)
+			WaitForFrames(thread, 2);
+	}
+	// Everything posted before a frame starts is handed over by the one after it
+	WaitForFrames(thread, 2);
+	thread.Stop();
+
+	REQUIRE(recording.keys.size() == 64);
+	for (uint32_t key = 0; key < 64; key++)
+	{
+		CHECK(recording.keys[key] == key);
+		CHECK(recording.types[key] == (key % 2 == 0 ? WindowEvent::KeyDown : WindowEvent::KeyUp));
+	}
+	for (size_t i = 1; i < recording.eventFrames.size(); i++)
+		CHECK(recording.eventFrames[i] >= recording.eventFrames[i - 1]);
+	// The batches waited on above were split across frames
+	CHECK(recording.eventFrames.back() > recording.eventFrames.front());
+}
+
+TEST_CASE(PostWaitsForRoomInsteadOfDropping)
+{
+	RenderThread thread;
+	Recording recording;
+	// Slow frames, the window thread outruns the queue many times over
+	Start(thread, recording, std::chrono::microseconds(500));
+
+	const uint32_t eventCount = RenderThread::EventQueueCapacity * 8;
+	for (uint32_t key = 0; key < eventCount; key++)
+		thread.Post({ WindowEvent::KeyDown, key });
+	WaitForFrames(thread, 2);
+	thread.Stop();
+
+	REQUIRE(recording.keys.size() == eventCount);
+	uint32_t outOfOrder = 0;
+	for (uint32_t key = 0; key < eventCount; key++)
+		outOfOrder += recording.keys[key] != key ? 1 : 0;
+	CHECK(outOfOrder == 0);
+}
+
+TEST_CASE(StopLetsTheFrameInProgressFinish)
+{
+	RenderThread thread;
+	Recording recording;
+	Start(thread, recording, std::chrono::milliseconds(20));
+
+	while (!recording.frameRunning.load())
+		std::this_thread::yield();
+	thread.Stop();
+	CHECK(!recording.frameRunning.load());
+	CHECK(recording.frames == thread.GetFrameCount());
+	CHECK(recording.frames >= 1);
+}
+
+TEST_CASE(RestartsWithAnEmptyQueue)
+{
+	RenderThread thread;
+	Recording first;
+	Start(thread, first, std::chrono::milliseconds(20));
+	while (!first.frameRunning.load())
+		std::this_thread::yield();
+	// Queued behind a frame that outlasts the Stop below, discarded with the thread
+	for (uint32_t key = 0; key < 10; key++)
+		thread.Post({ WindowEvent::KeyDown, key });
+	thread.Stop();
+	const size_t delivered = first.keys.size();
+	CHECK(delivered <= 10);
+
+	Recording second;
+	Start(thread, second);
+	thread.Post({ WindowEvent::KeyUp, 42 });
+	WaitForFrames(thread, 2);
+	thread.Stop();
+
+	REQUIRE(second.keys.size() == 1);
+	CHECK(second.keys[0] == 42);
+	CHECK(second.types[0] == WindowEvent::KeyUp);
+	CHECK(first.keys.size() == delivered);
+}
+
+TEST_CASE(StressWindowThreadPostingWhileFramesRun)
+{
+	RenderThread thread;
+	Recording recording;
+	Start(thread, recording);
+
+	const uint32_t eventCount = 200000;
+	std::thread window([&thread]()
+	{
+		for (uint32_t key = 0; key < eventCount; key++)
+			thread.Post({ key % 3 == 0 ? WindowEvent::KeyUp : WindowEvent::KeyDown, key });
+	});
+	window.join();
+	WaitForFrames(thread, 2);
+	thread.Stop();
+
+	REQUIRE(recording.keys.size() == eventCount);
+	uint32_t mismatches = 0;
+	for (uint32_t key = 0; key < eventCount; key++)
+	{
+		const WindowEvent::Type type = key % 3 == 0 ? WindowEvent::KeyUp : WindowEvent::KeyDown;
+		mismatches += recording.keys[key] != key || recording.types[key] != type ? 1 : 0;
+	}
+	CHECK(mismatches == 0);
+}
@@ -0,0 +1,49 @@
+#include "Benchmark.h"
+#include "RingAllocator.h"
+
+#include <random>
+#include <vector>
+
+// Sub-allocations per second for the upload ring's pattern: constant buffers and texture rows every frame,
+// batches tagged with the frame's fence value and retired two frames later.
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const uint32_t frameCount = quick ? 100 : 10000;
+	const uint32_t allocationsPerFrame = 1000;
+
+	// Sizes and alignments drawn up front so the loop only measures the allocator
+	std::mt19937 rng(42);
+	std::vector<uint64_t> sizes(allocationsPerFrame);
+	std::vector<uint64_t> alignments(allocationsPerFrame);
+	for (uint32_t n = 0; n < allocationsPerFrame; n++)
+	{
+		const bool texture = rng() % 8 == 0;
+		sizes[n] = texture ? 4096 + rng() % 16384 : 64 + rng() % 1024;
+		alignments[n] = texture ? 512 : 256;
+	}
+
+	RingAllocator ring(64 * 1024 * 1024);
+	uint64_t failures = 0;
+	const double time = Benchmark::Measure(3, [&]()
+	{
+		ring.Reset(ring.GetCapacity());
+		for (uint64_t frame = 1; frame <= frameCount; frame++)
+		{
+			for (uint32_t n = 0; n < allocationsPerFrame; n++)
+			{
+				const uint64_t offset = ring.Allocate(sizes[n], alignments[n]);
+				failures += offset == RingAllocator::InvalidOffset ? 1 : 0;
+				Benchmark::DoNotOptimize(offset);
+			}
+			ring.FinishBatch(frame);
+			if (frame > 2)
+				ring.Retire(frame - 2);
+		}
+	});
+
+	const double allocations = double(frameCount) * allocationsPerFrame;
+	printf("RingAllocator: %.1f M allocs/s, %.1f ns per alloc, %llu failed\n", allocations / time / 1e6, time / allocations * 1e9,
+		static_cast<unsigned long long>(failures));
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#include "TestFramework.h"
+#include "RingAllocator.h"
+
+#include <deque>
+#include <random>
+
+namespace
+{
+	// D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT and D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+	const uint64_t ConstantBufferAlignment = 256;
+	const uint64_t TextureAlignment = 512;
+
+	struct LiveAllocation
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint64_t fenceValue;
+	};
+
+	bool Overlaps(const LiveAllocation& a, const LiveAllocation& b)
+	{
+		return a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+	}
+}
+
+TEST_CASE(AlignedSubAllocation)
+{
+	RingAllocator ring(64 * 1024);
+	CHECK(ring.Allocate(100, ConstantBufferAlignment) == 0);
+	CHECK(ring.Allocate(100, ConstantBufferAlignment) == 256);
+	CHECK(ring.Allocate(1, TextureAlignment) == 512);
+	CHECK(ring.Allocate(10, 1) == 513);
+	// Padding counts as used until the batch retires
+	CHECK(ring.GetUsedSize() == 523);
+}
+
+TEST_CASE(RejectsWhatCannotFit)
+{
+	RingAllocator ring(1024);
+	CHECK(ring.Allocate(0, 1) == RingAllocator::InvalidOffset);
+	CHECK(ring.Allocate(1025, 1) == RingAllocator::InvalidOffset);
+	CHECK(ring.Allocate(1024, 1) == 0);
+	CHECK(ring.Allocate(1, 1) == RingAllocator::InvalidOffset);
+}
+
+TEST_CASE(BatchesRetireOldestFirst)
+{
+	RingAllocator ring(1024);
+	CHECK(ring.Allocate(100, ConstantBufferAlignment) == 0);
+	CHECK(ring.Allocate(100, ConstantBufferAlignment) == 256);
+	ring.FinishBatch(1);
+	CHECK(ring.Allocate(500, TextureAlignment) == 512);
+	ring.FinishBatch(2);
+	CHECK(ring.GetUsedSize() == 1012);
+
+	// Full until batch 1 retires, then the next allocation wraps to the start
+	CHECK(ring.Allocate(64, ConstantBufferAlignment) == RingAllocator::InvalidOffset);
+	ring.Retire(0);
+	CHECK(ring.GetUsedSize() == 1012);
+	ring.Retire(1);
+	CHECK(ring.GetUsedSize() == 656);
+	CHECK(ring.Allocate(64, ConstantBufferAlignment) == 0);
+
+	// Batch 2 still owns [512, 1012), the tail of batch 1 ends at 356
+	CHECK(ring.Allocate(300, 1) == RingAllocator::InvalidOffset);
+	CHECK(ring.Allocate(292, 1) == 64);
+	ring.FinishBatch(3);
+
+	ring.Retire(3);
+	CHECK(ring.GetUsedSize() == 0);
+}
+
+TEST_CASE(EmptyRingRestartsAtZero)
+{
+	RingAllocator ring(1024);
+	ring.Allocate(700, 1);
+	ring.FinishBatch(1);
+	ring.Retire(1);
+
+	// A 700 byte block only fits again because the ring rewinds once it is empty
+	CHECK(ring.Allocate(700, 1) == 0);
+}
+
+TEST_CASE(EmptyBatchesAreSkipped)
+{
+	RingAllocator ring(1024);
+	ring.FinishBatch(1);
+	ring.FinishBatch(2);
+	CHECK(ring.Allocate(512, 1) == 0);
+	ring.FinishBatch(3);
+	ring.Retire(2);
+	CHECK(ring.GetUsedSize() == 512);
+	ring.Retire(3);
+	CHECK(ring.GetUsedSize() == 0);
+}
+
+TEST_CASE(ResetDropsEverything)
+{
+	RingAllocator ring(1024);
+	ring.Allocate(512, 1);
+	ring.FinishBatch(1);
+	ring.Reset(4096);
+	CHECK(ring.GetCapacity() == 4096);
+	CHECK(ring.GetUsedSize() == 0);
+	CHECK(ring.Allocate(4096, 1) == 0);
+}
+
+// Frames allocating, retiring with GPU lag, every live block checked against every other
+TEST_CASE(RandomFramesNeverOverlap)
+{
+	std::mt19937 rng(1234);
+	const uint64_t capacity = 256 * 1024;
+	RingAllocator ring(capacity);
+	std::deque<LiveAllocation> live;
+	uint32_t overlaps = 0;
+	uint32_t misaligned = 0;
+	uint32_t outOfBounds = 0;
+	uint32_t failures = 0;
+
+	for (uint64_t frame = 1; frame <= 2000; frame++)
+	{
+		const uint32_t allocationCount = rng() % 24;
+		for (uint32_t n = 0; n < allocationCount; n++)
+		{
+			const uint64_t alignment = rng() % 2 ? ConstantBufferAlignment : TextureAlignment;
+			const uint64_t size = 1 + rng() % 8192;
+			const uint64_t offset = ring.Allocate(size, alignment);
+			if (offset == RingAllocator::InvalidOffset)
+			{
+				failures++;
+				continue;
+			}
+
+			const LiveAllocation allocation = { offset, size, frame };
+			misaligned += offset % alignment ? 1 : 0;
+			outOfBounds += offset + size > capacity ? 1 : 0;
+			for (const LiveAllocation& other : live)
+				overlaps += Overlaps(allocation, other) ? 1 : 0;
+			live.push_back(allocation);
+		}
+		ring.FinishBatch(frame);
+
+		// The GPU runs two frames behind
+		if (frame > 2)
+		{
+			ring.Retire(frame - 2);
+			while (!live.empty() && live.front().fenceValue <= frame - 2)
+				live.pop_front();
+		}
+	}
+
+	CHECK(overlaps == 0);
+	CHECK(misaligned == 0);
+	CHECK(outOfBounds == 0);
+	// Three frames of up to 200KB each don't always fit in 256KB, but nearly every allocation does
+	CHECK(failures < 200);
+
+	ring.Retire(~0ull);
+	CHECK(ring.GetUsedSize() == 0);
+}
@@ -0,0 +1,154 @@
+#include "Benchmark.h"
+#include "LinearArena.h"
+#include "RootSignatureStoreFile.h"
+
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+// The two halves of RootSignatureRegistry that run without a device: the 1.1 to 1.0 conversion scratch,
+// which lives in a LinearArena instead of the d3dx12 helper's heap allocations, and validating the
+// serialized store at startup. Heap traffic is counted by replacing the global operator new.
+
+namespace
+{
+	uint64_t gHeapAllocationCount = 0;
+
+	// Same sizes as D3D12_ROOT_PARAMETER and D3D12_DESCRIPTOR_RANGE on 64-bit
+	struct Parameter
+	{
+		uint32_t type;
+		uint32_t rangeCount;
+		const void* pRanges;
+		uint32_t shaderVisibility;
+		uint32_t padding[3];
+	};
+
+	struct Range
+	{
+		uint32_t values[5];
+	};
+
+	// Parameter and range counts of a typical mix of root signatures
+	struct Shape
+	{
+		uint32_t parameterCount;
+		uint32_t rangeCounts[8];
+	};
+
+	std::vector<Shape> MakeShapes(uint32_t count)
+	{
+		std::mt19937 rng(42);
+		std::vector<Shape> shapes(count);
+		for (Shape& shape : shapes)
+		{
+			shape.parameterCount = 1 + rng() % 8;
+			for (uint32_t& rangeCount : shape.rangeCounts)
+				rangeCount = rng() % 3 == 0 ? 1 + rng() % 4 : 0;
+		}
+		return shapes;
+	}
+
+	template <typename AllocateParameters, typename AllocateRanges>
+	uint64_t Convert(const Shape& shape, AllocateParameters&& allocateParameters, AllocateRanges&& allocateRanges)
+	{
+		Parameter* pParameters = allocateParameters(shape.parameterCount);
+		uint64_t checksum = 0;
+		for (uint32_t i = 0; i < shape.parameterCount; i++)
+		{
+			const uint32_t rangeCount = shape.rangeCounts[i];
+			Range* pRanges = rangeCount > 0 ? allocateRanges(rangeCount) : nullptr;
+			for (uint32_t r = 0; r < rangeCount; r++)
+				pRanges[r] = { { r, 1, i, 0, 0 } };
+			pParameters[i] = { rangeCount > 0 ? 0u : 2u, rangeCount, pRanges, 0, { 0, 0, 0 } };
+			checksum += reinterpret_cast<uintptr_t>(pRanges) & 0xff;
+		}
+		return checksum;
+	}
+}
+
+void* operator new(size_t size)
+{
+	gHeapAllocationCount++;
+	if (void* pData = malloc(size > 0 ? size : 1))
+		return pData;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pData) noexcept
+{
+	free(pData);
+}
+
+void operator delete(void* pData, size_t) noexcept
+{
+	free(pData);
+}
+
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const uint32_t conversionCount = quick ? 10000 : 1000000;
+	const std::vector<Shape> shapes = MakeShapes(256);
+
+	// Conversion scratch, one root signature at a time as Serialize does
+	uint64_t checksum = 0;
+	const double heapTime = Benchmark::Measure(3, [&]()
+	{
+		std::vector<std::unique_ptr<Range[]>> ranges;
+		for (uint32_t n = 0; n < conversionCount; n++)
+		{
+			std::unique_ptr<Parameter[]> parameters;
+			ranges.clear();
+			checksum += Convert(shapes[n % shapes.size()],
+				[&](uint32_t count) { parameters.reset(new Parameter[count]); return parameters.get(); },
+				[&](uint32_t count) { ranges.emplace_back(new Range[count]); return ranges.back().get(); });
+		}
+	});
+
+	LinearArena arena;
+	const uint64_t allocationsBefore = gHeapAllocationCount;
+	const double arenaTime = Benchmark::Measure(3, [&]()
+	{
+		for (uint32_t n = 0; n < conversionCount; n++)
+		{
+			checksum += Convert(shapes[n % shapes.size()],
+				[&](uint32_t count) { return arena.Allocate<Parameter>(count); },
+				[&](uint32_t count) { return arena.Allocate<Range>(count); });
+			arena.Reset();
+		}
+	});
+	// Only the first block and the list holding it, on the first conversion
+	const uint64_t arenaAllocations = gHeapAllocationCount - allocationsBefore;
+	Benchmark::DoNotOptimize(checksum);
+
+	printf("Conversion scratch, heap: %.1f ns per root signature\n", heapTime / conversionCount * 1e9);
+	printf("Conversion scratch, arena: %.1f ns per root signature, %llu heap allocations for %u conversions\n",
+		arenaTime / conversionCount * 1e9, static_cast<unsigned long long>(arenaAllocations), 3 * conversionCount);
+
+	// Startup: validate a store of serialized root signatures, a few hundred bytes each
+	const uint32_t rootSignatureCount = quick ? 64 : 1024;
+	std::mt19937 rng(7);
+	std::vector<std::vector<uint8_t>> blobs(rootSignatureCount);
+	std::vector<RootSignatureStoreFile::Entry> entries;
+	for (uint32_t n = 0; n < rootSignatureCount; n++)
+	{
+		blobs[n].resize(100 + rng() % 800);
+		for (uint8_t& value : blobs[n])
+			value = static_cast<uint8_t>(rng());
+		entries.push_back({ rng() * 0x9E3779B97F4A7C15ull, blobs[n].data(), blobs[n].size() });
+	}
+	const std::vector<uint8_t> data = RootSignatureStoreFile::Write(entries);
+
+	bool valid = true;
+	std::vector<RootSignatureStoreFile::Entry> readEntries;
+	const double readTime = Benchmark::Measure(5, [&]()
+	{
+		valid &= RootSignatureStoreFile::Read(data, readEntries) && readEntries.size() == rootSignatureCount;
+	});
+
+	printf("Store read: %u root signatures, %.1f KB, %.1f us, %.1f ns per root signature\n", rootSignatureCount,
+		data.size() / 1024.0, readTime * 1e6, readTime / rootSignatureCount * 1e9);
+	return valid && arenaAllocations <= 2 ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+#include "TestFramework.h"
+#include "RootSignatureStoreFile.h"
+
+#include <cstring>
+#include <random>
+
+namespace
+{
+	std::vector<uint8_t> MakeBlob(size_t size, uint8_t seed)
+	{
+		std::vector<uint8_t> blob(size);
+		for (size_t n = 0; n < size; n++)
+			blob[n] = static_cast<uint8_t>(n * 7 + seed);
+		return blob;
+	}
+
+	struct Fixture
+	{
+		std::vector<std::vector<uint8_t>> blobs;
+		std::vector<RootSignatureStoreFile::Entry> entries;
+		std::vector<uint8_t> data;
+
+		Fixture()
+		{
+			blobs = { MakeBlob(3, 1), MakeBlob(100, 2), {}, MakeBlob(532, 3) };
+			const uint64_t keys[] = { 11, 22, 33, 44 };
+			for (size_t n = 0; n < blobs.size(); n++)
+				entries.push_back({ keys[n], blobs[n].data(), blobs[n].size() });
+			data = RootSignatureStoreFile::Write(entries);
+		}
+
+		bool Matches(const RootSignatureStoreFile::Entry& read, size_t n) const
+		{
+			return read.key == entries[n].key && read.blobSize == entries[n].blobSize &&
+				(read.blobSize == 0 || memcmp(read.pBlob, entries[n].pBlob, static_cast<size_t>(read.blobSize)) == 0);
+		}
+	};
+}
+
+TEST_CASE(RoundTripsEveryEntry)
+{
+	Fixture fixture;
+	std::vector<RootSignatureStoreFile::Entry> entries;
+	REQUIRE(RootSignatureStoreFile::Read(fixture.data, entries));
+	REQUIRE(entries.size() == fixture.entries.size());
+	for (size_t n = 0; n < entries.size(); n++)
+	{
+		CHECK(fixture.Matches(entries[n], n));
+		// Blobs point into the file data, no copy
+		CHECK(entries[n].pBlob >= fixture.data.data() && entries[n].pBlob + entries[n].blobSize <= fixture.data.data() + fixture.data.size());
+	}
+}
+
+TEST_CASE(EmptyStoreIsValid)
+{
+	const std::vector<uint8_t> data = RootSignatureStoreFile::Write({});
+	std::vector<RootSignatureStoreFile::Entry> entries = { { 1, nullptr, 0 } };
+	CHECK(RootSignatureStoreFile::Read(data, entries));
+	CHECK(entries.empty());
+}
+
+TEST_CASE(DamagedBlobOnlyLosesItsEntry)
+{
+	Fixture fixture;
+	std::vector<uint8_t> corrupt = fixture.data;
+	// Inside the 100 byte blob, which follows the 3 byte one
+	const size_t blobOffset = corrupt.size() - 532 - 100;
+	corrupt[blobOffset + 50] ^= 0x10;
+
+	std::vector<RootSignatureStoreFile::Entry> entries;
+	REQUIRE(RootSignatureStoreFile::Read(corrupt, entries));
+	REQUIRE(entries.size() == 3);
+	CHECK(fixture.Matches(entries[0], 0));
+	CHECK(fixture.Matches(entries[1], 2));
+	CHECK(fixture.Matches(entries[2], 3));
+
+	// Cut into the last blob, the others survive
+	const std::vector<uint8_t> truncated(fixture.data.begin(), fixture.data.end() - 1);
+	REQUIRE(RootSignatureStoreFile::Read(truncated, entries));
+	CHECK(entries.size() == 3);
+}
+
+TEST_CASE(ForeignFilesAreRejected)
+{
+	Fixture fixture;
+	std::vector<RootSignatureStoreFile::Entry> entries;
+
+	CHECK(!RootSignatureStoreFile::Read({}, entries));
+	CHECK(!RootSignatureStoreFile::Read(std::vector<uint8_t>(fixture.data.begin(), fixture.data.begin() + 8), entries));
+
+	std::vector<uint8_t> magic = fixture.data;
+	magic[0] ^= 0xff;
+	CHECK(!RootSignatureStoreFile::Read(magic, entries));
+	std::vector<uint8_t> version = fixture.data;
+	version[4]++;
+	CHECK(!RootSignatureStoreFile::Read(version, entries));
+
+	// The entry table itself cut short
+	const std::vector<uint8_t> table(fixture.data.begin(), fixture.data.begin() + 40);
+	CHECK(!RootSignatureStoreFile::Read(table, entries));
+	CHECK(entries.empty());
+}
+
+TEST_CASE(GarbageNeverReadsOutOfBounds)
+{
+	Fixture fixture;
+	std::vector<RootSignatureStoreFile::Entry> entries;
+
+	for (size_t size = 0; size < fixture.data.size(); size++)
+	{
+		const std::vector<uint8_t> truncated(fixture.data.begin(), fixture.data.begin() + size);
+		RootSignatureStoreFile::Read(truncated, entries);
+	}
+
+	// Valid header, random table and blobs
+	std::mt19937 rng(7);
+	std::vector<uint8_t> junk(1000);
+	for (uint32_t n = 0; n < 2000; n++)
+	{
+		for (uint8_t& value : junk)
+			value = static_cast<uint8_t>(rng());
+		const uint32_t header[4] = { RootSignatureStoreFile::Magic, RootSignatureStoreFile::Version, static_cast<uint32_t>(rng() % 50), 0 };
+		memcpy(junk.data(), header, sizeof(header));
+
+		if (RootSignatureStoreFile::Read(junk, entries))
+		{
+			for (const RootSignatureStoreFile::Entry& entry : entries)
+				CHECK(entry.pBlob >= junk.data() && entry.pBlob + entry.blobSize <= junk.data() + junk.size());
+		}
+	}
+}
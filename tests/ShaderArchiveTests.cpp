@@ -0,0 +1,176 @@
+#include "TestFramework.h"
+#include "ShaderArchive.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+	// Written by data/make_shader_archive.py through tools/compile_shaders.py, entries sorted by name
+	struct ExpectedShader
+	{
+		const char* name;
+		uint64_t hash;
+		uint64_t size;
+		uint32_t pattern;
+	};
+
+	const ExpectedShader Shaders[] =
+	{
+		{ "Empty.hlsl:Main", 0x8000000000000001ull, 0, 3 },
+		{ "Post/Tonemap.hlsl:CSMain", 0xfedcba9876543210ull, 256, 2 },
+		{ "shader.hlsl:PSMain", 0x0123456789abcdefull, 17, 1 },
+		{ "shader.hlsl:VSMain", 0xa1b2c3d4e5f60718ull, 1000, 0 },
+	};
+
+	const size_t HeaderSize = 16;
+	const size_t EntrySize = 32;
+
+	std::vector<uint8_t> LoadArchive()
+	{
+		std::ifstream file(DXRT_TEST_DATA_DIR "/ShaderArchive.dxsl", std::ios::binary);
+		return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	template <typename T>
+	void Patch(std::vector<uint8_t>& data, size_t offset, T value)
+	{
+		memcpy(data.data() + offset, &value, sizeof(value));
+	}
+
+	// Parses a copy with one field of one entry replaced
+	template <typename T>
+	bool ParsePatched(const std::vector<uint8_t>& archive, uint32_t entry, size_t fieldOffset, T value)
+	{
+		std::vector<uint8_t> data = archive;
+		Patch(data, HeaderSize + entry * EntrySize + fieldOffset, value);
+		ShaderArchive parsed;
+		const bool result = parsed.Parse(data.data(), data.size());
+		CHECK(result || parsed.GetShaderCount() == 0);
+		return result;
+	}
+}
+
+TEST_CASE(ReadsTheArchiveTheScriptWrites)
+{
+	const std::vector<uint8_t> data = LoadArchive();
+	REQUIRE(data.size() == 1512);
+
+	ShaderArchive archive;
+	REQUIRE(archive.Parse(data.data(), data.size()));
+	CHECK(archive.GetShaderCount() == 4);
+	for (uint32_t n = 0; n < 4; n++)
+	{
+		const ExpectedShader& expected = Shaders[n];
+		const ShaderArchive::Shader* pShader = archive.Find(expected.name);
+		REQUIRE(pShader);
+		CHECK(pShader->hash == expected.hash);
+		CHECK(pShader->size == expected.size);
+
+		// Blobs point into the archive, 16 byte aligned from its start
+		const uint8_t* pBlob = static_cast<const uint8_t*>(pShader->pData);
+		CHECK(pBlob >= data.data() && pBlob + pShader->size <= data.data() + data.size());
+		CHECK((pBlob - data.data()) % 16 == 0);
+		uint32_t mismatches = 0;
+		for (uint32_t j = 0; j < pShader->size; j++)
+			mismatches += pBlob[j] != static_cast<uint8_t>(expected.pattern * 37 + j) ? 1 : 0;
+		CHECK(mismatches == 0);
+	}
+
+	CHECK(archive.Find("shader.hlsl:GSMain") == nullptr);
+	CHECK(archive.Find("shader.hlsl") == nullptr);
+}
+
+TEST_CASE(TruncatedArchivesAreRejected)
+{
+	const std::vector<uint8_t> data = LoadArchive();
+	REQUIRE(!data.empty());
+
+	// The last blob ends the file, so every shorter prefix cuts into the header, the table, a name or a blob
+	ShaderArchive archive;
+	uint32_t accepted = 0;
+	for (size_t size = 0; size < data.size(); size++)
+	{
+		std::vector<uint8_t> truncated(data.begin(), data.begin() + size);
+		accepted += archive.Parse(truncated.data(), truncated.size()) ? 1 : 0;
+		CHECK(archive.GetShaderCount() == 0);
+	}
+	CHECK(accepted == 0);
+	CHECK(!archive.Parse(nullptr, 0));
+}
+
+TEST_CASE(WrongMagicOrVersionIsRejected)
+{
+	const std::vector<uint8_t> data = LoadArchive();
+	REQUIRE(data.size() >= HeaderSize);
+
+	std::vector<uint8_t> patched = data;
+	Patch(patched, 0, uint32_t(0x4C535845));
+	ShaderArchive archive;
+	CHECK(!archive.Parse(patched.data(), patched.size()));
+
+	patched = data;
+	Patch(patched, 4, ShaderArchive::Version + 1);
+	CHECK(!archive.Parse(patched.data(), patched.size()));
+}
+
+TEST_CASE(OutOfRangeOffsetsAreRejected)
+{
+	const std::vector<uint8_t> data = LoadArchive();
+	REQUIRE(data.size() == 1512);
+	const uint32_t size = static_cast<uint32_t>(data.size());
+
+	// Entry fields: nameOffset, nameLength, dataOffset, dataSize
+	for (uint32_t entry = 0; entry < 4; entry++)
+	{
+		CHECK(!ParsePatched(data, entry, 0, size + 1));
+		CHECK(!ParsePatched(data, entry, 0, ~0u));
+		CHECK(!ParsePatched(data, entry, 4, size));
+		CHECK(!ParsePatched(data, entry, 4, ~0u));
+		CHECK(!ParsePatched(data, entry, 8, uint64_t(size) + 1));
+		CHECK(!ParsePatched(data, entry, 8, ~0ull));
+		CHECK(!ParsePatched(data, entry, 16, uint64_t(size)));
+		CHECK(!ParsePatched(data, entry, 16, ~0ull));
+		// Offset plus size wraps around to a small value
+		CHECK(!ParsePatched(data, entry, 16, ~0ull - 0x100));
+	}
+
+	// Ranges that end exactly at the end of the archive are fine
+	CHECK(ParsePatched(data, 0, 0, size - uint32_t(strlen(Shaders[0].name))));
+	CHECK(ParsePatched(data, 0, 8, uint64_t(size)));
+
+	// A failed parse drops what an earlier one found
+	ShaderArchive archive;
+	REQUIRE(archive.Parse(data.data(), data.size()));
+	std::vector<uint8_t> patched = data;
+	Patch(patched, HeaderSize + 3 * EntrySize + 16, ~0ull);
+	CHECK(!archive.Parse(patched.data(), patched.size()));
+	CHECK(archive.GetShaderCount() == 0);
+	CHECK(archive.Find("shader.hlsl:PSMain") == nullptr);
+}
+
+TEST_CASE(OverflowingEntryCountsAreRejected)
+{
+	const std::vector<uint8_t> data = LoadArchive();
+	REQUIRE(data.size() >= HeaderSize);
+
+	// Counts whose table size wraps 32 bit arithmetic, and ones that just don't fit
+	const uint32_t counts[] = { ~0u, 0x80000000u, 0x08000001u, static_cast<uint32_t>((data.size() - HeaderSize) / EntrySize) + 1 };
+	for (uint32_t count : counts)
+	{
+		std::vector<uint8_t> patched = data;
+		Patch(patched, 8, count);
+		ShaderArchive archive;
+		CHECK(!archive.Parse(patched.data(), patched.size()));
+		CHECK(archive.GetShaderCount() == 0);
+	}
+
+	// An empty archive is just a header
+	std::vector<uint8_t> empty(data.begin(), data.begin() + HeaderSize);
+	Patch(empty, 8, 0u);
+	ShaderArchive archive;
+	CHECK(archive.Parse(empty.data(), empty.size()));
+	CHECK(archive.GetShaderCount() == 0);
+}
@@ -0,0 +1,169 @@
+#include "TestFramework.h"
+#include "ShaderDependencyTracker.h"
+
+#include <fstream>
+#include <map>
+
+namespace
+{
+	// Shader sources kept in memory, under a root that does not exist on disk
+	struct Fixture
+	{
+		std::map<std::filesystem::path, std::string> files;
+		ShaderDependencyTracker tracker;
+
+		explicit Fixture(std::vector<std::filesystem::path> includeDirs = {})
+			: tracker(std::move(includeDirs), [this](const std::filesystem::path& path, std::string& contents)
+			{
+				auto file = files.find(path);
+				if (file == files.end())
+					return false;
+				contents = file->second;
+				return true;
+			})
+		{
+		}
+
+		static std::filesystem::path GetPath(const char* pName)
+		{
+			return (std::filesystem::path("/dxrt-test-shaders") / pName).lexically_normal();
+		}
+
+		void Write(const char* pName, const char* pContents)
+		{
+			files[GetPath(pName)] = pContents;
+		}
+
+		std::vector<std::string> Change(const char* pName)
+		{
+			return tracker.OnFileChanged(GetPath(pName));
+		}
+	};
+
+	typedef std::vector<std::string> Names;
+}
+
+TEST_CASE(DirectAndTransitiveIncludes)
+{
+	Fixture fixture;
+	fixture.Write("a.hlsl", "#include \"common.hlsli\"\nfloat4 main() : SV_Target { return 0; }\n");
+	fixture.Write("b.hlsl", "#include \"inc/light.hlsli\"\n");
+	fixture.Write("c.hlsl", "");
+	fixture.Write("common.hlsli", "// shared\n");
+	fixture.Write("inc/light.hlsli", "#include \"../common.hlsli\"\n");
+	fixture.tracker.AddShader("a:VS", Fixture::GetPath("a.hlsl"));
+	fixture.tracker.AddShader("a:PS", Fixture::GetPath("a.hlsl"));
+	fixture.tracker.AddShader("b:CS", Fixture::GetPath("b.hlsl"));
+	fixture.tracker.AddShader("c:PS", Fixture::GetPath("c.hlsl"));
+
+	CHECK(fixture.Change("common.hlsli") == Names({ "a:PS", "a:VS", "b:CS" }));
+	CHECK(fixture.Change("inc/light.hlsli") == Names({ "b:CS" }));
+	CHECK(fixture.Change("c.hlsl") == Names({ "c:PS" }));
+	CHECK(fixture.Change("unrelated.hlsli").empty());
+}
+
+TEST_CASE(DirectiveSpellings)
+{
+	Fixture fixture;
+	fixture.Write("a.hlsl",
+		"  #  include <one.hlsli>\n"
+		"\t#include\t\"two.hlsli\"\n"
+		"// #include \"three.hlsli\" is not a directive\n"
+		"#define include \"four.hlsli\"\n"
+		"#include \"unterminated.hlsli\n");
+	fixture.Write("one.hlsli", "");
+	fixture.Write("two.hlsli", "");
+	fixture.Write("three.hlsli", "");
+	fixture.Write("four.hlsli", "");
+	fixture.Write("unterminated.hlsli", "");
+	fixture.tracker.AddShader("a", Fixture::GetPath("a.hlsl"));
+
+	const std::set<std::filesystem::path> expected = {
+		Fixture::GetPath("a.hlsl"), Fixture::GetPath("one.hlsli"), Fixture::GetPath("two.hlsli") };
+	CHECK(fixture.tracker.GetDependencies("a") == expected);
+}
+
+TEST_CASE(IncludeDirsAfterTheIncludingFile)
+{
+	Fixture fixture({ "/dxrt-test-shaders/shared", "/dxrt-test-shaders/engine" });
+	fixture.Write("src/a.hlsl", "#include <common.hlsli>\n#include <math.hlsli>\n");
+	fixture.Write("src/common.hlsli", "");
+	fixture.Write("shared/common.hlsli", "");
+	fixture.Write("shared/math.hlsli", "");
+	fixture.Write("engine/math.hlsli", "");
+	fixture.tracker.AddShader("a", Fixture::GetPath("src/a.hlsl"));
+
+	// The including file's directory wins, then include dirs in order
+	CHECK(fixture.Change("src/common.hlsli") == Names({ "a" }));
+	CHECK(fixture.Change("shared/common.hlsli").empty());
+	CHECK(fixture.Change("shared/math.hlsli") == Names({ "a" }));
+	CHECK(fixture.Change("engine/math.hlsli").empty());
+}
+
+TEST_CASE(EditedIncludesAreRescanned)
+{
+	Fixture fixture;
+	fixture.Write("a.hlsl", "");
+	fixture.Write("light.hlsli", "#include \"common.hlsli\"\n");
+	fixture.Write("common.hlsli", "");
+	fixture.tracker.AddShader("a", Fixture::GetPath("a.hlsl"));
+	CHECK(fixture.Change("common.hlsli").empty());
+
+	// Files pulled in for the first time by the edit are scanned too
+	fixture.Write("a.hlsl", "#include \"light.hlsli\"\n");
+	CHECK(fixture.Change("a.hlsl") == Names({ "a" }));
+	CHECK(fixture.Change("common.hlsli") == Names({ "a" }));
+
+	// And includes that were removed are dropped
+	fixture.Write("light.hlsli", "");
+	CHECK(fixture.Change("light.hlsli") == Names({ "a" }));
+	CHECK(fixture.Change("common.hlsli").empty());
+}
+
+TEST_CASE(IncludeCyclesTerminate)
+{
+	Fixture fixture;
+	fixture.Write("a.hlsl", "#include \"x.hlsli\"\n");
+	fixture.Write("x.hlsli", "#include \"y.hlsli\"\n");
+	fixture.Write("y.hlsli", "#include \"x.hlsli\"\n#include \"a.hlsl\"\n");
+	fixture.tracker.AddShader("a", Fixture::GetPath("a.hlsl"));
+
+	CHECK(fixture.tracker.GetDependencies("a").size() == 3);
+	CHECK(fixture.Change("y.hlsli") == Names({ "a" }));
+	CHECK(fixture.Change("a.hlsl") == Names({ "a" }));
+}
+
+TEST_CASE(UnresolvedIncludesAreSkipped)
+{
+	Fixture fixture;
+	fixture.Write("a.hlsl", "#include \"missing.hlsli\"\n#include \"common.hlsli\"\n");
+	fixture.Write("common.hlsli", "");
+	fixture.tracker.AddShader("a", Fixture::GetPath("a.hlsl"));
+
+	const std::set<std::filesystem::path> expected = { Fixture::GetPath("a.hlsl"), Fixture::GetPath("common.hlsli") };
+	CHECK(fixture.tracker.GetDependencies("a") == expected);
+	CHECK(fixture.tracker.GetDependencies("unknown").empty());
+
+	// Once the file shows up, the next change of the includer picks it up
+	fixture.Write("missing.hlsli", "");
+	CHECK(fixture.Change("a.hlsl") == Names({ "a" }));
+	CHECK(fixture.Change("missing.hlsli") == Names({ "a" }));
+}
+
+TEST_CASE(ReadsFromDiskByDefault)
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "dxrt-shader-dependency-test";
+	std::filesystem::remove_all(directory);
+	REQUIRE(std::filesystem::create_directories(directory / "inc"));
+	std::ofstream(directory / "a.hlsl") << "#include <light.hlsli>\n";
+	std::ofstream(directory / "inc" / "light.hlsli") << "";
+
+	{
+		ShaderDependencyTracker tracker({ directory / "inc" });
+		tracker.AddShader("a", directory / "a.hlsl");
+		// Relative and unnormalized spellings name the same file
+		CHECK(tracker.OnFileChanged(directory / "inc" / ".." / "inc" / "light.hlsli") == Names({ "a" }));
+	}
+
+	std::filesystem::remove_all(directory);
+}
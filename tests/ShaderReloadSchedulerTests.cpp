@@ -0,0 +1,113 @@
+#include "TestFramework.h"
+#include "ShaderReloadScheduler.h"
+
+#include <stdexcept>
+
+namespace
+{
+	const std::chrono::milliseconds Debounce(30);
+
+	// Everything the compile function saw, read after WaitIdle
+	struct CompileLog
+	{
+		std::mutex mutex;
+		std::vector<std::vector<std::string>> compiles;
+		std::vector<std::chrono::steady_clock::time_point> times;
+
+		ShaderReloadScheduler::CompileFunc GetFunc()
+		{
+			return [this](const std::vector<std::string>& shaders)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				compiles.push_back(shaders);
+				times.push_back(std::chrono::steady_clock::now());
+				if (shaders.size() == 1 && shaders[0] == "broken")
+					throw std::runtime_error("compile error");
+			};
+		}
+	};
+
+	typedef std::vector<std::string> Names;
+}
+
+TEST_CASE(RequestsCloseTogetherAreMergedAndSorted)
+{
+	CompileLog log;
+	ShaderReloadScheduler scheduler(log.GetFunc(), Debounce);
+
+	const auto start = std::chrono::steady_clock::now();
+	scheduler.Request({ "b:PS" });
+	scheduler.Request({ "c:CS", "b:PS" });
+	scheduler.Request({ "a:VS" });
+	scheduler.WaitIdle();
+
+	REQUIRE(log.compiles.size() == 1);
+	CHECK(log.compiles[0] == Names({ "a:VS", "b:PS", "c:CS" }));
+	CHECK(log.times[0] - start >= Debounce);
+	CHECK(scheduler.GetCompileCount() == 1);
+}
+
+TEST_CASE(EachRequestPushesTheDeadlineBack)
+{
+	CompileLog log;
+	ShaderReloadScheduler scheduler(log.GetFunc(), Debounce);
+
+	// Keeps writing for longer than the debounce delay, but never pauses for that long
+	const auto start = std::chrono::steady_clock::now();
+	auto lastRequest = start;
+	for (int i = 0; i < 6; i++)
+	{
+		if (i > 0)
+			std::this_thread::sleep_for(Debounce / 3);
+		scheduler.Request({ "a:PS" });
+		lastRequest = std::chrono::steady_clock::now();
+	}
+	scheduler.WaitIdle();
+
+	REQUIRE(!log.compiles.empty());
+	CHECK(log.times.back() - lastRequest >= Debounce);
+	CHECK(log.times.back() - start >= 2 * Debounce);
+}
+
+TEST_CASE(FailedCompileDoesNotStopLaterReloads)
+{
+	CompileLog log;
+	ShaderReloadScheduler scheduler(log.GetFunc(), Debounce);
+
+	scheduler.Request({ "broken" });
+	scheduler.WaitIdle();
+	scheduler.Request({ "fixed" });
+	scheduler.WaitIdle();
+
+	REQUIRE(log.compiles.size() == 2);
+	CHECK(log.compiles[1] == Names({ "fixed" }));
+	CHECK(scheduler.GetCompileCount() == 2);
+}
+
+TEST_CASE(EmptyRequestIsIgnored)
+{
+	CompileLog log;
+	ShaderReloadScheduler scheduler(log.GetFunc(), Debounce);
+
+	scheduler.Request({});
+	scheduler.WaitIdle();
+	std::this_thread::sleep_for(2 * Debounce);
+	CHECK(log.compiles.empty());
+	CHECK(scheduler.GetCompileCount() == 0);
+}
+
+TEST_CASE(StopDropsPendingRequests)
+{
+	CompileLog log;
+	{
+		ShaderReloadScheduler scheduler(log.GetFunc(), std::chrono::milliseconds(1000));
+		scheduler.Request({ "a:PS" });
+		scheduler.Stop();
+		CHECK(scheduler.GetCompileCount() == 0);
+
+		// Stopped for good, WaitIdle returns and further requests go nowhere
+		scheduler.Request({ "b:PS" });
+		scheduler.WaitIdle();
+	}
+	CHECK(log.compiles.empty());
+}
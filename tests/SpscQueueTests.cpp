@@ -0,0 +1,128 @@
+#include "TestFramework.h"
+#include "SpscQueue.h"
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Payload larger than a word, a torn read shows up as a bad checksum
+	struct Item
+	{
+		uint64_t sequence;
+		uint64_t values[3];
+		uint64_t checksum;
+	};
+
+	Item MakeItem(uint64_t sequence)
+	{
+		Item item = { sequence, { sequence * 3, sequence * 5, sequence * 7 }, 0 };
+		item.checksum = item.sequence ^ item.values[0] ^ item.values[1] ^ item.values[2];
+		return item;
+	}
+
+	bool IsValid(const Item& item)
+	{
+		return item.checksum == (item.sequence ^ item.values[0] ^ item.values[1] ^ item.values[2]) &&
+			item.values[0] == item.sequence * 3;
+	}
+}
+
+TEST_CASE(CapacityIsRoundedUpToAPowerOfTwo)
+{
+	CHECK(SpscQueue<int>(0).GetCapacity() == 1);
+	CHECK(SpscQueue<int>(1).GetCapacity() == 1);
+	CHECK(SpscQueue<int>(3).GetCapacity() == 4);
+	CHECK(SpscQueue<int>(256).GetCapacity() == 256);
+	CHECK(SpscQueue<int>(257).GetCapacity() == 512);
+}
+
+TEST_CASE(FirstInFirstOutUntilFullOrEmpty)
+{
+	SpscQueue<int> queue(4);
+	int value = -1;
+	CHECK(queue.IsEmpty());
+	CHECK(!queue.TryPop(value));
+
+	for (int i = 0; i < 4; i++)
+		CHECK(queue.TryPush(i));
+	CHECK(!queue.TryPush(4));
+	CHECK(!queue.IsEmpty());
+
+	for (int i = 0; i < 4; i++)
+	{
+		REQUIRE(queue.TryPop(value));
+		CHECK(value == i);
+	}
+	CHECK(!queue.TryPop(value));
+	CHECK(queue.IsEmpty());
+}
+
+TEST_CASE(SlotsAreReusedAcrossManyLaps)
+{
+	SpscQueue<uint32_t> queue(8);
+	uint32_t next = 0;
+	uint32_t expected = 0;
+	// Fill levels that shift every lap, so pushes and pops wrap at every offset
+	for (uint32_t lap = 0; lap < 1000; lap++)
+	{
+		const uint32_t pushes = 1 + lap % 8;
+		for (uint32_t i = 0; i < pushes && queue.TryPush(next); i++)
+			next++;
+		const uint32_t pops = 1 + (lap * 5) % 8;
+		uint32_t value;
+		for (uint32_t i = 0; i < pops && queue.TryPop(value); i++)
+		{
+			CHECK(value == expected);
+			expected++;
+		}
+	}
+	uint32_t value;
+	while (queue.TryPop(value))
+	{
+		CHECK(value == expected);
+		expected++;
+	}
+	CHECK(expected == next);
+	CHECK(next > 1000);
+}
+
+TEST_CASE(StressOneProducerOneConsumer)
+{
+	const uint64_t itemCount = 1000000;
+	for (uint32_t capacity : { 1u, 16u, 1024u })
+	{
+		SpscQueue<Item> queue(capacity);
+
+		std::thread producer([&]()
+		{
+			for (uint64_t sequence = 0; sequence < itemCount; sequence++)
+			{
+				const Item item = MakeItem(sequence);
+				while (!queue.TryPush(item))
+					std::this_thread::yield();
+			}
+		});
+
+		uint64_t expected = 0;
+		uint64_t outOfOrder = 0;
+		uint64_t torn = 0;
+		while (expected < itemCount)
+		{
+			Item item;
+			if (!queue.TryPop(item))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			outOfOrder += item.sequence != expected ? 1 : 0;
+			torn += IsValid(item) ? 0 : 1;
+			expected++;
+		}
+		producer.join();
+
+		CHECK(outOfOrder == 0);
+		CHECK(torn == 0);
+		CHECK(queue.IsEmpty());
+	}
+}
@@ -0,0 +1,202 @@
+#include "TestFramework.h"
+#include "CpuFeatures.h"
+#include "JobSystem.h"
+#include "SubresourceCopy.h"
+#include "SubresourceCopyKernels.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	const uint8_t Padding = 0xCD;
+
+	std::vector<uint8_t> MakeRandom(size_t size, uint32_t seed)
+	{
+		std::vector<uint8_t> data(size);
+		std::mt19937 rng(seed);
+		for (uint8_t& value : data)
+			value = static_cast<uint8_t>(rng());
+		return data;
+	}
+
+	// The destination of one copy, with its rows laid out like the d3dx12 MemcpySubresource loop would write them
+	struct Layout
+	{
+		size_t rowSize;
+		unsigned int rowCount;
+		unsigned int sliceCount;
+		size_t destRowPitch;
+		size_t destSlicePitch;
+		size_t sourceRowPitch;
+		size_t sourceSlicePitch;
+		// Destination bytes before the first row, to misalign it
+		size_t destOffset;
+	};
+
+	std::vector<uint8_t> Expected(const Layout& layout, const std::vector<uint8_t>& source, size_t destSize)
+	{
+		std::vector<uint8_t> dest(destSize, Padding);
+		for (unsigned int z = 0; z < layout.sliceCount; z++)
+		{
+			for (unsigned int y = 0; y < layout.rowCount; y++)
+			{
+				memcpy(dest.data() + layout.destOffset + z * layout.destSlicePitch + y * layout.destRowPitch,
+					source.data() + z * layout.sourceSlicePitch + y * layout.sourceRowPitch, layout.rowSize);
+			}
+		}
+		return dest;
+	}
+
+	std::vector<uint8_t> CopyWith(const SubresourceCopy::Settings& settings, const Layout& layout, const std::vector<uint8_t>& source,
+		size_t destSize, JobSystem* pJobSystem)
+	{
+		std::vector<uint8_t> dest(destSize, Padding);
+		const SubresourceCopyDesc copy = { dest.data() + layout.destOffset, layout.destRowPitch, layout.destSlicePitch,
+			source.data(), layout.sourceRowPitch, layout.sourceSlicePitch, layout.rowSize, layout.rowCount, layout.sliceCount };
+		SubresourceCopy::Copy(settings, &copy, 1, pJobSystem);
+		return dest;
+	}
+
+	size_t GetDestSize(const Layout& layout)
+	{
+		return layout.destOffset + layout.destSlicePitch * layout.sliceCount + 64;
+	}
+}
+
+#if defined(_M_X64) || defined(__x86_64__)
+TEST_CASE(StreamKernelMatchesMemcpyAtEveryAlignment)
+{
+	if (!CpuFeatures::HasAvx2())
+		return;
+
+	const std::vector<uint8_t> source = MakeRandom(1024, 1);
+	for (size_t destOffset = 0; destOffset < 64; destOffset += 7)
+	{
+		for (size_t size : { size_t(0), size_t(1), size_t(31), size_t(32), size_t(33), size_t(255), size_t(256), size_t(900) })
+		{
+			std::vector<uint8_t> dest(1024 + 128, Padding);
+			StreamCopyAvx2(dest.data() + destOffset, source.data() + 3, size);
+			_mm_sfence();
+
+			std::vector<uint8_t> expected(dest.size(), Padding);
+			memcpy(expected.data() + destOffset, source.data() + 3, size);
+			CHECK(dest == expected);
+		}
+	}
+}
+#endif
+
+TEST_CASE(OddPitchesAndSlicesMatchTheRowLoop)
+{
+	std::mt19937 rng(2);
+	for (uint32_t i = 0; i < 200; i++)
+	{
+		Layout layout;
+		layout.rowSize = i % 7 == 0 ? rng() % 40 : rng() % 20000;
+		layout.rowCount = rng() % 40 + 1;
+		layout.sliceCount = rng() % 3 + 1;
+		layout.destRowPitch = layout.rowSize + rng() % 300;
+		layout.destSlicePitch = layout.destRowPitch * layout.rowCount + rng() % 64;
+		// Half of them tightly packed on the source side, which copies each slice as one run
+		layout.sourceRowPitch = layout.rowSize + (i % 2 == 0 ? 0 : rng() % 100);
+		layout.sourceSlicePitch = layout.sourceRowPitch * layout.rowCount;
+		layout.destOffset = rng() % 64;
+
+		const std::vector<uint8_t> source = MakeRandom(layout.sourceSlicePitch * layout.sliceCount, i);
+		const size_t destSize = GetDestSize(layout);
+		const std::vector<uint8_t> expected = Expected(layout, source, destSize);
+		for (bool streaming : { false, true })
+		{
+			SubresourceCopy::Settings settings;
+			settings.streaming = streaming;
+			CHECK(CopyWith(settings, layout, source, destSize, nullptr) == expected);
+		}
+	}
+}
+
+TEST_CASE(LargeCopiesSplitIntoBandsMatchTheRowLoop)
+{
+	JobSystem jobs(3);
+	// Above MinParallelSize, with partial last bands in each slice
+	Layout layout;
+	layout.rowSize = 8100 * 4;
+	layout.rowCount = 37;
+	layout.sliceCount = 3;
+	layout.destRowPitch = (layout.rowSize + 255) & ~size_t(255);
+	layout.destSlicePitch = layout.destRowPitch * layout.rowCount;
+	layout.sourceRowPitch = layout.rowSize;
+	layout.sourceSlicePitch = layout.rowSize * layout.rowCount;
+	layout.destOffset = 0;
+	REQUIRE(layout.rowSize * layout.rowCount * layout.sliceCount >= SubresourceCopy::MinParallelSize);
+
+	const std::vector<uint8_t> source = MakeRandom(layout.sourceSlicePitch * layout.sliceCount, 3);
+	const size_t destSize = GetDestSize(layout);
+	const std::vector<uint8_t> expected = Expected(layout, source, destSize);
+	for (bool streaming : { false, true })
+	{
+		for (bool allowAvx2 : { false, true })
+		{
+			SubresourceCopy::Settings settings;
+			settings.streaming = streaming;
+			settings.allowAvx2 = allowAvx2;
+			CHECK(CopyWith(settings, layout, source, destSize, &jobs) == expected);
+		}
+	}
+}
+
+TEST_CASE(SeveralCopiesInOneCall)
+{
+	JobSystem jobs(3);
+	// A mip chain in one upload, like UpdateSubresourcesParallel hands over
+	const uint32_t width = 1024;
+	std::vector<std::vector<uint8_t>> sources;
+	std::vector<std::vector<uint8_t>> dests;
+	std::vector<SubresourceCopyDesc> copies;
+	for (uint32_t mip = 0, size = width; size > 0; mip++, size /= 2)
+	{
+		sources.push_back(MakeRandom(size_t(size) * size * 4, mip));
+		dests.emplace_back(((size * 4 + 255) & ~size_t(255)) * size, Padding);
+	}
+	for (size_t mip = 0; mip < sources.size(); mip++)
+	{
+		const size_t size = width >> mip;
+		const size_t destRowPitch = dests[mip].size() / size;
+		copies.push_back({ dests[mip].data(), destRowPitch, dests[mip].size(), sources[mip].data(), size * 4, sources[mip].size(),
+			size * 4, static_cast<unsigned int>(size), 1 });
+	}
+	SubresourceCopy::Copy(SubresourceCopy::Settings(), copies.data(), static_cast<unsigned int>(copies.size()), &jobs);
+
+	uint32_t mismatches = 0;
+	for (const SubresourceCopyDesc& copy : copies)
+	{
+		for (unsigned int row = 0; row < copy.rowCount; row++)
+		{
+			mismatches += memcmp(static_cast<const uint8_t*>(copy.pDest) + row * copy.destRowPitch,
+				static_cast<const uint8_t*>(copy.pSource) + row * copy.sourceRowPitch, copy.rowSize) != 0 ? 1 : 0;
+		}
+	}
+	CHECK(mismatches == 0);
+}
+
+TEST_CASE(BuffersCopyExactlyTheirBytes)
+{
+	JobSystem jobs(3);
+	const size_t sizes[] = { 0, 1, 65535, 65536, 65537, (size_t(5) << 20) + 17 };
+	for (size_t size : sizes)
+	{
+		const std::vector<uint8_t> source = MakeRandom(size, static_cast<uint32_t>(size));
+		for (JobSystem* pJobSystem : { static_cast<JobSystem*>(nullptr), &jobs })
+		{
+			std::vector<uint8_t> dest(size + 8, Padding);
+			SubresourceCopy::CopyBuffer(SubresourceCopy::Settings(), dest.data() + 3, source.data(), size, pJobSystem);
+			CHECK(size == 0 || memcmp(dest.data() + 3, source.data(), size) == 0);
+			CHECK(dest[2] == Padding && dest[size + 3] == Padding);
+		}
+	}
+}
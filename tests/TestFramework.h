@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+// Minimal self-registering tests. Every *Tests.cpp is its own executable and links TestMain.cpp for main().
+namespace Test
+{
+	using Function = void (*)();
+
+	struct Registrar
+	{
+		Registrar(const char* name, Function function);
+	};
+
+	void ReportFailure(const char* file, int line, const char* expression);
+}
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static const Test::Registrar name##Registrar(#name, name); \
+	static void name()
+
+#define CHECK(condition) \
+	do { if (!(condition)) Test::ReportFailure(__FILE__, __LINE__, #condition); } while (0)
+
+// Stops the test case, for conditions the rest of it depends on
+#define REQUIRE(condition) \
+	do { if (!(condition)) { Test::ReportFailure(__FILE__, __LINE__, #condition); return; } } while (0)
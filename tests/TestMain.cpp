@@ -0,0 +1,64 @@
+#include "TestFramework.h"
+
+#include <cstring>
+#include <exception>
+#include <vector>
+
+namespace
+{
+	struct TestCase
+	{
+		const char* name;
+		Test::Function function;
+	};
+
+	std::vector<TestCase>& GetTestCases()
+	{
+		static std::vector<TestCase> testCases;
+		return testCases;
+	}
+
+	uint32_t gFailureCount = 0;
+}
+
+Test::Registrar::Registrar(const char* name, Function function)
+{
+	GetTestCases().push_back({ name, function });
+}
+
+void Test::ReportFailure(const char* file, int line, const char* expression)
+{
+	gFailureCount++;
+	printf("  %s:%d: CHECK(%s) failed\n", file, line, expression);
+}
+
+// Runs every test case, or only those whose name contains the first argument
+int main(int argc, char** argv)
+{
+	uint32_t failedCount = 0;
+	uint32_t runCount = 0;
+	for (const TestCase& testCase : GetTestCases())
+	{
+		if (argc > 1 && !strstr(testCase.name, argv[1]))
+			continue;
+
+		const uint32_t failuresBefore = gFailureCount;
+		try
+		{
+			testCase.function();
+		}
+		catch (const std::exception& e)
+		{
+			gFailureCount++;
+			printf("  unexpected exception: %s\n", e.what());
+		}
+
+		const bool passed = gFailureCount == failuresBefore;
+		printf("%s %s\n", passed ? "[pass]" : "[FAIL]", testCase.name);
+		failedCount += passed ? 0 : 1;
+		runCount++;
+	}
+
+	printf("%u of %u test cases passed\n", runCount - failedCount, runCount);
+	return failedCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+#include "Benchmark.h"
+#include "TlsfAllocator.h"
+
+#include <random>
+#include <vector>
+
+// Placed resource patterns GpuMemoryAllocator sees in a heap block: render targets and buffers
+// created and released in random order, and whole levels streamed in then out.
+namespace
+{
+	struct Request
+	{
+		uint64_t size;
+		uint64_t alignment;
+	};
+
+	std::vector<Request> MakeRequests(uint32_t count, uint32_t seed)
+	{
+		// Mostly 64 KB aligned buffers and small textures, some 4 MB aligned MSAA targets
+		std::mt19937 rng(seed);
+		std::vector<Request> requests(count);
+		for (Request& request : requests)
+		{
+			const uint32_t kind = rng() % 16;
+			if (kind == 0)
+				request = { 4 * 1024 * 1024 + (rng() % 4) * 1024 * 1024, 4 * 1024 * 1024 };
+			else if (kind < 6)
+				request = { 64 * 1024 * (1 + rng() % 32), 64 * 1024 };
+			else
+				request = { 256 + rng() % 65536, 64 * 1024 };
+		}
+		return requests;
+	}
+
+	void Report(const char* name, double operations, double time)
+	{
+		printf("%-24s %8.1f M ops/s %8.1f ns per op\n", name, operations / time / 1e6, time / operations * 1e9);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool quick = Benchmark::IsQuick(argc, argv);
+	const uint64_t heapSize = 256 * 1024 * 1024;
+	const uint32_t operationCount = quick ? 10000 : 2000000;
+	const std::vector<Request> requests = MakeRequests(4096, 42);
+	uint64_t failures = 0;
+
+	// Random churn, allocations and frees in equal measure, with at most half the heap in use
+	{
+		TlsfAllocator allocator(heapSize);
+		std::vector<TlsfAllocator::Handle> handles;
+		std::mt19937 rng(7);
+		uint32_t misses = 0;
+		const double time = Benchmark::Measure(3, [&]()
+		{
+			allocator.Reset(heapSize);
+			handles.clear();
+			misses = 0;
+			uint64_t usedSize = 0;
+			for (uint32_t n = 0; n < operationCount; n++)
+			{
+				const bool release = !handles.empty() && (rng() % 2 == 0 || usedSize > heapSize / 2);
+				if (release)
+				{
+					const size_t index = rng() % handles.size();
+					usedSize -= allocator.GetSize(handles[index]);
+					allocator.Free(handles[index]);
+					handles[index] = handles.back();
+					handles.pop_back();
+					continue;
+				}
+
+				const Request& request = requests[n % requests.size()];
+				const TlsfAllocator::Handle handle = allocator.Allocate(request.size, request.alignment);
+				if (handle != TlsfAllocator::InvalidHandle)
+				{
+					usedSize += request.size;
+					handles.push_back(handle);
+				}
+				else
+				{
+					misses++;
+				}
+			}
+		});
+		Report("Random churn", operationCount, time);
+
+		const TlsfAllocator::Stats stats = allocator.GetStats();
+		printf("  %u live, %.1f MB used, fragmentation %.2f, %u allocations did not fit\n", stats.allocationCount,
+			stats.usedSize / (1024.0 * 1024.0), stats.fragmentation, misses);
+
+		// Compaction of what the churn left behind
+		std::vector<TlsfAllocator::Move> moves;
+		const double start = Benchmark::GetSeconds();
+		allocator.Defragment(~0u, moves);
+		const double defragmentTime = Benchmark::GetSeconds() - start;
+		for (const TlsfAllocator::Move& move : moves)
+			allocator.Free(move.source);
+		printf("  Defragment: %zu moves in %.3f ms, fragmentation %.2f after\n", moves.size(), defragmentTime * 1e3,
+			allocator.GetStats().fragmentation);
+	}
+
+	// Level load and unload: fill, then free in allocation order
+	{
+		TlsfAllocator allocator(heapSize);
+		std::vector<TlsfAllocator::Handle> handles;
+		const uint32_t roundCount = quick ? 2 : 200;
+		uint64_t operations = 0;
+		const double time = Benchmark::Measure(3, [&]()
+		{
+			operations = 0;
+			for (uint32_t round = 0; round < roundCount; round++)
+			{
+				handles.clear();
+				for (const Request& request : requests)
+				{
+					const TlsfAllocator::Handle handle = allocator.Allocate(request.size, request.alignment);
+					if (handle == TlsfAllocator::InvalidHandle)
+						break;
+					handles.push_back(handle);
+				}
+				for (TlsfAllocator::Handle handle : handles)
+					allocator.Free(handle);
+				operations += 2 * handles.size();
+			}
+		});
+		Report("Level load/unload", double(operations), time);
+		failures += allocator.IsEmpty() ? 0 : 1;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
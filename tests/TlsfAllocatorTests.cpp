@@ -0,0 +1,263 @@
+#include "TestFramework.h"
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct Range
+	{
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	bool Overlaps(const std::vector<Range>& ranges)
+	{
+		std::vector<Range> sorted = ranges;
+		std::sort(sorted.begin(), sorted.end(), [](const Range& a, const Range& b) { return a.offset < b.offset; });
+		for (size_t i = 1; i < sorted.size(); i++)
+		{
+			if (sorted[i - 1].offset + sorted[i - 1].size > sorted[i].offset)
+				return true;
+		}
+		return false;
+	}
+
+	std::vector<Range> GetRanges(const TlsfAllocator& allocator, const std::vector<TlsfAllocator::Handle>& handles)
+	{
+		std::vector<Range> ranges;
+		for (TlsfAllocator::Handle handle : handles)
+			ranges.push_back({ allocator.GetOffset(handle), allocator.GetSize(handle) });
+		return ranges;
+	}
+}
+
+TEST_CASE(AllocatesUntilFull)
+{
+	TlsfAllocator allocator(1024);
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.Allocate(0, 1) == TlsfAllocator::InvalidHandle);
+	CHECK(allocator.Allocate(2048, 1) == TlsfAllocator::InvalidHandle);
+
+	const TlsfAllocator::Handle whole = allocator.Allocate(1024, 1);
+	REQUIRE(whole != TlsfAllocator::InvalidHandle);
+	CHECK(allocator.GetOffset(whole) == 0);
+	CHECK(allocator.GetSize(whole) == 1024);
+	CHECK(allocator.Allocate(1, 1) == TlsfAllocator::InvalidHandle);
+
+	allocator.Free(whole);
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.Allocate(1024, 1) != TlsfAllocator::InvalidHandle);
+}
+
+TEST_CASE(FreeCoalescesNeighbours)
+{
+	TlsfAllocator allocator(3072);
+	const TlsfAllocator::Handle a = allocator.Allocate(1024, 1);
+	const TlsfAllocator::Handle b = allocator.Allocate(1024, 1);
+	const TlsfAllocator::Handle c = allocator.Allocate(1024, 1);
+	REQUIRE(c != TlsfAllocator::InvalidHandle);
+
+	allocator.Free(a);
+	allocator.Free(c);
+	TlsfAllocator::Stats stats = allocator.GetStats();
+	CHECK(stats.freeBlockCount == 2);
+	CHECK(stats.largestFreeBlock == 1024);
+	CHECK(stats.fragmentation == 0.5);
+	// Two 1024 byte holes can't hold 1536
+	CHECK(allocator.Allocate(1536, 1) == TlsfAllocator::InvalidHandle);
+
+	// Merges with both sides at once
+	allocator.Free(b);
+	stats = allocator.GetStats();
+	CHECK(stats.freeBlockCount == 1);
+	CHECK(stats.largestFreeBlock == 3072);
+	CHECK(stats.fragmentation == 0.0);
+	CHECK(allocator.Allocate(3072, 1) != TlsfAllocator::InvalidHandle);
+}
+
+TEST_CASE(AlignmentIsHonoured)
+{
+	TlsfAllocator allocator(64 * 1024 * 1024);
+	std::mt19937 rng(7);
+	std::vector<TlsfAllocator::Handle> handles;
+	const uint64_t alignments[] = { 1, 4, 256, 4096, 64 * 1024 };
+	for (uint32_t n = 0; n < 500; n++)
+	{
+		const uint64_t alignment = alignments[rng() % 5];
+		const uint64_t size = 1 + rng() % 100000;
+		const TlsfAllocator::Handle handle = allocator.Allocate(size, alignment);
+		REQUIRE(handle != TlsfAllocator::InvalidHandle);
+		CHECK(allocator.GetOffset(handle) % alignment == 0);
+		CHECK(allocator.GetSize(handle) == size);
+		handles.push_back(handle);
+	}
+	CHECK(!Overlaps(GetRanges(allocator, handles)));
+}
+
+TEST_CASE(PaddingIsReturnedOnFree)
+{
+	TlsfAllocator allocator(1 << 20);
+	const TlsfAllocator::Handle small = allocator.Allocate(100, 1);
+	const TlsfAllocator::Handle aligned = allocator.Allocate(1000, 65536);
+	REQUIRE(aligned != TlsfAllocator::InvalidHandle);
+	CHECK(allocator.GetOffset(aligned) == 65536);
+
+	allocator.Free(small);
+	allocator.Free(aligned);
+	const TlsfAllocator::Stats stats = allocator.GetStats();
+	CHECK(stats.usedSize == 0);
+	CHECK(stats.freeBlockCount == 1);
+	CHECK(stats.largestFreeBlock == 1 << 20);
+}
+
+TEST_CASE(RandomChurnKeepsStatsConsistent)
+{
+	const uint64_t size = 16 * 1024 * 1024;
+	TlsfAllocator allocator(size);
+	std::mt19937 rng(1234);
+	std::vector<TlsfAllocator::Handle> handles;
+	uint64_t usedSize = 0;
+
+	for (uint32_t n = 0; n < 20000; n++)
+	{
+		if (!handles.empty() && rng() % 2 == 0)
+		{
+			const size_t index = rng() % handles.size();
+			usedSize -= allocator.GetSize(handles[index]);
+			allocator.Free(handles[index]);
+			handles[index] = handles.back();
+			handles.pop_back();
+		}
+		else
+		{
+			const uint64_t allocationSize = 256 + rng() % 65536;
+			const TlsfAllocator::Handle handle = allocator.Allocate(allocationSize, 256);
+			if (handle != TlsfAllocator::InvalidHandle)
+			{
+				CHECK(allocator.GetOffset(handle) + allocationSize <= size);
+				usedSize += allocationSize;
+				handles.push_back(handle);
+			}
+		}
+
+		if (n % 1000 == 0)
+		{
+			const TlsfAllocator::Stats stats = allocator.GetStats();
+			CHECK(stats.usedSize == usedSize);
+			CHECK(stats.freeSize == size - usedSize);
+			CHECK(stats.allocationCount == handles.size());
+			CHECK(stats.largestFreeBlock <= stats.freeSize);
+			CHECK(!Overlaps(GetRanges(allocator, handles)));
+		}
+	}
+
+	for (TlsfAllocator::Handle handle : handles)
+		allocator.Free(handle);
+	const TlsfAllocator::Stats stats = allocator.GetStats();
+	CHECK(allocator.IsEmpty());
+	CHECK(stats.freeBlockCount == 1);
+	CHECK(stats.largestFreeBlock == size);
+}
+
+TEST_CASE(DefragmentMovesHighAllocationsDown)
+{
+	TlsfAllocator allocator(16 * 1024);
+	std::vector<TlsfAllocator::Handle> handles;
+	for (uint32_t n = 0; n < 16; n++)
+		handles.push_back(allocator.Allocate(1024, 256));
+
+	// Every other block freed, free space is split into 8 holes
+	std::vector<TlsfAllocator::Handle> live;
+	for (uint32_t n = 0; n < 16; n++)
+	{
+		if (n % 2 == 0)
+			allocator.Free(handles[n]);
+		else
+			live.push_back(handles[n]);
+	}
+	CHECK(allocator.GetStats().freeBlockCount == 8);
+	CHECK(allocator.GetStats().fragmentation > 0.8);
+
+	std::vector<TlsfAllocator::Move> moves;
+	allocator.Defragment(3, moves);
+	REQUIRE(moves.size() == 3);
+	for (const TlsfAllocator::Move& move : moves)
+	{
+		CHECK(move.destinationOffset < move.sourceOffset);
+		CHECK(move.size == 1024);
+		CHECK(allocator.GetOffset(move.destination) == move.destinationOffset);
+		CHECK(allocator.GetOffset(move.destination) % 256 == 0);
+	}
+
+	// Sources stay allocated until the caller has copied them, nothing overlaps meanwhile
+	std::vector<TlsfAllocator::Handle> all = live;
+	for (const TlsfAllocator::Move& move : moves)
+		all.push_back(move.destination);
+	CHECK(!Overlaps(GetRanges(allocator, all)));
+
+	// Repeated passes, each after the previous copies are done, pack the heap
+	uint32_t passCount = 1;
+	while (!moves.empty() && passCount < 16)
+	{
+		for (const TlsfAllocator::Move& move : moves)
+			allocator.Free(move.source);
+		moves.clear();
+		allocator.Defragment(100, moves);
+		passCount++;
+	}
+	CHECK(moves.empty());
+
+	// Everything packed at the bottom, the free space is one block again
+	const TlsfAllocator::Stats stats = allocator.GetStats();
+	CHECK(stats.allocationCount == 8);
+	CHECK(stats.freeBlockCount == 1);
+	CHECK(stats.largestFreeBlock == 8 * 1024);
+	CHECK(stats.fragmentation == 0.0);
+}
+
+TEST_CASE(DefragmentLeavesPackedHeapAlone)
+{
+	TlsfAllocator allocator(8192);
+	for (uint32_t n = 0; n < 4; n++)
+		allocator.Allocate(1024, 1);
+
+	std::vector<TlsfAllocator::Move> moves;
+	allocator.Defragment(10, moves);
+	CHECK(moves.empty());
+	CHECK(allocator.GetStats().allocationCount == 4);
+	CHECK(allocator.GetStats().freeBlockCount == 1);
+}
+
+TEST_CASE(DefragmentSkipsRejectedSourcesWithoutUsingTheBudget)
+{
+	TlsfAllocator allocator(16 * 1024);
+	std::vector<TlsfAllocator::Handle> handles;
+	for (uint32_t n = 0; n < 16; n++)
+		handles.push_back(allocator.Allocate(1024, 1));
+	for (uint32_t n = 0; n < 8; n++)
+		allocator.Free(handles[n]);
+
+	// The four highest allocations are busy, like the sources of moves still being copied
+	auto canMove = [&handles](TlsfAllocator::Handle handle)
+	{
+		return std::find(handles.begin() + 12, handles.end(), handle) == handles.end();
+	};
+	std::vector<TlsfAllocator::Move> moves;
+	allocator.Defragment(3, moves, canMove);
+	REQUIRE(moves.size() == 3);
+	for (const TlsfAllocator::Move& move : moves)
+	{
+		CHECK(canMove(move.source));
+		CHECK(move.destinationOffset < move.sourceOffset);
+	}
+
+	// Nothing moves once every source is rejected
+	for (const TlsfAllocator::Move& move : moves)
+		allocator.Free(move.source);
+	moves.clear();
+	allocator.Defragment(100, moves, [](TlsfAllocator::Handle) { return false; });
+	CHECK(moves.empty());
+}
@@ -0,0 +1,210 @@
+#include "TestFramework.h"
+#include "TransitionTracker.h"
+
+namespace
+{
+	// D3D12_RESOURCE_STATES values the tests use
+	const uint32_t Common = 0x0;
+	const uint32_t RenderTarget = 0x4;
+	const uint32_t UnorderedAccess = 0x8;
+	const uint32_t PixelShaderResource = 0x80;
+	const uint32_t CopyDest = 0x400;
+	const uint32_t CopySource = 0x800;
+
+	// Resources are opaque keys, any distinct addresses do
+	const int ResourceA = 0;
+	const int ResourceB = 0;
+	const int TextureC = 0;
+
+	uint32_t GetSubresourceCount(TransitionTracker::Resource resource)
+	{
+		return resource == &TextureC ? 4 : 1;
+	}
+
+	bool IsTransition(const TransitionTracker::Barrier& barrier, const void* pResource, uint32_t subresource, uint32_t before, uint32_t after)
+	{
+		return barrier.type == TransitionTracker::BarrierType::Transition && barrier.resource == pResource &&
+			barrier.subresource == subresource && barrier.stateBefore == before && barrier.stateAfter == after;
+	}
+
+	// A resource the tracker has seen in a known state, so its transitions are recorded rather than pending
+	void Declare(TransitionTracker& tracker, const void* pResource, uint32_t state)
+	{
+		tracker.SetState(pResource, state);
+	}
+
+	const uint32_t All = TransitionTracker::AllSubresources;
+}
+
+TEST_CASE(KnownStateRecordsBarrier)
+{
+	TransitionTracker tracker(&GetSubresourceCount);
+	Declare(tracker, &ResourceA, Common);
+	tracker.Transition(&ResourceA, RenderTarget);
+	REQUIRE(tracker.GetBarriers().size() == 1);
+	CHECK(IsTransition(tracker.GetBarriers()[0], &ResourceA, All, Common, RenderTarget));
+
+	// Already there, nothing to do
+	tracker.Transition(&ResourceA, RenderTarget);
+	CHECK(tracker.GetBarriers().size() == 1);
+}
+
+TEST_CASE(ChainedTransitionsCollapse)
+{
+	TransitionTracker tracker(&GetSubresourceCount);
+	Declare(tracker, &ResourceA, Common);
+	Declare(tracker, &ResourceB, Common);
+
+	tracker.Transition(&ResourceA, CopyDest);
+	tracker.Transition(&ResourceB, CopySource);
+	// A->B->C becomes A->C even with another resource's transition in between
+	tracker.Transition(&ResourceA, PixelShaderResource);
+	REQUIRE(tracker.GetBarriers().size() == 2);
+	CHECK(IsTransition(tracker.GetBarriers()[0], &ResourceA, All, Common, PixelShaderResource));
+	CHECK(IsTransition(tracker.GetBarriers()[1], &ResourceB, All, Common, CopySource));
+
+	// Back to where it started, the barrier disappears
+	tracker.Transition(&ResourceB, Common);
+	REQUIRE(tracker.GetBarriers().size() == 1);
+	CHECK(IsTransition(tracker.GetBarriers()[0], &ResourceA, All, Common, PixelShaderResource));
+}
+
+TEST_CASE(UavAndAliasBarriersStopCollapsing)
+{
+	TransitionTracker tracker(&GetSubresourceCount);
+	Declare(tracker, &ResourceA, Common);
+	tracker.Transition(&ResourceA, UnorderedAccess);
+	tracker.UavBarrier(&ResourceA);
+	tracker.Transition(&ResourceA, PixelShaderResource);
+	tracker.AliasBarrier(&ResourceA, &ResourceB);
+	tracker.Transition(&ResourceA, Common);
+
+	const std::vector<TransitionTracker::Barrier>& barriers = tracker.GetBarriers();
+	REQUIRE(barriers.size() == 5);
+	CHECK(IsTransition(barriers[0], &ResourceA, All, Common, UnorderedAccess));
+	CHECK(barriers[1].type == TransitionTracker::BarrierType::Uav);
+	CHECK(IsTransition(barriers[2], &ResourceA, All, UnorderedAccess, PixelShaderResource));
+	CHECK(barriers[3].type == TransitionTracker::BarrierType::Aliasing);
+	CHECK(barriers[3].resource == &ResourceA && barriers[3].resourceAfter == &ResourceB);
+	CHECK(IsTransition(barriers[4], &ResourceA, All, PixelShaderResource, Common));
+
+	tracker.ClearBarriers();
+	CHECK(tracker.GetBarriers().empty());
+}
+
+TEST_CASE(SubresourcesAreTrackedSeparately)
+{
+	TransitionTracker tracker(&GetSubresourceCount);
+	Declare(tracker, &TextureC, PixelShaderResource);
+	tracker.Transition(&TextureC, RenderTarget, 1);
+	tracker.Transition(&TextureC, RenderTarget, 2);
+	CHECK(tracker.GetBarriers().size() == 2);
+	tracker.ClearBarriers();
+
+	// Whole resource transition after divergence goes subresource by subresource
+	tracker.Transition(&TextureC, CopySource);
+	const std::vector<TransitionTracker::Barrier>& barriers = tracker.GetBarriers();
+	REQUIRE(barriers.size() == 4);
+	CHECK(IsTransition(barriers[0], &TextureC, 0, PixelShaderResource, CopySource));
+	CHECK(IsTransition(barriers[1], &TextureC, 1, RenderTarget, CopySource));
+	CHECK(IsTransition(barriers[2], &TextureC, 2, RenderTarget, CopySource));
+	CHECK(IsTransition(barriers[3], &TextureC, 3, PixelShaderResource, CopySource));
+	tracker.ClearBarriers();
+
+	// States converged again, one barrier covers everything
+	tracker.Transition(&TextureC, PixelShaderResource);
+	REQUIRE(tracker.GetBarriers().size() == 1);
+	CHECK(IsTransition(tracker.GetBarriers()[0], &TextureC, All, CopySource, PixelShaderResource));
+}
+
+TEST_CASE(FirstUseIsResolvedAgainstGlobalState)
+{
+	TransitionTracker::StateMap globalStates;
+	globalStates[&ResourceA] = TransitionTracker::ResourceState(Common);
+	globalStates[&ResourceB] = TransitionTracker::ResourceState(RenderTarget);
+
+	TransitionTracker tracker(&GetSubresourceCount);
+	tracker.Transition(&ResourceA, CopyDest);
+	tracker.Transition(&ResourceB, RenderTarget);
+	// Later transitions of a pending resource are known relative to the first one
+	tracker.Transition(&ResourceA, PixelShaderResource);
+	REQUIRE(tracker.GetBarriers().size() == 1);
+	CHECK(IsTransition(tracker.GetBarriers()[0], &ResourceA, All, CopyDest, PixelShaderResource));
+
+	std::vector<TransitionTracker::Barrier> resolved;
+	tracker.ResolvePendingBarriers(globalStates, resolved);
+	// B was already a render target, so only A needs a barrier before the list
+	REQUIRE(resolved.size() == 1);
+	CHECK(IsTransition(resolved[0], &ResourceA, All, Common, CopyDest));
+
+	tracker.CommitFinalStates(globalStates);
+	CHECK(globalStates[&ResourceA].GetSubresourceState(0) == PixelShaderResource);
+	CHECK(globalStates[&ResourceB].GetSubresourceState(0) == RenderTarget);
+
+	// Everything was forgotten, the next list starts pending again
+	tracker.Transition(&ResourceA, Common);
+	CHECK(tracker.GetBarriers().size() == 1);
+	resolved.clear();
+	tracker.ResolvePendingBarriers(globalStates, resolved);
+	REQUIRE(resolved.size() == 1);
+	CHECK(IsTransition(resolved[0], &ResourceA, All, PixelShaderResource, Common));
+}
+
+TEST_CASE(PendingWholeResourceSplitsOverDivergedGlobalState)
+{
+	TransitionTracker::StateMap globalStates;
+	globalStates[&TextureC] = TransitionTracker::ResourceState(PixelShaderResource);
+	globalStates[&TextureC].SetSubresourceState(2, RenderTarget);
+
+	TransitionTracker tracker(&GetSubresourceCount);
+	tracker.Transition(&TextureC, RenderTarget);
+
+	std::vector<TransitionTracker::Barrier> resolved;
+	tracker.ResolvePendingBarriers(globalStates, resolved);
+	REQUIRE(resolved.size() == 3);
+	CHECK(IsTransition(resolved[0], &TextureC, 0, PixelShaderResource, RenderTarget));
+	CHECK(IsTransition(resolved[1], &TextureC, 1, PixelShaderResource, RenderTarget));
+	CHECK(IsTransition(resolved[2], &TextureC, 3, PixelShaderResource, RenderTarget));
+
+	tracker.CommitFinalStates(globalStates);
+	CHECK(globalStates[&TextureC].subresourceStates.empty());
+	CHECK(globalStates[&TextureC].state == RenderTarget);
+}
+
+TEST_CASE(PartialFirstUseCommitsOnlyTouchedSubresources)
+{
+	TransitionTracker::StateMap globalStates;
+	globalStates[&TextureC] = TransitionTracker::ResourceState(PixelShaderResource);
+
+	TransitionTracker tracker(&GetSubresourceCount);
+	tracker.Transition(&TextureC, RenderTarget, 1);
+	// The rest of the texture is still unknown, the whole resource transition leaves those pending
+	tracker.Transition(&TextureC, CopySource);
+	REQUIRE(tracker.GetBarriers().size() == 1);
+	CHECK(IsTransition(tracker.GetBarriers()[0], &TextureC, 1, RenderTarget, CopySource));
+
+	std::vector<TransitionTracker::Barrier> resolved;
+	tracker.ResolvePendingBarriers(globalStates, resolved);
+	REQUIRE(resolved.size() == 4);
+	CHECK(IsTransition(resolved[0], &TextureC, 1, PixelShaderResource, RenderTarget));
+	CHECK(IsTransition(resolved[1], &TextureC, 0, PixelShaderResource, CopySource));
+	CHECK(IsTransition(resolved[2], &TextureC, 2, PixelShaderResource, CopySource));
+	CHECK(IsTransition(resolved[3], &TextureC, 3, PixelShaderResource, CopySource));
+
+	tracker.CommitFinalStates(globalStates);
+	for (uint32_t n = 0; n < 4; n++)
+		CHECK(globalStates[&TextureC].GetSubresourceState(n) == CopySource);
+}
+
+TEST_CASE(UntrackedResourcesAreSkipped)
+{
+	TransitionTracker::StateMap globalStates;
+	TransitionTracker tracker(&GetSubresourceCount);
+	tracker.Transition(&ResourceA, RenderTarget);
+
+	std::vector<TransitionTracker::Barrier> resolved;
+	tracker.ResolvePendingBarriers(globalStates, resolved);
+	CHECK(resolved.empty());
+	tracker.CommitFinalStates(globalStates);
+	CHECK(globalStates.empty());
+}
@@ -0,0 +1,240 @@
+#include "TestFramework.h"
+#include "UploadScheduler.h"
+
+#include <map>
+#include <vector>
+
+namespace
+{
+	// Copy queue that records what the scheduler asks of it. The GPU only makes progress in Wait.
+	class FakeCopyQueue : public UploadCopyQueue
+	{
+	public:
+		struct Copy
+		{
+			uint64_t id;
+			uint64_t offset;
+			uint64_t size;
+			// 0 until submitted
+			uint64_t fenceValue;
+		};
+
+		explicit FakeCopyQueue(const std::map<uint64_t, uint64_t>& sizes) : mSizes(sizes) {}
+
+		void RecordCopy(uint64_t id, uint64_t stagingOffset) override
+		{
+			const uint64_t size = mSizes.at(id);
+			// Staging memory still read by a pending or unsubmitted copy must not be handed out again
+			for (const Copy& copy : mCopies)
+			{
+				const bool live = copy.fenceValue == 0 || copy.fenceValue > mCompletedValue;
+				if (live && stagingOffset < copy.offset + copy.size && copy.offset < stagingOffset + size)
+					mOverlapCount++;
+			}
+			mCopies.push_back({ id, stagingOffset, size, 0 });
+			mOrder.push_back(id);
+		}
+
+		void Submit(uint64_t fenceValue) override
+		{
+			std::vector<uint64_t> submission;
+			for (Copy& copy : mCopies)
+			{
+				if (copy.fenceValue == 0)
+				{
+					copy.fenceValue = fenceValue;
+					submission.push_back(copy.id);
+				}
+			}
+			mSubmissions.push_back(submission);
+			mFenceValues.push_back(fenceValue);
+		}
+
+		uint64_t GetCompletedValue() override { return mCompletedValue; }
+
+		void Wait(uint64_t fenceValue) override
+		{
+			mWaitCount++;
+			if (mCompletedValue < fenceValue)
+				mCompletedValue = fenceValue;
+		}
+
+		std::vector<Copy> mCopies;
+		std::vector<uint64_t> mOrder;
+		std::vector<std::vector<uint64_t>> mSubmissions;
+		std::vector<uint64_t> mFenceValues;
+		uint64_t mCompletedValue = 0;
+		uint32_t mWaitCount = 0;
+		uint32_t mOverlapCount = 0;
+
+	private:
+		const std::map<uint64_t, uint64_t>& mSizes;
+	};
+
+	struct Fixture
+	{
+		RingAllocator ring;
+		UploadScheduler scheduler;
+		std::map<uint64_t, uint64_t> sizes;
+
+		Fixture(uint64_t ringSize, uint64_t batchSize) : ring(ringSize)
+		{
+			scheduler.Init(&ring, batchSize);
+		}
+
+		void Enqueue(uint64_t id, uint64_t size, UploadPriority priority, uint64_t alignment = 4)
+		{
+			sizes[id] = size;
+			scheduler.Enqueue({ id, size, alignment }, priority);
+		}
+	};
+
+	std::vector<uint64_t> GetIds(const std::vector<UploadScheduler::Request>& batch)
+	{
+		std::vector<uint64_t> ids;
+		for (const UploadScheduler::Request& request : batch)
+			ids.push_back(request.id);
+		return ids;
+	}
+}
+
+TEST_CASE(HighestPriorityFirstAndInOrderWithin)
+{
+	Fixture fixture(1 << 20, 1 << 20);
+	fixture.Enqueue(0, 16, UploadPriority::Low);
+	fixture.Enqueue(1, 16, UploadPriority::Normal);
+	fixture.Enqueue(2, 16, UploadPriority::High);
+	fixture.Enqueue(3, 16, UploadPriority::Low);
+	fixture.Enqueue(4, 16, UploadPriority::High);
+	fixture.Enqueue(5, 16, UploadPriority::Normal);
+
+	const std::vector<uint64_t> expected = { 2, 4, 1, 5, 0, 3 };
+	CHECK(GetIds(fixture.scheduler.PopBatch()) == expected);
+	CHECK(fixture.scheduler.IsEmpty());
+	CHECK(fixture.scheduler.PopBatch().empty());
+}
+
+TEST_CASE(BatchClosesOnceItReachesTheBatchSize)
+{
+	Fixture fixture(1 << 20, 100);
+	for (uint64_t id = 0; id < 10; id++)
+		fixture.Enqueue(id, 30, UploadPriority::Normal);
+
+	// 30 + 30 + 30 is still short of 100, the fourth request takes it over
+	CHECK(GetIds(fixture.scheduler.PopBatch()) == std::vector<uint64_t>({ 0, 1, 2, 3 }));
+	CHECK(GetIds(fixture.scheduler.PopBatch()) == std::vector<uint64_t>({ 4, 5, 6, 7 }));
+	CHECK(GetIds(fixture.scheduler.PopBatch()) == std::vector<uint64_t>({ 8, 9 }));
+	CHECK(fixture.scheduler.IsEmpty());
+
+	// A request larger than the batch size still goes out, on its own
+	fixture.Enqueue(10, 1000, UploadPriority::Normal);
+	fixture.Enqueue(11, 10, UploadPriority::Normal);
+	CHECK(GetIds(fixture.scheduler.PopBatch()) == std::vector<uint64_t>({ 10 }));
+}
+
+TEST_CASE(HighPriorityJumpsAheadBetweenBatches)
+{
+	Fixture fixture(1 << 20, 64);
+	for (uint64_t id = 0; id < 8; id++)
+		fixture.Enqueue(id, 32, UploadPriority::Low);
+
+	CHECK(GetIds(fixture.scheduler.PopBatch()) == std::vector<uint64_t>({ 0, 1 }));
+	fixture.Enqueue(100, 32, UploadPriority::High);
+	CHECK(GetIds(fixture.scheduler.PopBatch()) == std::vector<uint64_t>({ 100, 2 }));
+}
+
+TEST_CASE(BatchIsOneSubmissionWhenItFits)
+{
+	Fixture fixture(1024, 1024);
+	for (uint64_t id = 0; id < 4; id++)
+		fixture.Enqueue(id, 100, UploadPriority::Normal);
+	FakeCopyQueue queue(fixture.sizes);
+
+	CHECK(fixture.scheduler.SubmitBatch(fixture.scheduler.PopBatch(), queue));
+	REQUIRE(queue.mSubmissions.size() == 1);
+	CHECK(queue.mSubmissions[0] == std::vector<uint64_t>({ 0, 1, 2, 3 }));
+	CHECK(queue.mWaitCount == 0);
+	CHECK(queue.mOverlapCount == 0);
+	CHECK(fixture.scheduler.GetLastSubmittedFenceValue() == 1);
+
+	// Nothing to do, nothing submitted
+	CHECK(fixture.scheduler.SubmitBatch({}, queue));
+	CHECK(queue.mSubmissions.size() == 1);
+}
+
+TEST_CASE(FullRingSplitsTheBatchWithoutReusingLiveStaging)
+{
+	Fixture fixture(1024, 1 << 20);
+	for (uint64_t id = 0; id < 10; id++)
+		fixture.Enqueue(id, 300, UploadPriority::Normal);
+	FakeCopyQueue queue(fixture.sizes);
+
+	CHECK(fixture.scheduler.SubmitBatch(fixture.scheduler.PopBatch(), queue));
+	// Three 300 byte copies fit in 1024, so the ring fills every third request
+	CHECK(queue.mSubmissions.size() == 4);
+	CHECK(queue.mWaitCount >= 3);
+	CHECK(queue.mOverlapCount == 0);
+	for (const FakeCopyQueue::Copy& copy : queue.mCopies)
+	{
+		CHECK(copy.offset % 4 == 0);
+		CHECK(copy.offset + copy.size <= 1024);
+	}
+
+	std::vector<uint64_t> expected;
+	for (uint64_t id = 0; id < 10; id++)
+		expected.push_back(id);
+	CHECK(queue.mOrder == expected);
+}
+
+TEST_CASE(StagingIsReusedOnlyOnceTheCopyQueueCatchesUp)
+{
+	Fixture fixture(1024, 1 << 20);
+	FakeCopyQueue queue(fixture.sizes);
+
+	// Many small batches, the ring wraps around several times
+	uint64_t id = 0;
+	for (uint32_t batch = 0; batch < 50; batch++)
+	{
+		for (uint32_t i = 0; i < 3; i++, id++)
+			fixture.Enqueue(id, 64 + (id * 37) % 200, i == 1 ? UploadPriority::High : UploadPriority::Normal, 256);
+		CHECK(fixture.scheduler.SubmitBatch(fixture.scheduler.PopBatch(), queue));
+	}
+	CHECK(queue.mOverlapCount == 0);
+	CHECK(queue.mCopies.size() == id);
+	for (const FakeCopyQueue::Copy& copy : queue.mCopies)
+		CHECK(copy.offset % 256 == 0);
+}
+
+TEST_CASE(OversizedRequestFailsAfterSubmittingEarlierOnes)
+{
+	Fixture fixture(1024, 1 << 20);
+	fixture.Enqueue(0, 200, UploadPriority::Normal);
+	fixture.Enqueue(1, 200, UploadPriority::Normal);
+	fixture.Enqueue(2, 4096, UploadPriority::Normal);
+	fixture.Enqueue(3, 200, UploadPriority::Normal);
+	FakeCopyQueue queue(fixture.sizes);
+
+	CHECK(!fixture.scheduler.SubmitBatch(fixture.scheduler.PopBatch(), queue));
+	REQUIRE(queue.mSubmissions.size() == 1);
+	CHECK(queue.mSubmissions[0] == std::vector<uint64_t>({ 0, 1 }));
+	CHECK(queue.mOrder == std::vector<uint64_t>({ 0, 1 }));
+	CHECK(fixture.ring.GetUsedSize() == 0);
+}
+
+TEST_CASE(FenceValuesIncreaseByOnePerSubmission)
+{
+	Fixture fixture(512, 256);
+	FakeCopyQueue queue(fixture.sizes);
+	for (uint64_t id = 0; id < 40; id++)
+		fixture.Enqueue(id, 100 + id, static_cast<UploadPriority>(id % 3));
+
+	while (!fixture.scheduler.IsEmpty())
+		CHECK(fixture.scheduler.SubmitBatch(fixture.scheduler.PopBatch(), queue));
+
+	REQUIRE(!queue.mFenceValues.empty());
+	for (size_t i = 0; i < queue.mFenceValues.size(); i++)
+		CHECK(queue.mFenceValues[i] == i + 1);
+	CHECK(fixture.scheduler.GetLastSubmittedFenceValue() == queue.mFenceValues.size());
+	CHECK(queue.mCopies.size() == 40);
+	CHECK(queue.mOverlapCount == 0);
+}
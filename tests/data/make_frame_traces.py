@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+"""Writes the frame time traces FramePacerTests replays, one "cpu,gpu" line of milliseconds per frame.
+
+GpuBoundTrace and CpuBoundTrace are constant loads, HitchTrace is a light load with a short and a long
+CPU hitch for the frame rate cap, and JitteryTrace is a GPU-bound load with noise on both sides and
+periodic GPU and CPU spikes.
+"""
+
+import os
+import random
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+def write(name, frames):
+    with open(os.path.join(HERE, name), 'w', newline='\n') as f:
+        f.write('cpu,gpu\n')
+        for cpu, gpu in frames:
+            f.write('%.3f,%.3f\n' % (cpu, gpu))
+
+
+def main():
+    write('GpuBoundTrace.csv', [(3.0, 10.0)] * 300)
+    write('CpuBoundTrace.csv', [(10.0, 4.0)] * 300)
+
+    hitch = [(2.0, 4.0)] * 120
+    hitch[30] = (20.0, 4.0)
+    hitch[60] = (40.0, 4.0)
+    write('HitchTrace.csv', hitch)
+
+    rng = random.Random(19)
+    jittery = []
+    for frame in range(2000):
+        cpu = max(rng.gauss(3.0, 0.5), 1.0)
+        gpu = max(rng.gauss(10.0, 1.5), 5.0)
+        if frame % 250 == 125:
+            gpu += 20.0
+        if frame % 400 == 300:
+            cpu += 15.0
+        jittery.append((cpu, gpu))
+    write('JitteryTrace.csv', jittery)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,34 @@
+#!/usr/bin/env python3
+"""Writes ShaderArchive.dxsl for ShaderArchiveTests with the archive writer of tools/compile_shaders.py.
+
+Blob i of n bytes holds (i * 37 + j) & 0xff at byte j, the keys are fixed hex strings.
+"""
+
+import os
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, '..', '..', 'tools'))
+
+import compile_shaders  # noqa: E402
+
+SHADERS = [
+    ('shader.hlsl:VSMain', 'a1b2c3d4e5f60718' + '0' * 48, 1000),
+    ('shader.hlsl:PSMain', '0123456789abcdef' + '1' * 48, 17),
+    ('Post/Tonemap.hlsl:CSMain', 'fedcba9876543210' + '2' * 48, 256),
+    ('Empty.hlsl:Main', '8000000000000001' + '3' * 48, 0),
+]
+
+
+def main():
+    entries = []
+    for index, (name, key, size) in enumerate(SHADERS):
+        entries.append((name, key, bytes((index * 37 + j) & 0xff for j in range(size))))
+    path = os.path.join(HERE, 'ShaderArchive.dxsl')
+    if os.path.isfile(path):
+        os.remove(path)
+    compile_shaders.write_archive(path, entries)
+
+
+if __name__ == '__main__':
+    main()
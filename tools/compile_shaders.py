@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+"""Offline shader build.
+
+Compiles every shader listed in Assets/Shaders/Shaders.json with DXC and packs the DXIL into a single
+archive the renderer memory-maps at startup (see ShaderArchive.h for the layout).
+
+Compiled blobs are cached by a hash of the DXC version, profile, entry point, defines, flags and the
+contents of the source and every file it includes, so unchanged shaders are never recompiled.
+Runs wherever a dxc binary does, Windows or Linux.
+"""
+
+import argparse
+import concurrent.futures
+import hashlib
+import json
+import os
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+ARCHIVE_MAGIC = 0x4C535844  # "DXSL"
+ARCHIVE_VERSION = 1
+BLOB_ALIGNMENT = 16
+
+INCLUDE_PATTERN = re.compile(r'^\s*#\s*include\s*[<"]([^>"]+)[>"]', re.MULTILINE)
+
+ROOT = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+
+def find_dxc(requested):
+    candidates = [requested] if requested else [os.environ.get('DXC'), 'dxc']
+    for candidate in candidates:
+        if not candidate:
+            continue
+        path = shutil.which(candidate) or (candidate if os.path.isfile(candidate) else None)
+        if path:
+            return path
+    sys.exit('error: dxc not found, pass --dxc or set DXC')
+
+
+def dxc_version(dxc):
+    result = subprocess.run([dxc, '--version'], capture_output=True, text=True)
+    return (result.stdout + result.stderr).strip()
+
+
+def resolve_include(name, including_dir, include_dirs):
+    for directory in [including_dir] + include_dirs:
+        path = os.path.normpath(os.path.join(directory, name))
+        if os.path.isfile(path):
+            return path
+    # Left to DXC to report
+    return None
+
+
+def hash_sources(path, include_dirs, hasher, visited):
+    """Feeds the file and, depth first, every file it includes, each once."""
+    if path in visited:
+        return
+    visited.add(path)
+
+    with open(path, 'rb') as f:
+        source = f.read()
+    hasher.update(os.path.basename(path).encode() + b'\0')
+    hasher.update(source)
+
+    for name in INCLUDE_PATTERN.findall(source.decode('utf-8', errors='replace')):
+        included = resolve_include(name, os.path.dirname(path), include_dirs)
+        if included:
+            hash_sources(included, include_dirs, hasher, visited)
+
+
+def shader_key(shader, include_dirs, version, flags):
+    hasher = hashlib.sha256()
+    for field in (version, shader['profile'], shader['entry'], ' '.join(sorted(shader['defines'])), ' '.join(flags)):
+        hasher.update(field.encode() + b'\0')
+    hash_sources(shader['path'], include_dirs, hasher, set())
+    return hasher.hexdigest()
+
+
+def compile_shader(dxc, shader, include_dirs, flags, key, cache_dir):
+    cached = os.path.join(cache_dir, key + '.dxil')
+    if os.path.isfile(cached):
+        return cached, False
+
+    arguments = [dxc, '-nologo', '-T', shader['profile'], '-E', shader['entry']]
+    for directory in include_dirs:
+        arguments += ['-I', directory]
+    for define in shader['defines']:
+        arguments += ['-D', define]
+    arguments += flags
+
+    # Compiled aside and renamed so an interrupted build never leaves a partial blob in the cache
+    fd, temp = tempfile.mkstemp(dir=cache_dir, suffix='.tmp')
+    os.close(fd)
+    try:
+        result = subprocess.run(arguments + ['-Fo', temp, shader['path']], capture_output=True, text=True)
+        if result.returncode != 0:
+            raise RuntimeError('%s:%s\n%s%s' % (shader['file'], shader['entry'], result.stdout, result.stderr))
+        os.replace(temp, cached)
+    finally:
+        if os.path.exists(temp):
+            os.remove(temp)
+
+    return cached, True
+
+
+def write_archive(path, entries):
+    """entries: list of (name, key, blob), written sorted by name."""
+    entries = sorted(entries, key=lambda entry: entry[0])
+
+    header_size = struct.calcsize('<IIII')
+    entry_size = struct.calcsize('<IIQQQ')
+    names = b''.join(name.encode() + b'\0' for name, _, _ in entries)
+
+    offset = header_size + entry_size * len(entries) + len(names)
+    table = b''
+    blobs = b''
+    name_offset = header_size + entry_size * len(entries)
+    for name, key, blob in entries:
+        padding = (-(offset + len(blobs))) % BLOB_ALIGNMENT
+        blobs += b'\0' * padding
+        table += struct.pack('<IIQQQ', name_offset, len(name.encode()), offset + len(blobs), len(blob), int(key[:16], 16))
+        blobs += blob
+        name_offset += len(name.encode()) + 1
+
+    data = struct.pack('<IIII', ARCHIVE_MAGIC, ARCHIVE_VERSION, len(entries), 0) + table + names + blobs
+
+    # Leave the archive untouched when nothing changed, so dependent build steps stay up to date
+    if os.path.isfile(path):
+        with open(path, 'rb') as f:
+            if f.read() == data:
+                return False
+
+    os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+    with open(path + '.tmp', 'wb') as f:
+        f.write(data)
+    os.replace(path + '.tmp', path)
+    return True
+
+
+def write_command(output, args, dxc):
+    """Records the interpreter and arguments of a full build in <output>.args, one per line, for the renderer
+    hot reload to rebuild shaders the same way. It adds --output and --only itself."""
+    command = [sys.executable, os.path.abspath(__file__), '--manifest', os.path.abspath(args.manifest),
+        '--cache-dir', os.path.abspath(args.cache_dir), '--dxc', os.path.abspath(dxc)]
+    if args.debug:
+        command.append('--debug')
+    for define in args.defines:
+        command += ['-D', define]
+    data = '\n'.join(command) + '\n'
+
+    path = output + '.args'
+    if os.path.isfile(path):
+        with open(path, encoding='utf-8') as f:
+            if f.read() == data:
+                return
+    with open(path, 'w', encoding='utf-8', newline='\n') as f:
+        f.write(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--manifest', default=os.path.join(ROOT, 'Assets', 'Shaders', 'Shaders.json'))
+    parser.add_argument('--output', default=os.path.join(ROOT, 'Assets', 'Shaders', 'Compiled', 'Shaders.dxsl'))
+    parser.add_argument('--cache-dir', default=os.path.join(ROOT, '.shadercache'))
+    parser.add_argument('--dxc', help='dxc executable, defaults to $DXC then dxc on the PATH')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count())
+    parser.add_argument('--debug', action='store_true', help='no optimization, embedded debug info')
+    parser.add_argument('-D', dest='defines', action='append', default=[], help='define added to every shader')
+    parser.add_argument('--only', action='append', default=[], metavar='FILE:ENTRY',
+        help='build only these shaders, used by the renderer hot reload')
+    args = parser.parse_args()
+
+    dxc = find_dxc(args.dxc)
+    version = dxc_version(dxc)
+    flags = ['-Od', '-Zi', '-Qembed_debug'] if args.debug else ['-O3', '-Qstrip_debug', '-Qstrip_reflect']
+
+    with open(args.manifest) as f:
+        manifest = json.load(f)
+
+    shader_dir = os.path.dirname(os.path.abspath(args.manifest))
+    include_dirs = [os.path.join(shader_dir, directory) for directory in manifest.get('includeDirs', [])]
+
+    shaders = []
+    for shader in manifest['shaders']:
+        if args.only and '%s:%s' % (shader['file'], shader['entry']) not in args.only:
+            continue
+        shader = dict(shader)
+        shader['path'] = os.path.join(shader_dir, shader['file'])
+        shader['defines'] = sorted(set(shader.get('defines', []) + args.defines))
+        shaders.append(shader)
+
+    os.makedirs(args.cache_dir, exist_ok=True)
+
+    entries = []
+    failures = []
+    compiled = 0
+    with concurrent.futures.ThreadPoolExecutor(max_workers=max(args.jobs or 1, 1)) as executor:
+        futures = {}
+        for shader in shaders:
+            key = shader_key(shader, include_dirs, version, flags)
+            futures[executor.submit(compile_shader, dxc, shader, include_dirs, flags, key, args.cache_dir)] = (shader, key)
+
+        for future in concurrent.futures.as_completed(futures):
+            shader, key = futures[future]
+            try:
+                cached, was_compiled = future.result()
+            except RuntimeError as error:
+                failures.append(str(error))
+                continue
+
+            compiled += was_compiled
+            with open(cached, 'rb') as f:
+                entries.append(('%s:%s' % (shader['file'], shader['entry']), key, f.read()))
+
+    for failure in failures:
+        print(failure, file=sys.stderr)
+    if failures:
+        return 1
+
+    written = write_archive(args.output, entries)
+    if not args.only:
+        write_command(args.output, args, dxc)
+    print('%d shaders, %d compiled, %d from cache, %s %s' % (len(entries), compiled, len(entries) - compiled,
+        args.output, 'written' if written else 'up to date'))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())